@@ -45,7 +45,11 @@ public:
     XNOR_ENGINE virtual void CheckWindowResize() = 0;
     
 protected:
-  
+    /// @brief Updates the sub systems that need to run once per frame on the main thread, e.g. the ResourceStreamer
+    /// uploads, and the ResourceManager restores and memory budgets.
+    ///
+    /// This must be called by the main loop of every Application, once each frame.
+    XNOR_ENGINE void UpdateSubsystems();
 };
 
 END_XNOR_CORE
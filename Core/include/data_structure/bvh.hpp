@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+
+#include "core.hpp"
+#include "Maths/vector3.hpp"
+#include "utils/bound.hpp"
+#include "utils/ray.hpp"
+
+/// @file bvh.hpp
+/// @brief Defines the XnorCore::Bvh class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Node of a Bvh.
+struct BvhNode
+{
+    /// @brief Minimum of the AABB of the node.
+    Vector3 min;
+    /// @brief Index of the first primitive of a leaf in Bvh::GetPrimitives, or of the first child of an internal node, the second child following it.
+    uint32_t first = 0;
+    /// @brief Maximum of the AABB of the node.
+    Vector3 max;
+    /// @brief Number of primitives of a leaf, or 0 for an internal node.
+    uint32_t count = 0;
+};
+
+/// @brief Bounding volume hierarchy over primitives given by their AABB, used to only test the primitives a ray can hit.
+///
+/// The tree is built top-down by splitting the nodes along the surface area heuristic, evaluated on a fixed number of bins.
+/// The primitives themselves are unknown to the Bvh, the raycast calls a function to intersect the ones in the leaves it reaches.
+class Bvh
+{
+public:
+    /// @brief Number of primitives under which a node isn't split anymore.
+    static constexpr uint32_t MaxLeafSize = 4;
+    /// @brief Number of bins the split positions are evaluated on, per axis.
+    static constexpr uint32_t BinCount = 16;
+
+    XNOR_ENGINE Bvh() = default;
+
+    XNOR_ENGINE ~Bvh() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(Bvh)
+
+    /// @brief Builds the tree over primitives.
+    ///
+    /// @param bounds AABB of the primitives, their index in this list is the one given back by the raycasts.
+    XNOR_ENGINE void Build(const std::vector<Bound>& bounds);
+
+    /// @brief Updates the AABB of the nodes to new AABB of the same primitives, keeping the tree as it was built.
+    ///
+    /// This is much faster than building the tree again, but the tree gets less efficient as the primitives move away from
+    /// where they were when it was built.
+    ///
+    /// @param bounds AABB of the primitives, in the same order as when the tree was built.
+    XNOR_ENGINE void Refit(const std::vector<Bound>& bounds);
+
+    /// @brief Removes all the nodes.
+    XNOR_ENGINE void Clear();
+
+    /// @brief Finds the closest primitive hit by a ray.
+    ///
+    /// @tparam HitFunc Function of signature @c bool_t(uint32_t primitive, float_t* distance), @p distance holding the
+    /// distance of the closest hit so far. It returns whether the ray hits the primitive closer than that, and sets @p distance then.
+    /// @param ray Ray.
+    /// @param hitPrimitive Function intersecting the ray with a primitive.
+    /// @param distance Distance after which hits are ignored, set to the distance of the hit.
+    /// @param primitive Index of the primitive hit.
+    /// @return Whether a primitive is hit.
+    template <typename HitFunc>
+    bool_t Raycast(const Ray& ray, HitFunc&& hitPrimitive, float_t* distance, uint32_t* primitive) const;
+
+    /// @brief Gets whether the tree has no node.
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsEmpty() const;
+
+    /// @brief Gets the nodes, the root being the first one.
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<BvhNode>& GetNodes() const;
+
+    /// @brief Gets the indices of the primitives, in the order of the leaves.
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<uint32_t>& GetPrimitives() const;
+
+    /// @brief Gets the memory used by the tree, in bytes.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetMemorySize() const;
+
+private:
+    /// @brief Maximum depth of the traversal stack, the splits can't be degenerate enough to reach it.
+    static constexpr size_t StackSize = 64;
+
+    /// @brief Node still to visit by a raycast
+    struct StackEntry
+    {
+        uint32_t node = 0;
+        /// @brief Distance at which the ray enters the node
+        float_t distance = 0.f;
+    };
+
+    std::vector<BvhNode> m_Nodes;
+    std::vector<uint32_t> m_Primitives;
+
+    static bool_t IntersectNode(const BvhNode& node, const Vector3& origin, const Vector3& inverseDirection, float_t maxDistance, float_t* distance);
+
+    XNOR_ENGINE void ComputeNodeBounds(BvhNode* node, const std::vector<Bound>& bounds) const;
+
+    XNOR_ENGINE bool_t FindSplit(const BvhNode& node, const std::vector<Bound>& bounds, const std::vector<Vector3>& centers, uint32_t* axis, float_t* position) const;
+};
+
+END_XNOR_CORE
+
+#include "data_structure/bvh.inl"
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+#include "core.hpp"
+#include "file/memory_mapped_file.hpp"
+#include "utils/compression.hpp"
+
+/// @file archive.hpp
+/// @brief Defines the XnorCore::Archive class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Header found at the very start of an Archive file.
+struct ArchiveHeader
+{
+    /// @brief Must be equal to Archive::Magic.
+    std::array<char_t, 4> magic {};
+    /// @brief Must be equal to Archive::Version.
+    uint32_t version = 0;
+    /// @brief Number of entries in the index.
+    uint32_t entryCount = 0;
+    /// @brief Alignment of the data of each entry, in bytes.
+    uint32_t alignment = 0;
+    /// @brief Offset of the index from the start of the file.
+    uint64_t indexOffset = 0;
+    /// @brief Offset of the entry path strings from the start of the file.
+    uint64_t pathsOffset = 0;
+    /// @brief Total size of the entry path strings.
+    uint64_t pathsSize = 0;
+};
+
+/// @brief Index entry describing a single file stored in an Archive.
+struct ArchiveEntry
+{
+    /// @brief Hash of the entry path, see Archive::HashPath.
+    uint64_t pathHash = 0;
+    /// @brief Offset of the stored data from the start of the file.
+    uint64_t offset = 0;
+    /// @brief Size of the stored, potentially compressed, data.
+    uint64_t storedSize = 0;
+    /// @brief Size of the original data.
+    uint64_t size = 0;
+    /// @brief Offset of the entry path from ArchiveHeader::pathsOffset.
+    uint32_t pathOffset = 0;
+    /// @brief Length of the entry path.
+    uint32_t pathLength = 0;
+    /// @brief Compression format of the stored data.
+    uint32_t compression = CompressionFormat::None;
+    /// @brief Unused, keeps the entries 8-byte aligned.
+    uint32_t reserved = 0;
+};
+
+/// @brief Options used by Archive::Build.
+struct ArchiveBuildOptions
+{
+    /// @brief Alignment of the data of each entry, in bytes. Must be a power of two.
+    uint32_t alignment = 16;
+    /// @brief Compression format used for the entries.
+    ENUM_VALUE(CompressionFormat) compression = CompressionFormat::Lz4;
+    /// @brief An entry is only stored compressed if its compressed size is at most this ratio of its original size.
+    ///
+    /// This avoids paying for the decompression of files that are already compressed, e.g. most image formats.
+    float_t maxCompressionRatio = 0.9f;
+};
+
+/// @brief Read-only archive of files, usually created from the @c assets directory using the Packer tool.
+///
+/// An archive is made of an ArchiveHeader, followed by the aligned data of each entry, the index, and finally the entry paths.
+/// The index is sorted by path hash so that entries can be found using a binary search, without any allocation.
+///
+/// The whole archive is memory mapped: opening it only reads the header, and uncompressed entries can be used in place without
+/// any copy. Archives are usually mounted using FileManager::MountArchive.
+class Archive
+{
+public:
+    /// @brief Magic number found at the start of every archive.
+    static constexpr std::array<char_t, 4> Magic { 'X', 'P', 'A', 'K' };
+
+    /// @brief Current version of the archive format.
+    static constexpr uint32_t Version = 1;
+
+    /// @brief File extension of archives.
+    static constexpr const char_t* const FileExtension = ".pak";
+
+    XNOR_ENGINE Archive() = default;
+
+    XNOR_ENGINE ~Archive() = default;
+
+    DELETE_COPY_MOVE_OPERATIONS(Archive)
+
+    /// @brief Builds an archive at @p archivePath containing every file of @p sourceDirectory, recursively.
+    ///
+    /// Entry paths are relative to @p sourceDirectory and always use forward slashes.
+    ///
+    /// @returns @c true if the archive was successfully written, @c false otherwise.
+    XNOR_ENGINE static bool_t Build(const std::filesystem::path& sourceDirectory, const std::filesystem::path& archivePath, const ArchiveBuildOptions& options = {});
+
+    /// @brief Computes the hash of an entry path, used to find entries in the index.
+    [[nodiscard]]
+    XNOR_ENGINE static uint64_t HashPath(std::string_view path);
+
+    /// @brief Opens and validates the archive at the given @p path.
+    ///
+    /// @returns @c true if the archive was successfully opened, @c false otherwise.
+    XNOR_ENGINE bool_t Open(const std::filesystem::path& path);
+
+    /// @brief Closes the archive, invalidating every pointer to its data.
+    XNOR_ENGINE void Close();
+
+    /// @brief Returns whether the archive is open.
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsOpen() const;
+
+    /// @brief Returns the path of the archive file.
+    [[nodiscard]]
+    XNOR_ENGINE const std::filesystem::path& GetPath() const;
+
+    /// @brief Returns the number of entries in the archive.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetEntryCount() const;
+
+    /// @brief Returns the index entry at the given @p index.
+    [[nodiscard]]
+    XNOR_ENGINE const ArchiveEntry& GetEntry(size_t index) const;
+
+    /// @brief Returns the path of the entry at the given @p index, relative to the archive root.
+    [[nodiscard]]
+    XNOR_ENGINE std::string_view GetEntryPath(size_t index) const;
+
+    /// @brief Finds the entry with the given @p path, relative to the archive root.
+    ///
+    /// @returns @c true if the entry was found, in which case @p index is set to its index, @c false otherwise.
+    XNOR_ENGINE bool_t Find(std::string_view path, size_t* index) const;
+
+    /// @brief Returns a pointer to the stored data of the entry at the given @p index.
+    ///
+    /// This is the original data if the entry isn't compressed. The mapping is copy-on-write, so writing to it is allowed but
+    /// doesn't modify the archive file.
+    [[nodiscard]]
+    XNOR_ENGINE uint8_t* GetStoredData(size_t index);
+
+    /// @brief Decompresses the entry at the given @p index into @p destination, which must be ArchiveEntry::size bytes long.
+    ///
+    /// @returns @c true if the entry was successfully decompressed, @c false otherwise.
+    XNOR_ENGINE bool_t Extract(size_t index, uint8_t* destination);
+
+    /// @brief Asks the operating system to read the data of the entry at the given @p index ahead of time.
+    XNOR_ENGINE void Prefetch(size_t index) const;
+
+private:
+    std::filesystem::path m_Path;
+    MemoryMappedFile m_Mapping;
+
+    const ArchiveEntry* m_Entries = nullptr;
+    size_t m_EntryCount = 0;
+    const char_t* m_Paths = nullptr;
+};
+
+END_XNOR_CORE
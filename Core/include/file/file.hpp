@@ -3,7 +3,9 @@
 #include <filesystem>
 
 #include "core.hpp"
+#include "file/archive.hpp"
 #include "file/entry.hpp"
+#include "file/memory_mapped_file.hpp"
 #include "resource/resource.hpp"
 #include "utils/pointer.hpp"
 
@@ -34,11 +36,27 @@ public:
         GeometryShader,
         ComputeShader
     };
+
+    /// @brief Whether large asset files should be memory mapped instead of being read into a separate buffer.
+    ///
+    /// Mapping a file avoids copying its contents from the kernel page cache and lets the operating system read it ahead.
+    /// Only textures, meshes, fonts and audio tracks are mapped, as those are parsed from the loaded data and never written to.
+    static inline bool_t useMemoryMapping = true;
+
+    /// @brief Minimum size of a file for it to be memory mapped, as mapping small files is slower than reading them.
+    static inline int64_t memoryMappingMinSize = 64 * 1024;
     
     /// @brief Constructs a File corresponding to the given @p path.
     [[nodiscard]]
     XNOR_ENGINE explicit File(std::filesystem::path&& filepath);
 
+    /// @brief Constructs a File corresponding to the entry at @p archiveIndex of the given @p archive.
+    ///
+    /// Unlike regular files, archived files don't exist on the filesystem: @p filepath is only a virtual path.
+    /// @see FileManager::MountArchive
+    [[nodiscard]]
+    XNOR_ENGINE File(std::filesystem::path&& filepath, const Pointer<Archive>& archive, size_t archiveIndex);
+
     /// @brief Destructs the File instance by calling Unload.
     XNOR_ENGINE ~File() override;
 
@@ -90,6 +108,18 @@ public:
     [[nodiscard]]
     XNOR_ENGINE int64_t GetSize() const;
 
+    /// @brief Returns whether the data of this File is a memory mapping of the filesystem file.
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsMemoryMapped() const;
+
+    /// @brief Returns whether this File is stored in an Archive instead of on the filesystem.
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsArchived() const;
+
+    /// @brief Returns the Archive this File is stored in, or a null Pointer if it is on the filesystem.
+    [[nodiscard]]
+    XNOR_ENGINE Pointer<Archive> GetArchive() const;
+
     /// @brief Sets the name of this File.
     XNOR_ENGINE void SetName(const std::string& newName) override;
 
@@ -104,6 +134,9 @@ protected:
     void UpdateUtilityValues() override;
     
 private:
+    [[nodiscard]]
+    bool_t ShouldMemoryMap() const;
+
     std::string m_NameNoExtension;
     std::string m_Extension;
     std::string m_PathNoExtension;
@@ -111,6 +144,13 @@ private:
     
     int8_t* m_Data = nullptr;
     int64_t m_Size = 0;
+    // False if m_Data points into m_Mapping or into the memory mapping of m_Archive
+    bool_t m_OwnsData = true;
+    MemoryMappedFile m_Mapping;
+
+    // Null if the file is on the filesystem
+    Pointer<Archive> m_Archive;
+    size_t m_ArchiveIndex = 0;
 
     // Null if the file isn't linked to a specific resource
     Pointer<Resource> m_Resource;
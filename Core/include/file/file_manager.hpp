@@ -2,8 +2,10 @@
 
 #include <filesystem>
 #include <map>
+#include <vector>
 
 #include "core.hpp"
+#include "file/archive.hpp"
 #include "file/directory.hpp"
 #include "file/file.hpp"
 #include "utils/logger.hpp"
@@ -37,6 +39,20 @@ public:
     /// @see Directory::Load
     XNOR_ENGINE static Pointer<Directory> LoadDirectory(std::filesystem::path path);
 
+    /// @brief Opens the Archive at the given @p archivePath and loads a File for each of its entries.
+    ///
+    /// Each entry is available at the path @p mountPoint / entry path, so mounting an archive built from the @c assets directory
+    /// on @c "assets" results in the same File paths as loading the directory itself. Entries that already exist are skipped,
+    /// which means that loose files take precedence over archived ones.
+    ///
+    /// No Directory is created for archived files.
+    ///
+    /// @returns The mounted Archive, or a null Pointer if it couldn't be opened.
+    XNOR_ENGINE static Pointer<Archive> MountArchive(const std::filesystem::path& archivePath, const std::filesystem::path& mountPoint);
+
+    /// @brief Unloads every File stored in the given @p archive and closes it.
+    XNOR_ENGINE static void UnmountArchive(Pointer<Archive> archive);
+
     /// @brief Checks whether the FileManager contains the specified Entry path.
     [[nodiscard]]
     XNOR_ENGINE static bool_t Contains(const std::filesystem::path& path);
@@ -114,6 +130,7 @@ public:
     
 private:
     XNOR_ENGINE static inline std::map<std::filesystem::path, Pointer<Entry>> m_Entries;
+    XNOR_ENGINE static inline std::vector<Pointer<Archive>> m_Archives;
 };
 
 END_XNOR_CORE
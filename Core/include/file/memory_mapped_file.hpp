@@ -0,0 +1,74 @@
+#pragma once
+
+#include <filesystem>
+
+#include "core.hpp"
+
+/// @file memory_mapped_file.hpp
+/// @brief Defines the XnorCore::MemoryMappedFile class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Expected access pattern of a MemoryMappedFile, used as a read-ahead hint by the operating system.
+BEGIN_ENUM(MappingAccess)
+{
+    /// @brief The file will mostly be read from start to end, so the operating system should read ahead aggressively.
+    Sequential,
+    /// @brief The file will be read at random offsets, so reading ahead would mostly waste I/O.
+    Random
+}
+END_ENUM
+
+/// @brief Read-only view of a whole filesystem file mapped in memory.
+///
+/// The mapping is copy-on-write: writing to the view never modifies the underlying file, and only duplicates the written pages.
+/// Pages are only read from the disk when first accessed, which makes opening a mapping almost free regardless of the file size.
+class MemoryMappedFile
+{
+public:
+    XNOR_ENGINE MemoryMappedFile() = default;
+
+    /// @brief Closes the mapping.
+    XNOR_ENGINE ~MemoryMappedFile();
+
+    DELETE_COPY_MOVE_OPERATIONS(MemoryMappedFile)
+
+    /// @brief Maps the file at the given @p path.
+    ///
+    /// Any previously opened mapping is closed first. Empty files are valid and result in an open mapping with a @c nullptr view.
+    ///
+    /// @returns @c true if the file was successfully mapped, @c false otherwise.
+    XNOR_ENGINE bool_t Open(const std::filesystem::path& path, ENUM_VALUE(MappingAccess) access = MappingAccess::Sequential);
+
+    /// @brief Unmaps the file.
+    XNOR_ENGINE void Close();
+
+    /// @brief Asks the operating system to asynchronously read the given range of the file.
+    XNOR_ENGINE void Prefetch(size_t offset, size_t size) const;
+
+    /// @brief Returns whether a file is currently mapped.
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsOpen() const;
+
+    /// @brief Returns a @c const pointer to the start of the mapped view.
+    [[nodiscard]]
+    XNOR_ENGINE const uint8_t* GetData() const;
+
+    /// @brief Returns a pointer to the start of the mapped view.
+    [[nodiscard]]
+    XNOR_ENGINE uint8_t* GetData();
+
+    /// @brief Returns the size of the mapped file.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetSize() const;
+
+private:
+    uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+    bool_t m_Open = false;
+
+    // Platform-specific handle, only used on Windows
+    void* m_MappingHandle = nullptr;
+};
+
+END_XNOR_CORE
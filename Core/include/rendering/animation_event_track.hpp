@@ -0,0 +1,84 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "core.hpp"
+
+/// @file animation_event_track.hpp
+/// @brief Defines the XnorCore::AnimationEventTrack class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Events of an animation, sorted by time and fired from a cursor.
+///
+/// Advancing the track only compares the time with the next event, so its cost doesn't depend on the number of events, and
+/// an update fires all the events it steps over, including across loops.
+class AnimationEventTrack
+{
+public:
+    /// @brief Function called when an event is reached.
+    using FunctionT = std::function<void()>;
+
+    XNOR_ENGINE AnimationEventTrack() = default;
+
+    XNOR_ENGINE ~AnimationEventTrack() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(AnimationEventTrack)
+
+    /// @brief Adds an event, after the events which are at the same time. Events mustn't be added from an event function.
+    ///
+    /// @param time Time of the event, between 0 and the duration.
+    /// @param function Function called when the event is reached.
+    XNOR_ENGINE void Add(float_t time, const FunctionT& function);
+
+    /// @brief Removes all the events.
+    XNOR_ENGINE void Clear();
+
+    /// @brief Moves to a time without firing any event.
+    ///
+    /// @param time Time in the track.
+    XNOR_ENGINE void Seek(float_t time);
+
+    /// @brief Advances the time and fires the events between the previous time, included, and the new one.
+    ///
+    /// The events at the end of the track are fired when it is reached. When looping, every loop the step goes through
+    /// fires all the events. Without a duration, the time is never wrapped.
+    ///
+    /// @param deltaTime Time since the last update, the events aren't fired backward.
+    /// @param looping Whether to go back to the start of the track after its end.
+    /// @return Number of events fired.
+    XNOR_ENGINE size_t Advance(float_t deltaTime, bool_t looping);
+
+    /// @brief Gets the duration of the track.
+    [[nodiscard]]
+    XNOR_ENGINE float_t GetDuration() const;
+
+    /// @brief Sets the duration of the track.
+    ///
+    /// @param duration Duration.
+    XNOR_ENGINE void SetDuration(float_t duration);
+
+    /// @brief Gets the current time.
+    [[nodiscard]]
+    XNOR_ENGINE float_t GetTime() const;
+
+    /// @brief Gets the index of the next event to fire.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetCursor() const;
+
+    /// @brief Gets the number of events.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetEventCount() const;
+
+private:
+    /// @brief Time of each event, in ascending order
+    std::vector<float_t> m_Times;
+    /// @brief Function of each event, in the order of the times
+    std::vector<FunctionT> m_Functions;
+    float_t m_Duration = 0.f;
+    float_t m_Time = 0.f;
+    size_t m_Cursor = 0;
+};
+
+END_XNOR_CORE
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vector>
+
+#include "core.hpp"
+#include "Maths/matrix.hpp"
+#include "Maths/quaternion.hpp"
+#include "Maths/vector3.hpp"
+#include "rendering/bone.hpp"
+#include "utils/list.hpp"
+
+/// @file animation_pose.hpp
+/// @brief Defines the XnorCore::AnimationPose class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Local transforms of the bones of a skeleton.
+///
+/// The translations, rotations and scales are stored in separate arrays so that poses can be blended several bones at a
+/// time with SIMD instructions. The arrays only grow, so a pose which is reused every frame for the same skeleton doesn't
+/// allocate memory.
+class AnimationPose final
+{
+public:
+    XNOR_ENGINE AnimationPose() = default;
+
+    XNOR_ENGINE explicit AnimationPose(size_t boneCount);
+
+    XNOR_ENGINE ~AnimationPose() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(AnimationPose)
+
+    /// @brief Sets the number of bones of the pose, only allocating memory if it is larger than it ever was.
+    ///
+    /// @param boneCount Number of bones.
+    XNOR_ENGINE void Resize(size_t boneCount);
+
+    /// @brief Sets every bone to the identity transform.
+    XNOR_ENGINE void SetIdentity();
+
+    /// @brief Blends 2 poses of the same skeleton, linearly for the translations and scales and with a normalized lerp for the rotations.
+    ///
+    /// @param from Pose at @p t = 0.
+    /// @param to Pose at @p t = 1.
+    /// @param t Blend factor.
+    /// @param result Blended pose, which can be @p from or @p to.
+    XNOR_ENGINE static void Blend(const AnimationPose& from, const AnimationPose& to, float_t t, AnimationPose* result);
+
+    /// @brief Blends 2 poses of the same skeleton with a blend factor for each bone.
+    ///
+    /// @param from Pose at @p t = 0.
+    /// @param to Pose at @p t = 1.
+    /// @param boneWeights Weight of each bone, multiplied by @p t. The bones without a weight keep the transform of @p from.
+    /// @param t Blend factor.
+    /// @param result Blended pose, which can be @p from or @p to.
+    XNOR_ENGINE static void Blend(const AnimationPose& from, const AnimationPose& to, const std::vector<float_t>& boneWeights, float_t t, AnimationPose* result);
+
+    /// @brief Adds the difference between a pose and a reference pose on top of a base pose.
+    ///
+    /// @param base Base pose.
+    /// @param additive Pose added to the base.
+    /// @param reference Pose the additive pose is relative to, usually its first frame.
+    /// @param weight Weight of the additive pose.
+    /// @param result Resulting pose, which can be @p base.
+    XNOR_ENGINE static void Add(const AnimationPose& base, const AnimationPose& additive, const AnimationPose& reference, float_t weight, AnimationPose* result);
+
+    /// @brief Computes the model space matrix of each bone from the local transforms, parents first, and the matrices used for skinning.
+    ///
+    /// @param bones Bones of the skeleton, ordered with the parents before their children.
+    /// @param modelMatrices Model space matrix of each bone, by bone id.
+    /// @param skinningMatrices Transform of each bone from its bind pose, by bone id.
+    XNOR_ENGINE void ComputeMatrices(const List<Bone>& bones, Matrix* modelMatrices, Matrix* skinningMatrices) const;
+
+    /// @brief Gets the number of bones.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetBoneCount() const;
+
+    /// @brief Gets the translation of each bone.
+    [[nodiscard]]
+    XNOR_ENGINE Vector3* GetTranslations();
+
+    /// @brief Gets the translation of each bone.
+    [[nodiscard]]
+    XNOR_ENGINE const Vector3* GetTranslations() const;
+
+    /// @brief Gets the rotation of each bone.
+    [[nodiscard]]
+    XNOR_ENGINE Quaternion* GetRotations();
+
+    /// @brief Gets the rotation of each bone.
+    [[nodiscard]]
+    XNOR_ENGINE const Quaternion* GetRotations() const;
+
+    /// @brief Gets the scale of each bone.
+    [[nodiscard]]
+    XNOR_ENGINE Vector3* GetScalings();
+
+    /// @brief Gets the scale of each bone.
+    [[nodiscard]]
+    XNOR_ENGINE const Vector3* GetScalings() const;
+
+private:
+    size_t m_BoneCount = 0;
+
+    std::vector<Vector3> m_Translations;
+    std::vector<Quaternion> m_Rotations;
+    std::vector<Vector3> m_Scalings;
+};
+
+END_XNOR_CORE
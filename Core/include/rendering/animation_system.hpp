@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "core.hpp"
+#include "rendering/animator.hpp"
+#include "rendering/camera.hpp"
+#include "rendering/frustum.hpp"
+#include "utils/bound.hpp"
+
+/// @file animation_system.hpp
+/// @brief Defines the XnorCore::AnimationSystem class.
+
+BEGIN_XNOR_CORE
+
+class Scene;
+class SkinnedMeshRenderer;
+
+/// @brief Level of detail of the animation of a character.
+struct AnimationLodLevel
+{
+    /// @brief Minimum height of the character on screen for this level, as a fraction of the height of the screen.
+    float_t minScreenSize = 0.f;
+    /// @brief Number of frames between 2 updates, 0 to pause the animation.
+    uint32_t updateInterval = 1;
+    /// @brief Levels of leaf bones which aren't sampled, such as the fingers and the face.
+    uint8_t skippedLeafLevels = 0;
+};
+
+/// @brief Animation work of a frame.
+struct AnimationStats
+{
+    /// @brief Number of animators.
+    size_t animatorCount = 0;
+    /// @brief Number of animators updated this frame, the other ones holding their pose.
+    size_t updatedAnimatorCount = 0;
+    /// @brief Number of animators in each level of detail.
+    std::array<size_t, 4> lodAnimatorCounts{};
+    /// @brief Number of bones of all the animators.
+    size_t boneCount = 0;
+    /// @brief Number of bones sampled this frame.
+    size_t animatedBoneCount = 0;
+};
+
+/// @brief Evaluates the animators of a scene once per frame, before anything is rendered.
+///
+/// The animators are split in batches which are animated on worker threads. Each animator only writes to its own bone
+/// matrices, so the result doesn't depend on the number of threads nor on the order the batches are run in, and the
+/// renderers only read the matrices afterward.
+///
+/// Each character gets a level of detail from its size on the screen in the views rendered in the last frame, and the
+/// characters which are in no view get the last one. Characters updated every few frames are spread over the frames
+/// and hold their pose in between. Each animator gets the phase of its updates when it enters a level, so it is updated
+/// at a regular interval whatever the order it is added in.
+class AnimationSystem
+{
+public:
+    /// @brief Number of animators animated one after another by a worker thread.
+    static constexpr size_t BatchSize = 8;
+
+    /// @brief Number of levels of detail.
+    static constexpr size_t LodCount = 4;
+
+    /// @brief Levels of detail, from the closest to the farthest.
+    std::array<AnimationLodLevel, LodCount> lodLevels
+    {
+        AnimationLodLevel{ .minScreenSize = 0.25f, .updateInterval = 1, .skippedLeafLevels = 0 },
+        AnimationLodLevel{ .minScreenSize = 0.1f, .updateInterval = 2, .skippedLeafLevels = 1 },
+        AnimationLodLevel{ .minScreenSize = 0.02f, .updateInterval = 4, .skippedLeafLevels = 2 },
+        AnimationLodLevel{ .minScreenSize = 0.f, .updateInterval = 0, .skippedLeafLevels = 2 }
+    };
+
+    XNOR_ENGINE AnimationSystem() = default;
+
+    XNOR_ENGINE ~AnimationSystem() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(AnimationSystem)
+
+    /// @brief Gathers the animators of the skinned meshes of a scene, replacing the previous ones.
+    ///
+    /// @param scene Scene.
+    XNOR_ENGINE void Gather(Scene& scene);
+
+    /// @brief Adds an animator to evaluate at full rate, which mustn't be the blend target of another one.
+    ///
+    /// @param animator Animator.
+    XNOR_ENGINE void Add(Animator* animator);
+
+    /// @brief Adds an animator to evaluate, which mustn't be the blend target of another one.
+    ///
+    /// @param animator Animator.
+    /// @param bound World space AABB of the character, used to choose its level of detail.
+    XNOR_ENGINE void Add(Animator* animator, const Bound& bound);
+
+    /// @brief Adds a view the characters are seen from, which is used by the next update.
+    ///
+    /// @param camera Camera.
+    /// @param screenSize Size of the view in pixels.
+    XNOR_ENGINE void AddView(const Camera& camera, Vector2i screenSize);
+
+    /// @brief Removes all the animators.
+    XNOR_ENGINE void Clear();
+
+    /// @brief Animates all the animators.
+    ///
+    /// @param deltaTime Time since the last update.
+    /// @param parallel Whether to animate the batches on worker threads, or all of them on the calling thread.
+    XNOR_ENGINE void Update(float_t deltaTime, bool_t parallel = true);
+
+    /// @brief Gets the level of detail of a character.
+    ///
+    /// @param bound World space AABB of the character.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetLod(const Bound& bound) const;
+
+    /// @brief Gets the height of an AABB on the screen of a camera, as a fraction of the height of the screen.
+    ///
+    /// @param camera Camera.
+    /// @param bound World space AABB.
+    [[nodiscard]]
+    XNOR_ENGINE static float_t GetScreenSize(const Camera& camera, const Bound& bound);
+
+    /// @brief Gets the animators which are evaluated.
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<Animator*>& GetAnimators() const;
+
+    /// @brief Gets the animation work of the last update.
+    [[nodiscard]]
+    XNOR_ENGINE const AnimationStats& GetStats() const;
+
+private:
+    /// @brief View the characters are seen from
+    struct View
+    {
+        Camera camera;
+        Frustum frustum;
+    };
+
+    std::vector<Animator*> m_Animators;
+    /// @brief AABB of each animator, empty ones being always animated at full rate
+    std::vector<Bound> m_Bounds;
+    /// @brief Animators updated this frame
+    std::vector<Animator*> m_UpdatedAnimators;
+    std::vector<View> m_Views;
+    uint64_t m_FrameIndex = 0;
+    /// @brief Phase given to the next animator entering each level of detail
+    std::array<uint32_t, LodCount> m_NextUpdatePhases{};
+    AnimationStats m_Stats;
+    /// @brief Index of each batch, iterated by the parallel algorithm
+    std::vector<uint32_t> m_Batches;
+    /// @brief Storage of the components of the scene, kept to avoid allocating it every frame
+    std::vector<SkinnedMeshRenderer*> m_SkinnedMeshRenderers;
+};
+
+END_XNOR_CORE
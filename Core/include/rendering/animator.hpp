@@ -1,8 +1,11 @@
 ﻿#pragma once
 
+#include <limits>
+
 #include "core.hpp"
 #include "rhi_typedef.hpp"
 #include "Maths/matrix.hpp"
+#include "rendering/animation_pose.hpp"
 #include "reflection/reflection.hpp"
 #include "utils/list.hpp"
 #include "utils/pointer.hpp"
@@ -10,6 +13,7 @@
 BEGIN_XNOR_CORE
 
 class Animation;
+class BlendTree;
 
 class Animator final
 {
@@ -25,15 +29,84 @@ public:
     XNOR_ENGINE void Start(const Pointer<Animation>& animation);
     XNOR_ENGINE void StartBlending(Animator* target);
 
+    /// @brief Drives the pose with a blend tree instead of the animation, or stops if @p blendTree is @c nullptr.
+    ///
+    /// The blend tree isn't owned by the animator, and can't be shared between animators animated in parallel. The pose of
+    /// the blend tree is cross-faded to the blend target the same way as the pose of the animation, except that the blend
+    /// target keeps its own play speed as a blend tree has no single duration.
+    ///
+    /// @param blendTree Blend tree.
+    XNOR_ENGINE void SetBlendTree(BlendTree* blendTree);
+
+    /// @brief Gets the blend tree driving the pose, if any.
+    [[nodiscard]]
+    XNOR_ENGINE BlendTree* GetBlendTree() const;
+
+    /// @brief Binds the animations of this animator and of its blend target to their skeleton if needed.
+    ///
+    /// The animations are shared between animators, so this has to be called before animating them on several threads.
+    XNOR_ENGINE void Prepare();
+
+    /// @brief Animates using the delta time of the frame.
     XNOR_ENGINE void Animate();
 
+    /// @brief Advances the animation and computes the matrices of the bones.
+    ///
+    /// This only writes to this animator and its blend target, so animators which were prepared can be animated in parallel.
+    ///
+    /// @param deltaTime Time since the last update.
+    XNOR_ENGINE void Animate(float_t deltaTime);
+
+    /// @brief Keeps the current pose for this frame, the time is caught up with at the next update.
+    ///
+    /// @param deltaTime Time since the last update.
+    XNOR_ENGINE void Hold(float_t deltaTime);
+
+    /// @brief Sets the levels of leaf bones which aren't sampled, e.g. 1 to skip the tips of the fingers.
+    ///
+    /// @param levels Levels of leaf bones.
+    XNOR_ENGINE void SetSkippedLeafLevels(uint8_t levels);
+
+    /// @brief Gets the number of bones sampled by the last update, including the ones of the blend target.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetSampledBoneCount() const;
+
+    /// @brief Gets the movement of the root bone during the last update, for the movement code to apply it to the character.
+    ///
+    /// This is read from the root motion baked in the animation, and is zero when the animator is driven by a blend tree.
+    ///
+    /// @param translation Translation of the root, in the space of the animation.
+    /// @param yaw Rotation of the root around the up axis, in radians.
+    XNOR_ENGINE void GetRootMotion(Vector3* translation, float_t* yaw) const;
+
+    /// @brief Sets whether the movement code applies the root motion to the character.
+    ///
+    /// The root bone of the pose then stays where it is at the start of the animation, so that the character doesn't move twice.
+    ///
+    /// @param consumed Whether the root motion is consumed.
+    XNOR_ENGINE void SetRootMotionConsumed(bool_t consumed);
+
+    /// @brief Gets whether the movement code applies the root motion to the character.
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsRootMotionConsumed() const;
+
+    /// @brief Gets the number of bones of the skeleton of the animation.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetBoneCount() const;
+
     XNOR_ENGINE void SetCrossFadeDelta(float_t delta);
 
     [[nodiscard]]
     XNOR_ENGINE const List<Matrix>& GetMatrices() const;
     
 private:
-    XNOR_ENGINE void UpdateTime();
+    XNOR_ENGINE void UpdateTime(float_t deltaTime);
+
+    XNOR_ENGINE void AnimateBlendTree(float_t deltaTime);
+
+    XNOR_ENGINE void AnimateBlendTarget(float_t deltaTime);
+
+    XNOR_ENGINE void ComputeMatrices(const List<Bone>& bones);
     
     Pointer<Animation> m_Animation;
     
@@ -45,17 +118,44 @@ private:
 
     size_t m_FrameCount;
 
-    mutable List<Matrix> m_FinalMatrices = List<Matrix>(MaxBones);
-    
-    List<Vector3> m_Positions = List<Vector3>(MaxBones);
+    // Sized to the skeleton when it changes, so that there is no limit to its number of bones
+    mutable List<Matrix> m_FinalMatrices;
     
-    List<Quaternion> m_Rotations = List<Quaternion>(MaxBones);
+    List<Matrix> m_ModelMatrices;
+
+    AnimationPose m_Pose;
+
+    AnimationPose m_BlendedPose;
+
+    float_t m_HeldTime = 0.f;
+
+    uint8_t m_SkippedLeafLevels = 0;
+
+    bool_t m_IsPoseComplete = false;
+
+    size_t m_SampledBoneCount = 0;
+
+    Vector3 m_RootMotionTranslation;
+
+    float_t m_RootMotionYaw = 0.f;
+
+    bool_t m_IsRootMotionConsumed = false;
 
     float_t m_CrossFadeT = 0.f;
     
     Animator* m_BlendTarget = nullptr;
 
+    BlendTree* m_BlendTree = nullptr;
+
     bool_t m_IsFinished = false;
+
+    // Level of detail the animation system last put the animator in, and the phase of its updates in that level
+    size_t m_UpdateLod = std::numeric_limits<size_t>::max();
+
+    uint32_t m_UpdatePhase = 0;
+
+    // We need this in order to keep the phase of the updates from the AnimationSystem
+    friend class AnimationSystem;
 };
 
 END_XNOR_CORE
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <deque>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core.hpp"
+#include "Maths/vector2.hpp"
+#include "rendering/animation_pose.hpp"
+#include "utils/pointer.hpp"
+
+/// @file blend_tree.hpp
+/// @brief Defines the XnorCore::BlendTree class.
+
+BEGIN_XNOR_CORE
+
+class Animation;
+class Skeleton;
+
+/// @brief Kind of node of a BlendTree.
+enum class BlendNodeType : uint8_t
+{
+    /// @brief Samples a clip.
+    Clip,
+    /// @brief Blends its inputs from their position on a line.
+    Blend1D,
+    /// @brief Blends its inputs from their position on a plane.
+    Blend2D,
+    /// @brief Adds the difference between a clip and its first frame on top of its base input.
+    Additive,
+    /// @brief Blends a layer on top of its base input with a weight for each bone.
+    Mask
+};
+
+/// @brief Node of a BlendTree, which evaluates to a local pose.
+struct BlendNode
+{
+    /// @brief Kind of node.
+    BlendNodeType type = BlendNodeType::Clip;
+    /// @brief Clip sampled by a Clip node.
+    uint32_t clip = 0;
+    /// @brief Input nodes. Additive and Mask nodes have a base input followed by the layer.
+    std::vector<uint32_t> inputs;
+    /// @brief Position of each input in a blend space, only using x for Blend1D nodes.
+    std::vector<Vector2> positions;
+    /// @brief Parameter giving the x position in a blend space, or the weight of the layer of Additive and Mask nodes.
+    uint32_t parameterX = 0;
+    /// @brief Parameter giving the y position in a Blend2D space.
+    uint32_t parameterY = 0;
+    /// @brief Weight of each bone in the layer of a Mask node.
+    std::vector<float_t> boneWeights;
+};
+
+/// @brief Blends clips of the same skeleton from a tree of nodes driven by parameters.
+///
+/// The tree is evaluated on local poses. The weight of each clip is computed from the parameters first, so each clip with a
+/// non-zero weight is sampled exactly once per frame even when several nodes use it, and the others aren't sampled at all.
+/// The intermediate poses come from a pool which only grows, so evaluating the tree every frame doesn't allocate memory.
+///
+/// The clips are synchronized: they are all sampled at the same normalized time, which advances with the durations of
+/// the clips weighted by their contribution to the base pose.
+class BlendTree
+{
+public:
+    /// @brief Invalid node, clip or parameter.
+    static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+    XNOR_ENGINE BlendTree() = default;
+
+    XNOR_ENGINE ~BlendTree() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(BlendTree)
+
+    /// @brief Adds a parameter.
+    ///
+    /// @param name Name.
+    /// @param value Initial value.
+    /// @return Parameter index.
+    XNOR_ENGINE uint32_t AddParameter(const std::string& name, float_t value = 0.f);
+
+    /// @brief Finds a parameter by name.
+    ///
+    /// @param name Name.
+    /// @return Parameter index, or @ref InvalidIndex.
+    [[nodiscard]]
+    XNOR_ENGINE uint32_t GetParameterIndex(std::string_view name) const;
+
+    /// @brief Sets the value of a parameter.
+    ///
+    /// @param parameter Parameter index.
+    /// @param value Value.
+    XNOR_ENGINE void SetParameter(uint32_t parameter, float_t value);
+
+    /// @brief Gets the value of a parameter.
+    ///
+    /// @param parameter Parameter index.
+    [[nodiscard]]
+    XNOR_ENGINE float_t GetParameter(uint32_t parameter) const;
+
+    /// @brief Adds a node sampling a clip. Nodes of the same animation share its samples.
+    ///
+    /// @param animation Animation.
+    /// @return Node index.
+    XNOR_ENGINE uint32_t AddClip(const Pointer<Animation>& animation);
+
+    /// @brief Adds a node blending its inputs from their position on a line.
+    ///
+    /// @param parameter Parameter giving the position.
+    /// @param inputs Input nodes.
+    /// @param positions Position of each input.
+    /// @return Node index.
+    XNOR_ENGINE uint32_t AddBlend1D(uint32_t parameter, const std::vector<uint32_t>& inputs, const std::vector<float_t>& positions);
+
+    /// @brief Adds a node blending its inputs from their position on a plane, with gradient band interpolation.
+    ///
+    /// @param parameterX Parameter giving the x position.
+    /// @param parameterY Parameter giving the y position.
+    /// @param inputs Input nodes.
+    /// @param positions Position of each input.
+    /// @return Node index.
+    XNOR_ENGINE uint32_t AddBlend2D(uint32_t parameterX, uint32_t parameterY, const std::vector<uint32_t>& inputs, const std::vector<Vector2>& positions);
+
+    /// @brief Adds a node adding the difference between a clip and its first frame on top of a base pose.
+    ///
+    /// @param base Base node.
+    /// @param additive Animation added to the base.
+    /// @param weightParameter Parameter giving the weight of the additive animation.
+    /// @return Node index.
+    XNOR_ENGINE uint32_t AddAdditive(uint32_t base, const Pointer<Animation>& additive, uint32_t weightParameter);
+
+    /// @brief Adds a node blending a layer on top of a base pose with a weight for each bone.
+    ///
+    /// @param base Base node.
+    /// @param layer Layer node.
+    /// @param boneWeights Weight of each bone of the skeleton.
+    /// @param weightParameter Parameter giving the weight of the layer.
+    /// @return Node index.
+    XNOR_ENGINE uint32_t AddMask(uint32_t base, uint32_t layer, const std::vector<float_t>& boneWeights, uint32_t weightParameter);
+
+    /// @brief Creates bone weights selecting a bone and all its descendants, e.g. the upper body from the spine.
+    ///
+    /// @param skeleton Skeleton, with the parents before their children.
+    /// @param rootBone Name of the first bone of the mask.
+    /// @return Weight of each bone.
+    [[nodiscard]]
+    XNOR_ENGINE static std::vector<float_t> CreateBoneMask(const Skeleton& skeleton, std::string_view rootBone);
+
+    /// @brief Sets the node evaluated to the final pose.
+    ///
+    /// @param node Node index.
+    XNOR_ENGINE void SetRoot(uint32_t node);
+
+    /// @brief Binds the clips to their skeleton if needed, which has to be done before evaluating trees on several threads.
+    XNOR_ENGINE void Prepare();
+
+    /// @brief Advances the clips and evaluates the tree.
+    ///
+    /// @param deltaTime Time since the last evaluation.
+    /// @param pose Final pose.
+    /// @param skippedLeafLevels Levels of leaf bones which aren't sampled.
+    /// @return Whether the tree could be evaluated.
+    XNOR_ENGINE bool_t Evaluate(float_t deltaTime, AnimationPose* pose, uint8_t skippedLeafLevels = 0);
+
+    /// @brief Gets the skeleton of the clips.
+    [[nodiscard]]
+    XNOR_ENGINE Pointer<Skeleton> GetSkeleton() const;
+
+    /// @brief Gets the nodes.
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<BlendNode>& GetNodes() const;
+
+    /// @brief Gets the weight of a clip in the final pose of the last evaluation.
+    ///
+    /// @param clip Clip index, as given by BlendNode::clip.
+    [[nodiscard]]
+    XNOR_ENGINE float_t GetClipWeight(uint32_t clip) const;
+
+    /// @brief Gets the number of clips sampled by the last evaluation.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetSampledClipCount() const;
+
+    /// @brief Gets the number of bones sampled by the last evaluation.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetSampledBoneCount() const;
+
+    /// @brief Gets the number of poses of the pool, which is the most intermediate poses a single evaluation needed.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetPoolSize() const;
+
+    /// @brief Gets the time shared by all the clips, between 0 and 1.
+    [[nodiscard]]
+    XNOR_ENGINE float_t GetNormalizedTime() const;
+
+private:
+    struct Parameter
+    {
+        std::string name;
+        float_t value = 0.f;
+    };
+
+    struct Clip
+    {
+        Pointer<Animation> animation;
+        /// @brief Last sampled pose, whose leaf bones skipped by a LOD are still valid
+        AnimationPose pose;
+        /// @brief First frame, which additive clips are relative to
+        AnimationPose reference;
+        /// @brief Weight in the final pose
+        float_t weight = 0.f;
+        /// @brief Weight in the base pose, which drives the time
+        float_t syncWeight = 0.f;
+        bool_t isPoseComplete = false;
+    };
+
+    std::vector<Parameter> m_Parameters;
+    std::vector<Clip> m_Clips;
+    std::vector<BlendNode> m_Nodes;
+    /// @brief Weight of each input of each node, computed from the parameters every evaluation
+    std::vector<std::vector<float_t>> m_InputWeights;
+    uint32_t m_Root = InvalidIndex;
+    float_t m_NormalizedTime = 0.f;
+
+    /// @brief Intermediate poses, a deque keeping them in place when it grows
+    std::deque<AnimationPose> m_PosePool;
+    std::vector<uint32_t> m_FreePoses;
+
+    size_t m_SampledClipCount = 0;
+    size_t m_SampledBoneCount = 0;
+
+    uint32_t AddNode(BlendNode&& node);
+
+    void ComputeInputWeights(uint32_t node);
+
+    void PropagateWeights(uint32_t node, float_t weight, float_t syncWeight);
+
+    // Poses are identified by the index of their clip, or by the clip count plus their index in the pool
+    uint32_t EvaluateNode(uint32_t node);
+
+    uint32_t AcquirePose();
+
+    void ReleasePose(uint32_t pose);
+
+    [[nodiscard]]
+    AnimationPose& GetPose(uint32_t pose);
+};
+
+END_XNOR_CORE
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "core.hpp"
+#include "Maths/matrix.hpp"
+#include "utils/list.hpp"
+
+/// @file bone_palette.hpp
+/// @brief Defines the XnorCore::BonePalette class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Function uploading the matrices of a bone palette to the GPU.
+using BonePaletteUpload = std::function<void(const Matrix* matrices, size_t count)>;
+
+/// @brief Bone palette counters of a frame.
+struct BonePaletteStatistics
+{
+    /// @brief Number of skinned meshes in the palette.
+    uint32_t instanceCount = 0;
+    /// @brief Number of bone matrices in the palette.
+    uint32_t matrixCount = 0;
+    /// @brief Number of times the palette was uploaded.
+    uint32_t uploadCount = 0;
+    /// @brief Number of bytes uploaded.
+    size_t uploadedBytes = 0;
+};
+
+/// @brief Bone matrices of all the skinned meshes of a frame, stored one after another.
+///
+/// Each skinned mesh gets the offset of its first matrix in the palette, which is given to its draws so that the whole
+/// palette is uploaded once to a single storage buffer instead of before every draw. The storage grows with the number of
+/// matrices, so there is no limit to the number of bones of a skeleton.
+///
+/// This class doesn't make any graphics API call.
+class BonePalette
+{
+public:
+    XNOR_ENGINE BonePalette() = default;
+
+    XNOR_ENGINE ~BonePalette() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(BonePalette)
+
+    /// @brief Removes all the matrices to start a new frame, and resets the statistics.
+    XNOR_ENGINE void Clear();
+
+    /// @brief Appends the matrices of a skinned mesh.
+    ///
+    /// @param matrices Bone matrices.
+    /// @return Offset of the first matrix in the palette.
+    XNOR_ENGINE uint32_t Add(const List<Matrix>& matrices);
+
+    /// @brief Uploads all the matrices at once, if there are any.
+    ///
+    /// @param upload Function uploading the matrices.
+    XNOR_ENGINE void Upload(const BonePaletteUpload& upload);
+
+    /// @brief Gets the matrices of the palette.
+    [[nodiscard]]
+    XNOR_ENGINE const Matrix* GetMatrices() const;
+
+    /// @brief Gets the number of matrices in the palette.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetMatrixCount() const;
+
+    /// @brief Gets the counters of the current frame.
+    [[nodiscard]]
+    XNOR_ENGINE const BonePaletteStatistics& GetStatistics() const;
+
+private:
+    /// @brief Storage of the matrices, only growing so that it isn't allocated every frame
+    std::vector<Matrix> m_Matrices;
+    size_t m_MatrixCount = 0;
+    BonePaletteStatistics m_Statistics;
+};
+
+END_XNOR_CORE
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "core.hpp"
+
+/// @file pixel_pack_buffer.hpp
+/// @brief Defines the XnorCore::PixelPackBuffer class
+
+BEGIN_XNOR_CORE
+
+/// @brief Encapsulates a pixel pack buffer, which receives pixels read from a render target without blocking the CPU
+class PixelPackBuffer
+{
+public:
+    PixelPackBuffer();
+    ~PixelPackBuffer();
+
+    DELETE_COPY_MOVE_OPERATIONS(PixelPackBuffer)
+
+    /// @brief Ensures the buffer can hold at least @p size bytes, discarding its data if it needs to grow
+    /// @param size Minimum size
+    void Reserve(size_t size);
+
+    /// @brief Copies the data of the buffer to the CPU
+    /// @param size Data size
+    /// @param output Output pointer
+    void Read(size_t size, void* output) const;
+
+    /// @brief Gets the id of the buffer
+    /// @return Id
+    [[nodiscard]]
+    uint32_t GetId() const;
+
+    /// @brief Gets the allocated size of the buffer
+    /// @return Size
+    [[nodiscard]]
+    size_t GetSize() const;
+    
+private:
+    uint32_t m_Id;
+    size_t m_Size = 0;
+};
+
+END_XNOR_CORE
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "core.hpp"
+
+/// @file shader_storage_buffer.hpp
+/// @brief Defines the XnorCore::ShaderStorageBuffer class
+
+BEGIN_XNOR_CORE
+
+/// @brief Encapsulates a shader storage buffer, which is used to send bulks of data of variable size in shaders
+class ShaderStorageBuffer
+{
+public:
+    ShaderStorageBuffer();
+    ~ShaderStorageBuffer();
+
+    DELETE_COPY_MOVE_OPERATIONS(ShaderStorageBuffer)
+
+    /// @brief Allocates the storage buffer on the GPU, discarding its previous data
+    /// @param size Data size
+    /// @param data Data
+    void Allocate(size_t size, const void* data);
+
+    /// @brief Ensures the storage buffer can hold at least @p size bytes, discarding its data if it needs to grow
+    /// @param size Minimum size
+    void Reserve(size_t size);
+
+    /// @brief Updates the data of the buffer on the GPU
+    /// @param size Data size
+    /// @param offset Data offset
+    /// @param data Data
+    void Update(size_t size, size_t offset, const void* data) const;
+
+    /// @brief Binds the storage buffer
+    /// @param index Index
+    void Bind(uint32_t index) const;
+
+    /// @brief Gets the allocated size of the buffer
+    /// @return Size
+    [[nodiscard]]
+    size_t GetSize() const;
+    
+private:
+    uint32_t m_Id;
+    size_t m_Size = 0;
+};
+
+END_XNOR_CORE
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "core.hpp"
+#include "rendering/rhi_typedef.hpp"
+#include "rendering/buffer/pixel_pack_buffer.hpp"
+
+/// @file gpu_readback.hpp
+/// @brief Defines the XnorCore::GpuReadback class.
+
+BEGIN_XNOR_CORE
+
+class Framebuffer;
+
+/// @brief Function receiving the pixels of a readback, row by row from the bottom one, without padding.
+using GpuReadbackCallback = std::function<void(const std::vector<uint8_t>& data)>;
+
+/// @brief Reads regions of render targets back to the CPU without stalling the pipeline.
+///
+/// A request only queues a copy of the region into a pixel pack buffer, followed by a fence. Update polls the fences of the
+/// pending requests without blocking, and calls the callbacks of the finished ones in the order they were requested, which
+/// usually happens one or two frames later. The pixel pack buffers are reused across requests.
+class GpuReadback
+{
+public:
+    XNOR_ENGINE GpuReadback() = default;
+
+    XNOR_ENGINE ~GpuReadback();
+
+    DELETE_COPY_MOVE_OPERATIONS(GpuReadback)
+
+    /// @brief Queues the readback of a region of a color attachment.
+    ///
+    /// @param frameBuffer Frame buffer to read.
+    /// @param attachmentIndex Color attachment index.
+    /// @param position Bottom left pixel of the region.
+    /// @param size Size of the region.
+    /// @param textureFormat Format of the pixels to read.
+    /// @param dataType Type of the pixels to read.
+    /// @param callback Function receiving the pixels once they reached the CPU.
+    XNOR_ENGINE void Request(
+        const Framebuffer& frameBuffer,
+        uint32_t attachmentIndex,
+        Vector2i position,
+        Vector2i size,
+        TextureFormat::TextureFormat textureFormat,
+        DataType::DataType dataType,
+        GpuReadbackCallback callback
+    );
+
+    /// @brief Calls the callbacks of the finished readbacks, should be called once per frame.
+    XNOR_ENGINE void Update();
+
+    /// @brief Drops the pending readbacks without calling their callbacks.
+    XNOR_ENGINE void Cancel();
+
+    /// @brief Gets the number of readbacks waiting for the GPU.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetPendingCount() const;
+
+private:
+    struct PendingReadback
+    {
+        PixelPackBuffer* buffer = nullptr;
+        void* fence = nullptr;
+        size_t size = 0;
+        GpuReadbackCallback callback;
+    };
+
+    // In request order, so that the callbacks are called in that order too
+    std::vector<PendingReadback> m_Pending;
+    std::vector<PixelPackBuffer*> m_FreeBuffers;
+    std::vector<uint8_t> m_Data;
+};
+
+END_XNOR_CORE
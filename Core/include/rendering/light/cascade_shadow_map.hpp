@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <array>
 #include <vector>
 
 #include "core.hpp"
@@ -13,26 +14,73 @@ BEGIN_XNOR_CORE
 class CascadeShadowMap
 {
 public:
+    /// @brief Number of cascades, the last one going from the last split to the far plane of the camera.
+    static constexpr size_t CascadeCount = DirectionalCascadeLevel + 1;
+
+    /// @brief Steps per world unit the radius of the cascades is rounded up to, so that it stays the same when the camera moves.
+    static constexpr float_t RadiusPrecision = 16.f;
+    
     XNOR_ENGINE CascadeShadowMap() = default;
 
     XNOR_ENGINE ~CascadeShadowMap() = default;
     
     DEFAULT_COPY_MOVE_OPERATIONS(CascadeShadowMap)
 
-    XNOR_ENGINE void GetCascadeCameras(std::vector<Camera>* cameras ,const Camera&  viewPortCamera, Vector3 lightDir, Vector2i screenSize);
+    /// @brief Computes the orthographic camera of each cascade.
+    ///
+    /// Each cascade is fitted to the bounding sphere of its slice of the view frustum, so that its size doesn't change when the
+    /// camera rotates, and its center is moved by whole shadow map texels, so that the shadows don't shimmer when the camera moves.
+    ///
+    /// @param cameras Cameras of the cascades.
+    /// @param viewPortCamera Camera the cascades cover.
+    /// @param lightDir Direction of the light.
+    /// @param screenSize Size of the viewport.
+    /// @param shadowMapResolution Resolution of the shadow map of each cascade.
+    XNOR_ENGINE void GetCascadeCameras(std::vector<Camera>* cameras, const Camera& viewPortCamera, Vector3 lightDir, Vector2i screenSize, int32_t shadowMapResolution);
+
+    /// @brief Lists the casters that can cast a shadow into a cascade, computed by the last call to GetCascadeCameras.
+    ///
+    /// A caster is kept if it overlaps the slice in light space, and lies between the slice and the light.
+    ///
+    /// @param cascade Cascade index.
+    /// @param casters World space AABB of the casters.
+    /// @param cascadeCasters Indices of the casters of the cascade.
+    XNOR_ENGINE void CullCasters(size_t cascade, const std::vector<Bound>& casters, std::vector<uint32_t>* cascadeCasters) const;
+
+    /// @brief Computes the split distances, blending a logarithmic and a uniform distribution between near and far.
+    ///
+    /// @param near Near plane of the camera.
+    /// @param far Far plane of the camera.
+    /// @param lambda Weight of the logarithmic distribution, between 0 (uniform) and 1 (logarithmic).
+    XNOR_ENGINE void ComputeCascadeLevel(float_t near, float_t far, float_t lambda);
     
     XNOR_ENGINE void SetCascadeLevel(const std::array<float, DirectionalCascadeLevel>& cascadeLevel);
 
+    [[nodiscard]]
+    XNOR_ENGINE const std::array<float_t, DirectionalCascadeLevel>& GetCascadeLevel() const;
+
     XNOR_ENGINE void SetZMultiplicator(const float_t zMultiPlicator);
 
 private:
+    // Light space volume of a slice, used to cull the casters
+    struct CascadeVolume
+    {
+        Matrix lightView;
+        Vector3 sliceMin;
+        Vector3 sliceMax;
+        // Light space depth of the near plane of the cascade, towards the light
+        float_t nearDepth = 0.f;
+    };
+    
     std::array<float_t,DirectionalCascadeLevel> m_CascadeLevel;
+
+    std::array<CascadeVolume, CascadeCount> m_CascadeVolumes;
     
     float_t m_ZMultiplicator = 10.f;
     
     XNOR_ENGINE void ComputeFrustumCorner(std::vector<Vector4>* frustumCornerWorldSpace, const Matrix& proj, const Matrix& view);
 
-    XNOR_ENGINE void GetCamera(Camera* cascadedCamera, float_t cascadedNear, float_t cascadedFar, const Camera& baseCamera, Vector3 lightDir, Vector2i screenSize);
+    XNOR_ENGINE void GetCamera(Camera* cascadedCamera, CascadeVolume* volume, float_t cascadedNear, float_t cascadedFar, const Camera& baseCamera, Vector3 lightDir, Vector2i screenSize, int32_t shadowMapResolution);
 
 
 };
@@ -25,6 +25,9 @@ public:
     Vector2 bottomTop = { -50.f, 50.f };
 
     float_t zCascadeShadowMapZMultiplactor = 10.f;
+
+    /// @brief Weight of the logarithmic distribution of the cascade splits, between 0 (uniform) and 1 (logarithmic)
+    float_t cascadeSplitLambda = 0.75f;
     
     XNOR_ENGINE DirectionalLight();
     
@@ -41,4 +44,5 @@ public:
 END_XNOR_CORE
 
 REFL_AUTO(type(XnorCore::DirectionalLight, bases<XnorCore::Light>),
-    field(zCascadeShadowMapZMultiplactor))
+    field(zCascadeShadowMapZMultiplactor),
+    field(cascadeSplitLambda, XnorCore::Reflection::Range(0.f, 1.f)))
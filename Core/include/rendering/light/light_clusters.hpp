@@ -0,0 +1,126 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "core.hpp"
+#include "Maths/matrix.hpp"
+#include "Maths/vector2.hpp"
+#include "Maths/vector3.hpp"
+#include "rendering/rhi_typedef.hpp"
+
+/// @file light_clusters.hpp
+/// @brief Defines the XnorCore::LightClusters class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Bounding sphere of a light, in world space.
+struct LightBounds
+{
+    /// @brief Center of the sphere.
+    Vector3 position;
+    /// @brief Distance after which the light has no effect.
+    float_t radius = 0.f;
+};
+
+/// @brief Assigns lights to the clusters of a view frustum, so that shading a pixel only iterates over the lights of its cluster.
+///
+/// The view frustum is divided into GridSizeX * GridSizeY tiles in screen space, and into GridSizeZ slices distributed
+/// exponentially in view depth. Each light is only tested against the clusters overlapped by the screen space bounds and
+/// the depth range of its bounding sphere. The indices of the lights of every cluster are then stored in a single list,
+/// point light indices followed by spot light indices, ready to be uploaded to the GPU.
+///
+/// This class doesn't make any graphics API call.
+class LightClusters
+{
+public:
+    /// @brief Number of clusters along the X axis.
+    static constexpr uint32_t GridSizeX = 16;
+    /// @brief Number of clusters along the Y axis.
+    static constexpr uint32_t GridSizeY = 9;
+    /// @brief Number of depth slices.
+    static constexpr uint32_t GridSizeZ = 24;
+    /// @brief Total number of clusters.
+    static constexpr uint32_t ClusterCount = GridSizeX * GridSizeY * GridSizeZ;
+
+    XNOR_ENGINE LightClusters() = default;
+
+    XNOR_ENGINE ~LightClusters() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(LightClusters)
+
+    /// @brief Assigns the given lights to the clusters of the frustum defined by @p projection.
+    ///
+    /// @param view View matrix of the camera.
+    /// @param projection Projection matrix of the camera.
+    /// @param near Near plane of the camera.
+    /// @param far Far plane of the camera.
+    /// @param pointLights Bounds of the point lights.
+    /// @param spotLights Bounds of the spot lights.
+    XNOR_ENGINE void Build(
+        const Matrix& view,
+        const Matrix& projection,
+        float_t near,
+        float_t far,
+        const std::vector<LightBounds>& pointLights,
+        const std::vector<LightBounds>& spotLights
+    );
+
+    /// @brief Gets the index of the cluster containing a point, the same way the lighting shaders do.
+    ///
+    /// @param ndc Normalized device coordinates of the point.
+    /// @param viewDepth Distance of the point from the camera along its view direction.
+    [[nodiscard]]
+    XNOR_ENGINE uint32_t GetClusterIndex(Vector2 ndc, float_t viewDepth) const;
+
+    /// @brief Gets the indices of the point lights affecting the given @p cluster.
+    [[nodiscard]]
+    XNOR_ENGINE std::span<const uint32_t> GetPointLights(uint32_t cluster) const;
+
+    /// @brief Gets the indices of the spot lights affecting the given @p cluster.
+    [[nodiscard]]
+    XNOR_ENGINE std::span<const uint32_t> GetSpotLights(uint32_t cluster) const;
+
+    /// @brief Gets the grid parameters to send to the GPU.
+    [[nodiscard]]
+    XNOR_ENGINE const GpuLightClusterGrid& GetGrid() const;
+
+    /// @brief Gets the clusters to send to the GPU.
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<GpuLightCluster>& GetClusters() const;
+
+    /// @brief Gets the light indices of all the clusters to send to the GPU.
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<uint32_t>& GetLightIndices() const;
+
+private:
+    // View space AABB of a cluster
+    struct ClusterBounds
+    {
+        Vector3 min;
+        Vector3 max;
+    };
+
+    // Set on the light index of spot lights in m_Assignments
+    static constexpr uint32_t SpotLightBit = 1u << 31;
+
+    Matrix m_Projection;
+    GpuLightClusterGrid m_Grid;
+    std::vector<ClusterBounds> m_ClusterBounds;
+
+    std::vector<GpuLightCluster> m_Clusters;
+    std::vector<uint32_t> m_LightIndices;
+
+    // Cluster index in the high bits and light index in the low bits, for each light overlapping a cluster
+    std::vector<uint64_t> m_Assignments;
+    std::vector<uint32_t> m_Cursors;
+
+    void ComputeClusterBounds(const Matrix& projection, float_t near, float_t far);
+
+    void AssignLights(const Matrix& view, const Matrix& projection, const std::vector<LightBounds>& lights, uint32_t lightFlag);
+
+    [[nodiscard]]
+    uint32_t GetDepthSlice(float_t viewDepth) const;
+};
+
+END_XNOR_CORE
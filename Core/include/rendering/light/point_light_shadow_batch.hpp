@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+#include "core.hpp"
+#include "Maths/vector3.hpp"
+#include "utils/bound.hpp"
+
+/// @file point_light_shadow_batch.hpp
+/// @brief Defines the XnorCore::PointLightShadowBatch class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Draw of a shadow caster into the cube map of a point light.
+struct PointLightShadowDraw
+{
+    /// @brief Index of the caster in the bounds given to PointLightShadowBatch::Build.
+    uint32_t caster = 0;
+    /// @brief Cube map faces overlapped by the caster, bit @c i corresponding to face @c i in the order +X, -X, +Y, -Y, +Z, -Z.
+    uint32_t faceMask = 0;
+};
+
+/// @brief Lists the draws needed to render the shadow casters of a point light into its 6 cube map faces at once.
+///
+/// The casters are culled once against the sphere of the light, and each remaining caster is tested against the 6 face
+/// frustums to get the mask of the faces it has to be rendered to. A layered render pass then draws each caster a single
+/// time, a geometry shader emitting its triangles to the faces of its mask.
+///
+/// This class doesn't make any graphics API call.
+class PointLightShadowBatch
+{
+public:
+    /// @brief Number of cube map faces.
+    static constexpr uint32_t FaceCount = 6;
+    /// @brief Mask of all the cube map faces.
+    static constexpr uint32_t AllFaces = (1u << FaceCount) - 1;
+
+    XNOR_ENGINE PointLightShadowBatch() = default;
+
+    XNOR_ENGINE ~PointLightShadowBatch() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(PointLightShadowBatch)
+
+    /// @brief Lists the draws of the casters overlapping the sphere of a light.
+    ///
+    /// @param lightPosition Position of the light.
+    /// @param radius Distance after which the light doesn't cast shadows.
+    /// @param casters World space AABB of the casters.
+    XNOR_ENGINE void Build(const Vector3& lightPosition, float_t radius, const std::vector<Bound>& casters);
+
+    /// @brief Gets the cube map faces of a light overlapped by a caster, or 0 if the caster is outside of the sphere of the light.
+    ///
+    /// @param lightPosition Position of the light.
+    /// @param radius Distance after which the light doesn't cast shadows.
+    /// @param caster World space AABB of the caster.
+    [[nodiscard]]
+    XNOR_ENGINE static uint32_t GetFaceMask(const Vector3& lightPosition, float_t radius, const Bound& caster);
+
+    /// @brief Gets the draws of the last build.
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<PointLightShadowDraw>& GetDraws() const;
+
+    /// @brief Gets the number of draws the casters of the last build would need if each face was rendered separately.
+    [[nodiscard]]
+    XNOR_ENGINE uint32_t GetFaceDrawCount() const;
+
+private:
+    std::vector<PointLightShadowDraw> m_Draws;
+    uint32_t m_FaceDrawCount = 0;
+};
+
+END_XNOR_CORE
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "core.hpp"
+#include "Maths/vector2i.hpp"
+
+/// @file shadow_atlas.hpp
+/// @brief Defines the XnorCore::ShadowAtlas class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Shadow map requested from a ShadowAtlas.
+struct ShadowAtlasRequest
+{
+    /// @brief Identifies the light across frames.
+    const void* handle = nullptr;
+    /// @brief Wanted resolution of the shadow map in texels, also used as its importance when the atlas is full.
+    float_t resolution = 0.f;
+};
+
+/// @brief Region of a ShadowAtlas given to a shadow map.
+struct ShadowAtlasTile
+{
+    /// @brief Offset of the tile in texels.
+    Vector2i offset;
+    /// @brief Width and height of the tile in texels, or 0 if the shadow map didn't fit in the atlas.
+    int32_t size = 0;
+    /// @brief Whether the tile moved or was resized since the last update, in which case its content is lost.
+    bool_t changed = true;
+};
+
+/// @brief Packs square shadow maps of different resolutions into a single texture of fixed size.
+///
+/// The atlas is a quad-tree: tile sizes are powers of two between the minimum and maximum tile sizes, and each node
+/// is split into 4 children of half its size. The resolution of each tile is the requested one rounded up to a power
+/// of two, with some hysteresis so that it doesn't flicker between two sizes. When the atlas is full, the least
+/// important shadow maps are downgraded first, and don't get any tile if they don't fit even at the minimum size.
+///
+/// Tiles keep their position across updates as long as their size doesn't change. The atlas is only repacked from
+/// scratch when a new tile doesn't fit in the remaining space because of fragmentation.
+///
+/// This class doesn't make any graphics API call.
+class ShadowAtlas
+{
+public:
+    /// @brief Relative change of the requested resolution needed to switch to another tile size.
+    static constexpr float_t Hysteresis = 0.2f;
+
+    /// @brief Creates an atlas.
+    ///
+    /// @param size Width and height of the atlas in texels, must be a power of two.
+    /// @param minTileSize Smallest tile size, must be a power of two.
+    /// @param maxTileSize Largest tile size, must be a power of two no larger than @p size.
+    XNOR_ENGINE ShadowAtlas(int32_t size, int32_t minTileSize, int32_t maxTileSize);
+
+    XNOR_ENGINE ~ShadowAtlas() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(ShadowAtlas)
+
+    /// @brief Assigns a tile to each request. Tiles of the handles missing from @p requests are freed.
+    XNOR_ENGINE void Update(const std::vector<ShadowAtlasRequest>& requests);
+
+    /// @brief Gets the tiles of the last update, in the same order as the requests.
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<ShadowAtlasTile>& GetTiles() const;
+
+    /// @brief Gets the width and height of the atlas in texels.
+    [[nodiscard]]
+    XNOR_ENGINE int32_t GetSize() const;
+
+    /// @brief Gets the fraction of the atlas covered by tiles.
+    [[nodiscard]]
+    XNOR_ENGINE float_t GetOccupancy() const;
+
+    /// @brief Gets the number of times the whole atlas was repacked.
+    [[nodiscard]]
+    XNOR_ENGINE uint32_t GetRepackCount() const;
+
+private:
+    struct Allocation
+    {
+        Vector2i offset;
+        int32_t size = 0;
+    };
+
+    int32_t m_Size = 0;
+    int32_t m_MinTileSize = 0;
+    int32_t m_MaxTileSize = 0;
+
+    std::vector<ShadowAtlasTile> m_Tiles;
+    std::unordered_map<const void*, Allocation> m_Allocations;
+
+    // Free nodes of the quad-tree, indexed by their level, level 0 being the whole atlas
+    std::vector<std::vector<Vector2i>> m_FreeNodes;
+    std::vector<size_t> m_Order;
+
+    uint32_t m_RepackCount = 0;
+
+    [[nodiscard]]
+    int32_t GetTileSize(const ShadowAtlasRequest& request) const;
+
+    [[nodiscard]]
+    size_t GetLevel(int32_t tileSize) const;
+
+    void ClearNodes();
+
+    void ReserveNode(Vector2i offset, int32_t tileSize);
+
+    bool_t AllocateNode(int32_t tileSize, Vector2i* offset);
+};
+
+END_XNOR_CORE
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "core.hpp"
+#include "Maths/matrix.hpp"
+#include "utils/bound.hpp"
+
+/// @file shadow_cache.hpp
+/// @brief Defines the XnorCore::ShadowCache class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Static shadow caster, as seen by a ShadowCache.
+struct ShadowCaster
+{
+    /// @brief Identifies the caster across frames, e.g. its mesh renderer.
+    const void* handle = nullptr;
+    /// @brief Mesh of the caster.
+    const void* mesh = nullptr;
+    /// @brief World matrix of the caster.
+    Matrix transform;
+    /// @brief World space AABB of the caster.
+    Bound bound;
+};
+
+/// @brief Shadow map counters of a frame.
+struct ShadowMapStatistics
+{
+    /// @brief Number of shadow maps whose static casters were drawn again.
+    uint32_t redrawnShadowMaps = 0;
+    /// @brief Number of shadow maps whose static casters were reused from the cache.
+    uint32_t cachedShadowMaps = 0;
+};
+
+/// @brief Keeps track of which shadow map static layers are still valid across frames.
+///
+/// Each shadow map, e.g. a cascade or a cube map face, is a view identified by an index and defined by its view projection
+/// matrix. The static layer of a view has to be drawn again when its view projection changes, or when a static caster
+/// overlapping its frustum is added, removed or modified.
+///
+/// This class doesn't make any graphics API call.
+class ShadowCache
+{
+public:
+    XNOR_ENGINE ShadowCache() = default;
+
+    XNOR_ENGINE ~ShadowCache() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(ShadowCache)
+
+    /// @brief Starts a new frame with the given static casters, and resets the statistics.
+    XNOR_ENGINE void UpdateCasters(const std::vector<ShadowCaster>& casters);
+
+    /// @brief Checks whether the static layer of a view can be reused.
+    ///
+    /// If it can't, the view is considered redrawn with @p viewProjection from now on.
+    ///
+    /// @param view View index.
+    /// @param viewProjection Current view projection matrix of the view.
+    /// @returns @c true if the static layer is still valid, @c false if it has to be drawn again.
+    XNOR_ENGINE bool_t IsValid(uint32_t view, const Matrix& viewProjection);
+
+    /// @brief Invalidates the static layers of @p count views starting at @p view, e.g. when they weren't drawn this frame.
+    XNOR_ENGINE void Invalidate(uint32_t view, uint32_t count = 1);
+
+    /// @brief Gets the counters of the current frame.
+    [[nodiscard]]
+    XNOR_ENGINE const ShadowMapStatistics& GetStatistics() const;
+
+    /// @brief Gets the bounds of the static casters that changed since the last frame.
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<Bound>& GetChangedBounds() const;
+
+private:
+    struct View
+    {
+        Matrix viewProjection;
+        // World space bounds of the view frustum
+        Bound bound;
+        bool_t valid = false;
+    };
+
+    struct CasterState
+    {
+        ShadowCaster caster;
+        uint64_t frame = 0;
+    };
+
+    std::vector<View> m_Views;
+    std::unordered_map<const void*, CasterState> m_Casters;
+    std::vector<Bound> m_ChangedBounds;
+
+    uint64_t m_Frame = 0;
+    ShadowMapStatistics m_Statistics;
+};
+
+END_XNOR_CORE
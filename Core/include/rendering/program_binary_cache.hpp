@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "core.hpp"
+#include "rendering/rhi_typedef.hpp"
+#include "resource/derived_data_cache.hpp"
+
+/// @file program_binary_cache.hpp
+/// @brief Defines the XnorCore::ProgramBinaryCache class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Driver-specific binary of a linked shader program.
+struct ProgramBinary
+{
+    /// @brief Driver-specific format of the binary, as returned by @c glGetProgramBinary.
+    uint32_t format = 0;
+    /// @brief Binary data.
+    std::vector<uint8_t> data;
+};
+
+/// @brief Static class used to store linked shader program binaries on disk so that they don't need to be compiled again.
+///
+/// Binaries are stored in their own DerivedDataPartition, keyed by the source of each shader stage, the preprocessor defines and
+/// the driver. Any change to one of them, including a driver update, therefore results in a cache miss, in which case the program
+/// is compiled from source. A driver can also reject a binary even if the key matches, so loading a cached binary must always
+/// be able to fall back to compiling from source.
+///
+/// This class doesn't make any graphics API call, the Rhi is responsible for getting and setting the binaries.
+class ProgramBinaryCache final
+{
+    STATIC_CLASS(ProgramBinaryCache)
+
+public:
+    /// @brief Version of the binary cache, which must be incremented whenever the key or the serialization format changes.
+    static constexpr uint32_t Version = 2;
+
+    /// @brief Whether cached program binaries are used.
+    XNOR_ENGINE static inline bool_t enabled = true;
+
+    /// @brief Partition of the DerivedDataCache in which the binaries are stored, so that they have their own maximum size.
+    XNOR_ENGINE static inline DerivedDataPartition partition { .name = "program_binaries", .maxSize = 256ull * 1024 * 1024 };
+
+    /// @brief Creates the key of the program made of the given @p shaderCodes, compiled with the given @p defines by the given
+    /// @p driver.
+    ///
+    /// @param shaderCodes Preprocessed source of each shader stage, as given to the driver.
+    /// @param defines Define set the sources were preprocessed with, see ShaderPreprocessor::GetDefines.
+    /// @param driver String identifying the driver, usually made of its vendor, renderer and version strings.
+    [[nodiscard]]
+    XNOR_ENGINE static DerivedDataKey CreateKey(const std::vector<ShaderCode>& shaderCodes, std::string_view defines, std::string_view driver);
+
+    /// @brief Serializes the given @p binary into @p data.
+    XNOR_ENGINE static void Serialize(const ProgramBinary& binary, std::vector<uint8_t>* data);
+
+    /// @brief Deserializes @p size bytes of @p data into @p binary.
+    ///
+    /// @returns @c true if the data is valid, @c false otherwise.
+    XNOR_ENGINE static bool_t Deserialize(const uint8_t* data, size_t size, ProgramBinary* binary);
+
+    /// @brief Tries to get the program binary corresponding to the given @p key.
+    ///
+    /// @returns @c true if the binary was found, @c false otherwise.
+    XNOR_ENGINE static bool_t Get(const DerivedDataKey& key, ProgramBinary* binary);
+
+    /// @brief Stores the given program @p binary.
+    ///
+    /// @returns @c true if the binary was successfully stored, @c false otherwise.
+    XNOR_ENGINE static bool_t Put(const DerivedDataKey& key, const ProgramBinary& binary);
+
+    /// @brief Removes the program binary corresponding to the given @p key, usually because the driver rejected it.
+    XNOR_ENGINE static void Remove(const DerivedDataKey& key);
+};
+
+END_XNOR_CORE
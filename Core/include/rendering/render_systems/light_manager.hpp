@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <array>
 #include <map>
 
 #include "core.hpp"
@@ -9,6 +10,10 @@
 #include "rendering/camera.hpp"
 #include "rendering/frame_buffer.hpp"
 #include "rendering/light/cascade_shadow_map.hpp"
+#include "rendering/light/light_clusters.hpp"
+#include "rendering/light/point_light_shadow_batch.hpp"
+#include "rendering/light/shadow_atlas.hpp"
+#include "rendering/light/shadow_cache.hpp"
 #include "resource/model.hpp"
 #include "resource/shader.hpp"
 #include "resource/texture.hpp"
@@ -20,17 +25,30 @@
 BEGIN_XNOR_CORE
 
 class Renderer;
+class SkinnedMeshRenderer;
 
 /// @brief Handles rendering lights and their gizmos
 class LightManager
 {
 private:
     static constexpr Vector2i DirectionalShadowMapSize = { 4096, 4096 };
-    static constexpr Vector2i SpotLightShadowMapSize = { 1024, 1024 };
+    // Spot light shadow maps share a single atlas, each one getting a tile sized after its coverage of the screen
+    static constexpr int32_t SpotLightShadowAtlasSize = 4096;
+    static constexpr int32_t SpotLightMinShadowMapSize = 128;
+    static constexpr int32_t SpotLightMaxShadowMapSize = 2048;
     static constexpr Vector2i PointLightLightShadowMapSize = { 1024, 1024 };
 
     static constexpr float_t LightThreshold = 30.f;
     static constexpr TextureInternalFormat::TextureInternalFormat ShadowDepthTextureInternalFormat = TextureInternalFormat::DepthComponent32F;
+
+    // Features of the depth_shader and point_light_depth_shader variants
+    static constexpr uint32_t DepthShaderSkinned = 1 << 0;
+
+    // Indices of the shadow maps in m_ShadowCache, one per cascade, spot light and point light cube map face
+    static constexpr uint32_t DirectionalShadowView = 0;
+    static constexpr uint32_t DirectionalShadowViewCount = static_cast<uint32_t>(DirectionalCascadeLevel) + 1;
+    static constexpr uint32_t SpotLightShadowView = DirectionalShadowView + DirectionalShadowViewCount;
+    static constexpr uint32_t PointLightShadowView = SpotLightShadowView + MaxSpotLights;
 public:
     XNOR_ENGINE LightManager() = default;
 
@@ -67,6 +85,10 @@ public:
     /// @brief Binds the shadow map
     XNOR_ENGINE void UnBindShadowMap() const;
 
+    /// @brief Gets the shadow map counters of the last frame
+    [[nodiscard]]
+    XNOR_ENGINE const ShadowMapStatistics& GetShadowMapStatistics() const;
+
 private:
     enum class RenderingLight
     {
@@ -95,6 +117,17 @@ private:
         Pointer<Shader> editorUi;
         Pointer<Mesh> quad;
     };
+
+    // Copy of a shadow map layer to or from its static casters cache
+    struct ShadowMapCopy
+    {
+        const Texture* shadowMap = nullptr;
+        TextureType::TextureType shadowMapType;
+        uint32_t shadowMapLayer = 0;
+        const Texture* cache = nullptr;
+        TextureType::TextureType cacheType;
+        uint32_t cacheLayer = 0;
+    };
     
     GpuLightData* m_GpuLightData = nullptr;
     RenderingLightStruct m_RenderingLightStruct;
@@ -110,28 +143,84 @@ private:
     Framebuffer* m_ShadowFrameBuffer {nullptr};
     Framebuffer* m_ShadowFrameBufferPointLight {nullptr};
 
-    Texture* m_SpotLightShadowMapTextureArray = nullptr;
+    Texture* m_SpotLightShadowAtlas = nullptr;
+    ShadowAtlas m_SpotLightShadowAtlasTiles { SpotLightShadowAtlasSize, SpotLightMinShadowMapSize, SpotLightMaxShadowMapSize };
+    std::vector<ShadowAtlasRequest> m_SpotLightShadowAtlasRequests;
+    // Index of the spot light of each request
+    std::vector<uint32_t> m_SpotLightShadowAtlasLights;
     
     Texture* m_PointLightShadowMapCubemapArrayPixelDistance = nullptr;
-    Texture* m_DepthBufferForPointLightPass = nullptr;
+    // Layered render target of the 6 faces of a point light, copied to its cube map afterwards
+    Texture* m_PointLightLayeredDistance = nullptr;
+    Texture* m_PointLightLayeredDepth = nullptr;
+    PointLightShadowBatch m_PointLightShadowBatch;
+    std::array<Matrix, PointLightShadowBatch::FaceCount> m_PointLightFaceViewProjections;
     Texture* m_DirectionalShadowMaps = nullptr;
 
+    // Shadow maps of the static casters only, the dynamic casters are drawn on top of a copy of them each frame
+    ShadowCache m_ShadowCache;
+    std::vector<ShadowCaster> m_ShadowCasters;
+    std::vector<const StaticMeshRenderer*> m_ShadowCasterRenderers;
+    std::vector<Bound> m_ShadowCasterBounds;
+    bool_t m_HasDynamicShadowCasters = false;
+    bool_t m_HadDynamicShadowCasters = false;
+
+    Texture* m_DirectionalShadowCache = nullptr;
+    Texture* m_SpotLightShadowCache = nullptr;
+    Texture* m_PointLightShadowCache = nullptr;
+    Texture* m_PointLightDepthShadowCache = nullptr;
+    uint32_t m_PointLightShadowCacheCapacity = 0;
+
     mutable std::vector<const PointLight*> m_PointLights;
     mutable std::vector<const SpotLight*> m_SpotLights;
     mutable std::vector<const DirectionalLight*> m_DirectionalLights;
+
+    std::vector<const StaticMeshRenderer*> m_StaticMeshRenderers;
+    std::vector<const SkinnedMeshRenderer*> m_SkinnedMeshRenderers;
     
     CascadeShadowMap m_CascadeShadowMap;
+    std::vector<uint32_t> m_CascadeCasters;
+    std::vector<const StaticMeshRenderer*> m_CascadeCasterRenderers;
+
+    LightClusters m_LightClusters;
+    std::vector<PointLightData> m_PointLightData;
+    std::vector<SpotLightData> m_SpotLightData;
+    std::vector<LightBounds> m_PointLightBounds;
+    std::vector<LightBounds> m_SpotLightBounds;
     
     
-    XNOR_ENGINE void FecthLightInfo() const;
+    XNOR_ENGINE void FecthLightInfo();
+
+    XNOR_ENGINE void ComputeLightClusters(const Viewport& viewport);
 
     XNOR_ENGINE void ComputeShadow(const Scene& scene, const Viewport& viewport, Renderer& renderer);
 
     XNOR_ENGINE void ComputeShadowDirLight(const Scene& scene, const Camera& viewPortCamera, Vector2i viewportSize, Renderer& renderer);
 
-    XNOR_ENGINE void ComputeShadowSpotLight(const Scene& scene, Renderer& renderer);
+    XNOR_ENGINE void ComputeShadowSpotLight(const Scene& scene, const Viewport& viewport, Renderer& renderer);
 
     XNOR_ENGINE void ComputeShadowPointLight(const Scene& scene, Renderer& renderer);
+
+    XNOR_ENGINE void UpdateShadowCasters(const Scene& scene);
+
+    XNOR_ENGINE void ReserveShadowCaches(uint32_t spotLightCount, uint32_t pointLightCount);
+
+    XNOR_ENGINE void DrawShadowMap(
+        const Scene& scene,
+        const Camera& camera,
+        const Matrix& viewProjection,
+        uint32_t view,
+        const RenderPassBeginInfo& renderPassBeginInfo,
+        const Pointer<Shader>& staticShader,
+        const Pointer<Shader>& skinnedShader,
+        std::initializer_list<ShadowMapCopy> copies,
+        Renderer& renderer,
+        const std::vector<const StaticMeshRenderer*>* staticCasters = nullptr
+    );
+    
+    XNOR_ENGINE void DrawPointLightShadowMap(const Scene& scene, uint32_t light, const Vector3& position, uint32_t staticFaceMask, Renderer& renderer);
+
+    XNOR_ENGINE void SetPointLightShadowUniforms(const Shader& shader, const Vector3& position) const;
     
     XNOR_ENGINE void GetDistanceFromCamera(std::map<float_t, GizmoLight>* sortedLight, const Camera& camera) const;
 
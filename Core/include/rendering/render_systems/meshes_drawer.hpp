@@ -1,6 +1,10 @@
 ﻿#pragma once
+#include <unordered_map>
+
 #include "core.hpp"
+#include "rendering/bone_palette.hpp"
 #include "rendering/frustum.hpp"
+#include "rendering/skinned_vertex_cache.hpp"
 
 #include "scene/scene.hpp"
 #include "scene/component/skinned_mesh_renderer.hpp"
@@ -8,20 +12,22 @@
 
 BEGIN_XNOR_CORE
 class Renderer;
+class Viewport;
 
 class MeshesDrawer
 {
 public:
-    XNOR_ENGINE MeshesDrawer();
+    XNOR_ENGINE MeshesDrawer() = default;
 
-    XNOR_ENGINE ~MeshesDrawer();
+    XNOR_ENGINE ~MeshesDrawer() = default;
 
     DEFAULT_COPY_MOVE_OPERATIONS(MeshesDrawer)
 
     XNOR_ENGINE void InitResources();
     void DrawAabb(const Pointer<Mesh> cube) const;
 
-    XNOR_ENGINE void BeginFrame(const Scene& scene, const Renderer& renderer);
+    // Gathers the meshes, uploads the bones of all the skinned meshes once per frame and skins the meshes drawn in many passes of the viewport on the CPU
+    XNOR_ENGINE void BeginFrame(const Scene& scene, const Viewport& viewport, const Renderer& renderer);
     
     XNOR_ENGINE void EndFrame();
     
@@ -34,10 +40,55 @@ public:
 
     XNOR_ENGINE void RenderStaticMeshNonShaded(const Camera& camera, const Frustum& frustum, const Scene& scene) const;
 
+    // Render the given static meshes without culling them
+    XNOR_ENGINE void RenderStaticMeshNonShaded(const std::vector<const StaticMeshRenderer*>& meshRenderers, const Scene& scene) const;
+
+    [[nodiscard]]
+    XNOR_ENGINE const BonePalette& GetBonePalette() const;
+
+    [[nodiscard]]
+    XNOR_ENGINE const SkinnedVertexCache& GetSkinnedVertexCache() const;
 
 
 private:
-    SkinnedMeshGpuData* m_SkinnedMeshGpuData = nullptr;
+    BonePalette m_BonePalette;
+
+    // Offset of the bones of each skinned mesh in the palette
+    std::vector<uint32_t> m_BoneOffsets;
+
+    SkinnedVertexCache m_SkinnedVertexCache;
+
+    // Model drawing the vertices skinned on the CPU, with a dynamic vertex buffer
+    struct CpuSkinnedModel
+    {
+        uint32_t modelId = 0;
+        // Model and indices it was copied from, the copy is created again when the source is reloaded
+        uint32_t sourceModelId = 0;
+        const uint32_t* sourceIndices = nullptr;
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        uint64_t lastUsedFrame = 0;
+    };
+
+    // CPU skinned models of each model of a mesh, reused every frame by its instances in order
+    std::unordered_map<const Model*, std::vector<CpuSkinnedModel>> m_CpuSkinnedModels;
+    std::unordered_map<const Model*, size_t> m_CpuSkinnedModelUses;
+    // Frame and scene of the last upload of the bone palette and release of the CPU skinned models which weren't used
+    uint64_t m_PreparedFrame = 0;
+    const Scene* m_PreparedScene = nullptr;
+    // CPU skinned model of each instance of the skinned vertex cache
+    std::vector<uint32_t> m_CpuSkinnedInstanceModels;
+
+    // Model drawn for each model of each skinned mesh
+    std::vector<uint32_t> m_SkinnedModelIds;
+    // Index of the first model of each skinned mesh in m_SkinnedModelIds
+    std::vector<uint32_t> m_FirstSkinnedModels;
+    // Whether each skinned mesh is skinned on the CPU
+    std::vector<bool_t> m_IsCpuSkinned;
+
+    // Number of passes which drew the skinned meshes in each viewport, since the beginning of its frame
+    mutable std::unordered_map<const Viewport*, uint32_t> m_SkinnedPassCounts;
+    const Viewport* m_Viewport = nullptr;
 
     Pointer<Shader> m_SkinnedShader;
 
@@ -50,6 +101,17 @@ private:
 
 
     XNOR_ENGINE void PrepareOctree(const Scene& scene);
+
+    XNOR_ENGINE void UploadBonePalette();
+
+    XNOR_ENGINE void PrepareSkinnedMeshes(uint32_t passCount, uint64_t frame);
+
+    XNOR_ENGINE uint32_t AcquireCpuSkinnedModel(const Model& model, uint64_t frame);
+
+    // Destroys the CPU skinned models which weren't used during the last frame
+    XNOR_ENGINE void ReleaseUnusedCpuSkinnedModels(uint64_t frame);
+
+    XNOR_ENGINE void SetSkinnedModelData(size_t skinnedMesh, ModelUniformData* modelData) const;
     
 };
 
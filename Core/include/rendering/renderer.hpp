@@ -26,6 +26,17 @@ class StaticMeshRenderer;
 class Renderer
 {
 public:
+    /// @brief Meshes drawn by a non shaded pass
+    enum class MeshFilter
+    {
+        /// @brief Static and skinned meshes
+        All,
+        /// @brief Only static meshes
+        Static,
+        /// @brief Only skinned meshes
+        Skinned
+    };
+
     /// @brief Clear color
     Vector4 clearColor = Vector4(0.f);
     
@@ -71,8 +82,11 @@ public:
     /// @param shaderToUseStatic Shader to use
     /// @param scene Scene to render
     /// @param drawEditorUi Whether to draw the editor only UI
+    /// @param meshFilter Meshes to draw
+    /// @param staticMeshes Static meshes to draw instead of the ones in the frustum of the camera, if not null
     XNOR_ENGINE void RenderNonShadedPass(const Scene& scene, const Camera& cameraData, const RenderPassBeginInfo& renderPassBeginInfo, const RenderPass& renderPass,
-                                         const Pointer<Shader>& shaderToUseStatic, const Pointer<Shader>& shaderToUseSkinned, bool_t drawEditorUi);
+                                         const Pointer<Shader>& shaderToUseStatic, const Pointer<Shader>& shaderToUseSkinned, bool_t drawEditorUi,
+                                         MeshFilter meshFilter = MeshFilter::All, const std::vector<const StaticMeshRenderer*>* staticMeshes = nullptr);
 
     /// @brief Renders a scene without shading
     /// @param cameraData Camera
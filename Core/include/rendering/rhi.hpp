@@ -1,12 +1,15 @@
 #pragma once
 
 #include <map>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 #include "material.hpp"
 #include "rhi_typedef.hpp"
+#include "uniform_table.hpp"
 #include "vertex.hpp"
+#include "buffer/shader_storage_buffer.hpp"
 #include "buffer/uniform_buffer.hpp"
 #include "render_systems/skybox_parser.hpp"
 
@@ -15,6 +18,8 @@
 
 BEGIN_XNOR_CORE
 
+struct DerivedDataKey;
+
 /// @brief Stands for Render Hardware Interface, provides a set of functions that interface between the application and the rendering API
 class Rhi
 {
@@ -44,9 +49,16 @@ public:
 	/// @brief Creates a model
 	/// @param vertices Model vertices
 	/// @param indices Model indices
+	/// @param vertexUsage Usage of the vertex buffer, dynamic if the vertices are updated every frame
 	/// @return Model id
 	[[nodiscard]]
-	XNOR_ENGINE static uint32_t CreateModel(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+	XNOR_ENGINE static uint32_t CreateModel(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, BufferUsage vertexUsage = BufferUsage::StaticDraw);
+
+	/// @brief Updates the vertices of a model
+	/// @param modelId Model id
+	/// @param vertices Vertices
+	/// @param count Number of vertices, at most the number the model was created with
+	XNOR_ENGINE static void UpdateModelVertices(uint32_t modelId, const Vertex* vertices, size_t count);
 
 	/// @brief Destroys a model
 	/// @param modelId Model id
@@ -64,7 +76,7 @@ public:
 	/// @param shaderId Shader id
 	XNOR_ENGINE static void DestroyProgram(uint32_t shaderId);
 
-	XNOR_ENGINE static uint32_t ReloadProgram(uint32_t oldShaderId, const std::vector<ShaderCode>& shaderCodes);
+	XNOR_ENGINE static uint32_t ReloadProgram(uint32_t oldShaderId, const std::vector<ShaderCode>& shaderCodes, std::string_view defines = "");
 
 	/// @brief Checks for compilation errors for shaders
 	/// @param shaderId Shader id
@@ -74,9 +86,10 @@ public:
 	/// @brief Creates a shader program using multiple shaders
 	/// @param shaderCodes Shader codes
 	/// @param shaderCreateInfo Create info
+	/// @param defines Define set the shader codes were preprocessed with, used to key the cached program binary
 	/// @return Shader id
 	[[nodiscard]]
-	XNOR_ENGINE static uint32_t CreateShaders(const std::vector<ShaderCode>& shaderCodes, const ShaderCreateInfo& shaderCreateInfo);
+	XNOR_ENGINE static uint32_t CreateShaders(const std::vector<ShaderCode>& shaderCodes, const ShaderCreateInfo& shaderCreateInfo, std::string_view defines = "");
 
 	/// @brief Binds a shader for use
 	/// @param shaderId Shader id
@@ -92,6 +105,15 @@ public:
 	/// @param uniformKey Uniform variable name
 	XNOR_ENGINE static void SetUniform(UniformType::UniformType uniformType, const void* data, uint32_t shaderId, const char_t* uniformKey);
 
+	/// @brief Sets a uniform variable in a shader without hashing its name, see UniformHandle
+	/// @param uniformType Uniform type
+	/// @param data Pointer to data
+	/// @param shaderId Shader id
+	/// @param uniformHash Uniform variable name hash
+	/// @param uniformCheckHash Uniform variable name second hash, see HashUniformNameCheck
+	/// @param uniformKey Uniform variable name, only used if the uniform wasn't reflected when the shader was linked
+	XNOR_ENGINE static void SetUniform(UniformType::UniformType uniformType, const void* data, uint32_t shaderId, uint32_t uniformHash, uint32_t uniformCheckHash, const char_t* uniformKey);
+
 	/// @brief Creates a texture
 	/// @brief textureCreateInfo Texture creation info
 	/// @returns Texture id
@@ -134,6 +156,18 @@ public:
 	XNOR_ENGINE static void BlitFrameBuffer(uint32_t readBuffer, uint32_t targetBuffer, Vector2i srcTopLeft, Vector2i srcBottomRight,
 		Vector2i targetTopLeft, Vector2i targetBottomRight, BufferFlag::BufferFlag bufferFlag, TextureFiltering::TextureFiltering textureFiltering);
 
+	/// @brief Copies a region of a layer of a texture to the same region of a layer of another texture with a compatible internal format
+	/// @param sourceId Source texture id
+	/// @param sourceType Source texture type
+	/// @param sourceLayer Source layer, or cube map face of a cube map array
+	/// @param targetId Target texture id
+	/// @param targetType Target texture type
+	/// @param targetLayer Target layer, or cube map face of a cube map array
+	/// @param offset Offset of the copied region
+	/// @param size Size of the copied region
+	XNOR_ENGINE static void CopyTextureLayer(uint32_t sourceId, TextureType::TextureType sourceType, uint32_t sourceLayer,
+		uint32_t targetId, TextureType::TextureType targetType, uint32_t targetLayer, Vector2i offset, Vector2i size);
+
 	/// @brief Binds a framebuffer
 	/// @param frameBufferId Framebuffer id
 	XNOR_ENGINE static void BindFrameBuffer(uint32_t frameBufferId);
@@ -177,6 +211,46 @@ public:
 	/// @param output Output pointer
 	XNOR_ENGINE static void GetPixelFromAttachement(uint32_t attachmentIndex, Vector2i position, TextureFormat::TextureFormat textureFormat, DataType::DataType dataType, void* output);
 
+	/// @brief Starts copying a region of an attachment to a pixel pack buffer, without waiting for the copy to be done
+	/// @param frameBufferId Frame buffer id
+	/// @param attachmentIndex Color attachment index
+	/// @param position Bottom left pixel of the region
+	/// @param size Size of the region
+	/// @param textureFormat Texture format
+	/// @param dataType Data type
+	/// @param bufferId Pixel pack buffer id
+	XNOR_ENGINE static void ReadPixelsToBuffer(
+		uint32_t frameBufferId,
+		uint32_t attachmentIndex,
+		Vector2i position,
+		Vector2i size,
+		TextureFormat::TextureFormat textureFormat,
+		DataType::DataType dataType,
+		uint32_t bufferId
+	);
+
+	/// @brief Inserts a fence after the commands issued so far
+	/// @return Fence
+	[[nodiscard]]
+	XNOR_ENGINE static void* CreateFence();
+
+	/// @brief Checks whether the commands issued before a fence are done, without blocking
+	/// @param fence Fence
+	/// @return Whether the fence is signaled
+	[[nodiscard]]
+	XNOR_ENGINE static bool_t IsFenceSignaled(void* fence);
+
+	/// @brief Destroys a fence
+	/// @param fence Fence
+	XNOR_ENGINE static void DestroyFence(void* fence);
+
+	/// @brief Gets the size of a pixel
+	/// @param textureFormat Texture format
+	/// @param dataType Data type
+	/// @return Size in bytes
+	[[nodiscard]]
+	XNOR_ENGINE static size_t GetPixelSize(TextureFormat::TextureFormat textureFormat, DataType::DataType dataType);
+
 	/// @brief Swaps the front and back buffer
 	XNOR_ENGINE static void SwapBuffers();
 
@@ -205,13 +279,25 @@ public:
 	/// @param cameraUniformData Data
 	XNOR_ENGINE static void UpdateCameraUniform(const CameraUniformData& cameraUniformData);
 
-	/// @brief Updates the animation UniformBuffer
-	/// @param skinnedMeshGPUData Data
-	XNOR_ENGINE static void UpdateAnimationUniform(const SkinnedMeshGpuData& skinnedMeshGPUData);
+	/// @brief Updates the bone palette ShaderStorageBuffer
+	/// @param matrices Bone matrices of all the skinned meshes
+	/// @param count Number of matrices
+	XNOR_ENGINE static void UpdateBonePalette(const Matrix* matrices, size_t count);
 
 	/// @brief Updates the light UniformBuffer
 	/// @param lightData Data
 	XNOR_ENGINE static void UpdateLight(const GpuLightData& lightData);
+
+	/// @brief Updates the point and spot light ShaderStorageBuffers
+	/// @param pointLights Point lights
+	/// @param spotLights Spot lights
+	XNOR_ENGINE static void UpdateLightStorage(const std::vector<PointLightData>& pointLights, const std::vector<SpotLightData>& spotLights);
+
+	/// @brief Updates the light cluster ShaderStorageBuffers
+	/// @param grid Grid parameters
+	/// @param clusters Clusters
+	/// @param lightIndices Light indices of all the clusters
+	XNOR_ENGINE static void UpdateLightClusters(const GpuLightClusterGrid& grid, const std::vector<GpuLightCluster>& clusters, const std::vector<uint32_t>& lightIndices);
 	
 	/// @brief Binds a Material
 	/// @param material Material
@@ -307,14 +393,19 @@ private:
 		DepthFunction::DepthFunction depthFunction{};
 		BlendFunction blendFunction;
 		ShaderProgramCullInfo cullInfo;
-		std::unordered_map<std::string, GpuUniform> uniformMap;
+		UniformTable uniforms;
 	};
 
 	XNOR_ENGINE static inline UniformBuffer* m_CameraUniform = nullptr;
 	XNOR_ENGINE static inline UniformBuffer* m_ModelUniform = nullptr;
 	XNOR_ENGINE static inline UniformBuffer* m_LightUniform = nullptr;
 	XNOR_ENGINE static inline UniformBuffer* m_MaterialUniform = nullptr;
-	XNOR_ENGINE static inline UniformBuffer* m_AnimationBuffer = nullptr;
+
+	XNOR_ENGINE static inline ShaderStorageBuffer* m_BonePaletteStorage = nullptr;
+	XNOR_ENGINE static inline ShaderStorageBuffer* m_PointLightStorage = nullptr;
+	XNOR_ENGINE static inline ShaderStorageBuffer* m_SpotLightStorage = nullptr;
+	XNOR_ENGINE static inline ShaderStorageBuffer* m_LightClusterStorage = nullptr;
+	XNOR_ENGINE static inline ShaderStorageBuffer* m_LightIndexStorage = nullptr;
 	
 	XNOR_ENGINE static inline bool_t m_Blending = false;
 	
@@ -328,11 +419,27 @@ private:
 	
 	XNOR_ENGINE static inline std::unordered_map<uint32_t, ModelInternal> m_ModelMap;
 
+	XNOR_ENGINE static inline bool_t m_ProgramBinarySupported = false;
+
+	// Identifies the driver in the ProgramBinaryCache keys
+	XNOR_ENGINE static inline std::string m_DriverString;
+
 	XNOR_ENGINE static void LogComputeShaderInfo();
+
+	XNOR_ENGINE static void InitializeProgramBinaries();
+
+	XNOR_ENGINE static void CompileProgram(uint32_t programId, const std::vector<ShaderCode>& shaderCodes);
+
+	// Returns false if there is no valid cached binary, in which case the program must be compiled from source
+	XNOR_ENGINE static bool_t LoadProgramBinary(uint32_t programId, const DerivedDataKey& key);
+
+	XNOR_ENGINE static void StoreProgramBinary(uint32_t programId, const DerivedDataKey& key);
 	
 	XNOR_ENGINE static void IsShaderValid(uint32_t shaderId);
 	
-	XNOR_ENGINE static GpuUniform& GetUniformInMap(uint32_t shaderId, const char_t* uniformKey, UniformType::UniformType type);
+	XNOR_ENGINE static UniformTableEntry& GetUniformInMap(uint32_t shaderId, uint32_t uniformHash, uint32_t uniformCheckHash, const char_t* uniformKey);
+
+	XNOR_ENGINE static void ReflectUniforms(uint32_t programId, UniformTable* uniforms);
 	
 	// Texture 
 	XNOR_ENGINE static uint32_t CreateTextureId(TextureType::TextureType textureType);
@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 #include <Maths/matrix.hpp>
@@ -16,15 +18,13 @@ BEGIN_XNOR_CORE
 
 class Framebuffer;
 
-/// @brief Maximum amount of spot lights that can exists in a same scene
+/// @brief Maximum amount of spot lights that can cast shadows in a same scene
 static constexpr uint32_t MaxSpotLights = 50;
-/// @brief Maximum amount of point lights that can exists in a same scene
+/// @brief Maximum amount of point lights that can cast shadows in a same scene
 static constexpr uint32_t MaxPointLights = 50;
 /// @brief Maximum amount of directional lights that can exists in a same scene
 static constexpr uint32_t MaxDirectionalLights = 1;
 
-static constexpr uint32_t MaxBones = 100;
-
 static constexpr size_t DirectionalCascadeLevelAllocation = 12;
 static constexpr size_t DirectionalCascadeLevel = 4;
 
@@ -366,6 +366,11 @@ struct ModelUniformData
 	Matrix normalInvertMatrix = Matrix::Identity();
 
 	uint64_t meshRenderIndex = 0;
+
+	/// @brief Offset of the first bone matrix of the skinned mesh in the bone palette
+	uint32_t boneOffset = 0;
+	/// @brief Number of bone matrices of the skinned mesh, the vertices of the other bones aren't skinned
+	uint32_t boneCount = 0;
 };
 
 /// @brief Uniform type for Shader
@@ -407,6 +412,69 @@ struct GpuUniform
 	} data = {};
 };
 
+#ifndef SWIG
+/// @brief Hashes the name of a shader uniform, see UniformHandle
+/// @param name Uniform name
+/// @return Hash
+[[nodiscard]]
+constexpr uint32_t HashUniformName(const std::string_view name)
+{
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+	for (const char_t c : name)
+	{
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/// @brief Second hash of the name of a shader uniform, used to tell apart names with the same HashUniformName
+/// @param name Uniform name
+/// @return Hash
+[[nodiscard]]
+constexpr uint32_t HashUniformNameCheck(const std::string_view name)
+{
+	// djb2
+	uint32_t hash = 5381u;
+	for (const char_t c : name)
+		hash = hash * 33u + static_cast<uint8_t>(c);
+	return hash;
+}
+
+/// @brief Typed handle to a shader uniform
+///
+/// The uniform name is hashed when the handle is created, which happens at compile time for @c static @c constexpr handles, so
+/// setting a uniform using a handle doesn't involve any string operation or allocation.
+///
+/// @tparam T Uniform type
+template <typename T>
+struct UniformHandle
+{
+	static_assert(
+		std::is_same_v<T, int32_t> || std::is_same_v<T, bool_t> || std::is_same_v<T, float_t> || std::is_same_v<T, Vector2> ||
+		std::is_same_v<T, Vector3> || std::is_same_v<T, Vector4> || std::is_same_v<T, Matrix>,
+		"Unsupported uniform type"
+	);
+
+	/// @brief Hash of the uniform name
+	uint32_t hash = 0;
+	/// @brief Second hash of the uniform name, see HashUniformNameCheck
+	uint32_t checkHash = 0;
+	/// @brief Uniform name, only used for uniforms that weren't found when the shader was linked, e.g. array elements
+	const char_t* name = nullptr;
+
+	/// @brief Creates a handle to the uniform with the given name
+	/// @param name Uniform name, must outlive the handle
+	constexpr explicit UniformHandle(const char_t* const name)
+		: hash(HashUniformName(name))
+		, checkHash(HashUniformNameCheck(name))
+		, name(name)
+	{
+	}
+};
+#endif
+
 /// @brief Depth function
 BEGIN_ENUM(DepthFunction)
 {
@@ -511,7 +579,7 @@ struct ShaderCreateInfo
 #pragma warning(push)
 #pragma warning(disable : 4324)
 
-/// @brief Point light UniformBuffer data
+/// @brief Point light ShaderStorageBuffer data
 struct ALIGNAS(16) PointLightData
 {
 	/// @brief Color
@@ -526,7 +594,7 @@ struct ALIGNAS(16) PointLightData
 	int32_t isCastingShadow = 0;
 };
 
-/// @brief Spot light UniformBuffer data
+/// @brief Spot light ShaderStorageBuffer data
 struct ALIGNAS(16) SpotLightData
 {
 	/// @brief Color
@@ -544,6 +612,8 @@ struct ALIGNAS(16) SpotLightData
 	
 	/// @brief CastShadow
 	int32_t isCastingShadow = 0;
+	/// @brief Distance after which the light has no effect
+	float_t range{};
 };
 
 /// @brief Directional light UniformBuffer data
@@ -572,16 +642,15 @@ struct ALIGNAS(16) GpuLightData
 	/// @brief Number of active spot lights
 	uint32_t nbrOfSpotLight{};
 	
-	/// @brief Point light data
-	PointLightData pointLightData[MaxPointLights];
-	/// @brief Spot light data
-	SpotLightData spotLightData[MaxSpotLights];
 	/// @brief Directional light data
 	DirectionalLightData directionalData[MaxDirectionalLights];
 	
 	/// @brief LightSpaceMatrix for shadowMapping
 	Matrix spotLightSpaceMatrix[MaxSpotLights];
 
+	/// @brief Tile of each spot light in the shadow atlas, offset in XY and size in ZW, in texture coordinates
+	Vector4 spotLightShadowAtlasRect[MaxSpotLights];
+
 	/// @brief Light space matrix
 	Matrix dirLightSpaceMatrix[DirectionalCascadeLevelAllocation];
 	
@@ -589,10 +658,39 @@ struct ALIGNAS(16) GpuLightData
 	uint32_t nbrOfDirLight{};
 };
 
-/// @brief UniformBuffer data for animation
-struct ALIGNAS(16) SkinnedMeshGpuData
-{
-	Matrix boneMatrices[MaxBones];
+/// @brief Header of the light cluster ShaderStorageBuffer
+struct GpuLightClusterGrid
+{
+	/// @brief Number of clusters along the X axis
+	uint32_t sizeX{};
+	/// @brief Number of clusters along the Y axis
+	uint32_t sizeY{};
+	/// @brief Number of depth slices
+	uint32_t sizeZ{};
+	/// @brief Padding
+	uint32_t padding{};
+
+	/// @brief Scale applied to the logarithm of the view depth to get the depth slice
+	float_t depthScale{};
+	/// @brief Bias added to the scaled logarithm of the view depth to get the depth slice
+	float_t depthBias{};
+	/// @brief Near plane
+	float_t near{};
+	/// @brief Far plane
+	float_t far{};
+};
+
+/// @brief Light cluster ShaderStorageBuffer data
+struct GpuLightCluster
+{
+	/// @brief Index of the first light index of the cluster, point light indices being followed by spot light indices
+	uint32_t offset{};
+	/// @brief Number of point lights affecting the cluster
+	uint32_t pointLightCount{};
+	/// @brief Number of spot lights affecting the cluster
+	uint32_t spotLightCount{};
+	/// @brief Padding
+	uint32_t padding{};
 };
 
 #pragma warning(pop) // 4324
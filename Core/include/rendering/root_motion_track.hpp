@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+
+#include "core.hpp"
+#include "Maths/quaternion.hpp"
+#include "Maths/vector3.hpp"
+
+/// @file root_motion_track.hpp
+/// @brief Defines the XnorCore::RootMotionTrack class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Movement of the root bone of an animation, baked once so that it can be read without sampling a pose.
+///
+/// The root translation and its rotation around the up axis are stored at regular intervals, relative to the start of the
+/// animation. The movement between two times is then the difference of two interpolated samples, plus the movement of a
+/// whole loop for each loop in between.
+class RootMotionTrack
+{
+public:
+    XNOR_ENGINE RootMotionTrack() = default;
+
+    XNOR_ENGINE ~RootMotionTrack() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(RootMotionTrack)
+
+    /// @brief Bakes the track from transforms of the root bone sampled at regular intervals over the animation.
+    ///
+    /// The pose at the end of an animation loops back to its first sample, so the movement of the end of the loop is
+    /// extrapolated from the last two samples instead.
+    ///
+    /// @param translations Root translation of each sample.
+    /// @param rotations Root rotation of each sample.
+    /// @param sampleCount Number of samples, the first one is at the start of the animation and the last one before its end.
+    XNOR_ENGINE void Bake(const Vector3* translations, const Quaternion* rotations, size_t sampleCount);
+
+    /// @brief Removes all the samples.
+    XNOR_ENGINE void Clear();
+
+    /// @brief Gets the movement of the root between two times.
+    ///
+    /// @param normalizedTime Start time, between 0 and 1.
+    /// @param normalizedDelta Time to move by, in animation durations, which can go over several loops or backward.
+    /// @param translation Translation of the root, in the space of the animation.
+    /// @param yaw Rotation of the root around the up axis, in radians.
+    XNOR_ENGINE void GetDelta(float_t normalizedTime, float_t normalizedDelta, Vector3* translation, float_t* yaw) const;
+
+    /// @brief Gets the translation of the root over a whole loop.
+    [[nodiscard]]
+    XNOR_ENGINE Vector3 GetLoopTranslation() const;
+
+    /// @brief Gets the rotation of the root around the up axis over a whole loop, in radians.
+    [[nodiscard]]
+    XNOR_ENGINE float_t GetLoopYaw() const;
+
+    /// @brief Gets the number of samples.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetSampleCount() const;
+
+    /// @brief Gets the size of the samples, in bytes.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetMemorySize() const;
+
+    /// @brief Gets the rotation around the up axis of a rotation, in radians.
+    ///
+    /// @param rotation Rotation.
+    [[nodiscard]]
+    XNOR_ENGINE static float_t GetYaw(const Quaternion& rotation);
+
+private:
+    struct Sample
+    {
+        Vector3 translation;
+        /// @brief Unwrapped, so it keeps increasing when the root turns more than once
+        float_t yaw = 0.f;
+    };
+
+    std::vector<Sample> m_Samples;
+
+    /// @brief Gets the movement from the start of the animation, @p normalizedTime counting the loops in its integer part
+    void GetOffset(float_t normalizedTime, Vector3* translation, float_t* yaw) const;
+};
+
+END_XNOR_CORE
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core.hpp"
+
+/// @file shader_preprocessor.hpp
+/// @brief Defines the XnorCore::ShaderPreprocessor class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Static class used to create the variants of a shader source from a set of features.
+///
+/// A shader declares up to MaxFeatures feature names, e.g. @c SKINNED or @c POINT_LIGHT, and each variant is identified by
+/// the bitmask of its enabled features, bit @c i corresponding to the feature at index @c i. Preprocessing a source resolves
+/// every conditional directive that only depends on features, i.e. @c \#ifdef, @c \#ifndef, @c \#if and @c \#elif using
+/// @c defined, @c !, @c &&, @c || and integer literals, and removes the inactive branches. The other conditionals are left to
+/// the driver, with the @c defined checks of features replaced by their value. A @c \#define of each feature to either 1 or 0
+/// is then injected after the @c \#version directive, but only if the feature is still referenced, so that the remaining
+/// conditionals compile and variants whose features don't change the source end up with identical outputs.
+///
+/// This class doesn't make any graphics API call.
+class ShaderPreprocessor final
+{
+    STATIC_CLASS(ShaderPreprocessor)
+
+public:
+    /// @brief Maximum number of features of a shader.
+    static constexpr size_t MaxFeatures = 32;
+
+    /// @brief Preprocesses the given @p source with the features of @p enabledFeatures.
+    ///
+    /// @param source Shader source.
+    /// @param features Names of the features of the shader.
+    /// @param enabledFeatures Bitmask of the enabled features.
+    /// @param output Preprocessed source.
+    /// @returns @c true if the source was successfully preprocessed, @c false if it has unbalanced conditionals or a feature
+    /// conditional followed by an @c \#elif that can't be resolved.
+    XNOR_ENGINE static bool_t Preprocess(std::string_view source, const std::vector<std::string>& features, uint32_t enabledFeatures, std::string* output);
+
+    /// @brief Returns the bitmask of the given @p feature, or 0 if it isn't one of @p features.
+    [[nodiscard]]
+    XNOR_ENGINE static uint32_t GetFeatureMask(const std::vector<std::string>& features, std::string_view feature);
+
+    /// @brief Returns a readable name of the variant of @p enabledFeatures, made of its enabled feature names.
+    [[nodiscard]]
+    XNOR_ENGINE static std::string GetVariantName(const std::vector<std::string>& features, uint32_t enabledFeatures);
+
+    /// @brief Returns the define set of the variant of @p enabledFeatures, i.e. a @c \#define of every feature to either 1 or 0,
+    /// in the order of @p features.
+    [[nodiscard]]
+    XNOR_ENGINE static std::string GetDefines(const std::vector<std::string>& features, uint32_t enabledFeatures);
+};
+
+END_XNOR_CORE
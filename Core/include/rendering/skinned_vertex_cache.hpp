@@ -0,0 +1,144 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "core.hpp"
+#include "Maths/matrix.hpp"
+#include "rendering/vertex.hpp"
+#include "utils/list.hpp"
+
+/// @file skinned_vertex_cache.hpp
+/// @brief Defines the XnorCore::SkinnedVertexCache class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Where the vertices of a skinned mesh are skinned.
+enum class SkinningMode : uint8_t
+{
+    /// @brief On the CPU when the mesh is drawn in enough passes.
+    Automatic,
+    /// @brief In the vertex shader of every pass.
+    Gpu,
+    /// @brief Once per frame on the CPU, the passes then draw the skinned vertices as they are.
+    Cpu
+};
+
+/// @brief Function uploading the skinned vertices of an instance to the GPU.
+using SkinnedVertexUpload = std::function<void(uint32_t instance, const Vertex* vertices, size_t count)>;
+
+/// @brief Skinned vertex cache counters of a frame.
+struct SkinnedVertexCacheStatistics
+{
+    /// @brief Number of skinned models in the cache.
+    uint32_t instanceCount = 0;
+    /// @brief Number of skinned vertices.
+    uint32_t vertexCount = 0;
+    /// @brief Number of bytes uploaded.
+    size_t uploadedBytes = 0;
+};
+
+/// @brief Vertices of models skinned on the CPU, stored one after another.
+///
+/// A skinned mesh drawn in many passes, e.g. into the shadow cascades and the faces of point lights, is skinned by the vertex
+/// shader of every pass. Skinning it once per frame on the CPU instead lets all the passes draw the same vertices, and gives
+/// skinned vertices without a GPU, e.g. on a headless server. The instances are skinned in parallel chunks of vertices.
+///
+/// This class doesn't make any graphics API call.
+class SkinnedVertexCache
+{
+public:
+    /// @brief Number of passes from which a mesh in SkinningMode::Automatic is skinned on the CPU.
+    static constexpr uint32_t MinCpuSkinningPassCount = 3;
+
+    /// @brief Number of vertices skinned by a single task.
+    static constexpr size_t ChunkSize = 2048;
+
+    XNOR_ENGINE SkinnedVertexCache() = default;
+
+    XNOR_ENGINE ~SkinnedVertexCache() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(SkinnedVertexCache)
+
+    /// @brief Gets whether a mesh is skinned on the CPU.
+    ///
+    /// @param mode Skinning mode of the mesh.
+    /// @param passCount Number of passes the mesh is drawn in.
+    [[nodiscard]]
+    XNOR_ENGINE static bool_t IsCpuSkinned(SkinningMode mode, uint32_t passCount);
+
+    /// @brief Skins vertices with the matrices of their bones.
+    ///
+    /// The vertices which don't have any bone, or have a bone outside of @p boneMatrices, keep their bind pose.
+    ///
+    /// @param vertices Vertices in bind pose.
+    /// @param count Number of vertices.
+    /// @param boneMatrices Skinning matrix of each bone.
+    /// @param boneCount Number of bones.
+    /// @param result Skinned vertices, with the same texture coordinates and bones.
+    XNOR_ENGINE static void Skin(const Vertex* vertices, size_t count, const Matrix* boneMatrices, size_t boneCount, Vertex* result);
+
+    /// @brief Removes all the instances to start a new frame, and resets the statistics.
+    XNOR_ENGINE void Clear();
+
+    /// @brief Appends a model to skin. The vertices and matrices are read by Skin, and must be kept until then.
+    ///
+    /// @param vertices Vertices in bind pose.
+    /// @param boneMatrices Skinning matrix of each bone.
+    /// @return Instance index.
+    XNOR_ENGINE uint32_t Add(const std::vector<Vertex>& vertices, const List<Matrix>& boneMatrices);
+
+    /// @brief Skins all the instances.
+    ///
+    /// @param parallel Whether to skin the chunks of vertices on several threads.
+    XNOR_ENGINE void Skin(bool_t parallel = true);
+
+    /// @brief Uploads the skinned vertices of each instance.
+    ///
+    /// @param upload Function uploading the vertices.
+    XNOR_ENGINE void Upload(const SkinnedVertexUpload& upload);
+
+    /// @brief Gets the number of instances.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetInstanceCount() const;
+
+    /// @brief Gets the skinned vertices of an instance.
+    ///
+    /// @param instance Instance index.
+    [[nodiscard]]
+    XNOR_ENGINE const Vertex* GetVertices(uint32_t instance) const;
+
+    /// @brief Gets the number of vertices of an instance.
+    ///
+    /// @param instance Instance index.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetVertexCount(uint32_t instance) const;
+
+    /// @brief Gets the counters of the current frame.
+    [[nodiscard]]
+    XNOR_ENGINE const SkinnedVertexCacheStatistics& GetStatistics() const;
+
+private:
+    struct Instance
+    {
+        const std::vector<Vertex>* vertices = nullptr;
+        const List<Matrix>* boneMatrices = nullptr;
+        size_t offset = 0;
+    };
+
+    struct Chunk
+    {
+        uint32_t instance = 0;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    std::vector<Instance> m_Instances;
+    std::vector<Chunk> m_Chunks;
+    /// @brief Skinned vertices, only growing so that they aren't allocated every frame
+    std::vector<Vertex> m_Vertices;
+    size_t m_VertexCount = 0;
+    SkinnedVertexCacheStatistics m_Statistics;
+};
+
+END_XNOR_CORE
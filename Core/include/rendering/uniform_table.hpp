@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "core.hpp"
+#include "rendering/rhi_typedef.hpp"
+
+/// @file uniform_table.hpp
+/// @brief Defines the XnorCore::UniformTable class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Uniform of a shader program stored in a UniformTable.
+struct UniformTableEntry
+{
+    /// @brief Uniform name.
+    std::string name;
+    /// @brief Uniform location and last value.
+    GpuUniform uniform {};
+    /// @brief Whether a value was set, in which case GpuUniform::data and GpuUniform::type are valid.
+    bool_t hasValue = false;
+};
+
+/// @brief Table of the uniforms of a shader program, indexed by two different hashes of their name.
+///
+/// The active uniforms of each program are reflected into a table when it is linked, so that setting a uniform using a
+/// UniformHandle is a binary search in a small array of hashes. The second hash, see HashUniformNameCheck, makes sure that two
+/// names with the same HashUniformName aren't mistaken for one another. Uniforms that weren't reflected, e.g. array elements,
+/// are added the first time they are used.
+class UniformTable
+{
+public:
+    /// @brief Location of the uniforms that don't exist in the program.
+    static constexpr uint32_t InvalidLocation = static_cast<uint32_t>(-1);
+
+    XNOR_ENGINE UniformTable() = default;
+
+    XNOR_ENGINE ~UniformTable() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(UniformTable)
+
+    /// @brief Adds the uniform with the given @p name and @p location.
+    ///
+    /// If a uniform with the same name hashes already exists, it is returned instead, and an error is logged if its name differs.
+    XNOR_ENGINE UniformTableEntry& Add(const std::string& name, uint32_t location);
+
+    /// @brief Finds the uniform whose name hashes are @p hash and @p checkHash, see HashUniformName and HashUniformNameCheck.
+    ///
+    /// @returns The uniform, or @c nullptr if there is no such uniform.
+    [[nodiscard]]
+    XNOR_ENGINE UniformTableEntry* Find(uint32_t hash, uint32_t checkHash);
+
+    /// @brief Finds the uniform whose name hashes are @p hash and @p checkHash, see HashUniformName and HashUniformNameCheck.
+    ///
+    /// @returns The uniform, or @c nullptr if there is no such uniform.
+    [[nodiscard]]
+    XNOR_ENGINE const UniformTableEntry* Find(uint32_t hash, uint32_t checkHash) const;
+
+    /// @brief Returns the number of uniforms.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetCount() const;
+
+    /// @brief Returns the uniforms, sorted by name hashes.
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<UniformTableEntry>& GetEntries() const;
+
+    /// @brief Removes every uniform.
+    XNOR_ENGINE void Clear();
+
+private:
+    // Kept separate from the entries so that the binary search only touches a few cache lines
+    // Hash of each name in the upper 32 bits and its second hash in the lower ones
+    std::vector<uint64_t> m_Keys;
+    std::vector<UniformTableEntry> m_Entries;
+};
+
+END_XNOR_CORE
@@ -6,8 +6,11 @@
 #include "skeleton.hpp"
 #include "assimp/scene.h"
 #include "file/file.hpp"
+#include "rendering/animation_pose.hpp"
 #include "rendering/bone.hpp"
 #include "rendering/rhi_typedef.hpp"
+#include "rendering/root_motion_track.hpp"
+#include "resource/animation_compression.hpp"
 #include "resource/resource.hpp"
 #include "utils/list.hpp"
 
@@ -18,13 +21,13 @@ class Animation final : public Resource
     REFLECTABLE_IMPL(Animation)
     
 public:
-    struct KeyFrame
-    {
-        Vector3 translation;
-        Quaternion rotation;
-        Vector3 scaling;
-        float_t time{};
-    };
+    using KeyFrame = AnimationKeyFrame;
+
+    /// @brief Track of the bones which aren't animated.
+    static constexpr uint32_t InvalidTrack = std::numeric_limits<uint32_t>::max();
+
+    /// @brief Settings used to compress the keys of the animations when they are loaded.
+    XNOR_ENGINE static inline AnimationCompressionSettings compressionSettings;
 
     Pointer<Skeleton> skeleton;
 
@@ -45,8 +48,15 @@ public:
 
     XNOR_ENGINE ~Animation() override = default;
 
+    /// @brief Sets the skeleton of the animation, and finds the track of each of its bones once so the animation can be sampled without looking bones up by name.
+    ///
+    /// @param bindedSkeleton Skeleton.
     XNOR_ENGINE void BindSkeleton(Pointer<Skeleton> bindedSkeleton);
 
+    /// @brief Gets whether the tracks were bound to the current skeleton.
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsBound() const;
+
     /// @copydoc XnorCore::Resource::Load(const uint8_t* buffer, int64_t length)
     XNOR_ENGINE bool_t Load(const uint8_t* buffer, int64_t length) override;
 
@@ -64,14 +74,81 @@ public:
     [[nodiscard]]
     XNOR_ENGINE float_t GetFrameDuration() const;
 
-    XNOR_ENGINE void GetBoneKeyFrame(const Bone& bone, const List<Animation::KeyFrame>** keyFrames) const;
+    /// @brief Samples the compressed keys of a bone.
+    ///
+    /// @param boneIndex Index of the bone in the skeleton.
+    /// @param normalizedTime Time in the animation, between 0 and 1.
+    /// @param translation Translation.
+    /// @param rotation Rotation.
+    /// @param scaling Scale.
+    /// @return Whether the animation has keys for the bone.
+    XNOR_ENGINE bool_t SampleBone(size_t boneIndex, float_t normalizedTime, Vector3* translation, Quaternion* rotation, Vector3* scaling) const;
+
+    /// @brief Samples the compressed keys of all the bones of the skeleton, in the order of the skeleton.
+    ///
+    /// @param normalizedTime Time in the animation, between 0 and 1.
+    /// @param pose Local transform of each bone, resized to the number of bones of the skeleton.
+    /// @param skippedLeafLevels Levels of leaf bones which aren't sampled and keep their previous transform, e.g. 1 to skip the tips of the fingers.
+    /// @return Whether the animation has keys for all the bones.
+    XNOR_ENGINE bool_t SamplePose(float_t normalizedTime, AnimationPose* pose, uint8_t skippedLeafLevels = 0) const;
+
+    /// @brief Puts the root bone of a sampled pose back where it is at the start of the animation, so that the movement of the
+    /// root motion is only applied to the character.
+    ///
+    /// The root keeps its rotations other than around the up axis, and a pose can go through this several times.
+    ///
+    /// @param pose Pose sampled by SamplePose.
+    XNOR_ENGINE void RemoveRootMotion(AnimationPose* pose) const;
+
+    /// @brief Gets the number of bones sampled by SamplePose.
+    ///
+    /// @param skippedLeafLevels Levels of leaf bones which aren't sampled.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetSampledBoneCount(uint8_t skippedLeafLevels) const;
+
+    /// @brief Gets the index of the track of each bone of the skeleton, or @ref InvalidTrack.
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<uint32_t>& GetBoneTracks() const;
+
+    /// @brief Gets the name of the bone animated by each track.
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<std::string>& GetTrackNames() const;
+
+    /// @copydoc XnorCore::Resource::GetMemorySize
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetMemorySize() const override;
+
+    /// @brief Gets the compressed keys of the bones.
+    [[nodiscard]]
+    XNOR_ENGINE const CompressedAnimation& GetCompressedAnimation() const;
+
+    /// @brief Gets the movement of the root bone of the skeleton, baked when the tracks are bound.
+    [[nodiscard]]
+    XNOR_ENGINE const RootMotionTrack& GetRootMotion() const;
 
 private:
     float_t m_Duration;
     float_t m_Framerate;
     float_t m_FrameDuration;
     size_t m_FrameCount;
-    std::unordered_map<std::string, List<KeyFrame>> m_KeyFrames;
+    /// @brief Name of the bone animated by each track of the compressed animation
+    std::vector<std::string> m_TrackNames;
+    /// @brief Index of the track of each bone of the bound skeleton
+    std::vector<uint32_t> m_BoneTracks;
+    /// @brief Number of bones between each bone of the bound skeleton and its deepest descendant, 0 for leaf bones
+    std::vector<uint8_t> m_BoneHeights;
+    /// @brief Skeleton the tracks were bound to
+    const Skeleton* m_BoundSkeleton = nullptr;
+    CompressedAnimation m_CompressedAnimation;
+    RootMotionTrack m_RootMotion;
+    /// @brief Bone moved by the root motion, and its transform at the start of the animation
+    size_t m_RootMotionBone = std::numeric_limits<size_t>::max();
+    Vector3 m_RootMotionStartTranslation;
+    float_t m_RootMotionStartYaw = 0.f;
+
+    XNOR_ENGINE void BindTracks();
+
+    XNOR_ENGINE void BakeRootMotion();
 
 };
 
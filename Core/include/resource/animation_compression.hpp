@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "core.hpp"
+#include "Maths/quaternion.hpp"
+#include "Maths/vector3.hpp"
+#include "utils/list.hpp"
+
+/// @file animation_compression.hpp
+/// @brief Defines the XnorCore::CompressedAnimation class and the types it is built from.
+
+BEGIN_XNOR_CORE
+
+/// @brief Uncompressed key of a bone, the keys of a bone being spread uniformly over its animation.
+struct AnimationKeyFrame
+{
+    Vector3 translation;
+    Quaternion rotation = Quaternion::Identity();
+    Vector3 scaling = Vector3(1.f);
+    float_t time{};
+};
+
+/// @brief Settings of CompressedAnimation::Compress.
+struct AnimationCompressionSettings
+{
+    /// @brief Maximum error introduced by the key reduction, in bone space units.
+    float_t maxError = 1e-3f;
+    /// @brief Distance from the bone at which the rotation and scale errors are measured, like the distance of a skinned vertex.
+    float_t errorDistance = 1.f;
+    /// @brief Whether to remove the keys that can be interpolated from their neighbors within @ref maxError.
+    bool_t reduceKeys = true;
+};
+
+/// @brief Unit quaternion stored on 48 bits with the smallest three method.
+///
+/// The largest component is dropped and recomputed from the 3 others, which are in the [-1/sqrt(2), 1/sqrt(2)] range and stored
+/// on 15 bits each. The index of the dropped component takes 2 more bits.
+struct QuantizedQuaternion
+{
+    std::array<uint16_t, 3> data{};
+
+    /// @brief Quantizes a unit quaternion.
+    [[nodiscard]]
+    XNOR_ENGINE static QuantizedQuaternion Quantize(const Quaternion& quaternion);
+
+    /// @brief Gets the quaternion back, its largest component being positive.
+    [[nodiscard]]
+    XNOR_ENGINE Quaternion Dequantize() const;
+};
+
+/// @brief Vector3 stored on 16 bits per component, relatively to the range of the values of its channel.
+struct QuantizedVector3
+{
+    std::array<uint16_t, 3> data{};
+
+    /// @brief Quantizes a vector in a range.
+    [[nodiscard]]
+    XNOR_ENGINE static QuantizedVector3 Quantize(const Vector3& vector, const Vector3& rangeMin, const Vector3& rangeExtent);
+
+    /// @brief Gets the vector back from its range.
+    [[nodiscard]]
+    XNOR_ENGINE Vector3 Dequantize(const Vector3& rangeMin, const Vector3& rangeExtent) const;
+};
+
+/// @brief Translation, rotation or scale keys of a bone in a CompressedAnimation.
+struct CompressedChannel
+{
+    /// @brief Index of the first key of the channel in the keys of the animation.
+    uint32_t firstKey = 0;
+    /// @brief Number of keys, 1 for a constant channel, or 0 for a channel stripped because it holds the default value.
+    uint32_t keyCount = 0;
+    /// @brief Minimum of the quantization range of a translation or scale channel.
+    Vector3 rangeMin;
+    /// @brief Size of the quantization range of a translation or scale channel.
+    Vector3 rangeExtent;
+};
+
+/// @brief Keys of a bone in a CompressedAnimation.
+struct CompressedTrack
+{
+    /// @brief Number of source keys, spread uniformly over the animation.
+    uint32_t sampleCount = 0;
+    CompressedChannel translation;
+    CompressedChannel rotation;
+    CompressedChannel scaling;
+};
+
+/// @brief Animation keys stored in a compact form.
+///
+/// The compression strips the channels that don't change, quantizes the rotations to 48 bits and the translations and scales
+/// to 48 bits relatively to the range of their channel, and removes the keys that can be interpolated from the ones kept with an
+/// error under a bone space threshold. The remaining keys store the index of their source key on 16 bits.
+///
+/// Sampling interpolates the kept keys like the source keys would be, the last key looping back to the first one.
+class CompressedAnimation
+{
+public:
+    XNOR_ENGINE CompressedAnimation() = default;
+
+    XNOR_ENGINE ~CompressedAnimation() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(CompressedAnimation)
+
+    /// @brief Compresses the keys of a list of bones.
+    ///
+    /// @param tracks Source keys of each bone, there can't be more than 65536 keys per bone.
+    /// @param settings Settings.
+    XNOR_ENGINE void Compress(const std::vector<List<AnimationKeyFrame>>& tracks, const AnimationCompressionSettings& settings = {});
+
+    /// @brief Samples a bone.
+    ///
+    /// @param track Index of the bone in the tracks given to Compress.
+    /// @param normalizedTime Time in the animation, between 0 and 1.
+    /// @param translation Translation.
+    /// @param rotation Rotation.
+    /// @param scaling Scale.
+    XNOR_ENGINE void Sample(size_t track, float_t normalizedTime, Vector3* translation, Quaternion* rotation, Vector3* scaling) const;
+
+    /// @brief Samples source keys the same way Sample does, e.g. to measure the compression error.
+    ///
+    /// @param keyFrames Source keys.
+    /// @param normalizedTime Time in the animation, between 0 and 1.
+    /// @return Interpolated key.
+    [[nodiscard]]
+    XNOR_ENGINE static AnimationKeyFrame Sample(const List<AnimationKeyFrame>& keyFrames, float_t normalizedTime);
+
+    /// @brief Gets the number of tracks.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetTrackCount() const;
+
+    /// @brief Gets the number of keys kept over all the channels.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetKeyCount() const;
+
+    /// @brief Gets the memory used by the compressed keys, in bytes.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetMemorySize() const;
+
+private:
+    std::vector<CompressedTrack> m_Tracks;
+
+    std::vector<uint16_t> m_VectorKeyIndices;
+    std::vector<QuantizedVector3> m_Vectors;
+
+    std::vector<uint16_t> m_RotationKeyIndices;
+    std::vector<QuantizedQuaternion> m_Rotations;
+
+    XNOR_ENGINE void CompressVectors(const std::vector<Vector3>& samples, const Vector3& defaultValue, float_t errorScale, const AnimationCompressionSettings& settings, CompressedChannel* channel);
+
+    XNOR_ENGINE void CompressRotations(const std::vector<Quaternion>& samples, const AnimationCompressionSettings& settings, CompressedChannel* channel);
+
+    [[nodiscard]]
+    XNOR_ENGINE Vector3 SampleVector(const CompressedChannel& channel, uint32_t sampleCount, float_t position, const Vector3& defaultValue) const;
+
+    [[nodiscard]]
+    XNOR_ENGINE Quaternion SampleRotation(const CompressedChannel& channel, uint32_t sampleCount, float_t position) const;
+};
+
+END_XNOR_CORE
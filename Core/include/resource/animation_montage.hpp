@@ -3,6 +3,7 @@
 #include "core.hpp"
 #include "mesh.hpp"
 #include "resource.hpp"
+#include "rendering/animation_event_track.hpp"
 #include "rendering/animator.hpp"
 #include "utils/timeline.hpp"
 
@@ -14,7 +15,7 @@ class AnimationMontage final : public Resource
 {
     REFLECTABLE_IMPL(AnimationMontage)
     
-    using FunctionT = Timeline<>::BeginFunctionT;
+    using FunctionT = AnimationEventTrack::FunctionT;
 
     struct AnimationInfo
     {
@@ -48,13 +49,13 @@ public:
     XNOR_ENGINE bool_t HasEnded() const;
 
     Pointer<Mesh> mesh;
-    bool_t looping;
+    bool_t looping = false;
 
 private:
-    Timeline<> m_NotifiesTimeline;
+    AnimationEventTrack m_Events;
     Timeline<SkinnedMeshRenderer*> m_AnimationTimeline;
 
-    bool_t m_Ended;
+    bool_t m_Ended = false;
 
     XNOR_ENGINE void UpdateTimelineDuration(float_t duration);
 };
@@ -62,7 +63,6 @@ private:
 END_XNOR_CORE
 
 REFL_AUTO(type(XnorCore::AnimationMontage, bases<XnorCore::Resource>, XnorCore::Reflection::OpenEditorWindow("AnimationMontageEditor")),
-    field(m_NotifiesTimeline),
     field(m_AnimationTimeline),
     field(mesh)
 )
@@ -37,6 +37,14 @@ public:
     XNOR_ENGINE void DestroyInInterface() override;
     
     XNOR_ENGINE void Unload() override;
+
+    /// @copydoc XnorCore::Resource::GetInterfaceMemorySize
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetInterfaceMemorySize() const override;
+
+    /// @copydoc XnorCore::Resource::GetMemoryCategory
+    [[nodiscard]]
+    XNOR_ENGINE ENUM_VALUE(ResourceCategory) GetMemoryCategory() const override;
     
     /// @brief Gets the raw data of the texture
     /// @tparam T Type
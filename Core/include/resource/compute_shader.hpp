@@ -95,6 +95,43 @@ public:
 	/// @param value Value
 	XNOR_ENGINE void SetMat4(const std::string& keyName, const Matrix& value) const;
 
+#ifndef SWIG
+	/// @brief Sets an int (signed, 32 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetInt(const UniformHandle<int32_t>& handle, int32_t value) const;
+
+	/// @brief Sets an bool (signed, 32 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetBool(const UniformHandle<bool_t>& handle, bool_t value) const;
+
+	/// @brief Sets an float (32 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetFloat(const UniformHandle<float_t>& handle, float_t value) const;
+
+	/// @brief Sets a @ref Vector2 (2 float, 64 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetVec2(const UniformHandle<Vector2>& handle, const Vector2& value) const;
+
+	/// @brief Sets a @ref Vector3 (3 float, 96 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetVec3(const UniformHandle<Vector3>& handle, const Vector3& value) const;
+
+	/// @brief Sets a @ref Vector4 (4 float, 128 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetVec4(const UniformHandle<Vector4>& handle, const Vector4& value) const;
+
+	/// @brief Sets a @ref Matrix (16 float, 512 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetMat4(const UniformHandle<Matrix>& handle, const Matrix& value) const;
+#endif
+
 	/// @brief Gets the internal id of the shader
 	/// @return Id
 	[[nodiscard]]
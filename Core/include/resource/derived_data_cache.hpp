@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core.hpp"
+
+/// @file derived_data_cache.hpp
+/// @brief Defines the XnorCore::DerivedDataCache class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Identifies a cached artifact derived from a source asset.
+///
+/// Two keys are equal if and only if they were created by the same importer, with the same importer version and settings, from
+/// the same source content. Changing any of them therefore automatically invalidates the previously cached artifact.
+struct DerivedDataKey
+{
+    /// @brief Name of the importer that produced the artifact, e.g. @c "Texture".
+    std::string importer;
+    /// @brief Version of the importer, which must be incremented whenever its output format changes.
+    uint32_t version = 0;
+    /// @brief Hash of the source asset content.
+    uint64_t sourceHash = 0;
+    /// @brief Hash of the importer settings.
+    uint64_t settingsHash = 0;
+};
+
+/// @brief Statistics of the DerivedDataCache.
+struct DerivedDataCacheStats
+{
+    /// @brief Number of artifacts found in the cache.
+    uint64_t hits = 0;
+    /// @brief Number of artifacts that weren't found in the cache.
+    uint64_t misses = 0;
+    /// @brief Number of artifacts written to the cache.
+    uint64_t writes = 0;
+    /// @brief Number of artifacts that failed the integrity check and were removed.
+    uint64_t corruptions = 0;
+    /// @brief Number of artifacts removed to stay under DerivedDataCache::maxSize.
+    uint64_t evictions = 0;
+    /// @brief Current size of the cache directory in bytes, including its partitions.
+    size_t size = 0;
+};
+
+/// @brief Subdirectory of the DerivedDataCache with its own maximum size.
+///
+/// The artifacts of a partition neither evict nor are evicted by the artifacts stored elsewhere in the cache, which keeps
+/// small but numerous artifacts such as program binaries from being pushed out by large imported assets.
+struct DerivedDataPartition
+{
+    /// @brief Name of the subdirectory of DerivedDataCache::directory in which the artifacts are stored.
+    std::string name;
+    /// @brief Maximum size of the partition in bytes.
+    size_t maxSize = 0;
+};
+
+/// @brief Static class used to store the results of expensive import steps on disk.
+///
+/// Importers such as the Texture decoder or the Mesh assimp processing create a DerivedDataKey from their source data and settings
+/// using DerivedDataCache::CreateKey, then try to DerivedDataCache::Get the artifact before doing any work, and DerivedDataCache::Put
+/// their result on a miss.
+///
+/// Each artifact is stored in its own file in DerivedDataCache::directory along with a checksum, so corrupted artifacts are
+/// detected and discarded. When the cache grows past DerivedDataCache::maxSize, the least recently used artifacts are removed.
+/// Artifacts can also be stored in a DerivedDataPartition, which is trimmed on its own.
+///
+/// All functions are thread-safe.
+class DerivedDataCache final
+{
+    STATIC_CLASS(DerivedDataCache)
+
+public:
+    /// @brief File extension of the cached artifacts.
+    static constexpr const char_t* const FileExtension = ".ddc";
+
+    /// @brief Whether the cache is used. If @c false, DerivedDataCache::Get always misses and DerivedDataCache::Put does nothing.
+    XNOR_ENGINE static inline bool_t enabled = true;
+
+    /// @brief Directory in which the artifacts are stored.
+    XNOR_ENGINE static inline std::filesystem::path directory = "cache/derived_data";
+
+    /// @brief Maximum size of the cache directory in bytes, excluding its partitions.
+    XNOR_ENGINE static inline size_t maxSize = 2ull * 1024 * 1024 * 1024;
+
+    /// @brief Computes a 64-bit hash of @p size bytes of @p data.
+    [[nodiscard]]
+    XNOR_ENGINE static uint64_t Hash(const void* data, size_t size, uint64_t seed = 0);
+
+    /// @brief Creates the key of the artifact produced by the given @p importer and @p version from the given source data.
+    ///
+    /// Each of the @p settings is hashed bytewise, so they must be trivially copyable and shouldn't contain any padding.
+    template <typename... Settings>
+    [[nodiscard]]
+    static DerivedDataKey CreateKey(std::string_view importer, uint32_t version, const uint8_t* source, size_t sourceSize, const Settings&... settings);
+
+    /// @brief Returns the file name used to store the artifact corresponding to the given @p key.
+    [[nodiscard]]
+    XNOR_ENGINE static std::string GetKeyString(const DerivedDataKey& key);
+
+    /// @brief Tries to get the artifact corresponding to the given @p key from the given @p partition, or from the rest of the
+    /// cache if it is @c nullptr.
+    ///
+    /// @returns @c true if the artifact was found and is valid, in which case @p data contains it, @c false otherwise.
+    XNOR_ENGINE static bool_t Get(const DerivedDataKey& key, std::vector<uint8_t>* data, const DerivedDataPartition* partition = nullptr);
+
+    /// @brief Stores @p size bytes of @p data as the artifact corresponding to the given @p key in the given @p partition, or in
+    /// the rest of the cache if it is @c nullptr.
+    ///
+    /// @returns @c true if the artifact was successfully written, @c false otherwise.
+    XNOR_ENGINE static bool_t Put(const DerivedDataKey& key, const uint8_t* data, size_t size, const DerivedDataPartition* partition = nullptr);
+
+    /// @brief Removes the artifact corresponding to the given @p key from the given @p partition, or from the rest of the cache
+    /// if it is @c nullptr.
+    XNOR_ENGINE static void Remove(const DerivedDataKey& key, const DerivedDataPartition* partition = nullptr);
+
+    /// @brief Removes every artifact from the cache, including its partitions.
+    XNOR_ENGINE static void Clear();
+
+    /// @brief Returns the statistics of the cache since the start of the program or the last call to ResetStats.
+    [[nodiscard]]
+    XNOR_ENGINE static DerivedDataCacheStats GetStats();
+
+    /// @brief Resets the statistics of the cache.
+    XNOR_ENGINE static void ResetStats();
+
+private:
+    XNOR_ENGINE static inline std::mutex m_Mutex;
+    XNOR_ENGINE static inline DerivedDataCacheStats m_Stats;
+
+    // Size of each directory of artifacts, computed the first time it is needed
+    XNOR_ENGINE static inline std::map<std::filesystem::path, size_t> m_Sizes;
+
+    XNOR_ENGINE static inline std::atomic<uint64_t> m_TemporaryFileCounter;
+
+    [[nodiscard]]
+    XNOR_ENGINE static std::filesystem::path GetDirectory(const DerivedDataPartition* partition);
+
+    [[nodiscard]]
+    XNOR_ENGINE static std::filesystem::path GetPath(const DerivedDataKey& key, const DerivedDataPartition* partition);
+
+    // Must be called with m_Mutex locked
+    [[nodiscard]]
+    XNOR_ENGINE static size_t& GetSize(const std::filesystem::path& artifactDirectory);
+
+    // Must be called with m_Mutex locked, the size is only updated if it was already computed
+    XNOR_ENGINE static void RemoveSize(const std::filesystem::path& artifactDirectory, size_t artifactSize);
+
+    // Must be called with m_Mutex locked
+    XNOR_ENGINE static void Trim(const std::filesystem::path& artifactDirectory, size_t maxArtifactSize);
+};
+
+END_XNOR_CORE
+
+#include "resource/derived_data_cache.inl"
@@ -43,6 +43,14 @@ public:
     
     XNOR_ENGINE void DestroyInInterface() override;
 
+    /// @copydoc XnorCore::Resource::GetInterfaceMemorySize
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetInterfaceMemorySize() const override;
+
+    /// @copydoc XnorCore::Resource::GetMemoryCategory
+    [[nodiscard]]
+    XNOR_ENGINE ENUM_VALUE(ResourceCategory) GetMemoryCategory() const override;
+
     XNOR_ENGINE const Character& GetGlyphByChar(char_t characters) const ;
     
 private:
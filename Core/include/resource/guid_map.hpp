@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core.hpp"
+#include "utils/guid.hpp"
+
+/// @file guid_map.hpp
+/// @brief Defines the XnorCore::GuidMap class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Header found at the very start of a binary GuidMap file.
+struct GuidMapHeader
+{
+    /// @brief Must be equal to GuidMap::Magic.
+    std::array<char_t, 4> magic {};
+    /// @brief Must be equal to GuidMap::Version.
+    uint32_t version = 0;
+    /// @brief Number of records following the header.
+    uint32_t entryCount = 0;
+    /// @brief Unused, keeps the records 8-byte aligned.
+    uint32_t reserved = 0;
+};
+
+/// @brief Bidirectional map between the Guid of each Resource and its name.
+///
+/// Both Guid to name and name to Guid lookups are hash table lookups. Each name is only stored once, the name to Guid table
+/// referencing the strings owned by the Guid to name one.
+///
+/// The binary file format is a GuidMapHeader followed by one record per entry, each made of the raw Guid, the 32-bit length of
+/// the name and the name itself. Loading it therefore doesn't involve any text parsing. Full saves sort the records by name so
+/// that saving the same map twice results in the same file, whereas entries added since the last save or load are simply
+/// appended to the existing file.
+class GuidMap
+{
+public:
+    /// @brief Magic number found at the start of every binary GuidMap file.
+    static constexpr std::array<char_t, 4> Magic { 'X', 'G', 'I', 'D' };
+
+    /// @brief Current version of the binary format.
+    static constexpr uint32_t Version = 1;
+
+    XNOR_ENGINE GuidMap() = default;
+
+    XNOR_ENGINE ~GuidMap() = default;
+
+    DELETE_COPY_MOVE_OPERATIONS(GuidMap)
+
+    /// @brief Loads the binary GuidMap file at the given @p path, replacing the current entries.
+    ///
+    /// @returns @c true if the file was successfully loaded, @c false otherwise.
+    XNOR_ENGINE bool_t Load(const std::filesystem::path& path);
+
+    /// @brief Loads a binary GuidMap from @p size bytes of @p data, replacing the current entries.
+    ///
+    /// @returns @c true if the data was valid, @c false otherwise.
+    XNOR_ENGINE bool_t Load(const uint8_t* data, size_t size);
+
+    /// @brief Loads a GuidMap from the legacy text format, made of one @c name;guid line per entry, replacing the current entries.
+    ///
+    /// @returns @c true if every line was valid, @c false otherwise.
+    XNOR_ENGINE bool_t LoadText(std::string_view text);
+
+    /// @brief Saves the map to the binary GuidMap file at the given @p path.
+    ///
+    /// If the map was last loaded from or saved to this same file, and entries were only added since, they are appended to it
+    /// instead of rewriting the whole file.
+    ///
+    /// @returns @c true if the file was successfully written, @c false otherwise.
+    XNOR_ENGINE bool_t Save(const std::filesystem::path& path);
+
+    /// @brief Converts the text GuidMap file at @p textPath into the binary GuidMap file at @p binaryPath.
+    ///
+    /// @returns @c true if the conversion succeeded, @c false otherwise.
+    XNOR_ENGINE static bool_t ConvertText(const std::filesystem::path& textPath, const std::filesystem::path& binaryPath);
+
+    /// @brief Adds an entry, or changes the name of the entry with the given @p guid if it already exists.
+    ///
+    /// If another entry already uses the given @p name, it is removed.
+    XNOR_ENGINE void Add(const Guid& guid, const std::string& name);
+
+    /// @brief Removes the entry with the given @p guid.
+    ///
+    /// @returns @c true if the entry existed, @c false otherwise.
+    XNOR_ENGINE bool_t Remove(const Guid& guid);
+
+    /// @brief Removes every entry.
+    XNOR_ENGINE void Clear();
+
+    /// @brief Reserves enough space for @p count entries.
+    XNOR_ENGINE void Reserve(size_t count);
+
+    /// @brief Finds the name of the entry with the given @p guid.
+    ///
+    /// @returns The name, or @c nullptr if there is no such entry.
+    [[nodiscard]]
+    XNOR_ENGINE const std::string* Find(const Guid& guid) const;
+
+    /// @brief Finds the Guid of the entry with the given @p name.
+    ///
+    /// @returns The Guid, or Guid::Empty if there is no such entry.
+    [[nodiscard]]
+    XNOR_ENGINE Guid Find(std::string_view name) const;
+
+    /// @brief Returns whether there is an entry with the given @p guid.
+    [[nodiscard]]
+    XNOR_ENGINE bool_t Contains(const Guid& guid) const;
+
+    /// @brief Returns whether there is an entry with the given @p name.
+    [[nodiscard]]
+    XNOR_ENGINE bool_t Contains(std::string_view name) const;
+
+    /// @brief Returns the number of entries.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetCount() const;
+
+    /// @brief Returns the Guid to name table.
+    [[nodiscard]]
+    XNOR_ENGINE const std::unordered_map<Guid, std::string>& GetEntries() const;
+
+private:
+    std::unordered_map<Guid, std::string> m_Names;
+    // Keys point to the strings of m_Names, which are stable as it is node-based
+    std::unordered_map<std::string_view, Guid> m_Guids;
+
+    // File the map was last loaded from or saved to, used for incremental saves
+    std::filesystem::path m_FilePath;
+    uintmax_t m_FileSize = 0;
+    // Entries added since the last load or save
+    std::vector<Guid> m_AddedEntries;
+    // Whether entries were removed or renamed since the last load or save, in which case appending isn't enough
+    bool_t m_RequiresRewrite = true;
+
+    void AddNoCheck(const Guid& guid, std::string&& name);
+
+    bool_t Rewrite(const std::filesystem::path& path);
+
+    bool_t Append(const std::filesystem::path& path);
+};
+
+END_XNOR_CORE
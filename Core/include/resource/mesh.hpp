@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <memory>
+#include <vector>
 
 #include <assimp/mesh.h>
 #include <assimp/scene.h>
@@ -11,9 +13,15 @@
 #include "skeleton.hpp"
 #include "texture.hpp"
 #include "rendering/material.hpp"
+#include "resource/derived_data_cache.hpp"
 #include "resource/resource.hpp"
 #include "utils/list.hpp"
 
+namespace Assimp
+{
+    class Importer;
+}
+
 BEGIN_XNOR_CORE
 
 class Mesh final : public Resource
@@ -48,22 +56,73 @@ public:
     /// @copydoc XnorCore::Resource::Load(const uint8_t* buffer, int64_t length)
     XNOR_ENGINE bool_t Load(const uint8_t* buffer, int64_t length) override;
 
+    /// @brief Reads the processed Models from the DerivedDataCache, or imports the file if they aren't cached.
+    ///
+    /// The Models, Skeletons, Animations and embedded Textures are only registered by FinishDecode.
+    ///
+    /// @returns @c true if the decoding succeeded, @c false otherwise.
+    XNOR_ENGINE bool_t Decode(const uint8_t* buffer, int64_t length) override;
+
+    /// @copydoc XnorCore::Resource::FinishDecode()
+    XNOR_ENGINE bool_t FinishDecode() override;
+
     /// @copydoc XnorCore::Resource::CreateInInterface()
     XNOR_ENGINE void CreateInInterface() override;
 
+    /// @copydoc XnorCore::Resource::DestroyInInterface()
+    XNOR_ENGINE void DestroyInInterface() override;
+
+    /// @copydoc XnorCore::Resource::Unload()
+    XNOR_ENGINE void Unload() override;
+
+    /// @copydoc XnorCore::Resource::GetInterfaceMemorySize
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetInterfaceMemorySize() const override;
+
+    /// @copydoc XnorCore::Resource::GetMemorySize
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetMemorySize() const override;
+
+    /// @copydoc XnorCore::Resource::GetMemoryCategory
+    [[nodiscard]]
+    XNOR_ENGINE ENUM_VALUE(ResourceCategory) GetMemoryCategory() const override;
+
     [[nodiscard]]
     XNOR_ENGINE Pointer<Animation> GetAnimation(size_t id);
 
 private:
+    // Version of the processed data stored in the DerivedDataCache, must be incremented when its layout changes
+    static constexpr uint32_t CacheVersion = 1;
+
     List<Pointer<Animation>> m_Animations;
     List<Pointer<Skeleton>> m_Skeletons;
 
+    // Data staged by Decode, waiting for FinishDecode
+    bool_t m_Decoded = false;
+    DerivedDataKey m_DecodedCacheKey;
+    std::vector<uint8_t> m_DecodedCache;
+    std::shared_ptr<Assimp::Importer> m_DecodedImporter;
+
     static std::string GetTextureFileName(const std::string& textureName,const std::string& textureFormat);
 
     bool_t LoadMesh(const aiScene& scene, Pointer<Skeleton>* outSkeleton);
 
     void LoadTexture(const aiScene& scene);
 
+    // Imports the file with assimp into m_DecodedImporter
+    bool_t Import(const uint8_t* buffer, int64_t length);
+
+    // Registers the sub-resources of an imported scene
+    void LoadScene(const aiScene& scene);
+
+    void ClearDecoded();
+
+    // Loads the Models from the processed data stored in the DerivedDataCache
+    bool_t LoadFromCache(const std::vector<uint8_t>& data);
+
+    // Stores the processed Models in the DerivedDataCache
+    void SaveToCache(const DerivedDataKey& key, const aiScene& scene) const;
+
     void ComputeAabb();
 };
 
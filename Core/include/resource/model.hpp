@@ -5,11 +5,13 @@
 #include <assimp/mesh.h>
 
 #include "core.hpp"
+#include "data_structure/bvh.hpp"
 #include "file/file.hpp"
 #include "refl/refl.hpp"
 #include "rendering/vertex.hpp"
 #include "resource/resource.hpp"
 #include "utils/bound.hpp"
+#include "utils/ray.hpp"
 
 /// @file model.hpp
 /// @brief Defines the XnorCore::Model class.
@@ -97,6 +99,9 @@ public:
     /// @brief Loads a Model from assimp loaded data.
     XNOR_ENGINE bool_t Load(const aiMesh& loadedData);
 
+    /// @brief Loads a Model from already processed vertices and indices, e.g. from the DerivedDataCache.
+    XNOR_ENGINE bool_t Load(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices, const Bound& bound);
+
     /// @copydoc XnorCore::Resource::CreateInInterface
     XNOR_ENGINE void CreateInInterface() override;
 
@@ -108,23 +113,55 @@ public:
 
     XNOR_ENGINE bool_t Save() const override;
 
+    /// @copydoc XnorCore::Resource::GetInterfaceMemorySize
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetInterfaceMemorySize() const override;
+
+    /// @copydoc XnorCore::Resource::GetMemorySize
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetMemorySize() const override;
+
+    /// @copydoc XnorCore::Resource::GetMemoryCategory
+    [[nodiscard]]
+    XNOR_ENGINE ENUM_VALUE(ResourceCategory) GetMemoryCategory() const override;
+
     /// @brief Gets the id of the model
     /// @return Model id
     [[nodiscard]]
     XNOR_ENGINE uint32_t GetId() const;
 
+    /// @brief Finds the closest triangle hit by a ray, using the Bvh built when loading the model.
+    ///
+    /// @param ray Ray, in the space of the model.
+    /// @param distance Distance after which hits are ignored, set to the distance of the hit.
+    /// @return Whether a triangle is hit.
+    XNOR_ENGINE bool_t Raycast(const Ray& ray, float_t* distance) const;
+
 #ifndef SWIG
     /// @brief Gets the vertices of the model
     /// @return Vertices
     [[nodiscard]]
     const std::vector<Vertex>& GetVertices() const;
+
+    /// @brief Gets the indices of the model
+    /// @return Indices
+    [[nodiscard]]
+    const std::vector<uint32_t>& GetIndices() const;
+
+    /// @brief Gets the Bvh over the triangles of the model
+    /// @return Bvh
+    [[nodiscard]]
+    const Bvh& GetBvh() const;
 #endif
     
 private:
     XNOR_ENGINE void ComputeAabb(const aiAABB& assimpAabb);
+
+    XNOR_ENGINE void BuildBvh();
     
     std::vector<Vertex> m_Vertices;
     std::vector<uint32_t> m_Indices;
+    Bvh m_Bvh;
     uint32_t m_ModelId = 0;
     
 };
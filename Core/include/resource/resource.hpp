@@ -12,6 +12,28 @@ BEGIN_XNOR_CORE
 
 class File;
 
+/// @brief Category used to account for the memory of a Resource, see ResourceManager::SetMemoryBudget.
+BEGIN_ENUM(ResourceCategory)
+{
+    /// @brief @ref XnorCore::Texture "Textures".
+    Textures,
+    /// @brief @ref XnorCore::Mesh "Meshes", including their @ref XnorCore::Model "Models".
+    Meshes,
+    /// @brief @ref XnorCore::AudioTrack "AudioTracks".
+    AudioTracks,
+    /// @brief @ref XnorCore::Font "Fonts".
+    Fonts,
+    /// @brief Any other Resource type.
+    Other,
+
+    /// @brief The number of accounted categories.
+    Count,
+
+    /// @brief The Resource isn't accounted for, e.g. because its memory is already accounted for by another Resource.
+    Untracked
+}
+END_ENUM
+
 /// @brief Interface for resources, which encapsulates most objects used in the engine that come from a file
 class Resource
 {
@@ -36,6 +58,22 @@ public:
     /// @returns @c true if the loading succeeded, @c false otherwise.
     XNOR_ENGINE virtual bool_t Load(const Pointer<File>& file);
 
+    /// @brief Decodes data from memory without touching any manager, so that it can be called from any thread.
+    ///
+    /// The decoded data is only staged, FinishDecode must then be called on the main thread to complete the loading.
+    /// The default implementation calls @ref Load(const uint8_t* buffer, int64_t length) "Load", which is enough for
+    /// any Resource that doesn't register other resources or files while loading.
+    ///
+    /// @returns @c true if the decoding succeeded, @c false otherwise.
+    XNOR_ENGINE virtual bool_t Decode(const uint8_t* buffer, int64_t length);
+
+    /// @brief Completes the loading of data staged by Decode, e.g. by registering sub-resources in the ResourceManager.
+    ///
+    /// This function must be called on the main thread.
+    ///
+    /// @returns @c true if the loading succeeded, @c false otherwise.
+    XNOR_ENGINE virtual bool_t FinishDecode();
+
     /// @brief Creates the Resource in the current interface (Rhi/Audio).
     XNOR_ENGINE virtual void CreateInInterface();
 
@@ -69,6 +107,22 @@ public:
 
     XNOR_ENGINE virtual bool_t Save() const;
 
+    /// @brief Returns the number of bytes this Resource uses in the current interface (Rhi/Audio) once created in it.
+    ///
+    /// This is an estimate computed from the loaded data, and can therefore be called before CreateInInterface.
+    [[nodiscard]]
+    XNOR_ENGINE virtual size_t GetInterfaceMemorySize() const;
+
+    /// @brief Returns the number of bytes of loaded data this Resource keeps in main memory.
+    ///
+    /// This doesn't include the raw File data, which is accounted for separately by the ResourceManager.
+    [[nodiscard]]
+    XNOR_ENGINE virtual size_t GetMemorySize() const;
+
+    /// @brief Returns the category this Resource is accounted in by the ResourceManager memory budgets.
+    [[nodiscard]]
+    XNOR_ENGINE virtual ENUM_VALUE(ResourceCategory) GetMemoryCategory() const;
+
     /// @brief Returns whether the Resource has already been loaded.
     [[nodiscard]]
     XNOR_ENGINE bool_t IsLoaded() const;
@@ -77,6 +131,14 @@ public:
     [[nodiscard]]
     XNOR_ENGINE bool_t IsLoadedInInterface() const;
 
+    /// @brief Returns whether the Resource has been evicted by the ResourceManager to stay within its memory budget.
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsEvicted() const;
+
+    /// @brief Returns the last frame during which this Resource was retrieved from the ResourceManager.
+    [[nodiscard]]
+    XNOR_ENGINE uint64_t GetLastUsedFrame() const;
+
     /// @brief Returns the name of this Resource.
     [[nodiscard]]
     XNOR_ENGINE std::string GetName() const;
@@ -108,6 +170,11 @@ protected:
 
     Pointer<File> m_File;
 
+    /// @brief Whether the resource was evicted by the ResourceManager
+    bool_t m_Evicted = false;
+    /// @brief Last frame during which the resource was retrieved from the ResourceManager
+    uint64_t m_LastUsedFrame = 0;
+
     // We need this in order to set m_File from the ResourceManager
     // which is the only class that needs to modify this field
     friend class ResourceManager;
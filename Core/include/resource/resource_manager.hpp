@@ -1,9 +1,13 @@
 ﻿#pragma once
 
+#include <array>
 #include <unordered_map>
 
 #include "file/file.hpp"
+#include "resource/guid_map.hpp"
 #include "resource/resource.hpp"
+#include "resource/resource_streamer.hpp"
+#include "utils/event.hpp"
 #include "utils/logger.hpp"
 #include "utils/pointer.hpp"
 
@@ -12,10 +16,32 @@
 
 BEGIN_XNOR_CORE
 
+/// @brief Memory usage of a single ResourceCategory.
+struct ResourceMemoryStats
+{
+    /// @brief The memory budget of the category in bytes, 0 meaning unlimited.
+    size_t budget = 0;
+    /// @brief Number of bytes used in main memory, including the File data owned by the resources.
+    size_t cpuBytes = 0;
+    /// @brief Number of bytes used in the interface (Rhi/Audio).
+    size_t gpuBytes = 0;
+    /// @brief Number of resources currently using memory.
+    uint32_t resourceCount = 0;
+    /// @brief Number of resources currently evicted.
+    uint32_t evictedCount = 0;
+    /// @brief Number of resources evicted by the last call to ResourceManager::EnforceMemoryBudgets.
+    uint32_t lastEvictionCount = 0;
+};
+
 /// @brief Static class used to add, load, get, or unload @ref XnorCore::Resource "Resources".
 ///
 /// It contains all wrapper instances of the Resource class. These are either added or loaded using the corresponding
 /// function: ResourceManager::Add and ResourceManager::Load.
+///
+/// Each ResourceCategory can be given a memory budget using ResourceManager::SetMemoryBudget. When a category goes over budget,
+/// ResourceManager::EnforceMemoryBudgets evicts the resources of this category that aren't referenced anywhere else in least
+/// recently used order. Evicted resources stay in the ResourceManager and are loaded back the next time they are retrieved,
+/// and created in the interface (Rhi/Audio) at the start of the following frame by ResourceManager::FinishRestores.
 class ResourceManager final
 {
     STATIC_CLASS(ResourceManager)
@@ -26,8 +52,22 @@ public:
     /// This is mainly used in LoadAll.
     static constexpr const char_t* const ReservedShaderPrefix = "_shaders/";
 
-    /// @brief The path to the GUID map file.
-    static constexpr const char_t* const GuidMapFilePath = "assets/guid_map.txt";
+    /// @brief The path to the binary GUID map file, see GuidMap.
+    static constexpr const char_t* const GuidMapFilePath = "assets/guid_map.bin";
+
+    /// @brief The path to the legacy text GUID map file, converted to the binary format if it is the only one found.
+    static constexpr const char_t* const TextGuidMapFilePath = "assets/guid_map.txt";
+
+    /// @brief Whether evicted resources are loaded back when retrieved using ResourceManager::Get.
+    ///
+    /// The Resource is decoded right away, but it is only usable once ResourceManager::FinishRestores has been called.
+    XNOR_ENGINE static inline bool_t restoreEvictedOnGet = true;
+
+    /// @brief Called after a Resource has been evicted.
+    XNOR_ENGINE static inline Event<const Pointer<Resource>&> onResourceEvicted;
+
+    /// @brief Called after an evicted Resource has been loaded back.
+    XNOR_ENGINE static inline Event<const Pointer<Resource>&> onResourceRestored;
     
     /// @brief Creates the Resource corresponding to the given @p name without loading it.
     template <Concepts::ResourceT T>
@@ -41,13 +81,26 @@ public:
     template <Concepts::ResourceT T>
     static Pointer<T> Load(const Pointer<File>& file, bool_t loadInRhi = true);
 
+    /// @brief Creates the Resource corresponding to the given @p file and loads it asynchronously.
+    ///
+    /// The Resource is added immediately, and can be retrieved using either ResourceManager::Get or StreamingRequest::GetResource.
+    /// It must however not be used until the returned request reaches the StreamingState::Ready state.
+    ///
+    /// @see ResourceStreamer
+    template <Concepts::ResourceT T>
+    static Pointer<StreamingRequest> LoadAsync(Pointer<File> file, ENUM_VALUE(LoadPriority) priority = LoadPriority::Nearby);
+
     /// @brief Creates one Resource for each @ref FileManager entry.
     XNOR_ENGINE static void LoadAll();
 
     /// @brief Loads the Guid resource map internally
+    ///
+    /// Resources added after this call are automatically added to the map.
     XNOR_ENGINE static void LoadGuidMap();
 
     /// @brief Saves the Guid resource map internally
+    ///
+    /// Only the entries added since the last save are written if possible.
     XNOR_ENGINE static void SaveGuidMap();
 
     /// @brief Checks whether the ResourceManager contains the specified Resource name.
@@ -135,10 +188,57 @@ public:
     /// @brief Unloads all stored @ref XnorCore::Resource "Resources".
     XNOR_ENGINE static void UnloadAll();
 
+    /// @brief Sets the memory budget of the given @p category, in bytes.
+    ///
+    /// A budget of 0 means the category is unlimited, which is the default. @p category must be lower than ResourceCategory::Count.
+    XNOR_ENGINE static void SetMemoryBudget(ENUM_VALUE(ResourceCategory) category, size_t bytes);
+
+    /// @brief Returns the memory budget of the given @p category, in bytes.
+    [[nodiscard]]
+    XNOR_ENGINE static size_t GetMemoryBudget(ENUM_VALUE(ResourceCategory) category);
+
+    /// @brief Computes the current memory usage of each ResourceCategory.
+    [[nodiscard]]
+    XNOR_ENGINE static std::array<ResourceMemoryStats, ResourceCategory::Count> GetMemoryStats();
+
+    /// @brief Evicts resources from the categories that are over budget.
+    ///
+    /// Only the resources that aren't referenced outside of the ResourceManager and that weren't used during the current frame
+    /// are evicted, least recently used first. A category can therefore stay over budget if all of its resources are in use.
+    ///
+    /// This function must be called on the main thread, once each frame.
+    XNOR_ENGINE static void EnforceMemoryBudgets();
+
+    /// @brief Unloads the given @p resource and its File data while keeping it in the ResourceManager.
+    ///
+    /// The caller is responsible for making sure the Resource isn't in use.
+    XNOR_ENGINE static void Evict(Pointer<Resource> resource);
+
+    /// @brief Decodes back the given evicted @p resource from its File.
+    ///
+    /// This function can be called from any thread. The Resource stays evicted until FinishRestores finishes loading it
+    /// and creates it in the interface on the main thread.
+    ///
+    /// @returns @c true if the Resource was successfully decoded or is already waiting for FinishRestores, @c false otherwise.
+    XNOR_ENGINE static bool_t Restore(Pointer<Resource> resource);
+
+    /// @brief Finishes loading the resources decoded by Restore, and creates them in the interface (Rhi/Audio).
+    ///
+    /// This function must be called on the main thread, once each frame.
+    XNOR_ENGINE static void FinishRestores();
+
 private:
     XNOR_ENGINE static inline std::unordered_map<std::string, Pointer<Resource>> m_Resources;
     XNOR_ENGINE static inline std::mutex m_ResourcesMutex;
-    XNOR_ENGINE static inline std::unordered_map<Guid, std::string> m_GuidMap;
+    XNOR_ENGINE static inline GuidMap m_GuidMap;
+    XNOR_ENGINE static inline bool_t m_GuidMapLoaded = false;
+
+    XNOR_ENGINE static inline std::array<size_t, ResourceCategory::Count> m_MemoryBudgets {};
+    XNOR_ENGINE static inline std::array<uint32_t, ResourceCategory::Count> m_LastEvictionCounts {};
+
+    // Resources decoded by Restore, waiting for FinishRestores
+    XNOR_ENGINE static inline std::vector<Pointer<Resource>> m_PendingRestores;
+    XNOR_ENGINE static inline std::mutex m_RestoreMutex;
     
     template <Concepts::ResourceT T>
     static Pointer<T> AddNoCheck(std::string name);
@@ -149,6 +249,14 @@ private:
     template <Concepts::ResourceT T>
     [[nodiscard]]
     static Pointer<T> GetNoCheck(const std::string& name);
+
+    // Gives the Resource the Guid it was saved with, or adds it to the map if it is new. Must be called with m_ResourcesMutex locked
+    XNOR_ENGINE static void AssignGuid(Resource& resource);
+
+    XNOR_ENGINE static void GetMemoryUsage(const Resource& resource, size_t* cpuBytes, size_t* gpuBytes);
+
+    [[nodiscard]]
+    XNOR_ENGINE static bool_t IsReferenced(const Pointer<Resource>& resource);
 };
 
 END_XNOR_CORE
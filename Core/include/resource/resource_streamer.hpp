@@ -0,0 +1,224 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core.hpp"
+#include "file/file.hpp"
+#include "resource/resource.hpp"
+#include "utils/pointer.hpp"
+#include "utils/utils.hpp"
+
+/// @file resource_streamer.hpp
+/// @brief Defines the XnorCore::ResourceStreamer class.
+
+BEGIN_XNOR_CORE
+
+/// @brief Priority class of an asynchronous load request.
+///
+/// Requests are always decoded and uploaded in priority order, and in submission order inside a same priority class.
+BEGIN_ENUM(LoadPriority)
+{
+    /// @brief The Resource is needed for what is currently on screen.
+    Visible,
+    /// @brief The Resource will soon be needed, e.g. it is close to the camera.
+    Nearby,
+    /// @brief The Resource can be loaded whenever there is nothing else to do.
+    Background,
+
+    /// @brief The number of priority classes.
+    Count
+}
+END_ENUM
+
+/// @brief Lifetime state of a StreamingRequest.
+BEGIN_ENUM(StreamingState)
+{
+    /// @brief Waiting for a worker thread.
+    Queued,
+    /// @brief Being read and decoded on a worker thread.
+    Decoding,
+    /// @brief Decoded, waiting for the main thread to finish loading it and to create it in the interface (Rhi/Audio).
+    Decoded,
+    /// @brief Fully loaded and usable.
+    Ready,
+    /// @brief Cancelled before being fully loaded.
+    Cancelled,
+    /// @brief An error occured while loading.
+    Failed
+}
+END_ENUM
+
+/// @brief Per-frame budget of the main thread upload step of the ResourceStreamer.
+struct StreamingBudget
+{
+    /// @brief Maximum time spent creating resources in the interface each frame, in milliseconds.
+    float_t milliseconds = 2.f;
+    /// @brief Maximum number of bytes created in the interface each frame.
+    size_t bytes = 32ull * 1024 * 1024;
+};
+
+/// @brief Statistics of the ResourceStreamer for the last call to ResourceStreamer::Update.
+struct StreamingStats
+{
+    /// @brief Number of resources created in the interface during the last frame.
+    uint32_t uploadCount = 0;
+    /// @brief Number of bytes created in the interface during the last frame.
+    size_t uploadBytes = 0;
+    /// @brief Time spent creating resources in the interface during the last frame, in milliseconds.
+    float_t uploadMilliseconds = 0.f;
+    /// @brief Number of requests waiting for a worker thread, for each LoadPriority.
+    std::array<size_t, LoadPriority::Count> queued {};
+    /// @brief Number of decoded requests waiting for their upload.
+    size_t pendingUploads = 0;
+};
+
+/// @brief Handle to an asynchronous Resource load.
+///
+/// Instances are created by ResourceManager::LoadAsync and are owned by the ResourceStreamer until they either finish or get cancelled.
+class StreamingRequest
+{
+public:
+    /// @brief Creates a request for the given @p resource to be loaded from @p file.
+    XNOR_ENGINE StreamingRequest(const Pointer<Resource>& resource, const Pointer<File>& file, ENUM_VALUE(LoadPriority) priority);
+
+    XNOR_ENGINE ~StreamingRequest() = default;
+
+    DELETE_COPY_MOVE_OPERATIONS(StreamingRequest)
+
+    /// @brief Returns the Resource being loaded.
+    ///
+    /// The Resource can be used as soon as GetState returns StreamingState::Ready.
+    [[nodiscard]]
+    XNOR_ENGINE Pointer<Resource> GetResource() const;
+
+    /// @brief Returns the Resource being loaded, cast to @p T.
+    template <Concepts::ResourceT T>
+    [[nodiscard]]
+    Pointer<T> GetResource() const;
+
+    /// @brief Returns the current state of this request.
+    [[nodiscard]]
+    XNOR_ENGINE ENUM_VALUE(StreamingState) GetState() const;
+
+    /// @brief Returns the priority class of this request.
+    [[nodiscard]]
+    XNOR_ENGINE ENUM_VALUE(LoadPriority) GetPriority() const;
+
+    /// @brief Returns whether this request reached either the Ready, Cancelled or Failed state.
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsDone() const;
+
+    /// @brief Cancels this request.
+    ///
+    /// A request that has already been decoded gets its Resource unloaded. This does nothing if the request is already done.
+    XNOR_ENGINE void Cancel();
+
+private:
+    Pointer<Resource> m_Resource;
+    Pointer<File> m_File;
+    ENUM_VALUE(LoadPriority) m_Priority = LoadPriority::Background;
+
+    std::atomic<ENUM_VALUE(StreamingState)> m_State = StreamingState::Queued;
+    std::atomic<bool_t> m_CancelRequested = false;
+
+    // The ResourceStreamer is the only class that drives the state of a request
+    friend class ResourceStreamer;
+};
+
+/// @brief Static class used to load @ref XnorCore::Resource "Resources" asynchronously.
+///
+/// Files are read and decoded on worker threads, in LoadPriority order, using Resource::Decode. Decoded resources are then
+/// finished with Resource::FinishDecode and created in the interface (Rhi/Audio) on the main thread by
+/// ResourceStreamer::Update, which is time-sliced using ResourceStreamer::budget.
+///
+/// Requests should be made using ResourceManager::LoadAsync.
+class ResourceStreamer final
+{
+    STATIC_CLASS(ResourceStreamer)
+
+public:
+    /// @brief The per-frame upload budget used by Update.
+    XNOR_ENGINE static inline StreamingBudget budget;
+
+    /// @brief Starts the worker threads.
+    ///
+    /// @param workerCount The number of worker threads. If 0, this is determined from the hardware concurrency.
+    XNOR_ENGINE static void Initialize(uint32_t workerCount = 0);
+
+    /// @brief Cancels every remaining request and stops the worker threads.
+    XNOR_ENGINE static void Shutdown();
+
+    /// @brief Returns whether the worker threads are running.
+    [[nodiscard]]
+    XNOR_ENGINE static bool_t IsRunning();
+
+    /// @brief Adds a new request to the streaming queues.
+    XNOR_ENGINE static Pointer<StreamingRequest> Enqueue(const Pointer<Resource>& resource, const Pointer<File>& file, ENUM_VALUE(LoadPriority) priority);
+
+    /// @brief Cancels the given @p request.
+    ///
+    /// @see StreamingRequest::Cancel
+    XNOR_ENGINE static void Cancel(StreamingRequest* request);
+
+    /// @brief Finishes decoded resources and creates them in the interface until the frame budget is exhausted.
+    ///
+    /// This function must be called on the main thread, once each frame, which Application::UpdateSubsystems does. At least one decoded resource is always
+    /// uploaded per call so that a single resource larger than the budget cannot stall the queue.
+    XNOR_ENGINE static void Update();
+
+    /// @brief Blocks until every queued request is decoded, then uploads all of them regardless of the budget.
+    ///
+    /// This function must be called on the main thread.
+    XNOR_ENGINE static void Flush();
+
+    /// @brief Stops the worker threads from starting new decodes.
+    XNOR_ENGINE static void Pause();
+
+    /// @brief Lets the worker threads start new decodes again.
+    XNOR_ENGINE static void Resume();
+
+    /// @brief Returns the statistics of the last Update.
+    [[nodiscard]]
+    XNOR_ENGINE static StreamingStats GetStats();
+
+private:
+    using Queue = std::deque<StreamingRequest*>;
+
+    XNOR_ENGINE static inline std::vector<std::thread> m_Workers;
+    XNOR_ENGINE static inline std::mutex m_Mutex;
+    XNOR_ENGINE static inline std::condition_variable m_CondVar;
+    XNOR_ENGINE static inline bool_t m_Running = false;
+    XNOR_ENGINE static inline bool_t m_Paused = false;
+    XNOR_ENGINE static inline uint32_t m_ActiveDecodes = 0;
+
+    XNOR_ENGINE static inline std::array<Queue, LoadPriority::Count> m_DecodeQueues;
+    XNOR_ENGINE static inline std::array<Queue, LoadPriority::Count> m_UploadQueues;
+
+    // Strong references to every request that isn't done yet, only ever modified on the main thread
+    XNOR_ENGINE static inline std::vector<Pointer<StreamingRequest>> m_Requests;
+
+    XNOR_ENGINE static inline StreamingStats m_Stats;
+
+    static void Run();
+
+    static StreamingRequest* PopDecode();
+
+    static StreamingRequest* PopUpload();
+
+    // Finishes the loading of a decoded request on the main thread, returns false and fails the request on error
+    static bool_t Finish(StreamingRequest* request);
+
+    static void Upload(StreamingRequest* request);
+
+    static void ReleaseDoneRequests();
+};
+
+END_XNOR_CORE
+
+#include "resource/resource_streamer.inl"
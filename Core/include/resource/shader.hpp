@@ -1,6 +1,9 @@
 #pragma once
 
 #include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "core.hpp"
 #include "file/file.hpp"
@@ -115,6 +118,43 @@ public:
 	/// @param value Value
 	XNOR_ENGINE void SetMat4(const std::string& keyName, const Matrix& value) const;
 
+#ifndef SWIG
+	/// @brief Sets an int (signed, 32 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetInt(const UniformHandle<int32_t>& handle, int32_t value) const;
+
+	/// @brief Sets an bool (signed, 32 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetBool(const UniformHandle<bool_t>& handle, bool_t value) const;
+
+	/// @brief Sets an float (32 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetFloat(const UniformHandle<float_t>& handle, float_t value) const;
+
+	/// @brief Sets a @ref Vector2 (2 float, 64 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetVec2(const UniformHandle<Vector2>& handle, const Vector2& value) const;
+
+	/// @brief Sets a @ref Vector3 (3 float, 96 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetVec3(const UniformHandle<Vector3>& handle, const Vector3& value) const;
+
+	/// @brief Sets a @ref Vector4 (4 float, 128 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetVec4(const UniformHandle<Vector4>& handle, const Vector4& value) const;
+
+	/// @brief Sets a @ref Matrix (16 float, 512 bits) variable in a shader without any string operation
+	/// @param handle Variable handle
+	/// @param value Value
+	XNOR_ENGINE void SetMat4(const UniformHandle<Matrix>& handle, const Matrix& value) const;
+#endif
+
 	/// @brief Gets the internal id of the shader
 	/// @return Id
 	[[nodiscard]]
@@ -138,6 +178,42 @@ public:
 	/// @param shaderProgramCullInfo Culling info
 	XNOR_ENGINE void SetFaceCullingInfo(const ShaderProgramCullInfo& shaderProgramCullInfo);
 
+#ifndef SWIG
+	/// @brief Declares the features of the shader, see ShaderPreprocessor. Should be called before any variant is created.
+	/// @param features Feature names, the bit @c i of a variant corresponding to the feature at index @c i
+	XNOR_ENGINE void SetFeatures(const std::vector<std::string>& features);
+
+	/// @brief Gets the features of the shader
+	/// @return Feature names
+	[[nodiscard]]
+	XNOR_ENGINE const std::vector<std::string>& GetFeatures() const;
+
+	/// @brief Gets the variant of the shader with the given @p features enabled, creating it if needed
+	///
+	/// The variant is compiled immediately if the shader is already loaded in the @ref Rhi, prefer declaring it using
+	/// @ref AddPrewarmVariant to avoid a hitch on first use. Variants with identical preprocessed sources share the same
+	/// program.
+	///
+	/// @param features Bitmask of the enabled features
+	/// @return Variant, or @c nullptr if the sources couldn't be preprocessed
+	XNOR_ENGINE Pointer<Shader> GetVariant(uint32_t features);
+
+	/// @brief Adds a variant to compile along with the shader in @ref CreateInInterface
+	/// @param features Bitmask of the enabled features
+	XNOR_ENGINE void AddPrewarmVariant(uint32_t features);
+
+	/// @brief Gets the number of distinct programs used by the variants of the shader
+	/// @return Program count
+	[[nodiscard]]
+	XNOR_ENGINE size_t GetVariantProgramCount() const;
+
+	/// @brief Gets the preprocessed code of a shader stage
+	/// @param pipeline Shader stage
+	/// @return Code
+	[[nodiscard]]
+	XNOR_ENGINE const ShaderCode& GetCode(ShaderPipeline::ShaderPipeline pipeline) const;
+#endif
+
 private:
 	uint32_t m_Id = 0;
 	
@@ -147,6 +223,21 @@ private:
 	
 	std::array<Pointer<File>, ShaderPipeline::Count> m_Files;
 	std::array<ShaderCode, ShaderPipeline::Count> m_Code;
+
+	std::vector<std::string> m_Features;
+	// Features of this shader if it is a variant
+	uint32_t m_VariantFeatures = 0;
+	// Define set of this shader if it is a variant, part of the key of its cached program binary
+	std::string m_VariantDefines;
+	// Variant of each requested feature bitmask, several bitmasks can share the same variant
+	std::unordered_map<uint32_t, Pointer<Shader>> m_Variants;
+	// Strong references to the distinct variants
+	std::vector<Pointer<Shader>> m_VariantPrograms;
+	std::vector<uint32_t> m_PrewarmVariants;
+
+	bool_t PreprocessVariant(uint32_t features, std::array<ShaderCode, ShaderPipeline::Count>* code) const;
+
+	void CopyPipelineState(Shader& variant) const;
 };
 
 END_XNOR_CORE
@@ -43,6 +43,12 @@ public:
     XNOR_ENGINE bool_t Load(const aiMesh& loadedData, const aiNode& rootNode);
     XNOR_ENGINE bool_t Load(const aiScene& scene, const aiAnimation& loadedData);
 
+    /// @brief Loads the skeleton from bones which were already created, with the parents before their children.
+    ///
+    /// @param bones Bones.
+    /// @return Whether the load succeeded.
+    XNOR_ENGINE bool_t Load(const List<Bone>& bones);
+
     /// @brief Re-orders how the bones are stored in order to have the parents first and the children after
     XNOR_ENGINE void ReorderBones();
 
@@ -138,7 +138,30 @@ public:
     
     XNOR_ENGINE bool_t Save() const override;
 
+    /// @copydoc XnorCore::Resource::GetInterfaceMemorySize
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetInterfaceMemorySize() const override;
+
+    /// @copydoc XnorCore::Resource::GetMemorySize
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetMemorySize() const override;
+
+    /// @copydoc XnorCore::Resource::GetMemoryCategory
+    [[nodiscard]]
+    XNOR_ENGINE ENUM_VALUE(ResourceCategory) GetMemoryCategory() const override;
+
 private:
+    // Version of the decoded data stored in the DerivedDataCache, must be incremented when its layout changes
+    static constexpr uint32_t CacheVersion = 1;
+
+    // Header of the decoded data stored in the DerivedDataCache
+    struct CachedHeader
+    {
+        Vector2i size;
+        int32_t dataChannels;
+        int32_t channels;
+    };
+
     uint8_t* m_Data = nullptr;
     Vector2i m_Size;
     int32_t m_DataChannels = 0;
@@ -3,6 +3,7 @@
 #include "core.hpp"
 #include "rendering/animator.hpp"
 #include "rendering/material.hpp"
+#include "rendering/skinned_vertex_cache.hpp"
 #include "resource/animation_montage.hpp"
 #include "resource/mesh.hpp"
 #include "resource/model.hpp"
@@ -33,6 +34,9 @@ public:
     /// @brief Whether to draw the model AABB box
     bool_t drawModelAabb = false;
 
+    /// @brief Where the vertices are skinned, the CPU being faster for meshes drawn in many passes
+    SkinningMode skinningMode = SkinningMode::Automatic;
+
     XNOR_ENGINE void StartAnimation(const Pointer<Animation>& animation);
     XNOR_ENGINE void StartBlending(const Pointer<Animation>& animation);
     XNOR_ENGINE void SetCrossFadeDelta(float_t delta);
@@ -41,6 +45,15 @@ public:
 
     XNOR_ENGINE const List<Matrix>& GetMatrices() const;
 
+    /// @brief Gets the animator computing the matrices of the bones.
+    [[nodiscard]]
+    XNOR_ENGINE Animator& GetAnimator();
+
+    /// @brief Gets the world space AABB of the mesh in its current pose
+    ///
+    /// The AABB contains the bind pose AABB moved by each bone, which contains every skinned vertex since they are weighted averages of their bone transforms.
+    XNOR_ENGINE void GetAabb(Bound* bound) const;
+
 private:
     Animator m_Animator;
     Animator m_TargetAnimator;
@@ -56,5 +69,6 @@ REFL_AUTO(
     field(mesh),
     field(material),
     field(drawModelAabb),
+    field(skinningMode),
     field(m_Animator)
 );
@@ -13,6 +13,8 @@ class XNOR_ENGINE Bound
 {
 public:
     static Bound GetAabbFromTransform(const Bound& bound,const Transform& transform);
+
+    static Bound GetAabbFromMatrix(const Bound& bound, const Matrix& matrix);
     
      /// @brief The extents of the Bounding Box. This is half size of the Bounds.
     Vector3 extents;
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "core.hpp"
+
+/// @file compression.hpp
+/// @brief Defines the XnorCore::Compression namespace.
+
+BEGIN_XNOR_CORE
+
+/// @brief Format of compressed data.
+BEGIN_ENUM(CompressionFormat)
+{
+    /// @brief The data is stored as is.
+    None,
+    /// @brief The data is compressed using the LZ4 block format.
+    Lz4
+}
+END_ENUM
+
+/// @namespace Compression
+/// @brief Namespace containing lossless compression functions.
+///
+/// The LZ4 implementation follows the LZ4 block format specification, so data compressed with it can be read by any other
+/// LZ4 implementation and vice versa. It favors decompression speed over compression ratio.
+namespace Compression
+{
+    /// @brief Returns the maximum size of the data resulting from the compression of @p size bytes using the given @p format.
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetMaxCompressedSize(ENUM_VALUE(CompressionFormat) format, size_t size);
+
+    /// @brief Compresses @p sourceSize bytes of @p source into @p destination.
+    ///
+    /// @returns The size of the compressed data, or 0 if it doesn't fit in @p destinationCapacity bytes.
+    [[nodiscard]]
+    XNOR_ENGINE size_t Compress(ENUM_VALUE(CompressionFormat) format, const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t destinationCapacity);
+
+    /// @brief Decompresses @p sourceSize bytes of @p source into @p destination.
+    ///
+    /// The input is validated, so corrupted data never results in reads or writes out of bounds.
+    ///
+    /// @returns @c true if exactly @p destinationSize bytes were decompressed, @c false otherwise.
+    [[nodiscard]]
+    XNOR_ENGINE bool_t Decompress(ENUM_VALUE(CompressionFormat) format, const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t destinationSize);
+}
+
+END_XNOR_CORE
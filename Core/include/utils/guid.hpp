@@ -5,6 +5,7 @@
 #include <format>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 #include "core.hpp"
 
@@ -32,6 +33,11 @@ public:
     /// @param str String
     /// @returns Guid
     static Guid FromString(const char_t* str);
+
+    /// @brief Parses a Guid from a string
+    /// @param str String
+    /// @returns Guid, or an empty one if the string isn't valid
+    static Guid FromString(std::string_view str);
     
     [[nodiscard]]
     uint32_t GetData1() const;
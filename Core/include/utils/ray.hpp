@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core.hpp"
+#include "Maths/matrix.hpp"
+#include "Maths/vector3.hpp"
+#include "utils/bound.hpp"
+
+/// @file ray.hpp
+/// @brief Defines the XnorCore::Ray struct.
+
+BEGIN_XNOR_CORE
+
+/// @brief Half-line used for raycasts.
+///
+/// The direction doesn't have to be normalized, the distances given by the intersection functions are then expressed in
+/// multiples of its length. This allows to transform a ray to the local space of an object and compare the distances of
+/// the hits with the ones of other objects.
+struct XNOR_ENGINE Ray
+{
+    /// @brief Starting point.
+    Vector3 origin;
+    /// @brief Direction.
+    Vector3 direction = -Vector3::UnitZ();
+
+    Ray(const Vector3& newOrigin, const Vector3& newDirection);
+
+    Ray() = default;
+
+    ~Ray() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(Ray)
+
+    /// @brief Gets the point at a distance along the ray.
+    [[nodiscard]]
+    Vector3 GetPoint(float_t distance) const;
+
+    /// @brief Transforms the ray by a matrix, distances along the transformed ray are the same as along this one.
+    [[nodiscard]]
+    Ray Transform(const Matrix& matrix) const;
+
+    /// @brief Intersects the ray with an AABB.
+    ///
+    /// @param bound AABB.
+    /// @param maxDistance Distance after which hits are ignored.
+    /// @param distance Distance at which the ray enters the AABB, or 0 if it starts inside of it.
+    /// @return Whether the ray hits the AABB before @p maxDistance.
+    [[nodiscard]]
+    bool_t Intersect(const Bound& bound, float_t maxDistance, float_t* distance) const;
+
+    /// @brief Intersects the ray with both sides of a triangle.
+    ///
+    /// @param p0 First vertex.
+    /// @param p1 Second vertex.
+    /// @param p2 Third vertex.
+    /// @param distance Distance of the hit.
+    /// @return Whether the ray hits the triangle.
+    [[nodiscard]]
+    bool_t Intersect(const Vector3& p0, const Vector3& p1, const Vector3& p2, float_t* distance) const;
+};
+
+END_XNOR_CORE
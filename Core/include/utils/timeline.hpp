@@ -44,6 +44,9 @@ public:
     float_t GetDuration() const;
     void SetDuration(float_t duration);
 
+    [[nodiscard]]
+    float_t GetTime() const;
+
 private:
     std::map<float_t, TimelineEvents<Args...>> m_Events;
     float_t m_Duration = 0.f;
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vector>
+
+#include "core.hpp"
+#include "data_structure/bvh.hpp"
+#include "Maths/matrix.hpp"
+#include "resource/model.hpp"
+#include "scene/entity.hpp"
+#include "scene/scene.hpp"
+#include "utils/bound.hpp"
+#include "utils/ray.hpp"
+
+/// @file scene_raycaster.hpp
+/// @brief Defines the XnorCore::SceneRaycaster class.
+
+BEGIN_XNOR_CORE
+
+class SkinnedMeshRenderer;
+class StaticMeshRenderer;
+
+/// @brief Instance of a SceneRaycaster.
+struct RaycastInstance
+{
+    /// @brief Entity given back when the instance is hit.
+    Entity* entity = nullptr;
+    /// @brief World space AABB.
+    Bound bound;
+    /// @brief Inverse of the world matrix, moving rays to the space of the model.
+    Matrix inverseWorldMatrix;
+    /// @brief Model whose triangles are intersected, or @c nullptr to only intersect the AABB.
+    const Model* model = nullptr;
+};
+
+/// @brief Casts rays against the entities of a scene on the CPU.
+///
+/// Each Model keeps a Bvh over its triangles, built once when it is loaded. This class builds a top-level Bvh over the
+/// instances of these models, the rays being moved to the space of a model to traverse its own Bvh. Skinned meshes are
+/// only intersected through the AABB of their current pose.
+///
+/// The top-level Bvh over a scene is kept between raycasts. It is only built again when the instances of the scene change,
+/// and refit when they only moved.
+class SceneRaycaster
+{
+public:
+    XNOR_ENGINE SceneRaycaster() = default;
+
+    XNOR_ENGINE ~SceneRaycaster() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(SceneRaycaster)
+
+    /// @brief Removes all the instances.
+    XNOR_ENGINE void Clear();
+
+    /// @brief Adds an instance whose triangles are intersected.
+    ///
+    /// @param entity Entity given back when the instance is hit.
+    /// @param worldMatrix World matrix of the instance.
+    /// @param model Model of the instance, it must outlive the raycasts.
+    XNOR_ENGINE void AddInstance(Entity* entity, const Matrix& worldMatrix, const Model& model);
+
+    /// @brief Adds an instance only intersected through its AABB.
+    ///
+    /// @param entity Entity given back when the instance is hit.
+    /// @param bound World space AABB of the instance.
+    XNOR_ENGINE void AddInstance(Entity* entity, const Bound& bound);
+
+    /// @brief Builds the top-level Bvh over the instances added since the last Clear.
+    XNOR_ENGINE void Build();
+
+    /// @brief Replaces the instances by the static and skinned meshes of a scene, and updates the top-level Bvh.
+    ///
+    /// The Bvh is built again if the instances aren't the ones of the last call, refit if some of them moved, and kept otherwise.
+    XNOR_ENGINE void Build(Scene& scene);
+
+    /// @brief Finds the closest instance hit by a world space ray.
+    ///
+    /// @param ray Ray.
+    /// @param entity Entity of the instance hit.
+    /// @param distance Distance after which hits are ignored, set to the distance of the hit.
+    /// @return Whether an instance is hit.
+    XNOR_ENGINE bool_t Raycast(const Ray& ray, Entity** entity, float_t* distance) const;
+
+    /// @brief Intersects a world space ray with a single instance.
+    ///
+    /// @param instance Instance.
+    /// @param ray Ray.
+    /// @param distance Distance after which hits are ignored, set to the distance of the hit.
+    /// @return Whether the instance is hit.
+    [[nodiscard]]
+    XNOR_ENGINE static bool_t Intersect(const RaycastInstance& instance, const Ray& ray, float_t* distance);
+
+    /// @brief Gets the instances.
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<RaycastInstance>& GetInstances() const;
+
+private:
+    std::vector<RaycastInstance> m_Instances;
+    /// @brief Instances of the last build over a scene, compared with the new ones
+    std::vector<RaycastInstance> m_PreviousInstances;
+    std::vector<Bound> m_InstanceBounds;
+    Bvh m_Bvh;
+
+    std::vector<StaticMeshRenderer*> m_StaticMeshRenderers;
+    std::vector<SkinnedMeshRenderer*> m_SkinnedMeshRenderers;
+};
+
+END_XNOR_CORE
@@ -2,6 +2,7 @@
 
 #include "core.hpp"
 #include "skybox.hpp"
+#include "rendering/animation_system.hpp"
 #include "scene/scene.hpp"
 
 /// @file world.hpp
@@ -26,6 +27,9 @@ public:
 
     /// @brief The currently loaded scene in the world
     XNOR_ENGINE static inline Scene* scene;
+
+    /// @brief Animates the skinned meshes of the scene every frame
+    XNOR_ENGINE static inline AnimationSystem animationSystem;
 };
 
 END_XNOR_CORE
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <utility>
+
+BEGIN_XNOR_CORE
+
+template <typename HitFunc>
+bool_t Bvh::Raycast(const Ray& ray, HitFunc&& hitPrimitive, float_t* const distance, uint32_t* const primitive) const
+{
+    if (m_Nodes.empty())
+        return false;
+
+    const Vector3 inverseDirection(1.f / ray.direction.x, 1.f / ray.direction.y, 1.f / ray.direction.z);
+
+    float_t nodeDistance = 0.f;
+    if (!IntersectNode(m_Nodes[0], ray.origin, inverseDirection, *distance, &nodeDistance))
+        return false;
+
+    // Nodes still to visit
+    StackEntry stack[StackSize];
+    size_t stackSize = 0;
+
+    bool_t hit = false;
+    uint32_t node = 0;
+    while (true)
+    {
+        const BvhNode& current = m_Nodes[node];
+
+        if (current.count != 0)
+        {
+            for (uint32_t i = current.first; i < current.first + current.count; i++)
+            {
+                if (hitPrimitive(m_Primitives[i], distance))
+                {
+                    *primitive = m_Primitives[i];
+                    hit = true;
+                }
+            }
+        }
+        else
+        {
+            float_t firstDistance = 0.f;
+            float_t secondDistance = 0.f;
+            const bool_t firstHit = IntersectNode(m_Nodes[current.first], ray.origin, inverseDirection, *distance, &firstDistance);
+            const bool_t secondHit = IntersectNode(m_Nodes[current.first + 1], ray.origin, inverseDirection, *distance, &secondDistance);
+
+            if (firstHit && secondHit)
+            {
+                // Visit the closest child first, the hits found in it can discard the other one
+                if (firstDistance <= secondDistance)
+                {
+                    stack[stackSize++] = { .node = current.first + 1, .distance = secondDistance };
+                    node = current.first;
+                }
+                else
+                {
+                    stack[stackSize++] = { .node = current.first, .distance = firstDistance };
+                    node = current.first + 1;
+                }
+                continue;
+            }
+
+            if (firstHit || secondHit)
+            {
+                node = firstHit ? current.first : current.first + 1;
+                continue;
+            }
+        }
+
+        // Pop the next node the ray can still hit before the closest hit
+        do
+        {
+            if (stackSize == 0)
+                return hit;
+
+            const StackEntry& entry = stack[--stackSize];
+            node = entry.node;
+            nodeDistance = entry.distance;
+        }
+        while (nodeDistance > *distance);
+    }
+}
+
+inline bool_t Bvh::IntersectNode(const BvhNode& node, const Vector3& origin, const Vector3& inverseDirection, const float_t maxDistance, float_t* const distance)
+{
+    float_t near = 0.f;
+    float_t far = maxDistance;
+    for (size_t axis = 0; axis < 3; axis++)
+    {
+        float_t t0 = (node.min[axis] - origin[axis]) * inverseDirection[axis];
+        float_t t1 = (node.max[axis] - origin[axis]) * inverseDirection[axis];
+        if (t0 > t1)
+            std::swap(t0, t1);
+
+        near = t0 > near ? t0 : near;
+        far = t1 < far ? t1 : far;
+    }
+
+    *distance = near;
+    return near <= far;
+}
+
+END_XNOR_CORE
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <type_traits>
+
+BEGIN_XNOR_CORE
+
+template <typename... Settings>
+DerivedDataKey DerivedDataCache::CreateKey(const std::string_view importer, const uint32_t version, const uint8_t* const source, const size_t sourceSize, const Settings&... settings)
+{
+    static_assert((std::is_trivially_copyable_v<Settings> && ...), "Importer settings must be trivially copyable");
+
+    uint64_t settingsHash = 0;
+    ((settingsHash = Hash(&settings, sizeof(Settings), settingsHash)), ...);
+
+    return DerivedDataKey
+    {
+        .importer = std::string(importer),
+        .version = version,
+        .sourceHash = Hash(source, sourceSize),
+        .settingsHash = settingsHash
+    };
+}
+
+END_XNOR_CORE
@@ -3,6 +3,7 @@
 #include <ranges>
 
 #include "file/file_manager.hpp"
+#include "input/time.hpp"
 #include "resource/compute_shader.hpp"
 #include "resource/shader.hpp"
 #include "utils/formatter.hpp"
@@ -84,6 +85,29 @@ Pointer<T> ResourceManager::Load(const Pointer<File>& file, bool_t loadInRhi)
     return LoadNoCheck<T>(file, loadInRhi);
 }
 
+template <Concepts::ResourceT T>
+Pointer<StreamingRequest> ResourceManager::LoadAsync(Pointer<File> file, const ENUM_VALUE(LoadPriority) priority)
+{
+    Logger::LogDebug("Streaming resource {}", file->GetPath());
+
+    Pointer<T> resource;
+
+    if (Contains(file->GetPathString()))
+    {
+        resource = GetNoCheck<T>(file->GetPathString());
+    }
+    else
+    {
+        resource = AddNoCheck<T>(file->GetPathString());
+        file->m_Resource = Pointer<Resource>(resource, false);
+    }
+
+    // The File must be set from the main thread as the worker threads aren't allowed to copy Pointers
+    Pointer<Resource>(resource)->m_File = file;
+
+    return ResourceStreamer::Enqueue(Pointer<Resource>(resource), file, priority);
+}
+
 template <Concepts::ResourceT T>
 Pointer<T> ResourceManager::Get(const std::string& name)
 {
@@ -136,12 +160,12 @@ Pointer<T> ResourceManager::Get(const Pointer<File>& file)
 template <Concepts::ResourceT T>
 Pointer<T> ResourceManager::Get(const Guid& guid)
 {
-    auto&& it = m_GuidMap.find(guid);
+    const std::string* const name = m_GuidMap.Find(guid);
 
-    if (it == m_GuidMap.end())
+    if (!name || !Contains(*name))
         return nullptr;
 
-    return Utils::DynamicPointerCast<T>(GetNoCheck<T>(it->second));
+    return Utils::DynamicPointerCast<T>(GetNoCheck<T>(*name));
 }
 
 template <Concepts::ResourceT T>
@@ -252,6 +276,7 @@ Pointer<T> ResourceManager::AddNoCheck(std::string name)
         std::scoped_lock lock(m_ResourcesMutex);
         // We cannot reuse the variable 'name' here in case it was moved inside the Resource constructor
         m_Resources[resource->GetName()] = static_cast<Pointer<Resource>>(resource.CreateStrongReference());
+        AssignGuid(*resource);
     }
 
     // Make sure to return a weak reference
@@ -268,6 +293,7 @@ Pointer<T> ResourceManager::LoadNoCheck(Pointer<File> file, const bool_t loadInR
     {
         std::scoped_lock lock(m_ResourcesMutex);
         m_Resources[resource->GetName()] = static_cast<Pointer<Resource>>(resource.CreateStrongReference());
+        AssignGuid(*resource);
     }
 
     // Make sure to return a weak reference
@@ -286,8 +312,21 @@ Pointer<T> ResourceManager::LoadNoCheck(Pointer<File> file, const bool_t loadInR
 template <Concepts::ResourceT T>
 Pointer<T> ResourceManager::GetNoCheck(const std::string& name)
 {
-    std::scoped_lock lock(m_ResourcesMutex);
-    return Pointer<T>(m_Resources.at(name));
+    Pointer<T> resource;
+
+    {
+        std::scoped_lock lock(m_ResourcesMutex);
+
+        Pointer<Resource>& storedResource = m_Resources.at(name);
+        storedResource->m_LastUsedFrame = Time::GetTotalFrameCount<uint64_t>();
+        resource = Pointer<T>(storedResource);
+    }
+
+    // Evicted resources are decoded back as soon as they are needed again, and usable from the next frame
+    if (restoreEvictedOnGet && resource->IsEvicted())
+        Restore(Pointer<Resource>(resource));
+
+    return resource;
 }
 
 END_XNOR_CORE
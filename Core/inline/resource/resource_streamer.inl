@@ -0,0 +1,11 @@
+#pragma once
+
+BEGIN_XNOR_CORE
+
+template <Concepts::ResourceT T>
+Pointer<T> StreamingRequest::GetResource() const
+{
+    return Utils::DynamicPointerCast<T>(m_Resource);
+}
+
+END_XNOR_CORE
@@ -118,4 +118,10 @@ void Timeline<Args...>::SetDuration(const float_t duration)
     m_Duration = duration;
 }
 
+template <typename... Args>
+float_t Timeline<Args...>::GetTime() const
+{
+    return m_Time;
+}
+
 END_XNOR_CORE
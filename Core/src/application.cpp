@@ -7,6 +7,7 @@
 #include "physics/physics_world.hpp"
 #include "rendering/rhi.hpp"
 #include "resource/resource_manager.hpp"
+#include "resource/resource_streamer.hpp"
 
 #include "audio/audio.hpp"
 #include "utils/message_box.hpp"
@@ -37,12 +38,17 @@ Application::Application(const int32_t, const char_t* const* const argv)
 		Logger::LogError("Couldn't initialize audio");
 
 	Texture::defaultLoadOptions = { .flipVertically = true };
-	FileManager::LoadDirectory("assets");
+	// Shipped builds use a packed archive instead of the loose assets directory
+	if (!std::filesystem::exists("assets") && std::filesystem::exists("assets.pak"))
+		FileManager::MountArchive("assets.pak", "assets");
+	else
+		FileManager::LoadDirectory("assets");
 	FileManager::LoadDirectory("assets_internal/shaders");
 	FileManager::LoadDirectory("assets_internal/editor/gizmos");
     ResourceManager::LoadAll();
 	
 	ResourceManager::LoadGuidMap();
+	ResourceStreamer::Initialize();
 	
     renderer.Initialize();
 	
@@ -66,6 +72,13 @@ Application::Application(const int32_t, const char_t* const* const argv)
 	gameViewPort = new Viewport();
 }
 
+void Application::UpdateSubsystems()
+{
+	ResourceStreamer::Update();
+	ResourceManager::FinishRestores();
+	ResourceManager::EnforceMemoryBudgets();
+}
+
 Application::~Application()
 {
 	delete gameViewPort;
@@ -74,7 +87,8 @@ Application::~Application()
 	DotnetRuntime::Shutdown();
 
 	PhysicsWorld::Destroy();
-	
+
+	ResourceStreamer::Shutdown();
     ResourceManager::UnloadAll();
 	
 	Audio::Shutdown();
@@ -0,0 +1,230 @@
+#include "data_structure/bvh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+
+using namespace XnorCore;
+
+static constexpr float_t Infinity = std::numeric_limits<float_t>::max();
+
+static Vector3 GetMin(const Vector3& a, const Vector3& b)
+{
+    return Vector3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+}
+
+static Vector3 GetMax(const Vector3& a, const Vector3& b)
+{
+    return Vector3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+}
+
+// Half of the surface area of an AABB, the probability of a ray hitting a box is proportional to it
+static float_t GetHalfArea(const Vector3& min, const Vector3& max)
+{
+    const Vector3 size = max - min;
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+struct Bin
+{
+    Vector3 min = Vector3(Infinity);
+    Vector3 max = Vector3(-Infinity);
+    uint32_t count = 0;
+};
+
+// Node still to split by the build
+struct SplitEntry
+{
+    uint32_t node = 0;
+    size_t depth = 0;
+};
+
+void Bvh::Build(const std::vector<Bound>& bounds)
+{
+    Clear();
+
+    const uint32_t primitiveCount = static_cast<uint32_t>(bounds.size());
+    if (primitiveCount == 0)
+        return;
+
+    m_Primitives.resize(primitiveCount);
+    std::iota(m_Primitives.begin(), m_Primitives.end(), 0);
+
+    std::vector<Vector3> centers(primitiveCount);
+    for (uint32_t i = 0; i < primitiveCount; i++)
+        centers[i] = bounds[i].center;
+
+    // A binary tree with a primitive per leaf at most
+    m_Nodes.reserve(static_cast<size_t>(primitiveCount) * 2 - 1);
+    m_Nodes.push_back({ .first = 0, .count = primitiveCount });
+    ComputeNodeBounds(&m_Nodes[0], bounds);
+
+    std::vector<SplitEntry> nodes = { { .node = 0, .depth = 1 } };
+    while (!nodes.empty())
+    {
+        const uint32_t node = nodes.back().node;
+        const size_t depth = nodes.back().depth;
+        nodes.pop_back();
+
+        uint32_t axis = 0;
+        float_t position = 0.f;
+        // The depth is bounded by the size of the raycast stack
+        if (depth >= StackSize || !FindSplit(m_Nodes[node], bounds, centers, &axis, &position))
+            continue;
+
+        const uint32_t first = m_Nodes[node].first;
+        const uint32_t count = m_Nodes[node].count;
+        const auto middle = std::partition(
+            m_Primitives.begin() + first,
+            m_Primitives.begin() + first + count,
+            [&](const uint32_t primitive) -> bool_t { return centers[primitive][axis] < position; }
+        );
+        const uint32_t leftCount = static_cast<uint32_t>(middle - (m_Primitives.begin() + first));
+        if (leftCount == 0 || leftCount == count)
+            continue;
+
+        const uint32_t left = static_cast<uint32_t>(m_Nodes.size());
+        m_Nodes.push_back({ .first = first, .count = leftCount });
+        m_Nodes.push_back({ .first = first + leftCount, .count = count - leftCount });
+        ComputeNodeBounds(&m_Nodes[left], bounds);
+        ComputeNodeBounds(&m_Nodes[left + 1], bounds);
+
+        m_Nodes[node].first = left;
+        m_Nodes[node].count = 0;
+
+        nodes.push_back({ .node = left, .depth = depth + 1 });
+        nodes.push_back({ .node = left + 1, .depth = depth + 1 });
+    }
+
+    m_Nodes.shrink_to_fit();
+}
+
+void Bvh::Refit(const std::vector<Bound>& bounds)
+{
+    // The children are stored after their parent, so they are refit before it
+    for (size_t i = m_Nodes.size(); i-- > 0;)
+    {
+        BvhNode& node = m_Nodes[i];
+        if (node.count != 0)
+        {
+            ComputeNodeBounds(&node, bounds);
+            continue;
+        }
+
+        const BvhNode& first = m_Nodes[node.first];
+        const BvhNode& second = m_Nodes[node.first + 1];
+        node.min = GetMin(first.min, second.min);
+        node.max = GetMax(first.max, second.max);
+    }
+}
+
+void Bvh::Clear()
+{
+    m_Nodes.clear();
+    m_Primitives.clear();
+}
+
+bool_t Bvh::IsEmpty() const
+{
+    return m_Nodes.empty();
+}
+
+const std::vector<BvhNode>& Bvh::GetNodes() const
+{
+    return m_Nodes;
+}
+
+const std::vector<uint32_t>& Bvh::GetPrimitives() const
+{
+    return m_Primitives;
+}
+
+size_t Bvh::GetMemorySize() const
+{
+    return m_Nodes.size() * sizeof(BvhNode) + m_Primitives.size() * sizeof(uint32_t);
+}
+
+void Bvh::ComputeNodeBounds(BvhNode* const node, const std::vector<Bound>& bounds) const
+{
+    node->min = Vector3(Infinity);
+    node->max = Vector3(-Infinity);
+
+    for (uint32_t i = node->first; i < node->first + node->count; i++)
+    {
+        const Bound& bound = bounds[m_Primitives[i]];
+        node->min = GetMin(node->min, bound.GetMin());
+        node->max = GetMax(node->max, bound.GetMax());
+    }
+}
+
+bool_t Bvh::FindSplit(const BvhNode& node, const std::vector<Bound>& bounds, const std::vector<Vector3>& centers, uint32_t* const axis, float_t* const position) const
+{
+    if (node.count <= MaxLeafSize)
+        return false;
+
+    // The bins are placed over the centers, which decide the side of the primitives
+    Vector3 centerMin(Infinity);
+    Vector3 centerMax(-Infinity);
+    for (uint32_t i = node.first; i < node.first + node.count; i++)
+    {
+        centerMin = GetMin(centerMin, centers[m_Primitives[i]]);
+        centerMax = GetMax(centerMax, centers[m_Primitives[i]]);
+    }
+
+    // Leaving the node as a leaf costs intersecting all of its primitives
+    float_t bestCost = static_cast<float_t>(node.count) * GetHalfArea(node.min, node.max);
+    bool_t found = false;
+
+    for (uint32_t a = 0; a < 3; a++)
+    {
+        const float_t extent = centerMax[a] - centerMin[a];
+        if (extent <= 0.f)
+            continue;
+
+        const float_t scale = static_cast<float_t>(BinCount) / extent;
+        std::array<Bin, BinCount> bins;
+        for (uint32_t i = node.first; i < node.first + node.count; i++)
+        {
+            const uint32_t primitive = m_Primitives[i];
+            const uint32_t bin = std::min(static_cast<uint32_t>((centers[primitive][a] - centerMin[a]) * scale), BinCount - 1);
+
+            bins[bin].count++;
+            bins[bin].min = GetMin(bins[bin].min, bounds[primitive].GetMin());
+            bins[bin].max = GetMax(bins[bin].max, bounds[primitive].GetMax());
+        }
+
+        // Cost of the split after each bin, sweeping from both sides
+        std::array<float_t, BinCount - 1> leftCosts;
+        Bin left;
+        for (uint32_t i = 0; i < BinCount - 1; i++)
+        {
+            left.count += bins[i].count;
+            left.min = GetMin(left.min, bins[i].min);
+            left.max = GetMax(left.max, bins[i].max);
+            leftCosts[i] = left.count == 0 ? 0.f : static_cast<float_t>(left.count) * GetHalfArea(left.min, left.max);
+        }
+
+        Bin right;
+        for (uint32_t i = BinCount - 1; i > 0; i--)
+        {
+            right.count += bins[i].count;
+            right.min = GetMin(right.min, bins[i].min);
+            right.max = GetMax(right.max, bins[i].max);
+
+            if (right.count == 0 || right.count == node.count)
+                continue;
+
+            const float_t cost = leftCosts[i - 1] + static_cast<float_t>(right.count) * GetHalfArea(right.min, right.max);
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                *axis = a;
+                *position = centerMin[a] + static_cast<float_t>(i) / scale;
+                found = true;
+            }
+        }
+    }
+
+    return found;
+}
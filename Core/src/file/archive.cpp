@@ -0,0 +1,350 @@
+#include "file/archive.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+#include "utils/formatter.hpp"
+#include "utils/logger.hpp"
+
+using namespace XnorCore;
+
+static_assert(sizeof(ArchiveHeader) == 40, "The ArchiveHeader layout must not depend on the platform");
+static_assert(sizeof(ArchiveEntry) == 48, "The ArchiveEntry layout must not depend on the platform");
+
+static uint64_t AlignUp(const uint64_t value, const uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static void WritePadding(std::ofstream& file, const uint64_t alignment)
+{
+    static constexpr std::array<char_t, 256> Zeros {};
+
+    uint64_t padding = AlignUp(static_cast<uint64_t>(file.tellp()), alignment) - static_cast<uint64_t>(file.tellp());
+    while (padding != 0)
+    {
+        const uint64_t size = std::min<uint64_t>(padding, Zeros.size());
+        file.write(Zeros.data(), static_cast<std::streamsize>(size));
+        padding -= size;
+    }
+}
+
+bool_t Archive::Build(const std::filesystem::path& sourceDirectory, const std::filesystem::path& archivePath, const ArchiveBuildOptions& options)
+{
+    Logger::LogInfo("Building archive {} from directory {}", archivePath, sourceDirectory);
+
+    if (!is_directory(sourceDirectory))
+    {
+        Logger::LogError("Couldn't build archive {}: {} isn't a directory", archivePath, sourceDirectory);
+        return false;
+    }
+
+    if (options.alignment == 0 || (options.alignment & (options.alignment - 1)) != 0)
+    {
+        Logger::LogError("Couldn't build archive {}: alignment {} isn't a power of two", archivePath, options.alignment);
+        return false;
+    }
+
+    auto&& start = std::chrono::system_clock::now();
+
+    // Sort the paths so that building the same directory twice results in the same archive
+    std::vector<std::filesystem::path> paths;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(sourceDirectory))
+    {
+        if (entry.is_regular_file())
+            paths.push_back(entry.path());
+    }
+    std::ranges::sort(paths);
+
+    std::ofstream file(archivePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open() || !file.good())
+    {
+        Logger::LogError("Couldn't open archive for writing: {}", archivePath);
+        return false;
+    }
+
+    ArchiveHeader header
+    {
+        .magic = Magic,
+        .version = Version,
+        .entryCount = static_cast<uint32_t>(paths.size()),
+        .alignment = options.alignment
+    };
+
+    // The header is written again at the end once all offsets are known
+    file.write(reinterpret_cast<const char_t*>(&header), sizeof(header));
+
+    std::vector<ArchiveEntry> entries;
+    entries.reserve(paths.size());
+    std::string entryPaths;
+
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> compressed;
+    uint64_t totalSize = 0;
+    uint64_t totalStoredSize = 0;
+
+    for (const std::filesystem::path& path : paths)
+    {
+        const std::string entryPath = relative(path, sourceDirectory).generic_string();
+
+        std::ifstream source(path, std::ios::in | std::ios::ate | std::ios::binary);
+        if (!source.is_open() || !source.good())
+        {
+            Logger::LogError("Couldn't open file for reading: {}", path);
+            return false;
+        }
+
+        data.resize(static_cast<size_t>(source.tellg()));
+        source.seekg(0);
+        source.read(reinterpret_cast<char_t*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+        ArchiveEntry entry
+        {
+            .pathHash = HashPath(entryPath),
+            .size = data.size(),
+            .pathOffset = static_cast<uint32_t>(entryPaths.size()),
+            .pathLength = static_cast<uint32_t>(entryPath.size())
+        };
+        entryPaths += entryPath;
+
+        const uint8_t* stored = data.data();
+        size_t storedSize = data.size();
+
+        if (options.compression != CompressionFormat::None && !data.empty())
+        {
+            compressed.resize(Compression::GetMaxCompressedSize(options.compression, data.size()));
+            const size_t compressedSize = Compression::Compress(options.compression, data.data(), data.size(), compressed.data(), compressed.size());
+
+            // Only keep the compressed data if it is worth the decompression cost
+            if (compressedSize != 0 && static_cast<float_t>(compressedSize) <= static_cast<float_t>(data.size()) * options.maxCompressionRatio)
+            {
+                stored = compressed.data();
+                storedSize = compressedSize;
+                entry.compression = options.compression;
+            }
+        }
+
+        WritePadding(file, options.alignment);
+        entry.offset = static_cast<uint64_t>(file.tellp());
+        entry.storedSize = storedSize;
+        file.write(reinterpret_cast<const char_t*>(stored), static_cast<std::streamsize>(storedSize));
+
+        totalSize += entry.size;
+        totalStoredSize += entry.storedSize;
+        entries.push_back(entry);
+    }
+
+    std::ranges::sort(entries, [](const ArchiveEntry& lhs, const ArchiveEntry& rhs) -> bool_t { return lhs.pathHash < rhs.pathHash; });
+
+    const auto duplicate = std::ranges::adjacent_find(entries, [](const ArchiveEntry& lhs, const ArchiveEntry& rhs) -> bool_t { return lhs.pathHash == rhs.pathHash; });
+    if (duplicate != entries.end())
+    {
+        Logger::LogError(
+            "Couldn't build archive {}: path hash collision for {}",
+            archivePath,
+            std::string_view(entryPaths).substr(duplicate->pathOffset, duplicate->pathLength)
+        );
+        return false;
+    }
+
+    WritePadding(file, alignof(ArchiveEntry));
+    header.indexOffset = static_cast<uint64_t>(file.tellp());
+    file.write(reinterpret_cast<const char_t*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(ArchiveEntry)));
+
+    header.pathsOffset = static_cast<uint64_t>(file.tellp());
+    header.pathsSize = entryPaths.size();
+    file.write(entryPaths.data(), static_cast<std::streamsize>(entryPaths.size()));
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char_t*>(&header), sizeof(header));
+
+    if (!file.good())
+    {
+        Logger::LogError("An error occured while writing archive {}", archivePath);
+        return false;
+    }
+
+    Logger::LogInfo(
+        "Archive {} built with {} entries ({} bytes stored for {} bytes of data). Took {}",
+        archivePath,
+        entries.size(),
+        totalStoredSize,
+        totalSize,
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start)
+    );
+
+    return true;
+}
+
+uint64_t Archive::HashPath(const std::string_view path)
+{
+    // 64-bit FNV-1a
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (const char_t c : path)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001B3ull;
+    }
+
+    return hash;
+}
+
+bool_t Archive::Open(const std::filesystem::path& path)
+{
+    Close();
+
+    // Entries are accessed in any order, so reading ahead would mostly be wasted
+    if (!m_Mapping.Open(path, MappingAccess::Random))
+        return false;
+
+    const uint8_t* const data = m_Mapping.GetData();
+    const size_t size = m_Mapping.GetSize();
+
+    ArchiveHeader header;
+    if (size < sizeof(header))
+    {
+        Logger::LogError("Invalid archive {}: file is too small", path);
+        m_Mapping.Close();
+        return false;
+    }
+
+    std::memcpy(&header, data, sizeof(header));
+
+    if (header.magic != Magic || header.version != Version)
+    {
+        Logger::LogError("Invalid archive {}: wrong magic number or unsupported version {}", path, header.version);
+        m_Mapping.Close();
+        return false;
+    }
+
+    if (header.indexOffset % alignof(ArchiveEntry) != 0
+        || header.indexOffset > size
+        || (size - header.indexOffset) / sizeof(ArchiveEntry) < header.entryCount
+        || header.pathsOffset > size
+        || size - header.pathsOffset < header.pathsSize)
+    {
+        Logger::LogError("Invalid archive {}: index is out of bounds", path);
+        m_Mapping.Close();
+        return false;
+    }
+
+    m_Entries = reinterpret_cast<const ArchiveEntry*>(data + header.indexOffset);
+    m_EntryCount = header.entryCount;
+    m_Paths = reinterpret_cast<const char_t*>(data + header.pathsOffset);
+
+    // Validate every entry once so that accessors don't need to
+    for (size_t i = 0; i < m_EntryCount; i++)
+    {
+        const ArchiveEntry& entry = m_Entries[i];
+        if (entry.offset > size
+            || size - entry.offset < entry.storedSize
+            || entry.pathOffset > header.pathsSize
+            || header.pathsSize - entry.pathOffset < entry.pathLength
+            || entry.compression > CompressionFormat::Lz4
+            || (i != 0 && m_Entries[i - 1].pathHash >= entry.pathHash))
+        {
+            Logger::LogError("Invalid archive {}: entry {} is corrupted", path, i);
+            Close();
+            return false;
+        }
+    }
+
+    m_Path = path;
+
+    Logger::LogDebug("Opened archive {} with {} entries", path, m_EntryCount);
+
+    return true;
+}
+
+void Archive::Close()
+{
+    m_Mapping.Close();
+
+    m_Path.clear();
+    m_Entries = nullptr;
+    m_EntryCount = 0;
+    m_Paths = nullptr;
+}
+
+bool_t Archive::IsOpen() const
+{
+    return m_Mapping.IsOpen();
+}
+
+const std::filesystem::path& Archive::GetPath() const
+{
+    return m_Path;
+}
+
+size_t Archive::GetEntryCount() const
+{
+    return m_EntryCount;
+}
+
+const ArchiveEntry& Archive::GetEntry(const size_t index) const
+{
+    return m_Entries[index];
+}
+
+std::string_view Archive::GetEntryPath(const size_t index) const
+{
+    const ArchiveEntry& entry = m_Entries[index];
+    return { m_Paths + entry.pathOffset, entry.pathLength };
+}
+
+bool_t Archive::Find(const std::string_view path, size_t* const index) const
+{
+    const uint64_t hash = HashPath(path);
+
+    const ArchiveEntry* const end = m_Entries + m_EntryCount;
+    const ArchiveEntry* const entry = std::lower_bound(
+        m_Entries,
+        end,
+        hash,
+        [](const ArchiveEntry& e, const uint64_t h) -> bool_t { return e.pathHash < h; }
+    );
+
+    if (entry == end || entry->pathHash != hash)
+        return false;
+
+    const size_t i = static_cast<size_t>(entry - m_Entries);
+
+    // Guard against hash collisions with paths that aren't in the archive
+    if (GetEntryPath(i) != path)
+        return false;
+
+    *index = i;
+    return true;
+}
+
+uint8_t* Archive::GetStoredData(const size_t index)
+{
+    return m_Mapping.GetData() + m_Entries[index].offset;
+}
+
+bool_t Archive::Extract(const size_t index, uint8_t* const destination)
+{
+    const ArchiveEntry& entry = m_Entries[index];
+
+    if (!Compression::Decompress(
+        static_cast<CompressionFormat::CompressionFormat>(entry.compression),
+        GetStoredData(index),
+        entry.storedSize,
+        destination,
+        entry.size
+    ))
+    {
+        Logger::LogError("Couldn't extract entry {} from archive {}", GetEntryPath(index), m_Path);
+        return false;
+    }
+
+    return true;
+}
+
+void Archive::Prefetch(const size_t index) const
+{
+    const ArchiveEntry& entry = m_Entries[index];
+    m_Mapping.Prefetch(entry.offset, entry.storedSize);
+}
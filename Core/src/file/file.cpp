@@ -5,6 +5,7 @@
 
 #include "file/file_manager.hpp"
 #include "resource/animation_montage.hpp"
+#include "resource/audio_track.hpp"
 #include "resource/compute_shader.hpp"
 #include "resource/font.hpp"
 #include "resource/mesh.hpp"
@@ -28,6 +29,14 @@ File::File(std::filesystem::path&& filepath)
     File::UpdateUtilityValues();
 }
 
+File::File(std::filesystem::path&& filepath, const Pointer<Archive>& archive, const size_t archiveIndex)
+    : Entry(std::move(filepath))
+    , m_Archive(archive)
+    , m_ArchiveIndex(archiveIndex)
+{
+    File::UpdateUtilityValues();
+}
+
 File::~File()
 {
     if (m_Loaded)
@@ -36,6 +45,52 @@ File::~File()
 
 bool_t File::Load()
 {
+    if (m_Archive)
+    {
+        const ArchiveEntry& entry = m_Archive->GetEntry(m_ArchiveIndex);
+        m_Size = static_cast<int64_t>(entry.size);
+
+        if (entry.compression == CompressionFormat::None)
+        {
+            // Uncompressed entries can be used directly from the archive mapping
+            m_Data = reinterpret_cast<int8_t*>(m_Archive->GetStoredData(m_ArchiveIndex));
+            m_OwnsData = false;
+        }
+        else
+        {
+            m_Data = new int8_t[m_Size];
+            m_OwnsData = true;
+
+            if (!m_Archive->Extract(m_ArchiveIndex, reinterpret_cast<uint8_t*>(m_Data)))
+            {
+                Unload();
+                return false;
+            }
+        }
+
+        m_Loaded = true;
+        return true;
+    }
+
+    if (ShouldMemoryMap())
+    {
+        // Loaders parse the file from start to end
+        if (m_Mapping.Open(m_Path, MappingAccess::Sequential))
+        {
+            m_Data = reinterpret_cast<int8_t*>(m_Mapping.GetData());
+            m_Size = static_cast<int64_t>(m_Mapping.GetSize());
+            m_OwnsData = false;
+
+            // Start reading the file asynchronously as it is very likely to be parsed soon
+            m_Mapping.Prefetch(0, m_Mapping.GetSize());
+
+            m_Loaded = true;
+            return true;
+        }
+
+        Logger::LogWarning("Couldn't memory map file {}, reading it instead", m_Path);
+    }
+
     std::ifstream file(m_Path, std::ios::in | std::ios::ate | std::ios::binary);
 
     if (!file.is_open() || !file.good())
@@ -48,6 +103,7 @@ bool_t File::Load()
     file.seekg(0);
 
     m_Data = new int8_t[m_Size];
+    m_OwnsData = true;
 
     file.read(reinterpret_cast<char*>(m_Data), m_Size);
     
@@ -57,7 +113,10 @@ bool_t File::Load()
 
 void File::Unload()
 {
-    delete[] m_Data;
+    if (m_Mapping.IsOpen())
+        m_Mapping.Close();
+    else if (m_OwnsData)
+        delete[] m_Data;
     m_Data = nullptr;
     m_Size = 0;
     
@@ -81,6 +140,12 @@ File::Type File::GetType() const
 
 void File::Delete() const
 {
+    if (m_Archive)
+    {
+        Logger::LogError("Cannot delete file {} as it is stored in archive {}", m_Path, m_Archive->GetPath());
+        return;
+    }
+
     // We need copies of these variables because they may otherwise be destroyed by FileManager::Unload
     const std::filesystem::path path = m_Path;
     const Pointer<Resource> resource = m_Resource;
@@ -112,6 +177,21 @@ int64_t File::GetSize() const
     return m_Size;
 }
 
+bool_t File::IsMemoryMapped() const
+{
+    return m_Mapping.IsOpen();
+}
+
+bool_t File::IsArchived() const
+{
+    return static_cast<bool_t>(m_Archive);
+}
+
+Pointer<Archive> File::GetArchive() const
+{
+    return m_Archive;
+}
+
 void File::SetName(const std::string& newName)
 {
     Entry::SetName(newName);
@@ -124,6 +204,19 @@ Pointer<Resource> File::GetResource() const
     return m_Resource;
 }
 
+bool_t File::ShouldMemoryMap() const
+{
+    if (!useMemoryMapping)
+        return false;
+
+    if (m_Type != Type::Texture && m_Type != Type::Mesh && m_Type != Type::Font && !Utils::StringArrayContains(AudioTrack::FileExtensions, m_Extension))
+        return false;
+
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(m_Path, error);
+    return !error && size >= static_cast<uintmax_t>(memoryMappingMinSize);
+}
+
 void File::UpdateUtilityValues()
 {
     Entry::UpdateUtilityValues();
@@ -148,6 +148,75 @@ Pointer<Directory> FileManager::LoadDirectory(std::filesystem::path path)
     return directory;
 }
 
+Pointer<Archive> FileManager::MountArchive(const std::filesystem::path& archivePath, const std::filesystem::path& mountPoint)
+{
+    Logger::LogInfo("Mounting archive {} on {}...", archivePath, mountPoint);
+
+    auto&& start = std::chrono::system_clock::now();
+
+    Pointer<Archive> archive = Pointer<Archive>::New();
+    if (!archive->Open(archivePath))
+        return nullptr;
+
+    size_t skipped = 0;
+    for (size_t i = 0; i < archive->GetEntryCount(); i++)
+    {
+        std::filesystem::path path = mountPoint / archive->GetEntryPath(i);
+        path.make_preferred();
+
+        if (Contains(path))
+        {
+            skipped++;
+            continue;
+        }
+
+        Pointer<File> file = Pointer<File>::New(std::move(path), archive, i);
+        // Uncompressed entries are only views of the archive mapping, so loading them is cheap
+        if (!file->Load())
+        {
+            Logger::LogError("Couldn't load file {} from archive {}", file->GetPath(), archivePath);
+            continue;
+        }
+
+        m_Entries[file->GetPath()] = file.CreateStrongReference();
+    }
+
+    if (skipped != 0)
+        Logger::LogWarning("{} entries of archive {} were skipped because they were already loaded", skipped, archivePath);
+
+    m_Archives.push_back(archive.CreateStrongReference());
+
+    // Make sure to return a weak reference
+    archive.ToWeakReference();
+
+    Logger::LogDebug("Archive {} mount successful. Took {}", archivePath, std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start));
+
+    return archive;
+}
+
+void FileManager::UnmountArchive(Pointer<Archive> archive)
+{
+    Logger::LogInfo("Unmounting archive {}", archive->GetPath());
+
+    // Files need to be unloaded before closing the archive as they may point to its mapping
+    for (decltype(m_Entries)::iterator it = m_Entries.begin(); it != m_Entries.end();)
+    {
+        Pointer<File> file = Utils::DynamicPointerCast<File>(it->second);
+        if (file && file->GetArchive() == archive)
+        {
+            if (file->GetLoaded())
+                file->Unload();
+            it = m_Entries.erase(it);
+            continue;
+        }
+
+        it++;
+    }
+
+    archive->Close();
+    std::erase(m_Archives, archive);
+}
+
 bool_t FileManager::Contains(const std::filesystem::path& path)
 {
     return m_Entries.contains(path);
@@ -238,6 +307,8 @@ void FileManager::UnloadAll()
 
     // Smart pointers are deleted automatically, we only need to clear the container
     m_Entries.clear();
+    // Archives need to outlive the files that may point to their mapping
+    m_Archives.clear();
 
     Logger::LogDebug("FileManager unload successful. Took {}", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start));
 }
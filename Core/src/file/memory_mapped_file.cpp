@@ -0,0 +1,169 @@
+#include "file/memory_mapped_file.hpp"
+
+#include "utils/formatter.hpp"
+#include "utils/logger.hpp"
+
+#ifdef _WIN32
+#include "utils/windows.hpp"
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace XnorCore;
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+bool_t MemoryMappedFile::Open(const std::filesystem::path& path, const ENUM_VALUE(MappingAccess) access)
+{
+    Close();
+
+#ifdef _WIN32
+    const DWORD flags = access == MappingAccess::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+    // Allow the file to be renamed while it is mapped, e.g. from the editor content browser
+    const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        Logger::LogError("Couldn't open file for mapping: {}", path);
+        Windows::SilenceError();
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        Logger::LogError("Couldn't get the size of file {}", path);
+        Windows::CheckError();
+        CloseHandle(file);
+        return false;
+    }
+
+    m_Size = static_cast<size_t>(size.QuadPart);
+
+    // Empty files cannot be mapped
+    if (m_Size != 0)
+    {
+        m_MappingHandle = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (m_MappingHandle)
+            m_Data = static_cast<uint8_t*>(MapViewOfFile(m_MappingHandle, FILE_MAP_COPY, 0, 0, 0));
+
+        if (!m_Data)
+        {
+            Logger::LogError("Couldn't map file {}", path);
+            Windows::CheckError();
+            CloseHandle(file);
+            Close();
+            return false;
+        }
+    }
+
+    // The mapping keeps its own reference to the file
+    CloseHandle(file);
+#else
+    const int32_t file = open(path.c_str(), O_RDONLY);
+    if (file == -1)
+    {
+        Logger::LogError("Couldn't open file for mapping: {}", path);
+        return false;
+    }
+
+    struct stat status {};
+    if (fstat(file, &status) == -1)
+    {
+        Logger::LogError("Couldn't get the size of file {}", path);
+        close(file);
+        return false;
+    }
+
+    m_Size = static_cast<size_t>(status.st_size);
+
+    // Empty files cannot be mapped
+    if (m_Size != 0)
+    {
+        void* const data = mmap(nullptr, m_Size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+        if (data == MAP_FAILED)
+        {
+            Logger::LogError("Couldn't map file {}", path);
+            close(file);
+            m_Size = 0;
+            return false;
+        }
+
+        m_Data = static_cast<uint8_t*>(data);
+        madvise(m_Data, m_Size, access == MappingAccess::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    }
+
+    // The mapping stays valid after the file descriptor is closed
+    close(file);
+#endif
+
+    m_Open = true;
+    return true;
+}
+
+void MemoryMappedFile::Close()
+{
+#ifdef _WIN32
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+
+    if (m_MappingHandle)
+        CloseHandle(m_MappingHandle);
+
+    m_MappingHandle = nullptr;
+#else
+    if (m_Data)
+        munmap(m_Data, m_Size);
+#endif
+
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Open = false;
+}
+
+void MemoryMappedFile::Prefetch(const size_t offset, const size_t size) const
+{
+    if (!m_Data || offset >= m_Size)
+        return;
+
+    const size_t clampedSize = std::min(size, m_Size - offset);
+
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range
+    {
+        .VirtualAddress = m_Data + offset,
+        .NumberOfBytes = clampedSize
+    };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    // madvise needs a page-aligned address
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t alignedOffset = offset / pageSize * pageSize;
+    madvise(m_Data + alignedOffset, clampedSize + offset - alignedOffset, MADV_WILLNEED);
+#endif
+}
+
+bool_t MemoryMappedFile::IsOpen() const
+{
+    return m_Open;
+}
+
+const uint8_t* MemoryMappedFile::GetData() const
+{
+    return m_Data;
+}
+
+uint8_t* MemoryMappedFile::GetData()
+{
+    return m_Data;
+}
+
+size_t MemoryMappedFile::GetSize() const
+{
+    return m_Size;
+}
@@ -0,0 +1,93 @@
+#include "rendering/animation_event_track.hpp"
+
+#include <algorithm>
+
+using namespace XnorCore;
+
+void AnimationEventTrack::Add(const float_t time, const FunctionT& function)
+{
+    const size_t index = static_cast<size_t>(std::ranges::upper_bound(m_Times, time) - m_Times.begin());
+    m_Times.insert(m_Times.begin() + static_cast<std::ptrdiff_t>(index), time);
+    m_Functions.insert(m_Functions.begin() + static_cast<std::ptrdiff_t>(index), function);
+
+    // An event which was already passed waits for the next loop
+    if (index < m_Cursor || (index == m_Cursor && time < m_Time))
+        m_Cursor++;
+}
+
+void AnimationEventTrack::Clear()
+{
+    m_Times.clear();
+    m_Functions.clear();
+    m_Cursor = 0;
+}
+
+void AnimationEventTrack::Seek(const float_t time)
+{
+    m_Time = time;
+    m_Cursor = static_cast<size_t>(std::ranges::lower_bound(m_Times, time) - m_Times.begin());
+}
+
+size_t AnimationEventTrack::Advance(const float_t deltaTime, const bool_t looping)
+{
+    if (deltaTime <= 0.f)
+        return 0;
+
+    size_t firedCount = 0;
+    float_t target = m_Time + deltaTime;
+
+    while (true)
+    {
+        const bool_t reachesEnd = m_Duration > 0.f && target >= m_Duration;
+
+        // Only the next event is compared with the time, the cursor then moves past the fired ones
+        while (m_Cursor < m_Times.size() && (reachesEnd ? m_Times[m_Cursor] <= m_Duration : m_Times[m_Cursor] < target))
+        {
+            m_Functions[m_Cursor++]();
+            firedCount++;
+        }
+
+        if (!reachesEnd)
+        {
+            m_Time = target;
+            break;
+        }
+
+        if (!looping)
+        {
+            m_Time = m_Duration;
+            break;
+        }
+
+        target -= m_Duration;
+        m_Time = 0.f;
+        m_Cursor = 0;
+    }
+
+    return firedCount;
+}
+
+float_t AnimationEventTrack::GetDuration() const
+{
+    return m_Duration;
+}
+
+void AnimationEventTrack::SetDuration(const float_t duration)
+{
+    m_Duration = duration;
+}
+
+float_t AnimationEventTrack::GetTime() const
+{
+    return m_Time;
+}
+
+size_t AnimationEventTrack::GetCursor() const
+{
+    return m_Cursor;
+}
+
+size_t AnimationEventTrack::GetEventCount() const
+{
+    return m_Times.size();
+}
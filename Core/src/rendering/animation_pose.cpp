@@ -0,0 +1,193 @@
+#include "rendering/animation_pose.hpp"
+
+#include <algorithm>
+
+#include <emmintrin.h>
+
+using namespace XnorCore;
+
+static_assert(sizeof(Vector3) == 3 * sizeof(float_t), "The translations and scales are blended as arrays of floats");
+static_assert(sizeof(Quaternion) == 4 * sizeof(float_t), "The rotations are blended as 4 floats each");
+
+// Lerp between 2 arrays of floats, 4 at a time
+static void LerpFloats(const float_t* const from, const float_t* const to, const float_t t, float_t* const result, const size_t count)
+{
+    const __m128 factor = _mm_set1_ps(t);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 a = _mm_loadu_ps(&from[i]);
+        const __m128 b = _mm_loadu_ps(&to[i]);
+        _mm_storeu_ps(&result[i], _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), factor)));
+    }
+
+    for (; i < count; i++)
+        result[i] = from[i] + (to[i] - from[i]) * t;
+}
+
+// Sum of the 4 components, in all of them
+static __m128 HorizontalSum(const __m128 v)
+{
+    const __m128 pairs = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_add_ps(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+// Normalized lerp between 2 arrays of quaternions, taking the shortest path
+static void NlerpQuaternions(const Quaternion* const from, const Quaternion* const to, const float_t t, Quaternion* const result, const size_t count)
+{
+    const __m128 factor = _mm_set1_ps(t);
+    const __m128 signMask = _mm_set1_ps(-0.f);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const __m128 a = _mm_loadu_ps(&from[i].imaginary.x);
+        __m128 b = _mm_loadu_ps(&to[i].imaginary.x);
+
+        // q and -q are the same rotation, flip b towards a
+        const __m128 dot = HorizontalSum(_mm_mul_ps(a, b));
+        b = _mm_xor_ps(b, _mm_and_ps(dot, signMask));
+
+        const __m128 lerp = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), factor));
+        const __m128 length = _mm_sqrt_ps(HorizontalSum(_mm_mul_ps(lerp, lerp)));
+        _mm_storeu_ps(&result[i].imaginary.x, _mm_div_ps(lerp, length));
+    }
+}
+
+static Quaternion Nlerp(const Quaternion& from, const Quaternion& to, const float_t t)
+{
+    const Quaternion target = Quaternion::Dot(from, to) < 0.f ? -to : to;
+    return (from + (target - from) * t).Normalized();
+}
+
+AnimationPose::AnimationPose(const size_t boneCount)
+{
+    Resize(boneCount);
+    SetIdentity();
+}
+
+void AnimationPose::Resize(const size_t boneCount)
+{
+    if (boneCount > m_Translations.size())
+    {
+        m_Translations.resize(boneCount);
+        m_Rotations.resize(boneCount, Quaternion::Identity());
+        m_Scalings.resize(boneCount, Vector3(1.f));
+    }
+
+    m_BoneCount = boneCount;
+}
+
+void AnimationPose::SetIdentity()
+{
+    std::fill_n(m_Translations.begin(), m_BoneCount, Vector3::Zero());
+    std::fill_n(m_Rotations.begin(), m_BoneCount, Quaternion::Identity());
+    std::fill_n(m_Scalings.begin(), m_BoneCount, Vector3(1.f));
+}
+
+void AnimationPose::Blend(const AnimationPose& from, const AnimationPose& to, const float_t t, AnimationPose* const result)
+{
+    const size_t boneCount = std::min(from.m_BoneCount, to.m_BoneCount);
+    result->Resize(boneCount);
+    if (boneCount == 0)
+        return;
+
+    LerpFloats(&from.m_Translations.data()->x, &to.m_Translations.data()->x, t, &result->m_Translations.data()->x, boneCount * 3);
+    NlerpQuaternions(from.m_Rotations.data(), to.m_Rotations.data(), t, result->m_Rotations.data(), boneCount);
+    LerpFloats(&from.m_Scalings.data()->x, &to.m_Scalings.data()->x, t, &result->m_Scalings.data()->x, boneCount * 3);
+}
+
+void AnimationPose::Blend(const AnimationPose& from, const AnimationPose& to, const std::vector<float_t>& boneWeights, const float_t t, AnimationPose* const result)
+{
+    const size_t boneCount = std::min(from.m_BoneCount, to.m_BoneCount);
+    result->Resize(boneCount);
+
+    for (size_t i = 0; i < boneCount; i++)
+    {
+        const float_t weight = i < boneWeights.size() ? boneWeights[i] * t : 0.f;
+        result->m_Translations[i] = Vector3::Lerp(from.m_Translations[i], to.m_Translations[i], weight);
+        result->m_Rotations[i] = Nlerp(from.m_Rotations[i], to.m_Rotations[i], weight);
+        result->m_Scalings[i] = Vector3::Lerp(from.m_Scalings[i], to.m_Scalings[i], weight);
+    }
+}
+
+void AnimationPose::Add(const AnimationPose& base, const AnimationPose& additive, const AnimationPose& reference, const float_t weight, AnimationPose* const result)
+{
+    const size_t boneCount = std::min({ base.m_BoneCount, additive.m_BoneCount, reference.m_BoneCount });
+    result->Resize(boneCount);
+
+    for (size_t i = 0; i < boneCount; i++)
+    {
+        // The rotation from the reference to the additive pose is applied in the local space of the bone
+        const Quaternion difference = reference.m_Rotations[i].Inverted() * additive.m_Rotations[i];
+
+        result->m_Translations[i] = base.m_Translations[i] + (additive.m_Translations[i] - reference.m_Translations[i]) * weight;
+        result->m_Rotations[i] = (base.m_Rotations[i] * Nlerp(Quaternion::Identity(), difference, weight)).Normalized();
+        result->m_Scalings[i] = base.m_Scalings[i] + (additive.m_Scalings[i] - reference.m_Scalings[i]) * weight;
+    }
+}
+
+void AnimationPose::ComputeMatrices(const List<Bone>& bones, Matrix* const modelMatrices, Matrix* const skinningMatrices) const
+{
+    const size_t boneCount = std::min(bones.GetSize(), m_BoneCount);
+
+    for (size_t i = 0; i < boneCount; i++)
+    {
+        const Bone& bone = bones[i];
+
+        if (static_cast<size_t>(bone.id) >= boneCount)
+            continue;
+
+        Matrix local;
+        Matrix::Trs(m_Translations[i], m_Rotations[i], m_Scalings[i], &local);
+
+        if (bone.parentId != -1)
+        {
+            // The bone has a parent, so apply the parent global transform to it
+            modelMatrices[bone.id] = modelMatrices[bones[bone.parentId].id] * local;
+        }
+        else
+        {
+            // The bone has no parent, so its global transform is the same as its local
+            modelMatrices[bone.id] = local;
+        }
+
+        // Apply the inverse to the global transform to remove the bind pose transform
+        skinningMatrices[bone.id] = modelMatrices[bone.id] * bone.global;
+    }
+}
+
+size_t AnimationPose::GetBoneCount() const
+{
+    return m_BoneCount;
+}
+
+Vector3* AnimationPose::GetTranslations()
+{
+    return m_Translations.data();
+}
+
+const Vector3* AnimationPose::GetTranslations() const
+{
+    return m_Translations.data();
+}
+
+Quaternion* AnimationPose::GetRotations()
+{
+    return m_Rotations.data();
+}
+
+const Quaternion* AnimationPose::GetRotations() const
+{
+    return m_Rotations.data();
+}
+
+Vector3* AnimationPose::GetScalings()
+{
+    return m_Scalings.data();
+}
+
+const Vector3* AnimationPose::GetScalings() const
+{
+    return m_Scalings.data();
+}
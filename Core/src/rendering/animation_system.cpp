@@ -0,0 +1,177 @@
+#include "rendering/animation_system.hpp"
+
+#include <algorithm>
+#include <execution>
+#include <limits>
+#include <numeric>
+
+#include <Maths/calc.hpp>
+
+#include "scene/scene.hpp"
+#include "scene/component/skinned_mesh_renderer.hpp"
+
+using namespace XnorCore;
+
+static_assert(std::tuple_size_v<decltype(AnimationStats::lodAnimatorCounts)> == AnimationSystem::LodCount, "There is a count for each level of detail");
+
+void AnimationSystem::Gather(Scene& scene)
+{
+    Clear();
+
+    scene.GetAllComponentsOfType<SkinnedMeshRenderer>(&m_SkinnedMeshRenderers);
+    for (SkinnedMeshRenderer* const skinnedMeshRenderer : m_SkinnedMeshRenderers)
+    {
+        if (!skinnedMeshRenderer->mesh.IsValid())
+        {
+            Add(&skinnedMeshRenderer->GetAnimator());
+            continue;
+        }
+
+        // The bind pose is close enough to choose a level of detail, and doesn't go through every bone
+        Add(&skinnedMeshRenderer->GetAnimator(), Bound::GetAabbFromTransform(skinnedMeshRenderer->mesh->aabb, skinnedMeshRenderer->GetTransform()));
+    }
+}
+
+void AnimationSystem::Add(Animator* const animator)
+{
+    m_Animators.push_back(animator);
+    m_Bounds.emplace_back();
+}
+
+void AnimationSystem::Add(Animator* const animator, const Bound& bound)
+{
+    m_Animators.push_back(animator);
+    m_Bounds.push_back(bound);
+}
+
+void AnimationSystem::AddView(const Camera& camera, const Vector2i screenSize)
+{
+    if (screenSize.x <= 0 || screenSize.y <= 0)
+        return;
+
+    View& view = m_Views.emplace_back();
+    view.camera = camera;
+    view.frustum.UpdateFromCamera(camera, static_cast<float_t>(screenSize.x) / static_cast<float_t>(screenSize.y));
+}
+
+void AnimationSystem::Clear()
+{
+    m_Animators.clear();
+    m_Bounds.clear();
+}
+
+void AnimationSystem::Update(const float_t deltaTime, const bool_t parallel)
+{
+    // Shared animations are bound on this thread, the workers then only read them
+    for (Animator* const animator : m_Animators)
+        animator->Prepare();
+
+    m_Stats = {};
+    m_Stats.animatorCount = m_Animators.size();
+
+    // Choose which animators are updated this frame, the other ones keep their pose and catch up later
+    m_UpdatedAnimators.clear();
+    for (size_t i = 0; i < m_Animators.size(); i++)
+    {
+        Animator* const animator = m_Animators[i];
+        const size_t lod = GetLod(m_Bounds[i]);
+        const AnimationLodLevel& level = lodLevels[lod];
+        m_Stats.lodAnimatorCounts[lod]++;
+
+        // The phases stagger the animators of a level over its interval, so that each frame updates about as many, and
+        // they are kept while the animators stay in the level so that none of them is held for longer than the interval
+        if (animator->m_UpdateLod != lod)
+        {
+            animator->m_UpdateLod = lod;
+            animator->m_UpdatePhase = m_NextUpdatePhases[lod]++;
+        }
+
+        if (level.updateInterval == 0 || (m_FrameIndex + animator->m_UpdatePhase) % level.updateInterval != 0)
+        {
+            animator->Hold(deltaTime);
+            continue;
+        }
+
+        animator->SetSkippedLeafLevels(level.skippedLeafLevels);
+        m_UpdatedAnimators.push_back(animator);
+    }
+
+    m_Views.clear();
+    m_FrameIndex++;
+
+    const size_t batchCount = (m_UpdatedAnimators.size() + BatchSize - 1) / BatchSize;
+    if (m_Batches.size() != batchCount)
+    {
+        m_Batches.resize(batchCount);
+        std::iota(m_Batches.begin(), m_Batches.end(), 0);
+    }
+
+    const auto animateBatch = [this, deltaTime](const uint32_t batch) -> void
+    {
+        const size_t end = std::min(static_cast<size_t>(batch + 1) * BatchSize, m_UpdatedAnimators.size());
+        for (size_t i = static_cast<size_t>(batch) * BatchSize; i < end; i++)
+            m_UpdatedAnimators[i]->Animate(deltaTime);
+    };
+
+    if (parallel)
+        std::for_each(std::execution::par, m_Batches.begin(), m_Batches.end(), animateBatch);
+    else
+        std::for_each(m_Batches.begin(), m_Batches.end(), animateBatch);
+
+    m_Stats.updatedAnimatorCount = m_UpdatedAnimators.size();
+    for (const Animator* const animator : m_Animators)
+        m_Stats.boneCount += animator->GetBoneCount();
+    for (const Animator* const animator : m_UpdatedAnimators)
+        m_Stats.animatedBoneCount += animator->GetSampledBoneCount();
+}
+
+size_t AnimationSystem::GetLod(const Bound& bound) const
+{
+    // Without a bound or a view, there is nothing to choose the level of detail from
+    if (bound.extents == Vector3::Zero() || m_Views.empty())
+        return 0;
+
+    float_t screenSize = -1.f;
+    for (const View& view : m_Views)
+    {
+        if (view.frustum.IsOnFrustum(bound))
+            screenSize = std::max(screenSize, GetScreenSize(view.camera, bound));
+    }
+
+    // Not seen by any view
+    if (screenSize < 0.f)
+        return LodCount - 1;
+
+    for (size_t i = 0; i < LodCount - 1; i++)
+    {
+        if (screenSize >= lodLevels[i].minScreenSize)
+            return i;
+    }
+
+    return LodCount - 1;
+}
+
+float_t AnimationSystem::GetScreenSize(const Camera& camera, const Bound& bound)
+{
+    const float_t radius = bound.extents.Length();
+
+    if (camera.isOrthographic)
+        return 2.f * radius / std::abs(camera.bottomtop.y - camera.bottomtop.x);
+
+    const float_t distance = (bound.center - camera.position).Length();
+    if (distance <= radius)
+        return std::numeric_limits<float_t>::max();
+
+    // Diameter of the bounding sphere over the height of the screen at its distance
+    return radius / (distance * std::tan(camera.fov * Calc::Deg2Rad * 0.5f));
+}
+
+const std::vector<Animator*>& AnimationSystem::GetAnimators() const
+{
+    return m_Animators;
+}
+
+const AnimationStats& AnimationSystem::GetStats() const
+{
+    return m_Stats;
+}
@@ -1,7 +1,10 @@
 ﻿#include "rendering/animator.hpp"
 
+#include <cmath>
+
 #include "input/time.hpp"
 #include "utils/utils.hpp"
+#include "rendering/blend_tree.hpp"
 #include "resource/animation.hpp"
 #include "utils/logger.hpp"
 
@@ -16,6 +19,8 @@ void Animator::Start(const Pointer<Animation>& animation)
 {
     m_Animation = animation;
     m_FrameCount = animation->GetFrameCount();
+    // The bones skipped by a LOD mustn't keep the pose of the previous animation
+    m_IsPoseComplete = false;
 }
 
 void Animator::StartBlending(Animator* const target)
@@ -23,90 +28,145 @@ void Animator::StartBlending(Animator* const target)
     m_BlendTarget = target;
 }
 
+void Animator::SetBlendTree(BlendTree* const blendTree)
+{
+    m_BlendTree = blendTree;
+}
+
+BlendTree* Animator::GetBlendTree() const
+{
+    return m_BlendTree;
+}
+
+void Animator::Prepare()
+{
+    if (m_BlendTree)
+        m_BlendTree->Prepare();
+
+    // The skeleton might have been changed since the animation was bound to it
+    if (m_Animation && m_Animation->skeleton && !m_Animation->IsBound())
+        m_Animation->BindSkeleton(m_Animation->skeleton);
+
+    if (m_BlendTarget)
+        m_BlendTarget->Prepare();
+}
+
 void Animator::Animate()
 {
+    Animate(Time::GetDeltaTime());
+}
+
+void Animator::Animate(float_t deltaTime)
+{
+    m_RootMotionTranslation = Vector3();
+    m_RootMotionYaw = 0.f;
+
+    if (m_BlendTree)
+    {
+        AnimateBlendTree(deltaTime);
+        return;
+    }
+
     if (!m_Animation)
         return;
     
     if (!m_Animation->skeleton)
         return;
+
+    // Catch up with the frames the animator was held for
+    deltaTime += m_HeldTime;
+    m_HeldTime = 0.f;
+    m_SampledBoneCount = 0;
+
+    if (!m_Animation->IsBound())
+        m_Animation->BindSkeleton(m_Animation->skeleton);
     
     m_FrameCount = m_Animation->GetFrameCount();
 
-    UpdateTime();
+    // The root movement is read from its baked track before the time wraps, without sampling any pose
+    const float_t duration = m_Animation->GetDuration();
+    m_Animation->GetRootMotion().GetDelta(m_Time / duration, deltaTime * m_PlaySpeed / duration, &m_RootMotionTranslation, &m_RootMotionYaw);
 
-    size_t nextFrame = m_CurrentFrame;
-    if (m_PlaySpeed < 0)
-    {
-        if (m_CurrentFrame == 0)
-            nextFrame = m_FrameCount - 1;
-        else
-            nextFrame = (m_CurrentFrame - 1) % m_FrameCount;
-    }
-    else
-    {
-        nextFrame = (m_CurrentFrame + 1) % m_FrameCount;
-    }
-    float_t t = std::fmodf(m_Time, m_Animation->GetFrameDuration()) / m_Animation->GetFrameDuration();
-    if (m_PlaySpeed < 0)
-        t = 1 - t;
+    UpdateTime(deltaTime);
+
+    // The compressed keys are sampled at any time, whichever direction the animation is played in
+    const float_t normalizedTime = m_Time / m_Animation->GetDuration();
 
     const List<Bone>& bones = m_Animation->skeleton->GetBones();
-    List<Matrix> currentMatrices(bones.GetSize());
+    if (m_FinalMatrices.GetSize() != bones.GetSize())
+    {
+        m_FinalMatrices.Resize(bones.GetSize());
+        m_ModelMatrices.Resize(bones.GetSize());
+    }
 
     if (m_BlendTarget)
     {
         m_BlendTarget->m_PlaySpeed = m_BlendTarget->m_Animation->GetDuration() / m_Animation->GetDuration() * m_PlaySpeed;
-        m_BlendTarget->Animate();
+        AnimateBlendTarget(deltaTime);
     }
 
-    for (size_t i = 0; i < bones.GetSize(); i++)
+    // The tracks are bound to the bones, so they are sampled in order without looking them up.
+    // The skipped leaf bones keep their last sampled transform, which needs a first complete pose.
+    const uint8_t skippedLeafLevels = m_IsPoseComplete ? m_SkippedLeafLevels : 0;
+    if (!m_Animation->SamplePose(normalizedTime, &m_Pose, skippedLeafLevels))
     {
-        const Bone& bone = bones[i];
+        // Reset animation
+        m_Time = 0.f;
+        return;
+    }
 
-        if (static_cast<size_t>(bone.id) >= currentMatrices.GetSize())
-            continue;
+    m_IsPoseComplete = true;
+    m_SampledBoneCount += m_Animation->GetSampledBoneCount(skippedLeafLevels);
 
-        const List<Animation::KeyFrame>* keyFramesPtr = nullptr;
-        m_Animation->GetBoneKeyFrame(bone, &keyFramesPtr);
-        if (keyFramesPtr == nullptr)
-        {
-            // Reset animation
-            m_Time = 0.f;
-            break;
-        }
-        const List<Animation::KeyFrame>& keyFrames = *keyFramesPtr;
+    if (m_IsRootMotionConsumed)
+        m_Animation->RemoveRootMotion(&m_Pose);
 
-        const size_t frame = Utils::RemapValue(m_CurrentFrame, Vector2i(0, static_cast<int32_t>(m_FrameCount)), Vector2i(0, static_cast<int32_t>(keyFrames.GetSize())));
-        nextFrame = (frame + 1) % keyFrames.GetSize();
+    ComputeMatrices(bones);
+}
 
-        //Logger::LogInfo("Current frame = {} ; Next frame = {}", frame, nextFrame);
-        
-        m_Positions[i] = Vector3::Lerp(keyFrames[frame].translation, keyFrames[nextFrame].translation, t);
-        m_Rotations[i] = Quaternion::Slerp(keyFrames[frame].rotation, keyFrames[nextFrame].rotation, t);
-
-        if (m_BlendTarget)
-        {
-            m_Positions[i] = Vector3::Lerp(m_Positions[i], m_BlendTarget->m_Positions[i], m_CrossFadeT);
-            m_Rotations[i] = Quaternion::Slerp(m_Rotations[i], m_BlendTarget->m_Rotations[i], m_CrossFadeT);
-        }
-
-        const Matrix localAnim = Matrix::Trs(m_Positions[i], m_Rotations[i], Vector3(1.f));
-
-        if (bone.parentId != -1)
-        {
-            // The bone has a parent, so apply the parent global transform to it
-            currentMatrices[bone.id] = currentMatrices[bones[bone.parentId].id] * localAnim;
-        }
-        else
-        {
-            // The bone has no parent, so its global transform is the same as its local
-            currentMatrices[bone.id] = localAnim;
-        }
-	    
-        // Apply the inverse to the global transform to remove the bind pose transform
-        m_FinalMatrices[bone.id] = currentMatrices[bone.id] * bone.global;
+void Animator::Hold(const float_t deltaTime)
+{
+    m_HeldTime += deltaTime;
+}
+
+void Animator::SetSkippedLeafLevels(const uint8_t levels)
+{
+    m_SkippedLeafLevels = levels;
+}
+
+size_t Animator::GetSampledBoneCount() const
+{
+    return m_SampledBoneCount;
+}
+
+void Animator::GetRootMotion(Vector3* const translation, float_t* const yaw) const
+{
+    *translation = m_RootMotionTranslation;
+    *yaw = m_RootMotionYaw;
+}
+
+void Animator::SetRootMotionConsumed(const bool_t consumed)
+{
+    m_IsRootMotionConsumed = consumed;
+}
+
+bool_t Animator::IsRootMotionConsumed() const
+{
+    return m_IsRootMotionConsumed;
+}
+
+size_t Animator::GetBoneCount() const
+{
+    if (m_BlendTree)
+    {
+        const Pointer<Skeleton> skeleton = m_BlendTree->GetSkeleton();
+        return skeleton ? skeleton->GetBones().GetSize() : 0;
     }
+
+    if (!m_Animation || !m_Animation->skeleton)
+        return 0;
+
+    return m_Animation->skeleton->GetBones().GetSize();
 }
 
 void Animator::SetCrossFadeDelta(const float_t delta)
@@ -116,6 +176,9 @@ void Animator::SetCrossFadeDelta(const float_t delta)
 
 const List<Matrix>& Animator::GetMatrices() const
 {
+    if (m_BlendTree)
+        return m_FinalMatrices;
+
     if (!m_Animation || !m_Animation->skeleton)
     {
         for (size_t i = 0; i < m_FinalMatrices.GetSize();i++)
@@ -127,21 +190,75 @@ const List<Matrix>& Animator::GetMatrices() const
     return m_FinalMatrices;
 }
 
-void Animator::UpdateTime()
+void Animator::UpdateTime(const float_t deltaTime)
 {
-    m_Time += Time::GetDeltaTime() * m_PlaySpeed;
-    
-    if (m_Time >= m_Animation->GetDuration())
+    m_Time += deltaTime * m_PlaySpeed;
+
+    // The time past the end is kept, so that the root motion of the next update starts where this one ended
+    const float_t duration = m_Animation->GetDuration();
+    if (m_Time >= duration)
     {
-        m_Time = 0.f;
+        m_Time = std::fmod(m_Time, duration);
         m_IsFinished = true;
     }
 
     if (m_PlaySpeed < 0.f && m_Time <= 0)
     {
-        m_Time = m_Animation->GetDuration();
+        m_Time = duration + std::fmod(m_Time, duration);
         m_IsFinished = true;
     }
 
     m_CurrentFrame = std::min(static_cast<size_t>(m_Time / m_Animation->GetFrameDuration()), m_FrameCount - 1);
 }
+
+void Animator::AnimateBlendTree(float_t deltaTime)
+{
+    // Catch up with the frames the animator was held for
+    deltaTime += m_HeldTime;
+    m_HeldTime = 0.f;
+    m_SampledBoneCount = 0;
+
+    const Pointer<Skeleton> skeleton = m_BlendTree->GetSkeleton();
+    if (!skeleton)
+        return;
+
+    if (!m_BlendTree->Evaluate(deltaTime * m_PlaySpeed, &m_Pose, m_SkippedLeafLevels))
+        return;
+
+    m_SampledBoneCount = m_BlendTree->GetSampledBoneCount();
+
+    // A blend tree has no single duration to match, so the blend target keeps its own play speed
+    if (m_BlendTarget)
+        AnimateBlendTarget(deltaTime);
+
+    const List<Bone>& bones = skeleton->GetBones();
+    if (m_FinalMatrices.GetSize() != bones.GetSize())
+    {
+        m_FinalMatrices.Resize(bones.GetSize());
+        m_ModelMatrices.Resize(bones.GetSize());
+    }
+
+    ComputeMatrices(bones);
+}
+
+void Animator::AnimateBlendTarget(const float_t deltaTime)
+{
+    m_BlendTarget->m_SkippedLeafLevels = m_SkippedLeafLevels;
+    m_BlendTarget->m_IsRootMotionConsumed = m_IsRootMotionConsumed;
+    m_BlendTarget->Animate(deltaTime);
+    m_SampledBoneCount += m_BlendTarget->m_SampledBoneCount;
+}
+
+void Animator::ComputeMatrices(const List<Bone>& bones)
+{
+    // The poses are blended before any matrix is computed, the buffers are reused every frame.
+    // The sampled pose is kept as is, so that the bones which aren't sampled aren't blended again.
+    if (m_BlendTarget && m_BlendTarget->m_Pose.GetBoneCount() == m_Pose.GetBoneCount())
+    {
+        AnimationPose::Blend(m_Pose, m_BlendTarget->m_Pose, m_CrossFadeT, &m_BlendedPose);
+        m_BlendedPose.ComputeMatrices(bones, m_ModelMatrices.GetData(), m_FinalMatrices.GetData());
+        return;
+    }
+
+    m_Pose.ComputeMatrices(bones, m_ModelMatrices.GetData(), m_FinalMatrices.GetData());
+}
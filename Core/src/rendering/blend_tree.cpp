@@ -0,0 +1,454 @@
+#include "rendering/blend_tree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "resource/animation.hpp"
+#include "resource/skeleton.hpp"
+#include "utils/logger.hpp"
+
+using namespace XnorCore;
+
+uint32_t BlendTree::AddParameter(const std::string& name, const float_t value)
+{
+    m_Parameters.push_back({ .name = name, .value = value });
+    return static_cast<uint32_t>(m_Parameters.size() - 1);
+}
+
+uint32_t BlendTree::GetParameterIndex(const std::string_view name) const
+{
+    for (size_t i = 0; i < m_Parameters.size(); i++)
+    {
+        if (m_Parameters[i].name == name)
+            return static_cast<uint32_t>(i);
+    }
+
+    return InvalidIndex;
+}
+
+void BlendTree::SetParameter(const uint32_t parameter, const float_t value)
+{
+    if (parameter >= m_Parameters.size())
+        return;
+
+    m_Parameters[parameter].value = value;
+}
+
+float_t BlendTree::GetParameter(const uint32_t parameter) const
+{
+    if (parameter >= m_Parameters.size())
+        return 0.f;
+
+    return m_Parameters[parameter].value;
+}
+
+uint32_t BlendTree::AddClip(const Pointer<Animation>& animation)
+{
+    // The nodes of the same animation share a clip, so that it is only sampled once
+    uint32_t clip = 0;
+    while (clip < m_Clips.size() && !(animation && m_Clips[clip].animation && m_Clips[clip].animation.Get() == animation.Get()))
+        clip++;
+
+    if (clip == m_Clips.size())
+        m_Clips.push_back({ .animation = animation });
+
+    return AddNode({ .type = BlendNodeType::Clip, .clip = clip });
+}
+
+uint32_t BlendTree::AddBlend1D(const uint32_t parameter, const std::vector<uint32_t>& inputs, const std::vector<float_t>& positions)
+{
+    if (inputs.empty() || inputs.size() != positions.size())
+    {
+        Logger::LogError("A 1D blend needs a position for each of its inputs");
+        return InvalidIndex;
+    }
+
+    // The inputs are sorted so that the 2 around the parameter are next to each other
+    std::vector<uint32_t> order(inputs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::sort(order, [&positions](const uint32_t a, const uint32_t b) -> bool_t { return positions[a] < positions[b]; });
+
+    BlendNode node = { .type = BlendNodeType::Blend1D, .parameterX = parameter };
+    for (const uint32_t i : order)
+    {
+        node.inputs.push_back(inputs[i]);
+        node.positions.emplace_back(positions[i], 0.f);
+    }
+
+    return AddNode(std::move(node));
+}
+
+uint32_t BlendTree::AddBlend2D(const uint32_t parameterX, const uint32_t parameterY, const std::vector<uint32_t>& inputs, const std::vector<Vector2>& positions)
+{
+    if (inputs.empty() || inputs.size() != positions.size())
+    {
+        Logger::LogError("A 2D blend needs a position for each of its inputs");
+        return InvalidIndex;
+    }
+
+    return AddNode({ .type = BlendNodeType::Blend2D, .inputs = inputs, .positions = positions, .parameterX = parameterX, .parameterY = parameterY });
+}
+
+uint32_t BlendTree::AddAdditive(const uint32_t base, const Pointer<Animation>& additive, const uint32_t weightParameter)
+{
+    const uint32_t additiveNode = AddClip(additive);
+    return AddNode({ .type = BlendNodeType::Additive, .inputs = { base, additiveNode }, .parameterX = weightParameter });
+}
+
+uint32_t BlendTree::AddMask(const uint32_t base, const uint32_t layer, const std::vector<float_t>& boneWeights, const uint32_t weightParameter)
+{
+    return AddNode({ .type = BlendNodeType::Mask, .inputs = { base, layer }, .parameterX = weightParameter, .boneWeights = boneWeights });
+}
+
+std::vector<float_t> BlendTree::CreateBoneMask(const Skeleton& skeleton, const std::string_view rootBone)
+{
+    const List<Bone>& bones = skeleton.GetBones();
+    std::vector<float_t> weights(bones.GetSize(), 0.f);
+
+    for (size_t i = 0; i < bones.GetSize(); i++)
+    {
+        const int32_t parent = bones[i].parentId;
+        if (bones[i].name == rootBone || (parent >= 0 && static_cast<size_t>(parent) < i && weights[parent] > 0.f))
+            weights[i] = 1.f;
+    }
+
+    return weights;
+}
+
+void BlendTree::SetRoot(const uint32_t node)
+{
+    m_Root = node;
+}
+
+void BlendTree::Prepare()
+{
+    for (Clip& clip : m_Clips)
+    {
+        if (clip.animation && clip.animation->skeleton && !clip.animation->IsBound())
+            clip.animation->BindSkeleton(clip.animation->skeleton);
+    }
+}
+
+bool_t BlendTree::Evaluate(const float_t deltaTime, AnimationPose* const pose, const uint8_t skippedLeafLevels)
+{
+    m_SampledClipCount = 0;
+    m_SampledBoneCount = 0;
+
+    if (m_Root >= m_Nodes.size())
+        return false;
+
+    for (Clip& clip : m_Clips)
+    {
+        clip.weight = 0.f;
+        clip.syncWeight = 0.f;
+    }
+
+    // The weights only depend on the parameters, so the clips which don't contribute are never sampled
+    PropagateWeights(m_Root, 1.f, 1.f);
+
+    float_t duration = 0.f;
+    float_t syncWeight = 0.f;
+    for (const Clip& clip : m_Clips)
+    {
+        if (clip.syncWeight <= 0.f || !clip.animation)
+            continue;
+
+        duration += clip.animation->GetDuration() * clip.syncWeight;
+        syncWeight += clip.syncWeight;
+    }
+
+    if (duration > 0.f)
+    {
+        m_NormalizedTime = std::fmod(m_NormalizedTime + deltaTime * syncWeight / duration, 1.f);
+        if (m_NormalizedTime < 0.f)
+            m_NormalizedTime += 1.f;
+    }
+
+    for (Clip& clip : m_Clips)
+    {
+        if (clip.weight <= 0.f)
+            continue;
+
+        if (!clip.animation || !clip.animation->skeleton)
+            return false;
+
+        if (!clip.animation->IsBound())
+            clip.animation->BindSkeleton(clip.animation->skeleton);
+
+        // The skipped leaf bones keep their last sampled transform, which needs a first complete pose
+        const uint8_t levels = clip.isPoseComplete ? skippedLeafLevels : 0;
+        if (!clip.animation->SamplePose(m_NormalizedTime, &clip.pose, levels))
+            return false;
+
+        clip.isPoseComplete = true;
+        m_SampledClipCount++;
+        m_SampledBoneCount += clip.animation->GetSampledBoneCount(levels);
+    }
+
+    const uint32_t result = EvaluateNode(m_Root);
+    *pose = GetPose(result);
+    ReleasePose(result);
+
+    return true;
+}
+
+Pointer<Skeleton> BlendTree::GetSkeleton() const
+{
+    for (const Clip& clip : m_Clips)
+    {
+        if (clip.animation)
+            return clip.animation->skeleton;
+    }
+
+    return Pointer<Skeleton>();
+}
+
+const std::vector<BlendNode>& BlendTree::GetNodes() const
+{
+    return m_Nodes;
+}
+
+float_t BlendTree::GetClipWeight(const uint32_t clip) const
+{
+    if (clip >= m_Clips.size())
+        return 0.f;
+
+    return m_Clips[clip].weight;
+}
+
+size_t BlendTree::GetSampledClipCount() const
+{
+    return m_SampledClipCount;
+}
+
+size_t BlendTree::GetSampledBoneCount() const
+{
+    return m_SampledBoneCount;
+}
+
+size_t BlendTree::GetPoolSize() const
+{
+    return m_PosePool.size();
+}
+
+float_t BlendTree::GetNormalizedTime() const
+{
+    return m_NormalizedTime;
+}
+
+uint32_t BlendTree::AddNode(BlendNode&& node)
+{
+    m_InputWeights.emplace_back(node.inputs.size(), 0.f);
+    m_Nodes.push_back(std::move(node));
+    return static_cast<uint32_t>(m_Nodes.size() - 1);
+}
+
+void BlendTree::ComputeInputWeights(const uint32_t node)
+{
+    const BlendNode& blendNode = m_Nodes[node];
+    std::vector<float_t>& weights = m_InputWeights[node];
+    std::ranges::fill(weights, 0.f);
+
+    switch (blendNode.type)
+    {
+        case BlendNodeType::Clip:
+            break;
+
+        case BlendNodeType::Blend1D:
+        {
+            const float_t x = GetParameter(blendNode.parameterX);
+            const std::vector<Vector2>& positions = blendNode.positions;
+
+            if (x <= positions.front().x)
+            {
+                weights.front() = 1.f;
+                break;
+            }
+
+            if (x >= positions.back().x)
+            {
+                weights.back() = 1.f;
+                break;
+            }
+
+            size_t i = 0;
+            while (x >= positions[i + 1].x)
+                i++;
+
+            const float_t t = (x - positions[i].x) / (positions[i + 1].x - positions[i].x);
+            weights[i] = 1.f - t;
+            weights[i + 1] = t;
+            break;
+        }
+
+        case BlendNodeType::Blend2D:
+        {
+            const Vector2 point(GetParameter(blendNode.parameterX), GetParameter(blendNode.parameterY));
+            const std::vector<Vector2>& positions = blendNode.positions;
+
+            // Gradient band interpolation: each input fades out towards every other input
+            float_t total = 0.f;
+            for (size_t i = 0; i < positions.size(); i++)
+            {
+                float_t weight = 1.f;
+                for (size_t j = 0; j < positions.size(); j++)
+                {
+                    const Vector2 edge = positions[j] - positions[i];
+                    const float_t squaredLength = edge.SquaredLength();
+                    if (i == j || squaredLength == 0.f)
+                        continue;
+
+                    weight = std::min(weight, 1.f - Vector2::Dot(point - positions[i], edge) / squaredLength);
+                }
+
+                weights[i] = std::max(weight, 0.f);
+                total += weights[i];
+            }
+
+            if (total > 0.f)
+            {
+                for (float_t& weight : weights)
+                    weight /= total;
+            }
+            else
+            {
+                weights.front() = 1.f;
+            }
+            break;
+        }
+
+        case BlendNodeType::Additive:
+        case BlendNodeType::Mask:
+            weights[0] = 1.f;
+            weights[1] = std::clamp(GetParameter(blendNode.parameterX), 0.f, 1.f);
+            break;
+    }
+}
+
+void BlendTree::PropagateWeights(const uint32_t node, const float_t weight, const float_t syncWeight)
+{
+    const BlendNode& blendNode = m_Nodes[node];
+
+    if (blendNode.type == BlendNodeType::Clip)
+    {
+        m_Clips[blendNode.clip].weight += weight;
+        m_Clips[blendNode.clip].syncWeight += syncWeight;
+        return;
+    }
+
+    ComputeInputWeights(node);
+    const std::vector<float_t>& weights = m_InputWeights[node];
+
+    for (size_t i = 0; i < blendNode.inputs.size(); i++)
+    {
+        if (weights[i] <= 0.f)
+            continue;
+
+        // Layers follow the time of their base
+        const bool_t isLayer = blendNode.type == BlendNodeType::Additive || blendNode.type == BlendNodeType::Mask;
+        PropagateWeights(blendNode.inputs[i], weight * weights[i], isLayer && i > 0 ? 0.f : syncWeight * weights[i]);
+    }
+}
+
+uint32_t BlendTree::EvaluateNode(const uint32_t node)
+{
+    const BlendNode& blendNode = m_Nodes[node];
+    const std::vector<float_t>& weights = m_InputWeights[node];
+
+    switch (blendNode.type)
+    {
+        case BlendNodeType::Clip:
+            return blendNode.clip;
+
+        case BlendNodeType::Blend1D:
+        case BlendNodeType::Blend2D:
+        {
+            uint32_t result = InvalidIndex;
+            float_t total = 0.f;
+
+            for (size_t i = 0; i < blendNode.inputs.size(); i++)
+            {
+                if (weights[i] <= 0.f)
+                    continue;
+
+                const uint32_t input = EvaluateNode(blendNode.inputs[i]);
+                total += weights[i];
+
+                if (result == InvalidIndex)
+                {
+                    result = input;
+                    continue;
+                }
+
+                // Blending each input by its share of the total so far gives the weighted average of all of them
+                const uint32_t blended = result < m_Clips.size() ? AcquirePose() : result;
+                AnimationPose::Blend(GetPose(result), GetPose(input), weights[i] / total, &GetPose(blended));
+                ReleasePose(input);
+                result = blended;
+            }
+
+            return result;
+        }
+
+        case BlendNodeType::Additive:
+        {
+            const uint32_t base = EvaluateNode(blendNode.inputs[0]);
+            if (weights[1] <= 0.f)
+                return base;
+
+            Clip& additive = m_Clips[m_Nodes[blendNode.inputs[1]].clip];
+            if (additive.reference.GetBoneCount() == 0)
+                additive.animation->SamplePose(0.f, &additive.reference);
+
+            const uint32_t result = base < m_Clips.size() ? AcquirePose() : base;
+            AnimationPose::Add(GetPose(base), additive.pose, additive.reference, weights[1], &GetPose(result));
+            return result;
+        }
+
+        case BlendNodeType::Mask:
+        {
+            const uint32_t base = EvaluateNode(blendNode.inputs[0]);
+            if (weights[1] <= 0.f)
+                return base;
+
+            const uint32_t layer = EvaluateNode(blendNode.inputs[1]);
+            const uint32_t result = base < m_Clips.size() ? AcquirePose() : base;
+            AnimationPose::Blend(GetPose(base), GetPose(layer), blendNode.boneWeights, weights[1], &GetPose(result));
+            ReleasePose(layer);
+            return result;
+        }
+    }
+
+    return InvalidIndex;
+}
+
+uint32_t BlendTree::AcquirePose()
+{
+    if (!m_FreePoses.empty())
+    {
+        const uint32_t pose = m_FreePoses.back();
+        m_FreePoses.pop_back();
+        return pose;
+    }
+
+    m_PosePool.emplace_back();
+    return static_cast<uint32_t>(m_Clips.size() + m_PosePool.size() - 1);
+}
+
+void BlendTree::ReleasePose(const uint32_t pose)
+{
+    // The poses of the clips are kept until the next evaluation
+    if (pose < m_Clips.size())
+        return;
+
+    m_FreePoses.push_back(pose);
+}
+
+AnimationPose& BlendTree::GetPose(const uint32_t pose)
+{
+    if (pose < m_Clips.size())
+        return m_Clips[pose].pose;
+
+    return m_PosePool[pose - m_Clips.size()];
+}
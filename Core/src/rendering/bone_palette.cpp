@@ -0,0 +1,53 @@
+#include "rendering/bone_palette.hpp"
+
+#include <algorithm>
+
+using namespace XnorCore;
+
+void BonePalette::Clear()
+{
+    m_MatrixCount = 0;
+    m_Statistics = {};
+}
+
+uint32_t BonePalette::Add(const List<Matrix>& matrices)
+{
+    const size_t offset = m_MatrixCount;
+    m_MatrixCount += matrices.GetSize();
+
+    if (m_Matrices.size() < m_MatrixCount)
+        m_Matrices.resize(m_MatrixCount);
+
+    std::copy_n(matrices.GetData(), matrices.GetSize(), m_Matrices.begin() + static_cast<ptrdiff_t>(offset));
+
+    m_Statistics.instanceCount++;
+    m_Statistics.matrixCount = static_cast<uint32_t>(m_MatrixCount);
+
+    return static_cast<uint32_t>(offset);
+}
+
+void BonePalette::Upload(const BonePaletteUpload& upload)
+{
+    if (m_MatrixCount == 0)
+        return;
+
+    upload(m_Matrices.data(), m_MatrixCount);
+
+    m_Statistics.uploadCount++;
+    m_Statistics.uploadedBytes += m_MatrixCount * sizeof(Matrix);
+}
+
+const Matrix* BonePalette::GetMatrices() const
+{
+    return m_Matrices.data();
+}
+
+size_t BonePalette::GetMatrixCount() const
+{
+    return m_MatrixCount;
+}
+
+const BonePaletteStatistics& BonePalette::GetStatistics() const
+{
+    return m_Statistics;
+}
@@ -0,0 +1,43 @@
+#include "rendering/buffer/pixel_pack_buffer.hpp"
+
+#include <glad/glad.h>
+
+using namespace XnorCore;
+
+PixelPackBuffer::PixelPackBuffer()
+{
+    glCreateBuffers(1, &m_Id);
+}
+
+PixelPackBuffer::~PixelPackBuffer()
+{
+    glDeleteBuffers(1, &m_Id);
+}
+
+void PixelPackBuffer::Reserve(const size_t size)
+{
+    if (size <= m_Size)
+        return;
+
+    // Written by the GPU and read once by the CPU
+    glNamedBufferData(m_Id, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+    m_Size = size;
+}
+
+void PixelPackBuffer::Read(const size_t size, void* const output) const
+{
+    if (size == 0)
+        return;
+
+    glGetNamedBufferSubData(m_Id, 0, static_cast<GLsizeiptr>(size), output);
+}
+
+uint32_t PixelPackBuffer::GetId() const
+{
+    return m_Id;
+}
+
+size_t PixelPackBuffer::GetSize() const
+{
+    return m_Size;
+}
@@ -0,0 +1,51 @@
+#include "rendering/buffer/shader_storage_buffer.hpp"
+
+#include <algorithm>
+
+#include <glad/glad.h>
+
+using namespace XnorCore;
+
+ShaderStorageBuffer::ShaderStorageBuffer()
+{
+    glCreateBuffers(1, &m_Id);
+}
+
+ShaderStorageBuffer::~ShaderStorageBuffer()
+{
+    glDeleteBuffers(1, &m_Id);
+}
+
+void ShaderStorageBuffer::Allocate(const size_t size, const void* const data)
+{
+    // Mutable storage so that the buffer can grow with the data
+    glNamedBufferData(m_Id, static_cast<GLsizeiptr>(size), data, GL_DYNAMIC_DRAW);
+    m_Size = size;
+}
+
+void ShaderStorageBuffer::Reserve(const size_t size)
+{
+    if (size <= m_Size)
+        return;
+
+    // Grow geometrically to avoid reallocating every frame while the data grows
+    Allocate(std::max(size, m_Size + m_Size / 2), nullptr);
+}
+
+void ShaderStorageBuffer::Update(const size_t size, const size_t offset, const void* const data) const
+{
+    if (size == 0)
+        return;
+    
+    glNamedBufferSubData(m_Id, static_cast<GLsizeiptr>(offset), static_cast<GLsizeiptr>(size), data);   
+}
+
+void ShaderStorageBuffer::Bind(const uint32_t index) const
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, m_Id);
+}
+
+size_t ShaderStorageBuffer::GetSize() const
+{
+    return m_Size;
+}
@@ -9,6 +9,8 @@
 
 using namespace XnorCore;
 
+static constexpr UniformHandle<Vector3> ColorUniform("color");
+
 DrawGizmo::DrawGizmo()
 {
      m_Sphere = ResourceManager::Get<Model>("assets/models/sphere.obj");
@@ -67,7 +69,7 @@ void DrawGizmo::DrawCollider(const Entity& entity)
     if (entityCollider.empty())
         return;
 
-    m_GizmoShader->SetVec3("color", static_cast<Vector3>(Color::Green()));
+    m_GizmoShader->SetVec3(ColorUniform, static_cast<Vector3>(Color::Green()));
 
     for (const Collider* coll : entityCollider)
     {
@@ -112,7 +114,7 @@ void DrawGizmo::DrawRectangle()
 {
     for (GizmoRectangle& gizmo : m_GizmoRectangleVector)
     {
-        m_GizmoShader->SetVec3("color", static_cast<Vector3>(gizmo.color));
+        m_GizmoShader->SetVec3(ColorUniform, static_cast<Vector3>(gizmo.color));
         modelData.model = Matrix::Trs(gizmo.position, Quaternion::Identity(), Vector3(gizmo.size));
         Rhi::UpdateModelUniform(modelData);
         Rhi::DrawModel(DrawMode::Triangles, m_Cube->models[0]->GetId());
@@ -123,7 +125,7 @@ void DrawGizmo::DrawSphere()
 {
     for (GizmoSphere& gizmo : m_GizmoSphereVector)
     {
-        m_GizmoShader->SetVec3("color", static_cast<Vector3>(gizmo.color));
+        m_GizmoShader->SetVec3(ColorUniform, static_cast<Vector3>(gizmo.color));
         modelData.model = Matrix::Trs(gizmo.position, Quaternion::Identity(), Vector3(gizmo.radius));
         Rhi::UpdateModelUniform(modelData);
         Rhi::DrawModel(DrawMode::Triangles, m_Sphere->models[0]->GetId());
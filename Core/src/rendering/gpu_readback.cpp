@@ -0,0 +1,89 @@
+#include "rendering/gpu_readback.hpp"
+
+#include "rendering/frame_buffer.hpp"
+#include "rendering/rhi.hpp"
+
+using namespace XnorCore;
+
+GpuReadback::~GpuReadback()
+{
+    Cancel();
+
+    for (const PixelPackBuffer* const buffer : m_FreeBuffers)
+        delete buffer;
+}
+
+void GpuReadback::Request(
+    const Framebuffer& frameBuffer,
+    const uint32_t attachmentIndex,
+    const Vector2i position,
+    const Vector2i size,
+    const TextureFormat::TextureFormat textureFormat,
+    const DataType::DataType dataType,
+    GpuReadbackCallback callback
+)
+{
+    PendingReadback readback =
+    {
+        .size = static_cast<size_t>(size.x) * static_cast<size_t>(size.y) * Rhi::GetPixelSize(textureFormat, dataType),
+        .callback = std::move(callback)
+    };
+
+    if (m_FreeBuffers.empty())
+    {
+        readback.buffer = new PixelPackBuffer;
+    }
+    else
+    {
+        readback.buffer = m_FreeBuffers.back();
+        m_FreeBuffers.pop_back();
+    }
+
+    readback.buffer->Reserve(readback.size);
+    Rhi::ReadPixelsToBuffer(frameBuffer.GetId(), attachmentIndex, position, size, textureFormat, dataType, readback.buffer->GetId());
+    readback.fence = Rhi::CreateFence();
+
+    m_Pending.push_back(std::move(readback));
+}
+
+void GpuReadback::Update()
+{
+    // The GPU executes the copies in order, so the first pending fence is always the first one to be signaled
+    size_t finished = 0;
+    while (finished < m_Pending.size() && Rhi::IsFenceSignaled(m_Pending[finished].fence))
+        finished++;
+
+    if (finished == 0)
+        return;
+
+    // Move the finished readbacks out first, a callback can request a new readback
+    std::vector<PendingReadback> readbacks(std::make_move_iterator(m_Pending.begin()), std::make_move_iterator(m_Pending.begin() + static_cast<std::ptrdiff_t>(finished)));
+    m_Pending.erase(m_Pending.begin(), m_Pending.begin() + static_cast<std::ptrdiff_t>(finished));
+
+    for (PendingReadback& readback : readbacks)
+    {
+        Rhi::DestroyFence(readback.fence);
+
+        m_Data.resize(readback.size);
+        readback.buffer->Read(readback.size, m_Data.data());
+        m_FreeBuffers.push_back(readback.buffer);
+
+        readback.callback(m_Data);
+    }
+}
+
+void GpuReadback::Cancel()
+{
+    for (const PendingReadback& readback : m_Pending)
+    {
+        Rhi::DestroyFence(readback.fence);
+        m_FreeBuffers.push_back(readback.buffer);
+    }
+
+    m_Pending.clear();
+}
+
+size_t GpuReadback::GetPendingCount() const
+{
+    return m_Pending.size();
+}
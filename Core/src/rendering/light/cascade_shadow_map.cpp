@@ -1,35 +1,81 @@
 ﻿#include "rendering/light/cascade_shadow_map.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 #include "rendering/rhi.hpp"
 #include "rendering/rhi_typedef.hpp"
 
 using namespace XnorCore;
 
+// Light space AABB of the 8 corners of a world space AABB
+static void GetLightSpaceBound(const Matrix& lightView, const Bound& bound, Vector3* min, Vector3* max)
+{
+    const Vector3 boundMin = bound.GetMin();
+    const Vector3 boundMax = bound.GetMax();
+
+    *min = Vector3(std::numeric_limits<float_t>::max());
+    *max = Vector3(std::numeric_limits<float_t>::lowest());
+    for (size_t i = 0; i < 8; i++)
+    {
+        const Vector4 corner = lightView * Vector4(
+            i & 1 ? boundMax.x : boundMin.x,
+            i & 2 ? boundMax.y : boundMin.y,
+            i & 4 ? boundMax.z : boundMin.z,
+            1.f
+        );
+
+        *min = Vector3(std::min(min->x, corner.x), std::min(min->y, corner.y), std::min(min->z, corner.z));
+        *max = Vector3(std::max(max->x, corner.x), std::max(max->y, corner.y), std::max(max->z, corner.z));
+    }
+}
 
 void CascadeShadowMap::GetCascadeCameras(std::vector<Camera>* cameras, const Camera& viewPortCamera, Vector3 lightDir,
-                                         const Vector2i screenSize)
+                                         const Vector2i screenSize, const int32_t shadowMapResolution)
 {
-    cameras->resize(DirectionalCascadeLevel + 1);
-    for (size_t i = 0; i < DirectionalCascadeLevel + 1; ++i)
+    cameras->resize(CascadeCount);
+    for (size_t i = 0; i < CascadeCount; ++i)
     {
         cameras->at(i) = viewPortCamera;
-        
-        if (i == 0)
-        {
-            GetCamera(&cameras->at(i), viewPortCamera.near, m_CascadeLevel[i],viewPortCamera,lightDir,screenSize);
-        }
-        else if (i < m_CascadeLevel.size())
-        {
-            GetCamera(&cameras->at(i), m_CascadeLevel[i - 1], m_CascadeLevel[i], viewPortCamera,lightDir,screenSize);
-        }
-        else
-        {
-            GetCamera(&cameras->at(i), m_CascadeLevel[i - 1], viewPortCamera.far, viewPortCamera,lightDir,screenSize);
 
-        }
+        const float_t cascadeNear = i == 0 ? viewPortCamera.near : m_CascadeLevel[i - 1];
+        const float_t cascadeFar = i < m_CascadeLevel.size() ? m_CascadeLevel[i] : viewPortCamera.far;
+        GetCamera(&cameras->at(i), &m_CascadeVolumes[i], cascadeNear, cascadeFar, viewPortCamera, lightDir, screenSize, shadowMapResolution);
     }
+}
 
-    
+void CascadeShadowMap::CullCasters(const size_t cascade, const std::vector<Bound>& casters, std::vector<uint32_t>* cascadeCasters) const
+{
+    const CascadeVolume& volume = m_CascadeVolumes[cascade];
+
+    cascadeCasters->clear();
+    for (uint32_t i = 0; i < static_cast<uint32_t>(casters.size()); i++)
+    {
+        Vector3 min;
+        Vector3 max;
+        GetLightSpaceBound(volume.lightView, casters[i], &min, &max);
+
+        // Shadows are cast along the Z axis, the caster has to be above the slice
+        if (max.x < volume.sliceMin.x || min.x > volume.sliceMax.x || max.y < volume.sliceMin.y || min.y > volume.sliceMax.y)
+            continue;
+
+        // The light is towards +Z, the caster has to be in front of the far side of the slice and behind the near plane
+        if (max.z < volume.sliceMin.z || min.z > volume.nearDepth)
+            continue;
+
+        cascadeCasters->push_back(i);
+    }
+}
+
+void CascadeShadowMap::ComputeCascadeLevel(const float_t near, const float_t far, const float_t lambda)
+{
+    for (size_t i = 0; i < m_CascadeLevel.size(); i++)
+    {
+        const float_t ratio = static_cast<float_t>(i + 1) / static_cast<float_t>(CascadeCount);
+        const float_t logarithmic = near * std::pow(far / near, ratio);
+        const float_t uniform = near + (far - near) * ratio;
+        m_CascadeLevel[i] = lambda * logarithmic + (1.f - lambda) * uniform;
+    }
 }
 
 void CascadeShadowMap::SetCascadeLevel(const std::array<float_t,DirectionalCascadeLevel>& cascadeLevel)
@@ -37,6 +83,11 @@ void CascadeShadowMap::SetCascadeLevel(const std::array<float_t,DirectionalCasca
     m_CascadeLevel = cascadeLevel;
 }
 
+const std::array<float_t, DirectionalCascadeLevel>& CascadeShadowMap::GetCascadeLevel() const
+{
+    return m_CascadeLevel;
+}
+
 void CascadeShadowMap::SetZMultiplicator(const float_t zMultiPlicator)
 {
     m_ZMultiplicator = zMultiPlicator;
@@ -73,7 +124,16 @@ void CascadeShadowMap::ComputeFrustumCorner(std::vector<Vector4>* frustumCornerW
     }
 }
 
-void CascadeShadowMap::GetCamera(Camera* cascadedCamera,const float_t cascadedNear, const float_t cascadedFar, const Camera& baseCamera, const Vector3 lightDir, const Vector2i screenSize)
+void CascadeShadowMap::GetCamera(
+    Camera* cascadedCamera,
+    CascadeVolume* volume,
+    const float_t cascadedNear,
+    const float_t cascadedFar,
+    const Camera& baseCamera,
+    const Vector3 lightDir,
+    const Vector2i screenSize,
+    const int32_t shadowMapResolution
+)
 {
     const Matrix proj = Matrix::Perspective(
             baseCamera.fov * Calc::Deg2Rad, static_cast<float_t>(screenSize.x) / static_cast<float_t>(screenSize.y), cascadedNear,
@@ -91,54 +151,49 @@ void CascadeShadowMap::GetCamera(Camera* cascadedCamera,const float_t cascadedNe
         center += {v.x , v.y, v.z};
     }
     center /= static_cast<float_t>(corners.size());
+
+    // The distance from the center to the corners only depends on the shape of the slice, rounding it up hides the float error
+    float_t radius = 0.f;
+    for (const Vector4& v : corners)
+        radius = std::max(radius, (Vector3(v.x, v.y, v.z) - center).Length());
+    radius = std::ceil(radius * RadiusPrecision) / RadiusPrecision;
+
+    // Rotation of the light space, without translation
+    Camera lightCamera;
+    lightCamera.position = Vector3();
+    lightCamera.front = -lightDir;
+    lightCamera.up = std::abs(lightDir.y) > 0.99f ? Vector3::UnitZ() : Vector3::UnitY();
+    Matrix lightRotation;
+    lightCamera.GetView(&lightRotation);
+
+    // Move the center by whole texels in light space, so that the texels stay at the same place in world space
+    const float_t texelSize = 2.f * radius / static_cast<float_t>(shadowMapResolution);
+    Vector4 lightSpaceCenter = lightRotation * Vector4(center.x, center.y, center.z, 1.f);
+    lightSpaceCenter.x = std::floor(lightSpaceCenter.x / texelSize) * texelSize;
+    lightSpaceCenter.y = std::floor(lightSpaceCenter.y / texelSize) * texelSize;
+    const Vector4 snappedCenter = lightRotation.Transposed() * lightSpaceCenter;
     
-    cascadedCamera->position = center + lightDir;
-    cascadedCamera->front = -lightDir;
-    cascadedCamera->up = Vector3::UnitY();
+    cascadedCamera->position = Vector3(snappedCenter.x, snappedCenter.y, snappedCenter.z);
+    cascadedCamera->front = lightCamera.front;
+    cascadedCamera->up = lightCamera.up;
+    cascadedCamera->right = Vector3::Cross(cascadedCamera->front, cascadedCamera->up).Normalized();
+    cascadedCamera->isOrthographic = true;
+
+    // Casters outside of the slice can still cast a shadow on it, the depth range is extended towards the light and away from it
+    cascadedCamera->near = -radius * m_ZMultiplicator;
+    cascadedCamera->far = radius * m_ZMultiplicator;
         
-    Matrix lightView;
-    cascadedCamera->GetView(&lightView);
-    
-    float_t minX = std::numeric_limits<float_t>::max();
-    float_t maxX = std::numeric_limits<float_t>::lowest();
-    float_t minY = std::numeric_limits<float_t>::max();
-    float_t maxY = std::numeric_limits<float_t>::lowest();
-    float_t minZ = std::numeric_limits<float_t>::max();
-    float_t maxZ = std::numeric_limits<float_t>::lowest();
-    
-    for (const Vector4& v : corners)
-    {
-        const Vector4 trf = lightView * v;
-        minX = std::min(minX, trf.x);
-        maxX = std::max(maxX, trf.x);
-        minY = std::min(minY, trf.y);
-        maxY = std::max(maxY, trf.y);
-        minZ = std::min(minZ, trf.z);
-        maxZ = std::max(maxZ, trf.z);
-    }
+    cascadedCamera->leftRight = { -radius, radius };
+    cascadedCamera->bottomtop = { -radius, radius };
 
-    if (minZ < 0.f)
-    {
-        minZ *= m_ZMultiplicator;
-    }
-    else
-    {
-        minZ /= m_ZMultiplicator;
-    }
-    if (maxZ < 0.f)
-    {
-        maxZ /= m_ZMultiplicator;
-    }
-    else
+    cascadedCamera->GetView(&volume->lightView);
+    volume->nearDepth = -cascadedCamera->near;
+    volume->sliceMin = Vector3(std::numeric_limits<float_t>::max());
+    volume->sliceMax = Vector3(std::numeric_limits<float_t>::lowest());
+    for (const Vector4& v : corners)
     {
-        maxZ *= m_ZMultiplicator;
+        const Vector4 trf = volume->lightView * v;
+        volume->sliceMin = Vector3(std::min(volume->sliceMin.x, trf.x), std::min(volume->sliceMin.y, trf.y), std::min(volume->sliceMin.z, trf.z));
+        volume->sliceMax = Vector3(std::max(volume->sliceMax.x, trf.x), std::max(volume->sliceMax.y, trf.y), std::max(volume->sliceMax.z, trf.z));
     }
-
-    cascadedCamera->near = minZ;
-    cascadedCamera->far = maxZ ;
-        
-    cascadedCamera->leftRight = { minX , maxX };
-    cascadedCamera->bottomtop = { minY, maxY };
-
 }
-
@@ -0,0 +1,243 @@
+#include "rendering/light/light_clusters.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Maths/vector4.hpp"
+
+using namespace XnorCore;
+
+static Vector3 Unproject(const Matrix& inverseProjection, const float_t x, const float_t y, const float_t z)
+{
+    const Vector4 point = inverseProjection * Vector4(x, y, z, 1.f);
+    return Vector3(point.x, point.y, point.z) * (1.f / point.w);
+}
+
+// Point of a ray at the given view depth, the camera looking towards -Z
+static Vector3 GetPointAtDepth(const Vector3& nearPoint, const Vector3& farPoint, const float_t depth)
+{
+    const float_t t = (depth + nearPoint.z) / (nearPoint.z - farPoint.z);
+    return nearPoint + (farPoint - nearPoint) * t;
+}
+
+static uint32_t GetTile(const float_t ndc, const uint32_t tileCount)
+{
+    const float_t tile = (ndc * 0.5f + 0.5f) * static_cast<float_t>(tileCount);
+    return static_cast<uint32_t>(std::clamp(tile, 0.f, static_cast<float_t>(tileCount - 1)));
+}
+
+static bool_t SphereIntersectsAabb(const Vector3& center, const float_t radius, const Vector3& min, const Vector3& max)
+{
+    const float_t x = std::clamp(center.x, min.x, max.x) - center.x;
+    const float_t y = std::clamp(center.y, min.y, max.y) - center.y;
+    const float_t z = std::clamp(center.z, min.z, max.z) - center.z;
+
+    return x * x + y * y + z * z <= radius * radius;
+}
+
+void LightClusters::Build(
+    const Matrix& view,
+    const Matrix& projection,
+    const float_t near,
+    const float_t far,
+    const std::vector<LightBounds>& pointLights,
+    const std::vector<LightBounds>& spotLights
+)
+{
+    if (m_ClusterBounds.empty() || !(projection == m_Projection) || near != m_Grid.near || far != m_Grid.far)
+        ComputeClusterBounds(projection, near, far);
+
+    m_Assignments.clear();
+    AssignLights(view, projection, pointLights, 0);
+    AssignLights(view, projection, spotLights, SpotLightBit);
+
+    // Counting sort of the assignments by cluster, keeping the lights of each cluster sorted by index
+    m_Clusters.assign(ClusterCount, {});
+    for (const uint64_t assignment : m_Assignments)
+    {
+        GpuLightCluster& cluster = m_Clusters[assignment >> 32];
+        if (assignment & SpotLightBit)
+            cluster.spotLightCount++;
+        else
+            cluster.pointLightCount++;
+    }
+
+    m_Cursors.resize(static_cast<size_t>(ClusterCount) * 2);
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < ClusterCount; i++)
+    {
+        GpuLightCluster& cluster = m_Clusters[i];
+        cluster.offset = offset;
+        m_Cursors[i * 2] = offset;
+        m_Cursors[i * 2 + 1] = offset + cluster.pointLightCount;
+        offset += cluster.pointLightCount + cluster.spotLightCount;
+    }
+
+    m_LightIndices.resize(offset);
+    for (const uint64_t assignment : m_Assignments)
+    {
+        const uint32_t light = static_cast<uint32_t>(assignment);
+        const bool_t isSpotLight = light & SpotLightBit;
+        m_LightIndices[m_Cursors[(assignment >> 32) * 2 + isSpotLight]++] = light & ~SpotLightBit;
+    }
+}
+
+uint32_t LightClusters::GetClusterIndex(const Vector2 ndc, const float_t viewDepth) const
+{
+    return GetTile(ndc.x, GridSizeX) + GetTile(ndc.y, GridSizeY) * GridSizeX + GetDepthSlice(viewDepth) * GridSizeX * GridSizeY;
+}
+
+std::span<const uint32_t> LightClusters::GetPointLights(const uint32_t cluster) const
+{
+    const GpuLightCluster& data = m_Clusters[cluster];
+    return { m_LightIndices.data() + data.offset, data.pointLightCount };
+}
+
+std::span<const uint32_t> LightClusters::GetSpotLights(const uint32_t cluster) const
+{
+    const GpuLightCluster& data = m_Clusters[cluster];
+    return { m_LightIndices.data() + data.offset + data.pointLightCount, data.spotLightCount };
+}
+
+const GpuLightClusterGrid& LightClusters::GetGrid() const
+{
+    return m_Grid;
+}
+
+const std::vector<GpuLightCluster>& LightClusters::GetClusters() const
+{
+    return m_Clusters;
+}
+
+const std::vector<uint32_t>& LightClusters::GetLightIndices() const
+{
+    return m_LightIndices;
+}
+
+void LightClusters::ComputeClusterBounds(const Matrix& projection, const float_t near, const float_t far)
+{
+    m_Projection = projection;
+
+    const float_t logDepthRange = std::log(far / near);
+    m_Grid =
+    {
+        .sizeX = GridSizeX,
+        .sizeY = GridSizeY,
+        .sizeZ = GridSizeZ,
+        .depthScale = static_cast<float_t>(GridSizeZ) / logDepthRange,
+        .depthBias = -static_cast<float_t>(GridSizeZ) * std::log(near) / logDepthRange,
+        .near = near,
+        .far = far
+    };
+
+    // Rays going through the corners of the tiles
+    const Matrix inverseProjection = projection.Inverted();
+    std::vector<Vector3> nearPoints((GridSizeX + 1) * (GridSizeY + 1));
+    std::vector<Vector3> farPoints(nearPoints.size());
+    for (uint32_t y = 0; y <= GridSizeY; y++)
+    {
+        for (uint32_t x = 0; x <= GridSizeX; x++)
+        {
+            const float_t ndcX = static_cast<float_t>(x) / GridSizeX * 2.f - 1.f;
+            const float_t ndcY = static_cast<float_t>(y) / GridSizeY * 2.f - 1.f;
+            nearPoints[x + y * (GridSizeX + 1)] = Unproject(inverseProjection, ndcX, ndcY, -1.f);
+            farPoints[x + y * (GridSizeX + 1)] = Unproject(inverseProjection, ndcX, ndcY, 1.f);
+        }
+    }
+
+    m_ClusterBounds.resize(ClusterCount);
+    for (uint32_t z = 0; z < GridSizeZ; z++)
+    {
+        const float_t sliceNear = near * std::pow(far / near, static_cast<float_t>(z) / GridSizeZ);
+        const float_t sliceFar = near * std::pow(far / near, static_cast<float_t>(z + 1) / GridSizeZ);
+
+        for (uint32_t y = 0; y < GridSizeY; y++)
+        {
+            for (uint32_t x = 0; x < GridSizeX; x++)
+            {
+                ClusterBounds& bounds = m_ClusterBounds[x + y * GridSizeX + z * GridSizeX * GridSizeY];
+                bounds.min = Vector3(std::numeric_limits<float_t>::max());
+                bounds.max = Vector3(std::numeric_limits<float_t>::lowest());
+
+                for (uint32_t corner = 0; corner < 4; corner++)
+                {
+                    const size_t ray = (x + (corner & 1)) + (y + (corner >> 1)) * (GridSizeX + 1);
+                    for (const float_t depth : { sliceNear, sliceFar })
+                    {
+                        const Vector3 point = GetPointAtDepth(nearPoints[ray], farPoints[ray], depth);
+                        bounds.min = Vector3(std::min(bounds.min.x, point.x), std::min(bounds.min.y, point.y), std::min(bounds.min.z, point.z));
+                        bounds.max = Vector3(std::max(bounds.max.x, point.x), std::max(bounds.max.y, point.y), std::max(bounds.max.z, point.z));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void LightClusters::AssignLights(const Matrix& view, const Matrix& projection, const std::vector<LightBounds>& lights, const uint32_t lightFlag)
+{
+    for (uint32_t i = 0; i < static_cast<uint32_t>(lights.size()); i++)
+    {
+        const float_t radius = lights[i].radius;
+        const Vector3 center = view * lights[i].position;
+        const float_t depth = -center.z;
+
+        if (radius <= 0.f || depth + radius < m_Grid.near || depth - radius > m_Grid.far)
+            continue;
+
+        uint32_t minX = 0;
+        uint32_t maxX = GridSizeX - 1;
+        uint32_t minY = 0;
+        uint32_t maxY = GridSizeY - 1;
+
+        // Screen space bounds, only if the light is entirely in front of the camera
+        if (depth - radius > m_Grid.near)
+        {
+            Vector2 ndcMin(std::numeric_limits<float_t>::max());
+            Vector2 ndcMax(std::numeric_limits<float_t>::lowest());
+            for (uint32_t corner = 0; corner < 8; corner++)
+            {
+                const Vector3 offset((corner & 1) ? radius : -radius, (corner & 2) ? radius : -radius, (corner & 4) ? radius : -radius);
+                const Vector4 clip = projection * Vector4(center.x + offset.x, center.y + offset.y, center.z + offset.z, 1.f);
+                ndcMin = Vector2(std::min(ndcMin.x, clip.x / clip.w), std::min(ndcMin.y, clip.y / clip.w));
+                ndcMax = Vector2(std::max(ndcMax.x, clip.x / clip.w), std::max(ndcMax.y, clip.y / clip.w));
+            }
+
+            if (ndcMax.x < -1.f || ndcMin.x > 1.f || ndcMax.y < -1.f || ndcMin.y > 1.f)
+                continue;
+
+            minX = GetTile(ndcMin.x, GridSizeX);
+            maxX = GetTile(ndcMax.x, GridSizeX);
+            minY = GetTile(ndcMin.y, GridSizeY);
+            maxY = GetTile(ndcMax.y, GridSizeY);
+        }
+
+        const uint32_t minZ = GetDepthSlice(depth - radius);
+        const uint32_t maxZ = GetDepthSlice(depth + radius);
+
+        for (uint32_t z = minZ; z <= maxZ; z++)
+        {
+            for (uint32_t y = minY; y <= maxY; y++)
+            {
+                for (uint32_t x = minX; x <= maxX; x++)
+                {
+                    const uint32_t cluster = x + y * GridSizeX + z * GridSizeX * GridSizeY;
+                    const ClusterBounds& bounds = m_ClusterBounds[cluster];
+
+                    if (SphereIntersectsAabb(center, radius, bounds.min, bounds.max))
+                        m_Assignments.push_back(static_cast<uint64_t>(cluster) << 32 | i | lightFlag);
+                }
+            }
+        }
+    }
+}
+
+uint32_t LightClusters::GetDepthSlice(const float_t viewDepth) const
+{
+    if (viewDepth <= m_Grid.near)
+        return 0;
+
+    const float_t slice = std::floor(std::log(viewDepth) * m_Grid.depthScale + m_Grid.depthBias);
+    return static_cast<uint32_t>(std::clamp(slice, 0.f, static_cast<float_t>(GridSizeZ - 1)));
+}
@@ -0,0 +1,75 @@
+#include "rendering/light/point_light_shadow_batch.hpp"
+
+#include <algorithm>
+#include <bit>
+
+using namespace XnorCore;
+
+// Distance from 0 to the closest value of the range
+static float_t GetClosestToZero(const float_t min, const float_t max)
+{
+    if (min > 0.f)
+        return min;
+
+    if (max < 0.f)
+        return -max;
+
+    return 0.f;
+}
+
+void PointLightShadowBatch::Build(const Vector3& lightPosition, const float_t radius, const std::vector<Bound>& casters)
+{
+    m_Draws.clear();
+    m_FaceDrawCount = 0;
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(casters.size()); i++)
+    {
+        const uint32_t faceMask = GetFaceMask(lightPosition, radius, casters[i]);
+        if (faceMask == 0)
+            continue;
+
+        m_Draws.push_back({ .caster = i, .faceMask = faceMask });
+        m_FaceDrawCount += static_cast<uint32_t>(std::popcount(faceMask));
+    }
+}
+
+uint32_t PointLightShadowBatch::GetFaceMask(const Vector3& lightPosition, const float_t radius, const Bound& caster)
+{
+    const Vector3 min = caster.GetMin() - lightPosition;
+    const Vector3 max = caster.GetMax() - lightPosition;
+
+    // Sphere of the light
+    const Vector3 closest(GetClosestToZero(min.x, max.x), GetClosestToZero(min.y, max.y), GetClosestToZero(min.z, max.z));
+    if (closest.x * closest.x + closest.y * closest.y + closest.z * closest.z > radius * radius)
+        return 0;
+
+    // With a 90 degrees field of view, the +X face sees the points where x >= |y| and x >= |z|, and so on for the other faces.
+    // The AABB overlaps a face if its farthest point along the face axis is beyond its closest points on the other 2 axes.
+    const float_t axisMin[3] = { min.x, min.y, min.z };
+    const float_t axisMax[3] = { max.x, max.y, max.z };
+    const float_t axisClosest[3] = { closest.x, closest.y, closest.z };
+
+    uint32_t faceMask = 0;
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        const float_t other = std::max(axisClosest[(axis + 1) % 3], axisClosest[(axis + 2) % 3]);
+
+        if (axisMax[axis] >= other)
+            faceMask |= 1u << (axis * 2);
+
+        if (-axisMin[axis] >= other)
+            faceMask |= 1u << (axis * 2 + 1);
+    }
+
+    return faceMask;
+}
+
+const std::vector<PointLightShadowDraw>& PointLightShadowBatch::GetDraws() const
+{
+    return m_Draws;
+}
+
+uint32_t PointLightShadowBatch::GetFaceDrawCount() const
+{
+    return m_FaceDrawCount;
+}
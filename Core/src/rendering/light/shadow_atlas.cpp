@@ -0,0 +1,226 @@
+#include "rendering/light/shadow_atlas.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace XnorCore;
+
+ShadowAtlas::ShadowAtlas(const int32_t size, const int32_t minTileSize, const int32_t maxTileSize)
+    : m_Size(size)
+    , m_MinTileSize(minTileSize)
+    , m_MaxTileSize(std::min(maxTileSize, size))
+{
+}
+
+void ShadowAtlas::Update(const std::vector<ShadowAtlasRequest>& requests)
+{
+    m_Tiles.assign(requests.size(), {});
+
+    // Most important shadow maps first
+    m_Order.resize(requests.size());
+    std::iota(m_Order.begin(), m_Order.end(), 0);
+    std::ranges::stable_sort(m_Order, [&](const size_t a, const size_t b) -> bool_t { return requests[a].resolution > requests[b].resolution; });
+
+    // Downgrade the tiles that don't fit in the remaining space
+    int64_t remainingArea = static_cast<int64_t>(m_Size) * m_Size;
+    for (const size_t i : m_Order)
+    {
+        int32_t tileSize = GetTileSize(requests[i]);
+        while (tileSize >= m_MinTileSize && static_cast<int64_t>(tileSize) * tileSize > remainingArea)
+            tileSize /= 2;
+
+        if (tileSize < m_MinTileSize)
+            continue;
+
+        remainingArea -= static_cast<int64_t>(tileSize) * tileSize;
+        m_Tiles[i].size = tileSize;
+    }
+
+    // Tiles whose size didn't change stay where they were
+    ClearNodes();
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        ShadowAtlasTile& tile = m_Tiles[i];
+        const auto&& it = m_Allocations.find(requests[i].handle);
+        if (tile.size == 0 || it == m_Allocations.end() || it->second.size != tile.size)
+            continue;
+
+        ReserveNode(it->second.offset, tile.size);
+        tile.offset = it->second.offset;
+        tile.changed = false;
+    }
+
+    // Largest tiles first, so that the smaller ones can't fragment the space they need
+    std::ranges::stable_sort(m_Order, [this](const size_t a, const size_t b) -> bool_t { return m_Tiles[a].size > m_Tiles[b].size; });
+
+    bool_t fits = true;
+    for (const size_t i : m_Order)
+    {
+        ShadowAtlasTile& tile = m_Tiles[i];
+        if (tile.size == 0 || !tile.changed)
+            continue;
+
+        if (!AllocateNode(tile.size, &tile.offset))
+        {
+            fits = false;
+            break;
+        }
+    }
+
+    // The tiles fit in the atlas by area, so packing all of them from the largest to the smallest one always succeeds
+    if (!fits)
+    {
+        m_RepackCount++;
+        ClearNodes();
+
+        for (const size_t i : m_Order)
+        {
+            ShadowAtlasTile& tile = m_Tiles[i];
+            if (tile.size == 0)
+                continue;
+
+            AllocateNode(tile.size, &tile.offset);
+
+            const auto&& it = m_Allocations.find(requests[i].handle);
+            tile.changed = it == m_Allocations.end() || it->second.size != tile.size || !(it->second.offset == tile.offset);
+        }
+    }
+
+    m_Allocations.clear();
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        if (m_Tiles[i].size != 0)
+            m_Allocations[requests[i].handle] = { .offset = m_Tiles[i].offset, .size = m_Tiles[i].size };
+    }
+}
+
+const std::vector<ShadowAtlasTile>& ShadowAtlas::GetTiles() const
+{
+    return m_Tiles;
+}
+
+int32_t ShadowAtlas::GetSize() const
+{
+    return m_Size;
+}
+
+float_t ShadowAtlas::GetOccupancy() const
+{
+    int64_t area = 0;
+    for (const ShadowAtlasTile& tile : m_Tiles)
+        area += static_cast<int64_t>(tile.size) * tile.size;
+
+    return static_cast<float_t>(static_cast<double_t>(area) / (static_cast<double_t>(m_Size) * m_Size));
+}
+
+uint32_t ShadowAtlas::GetRepackCount() const
+{
+    return m_RepackCount;
+}
+
+int32_t ShadowAtlas::GetTileSize(const ShadowAtlasRequest& request) const
+{
+    // Keep the current size until the resolution goes past the range of this size by more than the hysteresis
+    const auto&& it = m_Allocations.find(request.handle);
+    if (it != m_Allocations.end())
+    {
+        const float_t size = static_cast<float_t>(it->second.size);
+        if (request.resolution > size * 0.5f * (1.f - Hysteresis) && request.resolution <= size * (1.f + Hysteresis))
+            return it->second.size;
+    }
+
+    int32_t tileSize = m_MinTileSize;
+    while (tileSize < m_MaxTileSize && static_cast<float_t>(tileSize) < request.resolution)
+        tileSize *= 2;
+
+    return tileSize;
+}
+
+size_t ShadowAtlas::GetLevel(const int32_t tileSize) const
+{
+    size_t level = 0;
+    for (int32_t size = m_Size; size > tileSize; size /= 2)
+        level++;
+
+    return level;
+}
+
+void ShadowAtlas::ClearNodes()
+{
+    m_FreeNodes.assign(GetLevel(m_MinTileSize) + 1, {});
+    m_FreeNodes[0].emplace_back(0, 0);
+}
+
+void ShadowAtlas::ReserveNode(const Vector2i offset, const int32_t tileSize)
+{
+    const size_t targetLevel = GetLevel(tileSize);
+
+    // Find the free node containing the tile
+    for (size_t level = targetLevel + 1; level-- > 0;)
+    {
+        int32_t nodeSize = m_Size >> level;
+        std::vector<Vector2i>& nodes = m_FreeNodes[level];
+
+        const auto&& it = std::ranges::find_if(
+            nodes,
+            [&](const Vector2i node) -> bool_t
+            {
+                return offset.x >= node.x && offset.x < node.x + nodeSize && offset.y >= node.y && offset.y < node.y + nodeSize;
+            }
+        );
+
+        if (it == nodes.end())
+            continue;
+
+        Vector2i node = *it;
+        nodes.erase(it);
+
+        // Split it down to the tile, freeing the siblings at each level
+        for (size_t childLevel = level + 1; childLevel <= targetLevel; childLevel++)
+        {
+            nodeSize /= 2;
+            const Vector2i child(node.x + (offset.x >= node.x + nodeSize ? nodeSize : 0), node.y + (offset.y >= node.y + nodeSize ? nodeSize : 0));
+
+            for (const Vector2i sibling : { node + Vector2i(nodeSize, nodeSize), node + Vector2i(0, nodeSize), node + Vector2i(nodeSize, 0), node })
+            {
+                if (!(sibling == child))
+                    m_FreeNodes[childLevel].push_back(sibling);
+            }
+
+            node = child;
+        }
+
+        return;
+    }
+}
+
+bool_t ShadowAtlas::AllocateNode(const int32_t tileSize, Vector2i* const offset)
+{
+    const size_t targetLevel = GetLevel(tileSize);
+
+    // Smallest free node large enough
+    size_t level = targetLevel + 1;
+    while (level-- > 0)
+    {
+        if (!m_FreeNodes[level].empty())
+            break;
+    }
+
+    if (level > targetLevel)
+        return false;
+
+    Vector2i node = m_FreeNodes[level].back();
+    m_FreeNodes[level].pop_back();
+
+    // Split it down to the tile size, keeping the first child each time
+    for (int32_t nodeSize = m_Size >> level; level < targetLevel; level++)
+    {
+        nodeSize /= 2;
+        m_FreeNodes[level + 1].push_back(node + Vector2i(nodeSize, nodeSize));
+        m_FreeNodes[level + 1].push_back(node + Vector2i(0, nodeSize));
+        m_FreeNodes[level + 1].push_back(node + Vector2i(nodeSize, 0));
+    }
+
+    *offset = node;
+    return true;
+}
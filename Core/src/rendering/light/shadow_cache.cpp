@@ -0,0 +1,131 @@
+#include "rendering/light/shadow_cache.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "Maths/vector4.hpp"
+
+using namespace XnorCore;
+
+// World space AABB of the frustum of a view projection matrix
+static Bound GetFrustumBound(const Matrix& viewProjection)
+{
+    Matrix inverse;
+    try
+    {
+        inverse = viewProjection.Inverted();
+    }
+    catch (const std::invalid_argument&)
+    {
+        // Overlaps everything
+        constexpr float_t max = std::numeric_limits<float_t>::max() * 0.5f;
+        Bound bound;
+        bound.SetMinMax(Vector3(-max), Vector3(max));
+        return bound;
+    }
+
+    Vector3 min(std::numeric_limits<float_t>::max());
+    Vector3 max(std::numeric_limits<float_t>::lowest());
+    for (uint32_t corner = 0; corner < 8; corner++)
+    {
+        const Vector4 ndc((corner & 1) ? 1.f : -1.f, (corner & 2) ? 1.f : -1.f, (corner & 4) ? 1.f : -1.f, 1.f);
+        const Vector4 point = inverse * ndc;
+        const Vector3 position = Vector3(point.x, point.y, point.z) * (1.f / point.w);
+
+        min = Vector3(std::min(min.x, position.x), std::min(min.y, position.y), std::min(min.z, position.z));
+        max = Vector3(std::max(max.x, position.x), std::max(max.y, position.y), std::max(max.z, position.z));
+    }
+
+    Bound bound;
+    bound.SetMinMax(min, max);
+    return bound;
+}
+
+void ShadowCache::UpdateCasters(const std::vector<ShadowCaster>& casters)
+{
+    m_Frame++;
+    m_ChangedBounds.clear();
+    m_Statistics = {};
+
+    for (const ShadowCaster& caster : casters)
+    {
+        const auto&& it = m_Casters.find(caster.handle);
+        if (it == m_Casters.end())
+        {
+            m_Casters.emplace(caster.handle, CasterState{ .caster = caster, .frame = m_Frame });
+            m_ChangedBounds.push_back(caster.bound);
+            continue;
+        }
+
+        CasterState& state = it->second;
+        state.frame = m_Frame;
+
+        if (state.caster.mesh == caster.mesh && state.caster.transform == caster.transform && state.caster.bound == caster.bound)
+            continue;
+
+        // The shadow of the caster disappears from its previous location and appears at its new one
+        m_ChangedBounds.push_back(state.caster.bound);
+        m_ChangedBounds.push_back(caster.bound);
+        state.caster = caster;
+    }
+
+    // Removed casters
+    for (decltype(m_Casters)::iterator it = m_Casters.begin(); it != m_Casters.end();)
+    {
+        if (it->second.frame == m_Frame)
+        {
+            it++;
+            continue;
+        }
+
+        m_ChangedBounds.push_back(it->second.caster.bound);
+        it = m_Casters.erase(it);
+    }
+}
+
+bool_t ShadowCache::IsValid(const uint32_t view, const Matrix& viewProjection)
+{
+    if (view >= m_Views.size())
+        m_Views.resize(view + 1);
+
+    View& data = m_Views[view];
+
+    if (!data.valid || !(data.viewProjection == viewProjection))
+    {
+        data.viewProjection = viewProjection;
+        data.bound = GetFrustumBound(viewProjection);
+        data.valid = true;
+
+        m_Statistics.redrawnShadowMaps++;
+        return false;
+    }
+
+    for (const Bound& bound : m_ChangedBounds)
+    {
+        if (bound.Intersect(data.bound))
+        {
+            m_Statistics.redrawnShadowMaps++;
+            return false;
+        }
+    }
+
+    m_Statistics.cachedShadowMaps++;
+    return true;
+}
+
+void ShadowCache::Invalidate(const uint32_t view, const uint32_t count)
+{
+    for (size_t i = view; i < std::min<size_t>(static_cast<size_t>(view) + count, m_Views.size()); i++)
+        m_Views[i].valid = false;
+}
+
+const ShadowMapStatistics& ShadowCache::GetStatistics() const
+{
+    return m_Statistics;
+}
+
+const std::vector<Bound>& ShadowCache::GetChangedBounds() const
+{
+    return m_ChangedBounds;
+}
@@ -0,0 +1,103 @@
+#include "rendering/program_binary_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace XnorCore;
+
+// Header found before each program binary
+struct ProgramBinaryHeader
+{
+    uint32_t format;
+    uint32_t reserved;
+    uint64_t size;
+};
+
+DerivedDataKey ProgramBinaryCache::CreateKey(const std::vector<ShaderCode>& shaderCodes, const std::string_view defines, const std::string_view driver)
+{
+    // Only the part of each source given to the driver matters
+    uint64_t sourceHash = 0;
+    for (const ShaderCode& code : shaderCodes)
+    {
+        const size_t length = std::min(code.code.size(), static_cast<size_t>(std::max(code.codeLength, 0)));
+        const uint32_t type = static_cast<uint32_t>(code.type);
+
+        sourceHash = DerivedDataCache::Hash(&type, sizeof(type), sourceHash);
+        sourceHash = DerivedDataCache::Hash(code.code.data(), length, sourceHash);
+    }
+
+    const uint64_t definesHash = DerivedDataCache::Hash(defines.data(), defines.size());
+
+    return DerivedDataKey
+    {
+        .importer = "ProgramBinary",
+        .version = Version,
+        .sourceHash = sourceHash,
+        .settingsHash = DerivedDataCache::Hash(driver.data(), driver.size(), definesHash)
+    };
+}
+
+void ProgramBinaryCache::Serialize(const ProgramBinary& binary, std::vector<uint8_t>* const data)
+{
+    const ProgramBinaryHeader header
+    {
+        .format = binary.format,
+        .reserved = 0,
+        .size = binary.data.size()
+    };
+
+    data->resize(sizeof(header) + binary.data.size());
+    std::memcpy(data->data(), &header, sizeof(header));
+    if (!binary.data.empty())
+        std::memcpy(data->data() + sizeof(header), binary.data.data(), binary.data.size());
+}
+
+bool_t ProgramBinaryCache::Deserialize(const uint8_t* const data, const size_t size, ProgramBinary* const binary)
+{
+    ProgramBinaryHeader header;
+    if (size < sizeof(header))
+        return false;
+
+    std::memcpy(&header, data, sizeof(header));
+    if (header.size == 0 || header.size != size - sizeof(header))
+        return false;
+
+    binary->format = header.format;
+    binary->data.assign(data + sizeof(header), data + size);
+
+    return true;
+}
+
+bool_t ProgramBinaryCache::Get(const DerivedDataKey& key, ProgramBinary* const binary)
+{
+    if (!enabled)
+        return false;
+
+    std::vector<uint8_t> data;
+    if (!DerivedDataCache::Get(key, &data, &partition))
+        return false;
+
+    if (!Deserialize(data.data(), data.size(), binary))
+    {
+        DerivedDataCache::Remove(key, &partition);
+        return false;
+    }
+
+    return true;
+}
+
+bool_t ProgramBinaryCache::Put(const DerivedDataKey& key, const ProgramBinary& binary)
+{
+    if (!enabled || binary.data.empty())
+        return false;
+
+    std::vector<uint8_t> data;
+    Serialize(binary, &data);
+
+    return DerivedDataCache::Put(key, data.data(), data.size(), &partition);
+}
+
+void ProgramBinaryCache::Remove(const DerivedDataKey& key)
+{
+    DerivedDataCache::Remove(key, &partition);
+}
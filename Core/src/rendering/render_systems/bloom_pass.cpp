@@ -5,6 +5,9 @@
 
 using namespace XnorCore;
 
+static constexpr UniformHandle<float_t> BloomIntensityUniform("bloom_intensity");
+static constexpr UniformHandle<Vector2> TexelSizeUniform("uTexelSize");
+
 void BloomPass::Init()
 {
     m_Quad = ResourceManager::Get<Model>("assets/models/quad.obj");
@@ -44,7 +47,7 @@ void BloomPass::UpSampling(const BloomRenderTarget& bloomRenderTarget) const
     const std::vector<BloomRenderTarget::BloomMip>& mipchain = bloomRenderTarget.mipChain;
     
     m_UpSample->Use();
-    m_UpSample->SetFloat("bloom_intensity", 1.f);
+    m_UpSample->SetFloat(BloomIntensityUniform, 1.f);
 
     for (size_t i = mipchain.size() - 1; i > 0; i--)
     {
@@ -52,7 +55,7 @@ void BloomPass::UpSampling(const BloomRenderTarget& bloomRenderTarget) const
         const BloomRenderTarget::BloomMip& nextMip = mipchain[i - 1];
 
         const Vector2 mipSize = { std::floor(nextMip.sizef.x), std::floor(nextMip.sizef.y) };
-        m_UpSample->SetVec2("uTexelSize", Vector2(1.0f) / mipSize);
+        m_UpSample->SetVec2(TexelSizeUniform, Vector2(1.0f) / mipSize);
         
         // Source
         mip.texture->BindTexture(0);
@@ -76,7 +79,7 @@ void BloomPass::DownSampling(const BloomRenderTarget& bloomRenderTarget) const
     {
         m_DownSample->BindImage(1, *bloomMip.texture, 0, false, 0, ImageAccess::ReadWrite);
         const Vector2 mipSize = { std::floor(bloomMip.sizef.x), std::floor(bloomMip.sizef.y) };
-        m_DownSample->SetVec2("uTexelSize", Vector2(1.0f) / mipSize);
+        m_DownSample->SetVec2(TexelSizeUniform, Vector2(1.0f) / mipSize);
         
         m_DownSample->DispatchCompute(static_cast<uint32_t>(std::ceil(mipSize.x / ComputeShaderDispactValue)), static_cast<uint32_t>(std::ceil(mipSize.y / ComputeShaderDispactValue)), 1);  
         m_DownSample->SetMemoryBarrier(AllBarrierBits);
@@ -6,6 +6,10 @@
 
 using namespace XnorCore;
 
+static constexpr UniformHandle<Matrix> ProjectionUniform("projection");
+static constexpr UniformHandle<Matrix> ModelUniform("model");
+static constexpr UniformHandle<Vector3> TextColorUniform("textColor");
+
 void GuiPass::RenderGui(const Scene& scene, const Vector2i& viewportSize) const
 {
     const Vector2 size = static_cast<Vector2>(viewportSize);
@@ -15,12 +19,12 @@ void GuiPass::RenderGui(const Scene& scene, const Vector2i& viewportSize) const
     const Matrix matrixProj = Matrix::Orthographic(0.f, size.x, 0.f, size.y, 0.1f, 1000.f);
 
     m_FontShader->Use();
-    m_FontShader->SetMat4("projection", matrixProj); 
+    m_FontShader->SetMat4(ProjectionUniform, matrixProj); 
     RenderText();
     m_FontShader->Unuse();
     
     m_GuiShader->Use();
-    m_GuiShader->SetMat4("projection", matrixProj);
+    m_GuiShader->SetMat4(ProjectionUniform, matrixProj);
     RenderImage(size);
     m_GuiShader->Unuse();
 }
@@ -129,7 +133,7 @@ void GuiPass::RenderText() const
         if (!textComponent->font.IsValid())
             continue;
 
-        m_FontShader->SetVec3("textColor", static_cast<Vector3>(textComponent->color));
+        m_FontShader->SetVec3(TextColorUniform, static_cast<Vector3>(textComponent->color));
         float_t x = textComponent->screenTransform.x;
         const float_t y = textComponent->screenTransform.y;
 
@@ -187,7 +191,7 @@ void GuiPass::DrawImage(const Image* const imageComponent, const Vector2 viewPor
     Vector3 pos = static_cast<Vector3>(imageComponent->screenTransform * viewPortSize);
     pos.z = -1.f;
     pos.y = viewPortSize.y - pos.y; // Flip y axis to mach mouse position
-    m_GuiShader->SetMat4("model", Matrix::Trs(pos, Quaternion::Identity(), static_cast<Vector3>(imageComponent->size)));
+    m_GuiShader->SetMat4(ModelUniform, Matrix::Trs(pos, Quaternion::Identity(), static_cast<Vector3>(imageComponent->size)));
 
     // DRAW QUAD
     Rhi::DrawModel(DrawMode::Triangles, m_Quad->GetId());
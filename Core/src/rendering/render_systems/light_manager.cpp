@@ -1,29 +1,72 @@
 ﻿#include "rendering/render_systems/light_manager.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 #include "rendering/rhi.hpp"
 #include "rendering/rhi_typedef.hpp"
 #include "resource/resource_manager.hpp"
 #include "scene/entity.hpp"
+#include "scene/component/skinned_mesh_renderer.hpp"
+#include "scene/component/static_mesh_renderer.hpp"
 #include "utils/logger.hpp"
 #include "rendering/renderer.hpp"
 
 using namespace XnorCore;
 
+static constexpr UniformHandle<int32_t> FaceMaskUniform("faceMask");
+static constexpr UniformHandle<Vector3> LightPositionUniform("lightPosition");
+static constexpr std::array<UniformHandle<Matrix>, PointLightShadowBatch::FaceCount> FaceViewProjectionUniforms =
+{
+	UniformHandle<Matrix>("faceViewProjections[0]"),
+	UniformHandle<Matrix>("faceViewProjections[1]"),
+	UniformHandle<Matrix>("faceViewProjections[2]"),
+	UniformHandle<Matrix>("faceViewProjections[3]"),
+	UniformHandle<Matrix>("faceViewProjections[4]"),
+	UniformHandle<Matrix>("faceViewProjections[5]")
+};
+
+// Copies the faces of faceMask between 2 textures holding the 6 faces of a point light from the given layers
+static void CopyPointLightFaces(
+	const Texture& source,
+	const TextureType::TextureType sourceType,
+	const uint32_t sourceLayer,
+	const Texture& target,
+	const TextureType::TextureType targetType,
+	const uint32_t targetLayer,
+	const uint32_t faceMask
+)
+{
+	for (uint32_t face = 0; face < PointLightShadowBatch::FaceCount; face++)
+	{
+		if (faceMask & (1u << face))
+			Rhi::CopyTextureLayer(source.GetId(), sourceType, sourceLayer + face, target.GetId(), targetType, targetLayer + face, Vector2i(), source.GetSize());
+	}
+}
+
 LightManager::~LightManager()
 {
 	delete m_DirectionalShadowMaps;
 	m_DirectionalShadowMaps = nullptr;
+	delete m_DirectionalShadowCache;
+	m_DirectionalShadowCache = nullptr;
 
-	delete m_SpotLightShadowMapTextureArray;
-	m_SpotLightShadowMapTextureArray = nullptr;
+	delete m_SpotLightShadowAtlas;
+	m_SpotLightShadowAtlas = nullptr;
+	delete m_SpotLightShadowCache;
+	m_SpotLightShadowCache = nullptr;
 	delete m_PointLightShadowMapCubemapArrayPixelDistance;
 	m_PointLightShadowMapCubemapArrayPixelDistance = nullptr;
-	delete m_DepthBufferForPointLightPass;
-	m_DepthBufferForPointLightPass = nullptr;
+	delete m_PointLightLayeredDistance;
+	m_PointLightLayeredDistance = nullptr;
+	delete m_PointLightLayeredDepth;
+	m_PointLightLayeredDepth = nullptr;
 	delete m_ShadowFrameBufferPointLight;
 	m_ShadowFrameBufferPointLight = nullptr;
+	delete m_PointLightShadowCache;
+	m_PointLightShadowCache = nullptr;
+	delete m_PointLightDepthShadowCache;
+	m_PointLightDepthShadowCache = nullptr;
 
 
 	delete m_GpuLightData;
@@ -43,8 +86,9 @@ void LightManager::InitResources()
 	InitShader();
 	InitShadowMap();
 	
-	// need to attach it one time 
-	m_ShadowFrameBufferPointLight->AttachTexture(*m_DepthBufferForPointLightPass, Attachment::Depth, 0);
+	// The 6 faces are rendered at once into the layers of these textures, so they only need to be attached one time
+	m_ShadowFrameBufferPointLight->AttachTexture(*m_PointLightLayeredDistance, Attachment::Color00, 0);
+	m_ShadowFrameBufferPointLight->AttachTexture(*m_PointLightLayeredDepth, Attachment::Depth, 0);
 }
 
 void LightManager::BeginFrame(const Scene& scene,const Viewport& viewport, Renderer& renderer)
@@ -54,8 +98,11 @@ void LightManager::BeginFrame(const Scene& scene,const Viewport& viewport, Rende
 	scene.GetAllComponentsOfType<DirectionalLight>(&m_DirectionalLights);
 
 	FecthLightInfo();
+	UpdateShadowCasters(scene);
 	ComputeShadow(scene, viewport, renderer);
 	Rhi::UpdateLight(*m_GpuLightData);
+
+	ComputeLightClusters(viewport);
 }
 
 void LightManager::EndFrame(const Scene&)
@@ -122,58 +169,86 @@ void LightManager::DrawLightGizmoWithShader(const Camera& camera, const Scene& s
 void LightManager::BindShadowMap() const
 {
 	m_DirectionalShadowMaps->BindTexture(ShadowTextureBinding::Directional);
-	m_SpotLightShadowMapTextureArray->BindTexture(ShadowTextureBinding::SpotLight);
+	m_SpotLightShadowAtlas->BindTexture(ShadowTextureBinding::SpotLight);
 	m_PointLightShadowMapCubemapArrayPixelDistance->BindTexture(ShadowTextureBinding::PointLightCubemapArrayPixelDistance);
 }
 
 void LightManager::UnBindShadowMap() const
 {
 	m_DirectionalShadowMaps->UnbindTexture(ShadowTextureBinding::Directional);
-	m_SpotLightShadowMapTextureArray->BindTexture(ShadowTextureBinding::SpotLight);
+	m_SpotLightShadowAtlas->BindTexture(ShadowTextureBinding::SpotLight);
 	m_PointLightShadowMapCubemapArrayPixelDistance->BindTexture(ShadowTextureBinding::PointLightCubemapArrayPixelDistance);
 }
 
-void LightManager::FecthLightInfo() const
+const ShadowMapStatistics& LightManager::GetShadowMapStatistics() const
+{
+	return m_ShadowCache.GetStatistics();
+}
+
+void LightManager::FecthLightInfo()
 {
 	 if (m_DirectionalLights.size() > MaxDirectionalLights)
 		Logger::LogWarning("You cannot have more than 1 directional light in the scene");
 	
-	const size_t nbrOfpointLight = std::clamp<size_t>(m_PointLights.size(), 0, MaxPointLights);
-	const size_t nbrOfSpotLight = std::clamp<size_t>(m_SpotLights.size(), 0, MaxSpotLights);
 	const size_t nbrOfDirectionalLight = std::clamp<size_t>(m_DirectionalLights.size(), 0, MaxDirectionalLights);
 
 	m_GpuLightData->nbrOfDirLight = static_cast<uint32_t>(nbrOfDirectionalLight);
-	m_GpuLightData->nbrOfPointLight = static_cast<uint32_t>(nbrOfpointLight);
-	m_GpuLightData->nbrOfSpotLight = static_cast<uint32_t>(nbrOfSpotLight);
+	m_GpuLightData->nbrOfPointLight = static_cast<uint32_t>(m_PointLights.size());
+	m_GpuLightData->nbrOfSpotLight = static_cast<uint32_t>(m_SpotLights.size());
 
-	for (size_t i = 0; i < nbrOfpointLight; i++)
+	m_PointLightData.resize(m_PointLights.size());
+	m_PointLightBounds.resize(m_PointLights.size());
+	for (size_t i = 0; i < m_PointLights.size(); i++)
 	{
 		const PointLight* pointLight = m_PointLights[i];
+		const Vector3 position = static_cast<Vector3>(pointLight->GetEntity()->transform.worldMatrix[3]);
+		const float_t radius = LightThreshold * std::sqrt(pointLight->intensity);
 		
-		m_GpuLightData->pointLightData[i] =
+		m_PointLightData[i] =
 		{
 			.color = static_cast<Vector3>(pointLight->color),
 			.intensity = pointLight->intensity,
-			.position = static_cast<Vector3>(pointLight->GetEntity()->transform.worldMatrix[3]),
-			.radius = LightThreshold * sqrt(pointLight->intensity),
-			.isCastingShadow = pointLight[i].castShadow
+			.position = position,
+			.radius = radius,
+			// Only the first lights have a shadow map
+			.isCastingShadow = pointLight->castShadow && i < MaxPointLights
 		};
+
+		m_PointLightBounds[i] = { .position = position, .radius = radius };
 	}
 
-	for (size_t i = 0 ; i < nbrOfSpotLight ; i++)
+	m_SpotLightData.resize(m_SpotLights.size());
+	m_SpotLightBounds.resize(m_SpotLights.size());
+	for (size_t i = 0 ; i < m_SpotLights.size() ; i++)
 	{
 		const SpotLight* spotLight = m_SpotLights[i];
+		const Vector3 position = static_cast<Vector3>(spotLight->GetEntity()->transform.worldMatrix[3]);
+		const Vector3 direction = spotLight->GetLightDirection();
+		const float_t range = LightThreshold * std::sqrt(spotLight->intensity);
 		
-		m_GpuLightData->spotLightData[i] =
+		m_SpotLightData[i] =
 		{
 			.color = static_cast<Vector3>(spotLight->color),
 			.intensity = spotLight->intensity,
-			.position = static_cast<Vector3>(spotLight->GetEntity()->transform.worldMatrix[3]),
+			.position = position,
 			.cutOff = std::cos(spotLight->cutOff * Calc::Deg2Rad),
-			.direction = spotLight->GetLightDirection(),
+			.direction = direction,
 			.outerCutOff = std::cos(spotLight->outerCutOff * Calc::Deg2Rad),
-			.isCastingShadow = spotLight->castShadow,
+			.isCastingShadow = spotLight->castShadow && i < MaxSpotLights,
+			.range = range
 		};
+
+		// Bounding sphere of the cone
+		const float_t angle = spotLight->outerCutOff * Calc::Deg2Rad;
+		if (angle > Calc::PiOver4)
+		{
+			m_SpotLightBounds[i] = { .position = position + direction * (std::cos(angle) * range), .radius = std::sin(angle) * range };
+		}
+		else
+		{
+			const float_t radius = range / (2.f * std::cos(angle));
+			m_SpotLightBounds[i] = { .position = position + direction * radius, .radius = radius };
+		}
 	}
 	
 
@@ -194,37 +269,39 @@ void LightManager::FecthLightInfo() const
 
 void LightManager::ComputeShadow(const Scene& scene, const Viewport& viewport, Renderer& renderer)
 {
+	ReserveShadowCaches(
+		static_cast<uint32_t>(std::min<size_t>(m_SpotLights.size(), MaxSpotLights)),
+		static_cast<uint32_t>(std::min<size_t>(m_PointLights.size(), MaxPointLights))
+	);
+
 	ComputeShadowDirLight(scene, *viewport.camera,viewport.viewPortSize, renderer);
-	ComputeShadowSpotLight(scene, renderer);
+	ComputeShadowSpotLight(scene, viewport, renderer);
 	ComputeShadowPointLight(scene, renderer);
 }
 
 void LightManager::ComputeShadowDirLight(const Scene& scene,const Camera& viewPortCamera, const Vector2i viewportSize, Renderer& renderer)
 {
+	if (m_DirectionalLights.empty())
+		m_ShadowCache.Invalidate(DirectionalShadowView, DirectionalShadowViewCount);
+
 	for (const DirectionalLight* const directionalLight : m_DirectionalLights)
 	{
 		m_GpuLightData->directionalData->isDirlightCastingShadow = directionalLight->castShadow;
 		
 		if (!directionalLight->castShadow)
+		{
+			m_ShadowCache.Invalidate(DirectionalShadowView, DirectionalShadowViewCount);
 			continue;
+		}
 
 		const Texture& shadowMap = *m_DirectionalShadowMaps;
 		const Vector2i shadowMapSize = shadowMap.GetSize(); 
 		
 		const Vector3 lightDir = directionalLight->GetLightDirection();
 		
-		// HardCoded Shadow Cascade distance by level
-		std::array<float_t, DirectionalCascadeLevel> shadowCascadeLevels =
-		{
-		    viewPortCamera.far / 100.f,
-			viewPortCamera.far / 50.f,
-			viewPortCamera.far / 20.f,
-			viewPortCamera.far / 4.f,
-		
-		};
-
-		m_CascadeShadowMap.SetCascadeLevel(shadowCascadeLevels);
+		m_CascadeShadowMap.ComputeCascadeLevel(viewPortCamera.near, viewPortCamera.far, directionalLight->cascadeSplitLambda);
 		m_CascadeShadowMap.SetZMultiplicator(directionalLight->zCascadeShadowMapZMultiplactor);
+		const std::array<float_t, DirectionalCascadeLevel>& shadowCascadeLevels = m_CascadeShadowMap.GetCascadeLevel();
 
 		for (size_t k = 0; k < shadowCascadeLevels.size(); k++)
 		{
@@ -232,13 +309,18 @@ void LightManager::ComputeShadowDirLight(const Scene& scene,const Camera& viewPo
 		}
 		
 		std::vector<Camera> cascadedCameras;
-		m_CascadeShadowMap.GetCascadeCameras(&cascadedCameras, viewPortCamera ,lightDir, viewportSize);
+		m_CascadeShadowMap.GetCascadeCameras(&cascadedCameras, viewPortCamera ,lightDir, viewportSize, shadowMapSize.x);
 		
 		for (size_t i = 0; i < cascadedCameras.size(); i++)
 		{
-			cascadedCameras[i].isOrthographic = true;
 			cascadedCameras[i].GetVp(viewportSize, &m_GpuLightData->dirLightSpaceMatrix[i]);
 
+			// Only the casters of the slice of this cascade are drawn
+			m_CascadeShadowMap.CullCasters(i, m_ShadowCasterBounds, &m_CascadeCasters);
+			m_CascadeCasterRenderers.clear();
+			for (const uint32_t caster : m_CascadeCasters)
+				m_CascadeCasterRenderers.push_back(m_ShadowCasterRenderers[caster]);
+
 			
 			m_ShadowFrameBuffer->AttachTextureLayer(*m_DirectionalShadowMaps, Attachment::Depth, 0, static_cast<uint32_t>(i));
 			RenderPassBeginInfo renderPassBeginInfo =
@@ -249,17 +331,78 @@ void LightManager::ComputeShadowDirLight(const Scene& scene,const Camera& viewPo
 				.clearBufferFlags = BufferFlag::DepthBit,
 				.clearColor = Vector4::Zero()
 			};
-			renderer.RenderNonShadedPass(scene,cascadedCameras.at(i) , renderPassBeginInfo, m_ShadowRenderPass,m_ShadowMapShader, m_ShadowMapShaderSkinned, false);
+			const uint32_t layer = static_cast<uint32_t>(i);
+			DrawShadowMap(
+				scene,
+				cascadedCameras[i],
+				m_GpuLightData->dirLightSpaceMatrix[i],
+				DirectionalShadowView + layer,
+				renderPassBeginInfo,
+				m_ShadowMapShader,
+				m_ShadowMapShaderSkinned,
+				{ { m_DirectionalShadowMaps, TextureType::Texture2DArray, layer, m_DirectionalShadowCache, TextureType::Texture2DArray, layer } },
+				renderer,
+				&m_CascadeCasterRenderers
+			);
 		}
 	}
 }
 
-void LightManager::ComputeShadowSpotLight(const Scene& scene, Renderer& renderer)
+void LightManager::ComputeShadowSpotLight(const Scene& scene, const Viewport& viewport, Renderer& renderer)
 {
-	for (size_t i = 0; i < m_SpotLights.size(); i++)
+	const Camera& viewportCamera = *viewport.camera;
+	const float_t tanHalfFov = std::tan(viewportCamera.fov * 0.5f * Calc::Deg2Rad);
+
+	// Each shadow map asks for a resolution close to the height of its light on the screen
+	m_SpotLightShadowAtlasRequests.clear();
+	m_SpotLightShadowAtlasLights.clear();
+	const uint32_t spotLightCount = static_cast<uint32_t>(std::min<size_t>(m_SpotLights.size(), MaxSpotLights));
+	for (uint32_t i = 0; i < spotLightCount; i++)
 	{
 		if (!m_SpotLights[i]->castShadow)
-			return;
+		{
+			m_ShadowCache.Invalidate(SpotLightShadowView + i);
+			continue;
+		}
+
+		const LightBounds& bounds = m_SpotLightBounds[i];
+		const float_t distance = (bounds.position - viewportCamera.position).Length();
+
+		float_t screenCoverage = 1.f;
+		if (distance > bounds.radius)
+			screenCoverage = std::min(bounds.radius / (std::sqrt(distance * distance - bounds.radius * bounds.radius) * tanHalfFov), 1.f);
+
+		m_SpotLightShadowAtlasRequests.push_back({ .handle = m_SpotLights[i], .resolution = screenCoverage * static_cast<float_t>(viewport.viewPortSize.y) });
+		m_SpotLightShadowAtlasLights.push_back(i);
+	}
+
+	m_SpotLightShadowAtlasTiles.Update(m_SpotLightShadowAtlasRequests);
+	m_ShadowFrameBuffer->AttachTexture(*m_SpotLightShadowAtlas, Attachment::Depth, 0);
+
+	constexpr float_t atlasSize = static_cast<float_t>(SpotLightShadowAtlasSize);
+	for (size_t j = 0; j < m_SpotLightShadowAtlasLights.size(); j++)
+	{
+		const uint32_t i = m_SpotLightShadowAtlasLights[j];
+		const ShadowAtlasTile& tile = m_SpotLightShadowAtlasTiles.GetTiles()[j];
+
+		// The cached static casters were drawn in another tile
+		if (tile.changed)
+			m_ShadowCache.Invalidate(SpotLightShadowView + i);
+
+		// Not enough space left in the atlas
+		if (tile.size == 0)
+		{
+			m_SpotLightData[i].isCastingShadow = false;
+			continue;
+		}
+
+		const Vector2i tileSize(tile.size);
+		m_GpuLightData->spotLightShadowAtlasRect[i] = Vector4(
+			static_cast<float_t>(tile.offset.x) / atlasSize,
+			static_cast<float_t>(tile.offset.y) / atlasSize,
+			static_cast<float_t>(tile.size) / atlasSize,
+			static_cast<float_t>(tile.size) / atlasSize
+		);
 		
 		Camera cam;
 		cam.position = m_SpotLights[i]->entity->transform.GetPosition();
@@ -268,62 +411,313 @@ void LightManager::ComputeShadowSpotLight(const Scene& scene, Renderer& renderer
 		cam.right = Vector3::Cross(cam.front, cam.up).Normalized();
 		cam.near = m_SpotLights[i]->near;
 		cam.far = m_SpotLights[i]->far;
-		cam.GetVp(SpotLightShadowMapSize, &m_GpuLightData->spotLightSpaceMatrix[i]);
-		
-		m_ShadowFrameBuffer->AttachTextureLayer(*m_SpotLightShadowMapTextureArray, Attachment::Depth, 0, static_cast<uint32_t>(i));
+		cam.GetVp(tileSize, &m_GpuLightData->spotLightSpaceMatrix[i]);
 
 		RenderPassBeginInfo renderPassBeginInfo =
 		{
 			.frameBuffer = m_ShadowFrameBuffer,
-			.renderAreaOffset = { 0, 0 },
-			.renderAreaExtent = SpotLightShadowMapSize,
+			.renderAreaOffset = tile.offset,
+			.renderAreaExtent = tileSize,
 			.clearBufferFlags = BufferFlag::DepthBit,
 			.clearColor = Vector4(0.f)
 		};
 		
-		renderer.RenderNonShadedPass(scene, cam, renderPassBeginInfo, m_ShadowRenderPass,m_ShadowMapShader, m_ShadowMapShaderSkinned, false);
+		DrawShadowMap(
+			scene,
+			cam,
+			m_GpuLightData->spotLightSpaceMatrix[i],
+			SpotLightShadowView + i,
+			renderPassBeginInfo,
+			m_ShadowMapShader,
+			m_ShadowMapShaderSkinned,
+			{ { m_SpotLightShadowAtlas, TextureType::Texture2D, 0, m_SpotLightShadowCache, TextureType::Texture2D, 0 } },
+			renderer
+		);
 	}
+
+	// The shadow maps of the missing lights will have to be drawn again
+	m_ShadowCache.Invalidate(SpotLightShadowView + spotLightCount, MaxSpotLights - spotLightCount);
 }
 
 void LightManager::ComputeShadowPointLight(const Scene& scene, Renderer& renderer)
 {
 	Camera cam;
-	for (size_t i = 0; i < m_PointLights.size(); i++)
+	const uint32_t pointLightCount = static_cast<uint32_t>(std::min<size_t>(m_PointLights.size(), MaxPointLights));
+	for (uint32_t i = 0; i < pointLightCount; i++)
 	{
-		if (!m_PointLights[i]->castShadow)	
+		if (!m_PointLights[i]->castShadow)
+		{
+			m_ShadowCache.Invalidate(PointLightShadowView + i * PointLightShadowBatch::FaceCount, PointLightShadowBatch::FaceCount);
 			continue;
+		}
 		
 		const Vector3&& pos = static_cast<Vector3>(m_PointLights[i]->entity->transform.worldMatrix[3]);
-		
-		// Render fo each face of a the CubeMap
-		for (size_t k = 0; k < 6; k++)
+
+		// View projection of each face of the CubeMap, the faces whose static casters changed have to be drawn again
+		uint32_t staticFaceMask = 0;
+		for (uint32_t k = 0; k < PointLightShadowBatch::FaceCount; k++)
 		{
 			GetPointLightDirection(k, &cam.front, &cam.up);
 			cam.position = pos;
 			cam.near = m_PointLights[i]->near;
 			cam.far = m_PointLights[i]->far;
 			cam.right = Vector3::Cross(cam.front, cam.up).Normalized();
-			
-			// Get Current CubeMap faces In Cubemap Array
-			const uint32_t currentFace = static_cast<uint32_t>(k + i * 6);
-			m_ShadowFrameBufferPointLight->AttachTextureLayer(*m_PointLightShadowMapCubemapArrayPixelDistance, Attachment::Color00, 0, currentFace);
-			
-			RenderPassBeginInfo renderPassBeginInfo =
+			cam.GetVp(PointLightLightShadowMapSize, &m_PointLightFaceViewProjections[k]);
+
+			if (!m_ShadowCache.IsValid(PointLightShadowView + i * PointLightShadowBatch::FaceCount + k, m_PointLightFaceViewProjections[k]))
+				staticFaceMask |= 1u << k;
+		}
+
+		DrawPointLightShadowMap(scene, i, pos, staticFaceMask, renderer);
+	}
+
+	m_ShadowCache.Invalidate(
+		PointLightShadowView + pointLightCount * PointLightShadowBatch::FaceCount,
+		(MaxPointLights - pointLightCount) * PointLightShadowBatch::FaceCount
+	);
+}
+
+void LightManager::UpdateShadowCasters(const Scene& scene)
+{
+	scene.GetAllComponentsOfType<StaticMeshRenderer>(&m_StaticMeshRenderers);
+	scene.GetAllComponentsOfType<SkinnedMeshRenderer>(&m_SkinnedMeshRenderers);
+
+	// Static meshes are cached, they only cause a redraw of the shadow maps they overlap when they change
+	m_ShadowCasters.clear();
+	m_ShadowCasterRenderers.clear();
+	m_ShadowCasterBounds.clear();
+	for (const StaticMeshRenderer* const meshRenderer : m_StaticMeshRenderers)
+	{
+		if (!meshRenderer->mesh.IsValid())
+			continue;
+
+		ShadowCaster caster =
+		{
+			.handle = meshRenderer,
+			.mesh = meshRenderer->mesh.Get(),
+			.transform = meshRenderer->GetEntity()->transform.worldMatrix
+		};
+		meshRenderer->GetAabb(&caster.bound);
+
+		m_ShadowCasters.push_back(caster);
+		m_ShadowCasterRenderers.push_back(meshRenderer);
+		m_ShadowCasterBounds.push_back(caster.bound);
+	}
+
+	m_ShadowCache.UpdateCasters(m_ShadowCasters);
+
+	// Skinned meshes are drawn every frame
+	m_HadDynamicShadowCasters = m_HasDynamicShadowCasters;
+	m_HasDynamicShadowCasters = std::ranges::any_of(
+		m_SkinnedMeshRenderers,
+		[](const SkinnedMeshRenderer* const meshRenderer) -> bool_t { return meshRenderer->mesh.IsValid(); }
+	);
+}
+
+void LightManager::ReserveShadowCaches(const uint32_t spotLightCount, const uint32_t pointLightCount)
+{
+	// The spot light cache mirrors the whole atlas, and is only allocated once there is a spot light
+	if (spotLightCount != 0 && !m_SpotLightShadowCache)
+	{
+		m_SpotLightShadowCache = new Texture(
+			TextureCreateInfo
 			{
-				.frameBuffer = m_ShadowFrameBufferPointLight,
-				.renderAreaOffset = { 0, 0 },
-				.renderAreaExtent = SpotLightShadowMapSize ,
-				.clearBufferFlags = static_cast<BufferFlag::BufferFlag>(BufferFlag::DepthBit | BufferFlag::ColorBit),
-				.clearColor = Vector4(std::numeric_limits<float_t>::max())
-			};
-			
-		
-			renderer.RenderNonShadedPass(scene, cam, renderPassBeginInfo, m_ShadowRenderPass, m_ShadowMapShaderPointLight, m_ShadowMapShaderPointLightSkinned, false);
+				.textureType = TextureType::Texture2D,
+				.mipMaplevel = 1,
+				.size = Vector2i(SpotLightShadowAtlasSize),
+				.filtering = TextureFiltering::Nearest,
+				.wrapping = TextureWrapping::ClampToBorder,
+				.format = TextureFormat::DepthComponent,
+				.internalFormat = ShadowDepthTextureInternalFormat,
+				.dataType = DataType::Float
+			}
+		);
+
+		m_ShadowCache.Invalidate(SpotLightShadowView, MaxSpotLights);
+	}
+
+	// The point light caches grow with the number of shadow casting lights instead of being allocated for the maximum number of lights
+	if (pointLightCount > m_PointLightShadowCacheCapacity)
+	{
+		m_PointLightShadowCacheCapacity = std::min(std::max(pointLightCount, m_PointLightShadowCacheCapacity * 2), MaxPointLights);
+
+		delete m_PointLightShadowCache;
+		m_PointLightShadowCache = new Texture(
+			TextureCreateInfo
+			{
+				.textureType = TextureType::TextureCubeMapArray,
+				.mipMaplevel = 1,
+				.depth = m_PointLightShadowCacheCapacity,
+				.size = PointLightLightShadowMapSize,
+				.filtering = TextureFiltering::Linear,
+				.wrapping = TextureWrapping::ClampToEdge,
+				.format = TextureFormat::Red,
+				.internalFormat = TextureInternalFormat::R32F,
+				.dataType = DataType::Float
+			}
+		);
+
+		// Depth of each face, needed to draw the dynamic casters on top of the cached distances
+		delete m_PointLightDepthShadowCache;
+		m_PointLightDepthShadowCache = new Texture(
+			TextureCreateInfo
+			{
+				.textureType = TextureType::Texture2DArray,
+				.mipMaplevel = 1,
+				.depth = m_PointLightShadowCacheCapacity * 6,
+				.size = PointLightLightShadowMapSize,
+				.filtering = TextureFiltering::Nearest,
+				.wrapping = TextureWrapping::ClampToEdge,
+				.format = TextureFormat::DepthComponent,
+				.internalFormat = ShadowDepthTextureInternalFormat,
+				.dataType = DataType::Float
+			}
+		);
+
+		m_ShadowCache.Invalidate(PointLightShadowView, MaxPointLights * 6);
+	}
+}
+
+void LightManager::DrawShadowMap(
+	const Scene& scene,
+	const Camera& camera,
+	const Matrix& viewProjection,
+	const uint32_t view,
+	const RenderPassBeginInfo& renderPassBeginInfo,
+	const Pointer<Shader>& staticShader,
+	const Pointer<Shader>& skinnedShader,
+	const std::initializer_list<ShadowMapCopy> copies,
+	Renderer& renderer,
+	const std::vector<const StaticMeshRenderer*>* const staticCasters
+)
+{
+	const Vector2i offset = renderPassBeginInfo.renderAreaOffset;
+	const Vector2i size = renderPassBeginInfo.renderAreaExtent;
+
+	if (!m_ShadowCache.IsValid(view, viewProjection))
+	{
+		renderer.RenderNonShadedPass(scene, camera, renderPassBeginInfo, m_ShadowRenderPass, staticShader, skinnedShader, false, Renderer::MeshFilter::Static, staticCasters);
+
+		for (const ShadowMapCopy& copy : copies)
+			Rhi::CopyTextureLayer(copy.shadowMap->GetId(), copy.shadowMapType, copy.shadowMapLayer, copy.cache->GetId(), copy.cacheType, copy.cacheLayer, offset, size);
+	}
+	else if (m_HasDynamicShadowCasters || m_HadDynamicShadowCasters)
+	{
+		// Erase the dynamic casters of the last frame
+		for (const ShadowMapCopy& copy : copies)
+			Rhi::CopyTextureLayer(copy.cache->GetId(), copy.cacheType, copy.cacheLayer, copy.shadowMap->GetId(), copy.shadowMapType, copy.shadowMapLayer, offset, size);
+	}
+
+	if (!m_HasDynamicShadowCasters)
+		return;
+
+	RenderPassBeginInfo dynamicRenderPassBeginInfo = renderPassBeginInfo;
+	dynamicRenderPassBeginInfo.clearBufferFlags = BufferFlag::None;
+	renderer.RenderNonShadedPass(scene, camera, dynamicRenderPassBeginInfo, m_ShadowRenderPass, staticShader, skinnedShader, false, Renderer::MeshFilter::Skinned);
+}
+
+void LightManager::DrawPointLightShadowMap(const Scene& scene, const uint32_t light, const Vector3& position, const uint32_t staticFaceMask, Renderer& renderer)
+{
+	const uint32_t firstFace = light * PointLightShadowBatch::FaceCount;
+	const uint32_t cachedFaceMask = PointLightShadowBatch::AllFaces & ~staticFaceMask;
+
+	RenderPassBeginInfo renderPassBeginInfo =
+	{
+		.frameBuffer = m_ShadowFrameBufferPointLight,
+		.renderAreaOffset = { 0, 0 },
+		.renderAreaExtent = PointLightLightShadowMapSize,
+		.clearBufferFlags = static_cast<BufferFlag::BufferFlag>(BufferFlag::DepthBit | BufferFlag::ColorBit),
+		.clearColor = Vector4(std::numeric_limits<float_t>::max())
+	};
+
+	if (staticFaceMask != 0)
+	{
+		// Each caster is drawn once, the geometry shader emits its triangles to the faces it overlaps
+		m_PointLightShadowBatch.Build(position, std::min(m_PointLights[light]->far, m_PointLightData[light].radius), m_ShadowCasterBounds);
+
+		m_ShadowMapShaderPointLight->Use();
+		SetPointLightShadowUniforms(*m_ShadowMapShaderPointLight, position);
+		m_ShadowRenderPass.BeginRenderPass(renderPassBeginInfo);
+
+		for (const PointLightShadowDraw& draw : m_PointLightShadowBatch.GetDraws())
+		{
+			// Faces whose cache is valid don't need the caster
+			const uint32_t faceMask = draw.faceMask & staticFaceMask;
+			if (faceMask == 0)
+				continue;
+
+			const StaticMeshRenderer* const meshRenderer = m_ShadowCasterRenderers[draw.caster];
+			ModelUniformData modelData;
+			modelData.model = m_ShadowCasters[draw.caster].transform;
+			Rhi::UpdateModelUniform(modelData);
+			m_ShadowMapShaderPointLight->SetInt(FaceMaskUniform, static_cast<int32_t>(faceMask));
+
+			for (size_t i = 0; i < meshRenderer->mesh->models.GetSize(); i++)
+			{
+				const Pointer<Model>& model = meshRenderer->mesh->models[i];
+				if (model.IsValid())
+					Rhi::DrawModel(DrawMode::Triangles, model->GetId());
+			}
 		}
+
+		m_ShadowRenderPass.EndRenderPass();
+		m_ShadowMapShaderPointLight->Unuse();
+
+		CopyPointLightFaces(*m_PointLightLayeredDistance, TextureType::Texture2DArray, 0, *m_PointLightShadowCache, TextureType::TextureCubeMapArray, firstFace, staticFaceMask);
+		CopyPointLightFaces(*m_PointLightLayeredDepth, TextureType::Texture2DArray, 0, *m_PointLightDepthShadowCache, TextureType::Texture2DArray, firstFace, staticFaceMask);
+	}
+
+	if (m_HasDynamicShadowCasters)
+	{
+		// Restore the cached faces in the layered target, and draw the dynamic casters on top of the 6 faces at once
+		CopyPointLightFaces(*m_PointLightShadowCache, TextureType::TextureCubeMapArray, firstFace, *m_PointLightLayeredDistance, TextureType::Texture2DArray, 0, cachedFaceMask);
+		CopyPointLightFaces(*m_PointLightDepthShadowCache, TextureType::Texture2DArray, firstFace, *m_PointLightLayeredDepth, TextureType::Texture2DArray, 0, cachedFaceMask);
+
+		m_ShadowMapShaderPointLightSkinned->Use();
+		SetPointLightShadowUniforms(*m_ShadowMapShaderPointLightSkinned, position);
+		// Skinned meshes don't have a bound, they are drawn to every face
+		m_ShadowMapShaderPointLightSkinned->SetInt(FaceMaskUniform, static_cast<int32_t>(PointLightShadowBatch::AllFaces));
+
+		renderPassBeginInfo.clearBufferFlags = BufferFlag::None;
+		m_ShadowRenderPass.BeginRenderPass(renderPassBeginInfo);
+		renderer.meshesDrawer.RenderAnimationNonShaded(scene);
+		m_ShadowRenderPass.EndRenderPass();
+		m_ShadowMapShaderPointLightSkinned->Unuse();
+
+		CopyPointLightFaces(*m_PointLightLayeredDistance, TextureType::Texture2DArray, 0, *m_PointLightShadowMapCubemapArrayPixelDistance, TextureType::TextureCubeMapArray, firstFace, PointLightShadowBatch::AllFaces);
+		return;
 	}
+
+	CopyPointLightFaces(*m_PointLightLayeredDistance, TextureType::Texture2DArray, 0, *m_PointLightShadowMapCubemapArrayPixelDistance, TextureType::TextureCubeMapArray, firstFace, staticFaceMask);
+
+	// Erase the dynamic casters of the last frame
+	if (m_HadDynamicShadowCasters)
+		CopyPointLightFaces(*m_PointLightShadowCache, TextureType::TextureCubeMapArray, firstFace, *m_PointLightShadowMapCubemapArrayPixelDistance, TextureType::TextureCubeMapArray, firstFace, cachedFaceMask);
+}
+
+void LightManager::SetPointLightShadowUniforms(const Shader& shader, const Vector3& position) const
+{
+	shader.SetVec3(LightPositionUniform, position);
+	for (uint32_t i = 0; i < PointLightShadowBatch::FaceCount; i++)
+		shader.SetMat4(FaceViewProjectionUniforms[i], m_PointLightFaceViewProjections[i]);
 }
 
 
+void LightManager::ComputeLightClusters(const Viewport& viewport)
+{
+	const Camera& camera = *viewport.camera;
+
+	Matrix view;
+	Matrix projection;
+	camera.GetView(&view);
+	camera.GetProjection(viewport.viewPortSize, &projection);
+
+	m_LightClusters.Build(view, projection, camera.near, camera.far, m_PointLightBounds, m_SpotLightBounds);
+
+	Rhi::UpdateLightStorage(m_PointLightData, m_SpotLightData);
+	Rhi::UpdateLightClusters(m_LightClusters.GetGrid(), m_LightClusters.GetClusters(), m_LightClusters.GetLightIndices());
+}
+
 void LightManager::GetDistanceFromCamera(std::map<float_t, GizmoLight>* sortedLight, const Camera& camera) const
 {
 	
@@ -436,13 +830,14 @@ void LightManager::InitShadowMap()
 	};
 	
 	m_DirectionalShadowMaps = new Texture(dirLightShadowMap);
+
+	m_DirectionalShadowCache = new Texture(dirLightShadowMap);
 	
-	const TextureCreateInfo spothLightShadowArray =
+	const TextureCreateInfo spotLightShadowAtlas =
 	{
-		.textureType = TextureType::Texture2DArray,
+		.textureType = TextureType::Texture2D,
 		.mipMaplevel = 1,
-		.depth = MaxSpotLights,
-		.size = SpotLightShadowMapSize,
+		.size = Vector2i(SpotLightShadowAtlasSize),
 		.filtering = TextureFiltering::Nearest,
 		.wrapping = TextureWrapping::ClampToBorder,
 		.format = TextureFormat::DepthComponent,
@@ -450,22 +845,37 @@ void LightManager::InitShadowMap()
 		.dataType = DataType::Float
 	};
 
-	m_SpotLightShadowMapTextureArray = new Texture(spothLightShadowArray);
+	m_SpotLightShadowAtlas = new Texture(spotLightShadowAtlas);
 
-	const TextureCreateInfo pointLightDepthBufferCreateInfo =
+	const TextureCreateInfo pointLightLayeredDistanceCreateInfo =
 	{
-		.textureType = TextureType::Texture2D,
+		.textureType = TextureType::Texture2DArray,
 		.mipMaplevel = 1,
-		.depth = MaxPointLights,
+		.depth = PointLightShadowBatch::FaceCount,
 		.size = PointLightLightShadowMapSize,
-		.filtering = TextureFiltering::Linear,
+		.filtering = TextureFiltering::Nearest,
+		.wrapping = TextureWrapping::ClampToEdge,
+		.format = TextureFormat::Red,
+		.internalFormat = TextureInternalFormat::R32F,
+		.dataType = DataType::Float
+	};
+
+	m_PointLightLayeredDistance = new Texture(pointLightLayeredDistanceCreateInfo);
+
+	const TextureCreateInfo pointLightLayeredDepthCreateInfo =
+	{
+		.textureType = TextureType::Texture2DArray,
+		.mipMaplevel = 1,
+		.depth = PointLightShadowBatch::FaceCount,
+		.size = PointLightLightShadowMapSize,
+		.filtering = TextureFiltering::Nearest,
 		.wrapping = TextureWrapping::ClampToEdge,
 		.format = TextureFormat::DepthComponent,
-		.internalFormat =  ShadowDepthTextureInternalFormat,
-		.dataType =  DataType::Float
+		.internalFormat = ShadowDepthTextureInternalFormat,
+		.dataType = DataType::Float
 	};
 
-	m_DepthBufferForPointLightPass = new Texture(pointLightDepthBufferCreateInfo);
+	m_PointLightLayeredDepth = new Texture(pointLightLayeredDepthCreateInfo);
 
 	const TextureCreateInfo pointLightCubeMapArrayWorldSpaceInfo =
 	{
@@ -508,18 +918,18 @@ void LightManager::InitShader()
 	};
 
 	m_ShadowMapShader->SetFaceCullingInfo(cullInfo);
+	m_ShadowMapShader->SetFeatures({ "SKINNED" });
+	m_ShadowMapShader->AddPrewarmVariant(DepthShaderSkinned);
 	m_ShadowMapShader->CreateInInterface();
 
-	m_ShadowMapShaderPointLight = ResourceManager::Get<Shader>("depth_shader_point_light");
+	m_ShadowMapShaderSkinned = m_ShadowMapShader->GetVariant(DepthShaderSkinned);
+
+	// Renders the 6 faces of a point light in a single pass with a geometry shader
+	m_ShadowMapShaderPointLight = ResourceManager::Get<Shader>("point_light_depth_shader");
 	m_ShadowMapShaderPointLight->SetFaceCullingInfo(cullInfo);
+	m_ShadowMapShaderPointLight->SetFeatures({ "SKINNED" });
+	m_ShadowMapShaderPointLight->AddPrewarmVariant(DepthShaderSkinned);
 	m_ShadowMapShaderPointLight->CreateInInterface();
-	
-	// Skinned
-	m_ShadowMapShaderSkinned = ResourceManager::Get<Shader>("depth_shader_skinned");
-	m_ShadowMapShaderSkinned->SetFaceCullingInfo(cullInfo);
-	m_ShadowMapShaderSkinned->CreateInInterface();
-
-	m_ShadowMapShaderPointLightSkinned = ResourceManager::Get<Shader>("depth_shader_point_light_skinned");
-	m_ShadowMapShaderPointLightSkinned->SetFaceCullingInfo(cullInfo);
-	m_ShadowMapShaderPointLightSkinned->CreateInInterface();
+
+	m_ShadowMapShaderPointLightSkinned = m_ShadowMapShaderPointLight->GetVariant(DepthShaderSkinned);
 }
@@ -1,5 +1,6 @@
 ﻿#include "rendering/render_systems/meshes_drawer.hpp"
 
+#include "input/time.hpp"
 #include "rendering/frustum.hpp"
 #include "rendering/rhi.hpp"
 #include "resource/resource_manager.hpp"
@@ -8,17 +9,7 @@
 
 using namespace XnorCore;
 
-MeshesDrawer::MeshesDrawer()
-    : m_SkinnedMeshGpuData(new SkinnedMeshGpuData())
-{
-}
-
-
-
-MeshesDrawer::~MeshesDrawer()
-{
-    delete m_SkinnedMeshGpuData;
-}
+static constexpr UniformHandle<Vector3> ColorUniform("color");
 
 void MeshesDrawer::InitResources()
 {
@@ -43,7 +34,7 @@ void MeshesDrawer::DrawAabb(const Pointer<Mesh> cube) const
     m_GizmoShader->Use();
     Rhi::SetPolygonMode(PolygonFace::FrontAndBack, PolygonMode::Line);
     ModelUniformData modelData;
-    m_GizmoShader->SetVec3("color", {0.f, 1.f, 0.f});
+    m_GizmoShader->SetVec3(ColorUniform, {0.f, 1.f, 0.f});
 
     for (const StaticMeshRenderer* const staticMeshRenderer : m_StaticMeshs)
     {
@@ -103,21 +94,43 @@ void MeshesDrawer::DrawAabb(const Pointer<Mesh> cube) const
     Rhi::SetPolygonMode(PolygonFace::FrontAndBack, PolygonMode::Fill);
 }
 
-void MeshesDrawer::BeginFrame(const Scene& scene, const Renderer&)
+void MeshesDrawer::BeginFrame(const Scene& scene, const Viewport& viewport, const Renderer&)
 {
     scene.GetAllComponentsOfType<SkinnedMeshRenderer>(&m_SkinnedRender);
     scene.GetAllComponentsOfType<StaticMeshRenderer>(&m_StaticMeshs);
     PrepareOctree(scene);
+
+    // The passes of the last frame of the viewport are the best guess of how many times it will draw the skinned meshes,
+    // each viewport keeps its own count so that the ones with fewer passes don't change the mode of the other ones
+    m_Viewport = &viewport;
+    uint32_t& skinnedPassCount = m_SkinnedPassCounts[m_Viewport];
+    const uint32_t passCount = skinnedPassCount;
+    skinnedPassCount = 0;
+
+    // The bones don't change between the viewports of a frame, so only the first one uploads them
+    const uint64_t frame = Time::GetTotalFrameCount<uint64_t>();
+    if (frame != m_PreparedFrame || &scene != m_PreparedScene)
+    {
+        ReleaseUnusedCpuSkinnedModels(frame);
+        UploadBonePalette();
+        m_PreparedFrame = frame;
+        m_PreparedScene = &scene;
+    }
+
+    PrepareSkinnedMeshes(passCount, frame);
 }
 
 void MeshesDrawer::RenderAnimation() const
 {
+    m_SkinnedPassCounts[m_Viewport]++;
     m_SkinnedShader->Use();
 
-    for (const SkinnedMeshRenderer* skinnedMeshRender : m_SkinnedRender)
+    for (size_t k = 0; k < m_SkinnedRender.size(); k++)
     {
+        const SkinnedMeshRenderer* skinnedMeshRender = m_SkinnedRender[k];
         ModelUniformData modelData;
         modelData.model = skinnedMeshRender->GetTransform().worldMatrix;
+        SetSkinnedModelData(k, &modelData);
 
         try
         {
@@ -135,13 +148,8 @@ void MeshesDrawer::RenderAnimation() const
 
             for (uint32_t i = 0; i < skinnedMeshRender->mesh->models.GetSize(); i++)
             {
-                const List<Matrix>& matrices = skinnedMeshRender->GetMatrices();
-                for (size_t j = 0; j < matrices.GetSize(); j++)
-                    m_SkinnedMeshGpuData->boneMatrices[j] = matrices[j];
-
                 skinnedMeshRender->material.BindMaterial();
-                Rhi::UpdateAnimationUniform(*m_SkinnedMeshGpuData);
-                Rhi::DrawModel(DrawMode::Triangles, skinnedMeshRender->mesh->models[i]->GetId());
+                Rhi::DrawModel(DrawMode::Triangles, m_SkinnedModelIds[m_FirstSkinnedModels[k] + i]);
             }
         }
     }
@@ -150,12 +158,15 @@ void MeshesDrawer::RenderAnimation() const
 
 void MeshesDrawer::RenderAnimationNonShaded(const Scene& scene) const
 {
+    m_SkinnedPassCounts[m_Viewport]++;
 
-    for (const SkinnedMeshRenderer* skinnedMeshRender : m_SkinnedRender)
+    for (size_t k = 0; k < m_SkinnedRender.size(); k++)
     {
+        const SkinnedMeshRenderer* skinnedMeshRender = m_SkinnedRender[k];
         ModelUniformData modelData;
         modelData.model = skinnedMeshRender->GetTransform().worldMatrix;
         modelData.meshRenderIndex = scene.GetEntityIndex(skinnedMeshRender->GetEntity()) + 1;
+        SetSkinnedModelData(k, &modelData);
 
         try
         {
@@ -172,12 +183,7 @@ void MeshesDrawer::RenderAnimationNonShaded(const Scene& scene) const
         {
             for (uint32_t i = 0; i < skinnedMeshRender->mesh->models.GetSize(); i++)
             {
-                const List<Matrix>& matrices = skinnedMeshRender->GetMatrices();
-                for (size_t j = 0; j < matrices.GetSize(); j++)
-                    m_SkinnedMeshGpuData->boneMatrices[j] = matrices[j];
-
-                Rhi::UpdateAnimationUniform(*m_SkinnedMeshGpuData);
-                Rhi::DrawModel(DrawMode::Triangles, skinnedMeshRender->mesh->models[i]->GetId());
+                Rhi::DrawModel(DrawMode::Triangles, m_SkinnedModelIds[m_FirstSkinnedModels[k] + i]);
             }
         }
     }
@@ -355,38 +361,43 @@ void MeshesDrawer::RenderStaticMeshNonShaded(const Camera& camera, const Frustum
     else
     {
 #pragma region Draw iteration
-        for (const StaticMeshRenderer* mesh : m_StaticMeshs)
-        {
-            if (!mesh->mesh)
-                continue;
+        RenderStaticMeshNonShaded(m_StaticMeshs, scene);
+#pragma endregion Draw iteration
+    }
+}
 
-            for (size_t i = 0; i < mesh->mesh->models.GetSize(); i++)
-            {
-                Pointer<Model> model = mesh->mesh->models[i];
-                const Transform& transform = mesh->GetEntity()->transform;
-                ModelUniformData modelData;
-                modelData.model = transform.worldMatrix;
-                // +1 to avoid the black color of the attachment be a valid index  
-                modelData.meshRenderIndex = scene.GetEntityIndex(mesh->GetEntity()) + 1;
+void MeshesDrawer::RenderStaticMeshNonShaded(const std::vector<const StaticMeshRenderer*>& meshRenderers, const Scene& scene) const
+{
+    for (const StaticMeshRenderer* mesh : meshRenderers)
+    {
+        if (!mesh->mesh)
+            continue;
 
-                // Use a try-catch block in case the matrix is not invertible
-                try
-                {
-                    modelData.normalInvertMatrix = transform.worldMatrix.Inverted().Transposed();
-                }
-                catch (const std::invalid_argument&)
-                {
-                    modelData.normalInvertMatrix = Matrix::Identity();
-                }
+        for (size_t i = 0; i < mesh->mesh->models.GetSize(); i++)
+        {
+            Pointer<Model> model = mesh->mesh->models[i];
+            const Transform& transform = mesh->GetEntity()->transform;
+            ModelUniformData modelData;
+            modelData.model = transform.worldMatrix;
+            // +1 to avoid the black color of the attachment be a valid index  
+            modelData.meshRenderIndex = scene.GetEntityIndex(mesh->GetEntity()) + 1;
+
+            // Use a try-catch block in case the matrix is not invertible
+            try
+            {
+                modelData.normalInvertMatrix = transform.worldMatrix.Inverted().Transposed();
+            }
+            catch (const std::invalid_argument&)
+            {
+                modelData.normalInvertMatrix = Matrix::Identity();
+            }
 
-                if (model.IsValid())
-                {
-                    Rhi::UpdateModelUniform(modelData);
-                    Rhi::DrawModel(DrawMode::Triangles, model->GetId());
-                }
+            if (model.IsValid())
+            {
+                Rhi::UpdateModelUniform(modelData);
+                Rhi::DrawModel(DrawMode::Triangles, model->GetId());
             }
         }
-#pragma endregion Draw iteration
     }
 }
 
@@ -422,5 +433,143 @@ void MeshesDrawer::EndFrame()
     // In case of doing something at the end of frame 
 }
 
+const BonePalette& MeshesDrawer::GetBonePalette() const
+{
+    return m_BonePalette;
+}
+
+const SkinnedVertexCache& MeshesDrawer::GetSkinnedVertexCache() const
+{
+    return m_SkinnedVertexCache;
+}
+
+void MeshesDrawer::UploadBonePalette()
+{
+    m_BonePalette.Clear();
+    m_BoneOffsets.clear();
+
+    // Every skinned mesh is in the palette, whether a viewport then skins it on the CPU or not
+    for (const SkinnedMeshRenderer* const skinnedMeshRender : m_SkinnedRender)
+        m_BoneOffsets.push_back(m_BonePalette.Add(skinnedMeshRender->GetMatrices()));
+
+    m_BonePalette.Upload(Rhi::UpdateBonePalette);
+}
+
+void MeshesDrawer::PrepareSkinnedMeshes(const uint32_t passCount, const uint64_t frame)
+{
+    m_SkinnedVertexCache.Clear();
+    m_CpuSkinnedModelUses.clear();
+    m_CpuSkinnedInstanceModels.clear();
+    m_SkinnedModelIds.clear();
+    m_FirstSkinnedModels.clear();
+    m_IsCpuSkinned.clear();
+
+    for (const SkinnedMeshRenderer* const skinnedMeshRender : m_SkinnedRender)
+    {
+        m_FirstSkinnedModels.push_back(static_cast<uint32_t>(m_SkinnedModelIds.size()));
+
+        const bool_t isCpuSkinned = skinnedMeshRender->mesh && SkinnedVertexCache::IsCpuSkinned(skinnedMeshRender->skinningMode, passCount);
+        m_IsCpuSkinned.push_back(isCpuSkinned);
+
+        // The draws only give their offset in the palette, which is uploaded once for all the passes
+        if (!isCpuSkinned)
+        {
+            if (skinnedMeshRender->mesh)
+            {
+                for (size_t i = 0; i < skinnedMeshRender->mesh->models.GetSize(); i++)
+                    m_SkinnedModelIds.push_back(skinnedMeshRender->mesh->models[i]->GetId());
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < skinnedMeshRender->mesh->models.GetSize(); i++)
+        {
+            const Model& model = *skinnedMeshRender->mesh->models[i];
+            m_SkinnedVertexCache.Add(model.GetVertices(), skinnedMeshRender->GetMatrices());
+            m_CpuSkinnedInstanceModels.push_back(AcquireCpuSkinnedModel(model, frame));
+            m_SkinnedModelIds.push_back(m_CpuSkinnedInstanceModels.back());
+        }
+    }
+
+    // All the passes then draw the same skinned vertices
+    m_SkinnedVertexCache.Skin();
+    m_SkinnedVertexCache.Upload(
+        [this](const uint32_t instance, const Vertex* const vertices, const size_t count) -> void
+        {
+            Rhi::UpdateModelVertices(m_CpuSkinnedInstanceModels[instance], vertices, count);
+        }
+    );
+}
+
+uint32_t MeshesDrawer::AcquireCpuSkinnedModel(const Model& model, const uint64_t frame)
+{
+    std::vector<CpuSkinnedModel>& models = m_CpuSkinnedModels[&model];
+    const size_t use = m_CpuSkinnedModelUses[&model]++;
+
+    const CpuSkinnedModel source =
+    {
+        .sourceModelId = model.GetId(),
+        .sourceIndices = model.GetIndices().data(),
+        .vertexCount = static_cast<uint32_t>(model.GetVertices().size()),
+        .indexCount = static_cast<uint32_t>(model.GetIndices().size()),
+        .lastUsedFrame = frame
+    };
+
+    if (use == models.size())
+        models.push_back({});
+
+    CpuSkinnedModel& cpuSkinnedModel = models[use];
+    cpuSkinnedModel.lastUsedFrame = frame;
+
+    const bool_t isUpToDate = cpuSkinnedModel.modelId != 0
+        && cpuSkinnedModel.sourceModelId == source.sourceModelId
+        && cpuSkinnedModel.sourceIndices == source.sourceIndices
+        && cpuSkinnedModel.vertexCount == source.vertexCount
+        && cpuSkinnedModel.indexCount == source.indexCount;
+    if (isUpToDate)
+        return cpuSkinnedModel.modelId;
+
+    // The model was reloaded since its copy was created, so its indices are uploaded again with the new copy
+    if (cpuSkinnedModel.modelId != 0)
+        Rhi::DestroyModel(cpuSkinnedModel.modelId);
+
+    cpuSkinnedModel = source;
+    cpuSkinnedModel.modelId = Rhi::CreateModel(model.GetVertices(), model.GetIndices(), BufferUsage::DynamicDraw);
+    return cpuSkinnedModel.modelId;
+}
+
+void MeshesDrawer::ReleaseUnusedCpuSkinnedModels(const uint64_t frame)
+{
+    for (decltype(m_CpuSkinnedModels)::iterator it = m_CpuSkinnedModels.begin(); it != m_CpuSkinnedModels.end();)
+    {
+        // The instances of a model use its copies in order, so the unused ones are at the end
+        std::vector<CpuSkinnedModel>& models = it->second;
+        while (!models.empty() && models.back().lastUsedFrame + 1 < frame)
+        {
+            Rhi::DestroyModel(models.back().modelId);
+            models.pop_back();
+        }
+
+        if (models.empty())
+            it = m_CpuSkinnedModels.erase(it);
+        else
+            it++;
+    }
+}
+
+void MeshesDrawer::SetSkinnedModelData(const size_t skinnedMesh, ModelUniformData* const modelData) const
+{
+    // Without any bone, the skinned shaders draw the vertices skinned on the CPU as they are
+    if (m_IsCpuSkinned[skinnedMesh])
+    {
+        modelData->boneOffset = 0;
+        modelData->boneCount = 0;
+        return;
+    }
+
+    modelData->boneOffset = m_BoneOffsets[skinnedMesh];
+    modelData->boneCount = static_cast<uint32_t>(m_SkinnedRender[skinnedMesh]->GetMatrices().GetSize());
+}
+
 
 
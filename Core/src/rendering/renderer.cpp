@@ -24,7 +24,7 @@ void Renderer::Initialize()
 void Renderer::BeginFrame(const Scene& scene, const Viewport& viewport)
 {
     Rhi::ClearBuffer(BufferFlag::ColorBit);
-    meshesDrawer.BeginFrame(scene, *this);  
+    meshesDrawer.BeginFrame(scene, viewport, *this);
     lightManager.BeginFrame(scene, viewport, *this);
 }
 
@@ -40,6 +40,8 @@ void Renderer::RenderViewport(const Viewport& viewport, const Scene& scene)
     
 	BindCamera(*viewport.camera,viewport.viewPortSize);
 	m_Frustum.UpdateFromCamera(*viewport.camera,viewport.GetAspect());
+	// The characters get their animation level of detail from the views of this frame
+	World::animationSystem.AddView(*viewport.camera, viewport.viewPortSize);
 	const ViewportData& viewportData = viewport.viewportData;
 	DeferredRendering(*viewport.camera, scene, viewportData, viewport.viewPortSize);
 	ForwardPass(scene, viewport, viewport.viewPortSize, viewport.isEditor);
@@ -219,20 +221,30 @@ void Renderer::DrawMeshRendersByType(const MaterialType materialType, const Scen
 void Renderer::RenderNonShadedPass(const Scene& scene, const Camera& camera,
                                    const RenderPassBeginInfo& renderPassBeginInfo,
                                    const RenderPass& renderPass, const Pointer<Shader>& shaderToUseStatic,const Pointer<Shader>& shaderToUseSkinned,
-                                   bool_t drawEditorUi)
+                                   bool_t drawEditorUi, const MeshFilter meshFilter, const std::vector<const StaticMeshRenderer*>* staticMeshes)
 {
     shaderToUseStatic->Use();
-    const Vector2i viewportSize = renderPassBeginInfo.renderAreaOffset + renderPassBeginInfo.renderAreaExtent;
+    // The render area can be a tile of a larger target, e.g. a shadow atlas
+    const Vector2i viewportSize = renderPassBeginInfo.renderAreaExtent;
     const float_t aspect =  static_cast<float_t>(viewportSize.x) / static_cast<float_t>(viewportSize.y);
     BindCamera(camera, viewportSize);
     m_Frustum.UpdateFromCamera(camera, aspect);
     renderPass.BeginRenderPass(renderPassBeginInfo);
-    meshesDrawer.RenderStaticMeshNonShaded(camera, m_Frustum, scene);
+    if (meshFilter != MeshFilter::Skinned)
+    {
+        if (staticMeshes)
+            meshesDrawer.RenderStaticMeshNonShaded(*staticMeshes, scene);
+        else
+            meshesDrawer.RenderStaticMeshNonShaded(camera, m_Frustum, scene);
+    }
     shaderToUseStatic->Unuse();
 
-    shaderToUseSkinned->Use();
-    meshesDrawer.RenderAnimationNonShaded(scene);
-    shaderToUseSkinned->Unuse();
+    if (meshFilter != MeshFilter::Static)
+    {
+        shaderToUseSkinned->Use();
+        meshesDrawer.RenderAnimationNonShaded(scene);
+        shaderToUseSkinned->Unuse();
+    }
 
     shaderToUseStatic->Use();
     if (drawEditorUi)
@@ -299,7 +311,7 @@ void Renderer::InitResources()
     m_GBufferShaderLit->SetInt("brdfLUT", DefferedDescriptor::SkyboxPrecomputeBrdf);
 
     m_GBufferShaderLit->SetInt("dirLightShadowMap", ShadowTextureBinding::Directional);
-    m_GBufferShaderLit->SetInt("spotLightShadowArray", ShadowTextureBinding::SpotLight);
+    m_GBufferShaderLit->SetInt("spotLightShadowAtlas", ShadowTextureBinding::SpotLight);
     m_GBufferShaderLit->SetInt("pointLightCubemapArrayPixelDistance",
                                ShadowTextureBinding::PointLightCubemapArrayPixelDistance);
 
@@ -9,6 +9,7 @@
 #include "magic_enum/magic_enum.hpp"
 #include "rendering/camera.hpp"
 #include "rendering/frame_buffer.hpp"
+#include "rendering/program_binary_cache.hpp"
 #include "rendering/render_pass.hpp"
 #include "resource/resource_manager.hpp"
 #include "resource/shader.hpp"
@@ -33,7 +34,13 @@ void Rhi::BeginRenderPassInternal(const RenderPassBeginInfo& beginInfo)
 	SetClearColor(beginInfo.clearColor);
 	
 	if (beginInfo.clearBufferFlags != BufferFlag::None)
+	{
+		// Only clear the render area, e.g. a single tile of a shadow atlas
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(beginInfo.renderAreaOffset.x, beginInfo.renderAreaOffset.y, beginInfo.renderAreaExtent.x, beginInfo.renderAreaExtent.y);
 		ClearBuffer(beginInfo.clearBufferFlags);
+		glDisable(GL_SCISSOR_TEST);
+	}
 
 	SetViewport(beginInfo.renderAreaOffset, beginInfo.renderAreaExtent);
 }
@@ -43,7 +50,7 @@ void Rhi::EndRenderPass()
 	UnbindFrameBuffer();
 }
 
-uint32_t Rhi::CreateModel(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+uint32_t Rhi::CreateModel(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const BufferUsage vertexUsage)
 {
 	ModelInternal modelInternal;
 	modelInternal.nbrOfVertex = static_cast<uint32_t>(vertices.size());
@@ -55,7 +62,7 @@ uint32_t Rhi::CreateModel(const std::vector<Vertex>& vertices, const std::vector
 	glCreateBuffers(1, &modelInternal.ebo);
 
 	GLintptr size = static_cast<GLintptr>(vertices.size() * sizeof(Vertex));
-	glNamedBufferData(modelInternal.vbo, size, vertices.data(), GL_STATIC_DRAW);
+	glNamedBufferData(modelInternal.vbo, size, vertices.data(), BufferUsageToOpenglUsage(vertexUsage));
 	size = static_cast<GLintptr>(indices.size() * sizeof(uint32_t));
 	glNamedBufferData(modelInternal.ebo, size, indices.data(), GL_STATIC_DRAW);
 
@@ -119,9 +126,20 @@ bool_t Rhi::DestroyModel(const uint32_t modelId)
 	if (glIsVertexArray(model->vao))
 		glDeleteVertexArrays(1, &model->vao);
 
+	// The id might be given to a new model
+	m_ModelMap.erase(modelId);
+
 	return true;
 }
 
+void Rhi::UpdateModelVertices(const uint32_t modelId, const Vertex* const vertices, const size_t count)
+{
+	const ModelInternal& model = m_ModelMap.at(modelId);
+	const size_t vertexCount = std::min(count, static_cast<size_t>(model.nbrOfVertex));
+
+	glNamedBufferSubData(model.vbo, 0, static_cast<GLsizeiptr>(vertexCount * sizeof(Vertex)), vertices);
+}
+
 void Rhi::DrawModel(const ENUM_VALUE(DrawMode) drawMode,const uint32_t modelId)
 {
 	const ModelInternal model = m_ModelMap.at(modelId);
@@ -142,7 +160,7 @@ void Rhi::DestroyProgram(const uint32_t shaderId)
 	glDeleteProgram(shaderId);
 }
 
-uint32_t Rhi::ReloadProgram(const uint32_t oldShaderId, const std::vector<ShaderCode>& shaderCodes)
+uint32_t Rhi::ReloadProgram(const uint32_t oldShaderId, const std::vector<ShaderCode>& shaderCodes, const std::string_view defines)
 {
 	if (!m_ShaderMap.contains(oldShaderId) || !glIsProgram(oldShaderId))
 	{
@@ -154,13 +172,13 @@ uint32_t Rhi::ReloadProgram(const uint32_t oldShaderId, const std::vector<Shader
 	
 	const ShaderInternal oldData = m_ShaderMap[oldShaderId];
 	m_ShaderMap.erase(oldShaderId);
-	const uint32_t result = CreateShaders(shaderCodes, ShaderCreateInfo{oldData.depthFunction, oldData.blendFunction, oldData.cullInfo});
+	const uint32_t result = CreateShaders(shaderCodes, ShaderCreateInfo{oldData.depthFunction, oldData.blendFunction, oldData.cullInfo}, defines);
 
 	UseShader(result);
-	for (auto&& uniform : oldData.uniformMap)
+	for (const UniformTableEntry& uniform : oldData.uniforms.GetEntries())
 	{
-		auto val = uniform.second;
-		SetUniform(val.type, &val.data, result, uniform.first.c_str());
+		if (uniform.hasValue)
+			SetUniform(uniform.uniform.type, &uniform.uniform.data, result, HashUniformName(uniform.name), HashUniformNameCheck(uniform.name), uniform.name.c_str());
 	}
 	UnuseShader();
 	
@@ -193,9 +211,32 @@ void Rhi::CheckCompilationError(const uint32_t shaderId, const std::string& type
 	}
 }
 
-uint32_t Rhi::CreateShaders(const std::vector<ShaderCode>& shaderCodes, const ShaderCreateInfo& shaderCreateInfo)
+uint32_t Rhi::CreateShaders(const std::vector<ShaderCode>& shaderCodes, const ShaderCreateInfo& shaderCreateInfo, const std::string_view defines)
 {
 	const uint32_t programId = glCreateProgram();
+
+	const DerivedDataKey binaryKey = ProgramBinaryCache::CreateKey(shaderCodes, defines, m_DriverString);
+
+	// Compiling from source is always possible, even if the driver rejects the cached binary
+	if (!LoadProgramBinary(programId, binaryKey))
+	{
+		CompileProgram(programId, shaderCodes);
+		StoreProgramBinary(programId, binaryKey);
+	}
+
+	ShaderInternal shaderInternal;
+	shaderInternal.depthFunction = shaderCreateInfo.depthFunction;
+	shaderInternal.blendFunction = shaderCreateInfo.blendFunction;
+	shaderInternal.cullInfo = shaderCreateInfo.shaderProgramCullInfo;
+	ReflectUniforms(programId, &shaderInternal.uniforms);
+	
+	m_ShaderMap.emplace(programId, std::move(shaderInternal));
+	
+	return programId;
+}
+
+void Rhi::CompileProgram(const uint32_t programId, const std::vector<ShaderCode>& shaderCodes)
+{
 	std::vector<uint32_t> shaderIds(shaderCodes.size());
 
 	for (size_t i = 0; i < shaderCodes.size(); i++)
@@ -213,24 +254,71 @@ uint32_t Rhi::CreateShaders(const std::vector<ShaderCode>& shaderCodes, const Sh
 		glAttachShader(programId, shaderIds[i]);
 		
 	}
+
+	if (m_ProgramBinarySupported)
+		glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
 	glLinkProgram(programId);
 
 	for (size_t i = 0; i < shaderIds.size(); i++)
 	{
 		if (glIsShader(shaderIds[i]))
+		{
+			glDetachShader(programId, shaderIds[i]);
 			glDeleteShader(shaderIds[i]);
+		}
 	}
 		
 	CheckCompilationError(programId, "PROGRAM");
+}
 
-	ShaderInternal shaderInternal;
-	shaderInternal.depthFunction = shaderCreateInfo.depthFunction;
-	shaderInternal.blendFunction = shaderCreateInfo.blendFunction;
-	shaderInternal.cullInfo = shaderCreateInfo.shaderProgramCullInfo;
-	
-	m_ShaderMap.emplace(programId, shaderInternal);
-	
-	return programId;
+bool_t Rhi::LoadProgramBinary(const uint32_t programId, const DerivedDataKey& key)
+{
+	if (!m_ProgramBinarySupported)
+		return false;
+
+	ProgramBinary binary;
+	if (!ProgramBinaryCache::Get(key, &binary))
+		return false;
+
+	glProgramBinary(programId, binary.format, binary.data.data(), static_cast<GLsizei>(binary.data.size()));
+
+	int32_t success = 0;
+	glGetProgramiv(programId, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		// Can happen if the driver changed in a way that isn't reflected in its version string
+		Logger::LogWarning("The driver rejected the cached program binary {}, compiling from source", DerivedDataCache::GetKeyString(key));
+		ProgramBinaryCache::Remove(key);
+		return false;
+	}
+
+	return true;
+}
+
+void Rhi::StoreProgramBinary(const uint32_t programId, const DerivedDataKey& key)
+{
+	if (!m_ProgramBinarySupported || !ProgramBinaryCache::enabled)
+		return;
+
+	int32_t success = 0;
+	glGetProgramiv(programId, GL_LINK_STATUS, &success);
+	if (!success)
+		return;
+
+	int32_t length = 0;
+	glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	ProgramBinary binary;
+	binary.data.resize(static_cast<size_t>(length));
+
+	GLenum format = 0;
+	glGetProgramBinary(programId, length, nullptr, &format, binary.data.data());
+	binary.format = format;
+
+	(void) ProgramBinaryCache::Put(key, binary);
 }
 
 void Rhi::UseShader(const uint32_t shaderId)
@@ -284,7 +372,16 @@ void Rhi::UnuseShader()
 
 void Rhi::SetUniform(const UniformType::UniformType uniformType, const void* const data, const uint32_t shaderId, const char_t* const uniformKey)
 {
-	GpuUniform& uniform = GetUniformInMap(shaderId, uniformKey, uniformType);
+	SetUniform(uniformType, data, shaderId, HashUniformName(uniformKey), HashUniformNameCheck(uniformKey), uniformKey);
+}
+
+void Rhi::SetUniform(const UniformType::UniformType uniformType, const void* const data, const uint32_t shaderId, const uint32_t uniformHash, const uint32_t uniformCheckHash, const char_t* const uniformKey)
+{
+	UniformTableEntry& entry = GetUniformInMap(shaderId, uniformHash, uniformCheckHash, uniformKey);
+	entry.uniform.type = uniformType;
+	entry.hasValue = true;
+
+	GpuUniform& uniform = entry.uniform;
 
 	const int32_t value = static_cast<int32_t>(uniform.shaderKey);
 	
@@ -1056,6 +1153,16 @@ void Rhi::BlitFrameBuffer(const uint32_t readBuffer, const uint32_t targetBuffer
 	);
 }
 
+void Rhi::CopyTextureLayer(const uint32_t sourceId, const TextureType::TextureType sourceType, const uint32_t sourceLayer,
+	const uint32_t targetId, const TextureType::TextureType targetType, const uint32_t targetLayer, const Vector2i offset, const Vector2i size)
+{
+	glCopyImageSubData(
+		sourceId, GetOpenglTextureType(sourceType), 0, offset.x, offset.y, static_cast<GLint>(sourceLayer),
+		targetId, GetOpenglTextureType(targetType), 0, offset.x, offset.y, static_cast<GLint>(targetLayer),
+		size.x, size.y, 1
+	);
+}
+
 void Rhi::BindFrameBuffer(const uint32_t frameBufferId)
 {
 	if (glIsFramebuffer(frameBufferId))
@@ -1111,6 +1218,86 @@ void Rhi::GetPixelFromAttachement(const uint32_t attachmentIndex, const Vector2i
 	glReadPixels(position.x, position.y, 1, 1, format, dataTypeOpengl, output);
 }
 
+void Rhi::ReadPixelsToBuffer(
+	const uint32_t frameBufferId,
+	const uint32_t attachmentIndex,
+	const Vector2i position,
+	const Vector2i size,
+	const TextureFormat::TextureFormat textureFormat,
+	const DataType::DataType dataType,
+	const uint32_t bufferId
+)
+{
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, frameBufferId);
+	glReadBuffer(GL_COLOR_ATTACHMENT0 + static_cast<GLint>(attachmentIndex));
+
+	// With a pack buffer bound, glReadPixels only queues the copy and returns
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, bufferId);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(position.x, position.y, size.x, size.y, GetOpenGlTextureFormat(textureFormat), GetOpenglDataType(dataType), nullptr);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+void* Rhi::CreateFence()
+{
+	return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool_t Rhi::IsFenceSignaled(void* const fence)
+{
+	// Flush so that the fence is guaranteed to be signaled eventually, but don't wait for it
+	const GLenum status = glClientWaitSync(static_cast<GLsync>(fence), GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+void Rhi::DestroyFence(void* const fence)
+{
+	glDeleteSync(static_cast<GLsync>(fence));
+}
+
+size_t Rhi::GetPixelSize(const TextureFormat::TextureFormat textureFormat, const DataType::DataType dataType)
+{
+	size_t channels = 1;
+	switch (textureFormat)
+	{
+		case TextureFormat::RedGreen:
+			channels = 2;
+			break;
+
+		case TextureFormat::Rgb:
+			channels = 3;
+			break;
+
+		case TextureFormat::Rgba:
+			channels = 4;
+			break;
+
+		default:
+			break;
+	}
+
+	switch (dataType)
+	{
+		case DataType::Short:
+		case DataType::UnsignedShort:
+			return channels * 2;
+
+		case DataType::Int:
+		case DataType::UnsignedInt:
+		case DataType::Float:
+			return channels * 4;
+
+		case DataType::Double:
+			return channels * 8;
+
+		default:
+			return channels;
+	}
+}
+
 void Rhi::SwapBuffers()
 {
 	glfwSwapBuffers(glfwGetCurrentContext());
@@ -1329,19 +1516,52 @@ void Rhi::IsShaderValid(const uint32_t shaderId)
 	}
 }
 
-GpuUniform& Rhi::GetUniformInMap(const uint32_t shaderId, const char_t* const uniformKey, const UniformType::UniformType type)
+UniformTableEntry& Rhi::GetUniformInMap(const uint32_t shaderId, const uint32_t uniformHash, const uint32_t uniformCheckHash, const char_t* const uniformKey)
 {
-	auto& shaderUniformMap = m_ShaderMap.at(shaderId).uniformMap;
+	UniformTable& uniforms = m_ShaderMap.at(shaderId).uniforms;
 
-	if (shaderUniformMap.contains(uniformKey))
-		return shaderUniformMap[uniformKey];
+	UniformTableEntry* const entry = uniforms.Find(uniformHash, uniformCheckHash);
+	if (entry)
+		return *entry;
 
+	// Only array elements other than the first one aren't reflected when the program is linked
 	const GLint location = glGetUniformLocation(shaderId, uniformKey);
 	if (location == NullUniformLocation)
 		Logger::LogWarning("No uniform with key [{}] in shader #{}", uniformKey, shaderId);
 
-	shaderUniformMap[uniformKey] = GpuUniform{type, static_cast<uint32_t>(location)};
-	return shaderUniformMap[uniformKey];
+	return uniforms.Add(uniformKey, static_cast<uint32_t>(location));
+}
+
+void Rhi::ReflectUniforms(const uint32_t programId, UniformTable* const uniforms)
+{
+	int32_t uniformCount = 0;
+	glGetProgramiv(programId, GL_ACTIVE_UNIFORMS, &uniformCount);
+
+	int32_t maxNameLength = 0;
+	glGetProgramiv(programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	std::string name(static_cast<size_t>(maxNameLength), '\0');
+
+	for (int32_t i = 0; i < uniformCount; i++)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(programId, static_cast<GLuint>(i), maxNameLength, &length, &size, &type, name.data());
+
+		const std::string uniformName = name.substr(0, static_cast<size_t>(length));
+		const GLint location = glGetUniformLocation(programId, uniformName.c_str());
+
+		// Members of uniform blocks don't have a location
+		if (location == NullUniformLocation)
+			continue;
+
+		uniforms->Add(uniformName, static_cast<uint32_t>(location));
+
+		// Arrays are reported as their first element, but can also be set using their name only
+		if (uniformName.ends_with("[0]"))
+			uniforms->Add(uniformName.substr(0, uniformName.size() - 3), static_cast<uint32_t>(location));
+	}
 }
 
 uint32_t Rhi::GetOpenglDataType(const DataType::DataType dataType)
@@ -1584,6 +1804,8 @@ void Rhi::Initialize()
 	glEnable(GL_STENCIL_TEST);
 	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);  
 
+	InitializeProgramBinaries();
+
 #ifdef _DEBUG
 	glEnable(GL_DEBUG_OUTPUT);
 	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS); 
@@ -1593,19 +1815,39 @@ void Rhi::Initialize()
 #endif
 }
 
-void Rhi::Shutdown()
+void Rhi::InitializeProgramBinaries()
 {
-	// ReSharper disable once CppDiscardedPostfixOperatorResult
-	for (decltype(m_ModelMap)::iterator it = m_ModelMap.begin(); it != m_ModelMap.end(); it++)
+	int32_t formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	m_ProgramBinarySupported = formatCount > 0;
+
+	// Binaries are only valid for the exact driver that created them
+	const auto getString = [](const GLenum name) -> std::string_view
 	{
-		DestroyModel(it->first);
-	}
+		const char_t* const str = reinterpret_cast<const char_t*>(glGetString(name));
+		return str ? str : "";
+	};
+	m_DriverString = std::format("{};{};{}", getString(GL_VENDOR), getString(GL_RENDERER), getString(GL_VERSION));
+
+	if (!m_ProgramBinarySupported)
+		Logger::LogInfo("The driver doesn't support program binaries, shaders will always be compiled from source");
+}
+
+void Rhi::Shutdown()
+{
+	while (!m_ModelMap.empty())
+		DestroyModel(m_ModelMap.begin()->first);
 
 	delete m_CameraUniform;
 	delete m_ModelUniform;
 	delete m_LightUniform;
 	delete m_MaterialUniform;
-	delete m_AnimationBuffer;
+
+	delete m_BonePaletteStorage;
+	delete m_PointLightStorage;
+	delete m_SpotLightStorage;
+	delete m_LightClusterStorage;
+	delete m_LightIndexStorage;
 }
 
 void Rhi::PrepareRendering()
@@ -1626,9 +1868,26 @@ void Rhi::PrepareRendering()
 	m_MaterialUniform->Allocate(sizeof(MaterialData),nullptr);
 	m_MaterialUniform->Bind(4);
 
-	m_AnimationBuffer = new UniformBuffer();
-	m_AnimationBuffer->Allocate(sizeof(SkinnedMeshGpuData),nullptr);
-	m_AnimationBuffer->Bind(5);
+	// Storage buffers can't be empty when bound
+	m_BonePaletteStorage = new ShaderStorageBuffer;
+	m_BonePaletteStorage->Allocate(sizeof(Matrix), nullptr);
+	m_BonePaletteStorage->Bind(5);
+
+	m_PointLightStorage = new ShaderStorageBuffer;
+	m_PointLightStorage->Allocate(sizeof(PointLightData), nullptr);
+	m_PointLightStorage->Bind(6);
+
+	m_SpotLightStorage = new ShaderStorageBuffer;
+	m_SpotLightStorage->Allocate(sizeof(SpotLightData), nullptr);
+	m_SpotLightStorage->Bind(7);
+
+	m_LightClusterStorage = new ShaderStorageBuffer;
+	m_LightClusterStorage->Allocate(sizeof(GpuLightClusterGrid) + sizeof(GpuLightCluster), nullptr);
+	m_LightClusterStorage->Bind(8);
+
+	m_LightIndexStorage = new ShaderStorageBuffer;
+	m_LightIndexStorage->Allocate(sizeof(uint32_t), nullptr);
+	m_LightIndexStorage->Bind(9);
 
 	skyBoxParser.Init();
 }
@@ -1653,9 +1912,10 @@ void Rhi::UpdateCameraUniform(const CameraUniformData& cameraUniformData)
 	m_CameraUniform->Update(sizeof(CameraUniformData), 0, cameraUniformData.view.Raw());
 }
 
-void Rhi::UpdateAnimationUniform(const SkinnedMeshGpuData& skinnedMeshGpuData)
+void Rhi::UpdateBonePalette(const Matrix* const matrices, const size_t count)
 {
-	m_AnimationBuffer->Update(sizeof(SkinnedMeshGpuData), 0, skinnedMeshGpuData.boneMatrices->Raw());
+	m_BonePaletteStorage->Reserve(count * sizeof(Matrix));
+	m_BonePaletteStorage->Update(count * sizeof(Matrix), 0, matrices);
 }
 
 void Rhi::UpdateLight(const GpuLightData& lightData)
@@ -1663,6 +1923,25 @@ void Rhi::UpdateLight(const GpuLightData& lightData)
 	m_LightUniform->Update(sizeof(GpuLightData), 0, &lightData.nbrOfPointLight);
 }
 
+void Rhi::UpdateLightStorage(const std::vector<PointLightData>& pointLights, const std::vector<SpotLightData>& spotLights)
+{
+	m_PointLightStorage->Reserve(pointLights.size() * sizeof(PointLightData));
+	m_PointLightStorage->Update(pointLights.size() * sizeof(PointLightData), 0, pointLights.data());
+
+	m_SpotLightStorage->Reserve(spotLights.size() * sizeof(SpotLightData));
+	m_SpotLightStorage->Update(spotLights.size() * sizeof(SpotLightData), 0, spotLights.data());
+}
+
+void Rhi::UpdateLightClusters(const GpuLightClusterGrid& grid, const std::vector<GpuLightCluster>& clusters, const std::vector<uint32_t>& lightIndices)
+{
+	m_LightClusterStorage->Reserve(sizeof(GpuLightClusterGrid) + clusters.size() * sizeof(GpuLightCluster));
+	m_LightClusterStorage->Update(sizeof(GpuLightClusterGrid), 0, &grid);
+	m_LightClusterStorage->Update(clusters.size() * sizeof(GpuLightCluster), sizeof(GpuLightClusterGrid), clusters.data());
+
+	m_LightIndexStorage->Reserve(lightIndices.size() * sizeof(uint32_t));
+	m_LightIndexStorage->Update(lightIndices.size() * sizeof(uint32_t), 0, lightIndices.data());
+}
+
 void Rhi::BindMaterial(const Material& material)
 {
 	MaterialData materialData;
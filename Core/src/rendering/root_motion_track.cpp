@@ -0,0 +1,108 @@
+#include "rendering/root_motion_track.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Maths/calc.hpp"
+
+using namespace XnorCore;
+
+void RootMotionTrack::Bake(const Vector3* const translations, const Quaternion* const rotations, const size_t sampleCount)
+{
+    m_Samples.resize(sampleCount == 0 ? 0 : sampleCount + 1);
+    if (sampleCount == 0)
+        return;
+
+    float_t previousYaw = GetYaw(rotations[0]);
+    float_t unwrappedYaw = 0.f;
+
+    for (size_t i = 0; i < sampleCount; i++)
+    {
+        // The angles are wrapped between -pi and pi, a turn is kept by adding the shortest difference
+        const float_t yaw = GetYaw(rotations[i]);
+        float_t difference = yaw - previousYaw;
+        if (difference > Calc::Pi)
+            difference -= Calc::PiTimes2;
+        else if (difference < -Calc::Pi)
+            difference += Calc::PiTimes2;
+
+        unwrappedYaw += difference;
+        previousYaw = yaw;
+
+        m_Samples[i] = { .translation = translations[i] - translations[0], .yaw = unwrappedYaw };
+    }
+
+    // The end of the loop keeps the movement of the last interval
+    const Sample& last = m_Samples[sampleCount - 1];
+    const Sample& beforeLast = m_Samples[sampleCount == 1 ? 0 : sampleCount - 2];
+    m_Samples[sampleCount] = { .translation = last.translation * 2.f - beforeLast.translation, .yaw = last.yaw * 2.f - beforeLast.yaw };
+}
+
+void RootMotionTrack::Clear()
+{
+    m_Samples.clear();
+}
+
+void RootMotionTrack::GetDelta(const float_t normalizedTime, const float_t normalizedDelta, Vector3* const translation, float_t* const yaw) const
+{
+    Vector3 startTranslation;
+    float_t startYaw = 0.f;
+    GetOffset(normalizedTime, &startTranslation, &startYaw);
+
+    Vector3 endTranslation;
+    float_t endYaw = 0.f;
+    GetOffset(normalizedTime + normalizedDelta, &endTranslation, &endYaw);
+
+    *translation = endTranslation - startTranslation;
+    *yaw = endYaw - startYaw;
+}
+
+Vector3 RootMotionTrack::GetLoopTranslation() const
+{
+    return m_Samples.empty() ? Vector3() : m_Samples.back().translation;
+}
+
+float_t RootMotionTrack::GetLoopYaw() const
+{
+    return m_Samples.empty() ? 0.f : m_Samples.back().yaw;
+}
+
+size_t RootMotionTrack::GetSampleCount() const
+{
+    return m_Samples.size();
+}
+
+size_t RootMotionTrack::GetMemorySize() const
+{
+    return m_Samples.size() * sizeof(Sample);
+}
+
+float_t RootMotionTrack::GetYaw(const Quaternion& rotation)
+{
+    // Direction of the rotated forward axis on the ground
+    const float_t x = 2.f * (rotation.X() * rotation.Z() + rotation.W() * rotation.Y());
+    const float_t z = 1.f - 2.f * (rotation.X() * rotation.X() + rotation.Y() * rotation.Y());
+    return std::atan2(x, z);
+}
+
+void RootMotionTrack::GetOffset(const float_t normalizedTime, Vector3* const translation, float_t* const yaw) const
+{
+    if (m_Samples.empty())
+    {
+        *translation = Vector3();
+        *yaw = 0.f;
+        return;
+    }
+
+    const float_t loops = std::floor(normalizedTime);
+    const float_t position = (normalizedTime - loops) * static_cast<float_t>(m_Samples.size() - 1);
+    const size_t index = std::min(static_cast<size_t>(position), m_Samples.size() - 1);
+    const size_t nextIndex = std::min(index + 1, m_Samples.size() - 1);
+    const float_t t = position - static_cast<float_t>(index);
+
+    const Sample& sample = m_Samples[index];
+    const Sample& nextSample = m_Samples[nextIndex];
+
+    *translation = GetLoopTranslation() * loops + Vector3::Lerp(sample.translation, nextSample.translation, t);
+    *yaw = GetLoopYaw() * loops + std::lerp(sample.yaw, nextSample.yaw, t);
+}
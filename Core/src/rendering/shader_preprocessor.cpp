@@ -0,0 +1,423 @@
+#include "rendering/shader_preprocessor.hpp"
+
+#include <algorithm>
+#include <optional>
+
+#include "utils/logger.hpp"
+
+using namespace XnorCore;
+
+// State of an #if block
+struct ConditionalBlock
+{
+    // Whether the condition only depends on features, in which case the directives are removed
+    bool_t resolved;
+    bool_t parentActive;
+    // Whether the lines of the current branch are kept
+    bool_t active;
+    // Whether a branch of the block was already taken
+    bool_t taken;
+};
+
+static bool_t IsIdentifierCharacter(const char_t c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static std::string_view Trim(std::string_view str)
+{
+    const size_t first = str.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos)
+        return {};
+
+    const size_t last = str.find_last_not_of(" \t\r");
+    return str.substr(first, last - first + 1);
+}
+
+static bool_t ContainsIdentifier(const std::string_view str, const std::string_view identifier)
+{
+    for (size_t pos = str.find(identifier); pos != std::string_view::npos; pos = str.find(identifier, pos + 1))
+    {
+        const size_t end = pos + identifier.size();
+        if ((pos == 0 || !IsIdentifierCharacter(str[pos - 1])) && (end == str.size() || !IsIdentifierCharacter(str[end])))
+            return true;
+    }
+
+    return false;
+}
+
+// Evaluates #if expressions made of features, returns std::nullopt if the expression depends on anything else
+class ExpressionEvaluator
+{
+public:
+    ExpressionEvaluator(const std::string_view expression, const std::vector<std::string>& features, const uint32_t enabledFeatures)
+        : m_Expression(expression)
+        , m_Features(features)
+        , m_EnabledFeatures(enabledFeatures)
+    {
+    }
+
+    std::optional<bool_t> Evaluate()
+    {
+        const bool_t result = ParseOr();
+
+        SkipWhitespaces();
+        if (!m_Resolvable || m_Position != m_Expression.size())
+            return std::nullopt;
+
+        return result;
+    }
+
+private:
+    std::string_view m_Expression;
+    const std::vector<std::string>& m_Features;
+    uint32_t m_EnabledFeatures;
+    size_t m_Position = 0;
+    bool_t m_Resolvable = true;
+
+    void SkipWhitespaces()
+    {
+        while (m_Position < m_Expression.size() && (m_Expression[m_Position] == ' ' || m_Expression[m_Position] == '\t'))
+            m_Position++;
+    }
+
+    bool_t Accept(const std::string_view token)
+    {
+        SkipWhitespaces();
+        if (!m_Expression.substr(m_Position).starts_with(token))
+            return false;
+
+        m_Position += token.size();
+        return true;
+    }
+
+    std::string_view ParseIdentifier()
+    {
+        SkipWhitespaces();
+        const size_t start = m_Position;
+        while (m_Position < m_Expression.size() && IsIdentifierCharacter(m_Expression[m_Position]))
+            m_Position++;
+
+        return m_Expression.substr(start, m_Position - start);
+    }
+
+    bool_t GetFeature(const std::string_view name)
+    {
+        const auto&& it = std::ranges::find(m_Features, name);
+        if (it == m_Features.end())
+        {
+            m_Resolvable = false;
+            return false;
+        }
+
+        return (m_EnabledFeatures >> (it - m_Features.begin()) & 1) != 0;
+    }
+
+    bool_t ParseOr()
+    {
+        bool_t result = ParseAnd();
+        while (m_Resolvable && Accept("||"))
+            result = ParseAnd() || result;
+
+        return result;
+    }
+
+    bool_t ParseAnd()
+    {
+        bool_t result = ParseUnary();
+        while (m_Resolvable && Accept("&&"))
+            result = ParseUnary() && result;
+
+        return result;
+    }
+
+    bool_t ParseUnary()
+    {
+        if (Accept("!"))
+            return !ParseUnary();
+
+        return ParsePrimary();
+    }
+
+    bool_t ParsePrimary()
+    {
+        if (Accept("("))
+        {
+            const bool_t result = ParseOr();
+            if (!Accept(")"))
+                m_Resolvable = false;
+
+            return result;
+        }
+
+        const std::string_view identifier = ParseIdentifier();
+        if (identifier.empty())
+        {
+            m_Resolvable = false;
+            return false;
+        }
+
+        if (identifier == "defined")
+        {
+            const bool_t parenthesis = Accept("(");
+            const bool_t result = GetFeature(ParseIdentifier());
+            if (parenthesis && !Accept(")"))
+                m_Resolvable = false;
+
+            return result;
+        }
+
+        if (std::ranges::all_of(identifier, [](const char_t c) -> bool_t { return c >= '0' && c <= '9'; }))
+            return identifier.find_first_not_of('0') != std::string_view::npos;
+
+        return GetFeature(identifier);
+    }
+};
+
+static std::optional<bool_t> EvaluateCondition(
+    const std::string_view directive,
+    const std::string_view expression,
+    const std::vector<std::string>& features,
+    const uint32_t enabledFeatures
+)
+{
+    if (directive == "ifdef" || directive == "ifndef")
+    {
+        const auto&& it = std::ranges::find(features, expression);
+        if (it == features.end())
+            return std::nullopt;
+
+        const bool_t defined = (enabledFeatures >> (it - features.begin()) & 1) != 0;
+        return directive == "ifdef" ? defined : !defined;
+    }
+
+    return ExpressionEvaluator(expression, features, enabledFeatures).Evaluate();
+}
+
+// Replaces the defined checks of features by their value, as disabled features are defined to 0 instead of being undefined
+static std::string ReplaceDefinedFeatures(const std::string_view line, const std::vector<std::string>& features, const uint32_t enabledFeatures)
+{
+    std::string result;
+    result.reserve(line.size());
+
+    size_t position = 0;
+    while (position < line.size())
+    {
+        if (!IsIdentifierCharacter(line[position]))
+        {
+            result += line[position++];
+            continue;
+        }
+
+        const size_t start = position;
+        while (position < line.size() && IsIdentifierCharacter(line[position]))
+            position++;
+
+        const std::string_view identifier = line.substr(start, position - start);
+        result += identifier;
+
+        if (identifier != "defined")
+            continue;
+
+        // Either defined FEATURE or defined(FEATURE)
+        size_t nameStart = std::min(line.find_first_not_of(" \t", position), line.size());
+        const bool_t parenthesis = nameStart < line.size() && line[nameStart] == '(';
+        if (parenthesis)
+            nameStart = std::min(line.find_first_not_of(" \t", nameStart + 1), line.size());
+
+        size_t end = nameStart;
+        while (end < line.size() && IsIdentifierCharacter(line[end]))
+            end++;
+
+        const auto&& it = std::ranges::find(features, line.substr(nameStart, end - nameStart));
+        if (it == features.end())
+            continue;
+
+        if (parenthesis)
+        {
+            end = std::min(line.find_first_not_of(" \t", end), line.size());
+            if (end == line.size() || line[end] != ')')
+                continue;
+
+            end++;
+        }
+
+        result.resize(result.size() - identifier.size());
+        result += (enabledFeatures >> (it - features.begin()) & 1) != 0 ? '1' : '0';
+        position = end;
+    }
+
+    return result;
+}
+
+bool_t ShaderPreprocessor::Preprocess(const std::string_view source, const std::vector<std::string>& features, const uint32_t enabledFeatures, std::string* const output)
+{
+    if (features.size() > MaxFeatures)
+    {
+        Logger::LogError("Shaders can't have more than {} features", MaxFeatures);
+        return false;
+    }
+
+    std::string result;
+    result.reserve(source.size());
+
+    std::vector<ConditionalBlock> blocks;
+    size_t versionEnd = 0;
+
+    size_t lineNumber = 0;
+    for (size_t lineStart = 0; lineStart < source.size(); )
+    {
+        size_t lineEnd = source.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos)
+            lineEnd = source.size();
+
+        const std::string_view line = source.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+        lineNumber++;
+
+        const bool_t active = blocks.empty() || blocks.back().active;
+        bool_t keepLine = active;
+
+        std::string_view directive;
+        std::string_view expression;
+
+        const std::string_view trimmed = Trim(line);
+        if (trimmed.starts_with('#'))
+        {
+            std::string_view content = Trim(trimmed.substr(1));
+            const size_t comment = std::min(content.find("//"), content.find("/*"));
+            if (comment != std::string_view::npos)
+                content = Trim(content.substr(0, comment));
+
+            const size_t directiveEnd = std::min(content.find_first_of(" \t("), content.size());
+            directive = content.substr(0, directiveEnd);
+            expression = Trim(content.substr(directiveEnd));
+        }
+
+        if (directive == "if" || directive == "ifdef" || directive == "ifndef")
+        {
+            const std::optional<bool_t> condition = active ? EvaluateCondition(directive, expression, features, enabledFeatures) : std::nullopt;
+
+            if (!active)
+            {
+                blocks.push_back({ .resolved = true, .parentActive = false, .active = false, .taken = true });
+                keepLine = false;
+            }
+            else if (condition)
+            {
+                blocks.push_back({ .resolved = true, .parentActive = true, .active = *condition, .taken = *condition });
+                keepLine = false;
+            }
+            else
+            {
+                blocks.push_back({ .resolved = false, .parentActive = true, .active = true, .taken = false });
+            }
+        }
+        else if (directive == "elif" || directive == "else" || directive == "endif")
+        {
+            if (blocks.empty())
+            {
+                Logger::LogError("Unexpected #{} at line {}", directive, lineNumber);
+                return false;
+            }
+
+            ConditionalBlock& block = blocks.back();
+            keepLine = !block.resolved && block.parentActive;
+
+            if (block.resolved && directive == "elif")
+            {
+                if (block.taken || !block.parentActive)
+                {
+                    block.active = false;
+                }
+                else
+                {
+                    const std::optional<bool_t> condition = EvaluateCondition(directive, expression, features, enabledFeatures);
+                    if (!condition)
+                    {
+                        Logger::LogError("Unresolvable #elif following a feature condition at line {}", lineNumber);
+                        return false;
+                    }
+
+                    block.active = *condition;
+                    block.taken = *condition;
+                }
+            }
+            else if (block.resolved && directive == "else")
+            {
+                block.active = block.parentActive && !block.taken;
+                block.taken = true;
+            }
+            else if (directive == "endif")
+            {
+                blocks.pop_back();
+            }
+        }
+
+        if (!keepLine)
+            continue;
+
+        // The kept conditionals are the unresolved ones
+        if (directive == "if" || directive == "elif")
+            result += ReplaceDefinedFeatures(line, features, enabledFeatures);
+        else
+            result += line;
+        result += '\n';
+
+        if (versionEnd == 0 && directive == "version")
+            versionEnd = result.size();
+    }
+
+    if (!blocks.empty())
+    {
+        Logger::LogError("Missing #endif at the end of the shader source");
+        return false;
+    }
+
+    // Disabled features are defined as well, otherwise the driver can't compile the unresolved conditionals using them
+    std::string defines;
+    for (size_t i = 0; i < features.size(); i++)
+    {
+        if (ContainsIdentifier(result, features[i]))
+            defines += "#define " + features[i] + ((enabledFeatures >> i & 1) != 0 ? " 1\n" : " 0\n");
+    }
+
+    result.insert(versionEnd, defines);
+    *output = std::move(result);
+
+    return true;
+}
+
+uint32_t ShaderPreprocessor::GetFeatureMask(const std::vector<std::string>& features, const std::string_view feature)
+{
+    const auto&& it = std::ranges::find(features, feature);
+    if (it == features.end() || static_cast<size_t>(it - features.begin()) >= MaxFeatures)
+        return 0;
+
+    return 1u << (it - features.begin());
+}
+
+std::string ShaderPreprocessor::GetVariantName(const std::vector<std::string>& features, const uint32_t enabledFeatures)
+{
+    std::string name;
+    for (size_t i = 0; i < features.size(); i++)
+    {
+        if ((enabledFeatures >> i & 1) == 0)
+            continue;
+
+        if (!name.empty())
+            name += '|';
+        name += features[i];
+    }
+
+    return name;
+}
+
+std::string ShaderPreprocessor::GetDefines(const std::vector<std::string>& features, const uint32_t enabledFeatures)
+{
+    std::string defines;
+    for (size_t i = 0; i < features.size(); i++)
+        defines += "#define " + features[i] + ((enabledFeatures >> i & 1) != 0 ? " 1\n" : " 0\n");
+
+    return defines;
+}
@@ -0,0 +1,204 @@
+#include "rendering/skinned_vertex_cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+
+#include <emmintrin.h>
+
+using namespace XnorCore;
+
+static_assert(sizeof(Matrix) == 16 * sizeof(float_t), "The bone matrices are read as 4 columns of 4 floats");
+
+// Matrix stored as 4 columns
+struct Columns
+{
+    __m128 columns[4];
+};
+
+static Columns LoadColumns(const Matrix& matrix, const float_t weight)
+{
+    const __m128 factor = _mm_set1_ps(weight);
+    const float_t* const data = matrix.Raw();
+
+    return
+    {
+        {
+            _mm_mul_ps(_mm_loadu_ps(data), factor),
+            _mm_mul_ps(_mm_loadu_ps(data + 4), factor),
+            _mm_mul_ps(_mm_loadu_ps(data + 8), factor),
+            _mm_mul_ps(_mm_loadu_ps(data + 12), factor)
+        }
+    };
+}
+
+static void AddColumns(Columns* const result, const Matrix& matrix, const float_t weight)
+{
+    const __m128 factor = _mm_set1_ps(weight);
+    const float_t* const data = matrix.Raw();
+
+    for (size_t i = 0; i < 4; i++)
+        result->columns[i] = _mm_add_ps(result->columns[i], _mm_mul_ps(_mm_loadu_ps(data + i * 4), factor));
+}
+
+static __m128 TransformDirection(const Columns& matrix, const Vector3& direction)
+{
+    return _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(matrix.columns[0], _mm_set1_ps(direction.x)), _mm_mul_ps(matrix.columns[1], _mm_set1_ps(direction.y))),
+        _mm_mul_ps(matrix.columns[2], _mm_set1_ps(direction.z))
+    );
+}
+
+static Vector3 ToVector3(const __m128 v)
+{
+    alignas(16) float_t components[4];
+    _mm_store_ps(components, v);
+    return Vector3(components[0], components[1], components[2]);
+}
+
+static Vector3 Normalize(const Vector3& v)
+{
+    const float_t squaredLength = v.SquaredLength();
+    if (squaredLength == 0.f)
+        return v;
+
+    return v / std::sqrt(squaredLength);
+}
+
+bool_t SkinnedVertexCache::IsCpuSkinned(const SkinningMode mode, const uint32_t passCount)
+{
+    switch (mode)
+    {
+        case SkinningMode::Gpu:
+            return false;
+
+        case SkinningMode::Cpu:
+            return true;
+
+        case SkinningMode::Automatic:
+            // Skinning on the CPU costs about as much as a pass, and uploading the vertices a bit more
+            return passCount >= MinCpuSkinningPassCount;
+    }
+
+    return false;
+}
+
+void SkinnedVertexCache::Skin(const Vertex* const vertices, const size_t count, const Matrix* const boneMatrices, const size_t boneCount, Vertex* const result)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const Vertex& vertex = vertices[i];
+        Vertex& skinned = result[i];
+        skinned = vertex;
+
+        // The weighted bone matrices are summed first, so each attribute is transformed once
+        Columns matrix{};
+        bool_t hasBones = false;
+        bool_t isValid = true;
+        for (size_t j = 0; j < Vertex::MaxBoneWeight; j++)
+        {
+            const int32_t bone = static_cast<int32_t>(vertex.boneIndices[j]);
+            if (bone == -1)
+                continue;
+
+            if (bone < 0 || static_cast<size_t>(bone) >= boneCount)
+            {
+                isValid = false;
+                break;
+            }
+
+            if (hasBones)
+                AddColumns(&matrix, boneMatrices[bone], vertex.boneWeight[j]);
+            else
+                matrix = LoadColumns(boneMatrices[bone], vertex.boneWeight[j]);
+
+            hasBones = true;
+        }
+
+        if (!hasBones || !isValid)
+            continue;
+
+        skinned.position = ToVector3(_mm_add_ps(TransformDirection(matrix, vertex.position), matrix.columns[3]));
+        skinned.normal = Normalize(ToVector3(TransformDirection(matrix, vertex.normal)));
+        skinned.tangent = Normalize(ToVector3(TransformDirection(matrix, vertex.tangent)));
+        skinned.bitangent = Normalize(ToVector3(TransformDirection(matrix, vertex.bitangent)));
+    }
+}
+
+void SkinnedVertexCache::Clear()
+{
+    m_Instances.clear();
+    m_Chunks.clear();
+    m_VertexCount = 0;
+    m_Statistics = {};
+}
+
+uint32_t SkinnedVertexCache::Add(const std::vector<Vertex>& vertices, const List<Matrix>& boneMatrices)
+{
+    const uint32_t instance = static_cast<uint32_t>(m_Instances.size());
+    m_Instances.push_back({ .vertices = &vertices, .boneMatrices = &boneMatrices, .offset = m_VertexCount });
+
+    for (size_t begin = 0; begin < vertices.size(); begin += ChunkSize)
+        m_Chunks.push_back({ .instance = instance, .begin = begin, .end = std::min(begin + ChunkSize, vertices.size()) });
+
+    m_VertexCount += vertices.size();
+
+    m_Statistics.instanceCount++;
+    m_Statistics.vertexCount = static_cast<uint32_t>(m_VertexCount);
+
+    return instance;
+}
+
+void SkinnedVertexCache::Skin(const bool_t parallel)
+{
+    if (m_Vertices.size() < m_VertexCount)
+        m_Vertices.resize(m_VertexCount);
+
+    // Each chunk writes its own vertices, so they can be skinned in any order
+    const auto skinChunk = [this](const Chunk& chunk) -> void
+    {
+        const Instance& instance = m_Instances[chunk.instance];
+        Skin(
+            instance.vertices->data() + chunk.begin,
+            chunk.end - chunk.begin,
+            instance.boneMatrices->GetData(),
+            instance.boneMatrices->GetSize(),
+            m_Vertices.data() + instance.offset + chunk.begin
+        );
+    };
+
+    if (parallel)
+        std::for_each(std::execution::par, m_Chunks.begin(), m_Chunks.end(), skinChunk);
+    else
+        std::for_each(m_Chunks.begin(), m_Chunks.end(), skinChunk);
+}
+
+void SkinnedVertexCache::Upload(const SkinnedVertexUpload& upload)
+{
+    for (uint32_t i = 0; i < m_Instances.size(); i++)
+    {
+        const size_t count = GetVertexCount(i);
+        upload(i, GetVertices(i), count);
+        m_Statistics.uploadedBytes += count * sizeof(Vertex);
+    }
+}
+
+size_t SkinnedVertexCache::GetInstanceCount() const
+{
+    return m_Instances.size();
+}
+
+const Vertex* SkinnedVertexCache::GetVertices(const uint32_t instance) const
+{
+    return m_Vertices.data() + m_Instances[instance].offset;
+}
+
+size_t SkinnedVertexCache::GetVertexCount(const uint32_t instance) const
+{
+    return m_Instances[instance].vertices->size();
+}
+
+const SkinnedVertexCacheStatistics& SkinnedVertexCache::GetStatistics() const
+{
+    return m_Statistics;
+}
@@ -0,0 +1,65 @@
+#include "rendering/uniform_table.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "utils/logger.hpp"
+
+using namespace XnorCore;
+
+// Names with the same first hash are told apart by the second one, which only costs a wider comparison in the binary search
+static uint64_t GetKey(const uint32_t hash, const uint32_t checkHash)
+{
+    return static_cast<uint64_t>(hash) << 32 | checkHash;
+}
+
+UniformTableEntry& UniformTable::Add(const std::string& name, const uint32_t location)
+{
+    const uint64_t key = GetKey(HashUniformName(name), HashUniformNameCheck(name));
+
+    const auto&& it = std::ranges::lower_bound(m_Keys, key);
+    const size_t index = static_cast<size_t>(it - m_Keys.begin());
+
+    if (it != m_Keys.end() && *it == key)
+    {
+        if (m_Entries[index].name != name)
+            Logger::LogError("Uniforms {} and {} have the same name hashes, rename one of them", m_Entries[index].name, name);
+
+        return m_Entries[index];
+    }
+
+    m_Keys.insert(it, key);
+    return *m_Entries.insert(m_Entries.begin() + static_cast<std::ptrdiff_t>(index), UniformTableEntry { .name = name, .uniform = { .shaderKey = location } });
+}
+
+UniformTableEntry* UniformTable::Find(const uint32_t hash, const uint32_t checkHash)
+{
+    return const_cast<UniformTableEntry*>(std::as_const(*this).Find(hash, checkHash));
+}
+
+const UniformTableEntry* UniformTable::Find(const uint32_t hash, const uint32_t checkHash) const
+{
+    const uint64_t key = GetKey(hash, checkHash);
+    const auto&& it = std::ranges::lower_bound(m_Keys, key);
+
+    if (it == m_Keys.end() || *it != key)
+        return nullptr;
+
+    return &m_Entries[static_cast<size_t>(it - m_Keys.begin())];
+}
+
+size_t UniformTable::GetCount() const
+{
+    return m_Entries.size();
+}
+
+const std::vector<UniformTableEntry>& UniformTable::GetEntries() const
+{
+    return m_Entries;
+}
+
+void UniformTable::Clear()
+{
+    m_Keys.clear();
+    m_Entries.clear();
+}
@@ -1,5 +1,9 @@
 #include "resource/animation.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "input/time.hpp"
 #include "rendering/animator.hpp"
 #include "rendering/rhi_typedef.hpp"
@@ -10,6 +14,15 @@ using namespace XnorCore;
 void Animation::BindSkeleton(Pointer<Skeleton> bindedSkeleton)
 {
     skeleton = std::move(bindedSkeleton);
+    BindTracks();
+}
+
+bool_t Animation::IsBound() const
+{
+    if (!skeleton)
+        return m_BoundSkeleton == nullptr;
+
+    return m_BoundSkeleton == skeleton.Get() && m_BoneTracks.size() == skeleton->GetBones().GetSize();
 }
 
 bool_t Animation::Load(const uint8_t* const, const int64_t)
@@ -24,18 +37,24 @@ bool_t Animation::Load(const aiAnimation& loadedData)
     m_FrameDuration = 1.f / m_Framerate;
     m_Duration = static_cast<float_t>(loadedData.mDuration / loadedData.mTicksPerSecond);
 
+    // The source keys are only kept until they are compressed
+    std::vector<List<KeyFrame>> keyFrames(loadedData.mNumChannels);
+    m_TrackNames.resize(loadedData.mNumChannels);
+
     for (uint32_t i = 0; i < loadedData.mNumChannels; i++)
     {
         const aiNodeAnim* const channel = loadedData.mChannels[i];
-        std::string name = channel->mNodeName.C_Str();
-
-        auto&& it = m_KeyFrames.emplace(name, channel->mNumPositionKeys);
+        m_TrackNames[i] = channel->mNodeName.C_Str();
+        keyFrames[i].Resize(channel->mNumPositionKeys);
 
         for (uint32_t j = 0; j < channel->mNumPositionKeys; j++)
         {
+            const uint32_t rotationKey = std::min(j, channel->mNumRotationKeys - 1);
+            const uint32_t scalingKey = std::min(j, channel->mNumScalingKeys - 1);
+
             const Vector3 translation = Vector3(&channel->mPositionKeys[j].mValue.x);
-            const Quaternion rotation = Quaternion(Vector3(&channel->mRotationKeys[j].mValue.x), channel->mRotationKeys[j].mValue.w);
-            const Vector3 scaling = Vector3(&channel->mScalingKeys[j].mValue.x);
+            const Quaternion rotation = Quaternion(Vector3(&channel->mRotationKeys[rotationKey].mValue.x), channel->mRotationKeys[rotationKey].mValue.w);
+            const Vector3 scaling = Vector3(&channel->mScalingKeys[scalingKey].mValue.x);
 
             const KeyFrame keyFrame =
             {
@@ -45,10 +64,15 @@ bool_t Animation::Load(const aiAnimation& loadedData)
                 .time = static_cast<float_t>(channel->mPositionKeys[j].mTime)
             };
 
-            it.first->second[j] = keyFrame;
+            keyFrames[i][j] = keyFrame;
         }
     }
 
+    m_CompressedAnimation.Compress(keyFrames, compressionSettings);
+
+    // The animation might be loaded back while its skeleton is already set
+    BindTracks();
+
     return true;
 }
 
@@ -73,14 +97,158 @@ float_t Animation::GetFrameDuration() const
     return m_FrameDuration;
 }
 
-void Animation::GetBoneKeyFrame(const Bone& bone, const List<Animation::KeyFrame>** keyFrames) const
+bool_t Animation::SampleBone(const size_t boneIndex, const float_t normalizedTime, Vector3* const translation, Quaternion* const rotation, Vector3* const scaling) const
+{
+    if (boneIndex >= m_BoneTracks.size() || m_BoneTracks[boneIndex] == InvalidTrack)
+        return false;
+
+    m_CompressedAnimation.Sample(m_BoneTracks[boneIndex], normalizedTime, translation, rotation, scaling);
+    return true;
+}
+
+bool_t Animation::SamplePose(const float_t normalizedTime, AnimationPose* const pose, const uint8_t skippedLeafLevels) const
+{
+    pose->Resize(m_BoneTracks.size());
+
+    Vector3* const translations = pose->GetTranslations();
+    Quaternion* const rotations = pose->GetRotations();
+    Vector3* const scalings = pose->GetScalings();
+
+    for (size_t i = 0; i < m_BoneTracks.size(); i++)
+    {
+        const uint32_t track = m_BoneTracks[i];
+        if (track == InvalidTrack)
+            return false;
+
+        if (m_BoneHeights[i] < skippedLeafLevels)
+            continue;
+
+        m_CompressedAnimation.Sample(track, normalizedTime, &translations[i], &rotations[i], &scalings[i]);
+    }
+
+    return true;
+}
+
+size_t Animation::GetSampledBoneCount(const uint8_t skippedLeafLevels) const
+{
+    if (skippedLeafLevels == 0)
+        return m_BoneHeights.size();
+
+    return static_cast<size_t>(std::ranges::count_if(m_BoneHeights, [skippedLeafLevels](const uint8_t height) -> bool_t { return height >= skippedLeafLevels; }));
+}
+
+const std::vector<uint32_t>& Animation::GetBoneTracks() const
+{
+    return m_BoneTracks;
+}
+
+const std::vector<std::string>& Animation::GetTrackNames() const
+{
+    return m_TrackNames;
+}
+
+size_t Animation::GetMemorySize() const
+{
+    return m_CompressedAnimation.GetMemorySize() + m_BoneTracks.size() * sizeof(uint32_t) + m_RootMotion.GetMemorySize();
+}
+
+const CompressedAnimation& Animation::GetCompressedAnimation() const
+{
+    return m_CompressedAnimation;
+}
+
+const RootMotionTrack& Animation::GetRootMotion() const
 {
-    auto&& it = m_KeyFrames.find(bone.name);
-    if (it == m_KeyFrames.end())
+    return m_RootMotion;
+}
+
+void Animation::BindTracks()
+{
+    m_BoneTracks.clear();
+    m_BoneHeights.clear();
+    m_RootMotion.Clear();
+    m_RootMotionBone = std::numeric_limits<size_t>::max();
+
+    if (!skeleton)
     {
-        *keyFrames = nullptr;
+        m_BoundSkeleton = nullptr;
         return;
     }
 
-    *keyFrames = &it->second;
+    m_BoundSkeleton = skeleton.Get();
+
+    // Bone names are only hashed here, the animation is then sampled by index
+    std::unordered_map<std::string_view, uint32_t> tracks;
+    tracks.reserve(m_TrackNames.size());
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_TrackNames.size()); i++)
+        tracks.emplace(m_TrackNames[i], i);
+
+    const List<Bone>& bones = skeleton->GetBones();
+    m_BoneTracks.resize(bones.GetSize(), InvalidTrack);
+    for (size_t i = 0; i < bones.GetSize(); i++)
+    {
+        auto&& it = tracks.find(bones[i].name);
+        if (it != tracks.end())
+            m_BoneTracks[i] = it->second;
+    }
+
+    // The children are stored after their parent, so each bone gets the heights of all its children before its own parent
+    m_BoneHeights.resize(bones.GetSize(), 0);
+    for (size_t i = bones.GetSize(); i-- > 0;)
+    {
+        const int32_t parent = bones[i].parentId;
+        if (parent >= 0 && static_cast<size_t>(parent) < bones.GetSize() && m_BoneHeights[i] < std::numeric_limits<uint8_t>::max())
+            m_BoneHeights[parent] = std::max(m_BoneHeights[parent], static_cast<uint8_t>(m_BoneHeights[i] + 1));
+    }
+
+    BakeRootMotion();
+}
+
+void Animation::BakeRootMotion()
+{
+    // The first animated bone without a parent moves the whole character
+    const List<Bone>& bones = skeleton->GetBones();
+    uint32_t track = InvalidTrack;
+    size_t bone = 0;
+    for (size_t i = 0; i < bones.GetSize() && track == InvalidTrack; i++)
+    {
+        if (bones[i].parentId < 0)
+        {
+            track = m_BoneTracks[i];
+            bone = i;
+        }
+    }
+
+    if (track == InvalidTrack)
+        return;
+
+    // One sample per frame, the compressed keys are only sampled here and the track is then read without any pose
+    const size_t sampleCount = std::max<size_t>(m_FrameCount, 1);
+    std::vector<Vector3> translations(sampleCount);
+    std::vector<Quaternion> rotations(sampleCount);
+    for (size_t i = 0; i < sampleCount; i++)
+    {
+        Vector3 scaling;
+        const float_t normalizedTime = static_cast<float_t>(i) / static_cast<float_t>(sampleCount);
+        m_CompressedAnimation.Sample(track, normalizedTime, &translations[i], &rotations[i], &scaling);
+    }
+
+    m_RootMotion.Bake(translations.data(), rotations.data(), sampleCount);
+
+    m_RootMotionBone = bone;
+    m_RootMotionStartTranslation = translations[0];
+    m_RootMotionStartYaw = RootMotionTrack::GetYaw(rotations[0]);
+}
+
+void Animation::RemoveRootMotion(AnimationPose* const pose) const
+{
+    if (m_RootMotionBone >= pose->GetBoneCount())
+        return;
+
+    // The sampled transform is used instead of the baked track, which is extrapolated at the end of the loop
+    Quaternion& rotation = pose->GetRotations()[m_RootMotionBone];
+    const float_t yaw = RootMotionTrack::GetYaw(rotation) - m_RootMotionStartYaw;
+    rotation = Quaternion(0.f, std::sin(-yaw * 0.5f), 0.f, std::cos(-yaw * 0.5f)) * rotation;
+
+    pose->GetTranslations()[m_RootMotionBone] = m_RootMotionStartTranslation;
 }
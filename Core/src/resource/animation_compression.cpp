@@ -0,0 +1,436 @@
+#include "resource/animation_compression.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <numeric>
+
+#include "utils/logger.hpp"
+
+using namespace XnorCore;
+
+// Key indices are stored on 16 bits
+static constexpr size_t MaxSampleCount = 1 << 16;
+
+static constexpr uint64_t ComponentBits = 15;
+static constexpr uint64_t ComponentMax = (1 << ComponentBits) - 1;
+static constexpr float_t ComponentRange = std::numbers::sqrt2_v<float_t> * 0.5f;
+
+static constexpr float_t VectorMax = std::numeric_limits<uint16_t>::max();
+
+static Quaternion Interpolate(const Quaternion& value, const Quaternion& target, const float_t t)
+{
+    // q and -q are the same rotation, take the shortest path between them
+    return Quaternion::Slerp(value, Quaternion::Dot(value, target) < 0.f ? -target : target, t);
+}
+
+static float_t GetRotationError(const Quaternion& a, const Quaternion& b, const float_t errorDistance)
+{
+    // Distance travelled by a point at errorDistance from the bone, rotated by the angle between a and b.
+    // The angle is computed from the chord between the unit quaternions, acos of their dot product isn't precise enough for small angles.
+    const float_t chord = (Quaternion::Dot(a, b) < 0.f ? a + b : a - b).Length();
+    return 4.f * std::asin(std::min(chord * 0.5f, 1.f)) * errorDistance;
+}
+
+static float_t GetVectorError(const Vector3& a, const Vector3& b, const float_t errorScale)
+{
+    return (a - b).Length() * errorScale;
+}
+
+// Keeps the keys the others can't be interpolated from, greedily extending each segment while its error stays under the threshold
+template <typename T, typename InterpolateFunc, typename ErrorFunc>
+static void ReduceKeys(const std::vector<T>& samples, const std::vector<T>& quantized, const float_t maxError, InterpolateFunc&& interpolate, ErrorFunc&& getError, std::vector<uint16_t>* const keys)
+{
+    const size_t sampleCount = samples.size();
+
+    keys->clear();
+    keys->push_back(0);
+
+    const auto segmentFits = [&](const size_t start, const size_t end) -> bool_t
+    {
+        const float_t length = static_cast<float_t>(end - start);
+        for (size_t i = start + 1; i < end; i++)
+        {
+            const T value = interpolate(quantized[start], quantized[end], static_cast<float_t>(i - start) / length);
+            if (getError(value, samples[i]) > maxError)
+                return false;
+        }
+
+        return true;
+    };
+
+    size_t start = 0;
+    size_t end = 1;
+    while (end < sampleCount)
+    {
+        if (end + 1 < sampleCount && segmentFits(start, end + 1))
+        {
+            end++;
+            continue;
+        }
+
+        // The last key is always kept, it interpolates towards the first one
+        keys->push_back(static_cast<uint16_t>(end));
+        start = end;
+        end = start + 1;
+    }
+}
+
+// Finds the kept keys around a position, in source keys
+static void FindSegment(const uint16_t* const keys, const uint32_t keyCount, const uint32_t sampleCount, const float_t position, uint32_t* const first, uint32_t* const second, float_t* const t)
+{
+    // The first key is always kept, there is always one before the position
+    const uint16_t* const next = std::upper_bound(keys, keys + keyCount, position, [](const float_t value, const uint16_t key) -> bool_t { return value < static_cast<float_t>(key); });
+    *first = static_cast<uint32_t>(next - keys) - 1;
+
+    float_t nextPosition = static_cast<float_t>(sampleCount);
+    *second = 0;
+    if (*first + 1 < keyCount)
+    {
+        *second = *first + 1;
+        nextPosition = static_cast<float_t>(keys[*second]);
+    }
+
+    const float_t firstPosition = static_cast<float_t>(keys[*first]);
+    *t = (position - firstPosition) / (nextPosition - firstPosition);
+}
+
+// Position in source keys of a normalized time, looping at the end of the animation
+static float_t GetPosition(const float_t normalizedTime, const uint32_t sampleCount)
+{
+    float_t position = std::clamp(normalizedTime, 0.f, 1.f) * static_cast<float_t>(sampleCount);
+    if (position >= static_cast<float_t>(sampleCount))
+        position -= static_cast<float_t>(sampleCount);
+
+    return position;
+}
+
+QuantizedQuaternion QuantizedQuaternion::Quantize(const Quaternion& quaternion)
+{
+    // Drop the largest component, making it positive so that its sign doesn't have to be stored
+    uint64_t largest = 0;
+    for (uint64_t i = 1; i < 4; i++)
+    {
+        if (std::abs(quaternion[i]) > std::abs(quaternion[largest]))
+            largest = i;
+    }
+
+    const float_t sign = quaternion[largest] < 0.f ? -1.f : 1.f;
+
+    uint64_t bits = largest;
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        if (i == largest)
+            continue;
+
+        const float_t normalized = std::clamp((quaternion[i] * sign / ComponentRange) * 0.5f + 0.5f, 0.f, 1.f);
+        bits = (bits << ComponentBits) | static_cast<uint64_t>(std::lround(normalized * static_cast<float_t>(ComponentMax)));
+    }
+
+    QuantizedQuaternion result;
+    result.data[0] = static_cast<uint16_t>(bits >> 32);
+    result.data[1] = static_cast<uint16_t>(bits >> 16);
+    result.data[2] = static_cast<uint16_t>(bits);
+    return result;
+}
+
+Quaternion QuantizedQuaternion::Dequantize() const
+{
+    uint64_t bits = static_cast<uint64_t>(data[0]) << 32 | static_cast<uint64_t>(data[1]) << 16 | static_cast<uint64_t>(data[2]);
+    const uint64_t largest = bits >> ComponentBits * 3;
+
+    Quaternion result;
+    float_t squaredSum = 0.f;
+    for (uint64_t i = 4; i-- > 0;)
+    {
+        if (i == largest)
+            continue;
+
+        const float_t normalized = static_cast<float_t>(bits & ComponentMax) / static_cast<float_t>(ComponentMax);
+        result[i] = (normalized * 2.f - 1.f) * ComponentRange;
+        squaredSum += result[i] * result[i];
+        bits >>= ComponentBits;
+    }
+
+    result[largest] = std::sqrt(std::max(1.f - squaredSum, 0.f));
+    return result;
+}
+
+QuantizedVector3 QuantizedVector3::Quantize(const Vector3& vector, const Vector3& rangeMin, const Vector3& rangeExtent)
+{
+    QuantizedVector3 result;
+    for (size_t i = 0; i < 3; i++)
+    {
+        if (rangeExtent[i] <= 0.f)
+            continue;
+
+        const float_t normalized = std::clamp((vector[i] - rangeMin[i]) / rangeExtent[i], 0.f, 1.f);
+        result.data[i] = static_cast<uint16_t>(std::lround(normalized * VectorMax));
+    }
+
+    return result;
+}
+
+Vector3 QuantizedVector3::Dequantize(const Vector3& rangeMin, const Vector3& rangeExtent) const
+{
+    return Vector3(
+        rangeMin.x + static_cast<float_t>(data[0]) / VectorMax * rangeExtent.x,
+        rangeMin.y + static_cast<float_t>(data[1]) / VectorMax * rangeExtent.y,
+        rangeMin.z + static_cast<float_t>(data[2]) / VectorMax * rangeExtent.z
+    );
+}
+
+void CompressedAnimation::Compress(const std::vector<List<AnimationKeyFrame>>& tracks, const AnimationCompressionSettings& settings)
+{
+    m_Tracks.clear();
+    m_VectorKeyIndices.clear();
+    m_Vectors.clear();
+    m_RotationKeyIndices.clear();
+    m_Rotations.clear();
+
+    m_Tracks.resize(tracks.size());
+
+    std::vector<Vector3> translations;
+    std::vector<Quaternion> rotations;
+    std::vector<Vector3> scalings;
+    for (size_t i = 0; i < tracks.size(); i++)
+    {
+        const List<AnimationKeyFrame>& keyFrames = tracks[i];
+
+        size_t sampleCount = keyFrames.GetSize();
+        if (sampleCount > MaxSampleCount)
+        {
+            Logger::LogWarning("Animation track {} has {} keys, only the first {} are kept", i, sampleCount, MaxSampleCount);
+            sampleCount = MaxSampleCount;
+        }
+
+        CompressedTrack& track = m_Tracks[i];
+        track.sampleCount = static_cast<uint32_t>(sampleCount);
+        if (sampleCount == 0)
+            continue;
+
+        translations.resize(sampleCount);
+        rotations.resize(sampleCount);
+        scalings.resize(sampleCount);
+        for (size_t j = 0; j < sampleCount; j++)
+        {
+            translations[j] = keyFrames[j].translation;
+            rotations[j] = keyFrames[j].rotation.Normalized();
+            scalings[j] = keyFrames[j].scaling;
+        }
+
+        CompressVectors(translations, Vector3::Zero(), 1.f, settings, &track.translation);
+        CompressRotations(rotations, settings, &track.rotation);
+        CompressVectors(scalings, Vector3(1.f), settings.errorDistance, settings, &track.scaling);
+    }
+
+    m_VectorKeyIndices.shrink_to_fit();
+    m_Vectors.shrink_to_fit();
+    m_RotationKeyIndices.shrink_to_fit();
+    m_Rotations.shrink_to_fit();
+}
+
+void CompressedAnimation::Sample(const size_t track, const float_t normalizedTime, Vector3* const translation, Quaternion* const rotation, Vector3* const scaling) const
+{
+    const CompressedTrack& compressedTrack = m_Tracks[track];
+    const float_t position = GetPosition(normalizedTime, compressedTrack.sampleCount);
+
+    *translation = SampleVector(compressedTrack.translation, compressedTrack.sampleCount, position, Vector3::Zero());
+    *rotation = SampleRotation(compressedTrack.rotation, compressedTrack.sampleCount, position);
+    *scaling = SampleVector(compressedTrack.scaling, compressedTrack.sampleCount, position, Vector3(1.f));
+}
+
+AnimationKeyFrame CompressedAnimation::Sample(const List<AnimationKeyFrame>& keyFrames, const float_t normalizedTime)
+{
+    if (keyFrames.Empty())
+        return {};
+
+    const size_t sampleCount = keyFrames.GetSize();
+    const float_t position = GetPosition(normalizedTime, static_cast<uint32_t>(sampleCount));
+
+    const size_t frame = std::min(static_cast<size_t>(position), sampleCount - 1);
+    const size_t nextFrame = (frame + 1) % sampleCount;
+    const float_t t = position - static_cast<float_t>(frame);
+
+    return
+    {
+        .translation = Vector3::Lerp(keyFrames[frame].translation, keyFrames[nextFrame].translation, t),
+        .rotation = Interpolate(keyFrames[frame].rotation, keyFrames[nextFrame].rotation, t),
+        .scaling = Vector3::Lerp(keyFrames[frame].scaling, keyFrames[nextFrame].scaling, t),
+        .time = position
+    };
+}
+
+size_t CompressedAnimation::GetTrackCount() const
+{
+    return m_Tracks.size();
+}
+
+size_t CompressedAnimation::GetKeyCount() const
+{
+    return m_Vectors.size() + m_Rotations.size();
+}
+
+size_t CompressedAnimation::GetMemorySize() const
+{
+    return m_Tracks.size() * sizeof(CompressedTrack)
+        + m_VectorKeyIndices.size() * sizeof(uint16_t) + m_Vectors.size() * sizeof(QuantizedVector3)
+        + m_RotationKeyIndices.size() * sizeof(uint16_t) + m_Rotations.size() * sizeof(QuantizedQuaternion);
+}
+
+void CompressedAnimation::CompressVectors(
+    const std::vector<Vector3>& samples,
+    const Vector3& defaultValue,
+    const float_t errorScale,
+    const AnimationCompressionSettings& settings,
+    CompressedChannel* const channel
+)
+{
+    channel->firstKey = static_cast<uint32_t>(m_Vectors.size());
+
+    // Stripped, the sampling gives back the default value
+    if (std::ranges::all_of(samples, [&](const Vector3& sample) -> bool_t { return GetVectorError(sample, defaultValue, errorScale) <= settings.maxError; }))
+    {
+        channel->keyCount = 0;
+        return;
+    }
+
+    Vector3 min = samples[0];
+    Vector3 max = samples[0];
+    for (const Vector3& sample : samples)
+    {
+        min = Vector3(std::min(min.x, sample.x), std::min(min.y, sample.y), std::min(min.z, sample.z));
+        max = Vector3(std::max(max.x, sample.x), std::max(max.y, sample.y), std::max(max.z, sample.z));
+    }
+
+    // Constant, a single key at the center of the range
+    if (GetVectorError(max, min, errorScale) * 0.5f <= settings.maxError)
+    {
+        channel->keyCount = 1;
+        channel->rangeMin = (min + max) * 0.5f;
+        channel->rangeExtent = Vector3::Zero();
+        m_VectorKeyIndices.push_back(0);
+        m_Vectors.emplace_back();
+        return;
+    }
+
+    channel->rangeMin = min;
+    channel->rangeExtent = max - min;
+
+    std::vector<QuantizedVector3> quantized(samples.size());
+    std::vector<Vector3> dequantized(samples.size());
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        quantized[i] = QuantizedVector3::Quantize(samples[i], channel->rangeMin, channel->rangeExtent);
+        dequantized[i] = quantized[i].Dequantize(channel->rangeMin, channel->rangeExtent);
+    }
+
+    std::vector<uint16_t> keys;
+    if (settings.reduceKeys)
+    {
+        ReduceKeys(
+            samples,
+            dequantized,
+            settings.maxError,
+            [](const Vector3& value, const Vector3& target, const float_t t) -> Vector3 { return Vector3::Lerp(value, target, t); },
+            [&](const Vector3& a, const Vector3& b) -> float_t { return GetVectorError(a, b, errorScale); },
+            &keys
+        );
+    }
+    else
+    {
+        keys.resize(samples.size());
+        std::iota(keys.begin(), keys.end(), static_cast<uint16_t>(0));
+    }
+
+    channel->keyCount = static_cast<uint32_t>(keys.size());
+    for (const uint16_t key : keys)
+    {
+        m_VectorKeyIndices.push_back(key);
+        m_Vectors.push_back(quantized[key]);
+    }
+}
+
+void CompressedAnimation::CompressRotations(const std::vector<Quaternion>& samples, const AnimationCompressionSettings& settings, CompressedChannel* const channel)
+{
+    channel->firstKey = static_cast<uint32_t>(m_Rotations.size());
+
+    const auto getError = [&](const Quaternion& a, const Quaternion& b) -> float_t { return GetRotationError(a, b, settings.errorDistance); };
+
+    if (std::ranges::all_of(samples, [&](const Quaternion& sample) -> bool_t { return getError(sample, Quaternion::Identity()) <= settings.maxError; }))
+    {
+        channel->keyCount = 0;
+        return;
+    }
+
+    std::vector<QuantizedQuaternion> quantized(samples.size());
+    std::vector<Quaternion> dequantized(samples.size());
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        quantized[i] = QuantizedQuaternion::Quantize(samples[i]);
+        dequantized[i] = quantized[i].Dequantize();
+    }
+
+    if (std::ranges::all_of(samples, [&](const Quaternion& sample) -> bool_t { return getError(sample, dequantized[0]) <= settings.maxError; }))
+    {
+        channel->keyCount = 1;
+        m_RotationKeyIndices.push_back(0);
+        m_Rotations.push_back(quantized[0]);
+        return;
+    }
+
+    std::vector<uint16_t> keys;
+    if (settings.reduceKeys)
+    {
+        ReduceKeys(samples, dequantized, settings.maxError, Interpolate, getError, &keys);
+    }
+    else
+    {
+        keys.resize(samples.size());
+        std::iota(keys.begin(), keys.end(), static_cast<uint16_t>(0));
+    }
+
+    channel->keyCount = static_cast<uint32_t>(keys.size());
+    for (const uint16_t key : keys)
+    {
+        m_RotationKeyIndices.push_back(key);
+        m_Rotations.push_back(quantized[key]);
+    }
+}
+
+Vector3 CompressedAnimation::SampleVector(const CompressedChannel& channel, const uint32_t sampleCount, const float_t position, const Vector3& defaultValue) const
+{
+    if (channel.keyCount == 0)
+        return defaultValue;
+
+    if (channel.keyCount == 1)
+        return m_Vectors[channel.firstKey].Dequantize(channel.rangeMin, channel.rangeExtent);
+
+    uint32_t first = 0;
+    uint32_t second = 0;
+    float_t t = 0.f;
+    FindSegment(&m_VectorKeyIndices[channel.firstKey], channel.keyCount, sampleCount, position, &first, &second, &t);
+
+    return Vector3::Lerp(
+        m_Vectors[channel.firstKey + first].Dequantize(channel.rangeMin, channel.rangeExtent),
+        m_Vectors[channel.firstKey + second].Dequantize(channel.rangeMin, channel.rangeExtent),
+        t
+    );
+}
+
+Quaternion CompressedAnimation::SampleRotation(const CompressedChannel& channel, const uint32_t sampleCount, const float_t position) const
+{
+    if (channel.keyCount == 0)
+        return Quaternion::Identity();
+
+    if (channel.keyCount == 1)
+        return m_Rotations[channel.firstKey].Dequantize();
+
+    uint32_t first = 0;
+    uint32_t second = 0;
+    float_t t = 0.f;
+    FindSegment(&m_RotationKeyIndices[channel.firstKey], channel.keyCount, sampleCount, position, &first, &second, &t);
+
+    return Interpolate(m_Rotations[channel.firstKey + first].Dequantize(), m_Rotations[channel.firstKey + second].Dequantize(), t);
+}
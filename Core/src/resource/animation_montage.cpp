@@ -1,12 +1,13 @@
 ﻿#include "resource/animation_montage.hpp"
+#include "input/time.hpp"
 #include "scene/component/skinned_mesh_renderer.hpp"
 
 using namespace XnorCore;
 
 void AnimationMontage::Start()
 {
-    m_NotifiesTimeline.Start();
     m_AnimationTimeline.Start();
+    m_Events.Seek(m_AnimationTimeline.GetTime());
     m_Ended = false;
 }
 
@@ -14,19 +15,22 @@ void AnimationMontage::Update(SkinnedMeshRenderer* renderer)
 {
     if (!m_Ended)
     {
-        m_NotifiesTimeline.Update();
+        // The events stop at the end like the animations, and restart from the time the timeline restarts from
+        m_Events.Advance(Time::GetDeltaTime(), false);
         m_Ended = m_AnimationTimeline.Update(std::forward<SkinnedMeshRenderer*>(renderer));
 
         if (m_Ended && looping)
         {
-            Start();            
+            m_AnimationTimeline.Start();
+            m_Events.Seek(m_AnimationTimeline.GetTime());
+            m_Ended = false;
         }
     }
 }
 
 void AnimationMontage::AddEvent(const float_t when, const FunctionT& function)
 {
-    m_NotifiesTimeline.AddBeginEvent(when, function);
+    m_Events.Add(when, function);
 }
 
 void AnimationMontage::AddAnimation(const float_t when, const size_t animationId)
@@ -102,5 +106,5 @@ bool_t AnimationMontage::HasEnded() const
 void AnimationMontage::UpdateTimelineDuration(const float_t duration)
 {
     m_AnimationTimeline.SetDuration(m_AnimationTimeline.GetDuration() + duration);
-    m_NotifiesTimeline.SetDuration(m_NotifiesTimeline.GetDuration() + duration);
+    m_Events.SetDuration(m_Events.GetDuration() + duration);
 }
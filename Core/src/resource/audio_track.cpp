@@ -40,7 +40,7 @@ void AudioTrack::DestroyInInterface()
 
 void AudioTrack::Unload()
 {
-    // The data was new-ed by the File wrapper, so we don't need to delete it here
+    // The data is owned by the File wrapper, so we don't need to delete it here
     m_Data = nullptr;
     m_DataSize = 0;
     m_Channels = 0;
@@ -50,6 +50,17 @@ void AudioTrack::Unload()
     m_Loaded = false;
 }
 
+size_t AudioTrack::GetInterfaceMemorySize() const
+{
+    return static_cast<size_t>(m_DataSize);
+}
+
+ResourceCategory::ResourceCategory AudioTrack::GetMemoryCategory() const
+{
+    // The data is owned by the File, so GetMemorySize doesn't need to be overridden
+    return ResourceCategory::AudioTracks;
+}
+
 int32_t AudioTrack::GetDataSize() const
 {
     return m_DataSize;
@@ -83,6 +83,41 @@ void ComputeShader::SetMat4(const std::string& keyName, const Matrix& value) con
     Rhi::SetUniform(UniformType::Mat4, &value, m_Id, keyName.c_str());
 }
 
+void ComputeShader::SetInt(const UniformHandle<int32_t>& handle, const int32_t value) const
+{
+    Rhi::SetUniform(UniformType::Int, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
+void ComputeShader::SetBool(const UniformHandle<bool_t>& handle, const bool_t value) const
+{
+    Rhi::SetUniform(UniformType::Bool, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
+void ComputeShader::SetFloat(const UniformHandle<float_t>& handle, const float_t value) const
+{
+    Rhi::SetUniform(UniformType::Float, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
+void ComputeShader::SetVec2(const UniformHandle<Vector2>& handle, const Vector2& value) const
+{
+    Rhi::SetUniform(UniformType::Vec2, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
+void ComputeShader::SetVec3(const UniformHandle<Vector3>& handle, const Vector3& value) const
+{
+    Rhi::SetUniform(UniformType::Vec3, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
+void ComputeShader::SetVec4(const UniformHandle<Vector4>& handle, const Vector4& value) const
+{
+    Rhi::SetUniform(UniformType::Vec4, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
+void ComputeShader::SetMat4(const UniformHandle<Matrix>& handle, const Matrix& value) const
+{
+    Rhi::SetUniform(UniformType::Mat4, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
 uint32_t ComputeShader::GetId() const
 {
    return m_Id;
@@ -0,0 +1,367 @@
+#include "resource/derived_data_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <format>
+#include <fstream>
+
+#include "utils/formatter.hpp"
+#include "utils/logger.hpp"
+
+using namespace XnorCore;
+
+// Header found at the start of every cached artifact
+struct DerivedDataHeader
+{
+    std::array<char_t, 4> magic;
+    uint32_t formatVersion;
+    // Hash of the key string, guards against artifacts being renamed
+    uint64_t keyHash;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+static constexpr std::array<char_t, 4> DerivedDataMagic { 'X', 'D', 'D', 'C' };
+static constexpr uint32_t DerivedDataFormatVersion = 1;
+
+static constexpr uint64_t HashPrime1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t HashPrime2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr uint64_t HashPrime3 = 0x165667B19E3779F9ull;
+
+static uint64_t RotateLeft(const uint64_t value, const int32_t amount)
+{
+    return (value << amount) | (value >> (64 - amount));
+}
+
+static bool_t IsArtifact(const std::filesystem::directory_entry& entry)
+{
+    return entry.is_regular_file() && entry.path().extension() == DerivedDataCache::FileExtension;
+}
+
+std::string DerivedDataCache::GetKeyString(const DerivedDataKey& key)
+{
+    return std::format("{}_{}_{:016x}_{:016x}", key.importer, key.version, key.sourceHash, key.settingsHash);
+}
+
+uint64_t DerivedDataCache::Hash(const void* const data, size_t size, const uint64_t seed)
+{
+    // Processes 8 bytes at a time as hashing large source assets must stay much cheaper than importing them
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed + HashPrime3 + size * HashPrime1;
+
+    while (size >= sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+
+        hash ^= RotateLeft(word * HashPrime2, 31) * HashPrime1;
+        hash = RotateLeft(hash, 27) * HashPrime1 + HashPrime3;
+
+        bytes += sizeof(uint64_t);
+        size -= sizeof(uint64_t);
+    }
+
+    while (size > 0)
+    {
+        hash ^= *bytes++ * HashPrime3;
+        hash = RotateLeft(hash, 11) * HashPrime1;
+        size--;
+    }
+
+    // Final avalanche
+    hash ^= hash >> 33;
+    hash *= HashPrime2;
+    hash ^= hash >> 29;
+    hash *= HashPrime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+bool_t DerivedDataCache::Get(const DerivedDataKey& key, std::vector<uint8_t>* const data, const DerivedDataPartition* const partition)
+{
+    if (!enabled)
+        return false;
+
+    const std::filesystem::path path = GetPath(key, partition);
+
+    std::ifstream file(path, std::ios::in | std::ios::ate | std::ios::binary);
+    if (!file.is_open() || !file.good())
+    {
+        std::scoped_lock lock(m_Mutex);
+        m_Stats.misses++;
+        return false;
+    }
+
+    const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    DerivedDataHeader header {};
+    bool_t valid = fileSize >= sizeof(header);
+
+    if (valid)
+    {
+        const std::string keyString = GetKeyString(key);
+        file.read(reinterpret_cast<char_t*>(&header), sizeof(header));
+        valid = header.magic == DerivedDataMagic
+            && header.formatVersion == DerivedDataFormatVersion
+            && header.keyHash == Hash(keyString.data(), keyString.size())
+            && header.size == fileSize - sizeof(header);
+    }
+
+    if (valid)
+    {
+        data->resize(header.size);
+        file.read(reinterpret_cast<char_t*>(data->data()), static_cast<std::streamsize>(header.size));
+        valid = file.good() && Hash(data->data(), data->size()) == header.checksum;
+    }
+
+    file.close();
+
+    if (!valid)
+    {
+        Logger::LogWarning("Corrupted derived data {}, removing it", path);
+
+        data->clear();
+        std::error_code error;
+        std::filesystem::remove(path, error);
+
+        std::scoped_lock lock(m_Mutex);
+        m_Stats.corruptions++;
+        m_Stats.misses++;
+        RemoveSize(GetDirectory(partition), fileSize);
+        return false;
+    }
+
+    // Touch the artifact so that the least recently used ones are removed first
+    std::error_code error;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+
+    std::scoped_lock lock(m_Mutex);
+    m_Stats.hits++;
+    return true;
+}
+
+bool_t DerivedDataCache::Put(const DerivedDataKey& key, const uint8_t* const data, const size_t size, const DerivedDataPartition* const partition)
+{
+    if (!enabled)
+        return false;
+
+    const std::filesystem::path artifactDirectory = GetDirectory(partition);
+
+    std::error_code error;
+    std::filesystem::create_directories(artifactDirectory, error);
+
+    const std::filesystem::path path = GetPath(key, partition);
+
+    // Write to a temporary file first so that other threads and processes never see a partially written artifact
+    std::filesystem::path temporaryPath = path;
+    temporaryPath += std::format(".{}.tmp", m_TemporaryFileCounter++);
+
+    const std::string keyString = GetKeyString(key);
+    const DerivedDataHeader header
+    {
+        .magic = DerivedDataMagic,
+        .formatVersion = DerivedDataFormatVersion,
+        .keyHash = Hash(keyString.data(), keyString.size()),
+        .size = size,
+        .checksum = Hash(data, size)
+    };
+
+    {
+        std::ofstream file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open() || !file.good())
+        {
+            Logger::LogError("Couldn't open derived data file for writing: {}", temporaryPath);
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char_t*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char_t*>(data), static_cast<std::streamsize>(size));
+
+        if (!file.good())
+        {
+            Logger::LogError("An error occured while writing derived data file {}", temporaryPath);
+            file.close();
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+    }
+
+    std::scoped_lock lock(m_Mutex);
+
+    size_t& directorySize = GetSize(artifactDirectory);
+
+    const uintmax_t oldSize = std::filesystem::file_size(path, error);
+    const bool_t replaced = !error;
+
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error)
+    {
+        Logger::LogError("Couldn't move derived data file {} to {}: {}", temporaryPath, path, error.message());
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+
+    if (replaced)
+        directorySize -= std::min<size_t>(directorySize, oldSize);
+    directorySize += sizeof(header) + size;
+    m_Stats.writes++;
+
+    const size_t maxArtifactSize = partition ? partition->maxSize : maxSize;
+    if (directorySize > maxArtifactSize)
+        Trim(artifactDirectory, maxArtifactSize);
+
+    return true;
+}
+
+void DerivedDataCache::Remove(const DerivedDataKey& key, const DerivedDataPartition* const partition)
+{
+    const std::filesystem::path path = GetPath(key, partition);
+
+    std::scoped_lock lock(m_Mutex);
+
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(path, error);
+    if (error)
+        return;
+
+    if (std::filesystem::remove(path, error))
+        RemoveSize(GetDirectory(partition), size);
+}
+
+void DerivedDataCache::Clear()
+{
+    Logger::LogInfo("Clearing derived data cache {}", directory);
+
+    std::scoped_lock lock(m_Mutex);
+
+    std::error_code error;
+    if (std::filesystem::is_directory(directory, error))
+    {
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error))
+        {
+            if (IsArtifact(entry))
+            {
+                std::filesystem::remove(entry.path(), error);
+                continue;
+            }
+
+            // Partitions
+            if (!entry.is_directory(error))
+                continue;
+
+            for (const std::filesystem::directory_entry& partitionEntry : std::filesystem::directory_iterator(entry.path(), error))
+            {
+                if (IsArtifact(partitionEntry))
+                    std::filesystem::remove(partitionEntry.path(), error);
+            }
+        }
+    }
+
+    // The sizes of the partitions are computed again when they are next used
+    m_Sizes.clear();
+    m_Sizes[directory] = 0;
+}
+
+DerivedDataCacheStats DerivedDataCache::GetStats()
+{
+    std::scoped_lock lock(m_Mutex);
+
+    m_Stats.size = GetSize(directory);
+
+    std::error_code error;
+    if (std::filesystem::is_directory(directory, error))
+    {
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error))
+        {
+            if (entry.is_directory(error))
+                m_Stats.size += GetSize(entry.path());
+        }
+    }
+
+    return m_Stats;
+}
+
+void DerivedDataCache::ResetStats()
+{
+    std::scoped_lock lock(m_Mutex);
+
+    m_Stats = {};
+}
+
+std::filesystem::path DerivedDataCache::GetDirectory(const DerivedDataPartition* const partition)
+{
+    return partition ? directory / partition->name : directory;
+}
+
+std::filesystem::path DerivedDataCache::GetPath(const DerivedDataKey& key, const DerivedDataPartition* const partition)
+{
+    return GetDirectory(partition) / (GetKeyString(key) + FileExtension);
+}
+
+size_t& DerivedDataCache::GetSize(const std::filesystem::path& artifactDirectory)
+{
+    // The directory can be changed at any time, e.g. by tests, so the sizes are kept by path
+    const decltype(m_Sizes)::iterator it = m_Sizes.find(artifactDirectory);
+    if (it != m_Sizes.end())
+        return it->second;
+
+    size_t size = 0;
+
+    std::error_code error;
+    if (std::filesystem::is_directory(artifactDirectory, error))
+    {
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(artifactDirectory, error))
+        {
+            if (IsArtifact(entry))
+                size += entry.file_size(error);
+        }
+    }
+
+    return m_Sizes.emplace(artifactDirectory, size).first->second;
+}
+
+void DerivedDataCache::RemoveSize(const std::filesystem::path& artifactDirectory, const size_t artifactSize)
+{
+    const decltype(m_Sizes)::iterator it = m_Sizes.find(artifactDirectory);
+    if (it != m_Sizes.end())
+        it->second -= std::min(it->second, artifactSize);
+}
+
+void DerivedDataCache::Trim(const std::filesystem::path& artifactDirectory, const size_t maxArtifactSize)
+{
+    struct Artifact
+    {
+        std::filesystem::path path;
+        uintmax_t size;
+        std::filesystem::file_time_type lastUse;
+    };
+
+    std::vector<Artifact> artifacts;
+
+    std::error_code error;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(artifactDirectory, error))
+    {
+        if (IsArtifact(entry))
+            artifacts.emplace_back(entry.path(), entry.file_size(error), entry.last_write_time(error));
+    }
+
+    std::ranges::sort(artifacts, [](const Artifact& lhs, const Artifact& rhs) -> bool_t { return lhs.lastUse < rhs.lastUse; });
+
+    size_t& size = GetSize(artifactDirectory);
+    for (const Artifact& artifact : artifacts)
+    {
+        if (size <= maxArtifactSize)
+            break;
+
+        if (!std::filesystem::remove(artifact.path, error))
+            continue;
+
+        size -= std::min<size_t>(size, artifact.size);
+        m_Stats.evictions++;
+    }
+
+    Logger::LogDebug("Trimmed derived data cache {} to {} bytes", artifactDirectory, size);
+}
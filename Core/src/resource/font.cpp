@@ -1,5 +1,7 @@
 #include "resource/font.hpp"
 
+#include <ranges>
+
 #include "utils/logger.hpp"
 
 #include <ft2build.h>
@@ -27,11 +29,12 @@ void Font::CreateInInterface()
         return;
     }
 
+    // Use the already loaded File data instead of opening the file again, which also works for memory mapped and archived files
     FT_Face face = nullptr;
-    const std::string stringPath = m_File->GetPath().generic_string();
-    if (FT_New_Face(ft, stringPath.c_str(), 0, &face))
+    if (FT_New_Memory_Face(ft, m_File->GetData<FT_Byte>(), static_cast<FT_Long>(m_File->GetSize()), 0, &face))
     {
         Logger::LogError("Error freetype : Failed to load font");
+        FT_Done_FreeType(ft);
         return;
     }
 
@@ -87,9 +90,28 @@ void Font::DestroyInInterface()
         delete it->second.texture;
     }
 
+    // Clear the glyphs so that they can be created again by a subsequent CreateInInterface
+    m_Characters.clear();
+
     m_LoadedInInterface = false;
 }
 
+size_t Font::GetInterfaceMemorySize() const
+{
+    size_t size = 0;
+
+    // Glyphs are stored as single channel 8-bit textures
+    for (const Character& character : m_Characters | std::views::values)
+        size += static_cast<size_t>(character.size.x) * static_cast<size_t>(character.size.y);
+
+    return size;
+}
+
+ResourceCategory::ResourceCategory Font::GetMemoryCategory() const
+{
+    return ResourceCategory::Fonts;
+}
+
 const Font::Character& Font::GetGlyphByChar(const char_t characters) const 
 {
     return m_Characters.at(characters);
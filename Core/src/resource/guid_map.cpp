@@ -0,0 +1,368 @@
+#include "resource/guid_map.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+#include "utils/formatter.hpp"
+#include "utils/logger.hpp"
+
+using namespace XnorCore;
+
+static_assert(sizeof(GuidMapHeader) == 16, "The GuidMapHeader layout must not depend on the platform");
+static_assert(sizeof(Guid) == 16, "Guids are stored as raw bytes in GuidMap files");
+
+// Entry of the map, viewing the name stored by the map
+struct GuidEntry
+{
+    Guid guid;
+    std::string_view name;
+};
+
+static void WriteRecord(std::ofstream& file, const Guid& guid, const std::string& name)
+{
+    const uint32_t length = static_cast<uint32_t>(name.size());
+
+    file.write(reinterpret_cast<const char_t*>(&guid), sizeof(guid));
+    file.write(reinterpret_cast<const char_t*>(&length), sizeof(length));
+    file.write(name.data(), static_cast<std::streamsize>(length));
+}
+
+bool_t GuidMap::Load(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::ate | std::ios::binary);
+    if (!file.is_open() || !file.good())
+    {
+        Logger::LogError("Couldn't open GUID map file {}", path);
+        return false;
+    }
+
+    const uintmax_t size = static_cast<uintmax_t>(file.tellg());
+    file.seekg(0);
+
+    std::vector<uint8_t> data(size);
+    file.read(reinterpret_cast<char_t*>(data.data()), static_cast<std::streamsize>(size));
+    file.close();
+
+    if (!Load(data.data(), data.size()))
+    {
+        Logger::LogError("Invalid GUID map file {}", path);
+        return false;
+    }
+
+    m_FilePath = path;
+    m_FileSize = size;
+
+    return true;
+}
+
+bool_t GuidMap::Load(const uint8_t* const data, const size_t size)
+{
+    Clear();
+
+    GuidMapHeader header;
+    if (size < sizeof(header))
+        return false;
+
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != Magic || header.version != Version)
+        return false;
+
+    Reserve(header.entryCount);
+
+    bool_t duplicates = false;
+    size_t offset = sizeof(header);
+    for (uint32_t i = 0; i < header.entryCount; i++)
+    {
+        Guid guid;
+        uint32_t length;
+
+        if (size - offset < sizeof(guid) + sizeof(length))
+        {
+            Clear();
+            return false;
+        }
+
+        std::memcpy(&guid, data + offset, sizeof(guid));
+        offset += sizeof(guid);
+        std::memcpy(&length, data + offset, sizeof(length));
+        offset += sizeof(length);
+
+        if (size - offset < length)
+        {
+            Clear();
+            return false;
+        }
+
+        std::string name(reinterpret_cast<const char_t*>(data + offset), length);
+        offset += length;
+
+        // Files are never written with duplicates, but if a file was edited by hand the last record wins
+        if (m_Names.contains(guid) || m_Guids.contains(name))
+        {
+            Add(guid, name);
+            duplicates = true;
+            continue;
+        }
+
+        AddNoCheck(guid, std::move(name));
+    }
+
+    m_AddedEntries.clear();
+    m_RequiresRewrite = duplicates;
+
+    return true;
+}
+
+bool_t GuidMap::LoadText(const std::string_view text)
+{
+    Clear();
+
+    // Each entry is about 64 characters long
+    Reserve(text.size() / 64);
+
+    bool_t valid = true;
+
+    size_t lineStart = 0;
+    while (lineStart < text.size())
+    {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos)
+            lineEnd = text.size();
+
+        std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+
+        if (line.empty())
+            continue;
+
+        const size_t separator = line.find_last_of(';');
+        if (separator == std::string_view::npos)
+        {
+            valid = false;
+            continue;
+        }
+
+        const Guid guid = Guid::FromString(line.substr(separator + 1));
+        if (guid == Guid::Empty())
+        {
+            valid = false;
+            continue;
+        }
+
+        Add(guid, std::string(line.substr(0, separator)));
+    }
+
+    m_AddedEntries.clear();
+    m_RequiresRewrite = true;
+
+    return valid;
+}
+
+bool_t GuidMap::Save(const std::filesystem::path& path)
+{
+    std::error_code error;
+    const bool_t sameFile = !m_FilePath.empty() && std::filesystem::equivalent(path, m_FilePath, error);
+
+    // Appending is only valid if nothing else modified the file since we last used it
+    if (!m_RequiresRewrite && sameFile && std::filesystem::file_size(path, error) == m_FileSize && !error)
+    {
+        if (m_AddedEntries.empty())
+            return true;
+
+        if (Append(path))
+            return true;
+    }
+
+    return Rewrite(path);
+}
+
+bool_t GuidMap::ConvertText(const std::filesystem::path& textPath, const std::filesystem::path& binaryPath)
+{
+    Logger::LogInfo("Converting GUID map {} to {}", textPath, binaryPath);
+
+    std::ifstream file(textPath, std::ios::in | std::ios::binary);
+    if (!file.is_open() || !file.good())
+    {
+        Logger::LogError("Couldn't open GUID map file {}", textPath);
+        return false;
+    }
+
+    const std::string text((std::istreambuf_iterator(file)), std::istreambuf_iterator<char_t>());
+    file.close();
+
+    GuidMap map;
+    if (!map.LoadText(text))
+        Logger::LogWarning("Some entries of the GUID map file {} are invalid and were skipped", textPath);
+
+    return map.Save(binaryPath);
+}
+
+void GuidMap::Add(const Guid& guid, const std::string& name)
+{
+    const auto&& existingGuid = m_Guids.find(name);
+    if (existingGuid != m_Guids.end())
+    {
+        if (existingGuid->second == guid)
+            return;
+
+        // Copy the Guid as Remove destroys the node it is stored in
+        const Guid otherGuid = existingGuid->second;
+        Remove(otherGuid);
+    }
+
+    const auto&& existingName = m_Names.find(guid);
+    if (existingName != m_Names.end())
+    {
+        // Rename the entry, the view stored in m_Guids must be updated as well
+        m_Guids.erase(existingName->second);
+        existingName->second = name;
+        m_Guids.emplace(existingName->second, guid);
+        m_RequiresRewrite = true;
+        return;
+    }
+
+    AddNoCheck(guid, std::string(name));
+    m_AddedEntries.push_back(guid);
+}
+
+bool_t GuidMap::Remove(const Guid& guid)
+{
+    const auto&& it = m_Names.find(guid);
+    if (it == m_Names.end())
+        return false;
+
+    m_Guids.erase(it->second);
+    m_Names.erase(it);
+    m_RequiresRewrite = true;
+
+    return true;
+}
+
+void GuidMap::Clear()
+{
+    m_Guids.clear();
+    m_Names.clear();
+    m_AddedEntries.clear();
+    m_FilePath.clear();
+    m_FileSize = 0;
+    m_RequiresRewrite = true;
+}
+
+void GuidMap::Reserve(const size_t count)
+{
+    m_Names.reserve(count);
+    m_Guids.reserve(count);
+}
+
+const std::string* GuidMap::Find(const Guid& guid) const
+{
+    const auto&& it = m_Names.find(guid);
+    return it == m_Names.end() ? nullptr : &it->second;
+}
+
+Guid GuidMap::Find(const std::string_view name) const
+{
+    const auto&& it = m_Guids.find(name);
+    return it == m_Guids.end() ? Guid::Empty() : it->second;
+}
+
+bool_t GuidMap::Contains(const Guid& guid) const
+{
+    return m_Names.contains(guid);
+}
+
+bool_t GuidMap::Contains(const std::string_view name) const
+{
+    return m_Guids.contains(name);
+}
+
+size_t GuidMap::GetCount() const
+{
+    return m_Names.size();
+}
+
+const std::unordered_map<Guid, std::string>& GuidMap::GetEntries() const
+{
+    return m_Names;
+}
+
+void GuidMap::AddNoCheck(const Guid& guid, std::string&& name)
+{
+    const auto&& it = m_Names.emplace(guid, std::move(name)).first;
+    m_Guids.emplace(it->second, guid);
+}
+
+bool_t GuidMap::Rewrite(const std::filesystem::path& path)
+{
+    // Sort the entries so that saving the same map twice results in the same file
+    std::vector<GuidEntry> entries;
+    entries.reserve(m_Guids.size());
+    for (const auto& [name, guid] : m_Guids)
+        entries.push_back({ .guid = guid, .name = name });
+    std::ranges::sort(entries, [](const GuidEntry& lhs, const GuidEntry& rhs) -> bool_t { return lhs.name < rhs.name; });
+
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open() || !file.good())
+    {
+        Logger::LogError("Couldn't open GUID map file for writing: {}", path);
+        return false;
+    }
+
+    const GuidMapHeader header
+    {
+        .magic = Magic,
+        .version = Version,
+        .entryCount = static_cast<uint32_t>(entries.size())
+    };
+    file.write(reinterpret_cast<const char_t*>(&header), sizeof(header));
+
+    for (const GuidEntry& entry : entries)
+        WriteRecord(file, entry.guid, m_Names.at(entry.guid));
+
+    if (!file.good())
+    {
+        Logger::LogError("An error occured while writing GUID map file {}", path);
+        return false;
+    }
+
+    m_FilePath = path;
+    m_FileSize = static_cast<uintmax_t>(file.tellp());
+    m_AddedEntries.clear();
+    m_RequiresRewrite = false;
+
+    return true;
+}
+
+bool_t GuidMap::Append(const std::filesystem::path& path)
+{
+    std::ofstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file.is_open() || !file.good())
+        return false;
+
+    file.seekp(0, std::ios::end);
+    for (const Guid& guid : m_AddedEntries)
+        WriteRecord(file, guid, m_Names.at(guid));
+
+    const uintmax_t size = static_cast<uintmax_t>(file.tellp());
+
+    // Only update the entry count once every record was written, so that an interrupted append leaves a valid file
+    const uint32_t entryCount = static_cast<uint32_t>(m_Names.size());
+    file.seekp(offsetof(GuidMapHeader, entryCount));
+    file.write(reinterpret_cast<const char_t*>(&entryCount), sizeof(entryCount));
+
+    if (!file.good())
+    {
+        Logger::LogWarning("Couldn't append to GUID map file {}, rewriting it", path);
+        return false;
+    }
+
+    m_FileSize = size;
+    m_AddedEntries.clear();
+
+    return true;
+}
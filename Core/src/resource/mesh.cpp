@@ -1,5 +1,7 @@
 #include "resource/mesh.hpp"
 
+#include <cstring>
+
 #include "assimp/Importer.hpp"
 #include "assimp/postprocess.h"
 #include "resource/resource_manager.hpp"
@@ -7,6 +9,29 @@
 
 using namespace XnorCore;
 
+static constexpr uint32_t ImportFlags = aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_FixInfacingNormals | aiProcess_CalcTangentSpace | aiProcess_PopulateArmatureData;
+
+template <typename T>
+static void Write(std::vector<uint8_t>& data, const T* const values, const size_t count)
+{
+    const size_t offset = data.size();
+    data.resize(offset + sizeof(T) * count);
+    if (count != 0)
+        std::memcpy(data.data() + offset, values, sizeof(T) * count);
+}
+
+template <typename T>
+static bool_t Read(const std::vector<uint8_t>& data, size_t* const offset, T* const values, const size_t count)
+{
+    if (count > (data.size() - *offset) / sizeof(T))
+        return false;
+
+    if (count != 0)
+        std::memcpy(values, data.data() + *offset, sizeof(T) * count);
+    *offset += sizeof(T) * count;
+    return true;
+}
+
 Mesh::~Mesh()
 {
     models.Clear();
@@ -14,80 +39,104 @@ Mesh::~Mesh()
 
 bool_t Mesh::Load(const uint8_t* buffer, const int64_t length)
 {
-    Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFileFromMemory(buffer, length, aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_FixInfacingNormals | aiProcess_CalcTangentSpace | aiProcess_PopulateArmatureData);
-    const std::string folderPath = m_File->GetPathNoExtension() + '\\';
+    return Decode(buffer, length) && FinishDecode();
+}
+
+bool_t Mesh::Decode(const uint8_t* const buffer, const int64_t length)
+{
+    ClearDecoded();
 
-    if (!scene)
+    // The vertex layout is part of the settings as the Models are cached as is
+    m_DecodedCacheKey = DerivedDataCache::CreateKey("Mesh", CacheVersion, buffer, static_cast<size_t>(length), ImportFlags, sizeof(Vertex));
+
+    if (!DerivedDataCache::Get(m_DecodedCacheKey, &m_DecodedCache) && !Import(buffer, length))
         return false;
 
-    Pointer<Skeleton> skeletonRef = nullptr;
+    m_Decoded = true;
 
-    const bool_t hasSkeleton = LoadMesh(*scene, &skeletonRef);
+    return true;
+}
 
-    if (hasSkeleton)
-    {
-        for (uint32_t i = 0; i < scene->mNumAnimations; i++)
-        {
-            Pointer<Animation> animation = ResourceManager::Add<Animation>(folderPath + std::string(scene->mAnimations[i]->mName.C_Str()) + ".anim");
-        
-            animation->Load(*scene->mAnimations[i]);
-            animation->BindSkeleton(m_Skeletons[0]);
-            m_Animations.Add(animation);
-        }
-    }
+bool_t Mesh::FinishDecode()
+{
+    // Nothing was staged, e.g. because the Mesh was loaded before being streamed
+    if (!m_Decoded)
+        return m_Loaded;
 
-    LoadTexture(*scene);
-    /*
-    for (uint32_t i = 0; i < scene->mNumTextures; i++)
-    {
-        std::string fileName = GetTextureFileName(folderPath,scene->mTextures[i]->mFilename.C_Str(),scene->mTextures[i]->achFormatHint, i);
+    bool_t result = true;
+
+    if (!m_DecodedCache.empty() && LoadFromCache(m_DecodedCache))
+        ComputeAabb();
+    // Corrupted cached data falls back to importing the file
+    else if (m_DecodedImporter || Import(m_File->GetData<uint8_t>(), m_File->GetSize()))
+        LoadScene(*m_DecodedImporter->GetScene());
+    else
+        result = false;
+
+    ClearDecoded();
+    m_Loaded = result;
+
+    return result;
+}
+
+void Mesh::CreateInInterface()
+{
+    for (size_t i = 0; i < models.GetSize(); i++)
+        models[i]->CreateInInterface();
     
-        const std::string fullName = folderPath + fileName;
+    m_LoadedInInterface = true;
+}
 
-        if (FileManager::Contains(fullName))
-        {
-            
-        }
-        
-        const size_t pos = fileName.find_first_of('\\');
-        if (pos != std::string::npos)
-        {
-            const std::string subFolder = folderPath + fileName.substr(0, pos);
-            //FileManager::AddDirectory(subFolder);
-        }
-        Pointer<Texture> texture = ResourceManager::Add<Texture>(fullName);
+void Mesh::DestroyInInterface()
+{
+    for (size_t i = 0; i < models.GetSize(); i++)
+    {
+        if (models[i]->IsLoadedInInterface())
+            models[i]->DestroyInInterface();
+    }
+    
+    m_LoadedInInterface = false;
+}
 
-        int64_t size = 0;
-        if (scene->mTextures[i]->mHeight == 0)
-            size = scene->mTextures[i]->mWidth;
-        else
-            size = static_cast<int64_t>(static_cast<uint64_t>(scene->mTextures[i]->mWidth) * static_cast<uint64_t>(scene->mTextures[i]->mHeight) * sizeof(aiTexel));
+void Mesh::Unload()
+{
+    // Keep the Models in the list so that they get loaded back in place by a subsequent Load
+    for (size_t i = 0; i < models.GetSize(); i++)
+        models[i]->Unload();
 
-        texture->Load(reinterpret_cast<const uint8_t*>(scene->mTextures[i]->pcData), size);
-        texture->SetIsEmbedded();
-        texture->Save();
-    }*/
+    ClearDecoded();
+    m_Loaded = false;
+}
 
-    /*
-    if (textures.GetSize() >= 1)
+size_t Mesh::GetInterfaceMemorySize() const
+{
+    size_t size = 0;
+    
+    for (size_t i = 0; i < models.GetSize(); i++)
     {
-        aiString textureName;
-        scene->mMaterials[0]->GetTexture(aiTextureType_DIFFUSE, 0, &textureName);
-        
-        material.albedoTexture = Pointer<Texture>::New(*textures[0]);
-    }*/
-    ComputeAabb();
+        if (models[i].IsValid())
+            size += models[i]->GetInterfaceMemorySize();
+    }
     
-    return true;
+    return size;
 }
 
-void Mesh::CreateInInterface()
+size_t Mesh::GetMemorySize() const
 {
+    size_t size = 0;
+    
     for (size_t i = 0; i < models.GetSize(); i++)
-        models[i]->CreateInInterface();
+    {
+        if (models[i].IsValid())
+            size += models[i]->GetMemorySize();
+    }
     
-    m_LoadedInInterface = true;
+    return size;
+}
+
+ResourceCategory::ResourceCategory Mesh::GetMemoryCategory() const
+{
+    return ResourceCategory::Meshes;
 }
 
 Pointer<Animation> Mesh::GetAnimation(const size_t id)
@@ -150,7 +199,14 @@ bool_t Mesh::LoadMesh(const aiScene& scene,Pointer<Skeleton>* outSkeleton)
         }
         else
         {
-           model = ResourceManager::Get<Model>(fullName);
+            model = ResourceManager::Get<Model>(fullName);
+
+            // The Model was unloaded along with this Mesh, load it back in place
+            if (!model->IsLoaded() && !model->Load(*scene.mMeshes[i]))
+                return false;
+
+            if (!models.Contains(model))
+                models.Add(model);
         }
 
         if (scene.mMeshes[i]->HasBones())
@@ -158,14 +214,15 @@ bool_t Mesh::LoadMesh(const aiScene& scene,Pointer<Skeleton>* outSkeleton)
             std::string resourceName = folderPath + std::string(scene.mAnimations[i]->mName.C_Str()) + ".skel";
             if (ResourceManager::Contains(resourceName))
             {
+                // Keep going through the remaining Models instead of returning early, they might need to be loaded back
                 skeleton = ResourceManager::Get<Skeleton>(resourceName);
-                *outSkeleton = skeleton;
-                return true;
-            }
-            else
-            {
-                skeleton = ResourceManager::Add<Skeleton>(resourceName);
+                if (!m_Skeletons.Contains(skeleton))
+                    m_Skeletons.Add(skeleton);
+                hasSkeleton = true;
+                continue;
             }
+
+            skeleton = ResourceManager::Add<Skeleton>(resourceName);
             
             skeleton->Load(*scene.mMeshes[i], *scene.mRootNode);
 
@@ -225,6 +282,177 @@ void Mesh::LoadTexture(const aiScene& scene)
     }
 }
 
+bool_t Mesh::Import(const uint8_t* const buffer, const int64_t length)
+{
+    m_DecodedImporter = std::make_shared<Assimp::Importer>();
+
+    if (m_DecodedImporter->ReadFileFromMemory(buffer, length, ImportFlags))
+        return true;
+
+    m_DecodedImporter.reset();
+
+    return false;
+}
+
+void Mesh::LoadScene(const aiScene& scene)
+{
+    const std::string folderPath = m_File->GetPathNoExtension() + '\\';
+
+    Pointer<Skeleton> skeletonRef = nullptr;
+
+    const bool_t hasSkeleton = LoadMesh(scene, &skeletonRef);
+
+    if (hasSkeleton)
+    {
+        for (uint32_t i = 0; i < scene.mNumAnimations; i++)
+        {
+            Pointer<Animation> animation = ResourceManager::Add<Animation>(folderPath + std::string(scene.mAnimations[i]->mName.C_Str()) + ".anim");
+        
+            animation->Load(*scene.mAnimations[i]);
+            animation->BindSkeleton(m_Skeletons[0]);
+
+            // The Mesh might be loaded back after having been unloaded
+            if (!m_Animations.Contains(animation))
+                m_Animations.Add(animation);
+        }
+    }
+
+    LoadTexture(scene);
+    /*
+    for (uint32_t i = 0; i < scene.mNumTextures; i++)
+    {
+        std::string fileName = GetTextureFileName(folderPath,scene.mTextures[i]->mFilename.C_Str(),scene.mTextures[i]->achFormatHint, i);
+    
+        const std::string fullName = folderPath + fileName;
+
+        if (FileManager::Contains(fullName))
+        {
+            
+        }
+        
+        const size_t pos = fileName.find_first_of('\\');
+        if (pos != std::string::npos)
+        {
+            const std::string subFolder = folderPath + fileName.substr(0, pos);
+            //FileManager::AddDirectory(subFolder);
+        }
+        Pointer<Texture> texture = ResourceManager::Add<Texture>(fullName);
+
+        int64_t size = 0;
+        if (scene.mTextures[i]->mHeight == 0)
+            size = scene.mTextures[i]->mWidth;
+        else
+            size = static_cast<int64_t>(static_cast<uint64_t>(scene.mTextures[i]->mWidth) * static_cast<uint64_t>(scene.mTextures[i]->mHeight) * sizeof(aiTexel));
+
+        texture->Load(reinterpret_cast<const uint8_t*>(scene.mTextures[i]->pcData), size);
+        texture->SetIsEmbedded();
+        texture->Save();
+    }*/
+
+    /*
+    if (textures.GetSize() >= 1)
+    {
+        aiString textureName;
+        scene.mMaterials[0]->GetTexture(aiTextureType_DIFFUSE, 0, &textureName);
+        
+        material.albedoTexture = Pointer<Texture>::New(*textures[0]);
+    }*/
+    ComputeAabb();
+
+    // Skeletons, animations and embedded textures are separate resources, so only static meshes are cached
+    if (!hasSkeleton && scene.mNumAnimations == 0 && scene.mNumTextures == 0)
+        SaveToCache(m_DecodedCacheKey, scene);
+}
+
+void Mesh::ClearDecoded()
+{
+    m_Decoded = false;
+    m_DecodedCache = {};
+    m_DecodedImporter.reset();
+}
+
+bool_t Mesh::LoadFromCache(const std::vector<uint8_t>& data)
+{
+    const std::string folderPath = m_File->GetPathNoExtension() + '\\';
+
+    size_t offset = 0;
+    uint32_t modelCount = 0;
+    if (!Read(data, &offset, &modelCount, 1))
+        return false;
+
+    for (uint32_t i = 0; i < modelCount; i++)
+    {
+        uint32_t nameLength = 0;
+        std::string meshName;
+        uint64_t vertexCount = 0;
+        uint64_t indexCount = 0;
+        std::array<Vector3, 2> bound;
+
+        if (!Read(data, &offset, &nameLength, 1))
+            return false;
+
+        meshName.resize(nameLength);
+        if (!Read(data, &offset, meshName.data(), nameLength)
+            || !Read(data, &offset, &vertexCount, 1)
+            || !Read(data, &offset, &indexCount, 1)
+            || !Read(data, &offset, bound.data(), bound.size()))
+            return false;
+
+        std::vector<Vertex> vertices(vertexCount);
+        std::vector<uint32_t> indices(indexCount);
+        if (!Read(data, &offset, vertices.data(), vertices.size()) || !Read(data, &offset, indices.data(), indices.size()))
+            return false;
+
+        const std::string fullName = folderPath + meshName + ".obj";
+        Pointer<Model> model = ResourceManager::Contains(fullName) ? ResourceManager::Get<Model>(fullName) : ResourceManager::Add<Model>(fullName);
+
+        if (!model->IsLoaded())
+        {
+            Bound aabb;
+            aabb.SetMinMax(bound[0], bound[1]);
+            model->Load(std::move(vertices), std::move(indices), aabb);
+        }
+
+        if (!models.Contains(model))
+            models.Add(model);
+    }
+
+    return offset == data.size();
+}
+
+void Mesh::SaveToCache(const DerivedDataKey& key, const aiScene& scene) const
+{
+    const std::string folderPath = m_File->GetPathNoExtension() + '\\';
+
+    std::vector<uint8_t> data;
+    Write(data, &scene.mNumMeshes, 1);
+
+    for (uint32_t i = 0; i < scene.mNumMeshes; i++)
+    {
+        const std::string meshName = scene.mMeshes[i]->mName.C_Str();
+        const Pointer<Model> model = ResourceManager::Get<Model>(folderPath + meshName + ".obj");
+        if (!model)
+            return;
+
+        const std::vector<Vertex>& vertices = model->GetVertices();
+        const std::vector<uint32_t>& indices = model->GetIndices();
+        const uint32_t nameLength = static_cast<uint32_t>(meshName.size());
+        const uint64_t vertexCount = vertices.size();
+        const uint64_t indexCount = indices.size();
+        const std::array<Vector3, 2> bound { model->aabb.GetMin(), model->aabb.GetMax() };
+
+        Write(data, &nameLength, 1);
+        Write(data, meshName.data(), meshName.size());
+        Write(data, &vertexCount, 1);
+        Write(data, &indexCount, 1);
+        Write(data, bound.data(), bound.size());
+        Write(data, vertices.data(), vertices.size());
+        Write(data, indices.data(), indices.size());
+    }
+
+    DerivedDataCache::Put(key, data.data(), data.size());
+}
+
 void Mesh::ComputeAabb()
 {
     Vector3 aabbMin = Vector3(std::numeric_limits<float_t>::max());
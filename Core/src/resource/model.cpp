@@ -1,5 +1,7 @@
 #include "resource/model.hpp"
 
+#include <algorithm>
+
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
@@ -84,6 +86,19 @@ bool_t Model::Load(const aiMesh& loadedData)
     m_Loaded = true;
 
     ComputeAabb(loadedData.mAABB);
+    BuildBvh();
+
+    return true;
+}
+
+bool_t Model::Load(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices, const Bound& bound)
+{
+    m_Vertices = std::move(vertices);
+    m_Indices = std::move(indices);
+    aabb = bound;
+    BuildBvh();
+
+    m_Loaded = true;
 
     return true;
 }
@@ -109,6 +124,7 @@ void Model::Unload()
     
     m_Vertices.clear();
     m_Indices.clear();
+    m_Bvh.Clear();
 
     m_Loaded = false;
 }
@@ -180,16 +196,73 @@ bool_t Model::Save() const
     return exporter.Export(&scene, "obj", m_Name.c_str()) == aiReturn_SUCCESS;
 }
 
+size_t Model::GetInterfaceMemorySize() const
+{
+    return m_Vertices.size() * sizeof(Vertex) + m_Indices.size() * sizeof(uint32_t);
+}
+
+size_t Model::GetMemorySize() const
+{
+    // The vertices and indices are kept in memory after being created in the Rhi
+    return m_Vertices.size() * sizeof(Vertex) + m_Indices.size() * sizeof(uint32_t) + m_Bvh.GetMemorySize();
+}
+
+ResourceCategory::ResourceCategory Model::GetMemoryCategory() const
+{
+    // Models are accounted for by the Mesh they belong to
+    return ResourceCategory::Untracked;
+}
+
 uint32_t Model::GetId() const
 {
     return m_ModelId;
 }
 
+bool_t Model::Raycast(const Ray& ray, float_t* const distance) const
+{
+    uint32_t triangle = 0;
+    return m_Bvh.Raycast(
+        ray,
+        [&](const uint32_t primitive, float_t* const closestDistance) -> bool_t
+        {
+            const size_t baseIndex = static_cast<size_t>(primitive) * 3;
+            float_t triangleDistance = 0.f;
+            if (!ray.Intersect(
+                m_Vertices[m_Indices[baseIndex + 0]].position,
+                m_Vertices[m_Indices[baseIndex + 1]].position,
+                m_Vertices[m_Indices[baseIndex + 2]].position,
+                &triangleDistance
+            ))
+            {
+                return false;
+            }
+
+            if (triangleDistance >= *closestDistance)
+                return false;
+
+            *closestDistance = triangleDistance;
+            return true;
+        },
+        distance,
+        &triangle
+    );
+}
+
 const std::vector<Vertex>& Model::GetVertices() const
 {
     return m_Vertices;
 }
 
+const std::vector<uint32_t>& Model::GetIndices() const
+{
+    return m_Indices;
+}
+
+const Bvh& Model::GetBvh() const
+{
+    return m_Bvh;
+}
+
 void Model::ComputeAabb(const aiAABB& assimpAabb)
 {
     Vector3 min;
@@ -223,3 +296,22 @@ void Model::ComputeAabb(const aiAABB& assimpAabb)
 
     aabb.SetMinMax(min, max);
 }
+
+void Model::BuildBvh()
+{
+    // A primitive per triangle, for CPU raycasts
+    std::vector<Bound> triangleBounds(m_Indices.size() / 3);
+    for (size_t i = 0; i < triangleBounds.size(); i++)
+    {
+        const Vector3& p0 = m_Vertices[m_Indices[i * 3 + 0]].position;
+        const Vector3& p1 = m_Vertices[m_Indices[i * 3 + 1]].position;
+        const Vector3& p2 = m_Vertices[m_Indices[i * 3 + 2]].position;
+
+        triangleBounds[i].SetMinMax(
+            Vector3(std::min({ p0.x, p1.x, p2.x }), std::min({ p0.y, p1.y, p2.y }), std::min({ p0.z, p1.z, p2.z })),
+            Vector3(std::max({ p0.x, p1.x, p2.x }), std::max({ p0.y, p1.y, p2.y }), std::max({ p0.z, p1.z, p2.z }))
+        );
+    }
+
+    m_Bvh.Build(triangleBounds);
+}
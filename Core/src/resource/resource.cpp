@@ -29,6 +29,16 @@ bool_t Resource::Load(const Pointer<File>& file)
     return Load(file->GetData<uint8_t>(), file->GetSize());
 }
 
+bool_t Resource::Decode(const uint8_t* const buffer, const int64_t length)
+{
+    return Load(buffer, length);
+}
+
+bool_t Resource::FinishDecode()
+{
+    return true;
+}
+
 void Resource::CreateInInterface()
 {
     m_LoadedInInterface = true;
@@ -83,6 +93,21 @@ bool_t Resource::Save() const
     return false;
 }
 
+size_t Resource::GetInterfaceMemorySize() const
+{
+    return 0;
+}
+
+size_t Resource::GetMemorySize() const
+{
+    return 0;
+}
+
+ResourceCategory::ResourceCategory Resource::GetMemoryCategory() const
+{
+    return ResourceCategory::Other;
+}
+
 bool_t Resource::IsLoaded() const
 {
     return m_Loaded;
@@ -93,6 +118,16 @@ bool_t Resource::IsLoadedInInterface() const
     return m_LoadedInInterface;
 }
 
+bool_t Resource::IsEvicted() const
+{
+    return m_Evicted;
+}
+
+uint64_t Resource::GetLastUsedFrame() const
+{
+    return m_LastUsedFrame;
+}
+
 std::string Resource::GetName() const
 {
     return m_Name;
@@ -1,12 +1,15 @@
 ﻿#include "resource/resource_manager.hpp"
 
+#include <algorithm>
 #include <array>
 #include <execution>
-#include <fstream>
+#include <ranges>
 
 #include "file/file_manager.hpp"
+#include "input/time.hpp"
 #include "resource/audio_track.hpp"
 #include "resource/compute_shader.hpp"
+#include "resource/derived_data_cache.hpp"
 #include "resource/font.hpp"
 #include "resource/mesh.hpp"
 #include "resource/model.hpp"
@@ -91,53 +94,83 @@ void ResourceManager::LoadAll()
         m_Resources.size() - oldResourceCount,
         std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start)
     );
+
+    const DerivedDataCacheStats cacheStats = DerivedDataCache::GetStats();
+    Logger::LogDebug(
+        "Derived data cache: {} hits, {} misses, {} writes, {} corrupted, {} evicted ({} bytes)",
+        cacheStats.hits,
+        cacheStats.misses,
+        cacheStats.writes,
+        cacheStats.corruptions,
+        cacheStats.evictions,
+        cacheStats.size
+    );
 }
 
 void ResourceManager::LoadGuidMap()
 {
-    const Pointer<File> guidMap = FileManager::Get(GuidMapFilePath);
-    const char_t* const dataRaw = guidMap.Get()->GetData();
+    auto&& start = std::chrono::system_clock::now();
 
-    std::istringstream stream(dataRaw);
-    std::string line;
+    bool_t loaded = false;
 
-    while (std::getline(stream, line))
+    // Prefer the file on disk so that saves can be incremental, the archive version is read-only
+    if (std::filesystem::exists(GuidMapFilePath))
     {
-        const size_t guidPos = line.find_first_of(';');
+        loaded = m_GuidMap.Load(GuidMapFilePath);
+    }
+    else if (FileManager::Contains(GuidMapFilePath))
+    {
+        const Pointer<File> guidMap = FileManager::Get(GuidMapFilePath);
+        loaded = m_GuidMap.Load(guidMap->GetData<uint8_t>(), static_cast<size_t>(guidMap->GetSize()));
+    }
+    else if (FileManager::Contains(TextGuidMapFilePath))
+    {
+        Logger::LogInfo("Converting GUID map {} to the binary format", TextGuidMapFilePath);
+
+        const Pointer<File> guidMap = FileManager::Get(TextGuidMapFilePath);
+        loaded = m_GuidMap.LoadText(std::string_view(guidMap->GetData(), static_cast<size_t>(guidMap->GetSize())));
+    }
+
+    if (!loaded)
+        Logger::LogWarning("Couldn't load the GUID map, new GUIDs will be generated for every resource");
 
-        const std::string resourceName = line.substr(0, guidPos);
-        const Guid guid = Guid::FromString(&line[guidPos + 1]);
+    std::scoped_lock lock(m_ResourcesMutex);
 
-        auto&& it = m_Resources.find(resourceName);
+    m_GuidMapLoaded = true;
+
+    std::vector<Guid> removedEntries;
+    for (auto&& [guid, name] : m_GuidMap.GetEntries())
+    {
+        auto&& it = m_Resources.find(name);
 
         if (it != m_Resources.end())
-        {
             it->second->SetGuid(guid);
-            m_GuidMap.emplace(guid, it->first);
-        }
+        else
+            removedEntries.push_back(guid);
     }
 
+    // Entries of resources that don't exist anymore
+    for (const Guid& guid : removedEntries)
+        (void) m_GuidMap.Remove(guid);
+
     for (auto&& res : m_Resources)
-    {
-        auto it = std::ranges::find_if(m_GuidMap, [&res](auto&& p) -> bool_t { return p.second == res.first; });
+        AssignGuid(*res.second);
 
-        if (it == m_GuidMap.end())
-        {
-            m_GuidMap.emplace(res.second->GetGuid(), res.second->GetName());
-        }
-    }
+    Logger::LogDebug(
+        "Loaded GUID map with {} entries. Took {}",
+        m_GuidMap.GetCount(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start)
+    );
 }
 
 void ResourceManager::SaveGuidMap()
 {
-    std::ofstream file(GuidMapFilePath);
+    std::scoped_lock lock(m_ResourcesMutex);
 
-    for (auto&& res : m_GuidMap)
-    {
-        file << res.second << ";" << static_cast<std::string>(res.first) << '\n';
-    }
+    if (!m_GuidMapLoaded)
+        return;
 
-    file.close();
+    (void) m_GuidMap.Save(GuidMapFilePath);
 }
 
 bool ResourceManager::Contains(const std::string& name)
@@ -163,6 +196,9 @@ void ResourceManager::Rename(const Pointer<Resource>& resource, const std::strin
 
     Logger::LogInfo("Renaming resource {} to {}", oldName, newName);
 
+    if (m_GuidMapLoaded)
+        m_GuidMap.Add(resource->GetGuid(), newName);
+
     // Create a new temporary strong reference of the resource to keep it alive until we insert it in the map again
     const Pointer newResource(resource, true);
 
@@ -211,6 +247,245 @@ void ResourceManager::UnloadAll()
     // Smart pointers are deleted automatically, we only need to clear the container
     m_Resources.clear();
 
+    {
+        std::scoped_lock lock(m_RestoreMutex);
+        m_PendingRestores.clear();
+    }
+
     SaveGuidMap();
     Logger::LogInfo("ResourceManager unload successful. Took {}", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start));
 }
+
+void ResourceManager::SetMemoryBudget(const ResourceCategory::ResourceCategory category, const size_t bytes)
+{
+    if (category >= ResourceCategory::Count)
+    {
+        Logger::LogError("Cannot set the memory budget of an untracked resource category");
+        return;
+    }
+
+    m_MemoryBudgets[category] = bytes;
+}
+
+size_t ResourceManager::GetMemoryBudget(const ResourceCategory::ResourceCategory category)
+{
+    if (category >= ResourceCategory::Count)
+        return 0;
+
+    return m_MemoryBudgets[category];
+}
+
+std::array<ResourceMemoryStats, ResourceCategory::Count> ResourceManager::GetMemoryStats()
+{
+    std::array<ResourceMemoryStats, ResourceCategory::Count> stats;
+
+    for (size_t i = 0; i < ResourceCategory::Count; i++)
+    {
+        stats[i].budget = m_MemoryBudgets[i];
+        stats[i].lastEvictionCount = m_LastEvictionCounts[i];
+    }
+
+    std::scoped_lock lock(m_ResourcesMutex);
+
+    for (const Pointer<Resource>& resource : m_Resources | std::views::values)
+    {
+        const ENUM_VALUE(ResourceCategory) category = resource->GetMemoryCategory();
+        if (category >= ResourceCategory::Count)
+            continue;
+
+        ResourceMemoryStats& categoryStats = stats[category];
+
+        if (resource->IsEvicted())
+        {
+            categoryStats.evictedCount++;
+            continue;
+        }
+
+        size_t cpuBytes = 0, gpuBytes = 0;
+        GetMemoryUsage(*resource, &cpuBytes, &gpuBytes);
+
+        if (cpuBytes + gpuBytes == 0)
+            continue;
+
+        categoryStats.cpuBytes += cpuBytes;
+        categoryStats.gpuBytes += gpuBytes;
+        categoryStats.resourceCount++;
+    }
+
+    return stats;
+}
+
+void ResourceManager::EnforceMemoryBudgets()
+{
+    const uint64_t currentFrame = Time::GetTotalFrameCount<uint64_t>();
+
+    std::array<size_t, ResourceCategory::Count> usages {};
+    // The map isn't modified by evictions so we can safely keep pointers to its values
+    std::array<std::vector<const Pointer<Resource>*>, ResourceCategory::Count> candidates;
+
+    {
+        std::scoped_lock lock(m_ResourcesMutex);
+
+        for (const Pointer<Resource>& resource : m_Resources | std::views::values)
+        {
+            const ENUM_VALUE(ResourceCategory) category = resource->GetMemoryCategory();
+            if (category >= ResourceCategory::Count || resource->IsEvicted())
+                continue;
+
+            size_t cpuBytes = 0, gpuBytes = 0;
+            GetMemoryUsage(*resource, &cpuBytes, &gpuBytes);
+
+            if (cpuBytes + gpuBytes == 0)
+                continue;
+
+            usages[category] += cpuBytes + gpuBytes;
+
+            if (resource->GetLastUsedFrame() != currentFrame && !IsReferenced(resource))
+                candidates[category].push_back(&resource);
+        }
+    }
+
+    for (size_t i = 0; i < ResourceCategory::Count; i++)
+    {
+        m_LastEvictionCounts[i] = 0;
+
+        const size_t budget = m_MemoryBudgets[i];
+        if (budget == 0 || usages[i] <= budget)
+            continue;
+
+        std::vector<const Pointer<Resource>*>& categoryCandidates = candidates[i];
+        std::ranges::sort(
+            categoryCandidates,
+            [](const Pointer<Resource>* const lhs, const Pointer<Resource>* const rhs) -> bool_t { return (*lhs)->GetLastUsedFrame() < (*rhs)->GetLastUsedFrame(); }
+        );
+
+        for (const Pointer<Resource>* const resource : categoryCandidates)
+        {
+            if (usages[i] <= budget)
+                break;
+
+            size_t cpuBytes = 0, gpuBytes = 0;
+            GetMemoryUsage(**resource, &cpuBytes, &gpuBytes);
+
+            Evict(*resource);
+
+            usages[i] -= cpuBytes + gpuBytes;
+            m_LastEvictionCounts[i]++;
+        }
+    }
+}
+
+void ResourceManager::Evict(Pointer<Resource> resource)
+{
+    if (resource->IsEvicted())
+        return;
+
+    Logger::LogDebug("Evicting resource {}", resource->GetName());
+
+    if (resource->IsLoadedInInterface())
+        resource->DestroyInInterface();
+
+    if (resource->IsLoaded())
+        resource->Unload();
+
+    // Only release the File data if it isn't shared with another Resource
+    Pointer<File>& file = resource->m_File;
+    if (file && file->GetLoaded() && file->m_Resource.Get() == resource.Get())
+        file->Unload();
+
+    resource->m_Evicted = true;
+
+    onResourceEvicted(resource);
+}
+
+bool_t ResourceManager::Restore(Pointer<Resource> resource)
+{
+    // Decoding with the lock held makes sure concurrent retrievals of the same Resource only decode it once
+    std::scoped_lock lock(m_RestoreMutex);
+
+    if (!resource->IsEvicted() || std::ranges::find(m_PendingRestores, resource) != m_PendingRestores.end())
+        return true;
+
+    Logger::LogDebug("Restoring resource {}", resource->GetName());
+
+    // Access the File through a reference, this might not be the main thread
+    Pointer<File>& file = resource->m_File;
+    if (!file || (!file->GetLoaded() && !file->Load()) || !resource->Decode(file->GetData<uint8_t>(), file->GetSize()))
+    {
+        Logger::LogError("Couldn't restore evicted resource {}", resource->GetName());
+        return false;
+    }
+
+    m_PendingRestores.push_back(std::move(resource));
+
+    return true;
+}
+
+void ResourceManager::FinishRestores()
+{
+    std::vector<Pointer<Resource>> restores;
+
+    {
+        std::scoped_lock lock(m_RestoreMutex);
+        restores.swap(m_PendingRestores);
+    }
+
+    for (Pointer<Resource>& resource : restores)
+    {
+        // The Resource was unloaded in the meantime
+        if (!resource)
+            continue;
+
+        if (!resource->FinishDecode())
+        {
+            Logger::LogError("Couldn't restore evicted resource {}", resource->GetName());
+            resource->Unload();
+            continue;
+        }
+
+        // Same as LoadNoCheck, some resources only need to be created in the interface
+        resource->CreateInInterface();
+
+        {
+            std::scoped_lock lock(m_RestoreMutex);
+            resource->m_Evicted = false;
+        }
+
+        onResourceRestored(resource);
+    }
+}
+
+void ResourceManager::AssignGuid(Resource& resource)
+{
+    if (!m_GuidMapLoaded)
+        return;
+
+    const Guid guid = m_GuidMap.Find(resource.GetName());
+
+    if (guid == Guid::Empty())
+        m_GuidMap.Add(resource.GetGuid(), resource.GetName());
+    else
+        resource.SetGuid(guid);
+}
+
+void ResourceManager::GetMemoryUsage(const Resource& resource, size_t* const cpuBytes, size_t* const gpuBytes)
+{
+    *cpuBytes = resource.GetMemorySize();
+    *gpuBytes = resource.IsLoadedInInterface() ? resource.GetInterfaceMemorySize() : 0;
+
+    // The raw File data is accounted for by the Resource it was loaded for
+    const Pointer<File>& file = resource.m_File;
+    if (file && file->GetLoaded() && file->m_Resource.Get() == &resource)
+        *cpuBytes += static_cast<size_t>(file->GetSize());
+}
+
+bool_t ResourceManager::IsReferenced(const Pointer<Resource>& resource)
+{
+    const ReferenceCounter<Resource>* const counter = resource.GetReferenceCounter();
+
+    // The ResourceManager holds the only strong reference, and the File the Resource was loaded from holds a weak one
+    const Pointer<File>& file = resource->m_File;
+    const uint64_t internalWeakReferences = file && file->m_Resource.Get() == resource.Get() ? 1 : 0;
+
+    return counter->GetStrong() > 1 || counter->GetWeak() > internalWeakReferences;
+}
@@ -0,0 +1,417 @@
+#include "resource/resource_streamer.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "utils/formatter.hpp"
+#include "utils/logger.hpp"
+
+using namespace XnorCore;
+
+StreamingRequest::StreamingRequest(const Pointer<Resource>& resource, const Pointer<File>& file, const ENUM_VALUE(LoadPriority) priority)
+    : m_Resource(resource)
+    , m_File(file)
+    , m_Priority(priority)
+{
+}
+
+Pointer<Resource> StreamingRequest::GetResource() const
+{
+    return m_Resource;
+}
+
+StreamingState::StreamingState StreamingRequest::GetState() const
+{
+    return m_State;
+}
+
+LoadPriority::LoadPriority StreamingRequest::GetPriority() const
+{
+    return m_Priority;
+}
+
+bool_t StreamingRequest::IsDone() const
+{
+    const ENUM_VALUE(StreamingState) state = m_State;
+    return state == StreamingState::Ready || state == StreamingState::Cancelled || state == StreamingState::Failed;
+}
+
+void StreamingRequest::Cancel()
+{
+    ResourceStreamer::Cancel(this);
+}
+
+void ResourceStreamer::Initialize(uint32_t workerCount)
+{
+    if (m_Running)
+    {
+        Logger::LogWarning("ResourceStreamer has already been initialized");
+        return;
+    }
+
+    // Keep at least one hardware thread for the main thread
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency() / 2);
+
+    Logger::LogInfo("Starting ResourceStreamer with {} worker threads", workerCount);
+
+    m_Running = true;
+    m_Paused = false;
+
+    for (uint32_t i = 0; i < workerCount; i++)
+    {
+        std::thread& worker = m_Workers.emplace_back(Run);
+        Utils::SetThreadName(worker, L"ResourceStreamer Thread");
+    }
+}
+
+void ResourceStreamer::Shutdown()
+{
+    if (!m_Running)
+        return;
+
+    {
+        std::scoped_lock lock(m_Mutex);
+        m_Running = false;
+    }
+
+    m_CondVar.notify_all();
+
+    for (std::thread& worker : m_Workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+    m_Workers.clear();
+
+    // No worker is running at this point so we can safely cancel everything that is left
+    for (Pointer<StreamingRequest>& request : m_Requests)
+    {
+        if (request->IsDone())
+            continue;
+
+        if (request->m_State == StreamingState::Decoded)
+            request->m_Resource->Unload();
+
+        request->m_State = StreamingState::Cancelled;
+    }
+
+    for (size_t i = 0; i < LoadPriority::Count; i++)
+    {
+        m_DecodeQueues[i].clear();
+        m_UploadQueues[i].clear();
+    }
+
+    m_Requests.clear();
+    m_Stats = {};
+}
+
+bool_t ResourceStreamer::IsRunning()
+{
+    return m_Running;
+}
+
+Pointer<StreamingRequest> ResourceStreamer::Enqueue(const Pointer<Resource>& resource, const Pointer<File>& file, const ENUM_VALUE(LoadPriority) priority)
+{
+    Pointer<StreamingRequest> request = Pointer<StreamingRequest>::New(resource, file, priority);
+
+    // An already loaded resource doesn't need to go through the worker threads
+    if (resource->IsLoadedInInterface())
+    {
+        request->m_State = StreamingState::Ready;
+        return request;
+    }
+
+    {
+        std::scoped_lock lock(m_Mutex);
+
+        if (resource->IsLoaded())
+        {
+            request->m_State = StreamingState::Decoded;
+            m_UploadQueues[priority].push_back(request.Get());
+        }
+        else
+        {
+            m_DecodeQueues[priority].push_back(request.Get());
+        }
+
+        m_Requests.push_back(request.CreateStrongReference());
+    }
+
+    m_CondVar.notify_one();
+
+    return request;
+}
+
+void ResourceStreamer::Cancel(StreamingRequest* const request)
+{
+    std::scoped_lock lock(m_Mutex);
+
+    switch (request->m_State)
+    {
+        case StreamingState::Queued:
+            std::erase(m_DecodeQueues[request->m_Priority], request);
+            request->m_State = StreamingState::Cancelled;
+            break;
+
+        case StreamingState::Decoding:
+            // The worker thread will take care of it once it is done decoding
+            request->m_CancelRequested = true;
+            break;
+
+        case StreamingState::Decoded:
+            std::erase(m_UploadQueues[request->m_Priority], request);
+            request->m_Resource->Unload();
+            request->m_State = StreamingState::Cancelled;
+            break;
+
+        case StreamingState::Ready:
+        case StreamingState::Cancelled:
+        case StreamingState::Failed:
+            break;
+    }
+}
+
+void ResourceStreamer::Update()
+{
+    using namespace std::chrono;
+
+    const steady_clock::time_point start = steady_clock::now();
+
+    StreamingStats stats;
+
+    while (true)
+    {
+        StreamingRequest* request = nullptr;
+
+        {
+            std::scoped_lock lock(m_Mutex);
+            request = PopUpload();
+        }
+
+        if (!request)
+            break;
+
+        // The size of the resource is only known once its sub-resources are registered
+        if (!Finish(request))
+            continue;
+
+        const size_t size = request->m_Resource->GetInterfaceMemorySize();
+        const float_t elapsed = duration<float_t, std::milli>(steady_clock::now() - start).count();
+
+        // Always upload at least one resource per frame, otherwise a resource bigger than the budget would never be uploaded
+        if (stats.uploadCount != 0 && (stats.uploadBytes + size > budget.bytes || elapsed >= budget.milliseconds))
+        {
+            // Finishing a request twice doesn't do anything, so it can wait for the next frame as is
+            std::scoped_lock lock(m_Mutex);
+            m_UploadQueues[request->m_Priority].push_front(request);
+            break;
+        }
+
+        Upload(request);
+
+        stats.uploadCount++;
+        stats.uploadBytes += size;
+    }
+
+    stats.uploadMilliseconds = duration<float_t, std::milli>(steady_clock::now() - start).count();
+
+    {
+        std::scoped_lock lock(m_Mutex);
+
+        for (size_t i = 0; i < LoadPriority::Count; i++)
+        {
+            stats.queued[i] = m_DecodeQueues[i].size();
+            stats.pendingUploads += m_UploadQueues[i].size();
+        }
+    }
+
+    m_Stats = stats;
+
+    ReleaseDoneRequests();
+}
+
+void ResourceStreamer::Flush()
+{
+    if (!m_Running)
+    {
+        Logger::LogError("Cannot flush the ResourceStreamer as it isn't running");
+        return;
+    }
+
+    {
+        std::unique_lock lock(m_Mutex);
+
+        m_Paused = false;
+        m_CondVar.notify_all();
+
+        m_CondVar.wait(
+            lock,
+            []
+            {
+                if (m_ActiveDecodes != 0)
+                    return false;
+
+                return std::ranges::all_of(m_DecodeQueues, [](const Queue& queue) -> bool_t { return queue.empty(); });
+            }
+        );
+    }
+
+    StreamingRequest* request = nullptr;
+    while (true)
+    {
+        {
+            std::scoped_lock lock(m_Mutex);
+            request = PopUpload();
+        }
+
+        if (!request)
+            break;
+
+        if (Finish(request))
+            Upload(request);
+    }
+
+    ReleaseDoneRequests();
+}
+
+void ResourceStreamer::Pause()
+{
+    std::scoped_lock lock(m_Mutex);
+    m_Paused = true;
+}
+
+void ResourceStreamer::Resume()
+{
+    {
+        std::scoped_lock lock(m_Mutex);
+        m_Paused = false;
+    }
+
+    m_CondVar.notify_all();
+}
+
+StreamingStats ResourceStreamer::GetStats()
+{
+    return m_Stats;
+}
+
+void ResourceStreamer::Run()
+{
+    std::unique_lock lock(m_Mutex);
+
+    while (true)
+    {
+        StreamingRequest* request = nullptr;
+
+        m_CondVar.wait(
+            lock,
+            [&request]
+            {
+                if (!m_Running)
+                    return true;
+
+                if (m_Paused)
+                    return false;
+
+                request = PopDecode();
+                return request != nullptr;
+            }
+        );
+
+        if (!m_Running)
+            break;
+
+        request->m_State = StreamingState::Decoding;
+        m_ActiveDecodes++;
+
+        lock.unlock();
+
+        // Access the File through a reference, we mustn't create Pointer copies outside of the main thread
+        File& file = *request->m_File;
+
+        // Only decode here, registering sub-resources in the managers is done on the main thread by Finish
+        bool_t result = file.GetLoaded() || file.Load();
+        if (result)
+            result = request->m_Resource->Decode(file.GetData<uint8_t>(), file.GetSize());
+
+        lock.lock();
+
+        m_ActiveDecodes--;
+
+        if (request->m_CancelRequested)
+        {
+            if (result)
+                request->m_Resource->Unload();
+
+            request->m_State = StreamingState::Cancelled;
+        }
+        else if (!result)
+        {
+            Logger::LogError("Couldn't stream resource {}", request->m_Resource->GetName());
+            request->m_State = StreamingState::Failed;
+        }
+        else
+        {
+            request->m_State = StreamingState::Decoded;
+            m_UploadQueues[request->m_Priority].push_back(request);
+        }
+
+        // Wake up a potential Flush call
+        m_CondVar.notify_all();
+    }
+}
+
+StreamingRequest* ResourceStreamer::PopDecode()
+{
+    for (Queue& queue : m_DecodeQueues)
+    {
+        if (queue.empty())
+            continue;
+
+        StreamingRequest* const request = queue.front();
+        queue.pop_front();
+        return request;
+    }
+
+    return nullptr;
+}
+
+StreamingRequest* ResourceStreamer::PopUpload()
+{
+    for (Queue& queue : m_UploadQueues)
+    {
+        if (queue.empty())
+            continue;
+
+        StreamingRequest* const request = queue.front();
+        queue.pop_front();
+        return request;
+    }
+
+    return nullptr;
+}
+
+bool_t ResourceStreamer::Finish(StreamingRequest* const request)
+{
+    if (request->m_Resource->FinishDecode())
+        return true;
+
+    Logger::LogError("Couldn't stream resource {}", request->m_Resource->GetName());
+    request->m_Resource->Unload();
+    request->m_State = StreamingState::Failed;
+
+    return false;
+}
+
+void ResourceStreamer::Upload(StreamingRequest* const request)
+{
+    request->m_Resource->CreateInInterface();
+    request->m_State = StreamingState::Ready;
+}
+
+void ResourceStreamer::ReleaseDoneRequests()
+{
+    std::scoped_lock lock(m_Mutex);
+    std::erase_if(m_Requests, [](const Pointer<StreamingRequest>& request) -> bool_t { return request->IsDone(); });
+}
@@ -1,6 +1,7 @@
 #include "resource/shader.hpp"
 
 #include "rendering/rhi.hpp"
+#include "rendering/shader_preprocessor.hpp"
 #include "utils/logger.hpp"
 
 using namespace XnorCore;
@@ -85,12 +86,34 @@ void Shader::CreateInInterface()
     std::vector<ShaderCode> code(m_Code.size());
     std::ranges::copy(m_Code, code.begin());
     
-    m_Id = Rhi::CreateShaders(code, { m_DepthFunction, m_BlendFunction, m_ShaderProgramCullInfo });
+    m_Id = Rhi::CreateShaders(code, { m_DepthFunction, m_BlendFunction, m_ShaderProgramCullInfo }, m_VariantDefines);
     m_LoadedInInterface = true;
+
+    // Variants created before the shader was loaded, or kept after a reload
+    for (Pointer<Shader>& variant : m_VariantPrograms)
+    {
+        if (variant->m_LoadedInInterface)
+            continue;
+
+        if (!PreprocessVariant(variant->m_VariantFeatures, &variant->m_Code))
+            continue;
+
+        CopyPipelineState(*variant);
+        variant->CreateInInterface();
+    }
+
+    for (const uint32_t features : m_PrewarmVariants)
+        (void) GetVariant(features);
 }
 
 void Shader::DestroyInInterface()
 {
+    for (Pointer<Shader>& variant : m_VariantPrograms)
+    {
+        if (variant->m_LoadedInInterface)
+            variant->DestroyInInterface();
+    }
+
     Rhi::DestroyProgram(m_Id);
     
     m_Id = 0;
@@ -110,7 +133,27 @@ void Shader::Recompile()
 
     std::vector<ShaderCode> code(m_Code.size());
     std::ranges::copy(m_Code, code.begin());
-    m_Id = Rhi::ReloadProgram(m_Id, code);
+    m_Id = Rhi::ReloadProgram(m_Id, code, m_VariantDefines);
+
+    for (Pointer<Shader>& variant : m_VariantPrograms)
+    {
+        if (!PreprocessVariant(variant->m_VariantFeatures, &variant->m_Code))
+            continue;
+
+        code.assign(variant->m_Code.begin(), variant->m_Code.end());
+        variant->m_Id = Rhi::ReloadProgram(variant->m_Id, code, variant->m_VariantDefines);
+    }
+
+    // Variants are only deduplicated when they are created
+    for (const auto& [features, variant] : m_Variants)
+    {
+        std::array<ShaderCode, ShaderPipeline::Count> variantCode;
+        if (features != variant->m_VariantFeatures && PreprocessVariant(features, &variantCode) &&
+            !std::ranges::equal(variantCode, variant->m_Code, [](const ShaderCode& lhs, const ShaderCode& rhs) -> bool_t { return lhs.code == rhs.code; }))
+        {
+            Logger::LogWarning("Variant {} of shader {} now differs from variant {}, restart to recompile it", features, m_Name, variant->m_VariantFeatures);
+        }
+    }
 }
 
 void Shader::Unload()
@@ -153,6 +196,126 @@ void Shader::SetMat4(const std::string& keyName, const Matrix& value) const
     Rhi::SetUniform(UniformType::Mat4, &value, m_Id, keyName.c_str());
 }
 
+void Shader::SetInt(const UniformHandle<int32_t>& handle, const int32_t value) const
+{
+    Rhi::SetUniform(UniformType::Int, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
+void Shader::SetBool(const UniformHandle<bool_t>& handle, const bool_t value) const
+{
+    Rhi::SetUniform(UniformType::Bool, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
+void Shader::SetFloat(const UniformHandle<float_t>& handle, const float_t value) const
+{
+    Rhi::SetUniform(UniformType::Float, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
+void Shader::SetVec2(const UniformHandle<Vector2>& handle, const Vector2& value) const
+{
+    Rhi::SetUniform(UniformType::Vec2, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
+void Shader::SetVec3(const UniformHandle<Vector3>& handle, const Vector3& value) const
+{
+    Rhi::SetUniform(UniformType::Vec3, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
+void Shader::SetVec4(const UniformHandle<Vector4>& handle, const Vector4& value) const
+{
+    Rhi::SetUniform(UniformType::Vec4, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
+void Shader::SetMat4(const UniformHandle<Matrix>& handle, const Matrix& value) const
+{
+    Rhi::SetUniform(UniformType::Mat4, &value, m_Id, handle.hash, handle.checkHash, handle.name);
+}
+
+void Shader::SetFeatures(const std::vector<std::string>& features)
+{
+    if (features.size() > ShaderPreprocessor::MaxFeatures)
+    {
+        Logger::LogError("Shader {} can't have more than {} features", m_Name, ShaderPreprocessor::MaxFeatures);
+        return;
+    }
+
+    if (!m_Variants.empty())
+    {
+        Logger::LogError("Can't modify the features of shader {} after creating variants", m_Name);
+        return;
+    }
+    
+    m_Features = features;
+}
+
+const std::vector<std::string>& Shader::GetFeatures() const
+{
+    return m_Features;
+}
+
+Pointer<Shader> Shader::GetVariant(const uint32_t features)
+{
+    const auto&& it = m_Variants.find(features);
+    if (it != m_Variants.end())
+        return it->second;
+
+    if (m_Features.size() < ShaderPreprocessor::MaxFeatures && features >> m_Features.size() != 0)
+    {
+        Logger::LogError("Invalid features {:#x} for shader {}", features, m_Name);
+        return nullptr;
+    }
+
+    std::array<ShaderCode, ShaderPipeline::Count> code;
+    if (!PreprocessVariant(features, &code))
+    {
+        Logger::LogError("Couldn't preprocess variant {} of shader {}", ShaderPreprocessor::GetVariantName(m_Features, features), m_Name);
+        return nullptr;
+    }
+
+    const auto&& sameCode = [&code](const Pointer<Shader>& variant) -> bool_t
+    {
+        return std::ranges::equal(code, variant->m_Code, [](const ShaderCode& lhs, const ShaderCode& rhs) -> bool_t { return lhs.code == rhs.code; });
+    };
+
+    const auto&& existing = std::ranges::find_if(m_VariantPrograms, sameCode);
+    if (existing != m_VariantPrograms.end())
+        return m_Variants.emplace(features, *existing).first->second;
+
+    Pointer<Shader> variant = Pointer<Shader>::New(std::format("{}[{}]", m_Name, ShaderPreprocessor::GetVariantName(m_Features, features)));
+    variant->m_Code = std::move(code);
+    variant->m_VariantFeatures = features;
+    variant->m_VariantDefines = ShaderPreprocessor::GetDefines(m_Features, features);
+    variant->m_Loaded = true;
+    CopyPipelineState(*variant);
+
+    if (m_LoadedInInterface)
+        variant->CreateInInterface();
+
+    const Pointer<Shader>& result = m_VariantPrograms.emplace_back(std::move(variant));
+    return m_Variants.emplace(features, result).first->second;
+}
+
+void Shader::AddPrewarmVariant(const uint32_t features)
+{
+    if (std::ranges::find(m_PrewarmVariants, features) != m_PrewarmVariants.end())
+        return;
+
+    m_PrewarmVariants.push_back(features);
+
+    if (m_LoadedInInterface)
+        (void) GetVariant(features);
+}
+
+size_t Shader::GetVariantProgramCount() const
+{
+    return m_VariantPrograms.size();
+}
+
+const ShaderCode& Shader::GetCode(const ShaderPipeline::ShaderPipeline pipeline) const
+{
+    return m_Code[static_cast<size_t>(pipeline)];
+}
+
 uint32_t Shader::GetId() const
 {
     return m_Id;
@@ -201,3 +364,35 @@ void Shader::SetFaceCullingInfo(const ShaderProgramCullInfo& shaderProgramCullIn
     
     m_ShaderProgramCullInfo = shaderProgramCullInfo;
 }
+
+bool_t Shader::PreprocessVariant(const uint32_t features, std::array<ShaderCode, ShaderPipeline::Count>* const code) const
+{
+    for (size_t i = 0; i < m_Code.size(); i++)
+    {
+        const ShaderCode& source = m_Code[i];
+        ShaderCode& result = (*code)[i];
+
+        result.type = source.type;
+        if (source.codeLength <= 0)
+        {
+            result.code.clear();
+            result.codeLength = 0;
+            continue;
+        }
+
+        const std::string_view sourceCode(source.code.data(), std::min(source.code.size(), static_cast<size_t>(source.codeLength)));
+        if (!ShaderPreprocessor::Preprocess(sourceCode, m_Features, features, &result.code))
+            return false;
+
+        result.codeLength = static_cast<int32_t>(result.code.size());
+    }
+
+    return true;
+}
+
+void Shader::CopyPipelineState(Shader& variant) const
+{
+    variant.m_DepthFunction = m_DepthFunction;
+    variant.m_BlendFunction = m_BlendFunction;
+    variant.m_ShaderProgramCullInfo = m_ShaderProgramCullInfo;
+}
@@ -172,6 +172,13 @@ bool_t Skeleton::Load(const aiScene& scene, const aiAnimation& loadedData)
     return true;
 }
 
+bool_t Skeleton::Load(const List<Bone>& bones)
+{
+    m_Bones = bones;
+
+    return true;
+}
+
 void Skeleton::ReorderBones()
 {
     List<Bone> newBones;
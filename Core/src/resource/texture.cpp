@@ -1,9 +1,13 @@
 #include "resource/texture.hpp"
 
+#include <cstdlib>
+#include <cstring>
+
 #include <stb/stb_image.h>
 #include <stb/stb_image_write.h>
 
 #include "rendering/rhi.hpp"
+#include "resource/derived_data_cache.hpp"
 #include "utils/logger.hpp"
 
 using namespace XnorCore;
@@ -51,9 +55,46 @@ Texture::~Texture()
 
 bool_t Texture::Load(const uint8_t* const buffer, const int64_t length)
 {
+    const bool_t isHdr = std::filesystem::path(m_Name).extension() == ".hdr";
+    // Hdr textures are decoded to floats
+    const size_t bytesPerChannel = isHdr ? sizeof(float_t) : 1;
+
+    // Decoding is by far the most expensive part of loading a texture, so the decoded pixels are cached
+    const DerivedDataKey cacheKey = DerivedDataCache::CreateKey(
+        "Texture",
+        CacheVersion,
+        buffer,
+        static_cast<size_t>(length),
+        loadData.desiredChannels,
+        loadData.flipVertically,
+        isHdr
+    );
+
+    std::vector<uint8_t> cached;
+    if (DerivedDataCache::Get(cacheKey, &cached) && cached.size() >= sizeof(CachedHeader))
+    {
+        CachedHeader header;
+        std::memcpy(&header, cached.data(), sizeof(header));
+
+        const size_t dataSize = static_cast<size_t>(header.size.x) * static_cast<size_t>(header.size.y) * static_cast<size_t>(header.channels) * bytesPerChannel;
+        if (cached.size() - sizeof(header) == dataSize)
+        {
+            // The data is freed using stbi_image_free in Unload, which uses free by default
+            m_Data = static_cast<uint8_t*>(std::malloc(dataSize));
+            std::memcpy(m_Data, cached.data() + sizeof(header), dataSize);
+
+            m_Size = header.size;
+            m_DataChannels = header.dataChannels;
+            m_TextureFormat = Rhi::GetTextureFormatFromChannels(m_DataChannels);
+            m_Loaded = true;
+
+            return true;
+        }
+    }
+
     stbi_set_flip_vertically_on_load(loadData.flipVertically);
     
-    if (std::filesystem::path(m_Name).extension() == ".hdr")
+    if (isHdr)
     {
         m_Data = reinterpret_cast<decltype(m_Data)>(stbi_loadf_from_memory(buffer, static_cast<int32_t>(length), &m_Size.x, &m_Size.y, &m_DataChannels, loadData.desiredChannels));
     }
@@ -65,6 +106,23 @@ bool_t Texture::Load(const uint8_t* const buffer, const int64_t length)
     m_TextureFormat = Rhi::GetTextureFormatFromChannels(m_DataChannels);
     m_Loaded = true;
 
+    if (m_Data)
+    {
+        const CachedHeader header
+        {
+            .size = m_Size,
+            .dataChannels = m_DataChannels,
+            .channels = GetChannels()
+        };
+
+        const size_t dataSize = static_cast<size_t>(m_Size.x) * static_cast<size_t>(m_Size.y) * static_cast<size_t>(header.channels) * bytesPerChannel;
+        cached.resize(sizeof(header) + dataSize);
+        std::memcpy(cached.data(), &header, sizeof(header));
+        std::memcpy(cached.data() + sizeof(header), m_Data, dataSize);
+
+        DerivedDataCache::Put(cacheKey, cached.data(), cached.size());
+    }
+
     return true;
 }
 
@@ -168,6 +226,30 @@ TextureFormat::TextureFormat Texture::GetTextureFormat() const
     return m_TextureFormat;
 }
 
+size_t Texture::GetInterfaceMemorySize() const
+{
+    // Loaded textures are created using either the Rgba8 or the Rgb16F internal format, see CreateInInterface
+    const size_t bytesPerPixel = std::filesystem::path(m_Name).extension() == ".hdr" ? 3 * sizeof(uint16_t) : 4;
+    
+    return static_cast<size_t>(m_Size.x) * static_cast<size_t>(m_Size.y) * bytesPerPixel;
+}
+
+size_t Texture::GetMemorySize() const
+{
+    if (!m_Loaded || !m_Data || m_IsEmbedded)
+        return 0;
+
+    // Hdr textures are decoded to floats, see Load
+    const size_t bytesPerChannel = std::filesystem::path(m_Name).extension() == ".hdr" ? sizeof(float_t) : 1;
+
+    return static_cast<size_t>(m_Size.x) * static_cast<size_t>(m_Size.y) * static_cast<size_t>(GetChannels()) * bytesPerChannel;
+}
+
+ResourceCategory::ResourceCategory Texture::GetMemoryCategory() const
+{
+    return ResourceCategory::Textures;
+}
+
 bool_t Texture::Save() const
 {
     stbi_flip_vertically_on_write(loadData.flipVertically);
@@ -10,12 +10,11 @@ void SkinnedMeshRenderer::Begin()
 
 void SkinnedMeshRenderer::OnRendering()
 {
+    // The animator itself is animated afterward with the others by the AnimationSystem
     if (m_CurrentMontage)
     {
         m_CurrentMontage->Update(this);
     }
-
-    m_Animator.Animate();
 }
 
 void SkinnedMeshRenderer::StartAnimation(const Pointer<Animation>& animation)
@@ -44,3 +43,20 @@ const List<Matrix>& SkinnedMeshRenderer::GetMatrices() const
 {
     return m_Animator.GetMatrices();
 }
+
+Animator& SkinnedMeshRenderer::GetAnimator()
+{
+    return m_Animator;
+}
+
+void SkinnedMeshRenderer::GetAabb(Bound* const bound) const
+{
+    if (!mesh.IsValid())
+        return;
+
+    Bound poseAabb = mesh->aabb;
+    for (const Matrix& matrix : GetMatrices())
+        poseAabb.Encapsulate(Bound::GetAabbFromMatrix(mesh->aabb, matrix));
+
+    *bound = Bound::GetAabbFromTransform(poseAabb, GetTransform());
+}
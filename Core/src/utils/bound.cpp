@@ -35,9 +35,14 @@ void Bound::SetMinMax(const Vector3 newmin, const Vector3 newMax)
 
 Bound Bound::GetAabbFromTransform(const Bound& bound, const Transform& transform)
 {
-    const Vector3 globalPos = static_cast<Vector3>(transform.worldMatrix * Vector4(bound.center.x, bound.center.y, bound.center.z, 1.f));
+    return GetAabbFromMatrix(bound, transform.worldMatrix);
+}
+
+Bound Bound::GetAabbFromMatrix(const Bound& bound, const Matrix& matrix)
+{
+    const Vector3 globalPos = static_cast<Vector3>(matrix * Vector4(bound.center.x, bound.center.y, bound.center.z, 1.f));
     // Let the constructor
-    return ReturnAabbFromMatrix(bound, transform.worldMatrix, globalPos);
+    return ReturnAabbFromMatrix(bound, matrix, globalPos);
 }
 
 bool_t Bound::Intersect(const Bound& otherBound) const
@@ -0,0 +1,270 @@
+#include "utils/compression.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "utils/logger.hpp"
+
+using namespace XnorCore;
+
+// See https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+static constexpr size_t Lz4MinMatch = 4;
+// The last 5 bytes of a block are always literals
+static constexpr size_t Lz4LastLiterals = 5;
+// The last match must start at least 12 bytes before the end of a block
+static constexpr size_t Lz4MatchFindLimit = 12;
+static constexpr size_t Lz4MaxOffset = 0xFFFF;
+static constexpr uint32_t Lz4HashLog = 12;
+
+static uint32_t Read32(const uint8_t* const data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint32_t Lz4Hash(const uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - Lz4HashLog);
+}
+
+static uint8_t* WriteLength(uint8_t* destination, size_t length)
+{
+    while (length >= 0xFF)
+    {
+        *destination++ = 0xFF;
+        length -= 0xFF;
+    }
+
+    *destination++ = static_cast<uint8_t>(length);
+    return destination;
+}
+
+// Writes a sequence made of the literals in [literals, literals + literalLength) followed by an optional match
+static bool_t WriteSequence(
+    uint8_t** const destination,
+    const uint8_t* const destinationEnd,
+    const uint8_t* const literals,
+    const size_t literalLength,
+    const size_t offset,
+    const size_t matchLength
+)
+{
+    const size_t worstCase = 1 + literalLength / 0xFF + 1 + literalLength + 2 + matchLength / 0xFF + 1;
+    if (static_cast<size_t>(destinationEnd - *destination) < worstCase)
+        return false;
+
+    uint8_t* op = *destination;
+    uint8_t* const token = op++;
+
+    *token = static_cast<uint8_t>(std::min<size_t>(literalLength, 0xF) << 4);
+    if (literalLength >= 0xF)
+        op = WriteLength(op, literalLength - 0xF);
+
+    if (literalLength != 0)
+        std::memcpy(op, literals, literalLength);
+    op += literalLength;
+
+    // The last sequence only contains literals
+    if (offset != 0)
+    {
+        *op++ = static_cast<uint8_t>(offset & 0xFF);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+
+        const size_t encodedMatchLength = matchLength - Lz4MinMatch;
+        *token |= static_cast<uint8_t>(std::min<size_t>(encodedMatchLength, 0xF));
+        if (encodedMatchLength >= 0xF)
+            op = WriteLength(op, encodedMatchLength - 0xF);
+    }
+
+    *destination = op;
+    return true;
+}
+
+static size_t CompressLz4(const uint8_t* const source, const size_t sourceSize, uint8_t* const destination, const size_t destinationCapacity)
+{
+    const uint8_t* const end = source + sourceSize;
+    const uint8_t* const destinationEnd = destination + destinationCapacity;
+
+    const uint8_t* ip = source;
+    const uint8_t* anchor = source;
+    uint8_t* op = destination;
+
+    if (sourceSize > Lz4MatchFindLimit)
+    {
+        // Positions are stored relative to the start of the source
+        std::array<uint32_t, 1 << Lz4HashLog> table {};
+
+        const uint8_t* const matchLimit = end - Lz4LastLiterals;
+        const uint8_t* const ipLimit = end - Lz4MatchFindLimit;
+
+        while (ip < ipLimit)
+        {
+            const uint32_t sequence = Read32(ip);
+            uint32_t& entry = table[Lz4Hash(sequence)];
+            const uint8_t* const reference = source + entry;
+            entry = static_cast<uint32_t>(ip - source);
+
+            if (reference >= ip || static_cast<size_t>(ip - reference) > Lz4MaxOffset || Read32(reference) != sequence)
+            {
+                ip++;
+                continue;
+            }
+
+            const uint8_t* matchEnd = ip + Lz4MinMatch;
+            const uint8_t* referenceEnd = reference + Lz4MinMatch;
+            while (matchEnd < matchLimit && *matchEnd == *referenceEnd)
+            {
+                matchEnd++;
+                referenceEnd++;
+            }
+
+            if (!WriteSequence(&op, destinationEnd, anchor, static_cast<size_t>(ip - anchor), static_cast<size_t>(ip - reference), static_cast<size_t>(matchEnd - ip)))
+                return 0;
+
+            ip = matchEnd;
+            anchor = ip;
+        }
+    }
+
+    if (!WriteSequence(&op, destinationEnd, anchor, static_cast<size_t>(end - anchor), 0, 0))
+        return 0;
+
+    return static_cast<size_t>(op - destination);
+}
+
+static bool_t ReadLength(const uint8_t** const source, const uint8_t* const sourceEnd, size_t* const length)
+{
+    uint8_t value;
+    do
+    {
+        if (*source >= sourceEnd)
+            return false;
+
+        value = *(*source)++;
+        *length += value;
+    }
+    while (value == 0xFF);
+
+    return true;
+}
+
+static bool_t DecompressLz4(const uint8_t* const source, const size_t sourceSize, uint8_t* const destination, const size_t destinationSize)
+{
+    const uint8_t* ip = source;
+    const uint8_t* const ipEnd = source + sourceSize;
+    uint8_t* op = destination;
+    uint8_t* const opEnd = destination + destinationSize;
+
+    while (ip < ipEnd)
+    {
+        const uint8_t token = *ip++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 0xF && !ReadLength(&ip, ipEnd, &literalLength))
+            return false;
+
+        if (static_cast<size_t>(ipEnd - ip) < literalLength || static_cast<size_t>(opEnd - op) < literalLength)
+            return false;
+
+        if (literalLength != 0)
+            std::memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        // The last sequence only contains literals
+        if (ip == ipEnd)
+            break;
+
+        if (ipEnd - ip < 2)
+            return false;
+
+        const size_t offset = static_cast<size_t>(ip[0]) | static_cast<size_t>(ip[1]) << 8;
+        ip += 2;
+
+        if (offset == 0 || offset > static_cast<size_t>(op - destination))
+            return false;
+
+        size_t matchLength = token & 0xF;
+        if (matchLength == 0xF && !ReadLength(&ip, ipEnd, &matchLength))
+            return false;
+        matchLength += Lz4MinMatch;
+
+        if (static_cast<size_t>(opEnd - op) < matchLength)
+            return false;
+
+        // Matches can overlap with the output, so this needs to be copied byte by byte
+        const uint8_t* match = op - offset;
+        for (size_t i = 0; i < matchLength; i++)
+            *op++ = *match++;
+    }
+
+    return op == opEnd;
+}
+
+size_t Compression::GetMaxCompressedSize(const CompressionFormat::CompressionFormat format, const size_t size)
+{
+    switch (format)
+    {
+        case CompressionFormat::None:
+            return size;
+
+        case CompressionFormat::Lz4:
+            return size + size / 0xFF + 16;
+    }
+
+    return 0;
+}
+
+size_t Compression::Compress(
+    const CompressionFormat::CompressionFormat format,
+    const uint8_t* const source,
+    const size_t sourceSize,
+    uint8_t* const destination,
+    const size_t destinationCapacity
+)
+{
+    switch (format)
+    {
+        case CompressionFormat::None:
+            if (destinationCapacity < sourceSize)
+                return 0;
+
+            if (sourceSize != 0)
+                std::memcpy(destination, source, sourceSize);
+            return sourceSize;
+
+        case CompressionFormat::Lz4:
+            return CompressLz4(source, sourceSize, destination, destinationCapacity);
+    }
+
+    Logger::LogError("Unknown compression format {}", static_cast<int32_t>(format));
+    return 0;
+}
+
+bool_t Compression::Decompress(
+    const CompressionFormat::CompressionFormat format,
+    const uint8_t* const source,
+    const size_t sourceSize,
+    uint8_t* const destination,
+    const size_t destinationSize
+)
+{
+    switch (format)
+    {
+        case CompressionFormat::None:
+            if (sourceSize != destinationSize)
+                return false;
+
+            if (sourceSize != 0)
+                std::memcpy(destination, source, sourceSize);
+            return true;
+
+        case CompressionFormat::Lz4:
+            return DecompressLz4(source, sourceSize, destination, destinationSize);
+    }
+
+    Logger::LogError("Unknown compression format {}", static_cast<int32_t>(format));
+    return false;
+}
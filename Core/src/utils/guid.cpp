@@ -18,12 +18,61 @@ Guid Guid::New()
 	return guid;
 }
 
+// Parses up to 2 * sizeof(T) hexadecimal digits, returns false if there aren't any
+template <typename T>
+static bool_t ParseHex(std::string_view* const str, T* const value)
+{
+	*value = 0;
+
+	size_t i = 0;
+	for (; i < str->size() && i < sizeof(T) * 2; i++)
+	{
+		const char_t c = (*str)[i];
+
+		uint8_t digit;
+		if (c >= '0' && c <= '9')
+			digit = static_cast<uint8_t>(c - '0');
+		else if (c >= 'A' && c <= 'F')
+			digit = static_cast<uint8_t>(c - 'A' + 10);
+		else if (c >= 'a' && c <= 'f')
+			digit = static_cast<uint8_t>(c - 'a' + 10);
+		else
+			break;
+
+		*value = static_cast<T>((*value << 4) | digit);
+	}
+
+	str->remove_prefix(i);
+	return i != 0;
+}
+
+static bool_t ParseSeparator(std::string_view* const str)
+{
+	if (str->empty() || str->front() != '-')
+		return false;
+
+	str->remove_prefix(1);
+	return true;
+}
+
 Guid Guid::FromString(const char_t* str)
 {
+	return FromString(std::string_view(str));
+}
+
+Guid Guid::FromString(std::string_view str)
+{
+	// Hand-written instead of sscanf as this is called for every Guid of every serialized object
 	Guid g;
-	(void) sscanf_s(str, "%x-%hx-%hx-%hhx-%hhx-%hhx-%hhx-%hhx-%hhx-%hhx-%hhx", &g.m_Data1, &g.m_Data2, &g.m_Data3, &g.m_Data4[0], &g.m_Data4[1], &g.m_Data4[2], &g.m_Data4[3], &g.m_Data4[4], &g.m_Data4[5], &g.m_Data4[6], &g.m_Data4[7]);
 
-	return g;
+	bool_t valid = ParseHex(&str, &g.m_Data1)
+		&& ParseSeparator(&str) && ParseHex(&str, &g.m_Data2)
+		&& ParseSeparator(&str) && ParseHex(&str, &g.m_Data3);
+
+	for (size_t i = 0; i < Data4Size && valid; i++)
+		valid = ParseSeparator(&str) && ParseHex(&str, &g.m_Data4[i]);
+
+	return valid ? g : Empty();
 }
 
 uint32_t Guid::GetData1() const { return m_Data1; }
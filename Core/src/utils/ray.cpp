@@ -0,0 +1,83 @@
+#include "utils/ray.hpp"
+
+#include <algorithm>
+
+using namespace XnorCore;
+
+Ray::Ray(const Vector3& newOrigin, const Vector3& newDirection)
+    : origin(newOrigin)
+    , direction(newDirection)
+{
+}
+
+Vector3 Ray::GetPoint(const float_t distance) const
+{
+    return origin + direction * distance;
+}
+
+Ray Ray::Transform(const Matrix& matrix) const
+{
+    // Transform 2 points instead of the direction to keep the distances along the ray
+    const Vector3 newOrigin = matrix * origin;
+    return Ray(newOrigin, matrix * (origin + direction) - newOrigin);
+}
+
+bool_t Ray::Intersect(const Bound& bound, const float_t maxDistance, float_t* const distance) const
+{
+    const Vector3 min = bound.GetMin();
+    const Vector3 max = bound.GetMax();
+
+    float_t near = 0.f;
+    float_t far = maxDistance;
+    for (size_t axis = 0; axis < 3; axis++)
+    {
+        // A null direction gives infinite distances, the ray is then either always or never between the 2 planes
+        const float_t inverse = 1.f / direction[axis];
+        float_t t0 = (min[axis] - origin[axis]) * inverse;
+        float_t t1 = (max[axis] - origin[axis]) * inverse;
+        if (t0 > t1)
+            std::swap(t0, t1);
+
+        // Written so that NaNs, from a null direction and an origin on a plane, don't discard the hit
+        near = t0 > near ? t0 : near;
+        far = t1 < far ? t1 : far;
+        if (near > far)
+            return false;
+    }
+
+    *distance = near;
+    return true;
+}
+
+bool_t Ray::Intersect(const Vector3& p0, const Vector3& p1, const Vector3& p2, float_t* const distance) const
+{
+    // Möller-Trumbore
+    constexpr float_t Epsilon = 1e-12f;
+
+    const Vector3 edge1 = p1 - p0;
+    const Vector3 edge2 = p2 - p0;
+    const Vector3 p = Vector3::Cross(direction, edge2);
+    const float_t determinant = Vector3::Dot(edge1, p);
+
+    // Parallel to the triangle
+    if (std::abs(determinant) < Epsilon)
+        return false;
+
+    const float_t inverseDeterminant = 1.f / determinant;
+    const Vector3 s = origin - p0;
+    const float_t u = Vector3::Dot(s, p) * inverseDeterminant;
+    if (u < 0.f || u > 1.f)
+        return false;
+
+    const Vector3 q = Vector3::Cross(s, edge1);
+    const float_t v = Vector3::Dot(direction, q) * inverseDeterminant;
+    if (v < 0.f || u + v > 1.f)
+        return false;
+
+    const float_t t = Vector3::Dot(edge2, q) * inverseDeterminant;
+    if (t < 0.f)
+        return false;
+
+    *distance = t;
+    return true;
+}
@@ -0,0 +1,141 @@
+#include "world/scene_raycaster.hpp"
+
+#include <algorithm>
+
+#include "scene/component/skinned_mesh_renderer.hpp"
+#include "scene/component/static_mesh_renderer.hpp"
+
+using namespace XnorCore;
+
+void SceneRaycaster::Clear()
+{
+    m_Instances.clear();
+    m_PreviousInstances.clear();
+    m_InstanceBounds.clear();
+    m_Bvh.Clear();
+}
+
+void SceneRaycaster::AddInstance(Entity* const entity, const Matrix& worldMatrix, const Model& model)
+{
+    m_Instances.push_back(
+        {
+            .entity = entity,
+            .bound = Bound::GetAabbFromMatrix(model.aabb, worldMatrix),
+            .inverseWorldMatrix = worldMatrix.Inverted(),
+            .model = &model
+        }
+    );
+}
+
+void SceneRaycaster::AddInstance(Entity* const entity, const Bound& bound)
+{
+    m_Instances.push_back({ .entity = entity, .bound = bound });
+}
+
+void SceneRaycaster::Build()
+{
+    m_InstanceBounds.resize(m_Instances.size());
+    for (size_t i = 0; i < m_Instances.size(); i++)
+        m_InstanceBounds[i] = m_Instances[i].bound;
+
+    m_Bvh.Build(m_InstanceBounds);
+}
+
+void SceneRaycaster::Build(Scene& scene)
+{
+    // The Bvh is kept until the new instances are compared with the ones it was built over
+    m_PreviousInstances.swap(m_Instances);
+    m_Instances.clear();
+
+    scene.GetAllComponentsOfType<StaticMeshRenderer>(&m_StaticMeshRenderers);
+    for (StaticMeshRenderer* const meshRenderer : m_StaticMeshRenderers)
+    {
+        if (!meshRenderer->mesh.IsValid())
+            continue;
+
+        // An instance per model of the mesh, their AABB are tighter than the one of the whole mesh
+        const Matrix& worldMatrix = meshRenderer->GetTransform().worldMatrix;
+        for (const Pointer<Model>& model : meshRenderer->mesh->models)
+        {
+            if (model.IsValid() && model->IsLoaded())
+                AddInstance(meshRenderer->GetEntity(), worldMatrix, *model);
+        }
+    }
+
+    scene.GetAllComponentsOfType<SkinnedMeshRenderer>(&m_SkinnedMeshRenderers);
+    for (SkinnedMeshRenderer* const meshRenderer : m_SkinnedMeshRenderers)
+    {
+        if (!meshRenderer->mesh.IsValid())
+            continue;
+
+        Bound bound;
+        meshRenderer->GetAabb(&bound);
+        AddInstance(meshRenderer->GetEntity(), bound);
+    }
+
+    const bool_t isSameInstances = std::ranges::equal(
+        m_Instances,
+        m_PreviousInstances,
+        [](const RaycastInstance& lhs, const RaycastInstance& rhs) -> bool_t { return lhs.entity == rhs.entity && lhs.model == rhs.model; }
+    );
+    if (!isSameInstances)
+    {
+        Build();
+        return;
+    }
+
+    // The same instances keep the same primitives in the tree, only the AABB of its nodes need to follow the ones which moved
+    bool_t moved = false;
+    for (size_t i = 0; i < m_Instances.size(); i++)
+    {
+        if (m_Instances[i].bound == m_InstanceBounds[i])
+            continue;
+
+        m_InstanceBounds[i] = m_Instances[i].bound;
+        moved = true;
+    }
+
+    if (moved)
+        m_Bvh.Refit(m_InstanceBounds);
+}
+
+bool_t SceneRaycaster::Raycast(const Ray& ray, Entity** const entity, float_t* const distance) const
+{
+    uint32_t instance = 0;
+    if (!m_Bvh.Raycast(
+        ray,
+        [&](const uint32_t primitive, float_t* const closestDistance) -> bool_t { return Intersect(m_Instances[primitive], ray, closestDistance); },
+        distance,
+        &instance
+    ))
+    {
+        return false;
+    }
+
+    *entity = m_Instances[instance].entity;
+    return true;
+}
+
+bool_t SceneRaycaster::Intersect(const RaycastInstance& instance, const Ray& ray, float_t* const distance)
+{
+    float_t boundDistance = 0.f;
+    if (!ray.Intersect(instance.bound, *distance, &boundDistance))
+        return false;
+
+    if (!instance.model)
+    {
+        if (boundDistance >= *distance)
+            return false;
+
+        *distance = boundDistance;
+        return true;
+    }
+
+    // The transformed ray keeps the same distances, the hits of all instances can be compared
+    return instance.model->Raycast(ray.Transform(instance.inverseWorldMatrix), distance);
+}
+
+const std::vector<RaycastInstance>& SceneRaycaster::GetInstances() const
+{
+    return m_Instances;
+}
@@ -26,5 +26,9 @@ void World::Update()
     SceneGraph::Update(scene->GetEntities());
 
     scene->OnRendering();
+
+    // The skinned meshes are animated once their components had a chance to change their animations
+    animationSystem.Gather(*scene);
+    animationSystem.Update(Time::GetDeltaTime());
 }
 
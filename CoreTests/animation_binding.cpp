@@ -0,0 +1,215 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <format>
+#include <numbers>
+#include <random>
+
+#include "resource/animation.hpp"
+#include "resource/skeleton.hpp"
+
+namespace
+{
+    constexpr size_t CharacterCount = 500;
+    constexpr size_t BoneCount = 100;
+    constexpr uint32_t KeyCount = 60;
+    constexpr size_t FrameCount = 20;
+
+    // Chain of bones, each one the child of the previous one
+    Pointer<Skeleton> CreateSkeleton(const size_t boneCount)
+    {
+        List<Bone> bones(boneCount);
+        for (size_t i = 0; i < boneCount; i++)
+        {
+            bones[i].name = "Bone_" + std::to_string(i);
+            bones[i].id = static_cast<int32_t>(i);
+            bones[i].parentId = static_cast<int32_t>(i) - 1;
+        }
+
+        Pointer<Skeleton> skeleton = Pointer<Skeleton>::New();
+        skeleton->Load(bones);
+        return skeleton;
+    }
+
+    // Animation of the bones with the given names, in the order of the channels of the file
+    void LoadAnimation(Animation* const animation, const std::vector<std::string>& boneNames)
+    {
+        aiAnimation loadedData;
+        loadedData.mDuration = static_cast<double_t>(KeyCount);
+        loadedData.mTicksPerSecond = 30.0;
+        loadedData.mNumChannels = static_cast<uint32_t>(boneNames.size());
+        loadedData.mChannels = new aiNodeAnim*[boneNames.size()];
+
+        for (size_t i = 0; i < boneNames.size(); i++)
+        {
+            aiNodeAnim* const channel = new aiNodeAnim;
+            channel->mNodeName = aiString(boneNames[i]);
+            channel->mNumPositionKeys = KeyCount;
+            channel->mNumRotationKeys = KeyCount;
+            channel->mNumScalingKeys = 1;
+            channel->mPositionKeys = new aiVectorKey[KeyCount];
+            channel->mRotationKeys = new aiQuatKey[KeyCount];
+            channel->mScalingKeys = new aiVectorKey[1];
+            channel->mScalingKeys[0].mValue = aiVector3D(1.f);
+
+            for (uint32_t key = 0; key < KeyCount; key++)
+            {
+                const float_t angle = std::sin(2.f * std::numbers::pi_v<float_t> * static_cast<float_t>(key) / KeyCount) * static_cast<float_t>(i % 7 + 1) * 0.1f;
+                channel->mPositionKeys[key].mTime = static_cast<double_t>(key);
+                channel->mPositionKeys[key].mValue = aiVector3D(static_cast<float_t>(i), angle, 0.f);
+                channel->mRotationKeys[key].mTime = static_cast<double_t>(key);
+                channel->mRotationKeys[key].mValue = aiQuaternion(std::cos(angle * 0.5f), std::sin(angle * 0.5f), 0.f, 0.f);
+            }
+
+            loadedData.mChannels[i] = channel;
+        }
+
+        animation->Load(loadedData);
+    }
+
+    std::vector<std::string> GetBoneNames(const size_t boneCount)
+    {
+        std::vector<std::string> names(boneCount);
+        for (size_t i = 0; i < boneCount; i++)
+            names[i] = "Bone_" + std::to_string(i);
+
+        return names;
+    }
+
+    // Samples the bones by looking each of them up by name, the way it was done before the tracks were bound
+    void SampleByName(
+        const Animation& animation,
+        const std::unordered_map<std::string, uint32_t>& tracks,
+        const List<Bone>& bones,
+        const float_t normalizedTime,
+        AnimationPose* const pose
+    )
+    {
+        pose->Resize(bones.GetSize());
+        for (size_t i = 0; i < bones.GetSize(); i++)
+        {
+            auto&& it = tracks.find(bones[i].name);
+            if (it == tracks.end())
+                return;
+
+            animation.GetCompressedAnimation().Sample(it->second, normalizedTime, &pose->GetTranslations()[i], &pose->GetRotations()[i], &pose->GetScalings()[i]);
+        }
+    }
+}
+
+TEST(AnimationBinding, Tracks)
+{
+    // The file stores the channels in another order than the skeleton, with a channel for a node which isn't a bone
+    std::vector<std::string> names = GetBoneNames(BoneCount);
+    std::mt19937 random(1);
+    std::ranges::shuffle(names, random);
+    names.emplace_back("Armature");
+
+    Animation animation;
+    LoadAnimation(&animation, names);
+    EXPECT_TRUE(animation.GetBoneTracks().empty());
+
+    const Pointer<Skeleton> skeleton = CreateSkeleton(BoneCount);
+    animation.BindSkeleton(skeleton);
+    EXPECT_TRUE(animation.IsBound());
+
+    const std::vector<uint32_t>& boneTracks = animation.GetBoneTracks();
+    ASSERT_EQ(boneTracks.size(), BoneCount);
+    for (size_t i = 0; i < BoneCount; i++)
+    {
+        ASSERT_NE(boneTracks[i], Animation::InvalidTrack);
+        EXPECT_EQ(animation.GetTrackNames()[boneTracks[i]], skeleton->GetBones()[i].name);
+    }
+
+    // Each bone gets the keys of its own channel
+    AnimationPose pose;
+    ASSERT_TRUE(animation.SamplePose(0.25f, &pose));
+    ASSERT_EQ(pose.GetBoneCount(), BoneCount);
+    for (size_t i = 0; i < BoneCount; i++)
+    {
+        const size_t channel = static_cast<size_t>(std::ranges::find(names, skeleton->GetBones()[i].name) - names.begin());
+        EXPECT_NEAR(pose.GetTranslations()[i].x, static_cast<float_t>(channel), 1e-2f);
+        EXPECT_NEAR(pose.GetScalings()[i].x, 1.f, 1e-3f);
+
+        Vector3 translation;
+        Quaternion rotation;
+        Vector3 scaling;
+        ASSERT_TRUE(animation.SampleBone(i, 0.25f, &translation, &rotation, &scaling));
+        EXPECT_EQ(translation, pose.GetTranslations()[i]);
+    }
+
+    // A bone without a track can't be sampled
+    const Pointer<Skeleton> largerSkeleton = CreateSkeleton(BoneCount + 1);
+    animation.BindSkeleton(largerSkeleton);
+    EXPECT_EQ(animation.GetBoneTracks()[BoneCount], Animation::InvalidTrack);
+    EXPECT_FALSE(animation.SamplePose(0.25f, &pose));
+
+    // Changing the skeleton without binding it again leaves the animation unbound
+    animation.skeleton = skeleton;
+    EXPECT_FALSE(animation.IsBound());
+}
+
+TEST(AnimationBinding, Benchmark)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    std::vector<std::string> names = GetBoneNames(BoneCount);
+    std::mt19937 random(2);
+    std::ranges::shuffle(names, random);
+
+    const Pointer<Skeleton> skeleton = CreateSkeleton(BoneCount);
+    Animation animation;
+    LoadAnimation(&animation, names);
+    animation.BindSkeleton(skeleton);
+
+    std::unordered_map<std::string, uint32_t> tracks;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(animation.GetTrackNames().size()); i++)
+        tracks.emplace(animation.GetTrackNames()[i], i);
+
+    // Each character plays the animation at its own time
+    std::uniform_real_distribution unit(0.f, 1.f);
+    std::vector<float_t> times(CharacterCount);
+    for (float_t& time : times)
+        time = unit(random);
+
+    std::vector<AnimationPose> poses(CharacterCount, AnimationPose(BoneCount));
+    std::vector<AnimationPose> expectedPoses(CharacterCount, AnimationPose(BoneCount));
+
+    const List<Bone>& bones = skeleton->GetBones();
+    const Clock::time_point nameStart = Clock::now();
+    for (size_t frame = 0; frame < FrameCount; frame++)
+    {
+        for (size_t i = 0; i < CharacterCount; i++)
+            SampleByName(animation, tracks, bones, times[i], &expectedPoses[i]);
+    }
+    const double_t nameTime = std::chrono::duration<double_t, std::milli>(Clock::now() - nameStart).count() / FrameCount;
+
+    const Clock::time_point boundStart = Clock::now();
+    for (size_t frame = 0; frame < FrameCount; frame++)
+    {
+        for (size_t i = 0; i < CharacterCount; i++)
+            animation.SamplePose(times[i], &poses[i]);
+    }
+    const double_t boundTime = std::chrono::duration<double_t, std::milli>(Clock::now() - boundStart).count() / FrameCount;
+
+    for (size_t i = 0; i < CharacterCount; i++)
+    {
+        for (size_t j = 0; j < BoneCount; j++)
+        {
+            ASSERT_EQ(poses[i].GetTranslations()[j], expectedPoses[i].GetTranslations()[j]);
+            ASSERT_EQ(poses[i].GetScalings()[j], expectedPoses[i].GetScalings()[j]);
+            const Quaternion& expectedRotation = expectedPoses[i].GetRotations()[j];
+            ASSERT_FLOAT_EQ(Quaternion::Dot(poses[i].GetRotations()[j], expectedRotation), Quaternion::Dot(expectedRotation, expectedRotation));
+        }
+    }
+
+    std::cout << std::format(
+        "{} characters of {} bones: {:.3f} ms per frame looking bones up by name, {:.3f} ms per frame with bound tracks\n",
+        CharacterCount,
+        BoneCount,
+        nameTime,
+        boundTime
+    );
+    RecordProperty("name_lookup_ms", std::format("{:.4f}", nameTime));
+    RecordProperty("bound_ms", std::format("{:.4f}", boundTime));
+}
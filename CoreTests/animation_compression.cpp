@@ -0,0 +1,212 @@
+#include "pch.hpp"
+
+#include <format>
+#include <numbers>
+#include <random>
+
+#include "resource/animation_compression.hpp"
+
+namespace
+{
+    constexpr size_t BoneCount = 60;
+    constexpr size_t KeyCount = 300;
+    constexpr size_t SampleCount = 4000;
+
+    Quaternion FromAxisAngle(const Vector3& axis, const float_t angle)
+    {
+        return Quaternion(axis.Normalized() * std::sin(angle * 0.5f), std::cos(angle * 0.5f));
+    }
+
+    float_t GetRotationError(const Quaternion& a, const Quaternion& b, const float_t errorDistance)
+    {
+        const float_t chord = (Quaternion::Dot(a, b) < 0.f ? a + b : a - b).Length();
+        return 4.f * std::asin(std::min(chord * 0.5f, 1.f)) * errorDistance;
+    }
+
+    // Bones of a character: static ones, ones only rotating, and a root moving forward, with some noise like motion capture
+    std::vector<List<AnimationKeyFrame>> CreateTracks(std::mt19937* const random)
+    {
+        std::uniform_real_distribution axis(-1.f, 1.f);
+        std::uniform_real_distribution noise(-1e-4f, 1e-4f);
+        std::uniform_real_distribution amplitude(0.1f, 1.5f);
+
+        std::vector<List<AnimationKeyFrame>> tracks(BoneCount);
+        for (size_t bone = 0; bone < BoneCount; bone++)
+        {
+            const Vector3 rotationAxis(axis(*random), axis(*random), axis(*random));
+            const Vector3 offset(axis(*random), axis(*random) + 2.f, axis(*random));
+            const float_t rotationAmplitude = amplitude(*random);
+            const float_t frequency = static_cast<float_t>(bone % 4 + 1);
+
+            tracks[bone].Resize(KeyCount);
+            for (size_t key = 0; key < KeyCount; key++)
+            {
+                const float_t phase = 2.f * std::numbers::pi_v<float_t> * static_cast<float_t>(key) / static_cast<float_t>(KeyCount);
+                AnimationKeyFrame& keyFrame = tracks[bone][key];
+                keyFrame.time = static_cast<float_t>(key);
+
+                if (bone == 0)
+                {
+                    // Root motion
+                    keyFrame.translation = Vector3(std::sin(phase) * 0.2f, 1.f + std::sin(phase * 2.f) * 0.05f, static_cast<float_t>(key) * 0.05f);
+                    keyFrame.rotation = FromAxisAngle(Vector3::UnitY(), std::sin(phase) * 0.3f);
+                    continue;
+                }
+
+                // Bones keep their offset to their parent
+                keyFrame.translation = offset + Vector3(noise(*random), noise(*random), noise(*random));
+
+                if (bone % 5 == 0)
+                {
+                    // Bones which don't move, e.g. in the face
+                    keyFrame.rotation = Quaternion::Identity();
+                    keyFrame.translation = Vector3::Zero();
+                    continue;
+                }
+
+                keyFrame.rotation = FromAxisAngle(rotationAxis, std::sin(phase * frequency) * rotationAmplitude + noise(*random));
+            }
+        }
+
+        return tracks;
+    }
+
+    // Maximum error between the source and compressed keys, in bone space units
+    float_t GetMaxError(const std::vector<List<AnimationKeyFrame>>& tracks, const CompressedAnimation& compressed, const AnimationCompressionSettings& settings)
+    {
+        float_t maxError = 0.f;
+        for (size_t bone = 0; bone < tracks.size(); bone++)
+        {
+            for (size_t i = 0; i < SampleCount; i++)
+            {
+                const float_t time = static_cast<float_t>(i) / static_cast<float_t>(SampleCount);
+                const AnimationKeyFrame expected = CompressedAnimation::Sample(tracks[bone], time);
+
+                Vector3 translation;
+                Quaternion rotation;
+                Vector3 scaling;
+                compressed.Sample(bone, time, &translation, &rotation, &scaling);
+
+                maxError = std::max(maxError, (translation - expected.translation).Length());
+                maxError = std::max(maxError, GetRotationError(rotation, expected.rotation, settings.errorDistance));
+                maxError = std::max(maxError, (scaling - expected.scaling).Length() * settings.errorDistance);
+            }
+        }
+
+        return maxError;
+    }
+}
+
+TEST(AnimationCompression, QuantizedQuaternion)
+{
+    std::mt19937 random(1);
+    std::normal_distribution component(0.f, 1.f);
+
+    float_t maxError = 0.f;
+    for (size_t i = 0; i < 10000; i++)
+    {
+        const Quaternion quaternion = Quaternion(component(random), component(random), component(random), component(random)).Normalized();
+        const Quaternion dequantized = QuantizedQuaternion::Quantize(quaternion).Dequantize();
+
+        EXPECT_NEAR(dequantized.Length(), 1.f, 1e-4f);
+        maxError = std::max(maxError, GetRotationError(quaternion, dequantized, 1.f));
+    }
+
+    // 15 bits per component
+    EXPECT_LT(maxError, 2e-4f);
+
+    // The largest component is made positive, which is the same rotation
+    const Quaternion negative = -FromAxisAngle(Vector3::UnitX(), 0.5f);
+    EXPECT_LT(GetRotationError(QuantizedQuaternion::Quantize(negative).Dequantize(), negative, 1.f), 2e-4f);
+    EXPECT_GT(QuantizedQuaternion::Quantize(negative).Dequantize().W(), 0.f);
+}
+
+TEST(AnimationCompression, QuantizedVector3)
+{
+    const Vector3 rangeMin(-10.f, 0.f, 5.f);
+    const Vector3 rangeExtent(20.f, 0.f, 1.f);
+
+    std::mt19937 random(2);
+    std::uniform_real_distribution unit(0.f, 1.f);
+    for (size_t i = 0; i < 1000; i++)
+    {
+        const Vector3 vector(rangeMin.x + unit(random) * rangeExtent.x, rangeMin.y, rangeMin.z + unit(random) * rangeExtent.z);
+        const Vector3 dequantized = QuantizedVector3::Quantize(vector, rangeMin, rangeExtent).Dequantize(rangeMin, rangeExtent);
+
+        EXPECT_NEAR(dequantized.x, vector.x, rangeExtent.x / 65535.f);
+        // An empty range gives back its minimum
+        EXPECT_FLOAT_EQ(dequantized.y, vector.y);
+        EXPECT_NEAR(dequantized.z, vector.z, rangeExtent.z / 65535.f);
+    }
+}
+
+TEST(AnimationCompression, ConstantTracks)
+{
+    std::vector<List<AnimationKeyFrame>> tracks(2);
+    tracks[0] = List<AnimationKeyFrame>(KeyCount);
+    tracks[1] = List<AnimationKeyFrame>(KeyCount);
+    for (size_t key = 0; key < KeyCount; key++)
+    {
+        tracks[1][key].translation = Vector3(1.f, 2.f, 3.f);
+        tracks[1][key].rotation = FromAxisAngle(Vector3::UnitZ(), 1.f);
+    }
+
+    CompressedAnimation compressed;
+    compressed.Compress(tracks);
+
+    // A single key for the constant rotation and translation of the second bone, nothing for the rest which is the default pose
+    EXPECT_EQ(compressed.GetKeyCount(), 2);
+
+    Vector3 translation;
+    Quaternion rotation;
+    Vector3 scaling;
+    compressed.Sample(0, 0.3f, &translation, &rotation, &scaling);
+    EXPECT_EQ(translation, Vector3::Zero());
+    EXPECT_EQ(scaling, Vector3(1.f));
+    EXPECT_FLOAT_EQ(rotation.W(), 1.f);
+
+    compressed.Sample(1, 0.7f, &translation, &rotation, &scaling);
+    EXPECT_EQ(translation, Vector3(1.f, 2.f, 3.f));
+    EXPECT_LT(GetRotationError(rotation, tracks[1][0].rotation, 1.f), 2e-4f);
+}
+
+TEST(AnimationCompression, RatioAndError)
+{
+    std::mt19937 random(3);
+    const std::vector<List<AnimationKeyFrame>> tracks = CreateTracks(&random);
+    const size_t sourceSize = BoneCount * KeyCount * sizeof(AnimationKeyFrame);
+
+    // Quantization only
+    AnimationCompressionSettings settings;
+    settings.reduceKeys = false;
+    CompressedAnimation quantized;
+    quantized.Compress(tracks, settings);
+    const float_t quantizedError = GetMaxError(tracks, quantized, settings);
+    EXPECT_LE(quantizedError, settings.maxError);
+
+    // Key reduction
+    settings.reduceKeys = true;
+    CompressedAnimation compressed;
+    compressed.Compress(tracks, settings);
+    const float_t compressedError = GetMaxError(tracks, compressed, settings);
+    EXPECT_LE(compressedError, settings.maxError * 1.01f);
+    EXPECT_LT(compressed.GetMemorySize(), quantized.GetMemorySize());
+
+    const float_t quantizedRatio = static_cast<float_t>(sourceSize) / static_cast<float_t>(quantized.GetMemorySize());
+    const float_t compressedRatio = static_cast<float_t>(sourceSize) / static_cast<float_t>(compressed.GetMemorySize());
+    EXPECT_GT(compressedRatio, 10.f);
+
+    std::cout << std::format(
+        "{} bones, {} keys: {} bytes, {:.1f}x with quantization ({:.5f} max error), {:.1f}x with key reduction ({} keys kept, {:.5f} max error)\n",
+        BoneCount,
+        KeyCount,
+        sourceSize,
+        quantizedRatio,
+        quantizedError,
+        compressedRatio,
+        compressed.GetKeyCount(),
+        compressedError
+    );
+    RecordProperty("compression_ratio", std::format("{:.2f}", compressedRatio));
+    RecordProperty("max_error", std::format("{:.6f}", compressedError));
+}
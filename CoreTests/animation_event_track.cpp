@@ -0,0 +1,167 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <format>
+
+#include "rendering/animation_event_track.hpp"
+
+namespace
+{
+    constexpr float_t DeltaTime = 1.f / 60.f;
+
+    // Track of 1 second with events at 0, 0.25, 0.5 and 1, each one recording its index when fired
+    AnimationEventTrack CreateTrack(std::vector<size_t>* const fired)
+    {
+        AnimationEventTrack track;
+        track.SetDuration(1.f);
+
+        // Added out of order
+        track.Add(0.5f, [fired]() -> void { fired->push_back(2); });
+        track.Add(0.f, [fired]() -> void { fired->push_back(0); });
+        track.Add(1.f, [fired]() -> void { fired->push_back(3); });
+        track.Add(0.25f, [fired]() -> void { fired->push_back(1); });
+
+        return track;
+    }
+
+    double_t AdvanceFrames(AnimationEventTrack* const track, const size_t frameCount, size_t* const firedCount)
+    {
+        using Clock = std::chrono::high_resolution_clock;
+
+        const Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < frameCount; i++)
+            *firedCount += track->Advance(DeltaTime, true);
+
+        return std::chrono::duration<double_t, std::milli>(Clock::now() - start).count() / static_cast<double_t>(frameCount);
+    }
+}
+
+TEST(AnimationEventTrack, Order)
+{
+    std::vector<size_t> fired;
+    AnimationEventTrack track = CreateTrack(&fired);
+
+    EXPECT_EQ(track.Advance(0.1f, false), 1);
+    EXPECT_EQ(track.Advance(0.1f, false), 0);
+    EXPECT_EQ(track.Advance(0.3f, false), 1);
+    EXPECT_EQ(fired, (std::vector<size_t>{ 0, 1 }));
+
+    // The event at the end is fired when the end is reached, then the track stays there
+    EXPECT_EQ(track.Advance(1.f, false), 2);
+    EXPECT_EQ(track.Advance(1.f, false), 0);
+    EXPECT_EQ(fired, (std::vector<size_t>{ 0, 1, 2, 3 }));
+    EXPECT_FLOAT_EQ(track.GetTime(), 1.f);
+
+    // The events at the same time are fired in the order they were added
+    fired.clear();
+    track.Add(0.5f, [&fired]() -> void { fired.push_back(4); });
+    track.Seek(0.4f);
+    EXPECT_EQ(track.GetCursor(), 2);
+    EXPECT_EQ(track.Advance(0.2f, false), 2);
+    EXPECT_EQ(fired, (std::vector<size_t>{ 2, 4 }));
+
+    // Nothing is fired backward
+    EXPECT_EQ(track.Advance(-0.5f, false), 0);
+    EXPECT_FLOAT_EQ(track.GetTime(), 0.6f);
+}
+
+TEST(AnimationEventTrack, LoopBoundary)
+{
+    std::vector<size_t> fired;
+    AnimationEventTrack track = CreateTrack(&fired);
+
+    track.Seek(0.9f);
+    fired.clear();
+
+    // The step over the end fires the events of the end of the loop, then the ones of the start of the next one
+    EXPECT_EQ(track.Advance(0.2f, true), 2);
+    EXPECT_EQ(fired, (std::vector<size_t>{ 3, 0 }));
+    EXPECT_NEAR(track.GetTime(), 0.1f, 1e-5f);
+
+    // An event added before the current time waits for the next loop
+    fired.clear();
+    track.Add(0.05f, [&fired]() -> void { fired.push_back(5); });
+    EXPECT_EQ(track.Advance(0.5f, true), 2);
+    EXPECT_EQ(fired, (std::vector<size_t>{ 1, 2 }));
+
+    fired.clear();
+    EXPECT_EQ(track.Advance(0.5f, true), 3);
+    EXPECT_EQ(fired, (std::vector<size_t>{ 3, 0, 5 }));
+
+    // Frame by frame, each event is fired once per loop
+    fired.clear();
+    track.Seek(0.f);
+    size_t firedCount = 0;
+    for (size_t i = 0; i < 180; i++)
+        firedCount += track.Advance(DeltaTime, true);
+
+    EXPECT_EQ(firedCount, fired.size());
+    EXPECT_EQ(std::ranges::count(fired, 2), 3);
+    EXPECT_EQ(std::ranges::count(fired, 5), 3);
+}
+
+TEST(AnimationEventTrack, LargeStep)
+{
+    std::vector<size_t> fired;
+    AnimationEventTrack track = CreateTrack(&fired);
+
+    // A hitch of 2.6 loops fires every event it went through, in order
+    track.Seek(0.3f);
+    EXPECT_EQ(track.Advance(2.6f, true), 9);
+    EXPECT_EQ(fired, (std::vector<size_t>{ 2, 3, 0, 1, 2, 3, 0, 1, 2 }));
+    EXPECT_NEAR(track.GetTime(), 0.9f, 1e-5f);
+
+    // Without looping, the step stops at the end
+    fired.clear();
+    track.Seek(0.3f);
+    EXPECT_EQ(track.Advance(2.6f, false), 2);
+    EXPECT_EQ(fired, (std::vector<size_t>{ 2, 3 }));
+    EXPECT_FLOAT_EQ(track.GetTime(), 1.f);
+
+    // Without a duration, the time isn't wrapped
+    AnimationEventTrack unbounded;
+    size_t count = 0;
+    unbounded.Add(5.f, [&count]() -> void { count++; });
+    EXPECT_EQ(unbounded.Advance(4.f, true), 0);
+    EXPECT_EQ(unbounded.Advance(4.f, true), 1);
+    EXPECT_EQ(unbounded.Advance(4.f, true), 0);
+    EXPECT_EQ(count, 1);
+}
+
+TEST(AnimationEventTrack, Benchmark)
+{
+    constexpr size_t FrameCount = 600;
+    constexpr std::array<size_t, 2> EventCounts = { 10, 100000 };
+
+    std::array<double_t, EventCounts.size()> times{};
+    for (size_t i = 0; i < EventCounts.size(); i++)
+    {
+        AnimationEventTrack track;
+        track.SetDuration(20.f);
+
+        // The events are after the frames, so only the cost of looking for them is measured
+        size_t called = 0;
+        for (size_t j = 0; j < EventCounts[i]; j++)
+            track.Add(10.5f + static_cast<float_t>(j) * 9.f / static_cast<float_t>(EventCounts[i]), [&called]() -> void { called++; });
+
+        size_t firedCount = 0;
+        times[i] = AdvanceFrames(&track, FrameCount, &firedCount);
+        EXPECT_EQ(firedCount, 0);
+
+        // The rest of the loop then fires every event once
+        firedCount += track.Advance(track.GetDuration() - track.GetTime(), false);
+        EXPECT_EQ(firedCount, EventCounts[i]);
+        EXPECT_EQ(called, EventCounts[i]);
+    }
+
+    std::cout << std::format(
+        "{} frames between events: {:.5f} ms per frame with {} events, {:.5f} ms per frame with {} events\n",
+        FrameCount,
+        times[0],
+        EventCounts[0],
+        times[1],
+        EventCounts[1]
+    );
+    RecordProperty("small_ms", std::format("{:.5f}", times[0]));
+    RecordProperty("large_ms", std::format("{:.5f}", times[1]));
+}
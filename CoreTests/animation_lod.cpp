@@ -0,0 +1,282 @@
+#include "pch.hpp"
+
+#include <format>
+#include <random>
+
+#include "rendering/animation_pose.hpp"
+#include "rendering/animation_system.hpp"
+#include "resource/animation.hpp"
+#include "resource/skeleton.hpp"
+
+namespace
+{
+    constexpr uint32_t KeyCount = 30;
+    constexpr float_t DeltaTime = 1.f / 60.f;
+
+    // Root -> spine -> neck -> head, with an arm on the spine
+    //   0  ->   1   ->  2   ->  3
+    //           1   ->  4
+    Pointer<Skeleton> CreateSkeleton()
+    {
+        constexpr std::array<int32_t, 5> parents = { -1, 0, 1, 2, 1 };
+
+        List<Bone> bones(parents.size());
+        for (size_t i = 0; i < parents.size(); i++)
+        {
+            bones[i].name = "Bone_" + std::to_string(i);
+            bones[i].id = static_cast<int32_t>(i);
+            bones[i].parentId = parents[i];
+            bones[i].global = Matrix::Identity();
+        }
+
+        Pointer<Skeleton> skeleton = Pointer<Skeleton>::New();
+        skeleton->Load(bones);
+        return skeleton;
+    }
+
+    Pointer<Animation> CreateAnimation(const Pointer<Skeleton>& skeleton, std::mt19937* const random)
+    {
+        std::normal_distribution component(0.f, 1.f);
+        std::uniform_real_distribution position(-1.f, 1.f);
+
+        const size_t boneCount = skeleton->GetBones().GetSize();
+
+        aiAnimation loadedData;
+        loadedData.mDuration = static_cast<double_t>(KeyCount);
+        loadedData.mTicksPerSecond = 30.0;
+        loadedData.mNumChannels = static_cast<uint32_t>(boneCount);
+        loadedData.mChannels = new aiNodeAnim*[boneCount];
+
+        for (size_t i = 0; i < boneCount; i++)
+        {
+            aiNodeAnim* const channel = new aiNodeAnim;
+            channel->mNodeName = aiString(skeleton->GetBones()[i].name);
+            channel->mNumPositionKeys = KeyCount;
+            channel->mNumRotationKeys = KeyCount;
+            channel->mNumScalingKeys = 1;
+            channel->mPositionKeys = new aiVectorKey[KeyCount];
+            channel->mRotationKeys = new aiQuatKey[KeyCount];
+            channel->mScalingKeys = new aiVectorKey[1];
+            channel->mScalingKeys[0].mValue = aiVector3D(1.f);
+
+            for (uint32_t key = 0; key < KeyCount; key++)
+            {
+                channel->mPositionKeys[key].mTime = static_cast<double_t>(key);
+                channel->mPositionKeys[key].mValue = aiVector3D(position(*random), position(*random), position(*random));
+                channel->mRotationKeys[key].mTime = static_cast<double_t>(key);
+                channel->mRotationKeys[key].mValue = aiQuaternion(component(*random), component(*random), component(*random), component(*random)).Normalize();
+            }
+
+            loadedData.mChannels[i] = channel;
+        }
+
+        Pointer<Animation> animation = Pointer<Animation>::New();
+        animation->Load(loadedData);
+        animation->skeleton = skeleton;
+        return animation;
+    }
+
+    // Camera at the origin, looking towards -Z
+    Camera CreateCamera()
+    {
+        Camera camera;
+        camera.position = Vector3::Zero();
+        return camera;
+    }
+
+    // Character about 2 meters high in front of the camera
+    Bound CreateBound(const float_t distance)
+    {
+        return Bound(Vector3(0.f, 0.f, -distance), Vector3(1.f, 2.f, 1.f));
+    }
+}
+
+TEST(AnimationLod, LeafLevels)
+{
+    std::mt19937 random(1);
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    Pointer<Animation> animation = CreateAnimation(skeleton, &random);
+    animation->BindSkeleton(skeleton);
+
+    EXPECT_EQ(animation->GetSampledBoneCount(0), 5);
+    // Head and arm
+    EXPECT_EQ(animation->GetSampledBoneCount(1), 3);
+    // Neck
+    EXPECT_EQ(animation->GetSampledBoneCount(2), 2);
+    EXPECT_EQ(animation->GetSampledBoneCount(4), 0);
+
+    AnimationPose complete;
+    ASSERT_TRUE(animation->SamplePose(0.5f, &complete));
+
+    // The skipped bones keep their previous transform
+    AnimationPose pose(5);
+    ASSERT_TRUE(animation->SamplePose(0.5f, &pose, 1));
+    for (size_t i = 0; i < 5; i++)
+    {
+        const bool_t isLeaf = i == 3 || i == 4;
+        const Vector3 expected = isLeaf ? Vector3::Zero() : complete.GetTranslations()[i];
+        EXPECT_EQ(pose.GetTranslations()[i], expected) << std::format("Bone {}", i);
+    }
+}
+
+TEST(AnimationLod, Levels)
+{
+    AnimationSystem system;
+
+    // Without a view, every character is animated at full rate
+    EXPECT_EQ(system.GetLod(CreateBound(1000.f)), 0);
+
+    const Camera camera = CreateCamera();
+    system.AddView(camera, Vector2i(1920, 1080));
+
+    EXPECT_EQ(system.GetLod(CreateBound(2.f)), 0);
+    EXPECT_EQ(system.GetLod(CreateBound(8.f)), 1);
+    EXPECT_EQ(system.GetLod(CreateBound(30.f)), 2);
+    EXPECT_EQ(system.GetLod(CreateBound(200.f)), 3);
+    // Behind the camera
+    EXPECT_EQ(system.GetLod(CreateBound(-8.f)), 3);
+    // No bound
+    EXPECT_EQ(system.GetLod(Bound()), 0);
+
+    // The closest view wins
+    Camera closeCamera = CreateCamera();
+    closeCamera.position = Vector3(0.f, 0.f, -26.f);
+    system.AddView(closeCamera, Vector2i(1920, 1080));
+    EXPECT_EQ(system.GetLod(CreateBound(30.f)), 0);
+
+    EXPECT_GT(AnimationSystem::GetScreenSize(camera, CreateBound(2.f)), AnimationSystem::GetScreenSize(camera, CreateBound(4.f)));
+}
+
+TEST(AnimationLod, Stagger)
+{
+    constexpr size_t CharacterCount = 16;
+    constexpr size_t FrameCount = 8;
+
+    std::mt19937 random(2);
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    const Pointer<Animation> animation = CreateAnimation(skeleton, &random);
+
+    // Half of the characters every 2 frames, the other half every 4 frames
+    std::vector<Animator> animators;
+    animators.reserve(CharacterCount);
+    AnimationSystem system;
+    for (size_t i = 0; i < CharacterCount; i++)
+        system.Add(&animators.emplace_back(animation), CreateBound(i % 2 == 0 ? 8.f : 30.f));
+
+    for (size_t frame = 0; frame < FrameCount; frame++)
+    {
+        system.AddView(CreateCamera(), Vector2i(1920, 1080));
+        system.Update(DeltaTime, false);
+
+        const AnimationStats& stats = system.GetStats();
+        EXPECT_EQ(stats.animatorCount, CharacterCount);
+        EXPECT_EQ(stats.lodAnimatorCounts[1], CharacterCount / 2);
+        EXPECT_EQ(stats.lodAnimatorCounts[2], CharacterCount / 2);
+        EXPECT_EQ(stats.boneCount, CharacterCount * 5);
+
+        // The updates are spread evenly over the frames
+        EXPECT_EQ(stats.updatedAnimatorCount, CharacterCount / 4 + CharacterCount / 8) << std::format("Frame {}", frame);
+    }
+
+    const AnimationStats& stats = system.GetStats();
+    // Level 1 skips the leaves and level 2 also skips the neck, after a first complete pose
+    EXPECT_EQ(stats.animatedBoneCount, CharacterCount / 4 * 3 + CharacterCount / 8 * 2);
+    EXPECT_LT(stats.animatedBoneCount, stats.boneCount);
+
+    // Out of the view, the characters are paused
+    Camera otherWay = CreateCamera();
+    otherWay.front = Vector3::UnitZ();
+    otherWay.right = -Vector3::UnitX();
+    system.AddView(otherWay, Vector2i(1920, 1080));
+    system.Update(DeltaTime, false);
+    EXPECT_EQ(system.GetStats().updatedAnimatorCount, 0);
+    EXPECT_EQ(system.GetStats().lodAnimatorCounts[3], CharacterCount);
+    EXPECT_EQ(system.GetStats().animatedBoneCount, 0);
+
+    // Without a view, they are all animated at full rate
+    system.Update(DeltaTime, false);
+    EXPECT_EQ(system.GetStats().updatedAnimatorCount, CharacterCount);
+    EXPECT_EQ(system.GetStats().lodAnimatorCounts[0], CharacterCount);
+}
+
+TEST(AnimationLod, StablePhase)
+{
+    constexpr size_t CharacterCount = 4;
+
+    std::mt19937 random(3);
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    const Pointer<Animation> animation = CreateAnimation(skeleton, &random);
+
+    std::vector<Animator> animators;
+    animators.reserve(CharacterCount);
+    for (size_t i = 0; i < CharacterCount; i++)
+        animators.emplace_back(animation).Animate(DeltaTime);
+
+    // All the characters are updated every 2 frames, and are added in another order in the second frame
+    AnimationSystem system;
+    std::array<size_t, CharacterCount> updateCounts{};
+    for (size_t frame = 0; frame < 2; frame++)
+    {
+        std::vector<std::vector<Matrix>> previousMatrices;
+        for (const Animator& animator : animators)
+            previousMatrices.emplace_back(animator.GetMatrices().begin(), animator.GetMatrices().end());
+
+        system.Clear();
+        for (size_t i = 0; i < CharacterCount; i++)
+            system.Add(&animators[frame == 0 ? i : CharacterCount - 1 - i], CreateBound(8.f));
+
+        system.AddView(CreateCamera(), Vector2i(1920, 1080));
+        system.Update(DeltaTime, false);
+        EXPECT_EQ(system.GetStats().updatedAnimatorCount, CharacterCount / 2);
+
+        for (size_t i = 0; i < CharacterCount; i++)
+        {
+            if (previousMatrices[i] != std::vector<Matrix>(animators[i].GetMatrices().begin(), animators[i].GetMatrices().end()))
+                updateCounts[i]++;
+        }
+    }
+
+    // Each character was updated once, none of them was held twice in a row
+    for (size_t i = 0; i < CharacterCount; i++)
+        EXPECT_EQ(updateCounts[i], 1) << std::format("Animator {}", i);
+}
+
+TEST(AnimationLod, Hold)
+{
+    std::mt19937 random(3);
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    const Pointer<Animation> animation = CreateAnimation(skeleton, &random);
+
+    Animator everyFrame(animation);
+    Animator everyFourFrames(animation);
+    everyFrame.Animate(DeltaTime);
+    everyFourFrames.Animate(DeltaTime);
+
+    for (size_t frame = 1; frame < 4; frame++)
+    {
+        everyFrame.Animate(DeltaTime);
+        everyFourFrames.Hold(DeltaTime);
+    }
+
+    const std::vector<Matrix> heldMatrices(everyFourFrames.GetMatrices().begin(), everyFourFrames.GetMatrices().end());
+    ASSERT_EQ(heldMatrices.size(), 5);
+
+    everyFrame.Animate(DeltaTime);
+    everyFourFrames.Animate(DeltaTime);
+
+    // The held animator catches up with the time it missed
+    bool_t changed = false;
+    for (size_t i = 0; i < 5; i++)
+    {
+        for (size_t j = 0; j < 4; j++)
+        {
+            for (size_t k = 0; k < 4; k++)
+            {
+                EXPECT_NEAR(everyFourFrames.GetMatrices()[i][j][k], everyFrame.GetMatrices()[i][j][k], 1e-4f) << std::format("Bone {}", i);
+                changed |= heldMatrices[i][j][k] != everyFourFrames.GetMatrices()[i][j][k];
+            }
+        }
+    }
+
+    EXPECT_TRUE(changed);
+}
@@ -0,0 +1,230 @@
+#include "pch.hpp"
+
+#include <atomic>
+#include <format>
+#include <numbers>
+#include <random>
+
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
+#include "rendering/animation_pose.hpp"
+#include "rendering/animator.hpp"
+#include "resource/animation.hpp"
+#include "resource/skeleton.hpp"
+
+namespace
+{
+    constexpr size_t BoneCount = 67;
+    constexpr uint32_t KeyCount = 30;
+
+    Quaternion CreateRotation(std::mt19937* const random)
+    {
+        std::normal_distribution component(0.f, 1.f);
+        return Quaternion(component(*random), component(*random), component(*random), component(*random)).Normalized();
+    }
+
+    void FillPose(AnimationPose* const pose, std::mt19937* const random)
+    {
+        std::uniform_real_distribution position(-5.f, 5.f);
+        std::uniform_real_distribution scale(0.5f, 2.f);
+
+        for (size_t i = 0; i < pose->GetBoneCount(); i++)
+        {
+            pose->GetTranslations()[i] = Vector3(position(*random), position(*random), position(*random));
+            pose->GetRotations()[i] = CreateRotation(random);
+            pose->GetScalings()[i] = Vector3(scale(*random), scale(*random), scale(*random));
+        }
+    }
+
+    Quaternion Nlerp(const Quaternion& a, Quaternion b, const float_t t)
+    {
+        if (Quaternion::Dot(a, b) < 0.f)
+            b = -b;
+
+        return Quaternion(
+            a.X() + (b.X() - a.X()) * t,
+            a.Y() + (b.Y() - a.Y()) * t,
+            a.Z() + (b.Z() - a.Z()) * t,
+            a.W() + (b.W() - a.W()) * t
+        ).Normalized();
+    }
+
+    void ExpectNear(const Matrix& matrix, const Matrix& expected, const float_t tolerance)
+    {
+        for (size_t i = 0; i < 4; i++)
+        {
+            for (size_t j = 0; j < 4; j++)
+                EXPECT_NEAR(matrix[i][j], expected[i][j], tolerance) << std::format("Component {}, {}", i, j);
+        }
+    }
+
+    // Tree of bones where each bone is the child of one of the previous ones
+    List<Bone> CreateBones(std::mt19937* const random)
+    {
+        List<Bone> bones(BoneCount);
+        for (size_t i = 0; i < BoneCount; i++)
+        {
+            bones[i].name = "Bone_" + std::to_string(i);
+            bones[i].id = static_cast<int32_t>(i);
+            bones[i].parentId = i == 0 ? -1 : static_cast<int32_t>((*random)() % i);
+            bones[i].global = Matrix::Trs(Vector3(0.f, -static_cast<float_t>(i), 0.f), Vector3::Zero(), Vector3(1.f));
+        }
+
+        return bones;
+    }
+
+    void LoadAnimation(Animation* const animation, const List<Bone>& bones, std::mt19937* const random)
+    {
+        aiAnimation loadedData;
+        loadedData.mDuration = static_cast<double_t>(KeyCount);
+        loadedData.mTicksPerSecond = 30.0;
+        loadedData.mNumChannels = static_cast<uint32_t>(bones.GetSize());
+        loadedData.mChannels = new aiNodeAnim*[bones.GetSize()];
+
+        for (size_t i = 0; i < bones.GetSize(); i++)
+        {
+            aiNodeAnim* const channel = new aiNodeAnim;
+            channel->mNodeName = aiString(bones[i].name);
+            channel->mNumPositionKeys = KeyCount;
+            channel->mNumRotationKeys = KeyCount;
+            channel->mNumScalingKeys = 1;
+            channel->mPositionKeys = new aiVectorKey[KeyCount];
+            channel->mRotationKeys = new aiQuatKey[KeyCount];
+            channel->mScalingKeys = new aiVectorKey[1];
+            channel->mScalingKeys[0].mValue = aiVector3D(1.f);
+
+            for (uint32_t key = 0; key < KeyCount; key++)
+            {
+                const Quaternion rotation = CreateRotation(random);
+                channel->mPositionKeys[key].mTime = static_cast<double_t>(key);
+                channel->mPositionKeys[key].mValue = aiVector3D(0.f, 1.f, static_cast<float_t>(key) * 0.01f);
+                channel->mRotationKeys[key].mTime = static_cast<double_t>(key);
+                channel->mRotationKeys[key].mValue = aiQuaternion(rotation.W(), rotation.X(), rotation.Y(), rotation.Z());
+            }
+
+            loadedData.mChannels[i] = channel;
+        }
+
+        animation->Load(loadedData);
+    }
+
+#ifdef _DEBUG
+    std::atomic<size_t> allocationCount = 0;
+
+    // Counts the allocations of the whole process, the engine being a separate module which shares the debug runtime
+    int32_t CountAllocations(
+        const int32_t allocationType,
+        void* const,
+        const size_t,
+        const int32_t blockType,
+        const long,
+        const unsigned char* const,
+        const int32_t
+    )
+    {
+        if (_BLOCK_TYPE(blockType) != _CRT_BLOCK && (allocationType == _HOOK_ALLOC || allocationType == _HOOK_REALLOC))
+            allocationCount++;
+
+        return 1;
+    }
+#endif
+}
+
+TEST(AnimationPose, Blend)
+{
+    std::mt19937 random(1);
+    AnimationPose from(BoneCount);
+    AnimationPose to(BoneCount);
+    FillPose(&from, &random);
+    FillPose(&to, &random);
+
+    // The same rotation on the other hemisphere takes the shortest path
+    to.GetRotations()[1] = -from.GetRotations()[1];
+
+    for (const float_t t : { 0.f, 0.3f, 0.5f, 1.f })
+    {
+        AnimationPose result;
+        AnimationPose::Blend(from, to, t, &result);
+        ASSERT_EQ(result.GetBoneCount(), BoneCount);
+
+        for (size_t i = 0; i < BoneCount; i++)
+        {
+            const Vector3 translation = Vector3::Lerp(from.GetTranslations()[i], to.GetTranslations()[i], t);
+            const Vector3 scaling = Vector3::Lerp(from.GetScalings()[i], to.GetScalings()[i], t);
+            const Quaternion rotation = Nlerp(from.GetRotations()[i], to.GetRotations()[i], t);
+
+            EXPECT_NEAR((result.GetTranslations()[i] - translation).Length(), 0.f, 1e-5f) << std::format("Bone {} at {}", i, t);
+            EXPECT_NEAR((result.GetScalings()[i] - scaling).Length(), 0.f, 1e-5f) << std::format("Bone {} at {}", i, t);
+            EXPECT_NEAR(Quaternion::Dot(result.GetRotations()[i], rotation), 1.f, 1e-5f) << std::format("Bone {} at {}", i, t);
+        }
+
+        EXPECT_NEAR(Quaternion::Dot(result.GetRotations()[1], from.GetRotations()[1]), 1.f, 1e-5f);
+    }
+
+    // In place
+    AnimationPose::Blend(from, to, 1.f, &from);
+    for (size_t i = 0; i < BoneCount; i++)
+        EXPECT_NEAR((from.GetTranslations()[i] - to.GetTranslations()[i]).Length(), 0.f, 1e-5f);
+}
+
+TEST(AnimationPose, Matrices)
+{
+    std::mt19937 random(2);
+    const List<Bone> bones = CreateBones(&random);
+    AnimationPose pose(BoneCount);
+    FillPose(&pose, &random);
+
+    std::vector<Matrix> modelMatrices(BoneCount);
+    std::vector<Matrix> skinningMatrices(BoneCount);
+    pose.ComputeMatrices(bones, modelMatrices.data(), skinningMatrices.data());
+
+    // Each bone goes through the local transforms of all its parents
+    for (size_t i = 0; i < BoneCount; i++)
+    {
+        Matrix expected = Matrix::Identity();
+        for (int32_t bone = static_cast<int32_t>(i); bone != -1; bone = bones[bone].parentId)
+            expected = Matrix::Trs(pose.GetTranslations()[bone], pose.GetRotations()[bone], pose.GetScalings()[bone]) * expected;
+
+        ExpectNear(modelMatrices[i], expected, 1e-2f);
+        ExpectNear(skinningMatrices[i], modelMatrices[i] * bones[i].global, 1e-4f);
+    }
+}
+
+TEST(AnimationPose, SteadyStateAllocations)
+{
+#ifndef _DEBUG
+    GTEST_SKIP() << "Allocations are counted with the hooks of the debug runtime";
+#else
+    std::mt19937 random(3);
+
+    Pointer<Skeleton> skeleton = Pointer<Skeleton>::New();
+    skeleton->Load(CreateBones(&random));
+
+    Pointer<Animation> walk = Pointer<Animation>::New();
+    LoadAnimation(walk.Get(), skeleton->GetBones(), &random);
+    walk->BindSkeleton(skeleton);
+
+    Pointer<Animation> run = Pointer<Animation>::New();
+    LoadAnimation(run.Get(), skeleton->GetBones(), &random);
+    run->BindSkeleton(skeleton);
+
+    Animator animator(walk);
+    Animator blendTarget(run);
+    animator.StartBlending(&blendTarget);
+    animator.SetCrossFadeDelta(0.5f);
+
+    // The first frame might size the buffers
+    animator.Animate();
+
+    allocationCount = 0;
+    const _CRT_ALLOC_HOOK previousHook = _CrtSetAllocHook(CountAllocations);
+    for (size_t frame = 0; frame < 100; frame++)
+        animator.Animate();
+    _CrtSetAllocHook(previousHook);
+
+    EXPECT_EQ(allocationCount, 0);
+    RecordProperty("allocations_per_frame", static_cast<int32_t>(allocationCount / 100));
+#endif
+}
@@ -0,0 +1,183 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <random>
+#include <thread>
+
+#include "rendering/animation_system.hpp"
+#include "resource/animation.hpp"
+#include "resource/skeleton.hpp"
+
+namespace
+{
+    constexpr size_t CharacterCount = 1000;
+    constexpr size_t BoneCount = 60;
+    constexpr size_t AnimationCount = 4;
+    constexpr uint32_t KeyCount = 40;
+    constexpr size_t FrameCount = 10;
+    constexpr float_t DeltaTime = 1.f / 60.f;
+
+    Pointer<Skeleton> CreateSkeleton(std::mt19937* const random)
+    {
+        List<Bone> bones(BoneCount);
+        for (size_t i = 0; i < BoneCount; i++)
+        {
+            bones[i].name = "Bone_" + std::to_string(i);
+            bones[i].id = static_cast<int32_t>(i);
+            bones[i].parentId = i == 0 ? -1 : static_cast<int32_t>((*random)() % i);
+        }
+
+        Pointer<Skeleton> skeleton = Pointer<Skeleton>::New();
+        skeleton->Load(bones);
+        return skeleton;
+    }
+
+    Pointer<Animation> CreateAnimation(const Pointer<Skeleton>& skeleton, std::mt19937* const random)
+    {
+        std::normal_distribution component(0.f, 1.f);
+        std::uniform_real_distribution position(-1.f, 1.f);
+
+        aiAnimation loadedData;
+        loadedData.mDuration = static_cast<double_t>(KeyCount);
+        loadedData.mTicksPerSecond = 30.0;
+        loadedData.mNumChannels = static_cast<uint32_t>(BoneCount);
+        loadedData.mChannels = new aiNodeAnim*[BoneCount];
+
+        for (size_t i = 0; i < BoneCount; i++)
+        {
+            aiNodeAnim* const channel = new aiNodeAnim;
+            channel->mNodeName = aiString(skeleton->GetBones()[i].name);
+            channel->mNumPositionKeys = KeyCount;
+            channel->mNumRotationKeys = KeyCount;
+            channel->mNumScalingKeys = 1;
+            channel->mPositionKeys = new aiVectorKey[KeyCount];
+            channel->mRotationKeys = new aiQuatKey[KeyCount];
+            channel->mScalingKeys = new aiVectorKey[1];
+            channel->mScalingKeys[0].mValue = aiVector3D(1.f);
+
+            for (uint32_t key = 0; key < KeyCount; key++)
+            {
+                channel->mPositionKeys[key].mTime = static_cast<double_t>(key);
+                channel->mPositionKeys[key].mValue = aiVector3D(position(*random), position(*random), position(*random));
+                channel->mRotationKeys[key].mTime = static_cast<double_t>(key);
+                channel->mRotationKeys[key].mValue = aiQuaternion(component(*random), component(*random), component(*random), component(*random)).Normalize();
+            }
+
+            loadedData.mChannels[i] = channel;
+        }
+
+        Pointer<Animation> animation = Pointer<Animation>::New();
+        animation->Load(loadedData);
+        // Not bound yet, the system binds it before animating on several threads
+        animation->skeleton = skeleton;
+        return animation;
+    }
+
+    // Characters playing one of the animations, a third of them cross-fading to another one
+    void CreateCharacters(const std::vector<Pointer<Animation>>& animations, std::vector<Animator>* const animators, std::vector<Animator>* const blendTargets)
+    {
+        animators->clear();
+        blendTargets->clear();
+        animators->reserve(CharacterCount);
+        blendTargets->reserve(CharacterCount);
+
+        for (size_t i = 0; i < CharacterCount; i++)
+        {
+            Animator& animator = animators->emplace_back(animations[i % AnimationCount]);
+            Animator& blendTarget = blendTargets->emplace_back(animations[(i + 1) % AnimationCount]);
+
+            if (i % 3 == 0)
+            {
+                animator.StartBlending(&blendTarget);
+                animator.SetCrossFadeDelta(static_cast<float_t>(i % 10) * 0.1f);
+            }
+        }
+    }
+
+    double_t Animate(AnimationSystem* const system, std::vector<Animator>* const animators, const bool_t parallel)
+    {
+        using Clock = std::chrono::high_resolution_clock;
+
+        system->Clear();
+        for (Animator& animator : *animators)
+            system->Add(&animator);
+
+        const Clock::time_point start = Clock::now();
+        for (size_t frame = 0; frame < FrameCount; frame++)
+            system->Update(DeltaTime, parallel);
+
+        return std::chrono::duration<double_t, std::milli>(Clock::now() - start).count() / FrameCount;
+    }
+}
+
+TEST(AnimationSystem, Deterministic)
+{
+    std::mt19937 random(1);
+    const Pointer<Skeleton> skeleton = CreateSkeleton(&random);
+    std::vector<Pointer<Animation>> animations;
+    for (size_t i = 0; i < AnimationCount; i++)
+        animations.push_back(CreateAnimation(skeleton, &random));
+
+    AnimationSystem system;
+
+    std::vector<Animator> parallelAnimators;
+    std::vector<Animator> parallelBlendTargets;
+    CreateCharacters(animations, &parallelAnimators, &parallelBlendTargets);
+    Animate(&system, &parallelAnimators, true);
+    EXPECT_EQ(system.GetAnimators().size(), CharacterCount);
+
+    // The animations were bound once, before the workers sampled them
+    for (const Pointer<Animation>& animation : animations)
+        EXPECT_TRUE(animation->IsBound());
+
+    std::vector<Animator> serialAnimators;
+    std::vector<Animator> serialBlendTargets;
+    CreateCharacters(animations, &serialAnimators, &serialBlendTargets);
+    Animate(&system, &serialAnimators, false);
+
+    // Each character gets exactly the same matrices whichever thread animated it
+    for (size_t i = 0; i < CharacterCount; i++)
+    {
+        const List<Matrix>& serialMatrices = serialAnimators[i].GetMatrices();
+        const List<Matrix>& parallelMatrices = parallelAnimators[i].GetMatrices();
+        for (size_t j = 0; j < BoneCount; j++)
+            ASSERT_EQ(std::memcmp(&serialMatrices[j], &parallelMatrices[j], sizeof(Matrix)), 0) << std::format("Character {}, bone {}", i, j);
+    }
+}
+
+TEST(AnimationSystem, Benchmark)
+{
+    std::mt19937 random(2);
+    const Pointer<Skeleton> skeleton = CreateSkeleton(&random);
+    std::vector<Pointer<Animation>> animations;
+    for (size_t i = 0; i < AnimationCount; i++)
+        animations.push_back(CreateAnimation(skeleton, &random));
+
+    AnimationSystem system;
+    std::vector<Animator> animators;
+    std::vector<Animator> blendTargets;
+    CreateCharacters(animations, &animators, &blendTargets);
+
+    // Warm up the worker threads
+    Animate(&system, &animators, true);
+
+    const double_t serialTime = Animate(&system, &animators, false);
+    const double_t parallelTime = Animate(&system, &animators, true);
+
+    const uint32_t threadCount = std::thread::hardware_concurrency();
+
+    std::cout << std::format(
+        "{} characters of {} bones: {:.3f} ms per frame on 1 thread, {:.3f} ms per frame in parallel ({:.2f}x on {} hardware threads)\n",
+        CharacterCount,
+        BoneCount,
+        serialTime,
+        parallelTime,
+        serialTime / parallelTime,
+        threadCount
+    );
+    RecordProperty("serial_ms", std::format("{:.4f}", serialTime));
+    RecordProperty("parallel_ms", std::format("{:.4f}", parallelTime));
+    RecordProperty("speedup", std::format("{:.2f}", serialTime / parallelTime));
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "resource/animation.hpp"
+#include "resource/skeleton.hpp"
+
+// Skeletons and animations shared by the animation tests, must be included after pch.hpp
+
+// Sets the time and the value of the position and rotation keys of the given index of a bone
+using AnimationKeyFunction = std::function<void(size_t bone, uint32_t key, aiVectorKey* position, aiQuatKey* rotation)>;
+
+// Bones named Bone_<index>, each one the child of the bone at the same index in parents
+inline Pointer<Skeleton> CreateSkeleton(const std::vector<int32_t>& parents)
+{
+    List<Bone> bones(parents.size());
+    for (size_t i = 0; i < parents.size(); i++)
+    {
+        bones[i].name = "Bone_" + std::to_string(i);
+        bones[i].id = static_cast<int32_t>(i);
+        bones[i].parentId = parents[i];
+        bones[i].global = Matrix::Identity();
+    }
+
+    Pointer<Skeleton> skeleton = Pointer<Skeleton>::New();
+    skeleton->Load(bones);
+    return skeleton;
+}
+
+// Chain of bones, each one the child of the previous one
+inline Pointer<Skeleton> CreateChainSkeleton(const size_t boneCount)
+{
+    std::vector<int32_t> parents(boneCount);
+    for (size_t i = 0; i < boneCount; i++)
+        parents[i] = static_cast<int32_t>(i) - 1;
+
+    return CreateSkeleton(parents);
+}
+
+inline std::vector<std::string> GetBoneNames(const Skeleton& skeleton)
+{
+    const List<Bone>& bones = skeleton.GetBones();
+
+    std::vector<std::string> names(bones.GetSize());
+    for (size_t i = 0; i < bones.GetSize(); i++)
+        names[i] = bones[i].name;
+
+    return names;
+}
+
+// Animation of the bones with the given names, in the order of the channels of the file, with keyCount position and rotation keys
+inline void LoadAnimation(
+    Animation* const animation,
+    const std::vector<std::string>& boneNames,
+    const double_t duration,
+    const uint32_t keyCount,
+    const AnimationKeyFunction& keyFunction
+)
+{
+    aiAnimation loadedData;
+    loadedData.mDuration = duration;
+    loadedData.mTicksPerSecond = 30.0;
+    loadedData.mNumChannels = static_cast<uint32_t>(boneNames.size());
+    loadedData.mChannels = new aiNodeAnim*[boneNames.size()];
+
+    for (size_t i = 0; i < boneNames.size(); i++)
+    {
+        aiNodeAnim* const channel = new aiNodeAnim;
+        channel->mNodeName = aiString(boneNames[i]);
+        channel->mNumPositionKeys = keyCount;
+        channel->mNumRotationKeys = keyCount;
+        channel->mNumScalingKeys = 1;
+        channel->mPositionKeys = new aiVectorKey[keyCount];
+        channel->mRotationKeys = new aiQuatKey[keyCount];
+        channel->mScalingKeys = new aiVectorKey[1];
+        channel->mScalingKeys[0].mValue = aiVector3D(1.f);
+
+        for (uint32_t key = 0; key < keyCount; key++)
+            keyFunction(i, key, &channel->mPositionKeys[key], &channel->mRotationKeys[key]);
+
+        loadedData.mChannels[i] = channel;
+    }
+
+    animation->Load(loadedData);
+}
+
+// Animation of every bone of the skeleton, which isn't bound to it yet
+inline Pointer<Animation> CreateAnimation(const Pointer<Skeleton>& skeleton, const double_t duration, const uint32_t keyCount, const AnimationKeyFunction& keyFunction)
+{
+    Pointer<Animation> animation = Pointer<Animation>::New();
+    LoadAnimation(animation.Get(), GetBoneNames(*skeleton), duration, keyCount, keyFunction);
+    animation->skeleton = skeleton;
+    return animation;
+}
+
+// Animation with a random transform at each of the keyCount frames, which isn't bound to the skeleton yet
+inline Pointer<Animation> CreateRandomAnimation(const Pointer<Skeleton>& skeleton, const uint32_t keyCount, std::mt19937* const random)
+{
+    std::normal_distribution component(0.f, 1.f);
+    std::uniform_real_distribution position(-1.f, 1.f);
+
+    return CreateAnimation(
+        skeleton,
+        static_cast<double_t>(keyCount),
+        keyCount,
+        [&](size_t, const uint32_t key, aiVectorKey* const positionKey, aiQuatKey* const rotationKey) -> void
+        {
+            positionKey->mTime = static_cast<double_t>(key);
+            positionKey->mValue = aiVector3D(position(*random), position(*random), position(*random));
+            rotationKey->mTime = static_cast<double_t>(key);
+            rotationKey->mValue = aiQuaternion(component(*random), component(*random), component(*random), component(*random)).Normalize();
+        }
+    );
+}
@@ -0,0 +1,234 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+#include "file/archive.hpp"
+#include "file/file_manager.hpp"
+#include "utils/compression.hpp"
+
+namespace
+{
+    std::vector<uint8_t> CreateData(const size_t size, const bool_t compressible, const uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::vector<uint8_t> data(size);
+
+        for (size_t i = 0; i < size; i++)
+        {
+            // Compressible data is made of runs of identical bytes with some noise
+            if (compressible && random() % 16 != 0)
+                data[i] = static_cast<uint8_t>(i / 32);
+            else
+                data[i] = static_cast<uint8_t>(random());
+        }
+
+        return data;
+    }
+
+    void WriteFile(const std::filesystem::path& path, const std::vector<uint8_t>& data)
+    {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char_t*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    // Creates a directory that looks like a small asset tree
+    std::filesystem::path CreateSourceDirectory(const std::string& name, const size_t fileCount, const size_t fileSize)
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove_all(directory);
+
+        for (size_t i = 0; i < fileCount; i++)
+        {
+            const std::filesystem::path path = directory / std::format("folder_{}", i % 4) / std::format("file_{}.bin", i);
+            WriteFile(path, CreateData(fileSize, i % 2 == 0, static_cast<uint32_t>(i)));
+        }
+
+        return directory;
+    }
+}
+
+TEST(Compression, Lz4RoundTrip)
+{
+    for (const size_t size : { 0ull, 1ull, 12ull, 13ull, 1000ull, 100000ull })
+    {
+        for (const bool_t compressible : { false, true })
+        {
+            const std::vector<uint8_t> data = CreateData(size, compressible, 42);
+
+            std::vector<uint8_t> compressed(Compression::GetMaxCompressedSize(CompressionFormat::Lz4, size));
+            const size_t compressedSize = Compression::Compress(CompressionFormat::Lz4, data.data(), data.size(), compressed.data(), compressed.size());
+            ASSERT_NE(compressedSize, 0);
+
+            if (compressible && size >= 1000)
+                EXPECT_LT(compressedSize, size / 2);
+
+            std::vector<uint8_t> decompressed(size);
+            ASSERT_TRUE(Compression::Decompress(CompressionFormat::Lz4, compressed.data(), compressedSize, decompressed.data(), decompressed.size()));
+            EXPECT_EQ(decompressed, data);
+        }
+    }
+}
+
+TEST(Compression, Lz4CorruptedInput)
+{
+    const std::vector<uint8_t> data = CreateData(10000, true, 7);
+
+    std::vector<uint8_t> compressed(Compression::GetMaxCompressedSize(CompressionFormat::Lz4, data.size()));
+    const size_t compressedSize = Compression::Compress(CompressionFormat::Lz4, data.data(), data.size(), compressed.data(), compressed.size());
+    compressed.resize(compressedSize);
+
+    std::vector<uint8_t> decompressed(data.size());
+
+    // Truncated input
+    EXPECT_FALSE(Compression::Decompress(CompressionFormat::Lz4, compressed.data(), compressed.size() / 2, decompressed.data(), decompressed.size()));
+    // Wrong output size
+    EXPECT_FALSE(Compression::Decompress(CompressionFormat::Lz4, compressed.data(), compressed.size(), decompressed.data(), decompressed.size() - 1));
+
+    // Random corruptions must never read or write out of bounds
+    std::mt19937 random(3);
+    for (size_t i = 0; i < 1000; i++)
+    {
+        std::vector<uint8_t> corrupted = compressed;
+        corrupted[random() % corrupted.size()] = static_cast<uint8_t>(random());
+        (void) Compression::Decompress(CompressionFormat::Lz4, corrupted.data(), corrupted.size(), decompressed.data(), decompressed.size());
+    }
+}
+
+TEST(Archive, BuildAndFind)
+{
+    const std::filesystem::path source = CreateSourceDirectory("xnor_archive_source", 16, 4096);
+    const std::filesystem::path archivePath = std::filesystem::temp_directory_path() / "xnor_archive.pak";
+
+    ASSERT_TRUE(Archive::Build(source, archivePath));
+
+    Archive archive;
+    ASSERT_TRUE(archive.Open(archivePath));
+    EXPECT_EQ(archive.GetEntryCount(), 16);
+
+    size_t compressedCount = 0;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(source))
+    {
+        if (!entry.is_regular_file())
+            continue;
+
+        const std::string path = relative(entry.path(), source).generic_string();
+
+        size_t index;
+        ASSERT_TRUE(archive.Find(path, &index));
+        EXPECT_EQ(archive.GetEntryPath(index), path);
+        EXPECT_EQ(archive.GetEntry(index).offset % ArchiveBuildOptions{}.alignment, 0);
+
+        if (archive.GetEntry(index).compression != CompressionFormat::None)
+            compressedCount++;
+
+        std::vector<uint8_t> data(archive.GetEntry(index).size);
+        ASSERT_TRUE(archive.Extract(index, data.data()));
+
+        std::ifstream file(entry.path(), std::ios::in | std::ios::binary);
+        const std::vector<uint8_t> expected((std::istreambuf_iterator(file)), std::istreambuf_iterator<char_t>());
+        EXPECT_EQ(data, expected);
+    }
+
+    // Only half of the files are compressible
+    EXPECT_EQ(compressedCount, 8);
+
+    size_t index;
+    EXPECT_FALSE(archive.Find("folder_0/missing.bin", &index));
+    EXPECT_FALSE(archive.Find("", &index));
+
+    archive.Close();
+    std::filesystem::remove(archivePath);
+    std::filesystem::remove_all(source);
+}
+
+TEST(Archive, InvalidFile)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "xnor_invalid.pak";
+    WriteFile(path, CreateData(1024, false, 1));
+
+    Archive archive;
+    EXPECT_FALSE(archive.Open(path));
+    EXPECT_FALSE(archive.IsOpen());
+
+    std::filesystem::remove(path);
+}
+
+TEST(Archive, Mount)
+{
+    const std::filesystem::path source = CreateSourceDirectory("xnor_archive_mount", 8, 2048);
+    const std::filesystem::path archivePath = std::filesystem::temp_directory_path() / "xnor_archive_mount.pak";
+    ASSERT_TRUE(Archive::Build(source, archivePath));
+
+    const std::filesystem::path mountPoint = "mounted_assets";
+    Pointer<Archive> archive = FileManager::MountArchive(archivePath, mountPoint);
+    ASSERT_TRUE(archive);
+
+    for (size_t i = 0; i < 8; i++)
+    {
+        const std::filesystem::path relativePath = std::filesystem::path(std::format("folder_{}", i % 4)) / std::format("file_{}.bin", i);
+
+        Pointer<File> file = FileManager::Get(mountPoint / relativePath);
+        ASSERT_TRUE(file);
+        EXPECT_TRUE(file->IsArchived());
+        ASSERT_TRUE(file->GetLoaded());
+
+        const std::vector<uint8_t> expected = CreateData(2048, i % 2 == 0, static_cast<uint32_t>(i));
+        ASSERT_EQ(file->GetSize(), static_cast<int64_t>(expected.size()));
+        EXPECT_EQ(std::memcmp(file->GetData(), expected.data(), expected.size()), 0);
+    }
+
+    FileManager::UnmountArchive(archive);
+    EXPECT_FALSE(FileManager::Contains(mountPoint / "folder_0" / "file_0.bin"));
+
+    std::filesystem::remove(archivePath);
+    std::filesystem::remove_all(source);
+}
+
+// Compares loading many small loose files to loading the same files from a single archive.
+// The operating system file cache cannot be portably dropped, so the first pass is only an approximation of a cold load
+TEST(Archive, LoadBenchmark)
+{
+    constexpr size_t FileCount = 2000;
+    constexpr size_t FileSize = 16 * 1024;
+
+    const std::filesystem::path source = CreateSourceDirectory("xnor_archive_benchmark", FileCount, FileSize);
+    const std::filesystem::path archivePath = std::filesystem::temp_directory_path() / "xnor_archive_benchmark.pak";
+    ASSERT_TRUE(Archive::Build(source, archivePath));
+
+    const auto measure = [](const std::function<void()>& function) -> double_t
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+        function();
+        return std::chrono::duration<double_t, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    for (const char_t* const pass : { "cold", "warm" })
+    {
+        const double_t loose = measure(
+            [&]
+            {
+                FileManager::LoadDirectory(source);
+                FileManager::UnloadAll();
+            }
+        );
+
+        const double_t packed = measure(
+            [&]
+            {
+                FileManager::MountArchive(archivePath, source);
+                FileManager::UnloadAll();
+            }
+        );
+
+        std::cout << std::format("[{}] {} files of {} bytes: loose {:.2f}ms, packed {:.2f}ms\n", pass, FileCount, FileSize, loose, packed);
+        RecordProperty(std::format("{}_loose_ms", pass), std::format("{:.2f}", loose));
+        RecordProperty(std::format("{}_packed_ms", pass), std::format("{:.2f}", packed));
+    }
+
+    std::filesystem::remove(archivePath);
+    std::filesystem::remove_all(source);
+}
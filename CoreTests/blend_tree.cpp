@@ -0,0 +1,399 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <format>
+#include <random>
+
+#include "animation_test_utils.hpp"
+#include "rendering/animator.hpp"
+#include "rendering/blend_tree.hpp"
+
+namespace
+{
+    constexpr size_t BoneCount = 67;
+    constexpr size_t CharacterCount = 100;
+    constexpr size_t FrameCount = 100;
+
+    // Moves every bone from start to end over the animation
+    Pointer<Animation> CreateTranslationAnimation(const Pointer<Skeleton>& skeleton, const Vector3 start, const Vector3 end)
+    {
+        constexpr double_t Duration = 30.0;
+
+        Pointer<Animation> animation = CreateAnimation(
+            skeleton,
+            Duration,
+            2,
+            [&](size_t, const uint32_t key, aiVectorKey* const position, aiQuatKey* const rotation) -> void
+            {
+                const Vector3 value = key == 0 ? start : end;
+                position->mTime = key == 0 ? 0.0 : Duration;
+                position->mValue = aiVector3D(value.x, value.y, value.z);
+                rotation->mTime = position->mTime;
+            }
+        );
+        animation->BindSkeleton(skeleton);
+        return animation;
+    }
+
+    Pointer<Animation> CreateTranslationAnimation(const Pointer<Skeleton>& skeleton, const Vector3 position)
+    {
+        return CreateTranslationAnimation(skeleton, position, position);
+    }
+
+    float_t GetWeightSum(const BlendTree& tree, const size_t clipCount)
+    {
+        float_t sum = 0.f;
+        for (uint32_t i = 0; i < clipCount; i++)
+            sum += tree.GetClipWeight(i);
+
+        return sum;
+    }
+
+    // Idle in the middle, walking and running forward, walking backward and strafing
+    struct Locomotion
+    {
+        std::vector<Pointer<Animation>> animations;
+        std::vector<Vector2> positions = { Vector2(0.f, 0.f), Vector2(0.f, 1.f), Vector2(0.f, 2.f), Vector2(0.f, -1.f), Vector2(-1.f, 0.f), Vector2(1.f, 0.f) };
+        BlendTree tree;
+        uint32_t speedX = 0;
+        uint32_t speedY = 0;
+    };
+
+    void CreateLocomotion(const Pointer<Skeleton>& skeleton, Locomotion* const locomotion)
+    {
+        BlendTree& tree = locomotion->tree;
+        locomotion->speedX = tree.AddParameter("SpeedX");
+        locomotion->speedY = tree.AddParameter("SpeedY");
+
+        std::vector<uint32_t> clips;
+        for (const Vector2 position : locomotion->positions)
+        {
+            locomotion->animations.push_back(CreateTranslationAnimation(skeleton, Vector3(position.x, position.y, 0.f)));
+            clips.push_back(tree.AddClip(locomotion->animations.back()));
+        }
+
+        tree.SetRoot(tree.AddBlend2D(locomotion->speedX, locomotion->speedY, clips, locomotion->positions));
+    }
+}
+
+TEST(BlendTree, Blend1DWeights)
+{
+    const Pointer<Skeleton> skeleton = CreateChainSkeleton(BoneCount);
+    const Pointer<Animation> idle = CreateTranslationAnimation(skeleton, Vector3(0.f));
+    const Pointer<Animation> walk = CreateTranslationAnimation(skeleton, Vector3(1.f, 0.f, 0.f));
+    const Pointer<Animation> run = CreateTranslationAnimation(skeleton, Vector3(3.f, 0.f, 0.f));
+
+    BlendTree tree;
+    const uint32_t speed = tree.AddParameter("Speed");
+    EXPECT_EQ(tree.GetParameterIndex("Speed"), speed);
+    EXPECT_EQ(tree.GetParameterIndex("Direction"), BlendTree::InvalidIndex);
+
+    // The inputs don't need to be given in order
+    const uint32_t runNode = tree.AddClip(run);
+    const uint32_t idleNode = tree.AddClip(idle);
+    const uint32_t walkNode = tree.AddClip(walk);
+    tree.SetRoot(tree.AddBlend1D(speed, { runNode, idleNode, walkNode }, { 6.f, 0.f, 2.f }));
+
+    const uint32_t runClip = tree.GetNodes()[runNode].clip;
+    const uint32_t idleClip = tree.GetNodes()[idleNode].clip;
+    const uint32_t walkClip = tree.GetNodes()[walkNode].clip;
+
+    struct Expected
+    {
+        float_t speed;
+        float_t idle;
+        float_t walk;
+        float_t run;
+    };
+
+    for (const Expected& expected : {
+        Expected { -1.f, 1.f, 0.f, 0.f },
+        Expected { 0.f, 1.f, 0.f, 0.f },
+        Expected { 1.f, 0.5f, 0.5f, 0.f },
+        Expected { 2.f, 0.f, 1.f, 0.f },
+        Expected { 5.f, 0.f, 0.25f, 0.75f },
+        Expected { 10.f, 0.f, 0.f, 1.f }
+    })
+    {
+        tree.SetParameter(speed, expected.speed);
+
+        AnimationPose pose;
+        ASSERT_TRUE(tree.Evaluate(1.f / 60.f, &pose));
+        ASSERT_EQ(pose.GetBoneCount(), BoneCount);
+
+        EXPECT_NEAR(tree.GetClipWeight(idleClip), expected.idle, 1e-5f) << std::format("Speed {}", expected.speed);
+        EXPECT_NEAR(tree.GetClipWeight(walkClip), expected.walk, 1e-5f) << std::format("Speed {}", expected.speed);
+        EXPECT_NEAR(tree.GetClipWeight(runClip), expected.run, 1e-5f) << std::format("Speed {}", expected.speed);
+
+        // The pose is the weighted average of the clips
+        const float_t x = expected.walk * 1.f + expected.run * 3.f;
+        for (size_t i = 0; i < BoneCount; i++)
+            EXPECT_NEAR(pose.GetTranslations()[i].x, x, 1e-2f) << std::format("Speed {}, bone {}", expected.speed, i);
+    }
+}
+
+TEST(BlendTree, Blend2DWeights)
+{
+    const Pointer<Skeleton> skeleton = CreateChainSkeleton(BoneCount);
+    Locomotion locomotion;
+    CreateLocomotion(skeleton, &locomotion);
+    BlendTree& tree = locomotion.tree;
+    const size_t clipCount = locomotion.positions.size();
+
+    AnimationPose pose;
+
+    // Each clip has the whole weight at its own position
+    for (size_t i = 0; i < clipCount; i++)
+    {
+        tree.SetParameter(locomotion.speedX, locomotion.positions[i].x);
+        tree.SetParameter(locomotion.speedY, locomotion.positions[i].y);
+        ASSERT_TRUE(tree.Evaluate(1.f / 60.f, &pose));
+
+        for (uint32_t j = 0; j < clipCount; j++)
+            EXPECT_NEAR(tree.GetClipWeight(j), i == j ? 1.f : 0.f, 1e-5f) << std::format("Position {}, clip {}", i, j);
+
+        EXPECT_EQ(tree.GetSampledClipCount(), 1);
+    }
+
+    // Anywhere else, the weights are positive and sum to 1, and the pose is their weighted average
+    std::mt19937 random(1);
+    std::uniform_real_distribution coordinate(-1.5f, 2.5f);
+    for (size_t i = 0; i < 100; i++)
+    {
+        const Vector2 point(coordinate(random), coordinate(random));
+        tree.SetParameter(locomotion.speedX, point.x);
+        tree.SetParameter(locomotion.speedY, point.y);
+        ASSERT_TRUE(tree.Evaluate(1.f / 60.f, &pose));
+
+        Vector2 expected;
+        for (uint32_t j = 0; j < clipCount; j++)
+        {
+            EXPECT_GE(tree.GetClipWeight(j), 0.f);
+            expected += locomotion.positions[j] * tree.GetClipWeight(j);
+        }
+
+        EXPECT_NEAR(GetWeightSum(tree, clipCount), 1.f, 1e-5f) << std::format("Point {}, {}", point.x, point.y);
+        EXPECT_NEAR(pose.GetTranslations()[0].x, expected.x, 1e-2f);
+        EXPECT_NEAR(pose.GetTranslations()[0].y, expected.y, 1e-2f);
+    }
+}
+
+TEST(BlendTree, SampledOnce)
+{
+    const Pointer<Skeleton> skeleton = CreateChainSkeleton(BoneCount);
+    const Pointer<Animation> idle = CreateTranslationAnimation(skeleton, Vector3(0.f));
+    const Pointer<Animation> walk = CreateTranslationAnimation(skeleton, Vector3(1.f, 0.f, 0.f));
+    const Pointer<Animation> run = CreateTranslationAnimation(skeleton, Vector3(3.f, 0.f, 0.f));
+
+    BlendTree tree;
+    const uint32_t speed = tree.AddParameter("Speed", 0.5f);
+    const uint32_t aim = tree.AddParameter("Aim", 0.5f);
+
+    // Both blends use the walk
+    const uint32_t slow = tree.AddBlend1D(speed, { tree.AddClip(idle), tree.AddClip(walk) }, { 0.f, 1.f });
+    const uint32_t fast = tree.AddBlend1D(speed, { tree.AddClip(walk), tree.AddClip(run) }, { 0.f, 1.f });
+    tree.SetRoot(tree.AddBlend1D(aim, { slow, fast }, { 0.f, 1.f }));
+
+    AnimationPose pose;
+    ASSERT_TRUE(tree.Evaluate(1.f / 60.f, &pose));
+
+    // The walk has a weight from both blends, but is sampled once
+    EXPECT_NEAR(tree.GetClipWeight(1), 0.5f, 1e-5f);
+    EXPECT_EQ(tree.GetSampledClipCount(), 3);
+    EXPECT_EQ(tree.GetSampledBoneCount(), 3 * BoneCount);
+    EXPECT_NEAR(pose.GetTranslations()[0].x, 0.25f * 0.f + 0.5f * 1.f + 0.25f * 3.f, 1e-2f);
+
+    // The clips which don't contribute aren't sampled
+    tree.SetParameter(speed, 0.f);
+    tree.SetParameter(aim, 0.f);
+    ASSERT_TRUE(tree.Evaluate(1.f / 60.f, &pose));
+    EXPECT_EQ(tree.GetSampledClipCount(), 1);
+    EXPECT_EQ(tree.GetClipWeight(2), 0.f);
+
+    // The intermediate poses are reused
+    tree.SetParameter(speed, 0.5f);
+    tree.SetParameter(aim, 0.5f);
+    ASSERT_TRUE(tree.Evaluate(1.f / 60.f, &pose));
+    const size_t poolSize = tree.GetPoolSize();
+    for (size_t i = 0; i < 100; i++)
+        ASSERT_TRUE(tree.Evaluate(1.f / 60.f, &pose));
+    EXPECT_EQ(tree.GetPoolSize(), poolSize);
+}
+
+TEST(BlendTree, AdditiveAndMask)
+{
+    const Pointer<Skeleton> skeleton = CreateChainSkeleton(BoneCount);
+    const Pointer<Animation> idle = CreateTranslationAnimation(skeleton, Vector3(1.f, 0.f, 0.f));
+    const Pointer<Animation> wave = CreateTranslationAnimation(skeleton, Vector3(0.f, 4.f, 0.f));
+    const Pointer<Animation> breathe = CreateTranslationAnimation(skeleton, Vector3(0.f), Vector3(0.f, 0.f, 2.f));
+
+    BlendTree tree;
+    const uint32_t breatheWeight = tree.AddParameter("Breathe");
+    const uint32_t waveWeight = tree.AddParameter("Wave");
+
+    // The upper body waves from the middle of the chain
+    const std::vector<float_t> upperBody = BlendTree::CreateBoneMask(*skeleton, "Bone_40");
+    for (size_t i = 0; i < BoneCount; i++)
+        ASSERT_EQ(upperBody[i], i >= 40 ? 1.f : 0.f);
+
+    const uint32_t masked = tree.AddMask(tree.AddClip(idle), tree.AddClip(wave), upperBody, waveWeight);
+    tree.SetRoot(tree.AddAdditive(masked, breathe, breatheWeight));
+
+    AnimationPose pose;
+
+    // Without weights, only the base is sampled
+    ASSERT_TRUE(tree.Evaluate(0.5f, &pose));
+    EXPECT_EQ(tree.GetSampledClipCount(), 1);
+    for (size_t i = 0; i < BoneCount; i++)
+        EXPECT_NEAR((pose.GetTranslations()[i] - Vector3(1.f, 0.f, 0.f)).Length(), 0.f, 1e-2f) << std::format("Bone {}", i);
+
+    tree.SetParameter(waveWeight, 1.f);
+    tree.SetParameter(breatheWeight, 0.5f);
+    ASSERT_TRUE(tree.Evaluate(0.f, &pose));
+    EXPECT_EQ(tree.GetSampledClipCount(), 3);
+
+    // The additive clip is relative to its first frame
+    AnimationPose firstFrame;
+    AnimationPose currentFrame;
+    breathe->SamplePose(0.f, &firstFrame);
+    breathe->SamplePose(tree.GetNormalizedTime(), &currentFrame);
+    const float_t z = 0.5f * (currentFrame.GetTranslations()[0].z - firstFrame.GetTranslations()[0].z);
+    ASSERT_GT(z, 0.f);
+    for (size_t i = 0; i < BoneCount; i++)
+    {
+        const Vector3 expected = i >= 40 ? Vector3(0.f, 4.f, z) : Vector3(1.f, 0.f, z);
+        EXPECT_NEAR((pose.GetTranslations()[i] - expected).Length(), 0.f, 1e-2f) << std::format("Bone {}", i);
+    }
+}
+
+TEST(BlendTree, Animator)
+{
+    const Pointer<Skeleton> skeleton = CreateChainSkeleton(BoneCount);
+    Locomotion locomotion;
+    CreateLocomotion(skeleton, &locomotion);
+    locomotion.tree.SetParameter(locomotion.speedY, 2.f);
+
+    Animator animator;
+    animator.SetBlendTree(&locomotion.tree);
+    animator.Prepare();
+    animator.Animate(1.f / 60.f);
+
+    EXPECT_EQ(animator.GetBoneCount(), BoneCount);
+    EXPECT_EQ(animator.GetSampledBoneCount(), BoneCount);
+
+    // The bones of the chain are all moved by the run
+    const List<Matrix>& matrices = animator.GetMatrices();
+    ASSERT_EQ(matrices.GetSize(), BoneCount);
+    const Vector3 lastBone = static_cast<Vector3>(matrices[BoneCount - 1] * Vector4(0.f, 0.f, 0.f, 1.f));
+    EXPECT_NEAR(lastBone.y, 2.f * static_cast<float_t>(BoneCount), 1e-1f);
+}
+
+TEST(BlendTree, AnimatorCrossFade)
+{
+    const Pointer<Skeleton> skeleton = CreateChainSkeleton(BoneCount);
+    Locomotion locomotion;
+    CreateLocomotion(skeleton, &locomotion);
+    locomotion.tree.SetParameter(locomotion.speedY, 2.f);
+
+    // The run of the blend tree is cross-faded halfway to a jump
+    const Pointer<Animation> jumpAnimation = CreateTranslationAnimation(skeleton, Vector3(4.f, 0.f, 0.f));
+    Animator jump(jumpAnimation);
+    Animator animator;
+    animator.SetBlendTree(&locomotion.tree);
+    animator.StartBlending(&jump);
+    animator.SetCrossFadeDelta(0.5f);
+    animator.Prepare();
+    animator.Animate(1.f / 60.f);
+
+    EXPECT_EQ(animator.GetSampledBoneCount(), 2 * BoneCount);
+
+    const List<Matrix>& matrices = animator.GetMatrices();
+    ASSERT_EQ(matrices.GetSize(), BoneCount);
+    const Vector3 lastBone = static_cast<Vector3>(matrices[BoneCount - 1] * Vector4(0.f, 0.f, 0.f, 1.f));
+    EXPECT_NEAR(lastBone.x, 2.f * static_cast<float_t>(BoneCount), 1e-1f);
+    EXPECT_NEAR(lastBone.y, static_cast<float_t>(BoneCount), 1e-1f);
+}
+
+TEST(BlendTree, LocomotionBenchmark)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    const Pointer<Skeleton> skeleton = CreateChainSkeleton(BoneCount);
+    std::vector<Locomotion> characters;
+    characters.reserve(CharacterCount);
+
+    // Each character moves in its own direction
+    std::mt19937 random(2);
+    std::uniform_real_distribution coordinate(-1.f, 2.f);
+    for (size_t i = 0; i < CharacterCount; i++)
+    {
+        Locomotion& locomotion = characters.emplace_back();
+        CreateLocomotion(skeleton, &locomotion);
+        locomotion.tree.SetParameter(locomotion.speedX, coordinate(random));
+        locomotion.tree.SetParameter(locomotion.speedY, coordinate(random));
+    }
+
+    // The weights are computed by a first evaluation, the time then stays the same
+    std::vector<AnimationPose> poses(CharacterCount, AnimationPose(BoneCount));
+    for (size_t i = 0; i < CharacterCount; i++)
+        characters[i].tree.Evaluate(0.5f, &poses[i]);
+
+    // Sampling every clip and blending them
+    std::vector<AnimationPose> clipPoses(characters.front().animations.size(), AnimationPose(BoneCount));
+    std::vector<AnimationPose> expectedPoses(CharacterCount, AnimationPose(BoneCount));
+    const Clock::time_point naiveStart = Clock::now();
+    for (size_t frame = 0; frame < FrameCount; frame++)
+    {
+        for (size_t i = 0; i < CharacterCount; i++)
+        {
+            BlendTree& tree = characters[i].tree;
+            for (size_t j = 0; j < clipPoses.size(); j++)
+                characters[i].animations[j]->SamplePose(tree.GetNormalizedTime(), &clipPoses[j]);
+
+            float_t total = 0.f;
+            for (uint32_t j = 0; j < clipPoses.size(); j++)
+            {
+                const float_t weight = tree.GetClipWeight(j);
+                total += weight;
+                if (j == 0)
+                    expectedPoses[i] = clipPoses[j];
+                else if (total > 0.f)
+                    AnimationPose::Blend(expectedPoses[i], clipPoses[j], weight / total, &expectedPoses[i]);
+            }
+        }
+    }
+    const double_t naiveTime = std::chrono::duration<double_t, std::milli>(Clock::now() - naiveStart).count() / FrameCount;
+
+    size_t sampledClipCount = 0;
+    const Clock::time_point treeStart = Clock::now();
+    for (size_t frame = 0; frame < FrameCount; frame++)
+    {
+        sampledClipCount = 0;
+        for (size_t i = 0; i < CharacterCount; i++)
+        {
+            characters[i].tree.Evaluate(0.f, &poses[i]);
+            sampledClipCount += characters[i].tree.GetSampledClipCount();
+        }
+    }
+    const double_t treeTime = std::chrono::duration<double_t, std::milli>(Clock::now() - treeStart).count() / FrameCount;
+
+    for (size_t i = 0; i < CharacterCount; i++)
+    {
+        for (size_t j = 0; j < BoneCount; j++)
+            ASSERT_NEAR((poses[i].GetTranslations()[j] - expectedPoses[i].GetTranslations()[j]).Length(), 0.f, 1e-4f) << std::format("Character {}, bone {}", i, j);
+    }
+
+    // A point of the blend space is surrounded by at most 3 clips
+    EXPECT_LE(sampledClipCount, 3 * CharacterCount);
+
+    std::cout << std::format(
+        "{} characters blending 6 clips of {} bones: {:.3f} ms per frame sampling every clip, {:.3f} ms per frame with the blend tree, {:.2f} clips sampled per character\n",
+        CharacterCount,
+        BoneCount,
+        naiveTime,
+        treeTime,
+        static_cast<double_t>(sampledClipCount) / CharacterCount
+    );
+    RecordProperty("all_clips_ms", std::format("{:.4f}", naiveTime));
+    RecordProperty("blend_tree_ms", std::format("{:.4f}", treeTime));
+}
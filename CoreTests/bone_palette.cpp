@@ -0,0 +1,168 @@
+#include "pch.hpp"
+
+#include <cstring>
+#include <format>
+
+#include "rendering/animator.hpp"
+#include "rendering/bone_palette.hpp"
+#include "resource/animation.hpp"
+#include "resource/skeleton.hpp"
+
+namespace
+{
+    // Graphics backend which only records what is uploaded
+    struct RecordingBackend
+    {
+        uint32_t uploadCount = 0;
+        size_t uploadedBytes = 0;
+        std::vector<Matrix> matrices;
+
+        BonePaletteUpload GetUpload()
+        {
+            return [this](const Matrix* const data, const size_t count) -> void
+            {
+                uploadCount++;
+                uploadedBytes += count * sizeof(Matrix);
+                matrices.assign(data, data + count);
+            };
+        }
+    };
+
+    List<Matrix> CreateMatrices(const size_t count, const float_t character)
+    {
+        List<Matrix> matrices(count);
+        for (size_t i = 0; i < count; i++)
+            matrices[i] = Matrix::Trs(Vector3(character, static_cast<float_t>(i), 0.f), Vector3::Zero(), Vector3(1.f));
+
+        return matrices;
+    }
+
+    // Chain of bones
+    Pointer<Skeleton> CreateSkeleton(const size_t boneCount)
+    {
+        List<Bone> bones(boneCount);
+        for (size_t i = 0; i < boneCount; i++)
+        {
+            bones[i].name = "Bone_" + std::to_string(i);
+            bones[i].id = static_cast<int32_t>(i);
+            bones[i].parentId = static_cast<int32_t>(i) - 1;
+            bones[i].global = Matrix::Identity();
+        }
+
+        Pointer<Skeleton> skeleton = Pointer<Skeleton>::New();
+        skeleton->Load(bones);
+        return skeleton;
+    }
+
+    // Moves each bone up from its parent
+    Pointer<Animation> CreateAnimation(const Pointer<Skeleton>& skeleton)
+    {
+        const List<Bone>& bones = skeleton->GetBones();
+        const size_t boneCount = bones.GetSize();
+
+        aiAnimation loadedData;
+        loadedData.mDuration = 1.0;
+        loadedData.mTicksPerSecond = 30.0;
+        loadedData.mNumChannels = static_cast<uint32_t>(boneCount);
+        loadedData.mChannels = new aiNodeAnim*[boneCount];
+
+        for (size_t i = 0; i < boneCount; i++)
+        {
+            aiNodeAnim* const channel = new aiNodeAnim;
+            channel->mNodeName = aiString(bones[i].name);
+            channel->mNumPositionKeys = 2;
+            channel->mNumRotationKeys = 1;
+            channel->mNumScalingKeys = 1;
+            channel->mPositionKeys = new aiVectorKey[2];
+            channel->mRotationKeys = new aiQuatKey[1];
+            channel->mScalingKeys = new aiVectorKey[1];
+            channel->mPositionKeys[0].mTime = 0.0;
+            channel->mPositionKeys[0].mValue = aiVector3D(0.f, 1.f, 0.f);
+            channel->mPositionKeys[1].mTime = 1.0;
+            channel->mPositionKeys[1].mValue = aiVector3D(0.f, 1.f, 0.f);
+            channel->mScalingKeys[0].mValue = aiVector3D(1.f);
+
+            loadedData.mChannels[i] = channel;
+        }
+
+        Pointer<Animation> animation = Pointer<Animation>::New();
+        animation->Load(loadedData);
+        animation->skeleton = skeleton;
+        return animation;
+    }
+}
+
+TEST(BonePalette, Offsets)
+{
+    BonePalette palette;
+    RecordingBackend backend;
+
+    const std::array<size_t, 4> boneCounts = { 60, 150, 0, 7 };
+    std::vector<uint32_t> offsets;
+
+    for (size_t frame = 0; frame < 3; frame++)
+    {
+        backend = {};
+        palette.Clear();
+        offsets.clear();
+
+        for (size_t i = 0; i < boneCounts.size(); i++)
+            offsets.push_back(palette.Add(CreateMatrices(boneCounts[i], static_cast<float_t>(i))));
+
+        palette.Upload(backend.GetUpload());
+
+        // The characters are packed one after another
+        EXPECT_EQ(offsets, (std::vector<uint32_t>{ 0, 60, 210, 210 }));
+
+        // A single upload for the whole frame
+        constexpr size_t matrixCount = 60 + 150 + 7;
+        EXPECT_EQ(backend.uploadCount, 1);
+        EXPECT_EQ(backend.uploadedBytes, matrixCount * sizeof(Matrix));
+
+        const BonePaletteStatistics& statistics = palette.GetStatistics();
+        EXPECT_EQ(statistics.instanceCount, boneCounts.size());
+        EXPECT_EQ(statistics.matrixCount, matrixCount);
+        EXPECT_EQ(statistics.uploadCount, backend.uploadCount);
+        EXPECT_EQ(statistics.uploadedBytes, backend.uploadedBytes);
+
+        // Each draw finds its bones at its offset
+        ASSERT_EQ(backend.matrices.size(), matrixCount);
+        for (size_t i = 0; i < boneCounts.size(); i++)
+        {
+            const List<Matrix> expected = CreateMatrices(boneCounts[i], static_cast<float_t>(i));
+            for (size_t j = 0; j < boneCounts[i]; j++)
+                ASSERT_EQ(std::memcmp(&backend.matrices[offsets[i] + j], &expected[j], sizeof(Matrix)), 0) << std::format("Character {}, bone {}", i, j);
+        }
+    }
+
+    // Nothing to upload
+    backend = {};
+    palette.Clear();
+    palette.Upload(backend.GetUpload());
+    EXPECT_EQ(backend.uploadCount, 0);
+    EXPECT_EQ(palette.GetStatistics().uploadCount, 0);
+}
+
+TEST(BonePalette, MoreThan100Bones)
+{
+    constexpr size_t BoneCount = 180;
+
+    const Pointer<Skeleton> skeleton = CreateSkeleton(BoneCount);
+    const Pointer<Animation> animation = CreateAnimation(skeleton);
+    Animator animator(animation);
+    animator.Animate(1.f / 60.f);
+
+    const List<Matrix>& matrices = animator.GetMatrices();
+    ASSERT_EQ(matrices.GetSize(), BoneCount);
+
+    // The last bone is at the end of the whole chain
+    const Vector3 lastBone = static_cast<Vector3>(matrices[BoneCount - 1] * Vector4(0.f, 0.f, 0.f, 1.f));
+    EXPECT_NEAR(lastBone.y, static_cast<float_t>(BoneCount), 1e-2f);
+
+    BonePalette palette;
+    RecordingBackend backend;
+    palette.Add(CreateMatrices(3, 0.f));
+    EXPECT_EQ(palette.Add(matrices), 3);
+    palette.Upload(backend.GetUpload());
+    EXPECT_EQ(backend.uploadedBytes, (BoneCount + 3) * sizeof(Matrix));
+}
@@ -0,0 +1,154 @@
+#include "pch.hpp"
+
+#include <format>
+
+#include "Maths/vector4.hpp"
+#include "rendering/light/cascade_shadow_map.hpp"
+
+namespace
+{
+    constexpr float_t Near = 0.1f;
+    constexpr float_t Far = 200.f;
+    constexpr int32_t ShadowMapResolution = 2048;
+    const Vector2i ScreenSize(1920, 1080);
+
+    Camera CreateCamera(const Vector3& position, const Vector3& front)
+    {
+        Camera camera;
+        camera.position = position;
+        camera.front = front.Normalized();
+        camera.right = Vector3::Cross(camera.front, Vector3::UnitY()).Normalized();
+        camera.up = Vector3::Cross(camera.right, camera.front).Normalized();
+        camera.near = Near;
+        camera.far = Far;
+        return camera;
+    }
+
+    // Position of a world space point in the shadow map of a cascade, in texels
+    Vector2 GetTexel(const Camera& cascade, const Vector3& point)
+    {
+        Matrix viewProjection;
+        cascade.GetVp(ScreenSize, &viewProjection);
+
+        const Vector4 clip = viewProjection * Vector4(point.x, point.y, point.z, 1.f);
+        return Vector2((clip.x * 0.5f + 0.5f) * ShadowMapResolution, (clip.y * 0.5f + 0.5f) * ShadowMapResolution);
+    }
+}
+
+TEST(CascadeShadowMap, Splits)
+{
+    CascadeShadowMap cascades;
+
+    // Uniform
+    cascades.ComputeCascadeLevel(Near, Far, 0.f);
+    for (size_t i = 0; i < DirectionalCascadeLevel; i++)
+        EXPECT_NEAR(cascades.GetCascadeLevel()[i], Near + (Far - Near) * static_cast<float_t>(i + 1) / CascadeShadowMap::CascadeCount, 1e-3f);
+
+    // Logarithmic, each cascade covers the same ratio of depths
+    cascades.ComputeCascadeLevel(Near, Far, 1.f);
+    const float_t ratio = std::pow(Far / Near, 1.f / CascadeShadowMap::CascadeCount);
+    EXPECT_NEAR(cascades.GetCascadeLevel()[0], Near * ratio, 1e-3f);
+    for (size_t i = 1; i < DirectionalCascadeLevel; i++)
+        EXPECT_NEAR(cascades.GetCascadeLevel()[i] / cascades.GetCascadeLevel()[i - 1], ratio, 1e-3f);
+
+    // Practical, in between
+    cascades.ComputeCascadeLevel(Near, Far, 0.5f);
+    for (size_t i = 0; i < DirectionalCascadeLevel; i++)
+    {
+        const float_t uniform = Near + (Far - Near) * static_cast<float_t>(i + 1) / CascadeShadowMap::CascadeCount;
+        const float_t logarithmic = Near * std::pow(ratio, static_cast<float_t>(i + 1));
+        EXPECT_NEAR(cascades.GetCascadeLevel()[i], (uniform + logarithmic) * 0.5f, 1e-3f);
+
+        if (i > 0)
+            EXPECT_GT(cascades.GetCascadeLevel()[i], cascades.GetCascadeLevel()[i - 1]);
+    }
+}
+
+TEST(CascadeShadowMap, Stability)
+{
+    CascadeShadowMap cascades;
+    cascades.ComputeCascadeLevel(Near, Far, 0.75f);
+
+    const Vector3 lightDir = Vector3(0.3f, 1.f, 0.2f).Normalized();
+    const Vector3 point(3.f, 0.f, -4.f);
+
+    std::vector<Camera> firstCameras;
+    cascades.GetCascadeCameras(&firstCameras, CreateCamera(Vector3(0.f, 2.f, 0.f), Vector3(0.f, -0.2f, -1.f)), lightDir, ScreenSize, ShadowMapResolution);
+
+    // The camera moves by less than a texel each frame, and rotates
+    for (size_t frame = 1; frame < 200; frame++)
+    {
+        const float_t t = static_cast<float_t>(frame);
+        const Camera camera = CreateCamera(
+            Vector3(t * 0.013f, 2.f, -t * 0.007f),
+            Vector3(std::sin(t * 0.01f), -0.2f, -std::cos(t * 0.01f))
+        );
+
+        std::vector<Camera> cameras;
+        cascades.GetCascadeCameras(&cameras, camera, lightDir, ScreenSize, ShadowMapResolution);
+
+        for (size_t i = 0; i < CascadeShadowMap::CascadeCount; i++)
+        {
+            // The size of the cascades doesn't change
+            EXPECT_FLOAT_EQ(cameras[i].leftRight.y, firstCameras[i].leftRight.y);
+            EXPECT_FLOAT_EQ(cameras[i].bottomtop.y, firstCameras[i].bottomtop.y);
+
+            // A world space point stays at the same place within its texel, the shadow map only moves by whole texels
+            const Vector2 texel = GetTexel(cameras[i], point);
+            const Vector2 firstTexel = GetTexel(firstCameras[i], point);
+            const float_t offsetX = texel.x - firstTexel.x;
+            const float_t offsetY = texel.y - firstTexel.y;
+            EXPECT_NEAR(offsetX, std::round(offsetX), 0.01f) << std::format("Cascade {} at frame {}", i, frame);
+            EXPECT_NEAR(offsetY, std::round(offsetY), 0.01f) << std::format("Cascade {} at frame {}", i, frame);
+        }
+    }
+}
+
+TEST(CascadeShadowMap, CasterCulling)
+{
+    CascadeShadowMap cascades;
+    cascades.ComputeCascadeLevel(Near, Far, 0.75f);
+
+    // Light from straight above
+    const Vector3 lightDir = Vector3::UnitY();
+    std::vector<Camera> cameras;
+    cascades.GetCascadeCameras(&cameras, CreateCamera(Vector3(0.f, 2.f, 0.f), -Vector3::UnitZ()), lightDir, ScreenSize, ShadowMapResolution);
+
+    // Casters on a ground grid
+    std::vector<Bound> casters;
+    for (int32_t x = -50; x <= 50; x++)
+    {
+        for (int32_t z = -50; z <= 50; z++)
+            casters.emplace_back(Vector3(static_cast<float_t>(x) * 4.f, 0.f, static_cast<float_t>(z) * 4.f), Vector3(1.f));
+    }
+
+    // High above the first cascade, between it and the light
+    const uint32_t above = static_cast<uint32_t>(casters.size());
+    casters.emplace_back(Vector3(0.f, 30.f, -2.f), Vector3(1.f));
+    // Far below the first cascade, it can't cast a shadow on it
+    const uint32_t below = static_cast<uint32_t>(casters.size());
+    casters.emplace_back(Vector3(0.f, -30.f, -2.f), Vector3(1.f));
+
+    std::vector<uint32_t> cascadeCasters;
+    cascades.CullCasters(0, casters, &cascadeCasters);
+    EXPECT_NE(std::ranges::find(cascadeCasters, above), cascadeCasters.end());
+    EXPECT_EQ(std::ranges::find(cascadeCasters, below), cascadeCasters.end());
+
+    size_t totalCasters = 0;
+    size_t previousCount = 0;
+    for (size_t i = 0; i < CascadeShadowMap::CascadeCount; i++)
+    {
+        cascades.CullCasters(i, casters, &cascadeCasters);
+
+        // Each cascade only gets a part of the casters, and the farther cascades cover more of the ground
+        EXPECT_LT(cascadeCasters.size(), casters.size());
+        EXPECT_GE(cascadeCasters.size(), previousCount);
+        previousCount = cascadeCasters.size();
+        totalCasters += cascadeCasters.size();
+
+        std::cout << std::format("Cascade {}: {} casters out of {}\n", i, cascadeCasters.size(), casters.size());
+        RecordProperty(std::format("cascade_{}_casters", i), static_cast<int32_t>(cascadeCasters.size()));
+    }
+
+    EXPECT_LT(totalCasters, casters.size() * CascadeShadowMap::CascadeCount);
+}
@@ -0,0 +1,242 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <fstream>
+
+#include "resource/derived_data_cache.hpp"
+
+namespace
+{
+    // Uses a separate cache directory for the duration of a test
+    class ScopedCache
+    {
+    public:
+        ScopedCache()
+            : m_OldDirectory(DerivedDataCache::directory)
+            , m_OldMaxSize(DerivedDataCache::maxSize)
+        {
+            DerivedDataCache::directory = std::filesystem::temp_directory_path() / "xnor_derived_data";
+            DerivedDataCache::Clear();
+            DerivedDataCache::ResetStats();
+        }
+
+        ~ScopedCache()
+        {
+            DerivedDataCache::Clear();
+            DerivedDataCache::directory = m_OldDirectory;
+            DerivedDataCache::maxSize = m_OldMaxSize;
+        }
+
+    private:
+        std::filesystem::path m_OldDirectory;
+        size_t m_OldMaxSize;
+    };
+
+    struct ImporterSettings
+    {
+        int32_t channels = 4;
+        bool_t flip = false;
+    };
+
+    DerivedDataKey CreateKey(const std::vector<uint8_t>& source, const ImporterSettings& settings, const uint32_t version = 1)
+    {
+        return DerivedDataCache::CreateKey("Test", version, source.data(), source.size(), settings.channels, settings.flip);
+    }
+
+    std::vector<uint8_t> CreateData(const size_t size, const uint8_t seed)
+    {
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; i++)
+            data[i] = static_cast<uint8_t>(i * 31 + seed);
+        return data;
+    }
+}
+
+TEST(DerivedDataCache, PutAndGet)
+{
+    const ScopedCache cache;
+
+    const std::vector<uint8_t> source = CreateData(4096, 1);
+    const std::vector<uint8_t> artifact = CreateData(1024, 2);
+    const DerivedDataKey key = CreateKey(source, {});
+
+    std::vector<uint8_t> result;
+    EXPECT_FALSE(DerivedDataCache::Get(key, &result));
+
+    ASSERT_TRUE(DerivedDataCache::Put(key, artifact.data(), artifact.size()));
+    ASSERT_TRUE(DerivedDataCache::Get(key, &result));
+    EXPECT_EQ(result, artifact);
+
+    const DerivedDataCacheStats stats = DerivedDataCache::GetStats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.writes, 1);
+    EXPECT_GT(stats.size, artifact.size());
+
+    // Empty artifacts are valid
+    const DerivedDataKey emptyKey = CreateKey(source, { .channels = 3 });
+    ASSERT_TRUE(DerivedDataCache::Put(emptyKey, nullptr, 0));
+    ASSERT_TRUE(DerivedDataCache::Get(emptyKey, &result));
+    EXPECT_TRUE(result.empty());
+}
+
+TEST(DerivedDataCache, Invalidation)
+{
+    const ScopedCache cache;
+
+    std::vector<uint8_t> source = CreateData(4096, 1);
+    const std::vector<uint8_t> artifact = CreateData(1024, 2);
+
+    ASSERT_TRUE(DerivedDataCache::Put(CreateKey(source, {}), artifact.data(), artifact.size()));
+
+    std::vector<uint8_t> result;
+    EXPECT_TRUE(DerivedDataCache::Get(CreateKey(source, {}), &result));
+
+    // Changing a setting
+    EXPECT_FALSE(DerivedDataCache::Get(CreateKey(source, { .flip = true }), &result));
+    EXPECT_FALSE(DerivedDataCache::Get(CreateKey(source, { .channels = 3 }), &result));
+
+    // Changing the importer version
+    EXPECT_FALSE(DerivedDataCache::Get(CreateKey(source, {}, 2), &result));
+
+    // Changing a single byte of the source
+    source[source.size() / 2]++;
+    EXPECT_FALSE(DerivedDataCache::Get(CreateKey(source, {}), &result));
+
+    source[source.size() / 2]--;
+    EXPECT_TRUE(DerivedDataCache::Get(CreateKey(source, {}), &result));
+
+    const DerivedDataCacheStats stats = DerivedDataCache::GetStats();
+    EXPECT_EQ(stats.hits, 2);
+    EXPECT_EQ(stats.misses, 4);
+}
+
+TEST(DerivedDataCache, Corruption)
+{
+    const ScopedCache cache;
+
+    const std::vector<uint8_t> source = CreateData(4096, 1);
+    const std::vector<uint8_t> artifact = CreateData(1024, 2);
+    const DerivedDataKey key = CreateKey(source, {});
+
+    ASSERT_TRUE(DerivedDataCache::Put(key, artifact.data(), artifact.size()));
+
+    const std::filesystem::path path = DerivedDataCache::directory / (DerivedDataCache::GetKeyString(key) + DerivedDataCache::FileExtension);
+    ASSERT_TRUE(std::filesystem::exists(path));
+
+    // Flip a byte of the payload
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-1, std::ios::end);
+        file.put(static_cast<char_t>(~artifact.back()));
+    }
+
+    std::vector<uint8_t> result;
+    EXPECT_FALSE(DerivedDataCache::Get(key, &result));
+    EXPECT_FALSE(std::filesystem::exists(path));
+    EXPECT_EQ(DerivedDataCache::GetStats().corruptions, 1);
+
+    // Truncated artifact
+    ASSERT_TRUE(DerivedDataCache::Put(key, artifact.data(), artifact.size()));
+    std::filesystem::resize_file(path, 16);
+    EXPECT_FALSE(DerivedDataCache::Get(key, &result));
+    EXPECT_EQ(DerivedDataCache::GetStats().corruptions, 2);
+}
+
+TEST(DerivedDataCache, SizeLimit)
+{
+    const ScopedCache cache;
+
+    const std::vector<uint8_t> artifact = CreateData(1024, 2);
+
+    std::vector<DerivedDataKey> keys;
+    for (uint8_t i = 0; i < 3; i++)
+        keys.push_back(CreateKey(CreateData(64, i), {}));
+
+    DerivedDataCache::maxSize = artifact.size() * 5 / 2 + 128;
+
+    ASSERT_TRUE(DerivedDataCache::Put(keys[0], artifact.data(), artifact.size()));
+    ASSERT_TRUE(DerivedDataCache::Put(keys[1], artifact.data(), artifact.size()));
+
+    // Make the first artifact older than the second one, then use it so that the second one is the least recently used
+    const auto now = std::filesystem::file_time_type::clock::now();
+    std::filesystem::last_write_time(DerivedDataCache::directory / (DerivedDataCache::GetKeyString(keys[0]) + DerivedDataCache::FileExtension), now - std::chrono::hours(2));
+    std::filesystem::last_write_time(DerivedDataCache::directory / (DerivedDataCache::GetKeyString(keys[1]) + DerivedDataCache::FileExtension), now - std::chrono::hours(1));
+
+    std::vector<uint8_t> result;
+    ASSERT_TRUE(DerivedDataCache::Get(keys[0], &result));
+
+    ASSERT_TRUE(DerivedDataCache::Put(keys[2], artifact.data(), artifact.size()));
+
+    const DerivedDataCacheStats stats = DerivedDataCache::GetStats();
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_LE(stats.size, DerivedDataCache::maxSize);
+
+    EXPECT_TRUE(DerivedDataCache::Get(keys[0], &result));
+    EXPECT_FALSE(DerivedDataCache::Get(keys[1], &result));
+    EXPECT_TRUE(DerivedDataCache::Get(keys[2], &result));
+}
+
+TEST(DerivedDataCache, Partition)
+{
+    const ScopedCache cache;
+
+    const std::vector<uint8_t> artifact = CreateData(1024, 2);
+
+    std::vector<DerivedDataKey> keys;
+    for (uint8_t i = 0; i < 4; i++)
+        keys.push_back(CreateKey(CreateData(64, i), {}));
+
+    const DerivedDataPartition partition { .name = "partition", .maxSize = artifact.size() * 3 / 2 + 128 };
+    DerivedDataCache::maxSize = artifact.size() * 3 / 2 + 128;
+
+    // The artifacts of the partition aren't found outside of it
+    ASSERT_TRUE(DerivedDataCache::Put(keys[0], artifact.data(), artifact.size(), &partition));
+    const std::filesystem::path path = DerivedDataCache::directory / partition.name / (DerivedDataCache::GetKeyString(keys[0]) + DerivedDataCache::FileExtension);
+    EXPECT_TRUE(std::filesystem::exists(path));
+
+    std::vector<uint8_t> result;
+    EXPECT_FALSE(DerivedDataCache::Get(keys[0], &result));
+    ASSERT_TRUE(DerivedDataCache::Get(keys[0], &result, &partition));
+    EXPECT_EQ(result, artifact);
+
+    // Filling the rest of the cache doesn't evict the artifacts of the partition
+    ASSERT_TRUE(DerivedDataCache::Put(keys[1], artifact.data(), artifact.size()));
+    ASSERT_TRUE(DerivedDataCache::Put(keys[2], artifact.data(), artifact.size()));
+    EXPECT_EQ(DerivedDataCache::GetStats().evictions, 1);
+    EXPECT_TRUE(DerivedDataCache::Get(keys[0], &result, &partition));
+
+    // The size includes the partition
+    EXPECT_GT(DerivedDataCache::GetStats().size, DerivedDataCache::maxSize);
+
+    // Filling the partition only evicts its own artifacts
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+    ASSERT_TRUE(DerivedDataCache::Put(keys[3], artifact.data(), artifact.size(), &partition));
+    EXPECT_EQ(DerivedDataCache::GetStats().evictions, 2);
+    EXPECT_FALSE(DerivedDataCache::Get(keys[0], &result, &partition));
+    EXPECT_TRUE(DerivedDataCache::Get(keys[3], &result, &partition));
+
+    DerivedDataCache::Remove(keys[3], &partition);
+    EXPECT_FALSE(DerivedDataCache::Get(keys[3], &result, &partition));
+
+    // Clearing the cache clears its partitions
+    ASSERT_TRUE(DerivedDataCache::Put(keys[3], artifact.data(), artifact.size(), &partition));
+    DerivedDataCache::Clear();
+    EXPECT_FALSE(DerivedDataCache::Get(keys[3], &result, &partition));
+    EXPECT_EQ(DerivedDataCache::GetStats().size, 0);
+}
+
+TEST(DerivedDataCache, Disabled)
+{
+    const ScopedCache cache;
+
+    const std::vector<uint8_t> artifact = CreateData(1024, 2);
+    const DerivedDataKey key = CreateKey(CreateData(64, 0), {});
+
+    DerivedDataCache::enabled = false;
+    EXPECT_FALSE(DerivedDataCache::Put(key, artifact.data(), artifact.size()));
+    DerivedDataCache::enabled = true;
+
+    std::vector<uint8_t> result;
+    EXPECT_FALSE(DerivedDataCache::Get(key, &result));
+}
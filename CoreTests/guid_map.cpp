@@ -0,0 +1,290 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <random>
+
+#include "resource/guid_map.hpp"
+
+namespace
+{
+    Guid CreateGuid(std::mt19937& random)
+    {
+        return Guid::FromString(std::format(
+            "{:X}-{:X}-{:X}-{:X}-{:X}-{:X}-{:X}-{:X}-{:X}-{:X}-{:X}",
+            random(),
+            random() & 0xFFFF,
+            random() & 0xFFFF,
+            random() & 0xFF,
+            random() & 0xFF,
+            random() & 0xFF,
+            random() & 0xFF,
+            random() & 0xFF,
+            random() & 0xFF,
+            random() & 0xFF,
+            random() & 0xFF
+        ));
+    }
+
+    struct GuidEntry
+    {
+        Guid guid;
+        std::string name;
+    };
+
+    std::vector<GuidEntry> CreateEntries(const size_t count)
+    {
+        std::mt19937 random(1);
+
+        std::vector<GuidEntry> entries(count);
+        for (size_t i = 0; i < count; i++)
+            entries[i] = { .guid = CreateGuid(random), .name = std::format("assets/models/category_{}/model_{}.obj", i % 100, i) };
+
+        return entries;
+    }
+
+    std::string CreateText(const std::vector<GuidEntry>& entries)
+    {
+        std::string text;
+        for (const auto& [guid, name] : entries)
+            text += name + ';' + static_cast<std::string>(guid) + '\n';
+        return text;
+    }
+}
+
+TEST(GuidMap, GuidFromString)
+{
+    std::mt19937 random(1);
+
+    for (size_t i = 0; i < 100; i++)
+    {
+        const Guid guid = CreateGuid(random);
+        EXPECT_NE(guid, Guid::Empty());
+        EXPECT_EQ(Guid::FromString(static_cast<std::string>(guid)), guid);
+    }
+
+    EXPECT_EQ(Guid::FromString("1A2B3C4D-5E6F-7A8B-9-A-B-C-D-E-F-10").GetData1(), 0x1A2B3C4D);
+    EXPECT_EQ(Guid::FromString("1a2b3c4d-5e6f-7a8b-9-a-b-c-d-e-f-10").GetData4()[7], 0x10);
+    EXPECT_EQ(Guid::FromString("1A2B3C4D-5E6F-7A8B-9-A-B-C-D-E-F"), Guid::Empty());
+    EXPECT_EQ(Guid::FromString("not a guid"), Guid::Empty());
+    EXPECT_EQ(Guid::FromString(""), Guid::Empty());
+}
+
+TEST(GuidMap, Lookup)
+{
+    const std::vector<GuidEntry> entries = CreateEntries(1000);
+
+    GuidMap map;
+    for (const auto& [guid, name] : entries)
+        map.Add(guid, name);
+
+    ASSERT_EQ(map.GetCount(), entries.size());
+
+    for (const auto& [guid, name] : entries)
+    {
+        ASSERT_NE(map.Find(guid), nullptr);
+        EXPECT_EQ(*map.Find(guid), name);
+        EXPECT_EQ(map.Find(name), guid);
+    }
+
+    // Renaming
+    map.Add(entries[0].guid, "assets/renamed.obj");
+    EXPECT_EQ(*map.Find(entries[0].guid), "assets/renamed.obj");
+    EXPECT_EQ(map.Find("assets/renamed.obj"), entries[0].guid);
+    EXPECT_FALSE(map.Contains(entries[0].name));
+
+    // Reusing a name removes the previous entry
+    map.Add(entries[2].guid, entries[1].name);
+    EXPECT_FALSE(map.Contains(entries[1].guid));
+    EXPECT_FALSE(map.Contains(entries[2].name));
+    EXPECT_EQ(map.Find(entries[1].name), entries[2].guid);
+    EXPECT_EQ(map.GetCount(), entries.size() - 1);
+
+    EXPECT_TRUE(map.Remove(entries[3].guid));
+    EXPECT_FALSE(map.Remove(entries[3].guid));
+    EXPECT_EQ(map.Find(entries[3].name), Guid::Empty());
+    EXPECT_EQ(map.Find(entries[3].guid), nullptr);
+}
+
+TEST(GuidMap, SaveAndLoad)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "xnor_guid_map.bin";
+    const std::vector<GuidEntry> entries = CreateEntries(1000);
+
+    {
+        GuidMap map;
+        for (size_t i = 0; i < 900; i++)
+            map.Add(entries[i].guid, entries[i].name);
+        ASSERT_TRUE(map.Save(path));
+    }
+
+    const uintmax_t initialSize = std::filesystem::file_size(path);
+
+    {
+        GuidMap map;
+        ASSERT_TRUE(map.Load(path));
+        ASSERT_EQ(map.GetCount(), 900);
+
+        // Only the added entries are appended
+        size_t addedSize = 0;
+        for (size_t i = 900; i < 1000; i++)
+        {
+            map.Add(entries[i].guid, entries[i].name);
+            addedSize += sizeof(Guid) + sizeof(uint32_t) + entries[i].name.size();
+        }
+        ASSERT_TRUE(map.Save(path));
+        EXPECT_EQ(std::filesystem::file_size(path), initialSize + addedSize);
+    }
+
+    {
+        GuidMap map;
+        ASSERT_TRUE(map.Load(path));
+        ASSERT_EQ(map.GetCount(), entries.size());
+
+        for (const auto& [guid, name] : entries)
+            EXPECT_EQ(map.Find(name), guid);
+
+        // Removing an entry requires a full rewrite
+        ASSERT_TRUE(map.Remove(entries[0].guid));
+        ASSERT_TRUE(map.Save(path));
+    }
+
+    GuidMap map;
+    ASSERT_TRUE(map.Load(path));
+    EXPECT_EQ(map.GetCount(), entries.size() - 1);
+    EXPECT_FALSE(map.Contains(entries[0].guid));
+
+    std::filesystem::remove(path);
+}
+
+TEST(GuidMap, InvalidData)
+{
+    const std::vector<GuidEntry> entries = CreateEntries(10);
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "xnor_guid_map_invalid.bin";
+
+    {
+        GuidMap map;
+        for (const auto& [guid, name] : entries)
+            map.Add(guid, name);
+        ASSERT_TRUE(map.Save(path));
+    }
+
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator(file)), std::istreambuf_iterator<char_t>());
+    file.close();
+    std::filesystem::remove(path);
+
+    GuidMap map;
+    ASSERT_TRUE(map.Load(data.data(), data.size()));
+
+    // Truncated
+    EXPECT_FALSE(map.Load(data.data(), data.size() - 1));
+    EXPECT_EQ(map.GetCount(), 0);
+    EXPECT_FALSE(map.Load(data.data(), sizeof(GuidMapHeader) - 1));
+
+    // Wrong magic
+    data[0] = 'Y';
+    EXPECT_FALSE(map.Load(data.data(), data.size()));
+}
+
+TEST(GuidMap, TextConversion)
+{
+    const std::vector<GuidEntry> entries = CreateEntries(1000);
+    const std::filesystem::path textPath = std::filesystem::temp_directory_path() / "xnor_guid_map.txt";
+    const std::filesystem::path binaryPath = std::filesystem::temp_directory_path() / "xnor_guid_map_converted.bin";
+
+    std::ofstream(textPath, std::ios::out | std::ios::binary | std::ios::trunc) << CreateText(entries) << "invalid line\r\n\n";
+
+    // Invalid lines are skipped
+    EXPECT_TRUE(GuidMap::ConvertText(textPath, binaryPath));
+
+    GuidMap map;
+    ASSERT_TRUE(map.Load(binaryPath));
+    ASSERT_EQ(map.GetCount(), entries.size());
+
+    for (const auto& [guid, name] : entries)
+        EXPECT_EQ(map.Find(name), guid);
+
+    std::filesystem::remove(textPath);
+    std::filesystem::remove(binaryPath);
+}
+
+// Compares the legacy text GUID map to the binary one at 100k entries
+TEST(GuidMap, Benchmark)
+{
+    constexpr size_t EntryCount = 100'000;
+    // The legacy name to Guid lookup is a linear search, so only a subset of the names is looked up
+    constexpr size_t LegacyLookupCount = 1000;
+
+    const std::vector<GuidEntry> entries = CreateEntries(EntryCount);
+    const std::string text = CreateText(entries);
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "xnor_guid_map_benchmark.bin";
+
+    {
+        GuidMap map;
+        map.Reserve(entries.size());
+        for (const auto& [guid, name] : entries)
+            map.Add(guid, name);
+        ASSERT_TRUE(map.Save(path));
+    }
+
+    using Clock = std::chrono::high_resolution_clock;
+    const auto elapsed = [](const Clock::time_point start) -> double_t
+    {
+        return std::chrono::duration<double_t, std::milli>(Clock::now() - start).count();
+    };
+
+    // Legacy: line by line parsing into a Guid to name map, and linear name to Guid lookups
+    auto start = Clock::now();
+
+    std::unordered_map<Guid, std::string> legacyMap;
+    {
+        std::istringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            const size_t guidPos = line.find_first_of(';');
+            legacyMap.emplace(Guid::FromString(&line[guidPos + 1]), line.substr(0, guidPos));
+        }
+    }
+    const double_t legacyLoad = elapsed(start);
+
+    start = Clock::now();
+    size_t legacyFound = 0;
+    for (size_t i = 0; i < LegacyLookupCount; i++)
+    {
+        const std::string& name = entries[i * (EntryCount / LegacyLookupCount)].name;
+        legacyFound += std::ranges::find_if(legacyMap, [&name](auto&& p) -> bool_t { return p.second == name; }) != legacyMap.end();
+    }
+    const double_t legacyLookup = elapsed(start) / LegacyLookupCount;
+
+    // Binary
+    start = Clock::now();
+    GuidMap map;
+    ASSERT_TRUE(map.Load(path));
+    const double_t binaryLoad = elapsed(start);
+
+    start = Clock::now();
+    size_t binaryFound = 0;
+    for (const auto& [guid, name] : entries)
+        binaryFound += map.Find(name) == guid && map.Find(guid) != nullptr;
+    const double_t binaryLookup = elapsed(start) / (EntryCount * 2);
+
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(legacyMap.size(), EntryCount);
+    EXPECT_EQ(legacyFound, LegacyLookupCount);
+    EXPECT_EQ(binaryFound, EntryCount);
+
+    std::cout << std::format(
+        "[text] load {:.2f}ms, name lookup {:.4f}ms\n[binary] load {:.2f}ms, lookup {:.6f}ms\n",
+        legacyLoad,
+        legacyLookup,
+        binaryLoad,
+        binaryLookup
+    );
+    RecordProperty("text_load_ms", std::format("{:.2f}", legacyLoad));
+    RecordProperty("binary_load_ms", std::format("{:.2f}", binaryLoad));
+    RecordProperty("text_lookup_ms", std::format("{:.4f}", legacyLookup));
+    RecordProperty("binary_lookup_ms", std::format("{:.6f}", binaryLookup));
+}
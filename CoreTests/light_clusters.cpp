@@ -0,0 +1,163 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <format>
+#include <random>
+
+#include "Maths/calc.hpp"
+#include "Maths/vector4.hpp"
+#include "rendering/light/light_clusters.hpp"
+
+namespace
+{
+    constexpr float_t Fov = 90.f * Calc::Deg2Rad;
+    constexpr float_t AspectRatio = 16.f / 9.f;
+    constexpr float_t Near = 0.1f;
+    constexpr float_t Far = 1000.f;
+
+    std::vector<LightBounds> CreateLights(std::mt19937& random, const size_t count, const float_t extent, const float_t maxRadius)
+    {
+        std::uniform_real_distribution position(-extent, extent);
+        std::uniform_real_distribution radius(0.5f, maxRadius);
+
+        std::vector<LightBounds> lights(count);
+        for (LightBounds& light : lights)
+            light = { .position = Vector3(position(random), position(random), position(random)), .radius = radius(random) };
+
+        return lights;
+    }
+
+    bool_t Contains(const std::span<const uint32_t> lights, const uint32_t light)
+    {
+        return std::ranges::find(lights, light) != lights.end();
+    }
+}
+
+TEST(LightClusters, Assignment)
+{
+    std::mt19937 random(1);
+
+    const Matrix view = Matrix::LookAt(Vector3(5.f, 10.f, 40.f), Vector3(), Vector3::UnitY());
+    const Matrix projection = Matrix::Perspective(Fov, AspectRatio, Near, Far);
+    const Matrix inverseView = view.Inverted();
+
+    const std::vector<LightBounds> pointLights = CreateLights(random, 500, 30.f, 10.f);
+    const std::vector<LightBounds> spotLights = CreateLights(random, 500, 30.f, 10.f);
+
+    LightClusters clusters;
+    clusters.Build(view, projection, Near, Far, pointLights, spotLights);
+
+    // The lights of every cluster are stored contiguously
+    uint32_t offset = 0;
+    for (const GpuLightCluster& cluster : clusters.GetClusters())
+    {
+        EXPECT_EQ(cluster.offset, offset);
+        offset += cluster.pointLightCount + cluster.spotLightCount;
+    }
+    EXPECT_EQ(offset, clusters.GetLightIndices().size());
+
+    // Every light containing a point must be in the cluster of this point
+    std::uniform_real_distribution ndc(-1.f, 1.f);
+    std::uniform_real_distribution depth(Near, 80.f);
+    const float_t tanHalfFov = std::tan(Fov * 0.5f);
+
+    for (size_t i = 0; i < 2000; i++)
+    {
+        const float_t z = depth(random);
+        const Vector3 viewPosition(ndc(random) * z * tanHalfFov * AspectRatio, ndc(random) * z * tanHalfFov, -z);
+        const Vector3 point = inverseView * viewPosition;
+
+        // Same computations as the lighting shaders
+        const Vector3 pointViewPosition = view * point;
+        const Vector4 clip = projection * Vector4(pointViewPosition.x, pointViewPosition.y, pointViewPosition.z, 1.f);
+        const uint32_t cluster = clusters.GetClusterIndex(Vector2(clip.x / clip.w, clip.y / clip.w), -pointViewPosition.z);
+
+        for (uint32_t light = 0; light < pointLights.size(); light++)
+        {
+            if ((pointLights[light].position - point).Length() < pointLights[light].radius * 0.999f)
+                EXPECT_TRUE(Contains(clusters.GetPointLights(cluster), light)) << std::format("Point light {} missing from cluster {}", light, cluster);
+        }
+
+        for (uint32_t light = 0; light < spotLights.size(); light++)
+        {
+            if ((spotLights[light].position - point).Length() < spotLights[light].radius * 0.999f)
+                EXPECT_TRUE(Contains(clusters.GetSpotLights(cluster), light)) << std::format("Spot light {} missing from cluster {}", light, cluster);
+        }
+    }
+}
+
+TEST(LightClusters, Culling)
+{
+    const Matrix view = Matrix::LookAt(Vector3(), -Vector3::UnitZ(), Vector3::UnitY());
+    const Matrix projection = Matrix::Perspective(Fov, AspectRatio, Near, Far);
+
+    const std::vector<LightBounds> pointLights =
+    {
+        // Behind the camera
+        { .position = Vector3(0.f, 0.f, 20.f), .radius = 5.f },
+        // Off-screen
+        { .position = Vector3(500.f, 0.f, -50.f), .radius = 5.f },
+        // Beyond the far plane
+        { .position = Vector3(0.f, 0.f, -1100.f), .radius = 5.f },
+        // Small light at the center of the screen
+        { .position = Vector3(0.f, 0.f, -50.f), .radius = 0.5f }
+    };
+
+    LightClusters clusters;
+    clusters.Build(view, projection, Near, Far, pointLights, {});
+
+    const uint32_t center = clusters.GetClusterIndex(Vector2(0.f), 50.f);
+    for (uint32_t i = 0; i < LightClusters::ClusterCount; i++)
+    {
+        const std::span<const uint32_t> lights = clusters.GetPointLights(i);
+        EXPECT_TRUE(clusters.GetSpotLights(i).empty());
+
+        for (const uint32_t light : lights)
+            EXPECT_EQ(light, 3);
+
+        if (i == center)
+            EXPECT_EQ(lights.size(), 1);
+    }
+
+    // The light lies on the center of the screen, so it overlaps the 4 central tiles of a depth slice at most, and 2 slices at most
+    EXPECT_LE(clusters.GetLightIndices().size(), 8);
+}
+
+TEST(LightClusters, Benchmark)
+{
+    constexpr size_t LightCount = 4096;
+    constexpr size_t Iterations = 20;
+
+    std::mt19937 random(2);
+
+    const Matrix view = Matrix::LookAt(Vector3(0.f, 20.f, 200.f), Vector3(), Vector3::UnitY());
+    const Matrix projection = Matrix::Perspective(Fov, AspectRatio, Near, Far);
+
+    const std::vector<LightBounds> pointLights = CreateLights(random, LightCount / 2, 200.f, 8.f);
+    const std::vector<LightBounds> spotLights = CreateLights(random, LightCount / 2, 200.f, 8.f);
+
+    LightClusters clusters;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    clusters.Build(view, projection, Near, Far, pointLights, spotLights);
+    const double_t firstBuild = std::chrono::duration<double_t, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    // The cluster bounds are only computed again when the projection changes
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < Iterations; i++)
+        clusters.Build(view, projection, Near, Far, pointLights, spotLights);
+    const double_t build = std::chrono::duration<double_t, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / Iterations;
+
+    EXPECT_FALSE(clusters.GetLightIndices().empty());
+
+    std::cout << std::format(
+        "{} lights in {} clusters: first build {:.3f}ms, build {:.3f}ms, {} light indices\n",
+        LightCount,
+        LightClusters::ClusterCount,
+        firstBuild,
+        build,
+        clusters.GetLightIndices().size()
+    );
+    RecordProperty("first_build_ms", std::format("{:.3f}", firstBuild));
+    RecordProperty("build_ms", std::format("{:.3f}", build));
+}
@@ -0,0 +1,174 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <random>
+
+#include "file/file_manager.hpp"
+#include "file/memory_mapped_file.hpp"
+
+#ifdef _WIN32
+#include "utils/windows.hpp"
+#include <Psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Returns the current resident set size of the process, in bytes
+    size_t GetResidentMemory()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters {};
+        GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return counters.WorkingSetSize;
+#else
+        size_t pages = 0, residentPages = 0;
+        std::ifstream statm("/proc/self/statm");
+        statm >> pages >> residentPages;
+        return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    std::filesystem::path CreateLargeFile(const std::string& name, const size_t size)
+    {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+
+        std::mt19937 random(1);
+        std::vector<uint32_t> data(size / sizeof(uint32_t));
+        std::ranges::generate(data, random);
+
+        std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char_t*>(data.data()), static_cast<std::streamsize>(data.size() * sizeof(uint32_t)));
+
+        return path;
+    }
+
+    // Simulates a loader parsing the whole file
+    uint64_t Checksum(const Pointer<File>& file)
+    {
+        const uint8_t* const data = file->GetData<uint8_t>();
+        return std::accumulate(data, data + file->GetSize(), 0ull);
+    }
+}
+
+TEST(MemoryMappedFile, OpenAndRead)
+{
+    const std::filesystem::path path = CreateLargeFile("xnor_mapping.bin", 1024 * 1024);
+
+    MemoryMappedFile mapping;
+    ASSERT_TRUE(mapping.Open(path));
+    ASSERT_EQ(mapping.GetSize(), 1024 * 1024);
+
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    const std::vector<uint8_t> expected((std::istreambuf_iterator(file)), std::istreambuf_iterator<char_t>());
+    EXPECT_EQ(std::memcmp(mapping.GetData(), expected.data(), expected.size()), 0);
+
+    // The mapping is copy-on-write, so this must not modify the file
+    mapping.GetData()[0] = static_cast<uint8_t>(~expected[0]);
+    mapping.Close();
+    EXPECT_FALSE(mapping.IsOpen());
+
+    ASSERT_TRUE(mapping.Open(path));
+    EXPECT_EQ(mapping.GetData()[0], expected[0]);
+    mapping.Close();
+
+    std::filesystem::remove(path);
+}
+
+TEST(MemoryMappedFile, EmptyAndMissingFiles)
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "xnor_mapping_empty.bin";
+    std::ofstream(path, std::ios::out | std::ios::trunc).close();
+
+    MemoryMappedFile mapping;
+    ASSERT_TRUE(mapping.Open(path));
+    EXPECT_EQ(mapping.GetSize(), 0);
+    EXPECT_EQ(mapping.GetData(), nullptr);
+    mapping.Close();
+
+    std::filesystem::remove(path);
+    EXPECT_FALSE(mapping.Open(path));
+}
+
+// Compares loading a large texture by reading it into a buffer and by mapping it
+TEST(MemoryMappedFile, FileLoadBenchmark)
+{
+    constexpr size_t FileSize = 64 * 1024 * 1024;
+
+    // Use a texture extension as only asset files are mapped
+    const std::filesystem::path path = CreateLargeFile("xnor_mapping_benchmark.hdr", FileSize);
+
+    const bool_t oldUseMemoryMapping = File::useMemoryMapping;
+
+    struct Result
+    {
+        const char_t* name;
+        double_t loadTime;
+        double_t parseTime;
+        size_t loadMemory;
+        size_t parseMemory;
+        uint64_t checksum;
+    };
+
+    const auto measure = [&path](const bool_t useMemoryMapping) -> Result
+    {
+        File::useMemoryMapping = useMemoryMapping;
+
+        const size_t memoryBefore = GetResidentMemory();
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        Pointer<File> file = FileManager::Load(path);
+        EXPECT_EQ(file->IsMemoryMapped(), useMemoryMapping);
+
+        const auto loaded = std::chrono::high_resolution_clock::now();
+        const size_t memoryLoaded = GetResidentMemory();
+
+        const uint64_t checksum = Checksum(file);
+
+        const auto parsed = std::chrono::high_resolution_clock::now();
+        const size_t memoryParsed = GetResidentMemory();
+
+        FileManager::Unload(path);
+
+        return {
+            .name = useMemoryMapping ? "mapped" : "read",
+            .loadTime = std::chrono::duration<double_t, std::milli>(loaded - start).count(),
+            .parseTime = std::chrono::duration<double_t, std::milli>(parsed - loaded).count(),
+            .loadMemory = memoryLoaded - std::min(memoryLoaded, memoryBefore),
+            .parseMemory = memoryParsed - std::min(memoryParsed, memoryBefore),
+            .checksum = checksum
+        };
+    };
+
+    // Warm up the operating system file cache so that both modes start from the same state
+    measure(false);
+
+    const Result read = measure(false);
+    const Result mapped = measure(true);
+
+    File::useMemoryMapping = oldUseMemoryMapping;
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(read.checksum, mapped.checksum);
+    // Reading the file commits a buffer of its whole size, whereas a mapping only becomes resident when accessed
+    EXPECT_GE(read.loadMemory, FileSize / 2);
+    EXPECT_LT(mapped.loadMemory, read.loadMemory);
+
+    for (const Result& result : { read, mapped })
+    {
+        std::cout << std::format(
+            "[{}] load {:.2f}ms ({} KiB resident), load + parse {:.2f}ms ({} KiB resident)\n",
+            result.name,
+            result.loadTime,
+            result.loadMemory / 1024,
+            result.loadTime + result.parseTime,
+            result.parseMemory / 1024
+        );
+        RecordProperty(std::format("{}_load_ms", result.name), std::format("{:.2f}", result.loadTime));
+        RecordProperty(std::format("{}_parse_kib", result.name), std::to_string(result.parseMemory / 1024));
+    }
+}
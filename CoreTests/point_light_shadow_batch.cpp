@@ -0,0 +1,120 @@
+#include "pch.hpp"
+
+#include <bit>
+#include <format>
+#include <random>
+
+#include "rendering/light/point_light_shadow_batch.hpp"
+
+namespace
+{
+    constexpr uint32_t PositiveX = 1 << 0;
+    constexpr uint32_t NegativeX = 1 << 1;
+    constexpr uint32_t PositiveY = 1 << 2;
+    constexpr uint32_t NegativeZ = 1 << 5;
+
+    // Face of the cube map a direction falls into, the same way the GPU selects it
+    uint32_t GetFace(const Vector3& direction)
+    {
+        const Vector3 absolute(std::abs(direction.x), std::abs(direction.y), std::abs(direction.z));
+        if (absolute.x >= absolute.y && absolute.x >= absolute.z)
+            return direction.x >= 0.f ? 0 : 1;
+
+        if (absolute.y >= absolute.z)
+            return direction.y >= 0.f ? 2 : 3;
+
+        return direction.z >= 0.f ? 4 : 5;
+    }
+}
+
+TEST(PointLightShadowBatch, FaceMask)
+{
+    const Vector3 light(10.f, 0.f, 0.f);
+
+    EXPECT_EQ(PointLightShadowBatch::GetFaceMask(light, 20.f, Bound(light + Vector3(5.f, 0.f, 0.f), Vector3(1.f))), PositiveX);
+    EXPECT_EQ(PointLightShadowBatch::GetFaceMask(light, 20.f, Bound(light - Vector3(5.f, 0.f, 0.f), Vector3(1.f))), NegativeX);
+    EXPECT_EQ(PointLightShadowBatch::GetFaceMask(light, 20.f, Bound(light - Vector3(0.f, 0.f, 5.f), Vector3(1.f))), NegativeZ);
+
+    // On the edge between 2 faces
+    EXPECT_EQ(PointLightShadowBatch::GetFaceMask(light, 20.f, Bound(light + Vector3(5.f, 5.f, 0.f), Vector3(1.f))), PositiveX | PositiveY);
+
+    // Around the light
+    EXPECT_EQ(PointLightShadowBatch::GetFaceMask(light, 20.f, Bound(light, Vector3(1.f))), PointLightShadowBatch::AllFaces);
+
+    // Outside of the sphere of the light, even though the AABB corner is inside of its bounding box
+    EXPECT_EQ(PointLightShadowBatch::GetFaceMask(light, 20.f, Bound(light + Vector3(16.f, 16.f, 0.f), Vector3(2.f))), 0);
+}
+
+TEST(PointLightShadowBatch, Conservative)
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution position(-20.f, 20.f);
+    std::uniform_real_distribution size(0.1f, 8.f);
+    std::uniform_real_distribution unit(0.f, 1.f);
+
+    const Vector3 light(1.f, 2.f, 3.f);
+    constexpr float_t Radius = 25.f;
+
+    for (size_t i = 0; i < 500; i++)
+    {
+        const Bound caster(Vector3(position(random), position(random), position(random)), Vector3(size(random), size(random), size(random)));
+        const uint32_t faceMask = PointLightShadowBatch::GetFaceMask(light, Radius, caster);
+
+        // Every point of the caster inside of the sphere must be drawn to the face it is seen from
+        const Vector3 min = caster.GetMin();
+        const Vector3 max = caster.GetMax();
+        for (size_t j = 0; j < 100; j++)
+        {
+            const Vector3 point(min.x + (max.x - min.x) * unit(random), min.y + (max.y - min.y) * unit(random), min.z + (max.z - min.z) * unit(random));
+            const Vector3 direction = point - light;
+            if (direction.x * direction.x + direction.y * direction.y + direction.z * direction.z > Radius * Radius)
+                continue;
+
+            const uint32_t face = GetFace(direction);
+            EXPECT_NE(faceMask & (1u << face), 0) << std::format("Caster {} is missing from face {}", i, face);
+        }
+    }
+}
+
+TEST(PointLightShadowBatch, DrawCount)
+{
+    // Casters spread on a grid around the light
+    std::vector<Bound> casters;
+    for (int32_t x = -10; x <= 10; x++)
+    {
+        for (int32_t z = -10; z <= 10; z++)
+            casters.emplace_back(Vector3(static_cast<float_t>(x) * 4.f, -1.f, static_cast<float_t>(z) * 4.f), Vector3(2.f));
+    }
+
+    PointLightShadowBatch batch;
+    batch.Build(Vector3(0.f, 2.f, 0.f), 30.f, casters);
+
+    // Record the draws the layered pass issues and the faces they reach
+    uint32_t drawCount = 0;
+    uint32_t faceDrawCount = 0;
+    for (const PointLightShadowDraw& draw : batch.GetDraws())
+    {
+        EXPECT_LT(draw.caster, casters.size());
+        EXPECT_NE(draw.faceMask, 0);
+        EXPECT_EQ(draw.faceMask & ~PointLightShadowBatch::AllFaces, 0);
+
+        drawCount++;
+        faceDrawCount += static_cast<uint32_t>(std::popcount(draw.faceMask));
+    }
+
+    EXPECT_EQ(faceDrawCount, batch.GetFaceDrawCount());
+
+    // Casters far from the light are culled once instead of once per face, and casters seen by several faces are only drawn once
+    EXPECT_LT(drawCount, casters.size());
+    EXPECT_LT(drawCount, faceDrawCount);
+
+    std::cout << std::format(
+        "{} casters: {} layered draws, {} draws with a pass per face, {} casters tested with a pass per face\n",
+        casters.size(),
+        drawCount,
+        faceDrawCount,
+        casters.size() * PointLightShadowBatch::FaceCount
+    );
+    RecordProperty("layered_draws", static_cast<int32_t>(drawCount));
+    RecordProperty("face_draws", static_cast<int32_t>(faceDrawCount));
+}
@@ -0,0 +1,118 @@
+#include "pch.hpp"
+
+#include "rendering/program_binary_cache.hpp"
+
+namespace
+{
+    constexpr std::string_view Driver = "Vendor;Renderer;4.6.0 1.2.3";
+
+    ShaderCode CreateCode(const std::string& code, const ShaderType::ShaderType type)
+    {
+        return { .code = code, .codeLength = static_cast<int32_t>(code.size()), .type = type };
+    }
+
+    std::vector<ShaderCode> CreateProgram()
+    {
+        return {
+            CreateCode("#version 460 core\nvoid main() { gl_Position = vec4(0.0); }\n", ShaderType::Vertex),
+            CreateCode("#version 460 core\nout vec4 color;\nvoid main() { color = vec4(1.0); }\n", ShaderType::Fragment)
+        };
+    }
+
+    ProgramBinary CreateBinary(const size_t size)
+    {
+        ProgramBinary binary { .format = 0x8E21 };
+        binary.data.resize(size);
+        for (size_t i = 0; i < size; i++)
+            binary.data[i] = static_cast<uint8_t>(i * 7);
+        return binary;
+    }
+
+    bool_t operator==(const DerivedDataKey& lhs, const DerivedDataKey& rhs)
+    {
+        return DerivedDataCache::GetKeyString(lhs) == DerivedDataCache::GetKeyString(rhs);
+    }
+}
+
+TEST(ProgramBinaryCache, Key)
+{
+    const std::vector<ShaderCode> program = CreateProgram();
+    const DerivedDataKey key = ProgramBinaryCache::CreateKey(program, "", Driver);
+
+    EXPECT_TRUE(ProgramBinaryCache::CreateKey(CreateProgram(), "", Driver) == key);
+
+    // Source
+    std::vector<ShaderCode> modified = CreateProgram();
+    modified[1].code[modified[1].code.size() / 2] = ' ';
+    EXPECT_FALSE(ProgramBinaryCache::CreateKey(modified, "", Driver) == key);
+
+    // Only the part of the source given to the driver is used
+    modified = CreateProgram();
+    modified[0].code += "garbage";
+    EXPECT_TRUE(ProgramBinaryCache::CreateKey(modified, "", Driver) == key);
+
+    // Stage
+    modified = CreateProgram();
+    modified[1].type = ShaderType::Geometry;
+    EXPECT_FALSE(ProgramBinaryCache::CreateKey(modified, "", Driver) == key);
+
+    // Defines
+    EXPECT_FALSE(ProgramBinaryCache::CreateKey(program, "#define SHADOWS\n", Driver) == key);
+
+    // Driver
+    EXPECT_FALSE(ProgramBinaryCache::CreateKey(program, "", "Vendor;Renderer;4.6.0 1.2.4") == key);
+}
+
+TEST(ProgramBinaryCache, Serialization)
+{
+    const ProgramBinary binary = CreateBinary(4096);
+
+    std::vector<uint8_t> data;
+    ProgramBinaryCache::Serialize(binary, &data);
+
+    ProgramBinary result;
+    ASSERT_TRUE(ProgramBinaryCache::Deserialize(data.data(), data.size(), &result));
+    EXPECT_EQ(result.format, binary.format);
+    EXPECT_EQ(result.data, binary.data);
+
+    EXPECT_FALSE(ProgramBinaryCache::Deserialize(data.data(), data.size() - 1, &result));
+    EXPECT_FALSE(ProgramBinaryCache::Deserialize(data.data(), 8, &result));
+
+    // Empty binaries are never valid
+    ProgramBinaryCache::Serialize(ProgramBinary {}, &data);
+    EXPECT_FALSE(ProgramBinaryCache::Deserialize(data.data(), data.size(), &result));
+}
+
+TEST(ProgramBinaryCache, Storage)
+{
+    const std::filesystem::path oldDirectory = DerivedDataCache::directory;
+    DerivedDataCache::directory = std::filesystem::temp_directory_path() / "xnor_program_binaries";
+    DerivedDataCache::Clear();
+
+    const DerivedDataKey key = ProgramBinaryCache::CreateKey(CreateProgram(), "", Driver);
+    const ProgramBinary binary = CreateBinary(1024);
+
+    ProgramBinary result;
+    EXPECT_FALSE(ProgramBinaryCache::Get(key, &result));
+
+    ASSERT_TRUE(ProgramBinaryCache::Put(key, binary));
+    ASSERT_TRUE(ProgramBinaryCache::Get(key, &result));
+    EXPECT_EQ(result.format, binary.format);
+    EXPECT_EQ(result.data, binary.data);
+
+    // The binaries have their own partition of the cache
+    EXPECT_TRUE(std::filesystem::exists(DerivedDataCache::directory / ProgramBinaryCache::partition.name / (DerivedDataCache::GetKeyString(key) + DerivedDataCache::FileExtension)));
+    std::vector<uint8_t> data;
+    EXPECT_FALSE(DerivedDataCache::Get(key, &data));
+
+    // Rejected binaries are removed
+    ProgramBinaryCache::Remove(key);
+    EXPECT_FALSE(ProgramBinaryCache::Get(key, &result));
+
+    ProgramBinaryCache::enabled = false;
+    EXPECT_FALSE(ProgramBinaryCache::Put(key, binary));
+    ProgramBinaryCache::enabled = true;
+
+    DerivedDataCache::Clear();
+    DerivedDataCache::directory = oldDirectory;
+}
@@ -0,0 +1,236 @@
+#include "pch.hpp"
+
+#include <thread>
+
+#include "file/file_manager.hpp"
+#include "input/time.hpp"
+#include "resource/resource_manager.hpp"
+
+class BudgetedResource final : public Resource
+{
+public:
+    static constexpr size_t MegaByte = 1024 * 1024;
+
+    static inline uint32_t loadCount = 0;
+    static inline bool_t failLoad = false;
+
+    using Resource::Resource;
+
+    using Resource::Load;
+
+    bool_t Load(const uint8_t* const, const int64_t) override
+    {
+        if (failLoad)
+            return false;
+
+        loadCount++;
+        m_Loaded = true;
+        return true;
+    }
+
+    void Unload() override
+    {
+        m_Loaded = false;
+    }
+
+    size_t GetMemorySize() const override
+    {
+        return m_Loaded ? MegaByte : 0;
+    }
+
+    size_t GetInterfaceMemorySize() const override
+    {
+        return MegaByte;
+    }
+
+    ENUM_VALUE(ResourceCategory) GetMemoryCategory() const override
+    {
+        return ResourceCategory::Textures;
+    }
+};
+
+namespace
+{
+    std::vector<Pointer<File>> CreateFiles(const size_t count)
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "xnor_budget";
+        std::filesystem::create_directories(directory);
+
+        std::vector<Pointer<File>> files;
+        for (size_t i = 0; i < count; i++)
+            files.push_back(FileManager::Add(directory / std::format("resource_{}.bin", i)));
+        return files;
+    }
+
+    // Uses every resource once per frame, in order
+    void UseInOrder(const std::vector<Pointer<File>>& files)
+    {
+        for (const Pointer<File>& file : files)
+        {
+            Time::Update();
+            (void) ResourceManager::Get<BudgetedResource>(file);
+        }
+
+        Time::Update();
+    }
+
+    void Cleanup(const std::vector<Pointer<File>>& files)
+    {
+        ResourceManager::SetMemoryBudget(ResourceCategory::Textures, 0);
+        ResourceManager::onResourceEvicted.Clear();
+        ResourceManager::onResourceRestored.Clear();
+
+        for (const Pointer<File>& file : files)
+        {
+            ResourceManager::Unload(file->GetPathString());
+            FileManager::Unload(file->GetPath());
+        }
+
+        BudgetedResource::loadCount = 0;
+        BudgetedResource::failLoad = false;
+    }
+}
+
+TEST(ResourceBudget, Stats)
+{
+    const std::vector<Pointer<File>> files = CreateFiles(3);
+
+    for (const Pointer<File>& file : files)
+        (void) ResourceManager::Load<BudgetedResource>(file);
+
+    const ResourceMemoryStats stats = ResourceManager::GetMemoryStats()[ResourceCategory::Textures];
+    EXPECT_EQ(stats.resourceCount, 3);
+    EXPECT_EQ(stats.cpuBytes, 3 * BudgetedResource::MegaByte);
+    EXPECT_EQ(stats.gpuBytes, 3 * BudgetedResource::MegaByte);
+    EXPECT_EQ(stats.evictedCount, 0);
+
+    // Without any budget, nothing gets evicted
+    Time::Update();
+    ResourceManager::EnforceMemoryBudgets();
+    EXPECT_EQ(ResourceManager::GetMemoryStats()[ResourceCategory::Textures].lastEvictionCount, 0);
+
+    Cleanup(files);
+}
+
+TEST(ResourceBudget, LruEviction)
+{
+    constexpr size_t ResourceCount = 5;
+
+    const std::vector<Pointer<File>> files = CreateFiles(ResourceCount);
+
+    for (const Pointer<File>& file : files)
+        (void) ResourceManager::Load<BudgetedResource>(file);
+
+    std::vector<std::string> evicted;
+    ResourceManager::onResourceEvicted += [&evicted](const Pointer<Resource>& resource) { evicted.push_back(resource->GetName()); };
+
+    // Each resource uses 2MB, so only 2 of them fit within the budget
+    ResourceManager::SetMemoryBudget(ResourceCategory::Textures, 5 * BudgetedResource::MegaByte);
+
+    {
+        // A referenced resource must never be evicted even if it is the least recently used one
+        const Pointer<BudgetedResource> pinned = ResourceManager::Get<BudgetedResource>(files[4]);
+
+        // Use the resources in reverse order so that the last file is the least recently used one
+        UseInOrder(std::vector(files.rbegin(), files.rend()));
+
+        ResourceManager::EnforceMemoryBudgets();
+
+        EXPECT_FALSE(pinned->IsEvicted());
+        EXPECT_TRUE(pinned->IsLoaded());
+    }
+
+    EXPECT_EQ(evicted, (std::vector { files[3]->GetPathString(), files[2]->GetPathString(), files[1]->GetPathString() }));
+
+    const ResourceMemoryStats stats = ResourceManager::GetMemoryStats()[ResourceCategory::Textures];
+    EXPECT_EQ(stats.lastEvictionCount, 3);
+    EXPECT_EQ(stats.evictedCount, 3);
+    EXPECT_EQ(stats.resourceCount, 2);
+    EXPECT_LE(stats.cpuBytes + stats.gpuBytes, stats.budget);
+
+    // Evicted resources are no longer loaded but are still known by the ResourceManager
+    EXPECT_TRUE(ResourceManager::Contains(files[3]));
+    ResourceManager::restoreEvictedOnGet = false;
+    EXPECT_FALSE(ResourceManager::Get(files[3])->IsLoaded());
+    ResourceManager::restoreEvictedOnGet = true;
+
+    Cleanup(files);
+}
+
+TEST(ResourceBudget, RestoreOnGet)
+{
+    const std::vector<Pointer<File>> files = CreateFiles(2);
+
+    for (const Pointer<File>& file : files)
+        (void) ResourceManager::Load<BudgetedResource>(file);
+
+    std::vector<std::string> restored;
+    ResourceManager::onResourceRestored += [&restored](const Pointer<Resource>& resource) { restored.push_back(resource->GetName()); };
+
+    UseInOrder(files);
+
+    ResourceManager::SetMemoryBudget(ResourceCategory::Textures, 2 * BudgetedResource::MegaByte);
+    ResourceManager::EnforceMemoryBudgets();
+    EXPECT_EQ(ResourceManager::GetMemoryStats()[ResourceCategory::Textures].lastEvictionCount, 1);
+
+    const uint32_t loadCount = BudgetedResource::loadCount;
+
+    // Retrieving the resource from another thread only decodes it
+    Pointer<BudgetedResource> resource;
+    std::thread([&resource, &files] { resource = ResourceManager::Get<BudgetedResource>(files[0]); }).join();
+    EXPECT_TRUE(resource->IsEvicted());
+    EXPECT_TRUE(resource->IsLoaded());
+    EXPECT_FALSE(resource->IsLoadedInInterface());
+    EXPECT_EQ(resource->GetLastUsedFrame(), Time::GetTotalFrameCount<uint64_t>());
+    EXPECT_EQ(BudgetedResource::loadCount, loadCount + 1);
+    EXPECT_TRUE(restored.empty());
+
+    // Retrieving it again doesn't decode it twice
+    (void) ResourceManager::Get<BudgetedResource>(files[0]);
+    EXPECT_EQ(BudgetedResource::loadCount, loadCount + 1);
+
+    // The main thread then creates it in the interface
+    ResourceManager::FinishRestores();
+    EXPECT_FALSE(resource->IsEvicted());
+    EXPECT_TRUE(resource->IsLoadedInInterface());
+    EXPECT_EQ(restored, std::vector { files[0]->GetPathString() });
+
+    // The restored resource was used during this frame, so it cannot be evicted right away
+    ResourceManager::EnforceMemoryBudgets();
+    EXPECT_FALSE(resource->IsEvicted());
+
+    Cleanup(files);
+}
+
+TEST(ResourceBudget, RestoreFailure)
+{
+    const std::vector<Pointer<File>> files = CreateFiles(1);
+
+    const Pointer<BudgetedResource> resource = ResourceManager::Load<BudgetedResource>(files[0]);
+
+    std::vector<std::string> restored;
+    ResourceManager::onResourceRestored += [&restored](const Pointer<Resource>& r) { restored.push_back(r->GetName()); };
+
+    ResourceManager::Evict(Pointer<Resource>(resource));
+
+    // A resource which can't be loaded back stays evicted
+    BudgetedResource::failLoad = true;
+    (void) ResourceManager::Get<BudgetedResource>(files[0]);
+    ResourceManager::FinishRestores();
+
+    EXPECT_TRUE(resource->IsEvicted());
+    EXPECT_FALSE(resource->IsLoaded());
+    EXPECT_FALSE(resource->IsLoadedInInterface());
+    EXPECT_TRUE(restored.empty());
+
+    // It is loaded back once it can be
+    BudgetedResource::failLoad = false;
+    (void) ResourceManager::Get<BudgetedResource>(files[0]);
+    ResourceManager::FinishRestores();
+
+    EXPECT_FALSE(resource->IsEvicted());
+    EXPECT_TRUE(resource->IsLoadedInInterface());
+    EXPECT_EQ(restored, std::vector { files[0]->GetPathString() });
+
+    Cleanup(files);
+}
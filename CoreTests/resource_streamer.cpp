@@ -0,0 +1,319 @@
+#include "pch.hpp"
+
+#include "file/file_manager.hpp"
+#include "resource/resource_manager.hpp"
+#include "resource/resource_streamer.hpp"
+
+class StreamedResource final : public Resource
+{
+public:
+    static inline std::vector<std::string> decodeOrder;
+    static inline std::vector<std::string> uploadOrder;
+    static inline std::vector<std::thread::id> decodeThreads;
+    static inline std::vector<std::thread::id> finishThreads;
+
+    static inline bool_t failFinish = false;
+
+    static inline std::chrono::microseconds uploadCost { 0 };
+    static inline size_t interfaceSize = 0;
+
+    using Resource::Resource;
+
+    using Resource::Load;
+
+    bool_t Load(const uint8_t* const, const int64_t) override
+    {
+        // Only one worker thread is used in these tests so this doesn't need to be synchronized
+        decodeOrder.push_back(m_Name);
+        decodeThreads.push_back(std::this_thread::get_id());
+        m_Loaded = true;
+        return true;
+    }
+
+    bool_t FinishDecode() override
+    {
+        finishThreads.push_back(std::this_thread::get_id());
+        return !failFinish;
+    }
+
+    void CreateInInterface() override
+    {
+        // Busy wait instead of sleeping as the sleep granularity is way too coarse on some platforms
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + uploadCost;
+        while (std::chrono::steady_clock::now() < end)
+        {
+        }
+
+        uploadOrder.push_back(m_Name);
+        m_LoadedInInterface = true;
+    }
+
+    void Unload() override
+    {
+        m_Loaded = false;
+    }
+
+    size_t GetInterfaceMemorySize() const override
+    {
+        return interfaceSize;
+    }
+};
+
+namespace
+{
+    std::filesystem::path StreamingDirectory()
+    {
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "xnor_streaming";
+        std::filesystem::create_directories(directory);
+        return directory;
+    }
+
+    std::vector<Pointer<File>> CreateFiles(const size_t count)
+    {
+        std::vector<Pointer<File>> files;
+        for (size_t i = 0; i < count; i++)
+            files.push_back(FileManager::Add(StreamingDirectory() / std::format("resource_{}.bin", i)));
+        return files;
+    }
+
+    void WaitForDecode(const std::vector<Pointer<StreamingRequest>>& requests)
+    {
+        using namespace std::chrono_literals;
+
+        const std::chrono::steady_clock::time_point timeout = std::chrono::steady_clock::now() + 10s;
+
+        for (const Pointer<StreamingRequest>& request : requests)
+        {
+            while ((request->GetState() == StreamingState::Queued || request->GetState() == StreamingState::Decoding) && std::chrono::steady_clock::now() < timeout)
+                std::this_thread::sleep_for(1ms);
+        }
+    }
+
+    void Cleanup(const std::vector<Pointer<File>>& files)
+    {
+        ResourceStreamer::Shutdown();
+        ResourceStreamer::budget = {};
+
+        for (const Pointer<File>& file : files)
+        {
+            ResourceManager::Unload(file->GetPathString());
+            FileManager::Unload(file->GetPath());
+        }
+
+        StreamedResource::decodeOrder.clear();
+        StreamedResource::uploadOrder.clear();
+        StreamedResource::decodeThreads.clear();
+        StreamedResource::finishThreads.clear();
+        StreamedResource::failFinish = false;
+        StreamedResource::uploadCost = {};
+        StreamedResource::interfaceSize = 0;
+    }
+}
+
+TEST(ResourceStreamer, PriorityOrdering)
+{
+    const std::vector<Pointer<File>> files = CreateFiles(4);
+
+    ResourceStreamer::Initialize(1);
+    ResourceStreamer::Pause();
+
+    std::vector requests
+    {
+        ResourceManager::LoadAsync<StreamedResource>(files[0], LoadPriority::Background),
+        ResourceManager::LoadAsync<StreamedResource>(files[1], LoadPriority::Background),
+        ResourceManager::LoadAsync<StreamedResource>(files[2], LoadPriority::Nearby),
+        ResourceManager::LoadAsync<StreamedResource>(files[3], LoadPriority::Visible)
+    };
+
+    for (const Pointer<StreamingRequest>& request : requests)
+        EXPECT_EQ(request->GetState(), StreamingState::Queued);
+
+    ResourceStreamer::Resume();
+    WaitForDecode(requests);
+    ResourceStreamer::Update();
+
+    const std::vector expectedOrder
+    {
+        files[3]->GetPathString(),
+        files[2]->GetPathString(),
+        files[0]->GetPathString(),
+        files[1]->GetPathString()
+    };
+
+    EXPECT_EQ(StreamedResource::decodeOrder, expectedOrder);
+    EXPECT_EQ(StreamedResource::uploadOrder, expectedOrder);
+
+    for (const Pointer<StreamingRequest>& request : requests)
+    {
+        EXPECT_EQ(request->GetState(), StreamingState::Ready);
+        EXPECT_TRUE(request->GetResource()->IsLoadedInInterface());
+    }
+
+    Cleanup(files);
+}
+
+TEST(ResourceStreamer, Cancellation)
+{
+    const std::vector<Pointer<File>> files = CreateFiles(4);
+
+    ResourceStreamer::Initialize(1);
+    ResourceStreamer::Pause();
+
+    std::vector requests
+    {
+        ResourceManager::LoadAsync<StreamedResource>(files[0], LoadPriority::Visible),
+        ResourceManager::LoadAsync<StreamedResource>(files[1], LoadPriority::Visible),
+        ResourceManager::LoadAsync<StreamedResource>(files[2], LoadPriority::Visible)
+    };
+
+    // Cancel a request that hasn't been decoded yet
+    requests[1]->Cancel();
+    EXPECT_EQ(requests[1]->GetState(), StreamingState::Cancelled);
+
+    ResourceStreamer::Resume();
+    WaitForDecode(requests);
+
+    // Cancel a request that has been decoded but not uploaded yet
+    EXPECT_EQ(requests[2]->GetState(), StreamingState::Decoded);
+    requests[2]->Cancel();
+    EXPECT_EQ(requests[2]->GetState(), StreamingState::Cancelled);
+    EXPECT_FALSE(requests[2]->GetResource()->IsLoaded());
+
+    ResourceStreamer::Flush();
+
+    EXPECT_EQ(requests[0]->GetState(), StreamingState::Ready);
+    EXPECT_EQ(StreamedResource::decodeOrder, (std::vector { files[0]->GetPathString(), files[2]->GetPathString() }));
+    EXPECT_EQ(StreamedResource::uploadOrder, std::vector { files[0]->GetPathString() });
+    EXPECT_FALSE(requests[1]->GetResource()->IsLoaded());
+    EXPECT_FALSE(requests[2]->GetResource()->IsLoadedInInterface());
+
+    // Cancelling a finished request doesn't do anything
+    requests[0]->Cancel();
+    EXPECT_EQ(requests[0]->GetState(), StreamingState::Ready);
+
+    // Remaining requests are cancelled on shutdown
+    ResourceStreamer::Pause();
+    Pointer<StreamingRequest> pending = ResourceManager::LoadAsync<StreamedResource>(files[3], LoadPriority::Background);
+    ResourceStreamer::Shutdown();
+    EXPECT_EQ(pending->GetState(), StreamingState::Cancelled);
+
+    Cleanup(files);
+}
+
+TEST(ResourceStreamer, FinishOnMainThread)
+{
+    const std::vector<Pointer<File>> files = CreateFiles(3);
+
+    ResourceStreamer::Initialize(1);
+
+    std::vector requests
+    {
+        ResourceManager::LoadAsync<StreamedResource>(files[0], LoadPriority::Visible),
+        ResourceManager::LoadAsync<StreamedResource>(files[1], LoadPriority::Visible)
+    };
+
+    WaitForDecode(requests);
+
+    // The workers only decode, the loading is finished by the main thread
+    EXPECT_TRUE(StreamedResource::finishThreads.empty());
+    for (const std::thread::id id : StreamedResource::decodeThreads)
+        EXPECT_NE(id, std::this_thread::get_id());
+
+    ResourceStreamer::Update();
+
+    EXPECT_EQ(StreamedResource::finishThreads, std::vector(2, std::this_thread::get_id()));
+    for (const Pointer<StreamingRequest>& request : requests)
+        EXPECT_EQ(request->GetState(), StreamingState::Ready);
+
+    // A request which can't be finished fails without being uploaded
+    StreamedResource::failFinish = true;
+    Pointer<StreamingRequest> failed = ResourceManager::LoadAsync<StreamedResource>(files[2], LoadPriority::Visible);
+    WaitForDecode({ failed });
+    ResourceStreamer::Update();
+
+    EXPECT_EQ(failed->GetState(), StreamingState::Failed);
+    EXPECT_FALSE(failed->GetResource()->IsLoaded());
+    EXPECT_FALSE(failed->GetResource()->IsLoadedInInterface());
+    EXPECT_EQ(StreamedResource::uploadOrder.size(), 2);
+
+    Cleanup(files);
+}
+
+TEST(ResourceStreamer, ByteBudget)
+{
+    constexpr size_t ResourceCount = 6;
+    constexpr size_t MegaByte = 1024 * 1024;
+
+    const std::vector<Pointer<File>> files = CreateFiles(ResourceCount);
+
+    StreamedResource::interfaceSize = MegaByte;
+    ResourceStreamer::budget = { .milliseconds = 1000.f, .bytes = MegaByte * 5 / 2 };
+    ResourceStreamer::Initialize(1);
+
+    std::vector<Pointer<StreamingRequest>> requests;
+    for (const Pointer<File>& file : files)
+        requests.push_back(ResourceManager::LoadAsync<StreamedResource>(file, LoadPriority::Nearby));
+
+    WaitForDecode(requests);
+
+    for (size_t frame = 0; frame < ResourceCount / 2; frame++)
+    {
+        ResourceStreamer::Update();
+
+        const StreamingStats stats = ResourceStreamer::GetStats();
+        EXPECT_EQ(stats.uploadCount, 2);
+        EXPECT_LE(stats.uploadBytes, ResourceStreamer::budget.bytes);
+        EXPECT_EQ(stats.pendingUploads, ResourceCount - (frame + 1) * 2);
+    }
+
+    // A single resource bigger than the budget must still be uploaded
+    StreamedResource::interfaceSize = MegaByte * 10;
+    Pointer<StreamingRequest> big = ResourceManager::LoadAsync<StreamedResource>(FileManager::Add(StreamingDirectory() / "big.bin"), LoadPriority::Visible);
+    WaitForDecode({ big });
+    ResourceStreamer::Update();
+    EXPECT_EQ(big->GetState(), StreamingState::Ready);
+    EXPECT_EQ(ResourceStreamer::GetStats().uploadCount, 1);
+
+    ResourceManager::Unload(big->GetResource());
+    FileManager::Unload(StreamingDirectory() / "big.bin");
+    Cleanup(files);
+}
+
+TEST(ResourceStreamer, TimeBudget)
+{
+    using namespace std::chrono_literals;
+
+    constexpr size_t ResourceCount = 10;
+    constexpr float_t UploadCostMilliseconds = 2.f;
+
+    const std::vector<Pointer<File>> files = CreateFiles(ResourceCount);
+
+    StreamedResource::uploadCost = 2ms;
+    ResourceStreamer::budget = { .milliseconds = 5.f, .bytes = std::numeric_limits<size_t>::max() };
+    ResourceStreamer::Initialize(1);
+
+    std::vector<Pointer<StreamingRequest>> requests;
+    for (const Pointer<File>& file : files)
+        requests.push_back(ResourceManager::LoadAsync<StreamedResource>(file, LoadPriority::Background));
+
+    WaitForDecode(requests);
+
+    size_t uploaded = 0;
+    while (uploaded < ResourceCount)
+    {
+        ResourceStreamer::Update();
+
+        const StreamingStats stats = ResourceStreamer::GetStats();
+
+        // The budget can only be exceeded by the last upload of a frame
+        EXPECT_GE(stats.uploadCount, 1);
+        EXPECT_LE(stats.uploadCount, static_cast<uint32_t>(ResourceStreamer::budget.milliseconds / UploadCostMilliseconds) + 1);
+
+        uploaded += stats.uploadCount;
+    }
+
+    for (const Pointer<StreamingRequest>& request : requests)
+        EXPECT_EQ(request->GetState(), StreamingState::Ready);
+
+    Cleanup(files);
+}
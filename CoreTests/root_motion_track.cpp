@@ -0,0 +1,240 @@
+#include "pch.hpp"
+
+#include <cmath>
+#include <format>
+
+#include "rendering/animator.hpp"
+#include "rendering/root_motion_track.hpp"
+#include "resource/animation.hpp"
+#include "resource/skeleton.hpp"
+
+namespace
+{
+    constexpr uint32_t KeyCount = 30;
+    constexpr float_t StepLength = 0.1f;
+    constexpr float_t StepYaw = 0.02f;
+
+    // Root -> hips
+    Pointer<Skeleton> CreateSkeleton()
+    {
+        List<Bone> bones(2);
+        for (size_t i = 0; i < bones.GetSize(); i++)
+        {
+            bones[i].name = "Bone_" + std::to_string(i);
+            bones[i].id = static_cast<int32_t>(i);
+            bones[i].parentId = static_cast<int32_t>(i) - 1;
+            bones[i].global = Matrix::Identity();
+        }
+
+        Pointer<Skeleton> skeleton = Pointer<Skeleton>::New();
+        skeleton->Load(bones);
+        return skeleton;
+    }
+
+    // Animation of 1 second where the root walks forward while turning, and the hips sway
+    Pointer<Animation> CreateAnimation(const Pointer<Skeleton>& skeleton)
+    {
+        aiAnimation loadedData;
+        loadedData.mDuration = static_cast<double_t>(KeyCount);
+        loadedData.mTicksPerSecond = 30.0;
+        loadedData.mNumChannels = 2;
+        loadedData.mChannels = new aiNodeAnim*[2];
+
+        for (size_t i = 0; i < 2; i++)
+        {
+            aiNodeAnim* const channel = new aiNodeAnim;
+            channel->mNodeName = aiString(skeleton->GetBones()[i].name);
+            channel->mNumPositionKeys = KeyCount;
+            channel->mNumRotationKeys = KeyCount;
+            channel->mNumScalingKeys = 1;
+            channel->mPositionKeys = new aiVectorKey[KeyCount];
+            channel->mRotationKeys = new aiQuatKey[KeyCount];
+            channel->mScalingKeys = new aiVectorKey[1];
+            channel->mScalingKeys[0].mValue = aiVector3D(1.f);
+
+            for (uint32_t key = 0; key < KeyCount; key++)
+            {
+                const float_t k = static_cast<float_t>(key);
+                channel->mPositionKeys[key].mTime = static_cast<double_t>(key);
+                channel->mRotationKeys[key].mTime = static_cast<double_t>(key);
+
+                if (i == 0)
+                {
+                    channel->mPositionKeys[key].mValue = aiVector3D(0.f, 0.f, k * StepLength);
+                    channel->mRotationKeys[key].mValue = aiQuaternion(std::cos(k * StepYaw * 0.5f), 0.f, std::sin(k * StepYaw * 0.5f), 0.f);
+                }
+                else
+                {
+                    channel->mPositionKeys[key].mValue = aiVector3D(std::sin(k), 1.f, 0.f);
+                    channel->mRotationKeys[key].mValue = aiQuaternion(1.f, 0.f, 0.f, 0.f);
+                }
+            }
+
+            loadedData.mChannels[i] = channel;
+        }
+
+        Pointer<Animation> animation = Pointer<Animation>::New();
+        animation->Load(loadedData);
+        animation->BindSkeleton(skeleton);
+        return animation;
+    }
+
+    // Root transform of the pose of the animation
+    void SampleRoot(const Animation& animation, const float_t normalizedTime, Vector3* const translation, float_t* const yaw)
+    {
+        Quaternion rotation;
+        Vector3 scaling;
+        animation.SampleBone(0, normalizedTime, translation, &rotation, &scaling);
+        *yaw = RootMotionTrack::GetYaw(rotation);
+    }
+
+    // The root moves at a constant speed, including from the last key to the end of the loop
+    void ExpectDelta(const Animation& animation, const float_t normalizedTime, const float_t normalizedDelta)
+    {
+        Vector3 translation;
+        float_t yaw = 0.f;
+        animation.GetRootMotion().GetDelta(normalizedTime, normalizedDelta, &translation, &yaw);
+
+        const float_t frames = normalizedDelta * static_cast<float_t>(KeyCount);
+        EXPECT_NEAR((translation - Vector3(0.f, 0.f, frames * StepLength)).Length(), 0.f, 2e-2f) << std::format("From {} by {}", normalizedTime, normalizedDelta);
+        EXPECT_NEAR(yaw, frames * StepYaw, 2e-3f) << std::format("From {} by {}", normalizedTime, normalizedDelta);
+    }
+}
+
+TEST(RootMotionTrack, Yaw)
+{
+    constexpr float_t angle = 0.5f;
+    EXPECT_NEAR(RootMotionTrack::GetYaw(Quaternion(0.f, std::sin(angle * 0.5f), 0.f, std::cos(angle * 0.5f))), angle, 1e-5f);
+    EXPECT_NEAR(RootMotionTrack::GetYaw(Quaternion::Identity()), 0.f, 1e-6f);
+
+    // Two full turns in 8 steps, the angle keeps increasing past pi
+    constexpr size_t SampleCount = 8;
+    std::array<Vector3, SampleCount> translations;
+    std::array<Quaternion, SampleCount> rotations;
+    for (size_t i = 0; i < SampleCount; i++)
+    {
+        const float_t sampleAngle = static_cast<float_t>(i) * Calc::PiOver2;
+        translations[i] = Vector3(1.f + static_cast<float_t>(i), 0.f, 0.f);
+        rotations[i] = Quaternion(0.f, std::sin(sampleAngle * 0.5f), 0.f, std::cos(sampleAngle * 0.5f));
+    }
+
+    RootMotionTrack track;
+    track.Bake(translations.data(), rotations.data(), SampleCount);
+    EXPECT_EQ(track.GetSampleCount(), SampleCount + 1);
+    EXPECT_NEAR(track.GetLoopYaw(), 2.f * Calc::PiTimes2, 1e-4f);
+    EXPECT_NEAR((track.GetLoopTranslation() - Vector3(8.f, 0.f, 0.f)).Length(), 0.f, 1e-5f);
+
+    Vector3 translation;
+    float_t yaw = 0.f;
+    track.GetDelta(0.25f, 0.5f, &translation, &yaw);
+    EXPECT_NEAR(translation.x, 4.f, 1e-4f);
+    EXPECT_NEAR(yaw, Calc::PiTimes2, 1e-4f);
+}
+
+TEST(RootMotionTrack, Animation)
+{
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    Pointer<Animation> animation = CreateAnimation(skeleton);
+
+    const RootMotionTrack& rootMotion = animation->GetRootMotion();
+    EXPECT_EQ(rootMotion.GetSampleCount(), animation->GetFrameCount() + 1);
+    EXPECT_GT(animation->GetMemorySize(), rootMotion.GetMemorySize());
+    EXPECT_NEAR(rootMotion.GetLoopTranslation().z, StepLength * static_cast<float_t>(KeyCount), 2e-2f);
+    EXPECT_NEAR(rootMotion.GetLoopYaw(), StepYaw * static_cast<float_t>(KeyCount), 2e-3f);
+
+    // Within a loop, the track moves as much as the root of the poses
+    Vector3 start, end, translation;
+    float_t startYaw = 0.f, endYaw = 0.f, yaw = 0.f;
+    SampleRoot(*animation, 0.1f, &start, &startYaw);
+    SampleRoot(*animation, 0.7f, &end, &endYaw);
+    rootMotion.GetDelta(0.1f, 0.6f, &translation, &yaw);
+    EXPECT_NEAR((translation - (end - start)).Length(), 0.f, 2e-2f);
+    EXPECT_NEAR(yaw, endYaw - startYaw, 2e-3f);
+
+    // Within a loop, across the loop boundary, over several loops and backward
+    ExpectDelta(*animation, 0.1f, 0.3f);
+    ExpectDelta(*animation, 0.9f, 0.2f);
+    ExpectDelta(*animation, 0.25f, 2.5f);
+    ExpectDelta(*animation, 0.1f, -0.3f);
+
+    // Without a root track, there is no movement
+    animation->BindSkeleton(Pointer<Skeleton>());
+    EXPECT_EQ(animation->GetRootMotion().GetSampleCount(), 0);
+    animation->GetRootMotion().GetDelta(0.f, 1.f, &translation, &yaw);
+    EXPECT_EQ(translation, Vector3());
+    EXPECT_EQ(yaw, 0.f);
+}
+
+TEST(RootMotionTrack, Animator)
+{
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    const Pointer<Animation> animation = CreateAnimation(skeleton);
+    const RootMotionTrack& rootMotion = animation->GetRootMotion();
+
+    // Frame by frame across 2 loops and a half, the movement adds up to the movement of the whole time
+    Animator animator(animation);
+    Vector3 totalTranslation;
+    float_t totalYaw = 0.f;
+    for (size_t i = 0; i < 25; i++)
+    {
+        animator.Animate(0.1f);
+
+        Vector3 translation;
+        float_t yaw = 0.f;
+        animator.GetRootMotion(&translation, &yaw);
+        totalTranslation += translation;
+        totalYaw += yaw;
+    }
+
+    EXPECT_NEAR((totalTranslation - rootMotion.GetLoopTranslation() * 2.5f).Length(), 0.f, 5e-2f);
+    EXPECT_NEAR(totalYaw, rootMotion.GetLoopYaw() * 2.5f, 5e-3f);
+
+    // A single large step moves by as much
+    Animator hitchAnimator(animation);
+    hitchAnimator.Animate(2.5f);
+    Vector3 translation;
+    float_t yaw = 0.f;
+    hitchAnimator.GetRootMotion(&translation, &yaw);
+    EXPECT_NEAR((translation - rootMotion.GetLoopTranslation() * 2.5f).Length(), 0.f, 5e-2f);
+    EXPECT_NEAR(yaw, rootMotion.GetLoopYaw() * 2.5f, 5e-3f);
+}
+
+TEST(RootMotionTrack, Consumed)
+{
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    const Pointer<Animation> animation = CreateAnimation(skeleton);
+    const RootMotionTrack& rootMotion = animation->GetRootMotion();
+
+    Animator animator(animation);
+    animator.SetRootMotionConsumed(true);
+    Animator movingAnimator(animation);
+
+    Vector3 totalTranslation;
+    float_t totalYaw = 0.f;
+    for (size_t i = 0; i < 25; i++)
+    {
+        animator.Animate(0.1f);
+        movingAnimator.Animate(0.1f);
+
+        Vector3 translation;
+        float_t yaw = 0.f;
+        animator.GetRootMotion(&translation, &yaw);
+        totalTranslation += translation;
+        totalYaw += yaw;
+
+        // The root stays where the animation starts while the movement code moves the character
+        const Matrix& root = animator.GetMatrices()[0];
+        for (size_t j = 0; j < 4; j++)
+        {
+            for (size_t k = 0; k < 4; k++)
+                EXPECT_NEAR(root[j][k], Matrix::Identity()[j][k], 1e-4f) << std::format("Frame {}", i);
+        }
+    }
+
+    EXPECT_NEAR((totalTranslation - rootMotion.GetLoopTranslation() * 2.5f).Length(), 0.f, 5e-2f);
+    EXPECT_NEAR(totalYaw, rootMotion.GetLoopYaw() * 2.5f, 5e-3f);
+
+    // The other bones still move, and the root moves when the root motion isn't consumed
+    EXPECT_NE(animator.GetMatrices()[1], Matrix::Identity());
+    EXPECT_NE(movingAnimator.GetMatrices()[0], Matrix::Identity());
+}
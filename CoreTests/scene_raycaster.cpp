@@ -0,0 +1,319 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <format>
+#include <numbers>
+#include <random>
+
+#include "world/scene_raycaster.hpp"
+
+namespace
+{
+    constexpr size_t InstanceCount = 10000;
+    constexpr size_t RayCount = 1000;
+
+    Vertex CreateVertex(const Vector3& position)
+    {
+        Vertex vertex;
+        vertex.position = position;
+        return vertex;
+    }
+
+    // UV sphere of radius 1, which has a triangle count close to a small prop
+    void LoadSphere(Model* const model, const uint32_t rings, const uint32_t segments)
+    {
+        std::vector<Vertex> vertices;
+        for (uint32_t ring = 0; ring <= rings; ring++)
+        {
+            const float_t phi = std::numbers::pi_v<float_t> * static_cast<float_t>(ring) / static_cast<float_t>(rings);
+            for (uint32_t segment = 0; segment <= segments; segment++)
+            {
+                const float_t theta = 2.f * std::numbers::pi_v<float_t> * static_cast<float_t>(segment) / static_cast<float_t>(segments);
+                vertices.push_back(CreateVertex(Vector3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta))));
+            }
+        }
+
+        std::vector<uint32_t> indices;
+        for (uint32_t ring = 0; ring < rings; ring++)
+        {
+            for (uint32_t segment = 0; segment < segments; segment++)
+            {
+                const uint32_t current = ring * (segments + 1) + segment;
+                const uint32_t below = current + segments + 1;
+                indices.insert(indices.end(), { current, below, current + 1, current + 1, below, below + 1 });
+            }
+        }
+
+        model->Load(std::move(vertices), std::move(indices), Bound(Vector3::Zero(), Vector3(2.f)));
+    }
+
+    // Closest triangle of a model hit by a ray, testing all of them
+    bool_t RaycastBruteForce(const Model& model, const Ray& ray, float_t* const distance)
+    {
+        const std::vector<Vertex>& vertices = model.GetVertices();
+        const std::vector<uint32_t>& indices = model.GetIndices();
+
+        bool_t hit = false;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            float_t triangleDistance = 0.f;
+            if (ray.Intersect(vertices[indices[i]].position, vertices[indices[i + 1]].position, vertices[indices[i + 2]].position, &triangleDistance) && triangleDistance < *distance)
+            {
+                *distance = triangleDistance;
+                hit = true;
+            }
+        }
+
+        return hit;
+    }
+
+    // Closest instance hit by a ray, testing all of them
+    bool_t RaycastBruteForce(const SceneRaycaster& raycaster, const Ray& ray, Entity** const entity, float_t* const distance)
+    {
+        bool_t hit = false;
+        for (const RaycastInstance& instance : raycaster.GetInstances())
+        {
+            if (SceneRaycaster::Intersect(instance, ray, distance))
+            {
+                *entity = instance.entity;
+                hit = true;
+            }
+        }
+
+        return hit;
+    }
+
+    // Instances scattered in a box, a tenth of them only tested through their AABB like skinned meshes
+    void AddInstances(SceneRaycaster* const raycaster, const Model& model, std::vector<Entity>* const entities, std::mt19937* const random)
+    {
+        const float_t worldSize = 50.f * std::cbrt(static_cast<float_t>(entities->size()) / 1000.f);
+        std::uniform_real_distribution position(-worldSize, worldSize);
+        std::uniform_real_distribution angle(0.f, 2.f * std::numbers::pi_v<float_t>);
+        std::uniform_real_distribution scale(0.5f, 2.f);
+
+        for (size_t i = 0; i < entities->size(); i++)
+        {
+            const Vector3 translation(position(*random), position(*random), position(*random));
+            const Matrix worldMatrix = Matrix::Trs(
+                translation,
+                Vector3(angle(*random), angle(*random), angle(*random)),
+                Vector3(scale(*random), scale(*random), scale(*random))
+            );
+
+            if (i % 10 == 0)
+                raycaster->AddInstance(&(*entities)[i], Bound(translation, Vector3(scale(*random) * 2.f)));
+            else
+                raycaster->AddInstance(&(*entities)[i], worldMatrix, model);
+        }
+    }
+
+    // Rays from around the scene towards its center, like the editor camera looking at it
+    Ray CreateRay(std::mt19937* const random, const float_t worldSize)
+    {
+        std::uniform_real_distribution position(-worldSize, worldSize);
+        const Vector3 origin(position(*random), worldSize * 2.f, position(*random) - worldSize * 2.f);
+        const Vector3 target(position(*random) * 0.5f, position(*random) * 0.5f, position(*random) * 0.5f);
+
+        return Ray(origin, (target - origin).Normalized());
+    }
+}
+
+TEST(SceneRaycaster, ModelTriangles)
+{
+    Model model;
+    LoadSphere(&model, 32, 64);
+
+    // Each triangle is in a single leaf
+    const Bvh& bvh = model.GetBvh();
+    std::vector<uint32_t> primitives = bvh.GetPrimitives();
+    std::ranges::sort(primitives);
+    EXPECT_EQ(primitives.size(), model.GetIndices().size() / 3);
+    for (size_t i = 0; i < primitives.size(); i++)
+        EXPECT_EQ(primitives[i], i);
+
+    for (const BvhNode& node : bvh.GetNodes())
+        EXPECT_LE(node.count, Bvh::MaxLeafSize);
+
+    std::mt19937 random(1);
+    uint32_t hitCount = 0;
+    for (size_t i = 0; i < RayCount; i++)
+    {
+        const Ray ray = CreateRay(&random, 1.5f);
+
+        float_t distance = std::numeric_limits<float_t>::max();
+        float_t expectedDistance = std::numeric_limits<float_t>::max();
+        const bool_t hit = model.Raycast(ray, &distance);
+        ASSERT_EQ(hit, RaycastBruteForce(model, ray, &expectedDistance)) << std::format("Ray {}", i);
+
+        if (hit)
+        {
+            EXPECT_FLOAT_EQ(distance, expectedDistance) << std::format("Ray {}", i);
+            hitCount++;
+        }
+    }
+
+    // Both cases are tested
+    EXPECT_GT(hitCount, 0);
+    EXPECT_LT(hitCount, RayCount);
+}
+
+TEST(SceneRaycaster, Instances)
+{
+    Model model;
+    LoadSphere(&model, 8, 16);
+
+    std::mt19937 random(2);
+    std::vector<Entity> entities(1000);
+    SceneRaycaster raycaster;
+    AddInstances(&raycaster, model, &entities, &random);
+    raycaster.Build();
+
+    uint32_t hitCount = 0;
+    for (size_t i = 0; i < RayCount; i++)
+    {
+        const Ray ray = CreateRay(&random, 50.f);
+
+        Entity* entity = nullptr;
+        Entity* expectedEntity = nullptr;
+        float_t distance = std::numeric_limits<float_t>::max();
+        float_t expectedDistance = std::numeric_limits<float_t>::max();
+        const bool_t hit = raycaster.Raycast(ray, &entity, &distance);
+        ASSERT_EQ(hit, RaycastBruteForce(raycaster, ray, &expectedEntity, &expectedDistance)) << std::format("Ray {}", i);
+
+        if (hit)
+        {
+            EXPECT_EQ(entity, expectedEntity) << std::format("Ray {}", i);
+            EXPECT_FLOAT_EQ(distance, expectedDistance) << std::format("Ray {}", i);
+            hitCount++;
+        }
+    }
+
+    EXPECT_GT(hitCount, 0);
+    EXPECT_LT(hitCount, RayCount);
+
+    // A maximum distance in front of the first hit discards it
+    const Ray ray(Vector3(0.f, 0.f, -1000.f), Vector3::UnitZ());
+    Entity* entity = nullptr;
+    float_t distance = std::numeric_limits<float_t>::max();
+    if (raycaster.Raycast(ray, &entity, &distance))
+    {
+        float_t shorterDistance = distance * 0.5f;
+        EXPECT_FALSE(raycaster.Raycast(ray, &entity, &shorterDistance));
+    }
+}
+
+TEST(SceneRaycaster, Refit)
+{
+    std::mt19937 random(4);
+    std::uniform_real_distribution position(-50.f, 50.f);
+    std::uniform_real_distribution offset(-5.f, 5.f);
+
+    std::vector<Bound> bounds;
+    for (size_t i = 0; i < 1000; i++)
+        bounds.emplace_back(Vector3(position(random), position(random), position(random)), Vector3(2.f));
+
+    Bvh bvh;
+    bvh.Build(bounds);
+    const size_t nodeCount = bvh.GetNodes().size();
+
+    // The primitives move, the tree keeps its nodes and only their AABB follow
+    for (Bound& bound : bounds)
+        bound.center += Vector3(offset(random), offset(random), offset(random));
+    bvh.Refit(bounds);
+    EXPECT_EQ(bvh.GetNodes().size(), nodeCount);
+
+    const auto intersect = [&bounds](const Ray& ray, const uint32_t primitive, float_t* const distance) -> bool_t
+    {
+        float_t boundDistance = 0.f;
+        if (!ray.Intersect(bounds[primitive], *distance, &boundDistance) || boundDistance >= *distance)
+            return false;
+
+        *distance = boundDistance;
+        return true;
+    };
+
+    uint32_t hitCount = 0;
+    for (size_t i = 0; i < RayCount; i++)
+    {
+        const Ray ray = CreateRay(&random, 50.f);
+
+        float_t distance = std::numeric_limits<float_t>::max();
+        uint32_t primitive = 0;
+        const bool_t hit = bvh.Raycast(
+            ray,
+            [&](const uint32_t hitPrimitive, float_t* const closestDistance) -> bool_t { return intersect(ray, hitPrimitive, closestDistance); },
+            &distance,
+            &primitive
+        );
+
+        bool_t expectedHit = false;
+        float_t expectedDistance = std::numeric_limits<float_t>::max();
+        for (uint32_t j = 0; j < static_cast<uint32_t>(bounds.size()); j++)
+            expectedHit |= intersect(ray, j, &expectedDistance);
+
+        ASSERT_EQ(hit, expectedHit) << std::format("Ray {}", i);
+        if (hit)
+        {
+            EXPECT_FLOAT_EQ(distance, expectedDistance) << std::format("Ray {}", i);
+            hitCount++;
+        }
+    }
+
+    EXPECT_GT(hitCount, 0);
+}
+
+TEST(SceneRaycaster, Benchmark)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    Model model;
+    LoadSphere(&model, 16, 32);
+
+    std::mt19937 random(3);
+    std::vector<Entity> entities(InstanceCount);
+    SceneRaycaster raycaster;
+    AddInstances(&raycaster, model, &entities, &random);
+
+    const Clock::time_point buildStart = Clock::now();
+    raycaster.Build();
+    const double_t buildTime = std::chrono::duration<double_t, std::milli>(Clock::now() - buildStart).count();
+
+    std::vector<Ray> rays;
+    const float_t worldSize = 50.f * std::cbrt(static_cast<float_t>(InstanceCount) / 1000.f);
+    for (size_t i = 0; i < RayCount; i++)
+        rays.push_back(CreateRay(&random, worldSize));
+
+    uint32_t hitCount = 0;
+    const Clock::time_point bvhStart = Clock::now();
+    for (const Ray& ray : rays)
+    {
+        Entity* entity = nullptr;
+        float_t distance = std::numeric_limits<float_t>::max();
+        hitCount += raycaster.Raycast(ray, &entity, &distance);
+    }
+    const double_t bvhTime = std::chrono::duration<double_t, std::milli>(Clock::now() - bvhStart).count();
+
+    uint32_t bruteForceHitCount = 0;
+    const Clock::time_point bruteForceStart = Clock::now();
+    for (const Ray& ray : rays)
+    {
+        Entity* entity = nullptr;
+        float_t distance = std::numeric_limits<float_t>::max();
+        bruteForceHitCount += RaycastBruteForce(raycaster, ray, &entity, &distance);
+    }
+    const double_t bruteForceTime = std::chrono::duration<double_t, std::milli>(Clock::now() - bruteForceStart).count();
+
+    EXPECT_EQ(hitCount, bruteForceHitCount);
+
+    std::cout << std::format(
+        "{} instances of {} triangles: top-level build {:.2f} ms, {:.4f} ms per ray with the BVH, {:.4f} ms per ray testing every instance\n",
+        InstanceCount,
+        model.GetIndices().size() / 3,
+        buildTime,
+        bvhTime / RayCount,
+        bruteForceTime / RayCount
+    );
+    RecordProperty("build_ms", std::format("{:.3f}", buildTime));
+    RecordProperty("bvh_ray_ms", std::format("{:.5f}", bvhTime / RayCount));
+    RecordProperty("brute_force_ray_ms", std::format("{:.5f}", bruteForceTime / RayCount));
+}
@@ -0,0 +1,184 @@
+#include "pch.hpp"
+
+#include "rendering/shader_preprocessor.hpp"
+#include "resource/shader.hpp"
+
+namespace
+{
+    const std::vector<std::string> Features = { "SKINNED", "POINT_LIGHT", "ALPHA_TEST" };
+
+    constexpr uint32_t Skinned = 1 << 0;
+    constexpr uint32_t PointLight = 1 << 1;
+    constexpr uint32_t AlphaTest = 1 << 2;
+
+    constexpr std::string_view VertexSource =
+        "#version 460 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "#ifdef SKINNED\n"
+        "layout (location = 5) in vec4 aBoneIndices;\n"
+        "#endif\n"
+        "#if defined(POINT_LIGHT) && !SKINNED\n"
+        "out vec3 WorldPos;\n"
+        "#elif defined POINT_LIGHT\n"
+        "out vec3 SkinnedWorldPos;\n"
+        "#else\n"
+        "#ifndef SKINNED\n"
+        "// Static\n"
+        "#endif\n"
+        "#endif\n"
+        "void main() {}\n";
+
+    constexpr std::string_view FragmentSource =
+        "#version 460 core\n"
+        "#ifdef POINT_LIGHT\n"
+        "in vec3 WorldPos;\n"
+        "#endif\n"
+        "void main() {}\n";
+
+    std::string Preprocess(const std::string_view source, const uint32_t features)
+    {
+        std::string result;
+        EXPECT_TRUE(ShaderPreprocessor::Preprocess(source, Features, features, &result));
+        return result;
+    }
+}
+
+TEST(ShaderPreprocessor, Conditionals)
+{
+    EXPECT_EQ(
+        Preprocess(VertexSource, 0),
+        "#version 460 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "// Static\n"
+        "void main() {}\n"
+    );
+
+    EXPECT_EQ(
+        Preprocess(VertexSource, Skinned),
+        "#version 460 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "layout (location = 5) in vec4 aBoneIndices;\n"
+        "void main() {}\n"
+    );
+
+    EXPECT_EQ(
+        Preprocess(VertexSource, PointLight),
+        "#version 460 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "out vec3 WorldPos;\n"
+        "void main() {}\n"
+    );
+
+    EXPECT_EQ(
+        Preprocess(VertexSource, Skinned | PointLight),
+        "#version 460 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "layout (location = 5) in vec4 aBoneIndices;\n"
+        "out vec3 SkinnedWorldPos;\n"
+        "void main() {}\n"
+    );
+
+    // Features that aren't used don't change the output
+    EXPECT_EQ(Preprocess(VertexSource, Skinned | AlphaTest), Preprocess(VertexSource, Skinned));
+}
+
+TEST(ShaderPreprocessor, Defines)
+{
+    // Conditionals that don't only depend on features are left to the driver, with the features they use defined to 1 or 0
+    constexpr std::string_view source =
+        "#version 460 core\n"
+        "#if SKINNED && MAX_BONES > 64\n"
+        "#define LARGE_SKELETON\n"
+        "#endif\n";
+
+    EXPECT_EQ(
+        Preprocess(source, Skinned),
+        "#version 460 core\n"
+        "#define SKINNED 1\n"
+        "#if SKINNED && MAX_BONES > 64\n"
+        "#define LARGE_SKELETON\n"
+        "#endif\n"
+    );
+
+    EXPECT_EQ(
+        Preprocess(source, AlphaTest),
+        "#version 460 core\n"
+        "#define SKINNED 0\n"
+        "#if SKINNED && MAX_BONES > 64\n"
+        "#define LARGE_SKELETON\n"
+        "#endif\n"
+    );
+
+    // As disabled features are defined, their defined checks are replaced by their value
+    constexpr std::string_view definedSource =
+        "#version 460 core\n"
+        "#if defined(SKINNED) && MAX_BONES > 64\n"
+        "#elif defined POINT_LIGHT || defined(OTHER)\n"
+        "#endif\n";
+
+    EXPECT_EQ(
+        Preprocess(definedSource, Skinned),
+        "#version 460 core\n"
+        "#if 1 && MAX_BONES > 64\n"
+        "#elif 0 || defined(OTHER)\n"
+        "#endif\n"
+    );
+
+    // Lines of unresolved conditionals are still removed from inactive branches
+    EXPECT_EQ(Preprocess("#ifdef ALPHA_TEST\n#ifdef OTHER\n#endif\n#endif\nvoid main() {}\n", 0), "void main() {}\n");
+}
+
+TEST(ShaderPreprocessor, InvalidSource)
+{
+    std::string result;
+    EXPECT_FALSE(ShaderPreprocessor::Preprocess("#ifdef SKINNED\n", Features, Skinned, &result));
+    EXPECT_FALSE(ShaderPreprocessor::Preprocess("#endif\n", Features, Skinned, &result));
+    EXPECT_FALSE(ShaderPreprocessor::Preprocess("#ifdef SKINNED\n#elif OTHER\n#endif\n", Features, 0, &result));
+
+    const std::vector<std::string> tooManyFeatures(ShaderPreprocessor::MaxFeatures + 1, "FEATURE");
+    EXPECT_FALSE(ShaderPreprocessor::Preprocess("", tooManyFeatures, 0, &result));
+}
+
+TEST(ShaderPreprocessor, Features)
+{
+    EXPECT_EQ(ShaderPreprocessor::GetFeatureMask(Features, "POINT_LIGHT"), PointLight);
+    EXPECT_EQ(ShaderPreprocessor::GetFeatureMask(Features, "NORMAL_MAP"), 0);
+
+    EXPECT_EQ(ShaderPreprocessor::GetVariantName(Features, Skinned | AlphaTest), "SKINNED|ALPHA_TEST");
+    EXPECT_EQ(ShaderPreprocessor::GetVariantName(Features, 0), "");
+
+    // Every feature is defined, in the order they were declared
+    const std::string defines = ShaderPreprocessor::GetDefines(Features, Skinned | AlphaTest);
+    EXPECT_EQ(defines.find("#define SKINNED 1\n"), 0);
+    EXPECT_NE(defines.find("#define ALPHA_TEST 1\n"), std::string::npos);
+    EXPECT_NE(defines.find("#define POINT_LIGHT 0\n"), std::string::npos);
+    EXPECT_NE(defines, ShaderPreprocessor::GetDefines(Features, Skinned));
+}
+
+TEST(ShaderPreprocessor, Variants)
+{
+    Pointer<Shader> shader = Pointer<Shader>::New("variants");
+    shader->Load(VertexSource.data(), static_cast<int64_t>(VertexSource.size()), ShaderPipeline::Vertex);
+    shader->Load(FragmentSource.data(), static_cast<int64_t>(FragmentSource.size()), ShaderPipeline::Fragment);
+    shader->SetFeatures(Features);
+
+    const Pointer<Shader> skinned = shader->GetVariant(Skinned);
+    ASSERT_TRUE(skinned.IsValid());
+    EXPECT_EQ(skinned->GetName(), "variants[SKINNED]");
+    EXPECT_EQ(skinned->GetCode(ShaderPipeline::Vertex).code, Preprocess(VertexSource, Skinned));
+    EXPECT_EQ(skinned->GetCode(ShaderPipeline::Fragment).code, Preprocess(FragmentSource, Skinned));
+    EXPECT_TRUE(skinned->GetCode(ShaderPipeline::Geometry).code.empty());
+
+    // Same key
+    EXPECT_EQ(shader->GetVariant(Skinned).Get(), skinned.Get());
+
+    // Identical preprocessed sources share the same program
+    EXPECT_EQ(shader->GetVariant(Skinned | AlphaTest).Get(), skinned.Get());
+    EXPECT_EQ(shader->GetVariantProgramCount(), 1);
+
+    EXPECT_NE(shader->GetVariant(Skinned | PointLight).Get(), skinned.Get());
+    EXPECT_EQ(shader->GetVariantProgramCount(), 2);
+
+    // Unknown features
+    EXPECT_FALSE(shader->GetVariant(1 << 3).IsValid());
+}
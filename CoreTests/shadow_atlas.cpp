@@ -0,0 +1,187 @@
+#include "pch.hpp"
+
+#include <format>
+#include <random>
+
+#include "rendering/light/shadow_atlas.hpp"
+
+namespace
+{
+    constexpr int32_t AtlasSize = 4096;
+    constexpr int32_t MinTileSize = 128;
+    constexpr int32_t MaxTileSize = 2048;
+
+    bool_t Overlap(const ShadowAtlasTile& a, const ShadowAtlasTile& b)
+    {
+        return a.offset.x < b.offset.x + b.size && b.offset.x < a.offset.x + a.size && a.offset.y < b.offset.y + b.size && b.offset.y < a.offset.y + a.size;
+    }
+
+    void CheckTiles(const ShadowAtlas& atlas)
+    {
+        const std::vector<ShadowAtlasTile>& tiles = atlas.GetTiles();
+        for (size_t i = 0; i < tiles.size(); i++)
+        {
+            if (tiles[i].size == 0)
+                continue;
+
+            EXPECT_GE(tiles[i].offset.x, 0);
+            EXPECT_GE(tiles[i].offset.y, 0);
+            EXPECT_LE(tiles[i].offset.x + tiles[i].size, atlas.GetSize());
+            EXPECT_LE(tiles[i].offset.y + tiles[i].size, atlas.GetSize());
+            // Tiles are aligned on their size
+            EXPECT_EQ(tiles[i].offset.x % tiles[i].size, 0);
+            EXPECT_EQ(tiles[i].offset.y % tiles[i].size, 0);
+
+            for (size_t j = i + 1; j < tiles.size(); j++)
+            {
+                if (tiles[j].size != 0)
+                    EXPECT_FALSE(Overlap(tiles[i], tiles[j])) << std::format("Tiles {} and {} overlap", i, j);
+            }
+        }
+    }
+}
+
+TEST(ShadowAtlas, Resolution)
+{
+    const int32_t handles[4] = {};
+
+    ShadowAtlas atlas(AtlasSize, MinTileSize, MaxTileSize);
+    atlas.Update(
+        {
+            { .handle = &handles[0], .resolution = 10.f },
+            { .handle = &handles[1], .resolution = 300.f },
+            { .handle = &handles[2], .resolution = 1024.f },
+            { .handle = &handles[3], .resolution = 10000.f }
+        }
+    );
+    CheckTiles(atlas);
+
+    const std::vector<ShadowAtlasTile>& tiles = atlas.GetTiles();
+    EXPECT_EQ(tiles[0].size, MinTileSize);
+    EXPECT_EQ(tiles[1].size, 512);
+    EXPECT_EQ(tiles[2].size, 1024);
+    EXPECT_EQ(tiles[3].size, MaxTileSize);
+
+    for (const ShadowAtlasTile& tile : tiles)
+        EXPECT_TRUE(tile.changed);
+}
+
+TEST(ShadowAtlas, Packing)
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution resolution(50.f, 3000.f);
+
+    std::vector<int32_t> handles(200);
+    std::vector<ShadowAtlasRequest> requests(handles.size());
+    for (size_t i = 0; i < handles.size(); i++)
+        requests[i] = { .handle = &handles[i], .resolution = resolution(random) };
+
+    ShadowAtlas atlas(AtlasSize, MinTileSize, MaxTileSize);
+    atlas.Update(requests);
+    CheckTiles(atlas);
+
+    // Far more requests than what fits, the atlas must be nearly full
+    EXPECT_GE(atlas.GetOccupancy(), 0.95f);
+    EXPECT_LE(atlas.GetOccupancy(), 1.f);
+
+    // The most important shadow maps keep the largest tiles
+    const std::vector<ShadowAtlasTile>& tiles = atlas.GetTiles();
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        for (size_t j = 0; j < requests.size(); j++)
+        {
+            if (requests[i].resolution > requests[j].resolution)
+                EXPECT_GE(tiles[i].size, tiles[j].size);
+        }
+    }
+
+    std::cout << std::format("{} requests: {:.1f}% occupancy\n", requests.size(), atlas.GetOccupancy() * 100.f);
+    RecordProperty("occupancy", std::format("{:.3f}", atlas.GetOccupancy()));
+}
+
+TEST(ShadowAtlas, Stability)
+{
+    std::mt19937 random(2);
+    std::uniform_real_distribution resolution(200.f, 900.f);
+
+    std::vector<int32_t> handles(12);
+    std::vector<ShadowAtlasRequest> requests(handles.size());
+    for (size_t i = 0; i < handles.size(); i++)
+        requests[i] = { .handle = &handles[i], .resolution = resolution(random) };
+
+    ShadowAtlas atlas(AtlasSize, MinTileSize, MaxTileSize);
+    atlas.Update(requests);
+    CheckTiles(atlas);
+    const std::vector<ShadowAtlasTile> firstTiles = atlas.GetTiles();
+
+    // Small variations of the resolution keep the same tiles
+    std::uniform_real_distribution variation(1.f - ShadowAtlas::Hysteresis * 0.5f, 1.f + ShadowAtlas::Hysteresis * 0.5f);
+    for (size_t frame = 0; frame < 100; frame++)
+    {
+        std::vector<ShadowAtlasRequest> frameRequests = requests;
+        for (ShadowAtlasRequest& request : frameRequests)
+            request.resolution *= variation(random);
+
+        atlas.Update(frameRequests);
+
+        for (size_t i = 0; i < requests.size(); i++)
+        {
+            EXPECT_FALSE(atlas.GetTiles()[i].changed);
+            EXPECT_EQ(atlas.GetTiles()[i].size, firstTiles[i].size);
+            EXPECT_EQ(atlas.GetTiles()[i].offset, firstTiles[i].offset);
+        }
+    }
+
+    // Removing a light doesn't move the others
+    requests.erase(requests.begin() + 5);
+    atlas.Update(requests);
+    CheckTiles(atlas);
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        const ShadowAtlasTile& firstTile = firstTiles[i < 5 ? i : i + 1];
+        EXPECT_FALSE(atlas.GetTiles()[i].changed);
+        EXPECT_EQ(atlas.GetTiles()[i].offset, firstTile.offset);
+    }
+
+    // Neither does adding one, nor resizing one
+    int32_t newHandle = 0;
+    requests.push_back({ .handle = &newHandle, .resolution = 200.f });
+    requests[0].resolution = 50.f;
+    atlas.Update(requests);
+    CheckTiles(atlas);
+
+    EXPECT_EQ(atlas.GetRepackCount(), 0);
+    EXPECT_TRUE(atlas.GetTiles()[0].changed);
+    EXPECT_TRUE(atlas.GetTiles().back().changed);
+    for (size_t i = 1; i < requests.size() - 1; i++)
+        EXPECT_FALSE(atlas.GetTiles()[i].changed);
+}
+
+TEST(ShadowAtlas, Repack)
+{
+    std::vector<int32_t> handles(16);
+    std::vector<ShadowAtlasRequest> requests(handles.size());
+    for (size_t i = 0; i < handles.size(); i++)
+        requests[i] = { .handle = &handles[i], .resolution = 1024.f };
+
+    // Every other tile is freed, the space left is fragmented
+    ShadowAtlas atlas(AtlasSize, MinTileSize, MaxTileSize);
+    atlas.Update(requests);
+    EXPECT_FLOAT_EQ(atlas.GetOccupancy(), 1.f);
+
+    std::vector<ShadowAtlasRequest> remaining;
+    for (size_t i = 0; i < requests.size(); i += 2)
+        remaining.push_back(requests[i]);
+    atlas.Update(remaining);
+    EXPECT_EQ(atlas.GetRepackCount(), 0);
+
+    // A large tile can only fit by moving the others
+    int32_t newHandle = 0;
+    remaining.push_back({ .handle = &newHandle, .resolution = 2048.f });
+    atlas.Update(remaining);
+    CheckTiles(atlas);
+
+    EXPECT_EQ(atlas.GetRepackCount(), 1);
+    EXPECT_EQ(atlas.GetTiles().back().size, MaxTileSize);
+    EXPECT_FLOAT_EQ(atlas.GetOccupancy(), 0.75f);
+}
@@ -0,0 +1,104 @@
+#include "pch.hpp"
+
+#include "Maths/calc.hpp"
+#include "rendering/light/shadow_cache.hpp"
+
+namespace
+{
+    // Light at the origin looking towards -Z, seeing up to 50 units
+    Matrix GetViewProjection(const Vector3& position)
+    {
+        return Matrix::Perspective(90.f * Calc::Deg2Rad, 1.f, 0.1f, 50.f) * Matrix::LookAt(position, position - Vector3::UnitZ(), Vector3::UnitY());
+    }
+
+    ShadowCaster CreateCaster(const void* const handle, const Vector3& position)
+    {
+        return { .handle = handle, .transform = Matrix::Translation(position), .bound = Bound(position, Vector3(1.f)) };
+    }
+}
+
+TEST(ShadowCache, Reuse)
+{
+    const int32_t handles[2] = {};
+    const Matrix viewProjection = GetViewProjection(Vector3::Zero());
+
+    ShadowCache cache;
+    std::vector<ShadowCaster> casters = { CreateCaster(&handles[0], Vector3(0.f, 0.f, -10.f)), CreateCaster(&handles[1], Vector3(0.f, 0.f, 10.f)) };
+
+    cache.UpdateCasters(casters);
+    EXPECT_FALSE(cache.IsValid(0, viewProjection));
+    EXPECT_EQ(cache.GetStatistics().redrawnShadowMaps, 1);
+
+    // Nothing changed
+    cache.UpdateCasters(casters);
+    EXPECT_TRUE(cache.IsValid(0, viewProjection));
+    EXPECT_EQ(cache.GetStatistics().redrawnShadowMaps, 0);
+    EXPECT_EQ(cache.GetStatistics().cachedShadowMaps, 1);
+
+    // Caster behind the light
+    casters[1] = CreateCaster(&handles[1], Vector3(0.f, 2.f, 10.f));
+    cache.UpdateCasters(casters);
+    EXPECT_EQ(cache.GetChangedBounds().size(), 2);
+    EXPECT_TRUE(cache.IsValid(0, viewProjection));
+
+    // Caster in front of the light
+    casters[0] = CreateCaster(&handles[0], Vector3(0.f, 2.f, -10.f));
+    cache.UpdateCasters(casters);
+    EXPECT_FALSE(cache.IsValid(0, viewProjection));
+
+    // The light moved
+    cache.UpdateCasters(casters);
+    EXPECT_FALSE(cache.IsValid(0, GetViewProjection(Vector3(1.f, 0.f, 0.f))));
+    cache.UpdateCasters(casters);
+    EXPECT_TRUE(cache.IsValid(0, GetViewProjection(Vector3(1.f, 0.f, 0.f))));
+}
+
+TEST(ShadowCache, AddedAndRemovedCasters)
+{
+    const int32_t handles[2] = {};
+    const Matrix viewProjection = GetViewProjection(Vector3::Zero());
+
+    ShadowCache cache;
+    std::vector<ShadowCaster> casters = { CreateCaster(&handles[0], Vector3(0.f, 0.f, -10.f)) };
+
+    cache.UpdateCasters(casters);
+    EXPECT_FALSE(cache.IsValid(0, viewProjection));
+
+    casters.push_back(CreateCaster(&handles[1], Vector3(0.f, 0.f, -20.f)));
+    cache.UpdateCasters(casters);
+    EXPECT_EQ(cache.GetChangedBounds().size(), 1);
+    EXPECT_FALSE(cache.IsValid(0, viewProjection));
+
+    casters.erase(casters.begin());
+    cache.UpdateCasters(casters);
+    EXPECT_EQ(cache.GetChangedBounds().size(), 1);
+    EXPECT_FALSE(cache.IsValid(0, viewProjection));
+
+    // Far away from the light
+    casters.push_back(CreateCaster(&handles[0], Vector3(0.f, 0.f, -100.f)));
+    cache.UpdateCasters(casters);
+    EXPECT_TRUE(cache.IsValid(0, viewProjection));
+}
+
+TEST(ShadowCache, Invalidate)
+{
+    const Matrix viewProjection = GetViewProjection(Vector3::Zero());
+
+    ShadowCache cache;
+    cache.UpdateCasters({});
+    for (uint32_t i = 0; i < 4; i++)
+        EXPECT_FALSE(cache.IsValid(i, viewProjection));
+
+    cache.UpdateCasters({});
+    cache.Invalidate(1, 2);
+    // Out of range views are ignored
+    cache.Invalidate(10, 5);
+
+    EXPECT_TRUE(cache.IsValid(0, viewProjection));
+    EXPECT_FALSE(cache.IsValid(1, viewProjection));
+    EXPECT_FALSE(cache.IsValid(2, viewProjection));
+    EXPECT_TRUE(cache.IsValid(3, viewProjection));
+
+    EXPECT_EQ(cache.GetStatistics().redrawnShadowMaps, 2);
+    EXPECT_EQ(cache.GetStatistics().cachedShadowMaps, 2);
+}
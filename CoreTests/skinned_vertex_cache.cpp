@@ -0,0 +1,247 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <random>
+#include <thread>
+
+#include "rendering/skinned_vertex_cache.hpp"
+
+namespace
+{
+    constexpr size_t BoneCount = 60;
+    constexpr size_t VertexCount = 5000;
+    constexpr size_t CharacterCount = 100;
+    constexpr size_t FrameCount = 10;
+
+    List<Matrix> CreateMatrices(std::mt19937* const random)
+    {
+        std::uniform_real_distribution position(-2.f, 2.f);
+        std::uniform_real_distribution angle(-3.f, 3.f);
+        std::uniform_real_distribution scale(0.5f, 1.5f);
+
+        List<Matrix> matrices(BoneCount);
+        for (size_t i = 0; i < BoneCount; i++)
+        {
+            matrices[i] = Matrix::Trs(
+                Vector3(position(*random), position(*random), position(*random)),
+                Vector3(angle(*random), angle(*random), angle(*random)),
+                Vector3(scale(*random))
+            );
+        }
+
+        return matrices;
+    }
+
+    // Vertices with 1 to 4 bones
+    std::vector<Vertex> CreateVertices(std::mt19937* const random)
+    {
+        std::uniform_real_distribution position(-1.f, 1.f);
+        std::uniform_real_distribution weight(0.1f, 1.f);
+
+        std::vector<Vertex> vertices(VertexCount);
+        for (size_t i = 0; i < VertexCount; i++)
+        {
+            Vertex& vertex = vertices[i];
+            vertex.position = Vector3(position(*random), position(*random), position(*random));
+            vertex.normal = Vector3(position(*random), position(*random), 1.f).Normalized();
+            vertex.tangent = Vector3(1.f, position(*random), position(*random)).Normalized();
+            vertex.bitangent = Vector3::Cross(vertex.normal, vertex.tangent);
+            vertex.textureCoord = Vector2(position(*random), position(*random));
+
+            const size_t boneCount = 1 + i % Vertex::MaxBoneWeight;
+            float_t totalWeight = 0.f;
+            for (size_t j = 0; j < boneCount; j++)
+            {
+                vertex.boneIndices[j] = static_cast<float_t>((*random)() % BoneCount);
+                vertex.boneWeight[j] = weight(*random);
+                totalWeight += vertex.boneWeight[j];
+            }
+
+            for (size_t j = 0; j < boneCount; j++)
+                vertex.boneWeight[j] /= totalWeight;
+        }
+
+        return vertices;
+    }
+
+    // Same computation as the vertex shader, one bone at a time
+    Vector3 SkinPosition(const Vertex& vertex, const List<Matrix>& matrices)
+    {
+        Vector3 position;
+        for (size_t j = 0; j < Vertex::MaxBoneWeight; j++)
+        {
+            const int32_t bone = static_cast<int32_t>(vertex.boneIndices[j]);
+            if (bone != -1)
+                position += static_cast<Vector3>(matrices[bone] * Vector4(vertex.position.x, vertex.position.y, vertex.position.z, 1.f)) * vertex.boneWeight[j];
+        }
+
+        return position;
+    }
+
+    double_t SkinCharacters(SkinnedVertexCache* const cache, const std::vector<Vertex>& vertices, const std::vector<List<Matrix>>& matrices, const bool_t parallel)
+    {
+        using Clock = std::chrono::high_resolution_clock;
+
+        const Clock::time_point start = Clock::now();
+        for (size_t frame = 0; frame < FrameCount; frame++)
+        {
+            cache->Clear();
+            for (const List<Matrix>& characterMatrices : matrices)
+                cache->Add(vertices, characterMatrices);
+
+            cache->Skin(parallel);
+        }
+
+        return std::chrono::duration<double_t, std::milli>(Clock::now() - start).count() / FrameCount;
+    }
+}
+
+TEST(SkinnedVertexCache, Skin)
+{
+    std::mt19937 random(1);
+    const List<Matrix> matrices = CreateMatrices(&random);
+    const std::vector<Vertex> vertices = CreateVertices(&random);
+
+    std::vector<Vertex> skinned(VertexCount);
+    SkinnedVertexCache::Skin(vertices.data(), VertexCount, matrices.GetData(), BoneCount, skinned.data());
+
+    for (size_t i = 0; i < VertexCount; i++)
+    {
+        const Vector3 position = SkinPosition(vertices[i], matrices);
+        ASSERT_NEAR((skinned[i].position - position).Length(), 0.f, 1e-4f) << std::format("Vertex {}", i);
+
+        // The directions stay normalized, the other attributes are kept
+        EXPECT_NEAR(skinned[i].normal.Length(), 1.f, 1e-4f);
+        EXPECT_NEAR(skinned[i].tangent.Length(), 1.f, 1e-4f);
+        EXPECT_EQ(skinned[i].textureCoord, vertices[i].textureCoord);
+        EXPECT_EQ(std::memcmp(skinned[i].boneIndices, vertices[i].boneIndices, sizeof(Vertex::boneIndices)), 0);
+    }
+
+    // A single bone moves the normal with its rotation
+    Vertex vertex;
+    vertex.normal = Vector3::UnitY();
+    vertex.boneIndices[0] = 0.f;
+    vertex.boneWeight[0] = 1.f;
+    const Matrix rotation = Matrix::Trs(Vector3(5.f, 0.f, 0.f), Vector3(0.f, 0.f, Calc::PiOver2), Vector3(2.f));
+    Vertex result;
+    SkinnedVertexCache::Skin(&vertex, 1, &rotation, 1, &result);
+    EXPECT_NEAR((result.position - Vector3(5.f, 0.f, 0.f)).Length(), 0.f, 1e-5f);
+    EXPECT_NEAR((result.normal - Vector3(-1.f, 0.f, 0.f)).Length(), 0.f, 1e-5f);
+}
+
+TEST(SkinnedVertexCache, InvalidBones)
+{
+    std::mt19937 random(2);
+    const List<Matrix> matrices = CreateMatrices(&random);
+
+    std::array<Vertex, 2> vertices;
+    vertices[0].position = Vector3(1.f, 2.f, 3.f);
+    vertices[1].position = Vector3(4.f, 5.f, 6.f);
+    vertices[1].boneIndices[0] = static_cast<float_t>(BoneCount);
+    vertices[1].boneWeight[0] = 1.f;
+
+    // The vertices without a bone, or with a bone the skeleton doesn't have, keep their bind pose
+    std::array<Vertex, 2> skinned;
+    SkinnedVertexCache::Skin(vertices.data(), vertices.size(), matrices.GetData(), BoneCount, skinned.data());
+    for (size_t i = 0; i < vertices.size(); i++)
+        EXPECT_EQ(skinned[i].position, vertices[i].position);
+
+    // Without matrices, e.g. before the first animation update
+    SkinnedVertexCache::Skin(vertices.data(), vertices.size(), nullptr, 0, skinned.data());
+    EXPECT_EQ(skinned[1].position, vertices[1].position);
+}
+
+TEST(SkinnedVertexCache, Heuristic)
+{
+    EXPECT_FALSE(SkinnedVertexCache::IsCpuSkinned(SkinningMode::Automatic, 1));
+    EXPECT_FALSE(SkinnedVertexCache::IsCpuSkinned(SkinningMode::Automatic, SkinnedVertexCache::MinCpuSkinningPassCount - 1));
+    EXPECT_TRUE(SkinnedVertexCache::IsCpuSkinned(SkinningMode::Automatic, SkinnedVertexCache::MinCpuSkinningPassCount));
+    // A G-buffer pass, 4 shadow cascades and a point light
+    EXPECT_TRUE(SkinnedVertexCache::IsCpuSkinned(SkinningMode::Automatic, 6));
+
+    EXPECT_TRUE(SkinnedVertexCache::IsCpuSkinned(SkinningMode::Cpu, 1));
+    EXPECT_FALSE(SkinnedVertexCache::IsCpuSkinned(SkinningMode::Gpu, 20));
+}
+
+TEST(SkinnedVertexCache, Instances)
+{
+    std::mt19937 random(3);
+    const std::vector<Vertex> vertices = CreateVertices(&random);
+    const std::vector<Vertex> otherVertices(vertices.begin(), vertices.begin() + 100);
+    std::vector<List<Matrix>> matrices;
+    for (size_t i = 0; i < 3; i++)
+        matrices.push_back(CreateMatrices(&random));
+
+    SkinnedVertexCache cache;
+    for (size_t frame = 0; frame < 2; frame++)
+    {
+        cache.Clear();
+        EXPECT_EQ(cache.Add(vertices, matrices[0]), 0);
+        EXPECT_EQ(cache.Add(otherVertices, matrices[1]), 1);
+        EXPECT_EQ(cache.Add(vertices, matrices[2]), 2);
+        cache.Skin();
+
+        // A single upload per instance
+        std::vector<size_t> uploadedCounts;
+        cache.Upload([&](const uint32_t instance, const Vertex* const data, const size_t count) -> void
+        {
+            EXPECT_EQ(instance, uploadedCounts.size());
+            EXPECT_EQ(data, cache.GetVertices(instance));
+            uploadedCounts.push_back(count);
+        });
+
+        EXPECT_EQ(uploadedCounts, (std::vector<size_t>{ VertexCount, 100, VertexCount }));
+
+        const SkinnedVertexCacheStatistics& statistics = cache.GetStatistics();
+        EXPECT_EQ(statistics.instanceCount, 3);
+        EXPECT_EQ(statistics.vertexCount, 2 * VertexCount + 100);
+        EXPECT_EQ(statistics.uploadedBytes, (2 * VertexCount + 100) * sizeof(Vertex));
+
+        // Each instance is skinned with its own matrices
+        for (uint32_t i = 0; i < cache.GetInstanceCount(); i++)
+        {
+            std::vector<Vertex> expected(cache.GetVertexCount(i));
+            SkinnedVertexCache::Skin(i == 1 ? otherVertices.data() : vertices.data(), expected.size(), matrices[i].GetData(), BoneCount, expected.data());
+            ASSERT_EQ(std::memcmp(cache.GetVertices(i), expected.data(), expected.size() * sizeof(Vertex)), 0) << std::format("Instance {}", i);
+        }
+    }
+}
+
+TEST(SkinnedVertexCache, Benchmark)
+{
+    std::mt19937 random(4);
+    const std::vector<Vertex> vertices = CreateVertices(&random);
+    std::vector<List<Matrix>> matrices;
+    for (size_t i = 0; i < CharacterCount; i++)
+        matrices.push_back(CreateMatrices(&random));
+
+    SkinnedVertexCache serialCache;
+    SkinnedVertexCache parallelCache;
+
+    // Warm up the worker threads
+    SkinCharacters(&parallelCache, vertices, matrices, true);
+
+    const double_t serialTime = SkinCharacters(&serialCache, vertices, matrices, false);
+    const double_t parallelTime = SkinCharacters(&parallelCache, vertices, matrices, true);
+
+    // The skinned vertices don't depend on the thread which skinned them
+    for (uint32_t i = 0; i < CharacterCount; i++)
+        ASSERT_EQ(std::memcmp(serialCache.GetVertices(i), parallelCache.GetVertices(i), VertexCount * sizeof(Vertex)), 0) << std::format("Character {}", i);
+
+    const uint32_t threadCount = std::thread::hardware_concurrency();
+
+    std::cout << std::format(
+        "{} characters of {} vertices: {:.3f} ms per frame on 1 thread, {:.3f} ms per frame in parallel ({:.2f}x on {} hardware threads)\n",
+        CharacterCount,
+        VertexCount,
+        serialTime,
+        parallelTime,
+        serialTime / parallelTime,
+        threadCount
+    );
+    RecordProperty("serial_ms", std::format("{:.4f}", serialTime));
+    RecordProperty("parallel_ms", std::format("{:.4f}", parallelTime));
+    RecordProperty("speedup", std::format("{:.2f}", serialTime / parallelTime));
+}
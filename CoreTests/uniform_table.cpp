@@ -0,0 +1,164 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <unordered_map>
+
+#include "rendering/uniform_table.hpp"
+
+namespace
+{
+    constexpr UniformHandle<Matrix> ModelUniform("model");
+    constexpr UniformHandle<Vector3> ColorUniform("color");
+
+    static_assert(ModelUniform.hash == HashUniformName("model"));
+    static_assert(ModelUniform.hash != ColorUniform.hash);
+
+    std::vector<std::string> CreateNames(const size_t count)
+    {
+        std::vector<std::string> names(count);
+        for (size_t i = 0; i < count; i++)
+            names[i] = std::format("material.uniform{}", i);
+        return names;
+    }
+}
+
+TEST(UniformTable, AddAndFind)
+{
+    UniformTable table;
+    EXPECT_EQ(table.Find(ModelUniform.hash, ModelUniform.checkHash), nullptr);
+
+    table.Add("model", 3);
+    table.Add("color", 7);
+    table.Add("projection", 1);
+
+    ASSERT_EQ(table.GetCount(), 3);
+
+    const UniformTableEntry* const model = table.Find(ModelUniform.hash, ModelUniform.checkHash);
+    ASSERT_NE(model, nullptr);
+    EXPECT_EQ(model->name, "model");
+    EXPECT_EQ(model->uniform.shaderKey, 3);
+    EXPECT_FALSE(model->hasValue);
+
+    const UniformTableEntry* const color = table.Find(ColorUniform.hash, ColorUniform.checkHash);
+    ASSERT_NE(color, nullptr);
+    EXPECT_EQ(color->uniform.shaderKey, 7);
+
+    EXPECT_EQ(table.Find(HashUniformName("view"), HashUniformNameCheck("view")), nullptr);
+
+    // Entries are kept sorted by hash for the binary search
+    const std::vector<UniformTableEntry>& entries = table.GetEntries();
+    for (size_t i = 1; i < entries.size(); i++)
+        EXPECT_LT(HashUniformName(entries[i - 1].name), HashUniformName(entries[i].name));
+
+    table.Clear();
+    EXPECT_EQ(table.GetCount(), 0);
+    EXPECT_EQ(table.Find(ModelUniform.hash, ModelUniform.checkHash), nullptr);
+}
+
+TEST(UniformTable, Duplicates)
+{
+    UniformTable table;
+
+    UniformTableEntry& entry = table.Add("model", 3);
+    entry.hasValue = true;
+
+    // Adding an existing uniform returns it untouched
+    const UniformTableEntry& duplicate = table.Add("model", 5);
+    EXPECT_EQ(table.GetCount(), 1);
+    EXPECT_EQ(duplicate.uniform.shaderKey, 3);
+    EXPECT_TRUE(duplicate.hasValue);
+
+    // Uniforms that don't exist in the program are still cached
+    table.Add("missing", UniformTable::InvalidLocation);
+    const UniformTableEntry* const missing = table.Find(HashUniformName("missing"), HashUniformNameCheck("missing"));
+    ASSERT_NE(missing, nullptr);
+    EXPECT_EQ(missing->uniform.shaderKey, UniformTable::InvalidLocation);
+}
+
+TEST(UniformTable, HashCollisions)
+{
+    // Both names have the same FNV-1a hash, but not the same second hash
+    static_assert(HashUniformName("costarring") == HashUniformName("liquid"));
+    static_assert(HashUniformNameCheck("costarring") != HashUniformNameCheck("liquid"));
+    constexpr UniformHandle<float_t> CostarringUniform("costarring");
+    constexpr UniformHandle<float_t> LiquidUniform("liquid");
+
+    UniformTable table;
+    table.Add("costarring", 1);
+
+    // A name with the same hash isn't mistaken for the existing uniform
+    EXPECT_EQ(table.Find(LiquidUniform.hash, LiquidUniform.checkHash), nullptr);
+
+    table.Add("liquid", 2);
+    table.Add("model", 3);
+    EXPECT_EQ(table.GetCount(), 3);
+
+    const UniformTableEntry* const costarring = table.Find(CostarringUniform.hash, CostarringUniform.checkHash);
+    const UniformTableEntry* const liquid = table.Find(LiquidUniform.hash, LiquidUniform.checkHash);
+    ASSERT_NE(costarring, nullptr);
+    ASSERT_NE(liquid, nullptr);
+    EXPECT_EQ(costarring->uniform.shaderKey, 1);
+    EXPECT_EQ(liquid->uniform.shaderKey, 2);
+
+    // Adding either of them again returns it
+    EXPECT_EQ(&table.Add("liquid", 5), liquid);
+    EXPECT_EQ(table.GetCount(), 3);
+}
+
+TEST(UniformTable, Benchmark)
+{
+    constexpr size_t UniformCount = 32;
+    constexpr size_t Iterations = 2'000'000;
+
+    const std::vector<std::string> names = CreateNames(UniformCount);
+
+    // Legacy: uniforms looked up by std::string, built from the name given to Rhi::SetUniform
+    std::unordered_map<std::string, GpuUniform> legacyMap;
+    UniformTable table;
+    std::vector<uint32_t> hashes(UniformCount);
+    std::vector<uint32_t> checkHashes(UniformCount);
+    for (size_t i = 0; i < UniformCount; i++)
+    {
+        legacyMap.emplace(names[i], GpuUniform { .shaderKey = static_cast<uint32_t>(i) });
+        table.Add(names[i], static_cast<uint32_t>(i));
+        hashes[i] = HashUniformName(names[i]);
+        checkHashes[i] = HashUniformNameCheck(names[i]);
+    }
+
+    std::vector<const char_t*> keys(UniformCount);
+    for (size_t i = 0; i < UniformCount; i++)
+        keys[i] = names[i].c_str();
+
+    using Clock = std::chrono::high_resolution_clock;
+    const auto elapsed = [](const Clock::time_point start) -> double_t
+    {
+        return std::chrono::duration<double_t, std::nano>(Clock::now() - start).count();
+    };
+
+    auto start = Clock::now();
+    uint64_t legacySum = 0;
+    for (size_t i = 0; i < Iterations; i++)
+        legacySum += legacyMap.find(keys[i % UniformCount])->second.shaderKey;
+    const double_t legacy = elapsed(start) / Iterations;
+
+    // Name based calls still hash the name, but don't allocate
+    start = Clock::now();
+    uint64_t nameSum = 0;
+    for (size_t i = 0; i < Iterations; i++)
+        nameSum += table.Find(HashUniformName(keys[i % UniformCount]), HashUniformNameCheck(keys[i % UniformCount]))->uniform.shaderKey;
+    const double_t name = elapsed(start) / Iterations;
+
+    // Handles are hashed once
+    start = Clock::now();
+    uint64_t handleSum = 0;
+    for (size_t i = 0; i < Iterations; i++)
+        handleSum += table.Find(hashes[i % UniformCount], checkHashes[i % UniformCount])->uniform.shaderKey;
+    const double_t handle = elapsed(start) / Iterations;
+
+    EXPECT_EQ(nameSum, legacySum);
+    EXPECT_EQ(handleSum, legacySum);
+
+    std::cout << std::format("[string map] {:.2f}ns\n[name] {:.2f}ns\n[handle] {:.2f}ns\n", legacy, name, handle);
+    RecordProperty("string_map_ns", std::format("{:.2f}", legacy));
+    RecordProperty("handle_ns", std::format("{:.2f}", handle));
+}
@@ -1,10 +1,14 @@
 ﻿#pragma once
 
+#include <functional>
+
 #include "definitions.hpp"
 #include "rendering/camera.hpp"
+#include "rendering/gpu_readback.hpp"
 #include "rendering/render_pass.hpp"
 #include "resource/shader.hpp"
 #include "scene/entity.hpp"
+#include "world/scene_raycaster.hpp"
 #include "world/skybox.hpp"
 
 BEGIN_XNOR_EDITOR
@@ -23,8 +27,14 @@ public:
     // Should be call on the Imgui editor window only
     void ResizeHandle(Vector2i newSize);
 
-    // Pixel pos in image current Window
-    bool_t GetEntityFromScreen(Vector2i pixelPos, XnorCore::Scene& scene,const XnorCore::Camera& pointOfView, XnorCore::Entity** entity);
+    // Resolves the pending picks, should be called every frame
+    void Update();
+
+    // Pixel pos in image current Window, the callback receives the entity, or nullptr, once the GPU is done a frame or two later
+    void PickEntity(Vector2i pixelPos, const XnorCore::Camera& pointOfView, const std::function<void(XnorCore::Entity*)>& callback);
+
+    // Pixel pos in image current Window, raycasts the scene on the CPU and returns the entity hit, or nullptr
+    XnorCore::Entity* RaycastEntity(Vector2i pixelPos, const XnorCore::Camera& pointOfView);
 
 private:
     Editor* m_Editor = nullptr;
@@ -36,6 +46,10 @@ private:
 
     XnorCore::Texture* m_ColorAttachment = nullptr;
     XnorCore::Texture* m_DepthAttachement = nullptr;
+
+    XnorCore::GpuReadback m_Readback;
+
+    XnorCore::SceneRaycaster m_Raycaster;
     
     void DestroyRendering() const;
 
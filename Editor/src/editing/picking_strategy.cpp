@@ -1,4 +1,7 @@
 ﻿#include "editing/picking_strategy.hpp"
+
+#include <cstring>
+
 #include "editor.hpp"
 #include "rendering/rhi_typedef.hpp"
 #include "resource/resource_manager.hpp"
@@ -33,14 +36,18 @@ void PickingStrategy::ResizeHandle(const Vector2i newSize)
     }
 }
 
-bool_t PickingStrategy::GetEntityFromScreen(const Vector2i pixelPos, XnorCore::Scene& scene, const XnorCore::Camera& pointOfView,
-    XnorCore::Entity** entity)
+void PickingStrategy::Update()
+{
+    m_Readback.Update();
+}
+
+void PickingStrategy::PickEntity(const Vector2i pixelPos, const XnorCore::Camera& pointOfView, const std::function<void(XnorCore::Entity*)>& callback)
 {
     if (!m_Editor)
-        return false;
+        return;
 
     if (!frameBuffer)
-        return false;
+        return;
 
     // Draw
     m_PickingShaderStatic->Use();
@@ -58,24 +65,62 @@ bool_t PickingStrategy::GetEntityFromScreen(const Vector2i pixelPos, XnorCore::S
 
     m_PickingShaderStatic->Unuse();
 
-    float_t getValue = 0.f;
-    frameBuffer->GetPixelFromAttachment(0, pixelPos, XnorCore::TextureFormat::Red, XnorCore::DataType::Float, &getValue);
+    // Reading the pixel right away would wait for the whole pass to be rendered
+    m_Readback.Request(
+        *frameBuffer,
+        0,
+        pixelPos,
+        Vector2i(1),
+        XnorCore::TextureFormat::Red,
+        XnorCore::DataType::Float,
+        [callback](const std::vector<uint8_t>& data) -> void
+        {
+            float_t getValue = 0.f;
+            std::memcpy(&getValue, data.data(), sizeof(getValue));
 
-    if (getValue == 0.f)
-        return false;
+            // The scene can have changed since the request
+            if (getValue == 0.f || XnorCore::World::scene == nullptr)
+            {
+                callback(nullptr);
+                return;
+            }
 
-    // - 1 cause in render wee need to do +1 to avoid the black color of the attachment be a valid index  
-    const uint32_t entityIndex = static_cast<uint32_t>(getValue) - 1;
+            // - 1 cause in render wee need to do +1 to avoid the black color of the attachment be a valid index  
+            const uint32_t entityIndex = static_cast<uint32_t>(getValue) - 1;
 
-    const XnorCore::List<XnorCore::Entity*>& entities = scene.GetEntities();
+            const XnorCore::List<XnorCore::Entity*>& entities = XnorCore::World::scene->GetEntities();
+            callback(entityIndex < entities.GetSize() ? entities[entityIndex] : nullptr);
+        }
+    );
+}
 
-    if (entityIndex < entities.GetSize())
-    {
-        *entity = entities[entityIndex];
-        return true;
-    }
-    
-    return false;
+XnorCore::Entity* PickingStrategy::RaycastEntity(const Vector2i pixelPos, const XnorCore::Camera& pointOfView)
+{
+    if (XnorCore::World::scene == nullptr || !m_ColorAttachment)
+        return nullptr;
+
+    // Unproject the pixel on the near and far planes
+    const Vector2i screenSize = m_ColorAttachment->GetSize();
+    Matrix viewProjection;
+    pointOfView.GetVp(screenSize, &viewProjection);
+    const Matrix inverseViewProjection = viewProjection.Inverted();
+
+    const float_t x = (static_cast<float_t>(pixelPos.x) + 0.5f) / static_cast<float_t>(screenSize.x) * 2.f - 1.f;
+    const float_t y = (static_cast<float_t>(pixelPos.y) + 0.5f) / static_cast<float_t>(screenSize.y) * 2.f - 1.f;
+    const Vector4 near = inverseViewProjection * Vector4(x, y, -1.f, 1.f);
+    const Vector4 far = inverseViewProjection * Vector4(x, y, 1.f, 1.f);
+    const Vector3 nearPoint = static_cast<Vector3>(near) / near.w;
+    const Vector3 farPoint = static_cast<Vector3>(far) / far.w;
+
+    // The top-level BVH is only rebuilt when the instances changed since the last pick, and refit when some of them moved, the triangle BVHs of the models are kept
+    m_Raycaster.Build(*XnorCore::World::scene);
+
+    XnorCore::Entity* entity = nullptr;
+    float_t distance = 1.f;
+    if (!m_Raycaster.Raycast(XnorCore::Ray(nearPoint, farPoint - nearPoint), &entity, &distance))
+        return nullptr;
+
+    return entity;
 }
 
 void PickingStrategy::DestroyRendering() const
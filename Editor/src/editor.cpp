@@ -622,6 +622,8 @@ void Editor::Update()
 		shadersToReload.Clear();
 		listMutex.unlock();
 
+		UpdateSubsystems();
+
 		const bool_t deserializingScene = m_CurrentAsyncActionThread.joinable() || m_Deserializing;
 
 		UpdateWindows();
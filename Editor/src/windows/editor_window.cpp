@@ -23,6 +23,7 @@ void EditorWindow::Display()
 {
     RenderWindow::Display();
     m_PickingStrategy.ResizeHandle(m_Size);
+    m_PickingStrategy.Update();
     
     m_TransformGizmo.SetRendering(
         m_Editor->data.editorCam,
@@ -107,13 +108,6 @@ void EditorWindow::SelectEntityOnScreen()
             return;
         }
 
-        XnorCore::Entity* ptr = nullptr;
-        if (m_PickingStrategy.GetEntityFromScreen(mousePosI, *XnorCore::World::scene, m_Editor->data.editorCam, &ptr))
-        {
-            m_Editor->data.selectedEntity = ptr;
-            return;
-        }
-
-        m_Editor->data.selectedEntity = nullptr;
+        m_Editor->data.selectedEntity = m_PickingStrategy.RaycastEntity(mousePosI, m_Editor->data.editorCam);
     }
 }
@@ -11,6 +11,7 @@
 #include "imgui/imgui.h"
 #include "input/time.hpp"
 #include "Maths/calc.hpp"
+#include "world/world.hpp"
 
 using namespace XnorEditor;
 
@@ -56,6 +57,12 @@ void Performance::Display()
     format = std::format("Memory: {:.2f}MB", m_LastMemory);
     ImGui::PlotLines("##memory", m_MemoryArray.data(), static_cast<int32_t>(std::min(m_TotalSamples, m_MemoryArray.size())), m_ArrayIndex,
         format.c_str(), m_LowestArrayMemory, m_HighestArrayMemory, ImVec2(available.x, GraphsHeight));
+
+    const XnorCore::AnimationStats& animationStats = XnorCore::World::animationSystem.GetStats();
+    ImGui::Text("Animated bones: %zu / %zu", animationStats.animatedBoneCount, animationStats.boneCount);
+    ImGui::Text("Animators updated: %zu / %zu", animationStats.updatedAnimatorCount, animationStats.animatorCount);
+    for (size_t i = 0; i < animationStats.lodAnimatorCounts.size(); i++)
+        ImGui::Text("Animation LOD %zu: %zu", i, animationStats.lodAnimatorCounts[i]);
 }
 
 void Performance::SetSampleCount(const size_t sampleCount)
@@ -0,0 +1,77 @@
+#include <charconv>
+#include <iostream>
+#include <string_view>
+
+#include "file/archive.hpp"
+#include "resource/guid_map.hpp"
+#include "utils/logger.hpp"
+
+using namespace XnorCore;
+
+static void PrintUsage(const char_t* const executable)
+{
+    std::cout << "Usage: " << executable << " <source directory> <archive path> [--alignment <bytes>] [--no-compression]\n"
+        << "Packs every file of the source directory into a single archive that can be mounted using FileManager::MountArchive.\n\n"
+        << "Usage: " << executable << " --convert-guid-map <text GUID map path> <binary GUID map path>\n"
+        << "Converts a legacy text GUID map into the binary format used by the ResourceManager.\n";
+}
+
+int32_t main(const int32_t argc, const char_t* const* const argv)
+{
+    if (argc < 3)
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (std::string_view(argv[1]) == "--convert-guid-map")
+    {
+        if (argc != 4)
+        {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        Logger::Start();
+
+        const bool_t result = GuidMap::ConvertText(argv[2], argv[3]);
+
+        Logger::Stop();
+
+        return result ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    ArchiveBuildOptions options;
+
+    for (int32_t i = 3; i < argc; i++)
+    {
+        const std::string_view argument = argv[i];
+
+        if (argument == "--no-compression")
+        {
+            options.compression = CompressionFormat::None;
+        }
+        else if (argument == "--alignment" && i + 1 < argc)
+        {
+            const std::string_view value = argv[++i];
+            if (std::from_chars(value.data(), value.data() + value.size(), options.alignment).ec != std::errc())
+            {
+                PrintUsage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Logger::Start();
+
+    const bool_t result = Archive::Build(argv[1], argv[2], options);
+
+    Logger::Stop();
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -2,5 +2,4 @@
 
 void main()
 {
-    //gl_FragDepth = gl_FragCoord.z;
 }
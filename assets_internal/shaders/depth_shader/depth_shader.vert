@@ -1,60 +1,10 @@
 #version 460 core
-#extension GL_NV_uniform_buffer_std430_layout : enable
-
-
 layout (location = 0) in vec3 aPos;
 
-const int MaxSpotLight = 50;
-const int MaxPointLight = 50;
-const int DirectionalCascadeLevelAllocation = 12;
-const int DirectionalCascadeLevel = 4;
-
-const float PI = 3.14159265359;
-const float InvPI = 1/PI;
-
-struct PointLightData
-{
-    vec3 color;
-    float intensity;
-    vec3 position;
-    float radius;
-    bool isCastShadow;
-};
-
-struct SpotLightData
-{
-    vec3 color;
-    float intensity;
-    vec3 position;
-    float cutOff;
-    vec3 direction;
-    float outerCutOff;
-    bool isCastShadow;
-};
-
-struct DirectionalData
-{
-    vec3 color;
-    float intensity;
-    vec3 direction;
-    bool isDirlightCastShadow;
-    int cascadeCount;
-    float cascadePlaneDistance[DirectionalCascadeLevel];
-};
-
-layout (std430, binding = 2) uniform LightData
-{
-    int nbrOfPointLight;
-    int nbrOfSpotLight;
-    PointLightData pointLightData[MaxPointLight];
-    SpotLightData spotLightData[MaxSpotLight];
-    DirectionalData directionalData;
-
-    mat4 spothLightlightSpaceMatrix[MaxSpotLight];
-    mat4 dirLightSpaceMatrix[DirectionalCascadeLevelAllocation];
-    int nbrOfDirLight;
-};
-
+#ifdef SKINNED
+layout (location = 5) in vec4 aBoneIndices;
+layout (location = 6) in vec4 aBoneWeights;
+#endif
 
 layout (std140, binding = 0) uniform CameraUniform
 {
@@ -72,8 +22,46 @@ layout (std140, binding = 1) uniform ModelUniform
     mat4 model;
     mat4 normalInvertMatrix;
     uint drawId;
+    // Upper half of the 64 bits draw id
+    uint drawIdHigh;
+    uint boneOffset;
+    uint boneCount;
+};
+
+#ifdef SKINNED
+// Bone matrices of all the skinned meshes of the frame
+layout (std430, binding = 5) readonly buffer BonePalette
+{
+    mat4 boneMatrices[];
 };
+#endif
+
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+#ifdef SKINNED
+    vec4 finalPosition = vec4(0.0, 0.0, 0.0, 1.0);
+
+    for(int i = 0; i < 4; i++)
+    {
+        int idx = int(aBoneIndices[i]);
+        if (idx == -1)
+            continue;
+
+        if (idx >= int(boneCount))
+        {
+            finalPosition = vec4(aPos, 1.0f);
+            break;
+        }
+
+        vec4 localPosition = boneMatrices[boneOffset + uint(idx)] * vec4(aPos ,1.0f);
+        finalPosition += localPosition * aBoneWeights[i];
+    }
+
+    // Set the fragement pose base on animation and the model matrix
+    vec4 worldPosition = model * vec4(finalPosition.xyz, 1.0);
+#else
+    vec4 worldPosition = model * vec4(aPos, 1.0);
+#endif
+
+    gl_Position = projection * view * worldPosition;
 }
@@ -0,0 +1,13 @@
+#version 460 core
+
+layout (location = 0) out float PixelLigthDistance;
+
+uniform vec3 lightPosition;
+
+in vec3 WorldPos;
+
+void main()
+{
+    vec3 pixelToVertex = WorldPos - lightPosition;
+    PixelLigthDistance = length(pixelToVertex);
+}
@@ -1,6 +0,0 @@
-#version 460 core
-
-void main()
-{
-    //gl_FragDepth = gl_FragCoord.z;
-}
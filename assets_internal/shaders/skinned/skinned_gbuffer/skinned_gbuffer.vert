@@ -8,8 +8,6 @@ layout (location = 4) in vec3 aBitangent;
 layout (location = 5) in vec4 aBoneIndices;
 layout (location = 6) in vec4 aBoneWeights;
 
-#define MaxBones 100
-
 layout (std140, binding = 0) uniform CameraUniform
 {
     mat4 view;
@@ -26,6 +24,10 @@ layout (std140, binding = 1) uniform ModelUniform
     mat4 model;
     mat4 normalInvertMatrix;
     uint drawId;
+    // Upper half of the 64 bits draw id
+    uint drawIdHigh;
+    uint boneOffset;
+    uint boneCount;
 };
 
 layout (std140, binding = 4) uniform MaterialDataUniform
@@ -51,9 +53,10 @@ layout (std140, binding = 4) uniform MaterialDataUniform
 };
 
 
-layout (std140, binding = 5) uniform SkinnedBuffer
+// Bone matrices of all the skinned meshes of the frame
+layout (std430, binding = 5) readonly buffer BonePalette
 {
-    mat4 mat[MaxBones];
+    mat4 boneMatrices[];
 };
 
 out VS_OUT
@@ -83,15 +86,15 @@ void main()
         if (idx == -1)
             continue;
 
-        if (idx >= MaxBones)
+        if (idx >= int(boneCount))
         {
             finalPosition = vec4(aPos, 1.0f);
             break;
         }
 
-        vec4 localPosition = mat[idx] * vec4(aPos ,1.0f);
+        vec4 localPosition = boneMatrices[boneOffset + uint(idx)] * vec4(aPos ,1.0f);
         finalPosition += localPosition * aBoneWeights[i];
-        localNormal = mat3(mat[idx]) * aNormal;
+        localNormal = mat3(boneMatrices[boneOffset + uint(idx)]) * aNormal;
     }
 
     // Set the fragement pose base on animation and the model matrix
@@ -29,6 +29,7 @@ struct SpotLightData
     vec3 direction;
     float outerCutOff;
     bool isCastShadow;
+    float range;
 };
 
 struct DirectionalData
@@ -45,15 +46,39 @@ layout (std430, binding = 2) uniform LightData
 {
     int nbrOfPointLight;
     int nbrOfSpotLight;
-    PointLightData pointLightData[MaxPointLight];
-    SpotLightData spotLightData[MaxSpotLight];
     DirectionalData directionalData;
 
     mat4 spothLightlightSpaceMatrix[MaxSpotLight];
+    // Offset in xy and size in zw of the shadow atlas tile of each spot light
+    vec4 spotLightShadowAtlasRect[MaxSpotLight];
     mat4 dirLightSpaceMatrix[DirectionalCascadeLevelAllocation];
     int nbrOfDirLight;
 };
 
+layout (std430, binding = 6) readonly buffer PointLightBuffer
+{
+    PointLightData pointLightData[];
+};
+
+layout (std430, binding = 7) readonly buffer SpotLightBuffer
+{
+    SpotLightData spotLightData[];
+};
+
+layout (std430, binding = 8) readonly buffer LightClusterBuffer
+{
+    uvec4 clusterGridSize;
+    // Depth scale, depth bias, near and far
+    vec4 clusterDepthParams;
+    // Light index offset, point light count and spot light count
+    uvec4 clusters[];
+};
+
+layout (std430, binding = 9) readonly buffer LightIndexBuffer
+{
+    uint lightIndices[];
+};
+
 layout (std140, binding = 0) uniform CameraUniform
 {
     mat4 view;
@@ -155,6 +180,21 @@ vec3 CalcDirLight(DirectionalData light,vec3 viewDir,vec3 fragPos, vec3 normal,v
     return ambient + diffuse + specular;
 }
 
+// Lights affecting the cluster of a fragment
+uvec4 GetCluster(vec3 fragPos)
+{
+    vec4 viewPos = view * vec4(fragPos, 1.0);
+    vec4 clipPos = projection * viewPos;
+    vec2 tile = clamp((clipPos.xy / clipPos.w * 0.5 + 0.5) * vec2(clusterGridSize.xy), vec2(0.0), vec2(clusterGridSize.xy) - 1.0);
+
+    float depth = -viewPos.z;
+    uint slice = 0;
+    if (depth > clusterDepthParams.z)
+        slice = uint(clamp(floor(log(depth) * clusterDepthParams.x + clusterDepthParams.y), 0.0, float(clusterGridSize.z) - 1.0));
+
+    return clusters[uint(tile.x) + uint(tile.y) * clusterGridSize.x + slice * clusterGridSize.x * clusterGridSize.y];
+}
+
 void main()
 {
     vec3 normal = normalize(fs_in.normal);
@@ -163,14 +203,16 @@ void main()
 
     vec3 finalColor = CalcDirLight(directionalData, viewDir, fs_in.fragPos, normal, albedo);
 
-    for (int i = 0; i < nbrOfPointLight; i++)
+    uvec4 cluster = GetCluster(fs_in.fragPos);
+
+    for (uint i = 0; i < cluster.y; i++)
     {
-        finalColor += CalcPointLight(pointLightData[i], viewDir, fs_in.fragPos, normal, albedo);
+        finalColor += CalcPointLight(pointLightData[lightIndices[cluster.x + i]], viewDir, fs_in.fragPos, normal, albedo);
     }
 
-    for (int i = 0; i < nbrOfSpotLight; i++)
+    for (uint i = 0; i < cluster.z; i++)
     {
-        finalColor += CalcSpotLight(spotLightData[i], viewDir, fs_in.fragPos, normal, albedo);
+        finalColor += CalcSpotLight(spotLightData[lightIndices[cluster.x + cluster.y + i]], viewDir, fs_in.fragPos, normal, albedo);
     }
 
     FragColor = vec4(finalColor, 1);
@@ -29,6 +29,7 @@ struct SpotLightData
     vec3 direction;
     float outerCutOff;
     bool isCastShadow;
+    float range;
 };
 
 struct DirectionalData
@@ -45,14 +46,38 @@ layout (std430, binding = 2) uniform LightData
 {
     int nbrOfPointLight;
     int nbrOfSpotLight;
-    PointLightData pointLightData[MaxPointLight];
-    SpotLightData spotLightData[MaxSpotLight];
     DirectionalData directionalData;
 
     mat4 spothLightlightSpaceMatrix[MaxSpotLight];
+    // Offset in xy and size in zw of the shadow atlas tile of each spot light
+    vec4 spotLightShadowAtlasRect[MaxSpotLight];
     mat4 dirLightSpaceMatrix[DirectionalCascadeLevelAllocation];
     int nbrOfDirLight;
 };
+layout (std430, binding = 6) readonly buffer PointLightBuffer
+{
+    PointLightData pointLightData[];
+};
+
+layout (std430, binding = 7) readonly buffer SpotLightBuffer
+{
+    SpotLightData spotLightData[];
+};
+
+layout (std430, binding = 8) readonly buffer LightClusterBuffer
+{
+    uvec4 clusterGridSize;
+    // Depth scale, depth bias, near and far
+    vec4 clusterDepthParams;
+    // Light index offset, point light count and spot light count
+    uvec4 clusters[];
+};
+
+layout (std430, binding = 9) readonly buffer LightIndexBuffer
+{
+    uint lightIndices[];
+};
+
 layout (std140, binding = 0) uniform CameraUniform
 {
     mat4 view;
@@ -77,7 +102,7 @@ uniform samplerCube prefilterMap;
 uniform sampler2D brdfLUT;
 
 uniform sampler2DArray dirLightShadowMap;
-uniform sampler2DArray spotLightShadowArray;
+uniform sampler2D spotLightShadowAtlas;
 
 uniform samplerCubeArray pointLightCubemapArrayPixelDistance;
 
@@ -102,6 +127,21 @@ const vec2 gridSamplingDiskVec2[20] = vec2[]
 );
 
 
+// Lights affecting the cluster of a fragment
+uvec4 GetCluster(vec3 fragPos)
+{
+    vec4 viewPos = view * vec4(fragPos, 1.0);
+    vec4 clipPos = projection * viewPos;
+    vec2 tile = clamp((clipPos.xy / clipPos.w * 0.5 + 0.5) * vec2(clusterGridSize.xy), vec2(0.0), vec2(clusterGridSize.xy) - 1.0);
+
+    float depth = -viewPos.z;
+    uint slice = 0;
+    if (depth > clusterDepthParams.z)
+        slice = uint(clamp(floor(log(depth) * clusterDepthParams.x + clusterDepthParams.y), 0.0, float(clusterGridSize.z) - 1.0));
+
+    return clusters[uint(tile.x) + uint(tile.y) * clusterGridSize.x + slice * clusterGridSize.x * clusterGridSize.y];
+}
+
 // this is supposed to get the world position from the depth buffer
 vec4 WorldPosFromDepth(float depth) {
     float z = depth * 2.0 - 1.0;
@@ -187,32 +227,36 @@ float ShadowCalculationSpolight(vec4 fragPosLightSpace, vec3 n, vec3 l, int inde
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     // transform to [0,1] range
     projCoords = projCoords * 0.5 + 0.5;
-    // get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-    float closestDepth = texture(spotLightShadowArray, vec3(projCoords.xy, index)).r; // Corrected indexing
+
+    // keep the shadow at 0.0 when outside the light's frustum.
+    if (projCoords.z > 1.0 || any(lessThan(projCoords.xy, vec2(0.0))) || any(greaterThan(projCoords.xy, vec2(1.0))))
+        return 0.0;
+
+    // tile of the light in the shadow atlas, the PCF samples must not bleed into the neighbouring tiles
+    vec4 atlasRect = spotLightShadowAtlasRect[index];
+    vec2 texelSize = 1.0 / vec2(textureSize(spotLightShadowAtlas, 0));
+    vec2 tileMin = atlasRect.xy + texelSize * 0.5;
+    vec2 tileMax = atlasRect.xy + atlasRect.zw - texelSize * 0.5;
+    vec2 atlasCoords = atlasRect.xy + projCoords.xy * atlasRect.zw;
+
     // get depth of current fragment from light's perspective
     float currentDepth = projCoords.z;
     // calculate bias (based on depth map resolution and slope)
     vec3 normal = normalize(n);
     vec3 lightDir = normalize(l);
     float bias = max(0.00005 * (1.0 - dot(normal, lightDir)), 0.0000005f);
-    // check whether current frag pos is in shadow
-    float shadow = currentDepth - bias > closestDepth ? 1.0 : 0.0;
     // PCF
-    vec2 texelSize = 1.0 / textureSize(spotLightShadowArray, 0).xy;
+    float shadow = 0.0;
     for(int x = -1; x <= 1; ++x)
     {
         for(int y = -1; y <= 1; ++y)
         {
-            vec2 texel = projCoords.xy + vec2(x, y) * texelSize;
-            float pcfDepth = texture(spotLightShadowArray, vec3(texel, index)).r; // Corrected indexing
+            vec2 texel = clamp(atlasCoords + vec2(x, y) * texelSize, tileMin, tileMax);
+            float pcfDepth = texture(spotLightShadowAtlas, texel).r;
             shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
         }
     }
     shadow /= 9.0;
-
-    // keep the shadow at 0.0 when outside the far_plane region of the light's frustum.
-    if(projCoords.z > 1.0)
-    shadow = 0.0;
     
     return shadow;
 }
@@ -285,15 +329,19 @@ vec3 ComputeIbl(float roughness,vec3 kD, float ao,vec3 albedo, vec3 N , vec3 R ,
 }
     
 
-vec3 ComputeSpotLight(vec3 baseColor,vec4 fragPos,vec3 v, vec3 n, float roughness, float metallic, vec3 f0)
+vec3 ComputeSpotLight(vec3 baseColor,vec4 fragPos,vec3 v, vec3 n, float roughness, float metallic, vec3 f0, uvec4 cluster)
 {
     vec3 outLo = vec3(0.f);
     vec3 fragposVec3 = vec3(fragPos.x, fragPos.y, fragPos.z);
 
-    for (int i = 0; i < nbrOfSpotLight; i++)
+    for (uint c = 0; c < cluster.z; c++)
     {
+        int i = int(lightIndices[cluster.x + cluster.y + c]);
         SpotLightData light = spotLightData[i];
         float distance = length(light.position - fragposVec3);
+
+        if (distance > light.range)
+        continue;
         
         vec3 l = normalize(vec3(light.position - fragposVec3));
         vec3 h = normalize(v + l);
@@ -337,12 +385,13 @@ vec3 ComputeSpotLight(vec3 baseColor,vec4 fragPos,vec3 v, vec3 n, float roughnes
     return outLo;
 }
 
-vec3 ComputePointLight(vec3 baseColor,vec3 fragPos,vec3 v, vec3 n, float roughness, float metallic, vec3 f0)
+vec3 ComputePointLight(vec3 baseColor,vec3 fragPos,vec3 v, vec3 n, float roughness, float metallic, vec3 f0, uvec4 cluster)
 {
     vec3 outLo = vec3(0.f);
 
-    for (int i = 0; i < nbrOfPointLight; i++)
+    for (uint c = 0; c < cluster.y; c++)
     {
+        int i = int(lightIndices[cluster.x + c]);
         PointLightData light = pointLightData[i];
         float distance = length(light.position - fragPos);
 
@@ -456,8 +505,9 @@ void main()
         Lo += LoDir;
     }
     
-    Lo += ComputePointLight(albedo, fragPos, v, n, roughness, metallic, F0);
-    Lo += ComputeSpotLight(albedo, fragPosVec4, v, n, roughness, metallic, F0);
+    uvec4 cluster = GetCluster(fragPos);
+    Lo += ComputePointLight(albedo, fragPos, v, n, roughness, metallic, F0, cluster);
+    Lo += ComputeSpotLight(albedo, fragPosVec4, v, n, roughness, metallic, F0, cluster);
     
     vec3 ambient = ComputeIbl(roughness, kD, ambientOcclusion, albedo, n, r, v, f);
     vec3 color = Lo + ambient + (emissiveColor * emissive);